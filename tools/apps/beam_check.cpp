@@ -0,0 +1,127 @@
+// IR beam check for the Photogate housing: casts every line of sight between
+// the LED and phototransistor lenses through the assembled halves, reports
+// how much of the beam is clear, then how far the top half or the receiver
+// can move before the clear fraction drops below the threshold.
+//
+//   beam_check [--samples N] [--threshold F] [--scalar] [top.stl bottom.stl]
+//
+// With no files it uses STL/fdm/Photogate_Top.stl and Photogate_Bottom.stl.
+
+#include "pwb/beam.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/stl.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pwb::stl::Vec3;
+
+pwb::ray::Scene assemble(const pwb::stl::File& top, const pwb::stl::File& bottom, const Vec3& top_offset) {
+    pwb::ray::Scene scene;
+    scene.add(bottom.triangles());
+    scene.add(top.triangles(), top_offset);
+    scene.build();
+    return scene;
+}
+
+void print_limits(const char* what, const pwb::beam::Limits& l, double reach) {
+    auto side = [&](double v) {
+        char buf[32];
+        if (std::abs(v) >= reach) std::snprintf(buf, sizeof buf, "beyond %+.1f", v);
+        else std::snprintf(buf, sizeof buf, "%+.3f", v);
+        return std::string(buf);
+    };
+    std::printf("  %-34s %12s %12s mm\n", what, side(l.minus).c_str(), side(l.plus).c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    pwb::beam::Beam beam = pwb::beam::photogate();
+    double threshold = 0.5;
+    pwb::ray::Options options;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--samples" && i + 1 < argc) beam.samples = std::atoi(argv[++i]);
+        else if (a == "--threshold" && i + 1 < argc) threshold = std::atof(argv[++i]);
+        else if (a == "--scalar") options.simd = false;
+        else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else {
+            std::fprintf(stderr, "usage: beam_check [--samples N] [--threshold F] [--scalar] [top.stl bottom.stl]\n");
+            return 2;
+        }
+    }
+    if (paths.empty()) {
+        paths.push_back(std::string(PWB_REPO_ROOT) + "/STL/fdm/Photogate_Top.stl");
+        paths.push_back(std::string(PWB_REPO_ROOT) + "/STL/fdm/Photogate_Bottom.stl");
+    }
+    if (paths.size() != 2 || beam.samples < 1 || threshold <= 0 || threshold > 1) {
+        std::fprintf(stderr, "usage: beam_check [--samples N] [--threshold F] [--scalar] [top.stl bottom.stl]\n");
+        return 2;
+    }
+
+    try {
+        const pwb::stl::File top(paths[0]), bottom(paths[1]);
+        auto t0 = std::chrono::steady_clock::now();
+        const pwb::ray::Scene scene = assemble(top, bottom, {});
+        const double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("housing    %s + %s\n", paths[0].c_str(), paths[1].c_str());
+        std::printf("scene      %zu triangles, %zu BVH nodes, SAH cost %.1f, %.1f KB, built in %.2f ms\n",
+                    scene.triangles(), scene.tree().nodes.size(), scene.tree().sah_cost(), scene.bytes() / 1024.0,
+                    build_ms);
+        std::printf("beam       emitter (%.2f, %.2f, %.2f) r %.2f -> receiver (%.2f, %.2f, %.2f) r %.2f, %d x %d rays\n",
+                    beam.emitter.centre.x, beam.emitter.centre.y, beam.emitter.centre.z, beam.emitter.radius,
+                    beam.receiver.centre.x, beam.receiver.centre.y, beam.receiver.centre.z, beam.receiver.radius,
+                    beam.samples, beam.samples);
+
+        const pwb::beam::Trace aligned = pwb::beam::trace(scene, beam, options);
+        std::printf("aligned    %.1f %% of the lines of sight clear (%zu of %zu), %.2f Mrays/s%s\n",
+                    100 * aligned.fraction(), aligned.clear, aligned.rays, aligned.rays / aligned.seconds * 1e-6,
+                    options.simd ? "" : " (scalar)");
+
+        // The bores are split between the halves, so a shifted top half
+        // narrows them; a receiver seated off-axis looks into the bore wall.
+        auto top_shift = [&](Vec3 dir) {
+            return [&, dir](double d) {
+                const Vec3 off{float(dir.x * d), float(dir.y * d), float(dir.z * d)};
+                return pwb::beam::trace(assemble(top, bottom, off), beam, options).fraction();
+            };
+        };
+        auto receiver_shift = [&](Vec3 dir) {
+            return [&, dir](double d) {
+                pwb::beam::Beam moved = beam;
+                moved.receiver.centre = {beam.receiver.centre.x + float(dir.x * d), beam.receiver.centre.y + float(dir.y * d),
+                                         beam.receiver.centre.z + float(dir.z * d)};
+                return pwb::beam::trace(scene, moved, options).fraction();
+            };
+        };
+
+        std::printf("profile    top half shifted across the beam (y):");
+        for (double d = 0; d <= 2.0 + 1e-9; d += 0.25) std::printf(" %.2f:%.0f%%", d, 100 * top_shift({0, 1, 0})(d));
+        std::printf("\n");
+
+        const double reach = 3.0, step = 0.1;
+        t0 = std::chrono::steady_clock::now();
+        std::printf("tolerance  offsets keeping %.0f %% of the beam clear:\n", 100 * threshold);
+        print_limits("top half across the beam (y)", pwb::beam::limits(top_shift({0, 1, 0}), threshold, step, reach), reach);
+        print_limits("top half along the beam (x)", pwb::beam::limits(top_shift({1, 0, 0}), threshold, step, reach), reach);
+        print_limits("receiver across the beam (y)", pwb::beam::limits(receiver_shift({0, 1, 0}), threshold, step, reach),
+                     reach);
+        print_limits("receiver off the split plane (z)",
+                     pwb::beam::limits(receiver_shift({0, 0, 1}), threshold, step, reach), reach);
+        std::printf("           swept in %.2f s\n",
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+        return aligned.fraction() >= threshold ? 0 : 1;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "beam_check: %s\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,93 @@
+// Checks that the copper Gerbers of a CAM package still match the EAGLE
+// board they were generated from. Both sides are rendered on the same grid
+// and XOR-ed; differing regions are listed with their bounding boxes.
+//
+//   board_check [--pixel-um N] [board.brd] [cam.zip]
+//
+// Exits with status 1 when any region differs.
+
+#include "pwb/bitmap_diff.hpp"
+#include "pwb/board_geometry.hpp"
+#include "pwb/eagle_board.hpp"
+#include "pwb/gerber.hpp"
+#include "pwb/raster.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+namespace {
+
+double mm(pwb::gerber::Coord v) { return double(v) / pwb::gerber::kNmPerMm; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string board_path = PWB_REPO_ROOT "/PCB/deprecated/PCB_photogate_ESPWROOM32/schematic.brd";
+    std::string zip_path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    pwb::raster::Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--pixel-um" && i + 1 < argc) options.pixel = std::llround(std::atof(argv[++i]) * 1000);
+        else if (pwb::ends_with(a, ".brd")) board_path = a;
+        else if (pwb::ends_with(a, ".zip")) zip_path = a;
+        else {
+            std::fprintf(stderr, "usage: board_check [--pixel-um N] [board.brd] [cam.zip]\n");
+            return 2;
+        }
+    }
+
+    struct Pair {
+        const char* gerber;
+        int layer;
+    };
+    const Pair pairs[] = {{"copper_top.gbr", pwb::eagle::kTop}, {"copper_bottom.gbr", pwb::eagle::kBottom}};
+
+    try {
+        pwb::eagle::Board board = pwb::eagle::load_board(board_path);
+        pwb::ZipArchive zip(zip_path);
+        int failures = 0;
+        for (const Pair& p : pairs) {
+            auto t0 = std::chrono::steady_clock::now();
+            pwb::gerber::Layer layer = pwb::gerber::parse(zip.read(p.gerber));
+            pwb::gerber::Coord tolerance = std::max<pwb::gerber::Coord>(options.pixel / 8, 100);
+            std::vector<pwb::gerber::PolygonSet> eagle_copper{pwb::eagle::copper(board, p.layer, tolerance)};
+
+            // Common window: union of both extents.
+            pwb::raster::Options opt = options;
+            opt.window = layer.bounds();
+            for (const pwb::gerber::Point& q : eagle_copper[0].points) opt.window.add(q.x, q.y);
+            opt.window.min_x -= 2 * opt.pixel, opt.window.min_y -= 2 * opt.pixel;
+            opt.window.max_x += 2 * opt.pixel, opt.window.max_y += 2 * opt.pixel;
+
+            pwb::raster::Bitmap from_gerber = pwb::raster::rasterise(layer, opt);
+            pwb::raster::Bitmap from_board = pwb::raster::rasterise(eagle_copper, {}, opt);
+            pwb::raster::DiffResult d = pwb::raster::diff(from_gerber, from_board);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+            std::printf("%-18s vs layer %-2d  gerber %8.3f mm2  board %8.3f mm2  xor %7.3f mm2  regions %-3zu %7.1f ms  %s\n",
+                        p.gerber, p.layer, d.area_a_mm2, d.area_b_mm2, d.xor_mm2, d.regions.size(), ms,
+                        d.regions.empty() ? "OK" : "MISMATCH");
+            std::size_t shown = 0;
+            for (const pwb::raster::DiffRegion& r : d.regions) {
+                if (++shown > 20) {
+                    std::printf("    ... %zu more\n", d.regions.size() - 20);
+                    break;
+                }
+                std::printf("    [%7.3f, %7.3f] - [%7.3f, %7.3f] mm  %.4f mm2\n", mm(r.box.min_x), mm(r.box.min_y),
+                            mm(r.box.max_x), mm(r.box.max_y), r.area_mm2);
+            }
+            failures += !d.regions.empty();
+        }
+        return failures ? 1 : 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "board_check: %s\n", ex.what());
+        return 2;
+    }
+}
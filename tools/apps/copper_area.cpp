@@ -0,0 +1,224 @@
+// Copper area per layer and per net from a CAM package, for fab quotes (ENIG
+// is priced on copper left exposed by the soldermask) and for checking the
+// copper balance of home-etched boards.
+//
+//   copper_area [--cell-mm N] [--heatmap DIR] [--cache DIR | --no-cache] [cam.zip] [board.brd]
+//
+// Nets: islands on the two sides are joined through the drill hits that land
+// in both, then named after the EAGLE signals whose pads, wires and vias fall
+// inside them. Per-layer results are cached by content hash.
+
+#include "pwb/copper_area.hpp"
+#include "pwb/eagle_board.hpp"
+#include "pwb/excellon.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pwb::copper::Island;
+using pwb::copper::LayerResult;
+
+// Island of `layer` containing the point (mm), as a global index, or -1.
+long island_at(const std::vector<LayerResult>& layers, const std::vector<std::size_t>& base, std::size_t layer,
+               double x_mm, double y_mm) {
+    const std::vector<Island>& is = layers[layer].islands;
+    for (std::size_t i = 0; i < is.size(); ++i)
+        if (is[i].contains(x_mm * 1e6, y_mm * 1e6)) return long(base[layer] + i);
+    return -1;
+}
+
+void print_heatmap(const pwb::copper::Heatmap& h) {
+    static const char ramp[] = " .:-=+*#%@";
+    for (int r = h.rows - 1; r >= 0; --r) {
+        std::printf("    |");
+        for (int c = 0; c < h.cols; ++c) std::putchar(ramp[std::min(9, int(h.at(c, r) * 10.0f))]);
+        std::printf("|\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string zip_path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    std::string board_path = PWB_REPO_ROOT "/PCB/deprecated/PCB_photogate_ESPWROOM32/schematic.brd";
+    std::string heatmap_dir;
+    pwb::copper::Options options;
+    options.cache_dir = pwb::copper::default_cache_dir();
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--cell-mm" && i + 1 < argc) options.cell = std::llround(std::atof(argv[++i]) * 1e6);
+        else if (a == "--heatmap" && i + 1 < argc) heatmap_dir = argv[++i];
+        else if (a == "--cache" && i + 1 < argc) options.cache_dir = argv[++i];
+        else if (a == "--no-cache") options.cache_dir.clear();
+        else if (pwb::ends_with(a, ".zip")) zip_path = a;
+        else if (pwb::ends_with(a, ".brd")) board_path = a;
+        else {
+            std::fprintf(stderr, "usage: copper_area [--cell-mm N] [--heatmap DIR] [--cache DIR | --no-cache] "
+                                 "[cam.zip] [board.brd]\n");
+            return 2;
+        }
+    }
+
+    try {
+        auto t0 = std::chrono::steady_clock::now();
+        pwb::ZipArchive zip(zip_path);
+        std::vector<pwb::copper::LayerInput> inputs;
+        std::string drill, profile;
+        for (const pwb::ZipEntry& e : zip.entries()) {
+            std::string name(e.basename());
+            if (pwb::ends_with(name, ".xln") || pwb::ends_with(name, ".drl")) drill = zip.read(e);
+            else if (name == "profile.gbr") profile = zip.read(e);
+            else if (pwb::ends_with(name, ".gbr") && name.find("copper") != std::string::npos) {
+                std::string mask_name = name;
+                mask_name.replace(mask_name.find("copper"), 6, "soldermask");
+                const pwb::ZipEntry* mask = zip.find(mask_name);
+                inputs.push_back({name, zip.read(e), mask ? zip.read(*mask) : std::string()});
+            }
+        }
+        if (inputs.empty()) throw std::runtime_error(zip_path + ": no copper layers");
+        // Top side first so the tables read top / bottom.
+        std::sort(inputs.begin(), inputs.end(), [](const auto& a, const auto& b) {
+            return (a.name.find("top") != std::string::npos) > (b.name.find("top") != std::string::npos);
+        });
+        if (!profile.empty()) options.window = pwb::gerber::parse(profile).bounds();
+
+        std::vector<LayerResult> layers = pwb::copper::analyse(inputs, options);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        double board = options.window.empty() ? 0.0 : double(options.window.width()) * double(options.window.height()) * 1e-12;
+        std::printf("%-20s %10s %8s %12s %8s  %s\n", "layer", "copper mm2", "fill", "exposed mm2", "islands", "");
+        for (const LayerResult& l : layers) {
+            std::printf("%-20s %10.3f %7.1f%% ", l.name.c_str(), l.area, board > 0 ? 100.0 * l.area / board : 0.0);
+            if (l.exposed >= 0) std::printf("%12.3f ", l.exposed);
+            else std::printf("%12s ", "-");
+            std::printf("%8zu  %s\n", l.islands.size(), l.from_cache ? "(cached)" : "");
+        }
+        if (layers.size() == 2 && layers[1].area > 0)
+            std::printf("copper balance top/bottom: %.2f\n", layers[0].area / layers[1].area);
+
+        // Nets: islands joined through drill hits, named from the board.
+        std::vector<std::size_t> base(layers.size() + 1, 0);
+        for (std::size_t l = 0; l < layers.size(); ++l) base[l + 1] = base[l] + layers[l].islands.size();
+        pwb::UnionFind uf(base.back());
+        if (!drill.empty() && layers.size() > 1) {
+            pwb::excellon::DrillFile holes = pwb::excellon::parse(drill);
+            for (const pwb::excellon::Tool& t : holes.tools) {
+                for (const pwb::excellon::Hit& h : t.hits) {
+                    long first = -1;
+                    for (std::size_t l = 0; l < layers.size(); ++l) {
+                        long i = island_at(layers, base, l, h.x, h.y);
+                        if (i < 0) continue;
+                        if (first < 0) first = i;
+                        else uf.join(std::uint32_t(first), std::uint32_t(i));
+                    }
+                }
+            }
+        }
+        std::map<std::size_t, std::set<std::string>> names;
+        try {
+            pwb::eagle::Board b = pwb::eagle::load_board(board_path);
+            auto side = [&](int eagle_layer) -> long {
+                for (std::size_t l = 0; l < layers.size(); ++l) {
+                    bool top = layers[l].name.find("top") != std::string::npos;
+                    if ((eagle_layer == pwb::eagle::kTop && top) || (eagle_layer == pwb::eagle::kBottom && !top)) return long(l);
+                }
+                return -1;
+            };
+            auto mark = [&](const std::string& net, int eagle_layer, double x, double y) {
+                for (std::size_t l = 0; l < layers.size(); ++l) {
+                    if (eagle_layer != 0 && long(l) != side(eagle_layer)) continue;
+                    long i = island_at(layers, base, l, x, y);
+                    if (i >= 0) names[uf.find(std::uint32_t(i))].insert(net);
+                }
+            };
+            for (const pwb::eagle::Signal& s : b.signals) {
+                for (const pwb::eagle::Wire& w : s.wires) mark(s.name, w.layer, (w.x1 + w.x2) / 2, (w.y1 + w.y2) / 2);
+                for (const pwb::eagle::Via& v : s.vias) mark(s.name, 0, v.x, v.y);
+                for (const pwb::eagle::ContactRef& c : s.contacts) {
+                    const pwb::eagle::Element* e = b.element(c.element);
+                    const pwb::eagle::Package* pkg = e ? b.package_of(*e) : nullptr;
+                    if (!pkg) continue;
+                    pwb::eagle::Placement at = pwb::eagle::placement(*e);
+                    double x, y;
+                    for (const pwb::eagle::Pad& p : pkg->pads)
+                        if (p.name == c.pad) at.apply(p.x, p.y, x, y), mark(s.name, 0, x, y);
+                    for (const pwb::eagle::Smd& p : pkg->smds)
+                        if (p.name == c.pad) at.apply(p.x, p.y, x, y), mark(s.name, at.layer(p.layer), x, y);
+                }
+            }
+        } catch (const std::exception& ex) {
+            std::fprintf(stderr, "copper_area: %s; nets left unnamed\n", ex.what());
+        }
+
+        struct Net {
+            std::string name;
+            std::size_t signals = 0, islands = 0;
+            std::vector<double> area;
+            double total = 0;
+        };
+        std::map<std::size_t, Net> nets;
+        for (std::size_t l = 0; l < layers.size(); ++l) {
+            for (std::size_t i = 0; i < layers[l].islands.size(); ++i) {
+                Net& n = nets[uf.find(std::uint32_t(base[l] + i))];
+                n.area.resize(layers.size(), 0.0);
+                n.area[l] += layers[l].islands[i].area;
+                n.total += layers[l].islands[i].area;
+                ++n.islands;
+            }
+        }
+        // Islands no signal reaches (unconnected module pads, logos) are summed into one row.
+        std::vector<Net> sorted;
+        Net unnamed;
+        unnamed.area.resize(layers.size(), 0.0);
+        for (auto& [root, n] : nets) {
+            const std::set<std::string>& s = names[root];
+            if (s.empty()) {
+                for (std::size_t l = 0; l < layers.size(); ++l) unnamed.area[l] += n.area[l];
+                unnamed.total += n.total;
+                unnamed.islands += n.islands;
+                continue;
+            }
+            for (const std::string& name : s) n.name += (n.name.empty() ? "" : " / ") + name;
+            n.signals = s.size();
+            sorted.push_back(std::move(n));
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Net& a, const Net& b) { return a.total > b.total; });
+        if (unnamed.islands) {
+            unnamed.name = "(no signal, " + std::to_string(unnamed.islands) + " islands)";
+            sorted.push_back(std::move(unnamed));
+        }
+        std::printf("\n%-24s", "net");
+        for (const LayerResult& l : layers) std::printf(" %16s", l.name.c_str());
+        std::printf(" %10s\n", "total mm2");
+        for (const Net& n : sorted) {
+            std::printf("%-24s", n.name.c_str());
+            for (double a : n.area) std::printf(" %16.3f", a);
+            std::printf(" %10.3f%s\n", n.total, n.signals > 1 ? "  <- copper joins several signals" : "");
+        }
+
+        for (const LayerResult& l : layers) {
+            const pwb::copper::Heatmap& h = l.heatmap;
+            std::printf("\n%s copper density, %.1f mm cells (%d x %d):\n", l.name.c_str(), h.cell * 1e-6, h.cols, h.rows);
+            print_heatmap(h);
+            if (!heatmap_dir.empty()) h.write_pgm(heatmap_dir + "/" + l.name.substr(0, l.name.rfind('.')) + "_density.pgm");
+        }
+        std::printf("\n%.1f ms\n", ms);
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "copper_area: %s\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,88 @@
+// Orders the hits of an Excellon drill file for CNC drilling: per tool, a
+// nearest-neighbour route improved with 2-opt and Or-opt. Prints the travel
+// per tool before and after, and optionally writes the reordered file.
+//
+//   drill_plan [--home X,Y] [--neighbours K] [--no-or-opt] [--out planned.xln] [drill.xln | cam.zip]
+//
+// With a .zip the first *.xln / *.drl member is used.
+
+#include "pwb/drill_path.hpp"
+#include "pwb/excellon.hpp"
+#include "pwb/mapped_file.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::string read_drill(const std::string& path) {
+    if (!pwb::ends_with(path, ".zip")) return std::string(pwb::MappedFile(path).view());
+    pwb::ZipArchive zip(path);
+    for (const pwb::ZipEntry& e : zip.entries())
+        if (pwb::ends_with(e.name, ".xln") || pwb::ends_with(e.name, ".drl")) return zip.read(e);
+    throw std::runtime_error(path + ": no drill file in archive");
+}
+
+double percent(double before, double after) { return before > 0 ? 100.0 * (before - after) / before : 0.0; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    std::string out_path;
+    pwb::drill::PlanOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--home" && i + 1 < argc) {
+            char* end = nullptr;
+            options.home_x = std::strtod(argv[++i], &end);
+            options.home_y = *end == ',' ? std::strtod(end + 1, nullptr) : 0.0;
+        } else if (a == "--neighbours" && i + 1 < argc) options.neighbours = std::atoi(argv[++i]);
+        else if (a == "--no-or-opt") options.or_opt = false;
+        else if (a == "--out" && i + 1 < argc) out_path = argv[++i];
+        else if (a[0] != '-') path = a;
+        else {
+            std::fprintf(stderr, "usage: drill_plan [--home X,Y] [--neighbours K] [--no-or-opt] [--out planned.xln] "
+                                 "[drill.xln | cam.zip]\n");
+            return 2;
+        }
+    }
+
+    try {
+        pwb::excellon::DrillFile file = pwb::excellon::parse(read_drill(path));
+        std::vector<pwb::drill::PlanStats> stats = pwb::drill::optimise(file, options);
+
+        std::printf("%-5s %8s %7s %12s %12s %12s %8s %9s\n", "tool", "dia mm", "holes", "file mm", "nn mm", "planned mm",
+                    "saved", "ms");
+        pwb::drill::PlanStats total;
+        for (std::size_t t = 0; t < file.tools.size(); ++t) {
+            const pwb::drill::PlanStats& s = stats[t];
+            std::printf("T%-4d %8.3f %7zu %12.1f %12.1f %12.1f %7.1f%% %9.1f\n", file.tools[t].number,
+                        file.tools[t].diameter, s.holes, s.original, s.nearest, s.optimised,
+                        percent(s.original, s.optimised), s.seconds * 1e3);
+            total.holes += s.holes;
+            total.original += s.original;
+            total.nearest += s.nearest;
+            total.optimised += s.optimised;
+        }
+        std::printf("%-5s %8s %7zu %12.1f %12.1f %12.1f %7.1f%%\n", "all", "", total.holes, total.original,
+                    total.nearest, total.optimised, percent(total.original, total.optimised));
+
+        if (!out_path.empty()) {
+            std::ofstream out(out_path, std::ios::binary);
+            out << pwb::excellon::write(file) << "\n";
+            if (!out) throw std::runtime_error("cannot write " + out_path);
+        }
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "drill_plan: %s\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,44 @@
+// Validates a CAM package before it goes to the fab: the .gbrjob metadata,
+// every Gerber header (%MO%, %FS%, %IN%), layer presence and extents against
+// the profile, and the drill file's units and zero mode.
+//
+//   fab_check [--tolerance-mm N] [cam.zip]
+//
+// Exit status: 0 pass (warnings allowed), 1 on any failure, 2 if the package
+// cannot be read.
+
+#include "pwb/fab_package.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+int main(int argc, char** argv) {
+    std::string path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    pwb::fab::Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--tolerance-mm" && i + 1 < argc) options.tolerance = std::llround(std::atof(argv[++i]) * 1e6);
+        else if (!a.empty() && a[0] != '-') path = a;
+        else {
+            std::fprintf(stderr, "usage: fab_check [--tolerance-mm N] [cam.zip]\n");
+            return 2;
+        }
+    }
+    try {
+        pwb::ZipArchive zip(path);
+        pwb::fab::Report report = pwb::fab::validate(zip, options);
+        for (const pwb::fab::Check& c : report.checks)
+            std::printf("%s  %-30s %s\n", pwb::fab::status_name(c.status), c.name.c_str(), c.detail.c_str());
+        std::printf("\n%s: %zu checks, %zu warnings, %zu failures in %.1f ms\n",
+                    pwb::fab::status_name(report.overall()), report.checks.size(),
+                    report.count(pwb::fab::Status::Warn), report.count(pwb::fab::Status::Fail), report.seconds * 1e3);
+        return report.overall() == pwb::fab::Status::Fail ? 1 : 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "fab_check: %s\n", ex.what());
+        return 2;
+    }
+}
@@ -0,0 +1,139 @@
+// Assembly fit check for printed halves: minimum clearance, interpenetration,
+// an area histogram of the gap and the patches that touch, for each pair of
+// parts that must mate. Exits with 1 if any pair interpenetrates.
+//
+//   fit_check [--max-distance MM] [--contact MM] [--seat] [--offset X,Y,Z] fixed.stl moving.stl
+//   fit_check [--max-distance MM] [--contact MM] [--thickness MM] [--z MM] shell.stl board.brd
+//
+// --seat drops the moving part along -z until it touches before checking.
+// With no files it checks the Photogate halves, the shield halves (seated)
+// and the PCB from PCB/eagle_files/schm.brd inside Shield_Bottom_V1.
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/fit.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pwb::stl::Vec3;
+
+struct Job {
+    std::string fixed, moving;
+    bool seat = false;
+    Vec3 offset{};
+};
+
+std::string base_name(const std::string& path) { return path.substr(path.find_last_of("/\\") + 1); }
+
+bool run(const Job& job, const pwb::fit::Options& options, double thickness, double board_z) {
+    const pwb::stl::File fixed_file(job.fixed);
+    const pwb::mesh::Mesh fixed = pwb::mesh::weld(fixed_file.triangles());
+    pwb::mesh::Mesh moving;
+    if (pwb::ends_with(job.moving, ".brd")) {
+        moving = pwb::fit::board_solid(pwb::eagle::load_board(job.moving), thickness, board_z);
+    } else {
+        const pwb::stl::File f(job.moving);
+        moving = pwb::mesh::weld(f.triangles());
+    }
+    std::printf("%s in %s\n", base_name(job.moving).c_str(), base_name(job.fixed).c_str());
+    Vec3 offset = job.offset;
+    if (job.seat) {
+        const float drop = pwb::fit::seat_distance(fixed, pwb::fit::translated(moving, offset), {0, 0, -1});
+        if (drop >= pwb::fit::kFar) throw std::runtime_error(job.moving + " never touches " + job.fixed + " along -z");
+        offset.z -= drop;
+        std::printf("  seated     dropped %.3f mm along -z\n", drop);
+    }
+    if (offset.x != 0 || offset.y != 0 || offset.z != 0) {
+        moving = pwb::fit::translated(moving, offset);
+        std::printf("  offset     (%.3f, %.3f, %.3f)\n", offset.x, offset.y, offset.z);
+    }
+
+    const pwb::fit::Report r = pwb::fit::check(fixed, moving, options);
+    if (r.min_distance >= pwb::fit::kFar)
+        std::printf("  clearance  more than %.2f mm everywhere\n", options.max_distance);
+    else
+        std::printf("  clearance  min %.3f mm at (%.2f, %.2f, %.2f) / (%.2f, %.2f, %.2f)\n", r.min_distance,
+                    r.closest_moving.x, r.closest_moving.y, r.closest_moving.z, r.closest_fixed.x, r.closest_fixed.y,
+                    r.closest_fixed.z);
+    std::printf("  interpen.  %zu crossing triangle pairs, %zu vertices inside the other part", r.intersecting_pairs,
+                r.vertices_inside);
+    if (r.vertices_inside) std::printf(", up to %.3f mm deep", r.max_depth);
+    std::printf("\n  histogram  moving surface %.1f mm², by gap:\n", r.area);
+    const double bin = options.max_distance / double(r.histogram.size());
+    for (std::size_t b = 0; b < r.histogram.size(); ++b) {
+        if (r.histogram[b] == 0) continue;
+        std::printf("    %5.2f-%5.2f mm %10.2f mm²  %5.1f %%\n", b * bin, (b + 1) * bin, r.histogram[b],
+                    100 * r.histogram[b] / r.area);
+    }
+    std::printf("  contacts   %zu patch%s within %.2f mm\n", r.contacts.size(), r.contacts.size() == 1 ? "" : "es",
+                options.contact);
+    for (std::size_t i = 0; i < r.contacts.size() && i < 8; ++i) {
+        const pwb::fit::Contact& c = r.contacts[i];
+        std::printf("    %8.2f mm², %5zu triangles, min %.3f mm, (%.1f, %.1f, %.1f) .. (%.1f, %.1f, %.1f)\n", c.area,
+                    c.triangles, c.min_distance, c.box.min.x, c.box.min.y, c.box.min.z, c.box.max.x, c.box.max.y,
+                    c.box.max.z);
+    }
+    if (r.contacts.size() > 8) std::printf("    ... %zu more\n", r.contacts.size() - 8);
+    std::printf("  %s, %zu triangle pairs measured in %.2f ms\n", r.interpenetrates() ? "INTERFERES" : "fits",
+                r.pairs_tested, r.seconds * 1e3);
+    return !r.interpenetrates();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    pwb::fit::Options options;
+    double thickness = 1.6, board_z = 0;
+    Job job;
+    std::vector<std::string> paths;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: fit_check [--max-distance MM] [--contact MM] [--seat] [--offset X,Y,Z] "
+                             "[--thickness MM] [--z MM] [fixed.stl moving.stl|board.brd]\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--max-distance" && i + 1 < argc) options.max_distance = float(std::atof(argv[++i]));
+        else if (a == "--contact" && i + 1 < argc) options.contact = float(std::atof(argv[++i]));
+        else if (a == "--thickness" && i + 1 < argc) thickness = std::atof(argv[++i]);
+        else if (a == "--z" && i + 1 < argc) board_z = std::atof(argv[++i]);
+        else if (a == "--seat") job.seat = true;
+        else if (a == "--offset" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%f,%f,%f", &job.offset.x, &job.offset.y, &job.offset.z) != 3) return usage();
+        } else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else return usage();
+    }
+    if ((paths.size() != 0 && paths.size() != 2) || options.max_distance <= 0 || options.contact < 0) return usage();
+
+    std::vector<Job> jobs;
+    if (paths.empty()) {
+        const std::string root = PWB_REPO_ROOT;
+        jobs.push_back({root + "/STL/fdm/Photogate_Bottom.stl", root + "/STL/fdm/Photogate_Top.stl", false, {}});
+        jobs.push_back({root + "/STL/fdm/shield_design/Shield_Bottom_V1.stl",
+                        root + "/STL/fdm/shield_design/Shield_Top_V1.stl", true, {}});
+        jobs.push_back({root + "/STL/fdm/shield_design/Shield_Bottom_V1.stl", root + "/PCB/eagle_files/schm.brd", false, {}});
+    } else {
+        job.fixed = paths[0];
+        job.moving = paths[1];
+        jobs.push_back(job);
+    }
+
+    bool ok = true;
+    try {
+        for (const Job& j : jobs) ok &= run(j, options, thickness, board_z);
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "fit_check: %s\n", ex.what());
+        return 2;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+// Lists the Gerber layers of a CAM package (zip or single file) with their
+// header settings, primitive counts and extents.
+//
+//   gerber_dump [archive.zip | layer.gbr] [member...]
+
+#include "pwb/gerber.hpp"
+#include "pwb/mapped_file.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cstdio>
+#include <exception>
+#include <string>
+
+namespace {
+
+void describe(const std::string& label, std::string_view text) {
+    using namespace pwb::gerber;
+    Layer layer = parse(text);
+    Box b = layer.bounds();
+    auto mm = [](Coord v) { return double(v) / kNmPerMm; };
+    std::printf("%-32s %-18s %s FS%c%d%d/%d%d  D:%-3zu flash:%-5zu stroke:%-6zu region:%-4zu levels:%zu",
+                label.c_str(), ("\"" + layer.name + "\"").c_str(),
+                layer.units == Units::Millimetres ? "MM" : "IN", layer.format.omit_trailing ? 'T' : 'L',
+                layer.format.x_integer, layer.format.x_decimal, layer.format.y_integer, layer.format.y_decimal,
+                layer.apertures.size(), layer.flashes.size(), layer.strokes.size(), layer.regions.size(),
+                layer.levels.size());
+    if (!b.empty())
+        std::printf("  [%.3f, %.3f]-[%.3f, %.3f] mm", mm(b.min_x), mm(b.min_y), mm(b.max_x), mm(b.max_y));
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    try {
+        if (!pwb::ends_with(path, ".zip")) {
+            pwb::MappedFile file(path);
+            describe(path, file.view());
+            return 0;
+        }
+        pwb::ZipArchive zip(path);
+        if (argc > 2) {
+            for (int i = 2; i < argc; ++i) describe(argv[i], zip.read(argv[i]));
+            return 0;
+        }
+        for (const pwb::ZipEntry& e : zip.entries()) {
+            if (pwb::ends_with(e.name, ".gbr")) describe(std::string(e.basename()), zip.read(e));
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "gerber_dump: %s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+// Renders Gerber layers of a CAM package to PGM coverage images.
+//
+//   gerber_render [--pixel-um N] [--out DIR] [archive.zip] [member...]
+
+#include "pwb/gerber.hpp"
+#include "pwb/raster.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::string path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    std::string out_dir = ".";
+    std::vector<std::string> members;
+    pwb::raster::Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--pixel-um") && i + 1 < argc) options.pixel = std::llround(std::atof(argv[++i]) * 1000);
+        else if (!std::strcmp(argv[i], "--out") && i + 1 < argc) out_dir = argv[++i];
+        else if (std::strstr(argv[i], ".zip")) path = argv[i];
+        else members.push_back(argv[i]);
+    }
+    try {
+        pwb::ZipArchive zip(path);
+        if (members.empty()) {
+            for (const pwb::ZipEntry& e : zip.entries())
+                if (e.name.size() > 4 && e.name.compare(e.name.size() - 4, 4, ".gbr") == 0) members.emplace_back(e.basename());
+        }
+        for (const std::string& m : members) {
+            pwb::gerber::Layer layer = pwb::gerber::parse(zip.read(m));
+            auto t0 = std::chrono::steady_clock::now();
+            pwb::raster::Bitmap bmp = pwb::raster::rasterise(layer, options);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            if (bmp.width == 0) {
+                std::printf("%-24s empty\n", m.c_str());
+                continue;
+            }
+            std::string out = out_dir + "/" + m.substr(0, m.rfind('.')) + ".pgm";
+            bmp.write_pgm(out);
+            std::printf("%-24s %6d x %-6d %8.2f ms  -> %s\n", m.c_str(), bmp.width, bmp.height, ms, out.c_str());
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "gerber_render: %s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
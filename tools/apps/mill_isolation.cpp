@@ -0,0 +1,159 @@
+// Isolation-milling G-code for a home-made board, from the copper layers of a
+// CAM package: a few concentric passes around every net, loops ordered to keep
+// rapids short. The bottom file is mirrored for milling after flipping the
+// board over its vertical axis.
+//
+// Nets the first pass cannot separate are named from the EAGLE board on
+// stderr and the exit status is 3: the G-code is still written, but it leaves
+// them bridged. --allow-shorts exits 0 anyway.
+//
+//   mill_isolation [--tool-mm N] [--passes N] [--overlap F] [--depth-mm N] [--feed N] [--conventional]
+//                  [--allow-shorts] [--out DIR] [cam.zip] [board.brd]
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+#include "pwb/isolation.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pwb::gerber::PolygonSet;
+
+PolygonSet merged_layer(const pwb::gerber::Layer& layer, pwb::gerber::Coord tolerance) {
+    std::vector<PolygonSet> levels = pwb::gerber::layer_outlines(layer, tolerance);
+    std::vector<bool> clear;
+    for (const pwb::gerber::Level& l : layer.levels) clear.push_back(l.polarity == pwb::gerber::Polarity::Clear);
+    return pwb::poly::flatten(levels, clear);
+}
+
+// EAGLE signals with a pad, via or wire on `side` (kTop/kBottom) inside `island`.
+std::set<std::string> signals_in(const pwb::eagle::Board& b, int side, const pwb::copper::Island& island) {
+    std::set<std::string> out;
+    auto mark = [&](const std::string& net, int layer, double x, double y) {
+        if (layer != 0 && layer != side) return;
+        const double nx = x * 1e6, ny = y * 1e6;
+        const pwb::gerber::Box& box = island.box;
+        if (nx < double(box.min_x) || nx > double(box.max_x) || ny < double(box.min_y) || ny > double(box.max_y)) return;
+        if (island.contains(nx, ny)) out.insert(net);
+    };
+    for (const pwb::eagle::Signal& s : b.signals) {
+        for (const pwb::eagle::Wire& w : s.wires) mark(s.name, w.layer, (w.x1 + w.x2) / 2, (w.y1 + w.y2) / 2);
+        for (const pwb::eagle::Via& v : s.vias) mark(s.name, 0, v.x, v.y);
+        for (const pwb::eagle::ContactRef& c : s.contacts) {
+            const pwb::eagle::Element* e = b.element(c.element);
+            const pwb::eagle::Package* pkg = e ? b.package_of(*e) : nullptr;
+            if (!pkg) continue;
+            pwb::eagle::Placement at = pwb::eagle::placement(*e);
+            double x, y;
+            for (const pwb::eagle::Pad& p : pkg->pads)
+                if (p.name == c.pad) at.apply(p.x, p.y, x, y), mark(s.name, 0, x, y);
+            for (const pwb::eagle::Smd& p : pkg->smds)
+                if (p.name == c.pad) at.apply(p.x, p.y, x, y), mark(s.name, at.layer(p.layer), x, y);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string zip_path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    std::string board_path = PWB_REPO_ROOT "/PCB/deprecated/PCB_photogate_ESPWROOM32/schematic.brd";
+    std::string out_dir = "mill_out";
+    bool allow_shorts = false;
+    pwb::mill::Options options;
+    pwb::mill::Machine machine;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--tool-mm" && i + 1 < argc) options.tool_width = std::llround(std::atof(argv[++i]) * 1e6);
+        else if (a == "--passes" && i + 1 < argc) options.passes = std::atoi(argv[++i]);
+        else if (a == "--overlap" && i + 1 < argc) options.overlap = std::atof(argv[++i]);
+        else if (a == "--depth-mm" && i + 1 < argc) machine.cut_depth = std::atof(argv[++i]);
+        else if (a == "--feed" && i + 1 < argc) machine.feed = std::atof(argv[++i]);
+        else if (a == "--conventional") options.climb = false;
+        else if (a == "--allow-shorts") allow_shorts = true;
+        else if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+        else if (pwb::ends_with(a, ".brd")) board_path = a;
+        else if (!a.empty() && a[0] != '-') zip_path = a;
+        else {
+            std::fprintf(stderr, "usage: mill_isolation [--tool-mm N] [--passes N] [--overlap F] [--depth-mm N] "
+                                 "[--feed N] [--conventional] [--allow-shorts] [--out DIR] [cam.zip] [board.brd]\n");
+            return 2;
+        }
+    }
+
+    try {
+        pwb::ZipArchive zip(zip_path);
+        pwb::gerber::Layer profile = pwb::gerber::parse(zip.read("profile.gbr"));
+        pwb::gerber::Box board;
+        for (const pwb::gerber::Stroke& st : profile.strokes) board.add(st.x0, st.y0), board.add(st.x1, st.y1);
+        std::filesystem::create_directories(out_dir);
+
+        std::printf("tool %.3f mm, %d passes, %.0f%% overlap, %.3f mm deep at %.0f mm/min\n",
+                    double(options.tool_width) / pwb::gerber::kNmPerMm, options.passes, options.overlap * 100,
+                    machine.cut_depth, machine.feed);
+        std::printf("%-7s %5s %8s %6s %10s %18s %9s %9s\n", "side", "nets", "shorted", "loops", "cut mm",
+                    "rapid mm (naive)", "time", "ms");
+        const char* sides[2] = {"top", "bottom"};
+        std::vector<std::string> shorts;
+        pwb::eagle::Board eagle;
+        bool named = true;
+        try {
+            eagle = pwb::eagle::load_board(board_path);
+        } catch (const std::exception& ex) {
+            std::fprintf(stderr, "mill_isolation: %s; shorted nets left unnamed\n", ex.what());
+            named = false;
+        }
+        for (int s = 0; s < 2; ++s) {
+            auto t0 = std::chrono::steady_clock::now();
+            pwb::gerber::Layer layer = pwb::gerber::parse(zip.read(std::string("copper_") + sides[s] + ".gbr"));
+            pwb::mill::Plan plan = pwb::mill::isolate(merged_layer(layer, options.tolerance), options);
+            std::string path = out_dir + "/isolation_" + sides[s] + ".gcode";
+            std::ofstream out(path, std::ios::binary);
+            if (!(out << pwb::mill::write_gcode(plan, machine, board, s == 1, std::string("copper_") + sides[s] + ".gbr")))
+                throw std::runtime_error("cannot write " + path);
+            for (const std::vector<std::uint32_t>& group : plan.shorts) {
+                std::set<std::string> names;
+                for (std::uint32_t i : group)
+                    if (named)
+                        for (const std::string& n : signals_in(eagle, s ? pwb::eagle::kBottom : pwb::eagle::kTop, plan.islands[i]))
+                            names.insert(n);
+                const pwb::gerber::Box& at = plan.islands[group.front()].box;
+                std::string line = std::string(sides[s]) + ": " + std::to_string(group.size()) + " nets bridged near (" +
+                                   std::to_string(int(std::lround(double(at.min_x) / 1e6))) + ", " +
+                                   std::to_string(int(std::lround(double(at.min_y) / 1e6))) + ") mm:";
+                for (const std::string& n : names) line += " " + n;
+                if (names.empty()) line += " (no signal found)";
+                shorts.push_back(line);
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            double minutes = pwb::mill::estimate_seconds(plan, machine) / 60;
+            std::printf("%-7s %5zu %8zu %6zu %10.1f %8.1f (%7.1f) %5.0f min %9.1f\n", sides[s], plan.nets, plan.shorted,
+                        plan.loops.size(), plan.cut_mm, plan.rapid_mm, plan.naive_rapid_mm, minutes, ms);
+        }
+        std::printf("wrote %s/isolation_top.gcode and isolation_bottom.gcode (bottom mirrored in x)\n", out_dir.c_str());
+        if (shorts.empty()) return 0;
+        std::fprintf(stderr, "mill_isolation: the first pass cannot separate these nets; the G-code leaves them "
+                             "bridged (smaller --tool-mm, or fix by hand):\n");
+        for (const std::string& line : shorts) std::fprintf(stderr, "  %s\n", line.c_str());
+        return allow_shorts ? 0 : 3;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "mill_isolation: %s\n", ex.what());
+        return 1;
+    }
+}
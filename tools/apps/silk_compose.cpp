@@ -0,0 +1,217 @@
+// Adds bitmap logos and stroke-font text to the silkscreen layers of a CAM
+// package. Logos are traced into Gerber regions; items without a position are
+// placed in the emptiest spot of the board away from legend ink and pads.
+//
+//   silk_compose [--out DIR] [--invert] [--threshold N|otsu] [--clearance-mm N]
+//                [--top | --bottom] [--logo FILE,WIDTH_MM[,X,Y]] [--text TEXT,HEIGHT_MM[,X,Y]] ... [cam.zip]
+//
+// --top/--bottom apply to the items that follow. With no items the UFSCar and
+// CCA logos from images/ go on the top side.
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+#include "pwb/image.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/silkscreen.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pwb::gerber::Coord;
+using pwb::gerber::PolygonSet;
+
+struct Item {
+    bool logo = false;
+    bool bottom = false;
+    std::string source; // image path or text
+    double size_mm = 0; // logo width or text height
+    bool placed = false;
+    double x_mm = 0, y_mm = 0;
+};
+
+bool is_number(const std::string& s) {
+    char* end = nullptr;
+    std::strtod(s.c_str(), &end);
+    return !s.empty() && end == s.c_str() + s.size();
+}
+
+// "name,size[,x,y]" where name may itself contain commas.
+Item parse_item(const std::string& spec, bool logo, bool bottom) {
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+    for (;;) {
+        std::size_t comma = spec.find(',', start);
+        parts.push_back(spec.substr(start, comma - start));
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    Item item;
+    item.logo = logo;
+    item.bottom = bottom;
+    std::size_t n = parts.size();
+    if (n >= 4 && is_number(parts[n - 1]) && is_number(parts[n - 2]) && is_number(parts[n - 3])) {
+        item.placed = true;
+        item.x_mm = std::atof(parts[n - 2].c_str());
+        item.y_mm = std::atof(parts[n - 1].c_str());
+        n -= 2;
+    }
+    if (n < 2 || !is_number(parts[n - 1])) throw std::runtime_error("bad item '" + spec + "': expected NAME,SIZE_MM[,X,Y]");
+    item.size_mm = std::atof(parts[n - 1].c_str());
+    for (std::size_t i = 0; i + 1 < n; ++i) item.source += (i ? "," : "") + parts[i];
+    return item;
+}
+
+PolygonSet merged_layer(const pwb::gerber::Layer& layer) {
+    std::vector<PolygonSet> levels = pwb::gerber::layer_outlines(layer, 5000);
+    std::vector<bool> clear;
+    for (const pwb::gerber::Level& l : layer.levels) clear.push_back(l.polarity == pwb::gerber::Polarity::Clear);
+    return pwb::poly::flatten(levels, clear);
+}
+
+void append(PolygonSet& to, const PolygonSet& from) {
+    for (std::size_t k = 0; k < from.size(); ++k) {
+        to.points.insert(to.points.end(), from.begin(k), from.begin(k) + from.count(k));
+        to.close();
+    }
+}
+
+double mm(Coord v) { return double(v) / pwb::gerber::kNmPerMm; }
+Coord nm(double v) { return std::llround(v * pwb::gerber::kNmPerMm); }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string zip_path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    std::string out_dir = "silk_out";
+    pwb::silk::TraceOptions trace;
+    double clearance_mm = 0.5;
+    bool bottom = false;
+    std::string threshold; // grey level, "otsu", or empty for paper - 40
+    std::vector<Item> items;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+            else if (a == "--invert") trace.dark_ink = false;
+            else if (a == "--threshold" && i + 1 < argc) threshold = argv[++i];
+            else if (a == "--clearance-mm" && i + 1 < argc) clearance_mm = std::atof(argv[++i]);
+            else if (a == "--top") bottom = false;
+            else if (a == "--bottom") bottom = true;
+            else if (a == "--logo" && i + 1 < argc) items.push_back(parse_item(argv[++i], true, bottom));
+            else if (a == "--text" && i + 1 < argc) items.push_back(parse_item(argv[++i], false, bottom));
+            else if (!a.empty() && a[0] != '-') zip_path = a;
+            else {
+                std::fprintf(stderr, "usage: silk_compose [--out DIR] [--invert] [--threshold N|otsu] [--clearance-mm N] "
+                                     "[--top | --bottom] [--logo FILE,WIDTH_MM[,X,Y]] [--text TEXT,HEIGHT_MM[,X,Y]] ... [cam.zip]\n");
+                return 2;
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "silk_compose: %s\n", ex.what());
+        return 2;
+    }
+    if (items.empty()) {
+        items.push_back(parse_item(PWB_REPO_ROOT "/images/ufscar_logo_128x32.jpg,14", true, false));
+        items.push_back(parse_item(PWB_REPO_ROOT "/images/cca_logo_128x32.jpg,14", true, false));
+    }
+
+    try {
+        auto t0 = std::chrono::steady_clock::now();
+        pwb::ZipArchive zip(zip_path);
+        const char* side_name[2] = {"top", "bottom"};
+        std::string silk_text[2];
+        pwb::gerber::Layer silk[2];
+        PolygonSet occupied[2];
+        for (int s = 0; s < 2; ++s) {
+            silk_text[s] = zip.read(std::string("silkscreen_") + side_name[s] + ".gbr");
+            silk[s] = pwb::gerber::parse(silk_text[s]);
+            occupied[s] = merged_layer(silk[s]);
+            if (const pwb::ZipEntry* mask = zip.find(std::string("soldermask_") + side_name[s] + ".gbr"))
+                append(occupied[s], merged_layer(pwb::gerber::parse(zip.read(*mask))));
+        }
+        pwb::gerber::Layer profile = pwb::gerber::parse(zip.read("profile.gbr"));
+        pwb::gerber::Box board;
+        for (const pwb::gerber::Stroke& st : profile.strokes) board.add(st.x0, st.y0), board.add(st.x1, st.y1);
+
+        pwb::silk::GlyphCache glyphs;
+        PolygonSet added[2];
+        std::size_t naive_bytes = 0;
+        for (Item& item : items) {
+            const int s = item.bottom ? 1 : 0;
+            PolygonSet art;
+            Coord w, h;
+            std::size_t traced = 0;
+            pwb::image::Gray image;
+            if (item.logo) {
+                image = pwb::image::load(item.source);
+                if (threshold == "otsu") trace.threshold = pwb::image::otsu_threshold(image);
+                else if (!threshold.empty()) trace.threshold = std::atoi(threshold.c_str());
+                pwb::silk::Artwork a = pwb::silk::vectorise(image, nm(item.size_mm), trace);
+                art = std::move(a.outline);
+                w = a.width, h = a.height, traced = a.traced_vertices;
+            } else {
+                pwb::silk::TextStyle style;
+                style.height = nm(item.size_mm);
+                art = pwb::silk::text_outline(glyphs, item.source, 0, style.height * 2 / 6, style);
+                w = pwb::silk::text_width(item.source, style.height), h = style.height * 8 / 6;
+            }
+            Coord x = nm(item.x_mm), y = nm(item.y_mm);
+            if (!item.placed && !pwb::silk::find_free_spot(pwb::poly::merge(occupied[s]), board, w, h, nm(clearance_mm), x, y))
+                throw std::runtime_error("no free room for " + item.source + " on the " + side_name[s] + " side");
+            // Bottom legend is seen through the board, so it is mirrored in the file.
+            PolygonSet placed = pwb::silk::transform(art, item.bottom ? x + w : x, y, 0, item.bottom);
+            append(added[s], placed);
+            PolygonSet box;
+            box.points = {{x, y}, {x + w, y}, {x + w, y + h}, {x, y + h}};
+            box.close();
+            append(occupied[s], box);
+
+            std::printf("%-6s %-4s %-28s %6.2f x %5.2f mm at (%.2f, %.2f)%s  %zu contours, %zu vertices",
+                        side_name[s], item.logo ? "logo" : "text",
+                        std::filesystem::path(item.source).filename().string().c_str(), mm(w), mm(h), mm(x), mm(y),
+                        item.placed ? "" : " auto", placed.size(), placed.points.size());
+            if (item.logo) {
+                Coord pixel = w / image.width;
+                std::string naive = pwb::silk::pixel_flashes(image, pixel, x, y, silk[s].format, silk[s].units, 999, trace);
+                std::string regions = pwb::silk::region_block(placed, silk[s].format, silk[s].units);
+                naive_bytes += naive.size();
+                std::printf(" (traced %zu), %zu bytes vs %zu as pixel flashes", traced, regions.size(), naive.size());
+            }
+            std::printf("\n");
+        }
+
+        std::filesystem::create_directories(out_dir);
+        for (int s = 0; s < 2; ++s) {
+            if (added[s].size() == 0) continue;
+            PolygonSet ink = pwb::poly::merge(added[s]);
+            std::string block = pwb::silk::region_block(ink, silk[s].format, silk[s].units);
+            std::string text = pwb::silk::append_to_layer(silk_text[s], block);
+            // Round trip through the parser so a broken file never leaves the tool.
+            pwb::gerber::Layer check = pwb::gerber::parse(text);
+            std::string path = out_dir + "/silkscreen_" + side_name[s] + ".gbr";
+            std::ofstream(path, std::ios::binary) << text;
+            std::printf("wrote %s: +%zu regions, +%zu bytes (%.3f mm2 of ink)\n", path.c_str(),
+                        check.regions.size() - silk[s].regions.size(), block.size(), pwb::poly::area(ink) * 1e-12);
+        }
+        if (glyphs.hits() + glyphs.misses())
+            std::printf("glyph cache: %zu outlines built, %zu reused\n", glyphs.misses(), glyphs.hits());
+        if (naive_bytes) std::printf("per-pixel flashes would have added %zu bytes\n", naive_bytes);
+        std::printf("%.1f ms\n", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "silk_compose: %s\n", ex.what());
+        return 1;
+    }
+}
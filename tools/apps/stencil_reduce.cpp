@@ -0,0 +1,133 @@
+// Reduces the paste apertures of a CAM package for a laser-cut stencil: each
+// pad is matched to its part in the EAGLE board and reshaped by the package's
+// rule (home plate for 0805 chips, window pane for big thermal tabs), then
+// written as a new paste Gerber and an SVG for the cutter.
+//
+//   stencil_reduce [--side top|bottom] [--thickness-mm N] [--out DIR] [cam.zip] [board.brd]
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/gerber.hpp"
+#include "pwb/stencil.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* shape_name(pwb::stencil::Shape s) {
+    switch (s) {
+    case pwb::stencil::Shape::Inset: return "inset";
+    case pwb::stencil::Shape::HomePlate: return "home plate";
+    case pwb::stencil::Shape::WindowPane: return "window pane";
+    }
+    return "?";
+}
+
+void write_file(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.write(data.data(), std::streamsize(data.size()))) throw std::runtime_error("cannot write " + path);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string zip_path = PWB_REPO_ROOT "/PCB/deprecated/gerber/gerber_espwroom32.zip";
+    std::string board_path = PWB_REPO_ROOT "/PCB/deprecated/PCB_photogate_ESPWROOM32/schematic.brd";
+    std::string out_dir = "stencil_out";
+    std::string side = "top";
+    double thickness = 0.12;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--side" && i + 1 < argc) side = argv[++i];
+        else if (a == "--thickness-mm" && i + 1 < argc) thickness = std::atof(argv[++i]);
+        else if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+        else if (!a.empty() && a[0] != '-' && pwb::ends_with(a, ".brd")) board_path = a;
+        else if (!a.empty() && a[0] != '-') zip_path = a;
+        else {
+            std::fprintf(stderr, "usage: stencil_reduce [--side top|bottom] [--thickness-mm N] [--out DIR] [cam.zip] [board.brd]\n");
+            return 2;
+        }
+    }
+    if (side != "top" && side != "bottom") {
+        std::fprintf(stderr, "stencil_reduce: --side must be top or bottom\n");
+        return 2;
+    }
+
+    try {
+        auto t0 = std::chrono::steady_clock::now();
+        pwb::ZipArchive zip(zip_path);
+        pwb::gerber::Layer paste = pwb::gerber::parse(zip.read("solderpaste_" + side + ".gbr"));
+        pwb::gerber::Layer profile = pwb::gerber::parse(zip.read("profile.gbr"));
+        pwb::gerber::Box board_box;
+        for (const pwb::gerber::Stroke& st : profile.strokes) board_box.add(st.x0, st.y0), board_box.add(st.x1, st.y1);
+        pwb::eagle::Board board = pwb::eagle::load_board(board_path);
+        const bool bottom = side == "bottom";
+
+        std::vector<pwb::stencil::Pad> pads = pwb::stencil::paste_pads(paste, &board, bottom ? pwb::eagle::kBottom : pwb::eagle::kTop);
+        std::vector<pwb::stencil::Rule> rules = pwb::stencil::default_rules();
+        auto t1 = std::chrono::steady_clock::now();
+        pwb::stencil::Result result = pwb::stencil::reduce(pads, rules, thickness);
+        double reduce_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t1).count();
+
+        // One line per package and rule.
+        struct Row {
+            std::vector<std::string> parts;
+            std::size_t pads = 0, openings = 0;
+            double pad_area = 0, paste_area = 0, min_ratio = 1e300;
+        };
+        std::map<std::string, Row> rows;
+        std::size_t unmatched = 0;
+        for (std::size_t i = 0; i < pads.size(); ++i) {
+            const pwb::stencil::PadResult& pr = result.pads[i];
+            if (pads[i].element.empty()) ++unmatched;
+            std::string key = (pads[i].package.empty() ? "?" : pads[i].package) + "  " +
+                              (pr.rule < 0 ? "1:1" : shape_name(rules[std::size_t(pr.rule)].shape));
+            Row& r = rows[key];
+            if (!pads[i].element.empty() && (r.parts.empty() || r.parts.back() != pads[i].element))
+                r.parts.push_back(pads[i].element);
+            ++r.pads;
+            r.openings += pr.openings;
+            r.pad_area += pr.pad_area;
+            r.paste_area += pr.paste_area;
+            r.min_ratio = std::min(r.min_ratio, pr.area_ratio);
+        }
+        std::printf("%s paste: %zu pads, %zu not matched to a part; %.2f mm stencil\n", side.c_str(), pads.size(),
+                    unmatched, thickness);
+        std::printf("%-32s %5s %9s %9s %9s %8s %7s  %s\n", "package  rule", "pads", "openings", "pad mm2", "paste mm2",
+                    "paste %", "min AR", "parts");
+        for (const auto& [key, r] : rows) {
+            std::string parts;
+            for (std::size_t k = 0; k < r.parts.size(); ++k) parts += (k ? " " : "") + r.parts[k];
+            std::printf("%-32s %5zu %9zu %9.2f %9.2f %7.1f%% %6.2f%s  %s\n", key.c_str(), r.pads, r.openings, r.pad_area,
+                        r.paste_area, r.pad_area > 0 ? 100 * r.paste_area / r.pad_area : 0.0, r.min_ratio,
+                        r.min_ratio < 0.66 ? "!" : " ", parts.c_str());
+        }
+
+        std::filesystem::create_directories(out_dir);
+        std::string gbr = pwb::stencil::paste_gerber(result.apertures, paste.name + " (reduced)", paste.format, paste.units);
+        // Round trip through the parser so a broken file never leaves the tool.
+        pwb::gerber::Layer check = pwb::gerber::parse(gbr);
+        std::string gbr_path = out_dir + "/solderpaste_" + side + "_reduced.gbr";
+        std::string svg_path = out_dir + "/stencil_" + side + ".svg";
+        write_file(gbr_path, gbr);
+        write_file(svg_path, pwb::stencil::svg(result.apertures, board_box, &profile, bottom));
+        std::printf("wrote %s (%zu regions) and %s\n", gbr_path.c_str(), check.regions.size(), svg_path.c_str());
+        std::printf("reduce: %.1f us for %zu openings; total %.1f ms\n", reduce_us, result.apertures.size(),
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stencil_reduce: %s\n", ex.what());
+        return 1;
+    }
+}
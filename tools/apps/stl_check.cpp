@@ -0,0 +1,90 @@
+// Printability check for STL parts: open and non-manifold edges, flipped
+// faces and self-intersections, one report per file. Exits with 1 if any
+// part would make the slicer guess.
+//
+//   stl_check [--tolerance N] [--no-intersections] [file.stl | archive.zip] ...
+//
+// With no files it checks the Photogate and shield halves under STL/fdm.
+
+#include "pwb/mesh_check.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool report(const std::string& name, const pwb::stl::TriangleView& tris, const pwb::mesh::CheckOptions& options) {
+    auto t0 = std::chrono::steady_clock::now();
+    pwb::mesh::CheckReport r = pwb::mesh::check(tris, options);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    const char* verdict = r.printable() ? "OK" : r.watertight() ? "FIX" : "FAIL";
+    std::printf("%-4s %s\n", verdict, name.c_str());
+    std::printf("     %zu triangles, %zu vertices, %zu edges, %zu shell%s, volume %.1f", r.triangles, r.vertices, r.edges,
+                r.shells, r.shells == 1 ? "" : "s", r.volume);
+    if (r.shells == 1 && r.watertight()) std::printf(", genus %d", r.genus);
+    std::printf("\n");
+    std::printf("     open edges %zu, non-manifold %zu, misoriented %zu, inverted shells %zu, degenerate %zu\n",
+                r.open_edges, r.nonmanifold_edges, r.misoriented_edges, r.inverted_shells, r.degenerate);
+    if (r.stored_normals_flipped)
+        std::printf("     %zu stored facet normals disagree with the winding (slicers ignore them)\n", r.stored_normals_flipped);
+    if (options.self_intersections) {
+        std::printf("     self-intersecting pairs %zu", r.intersecting_pairs);
+        for (const auto& [a, b] : r.examples) std::printf(" (%u, %u)", a, b);
+        std::printf("\n");
+    }
+    std::printf("     %.2f ms: weld %.2f, topology %.2f, intersections %.2f\n", ms, r.weld_seconds * 1e3,
+                r.topology_seconds * 1e3, r.intersect_seconds * 1e3);
+    return r.printable();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    pwb::mesh::CheckOptions options;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--tolerance" && i + 1 < argc) options.weld_tolerance = float(std::atof(argv[++i]));
+        else if (a == "--no-intersections") options.self_intersections = false;
+        else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else {
+            std::fprintf(stderr, "usage: stl_check [--tolerance N] [--no-intersections] [file.stl | archive.zip] ...\n");
+            return 2;
+        }
+    }
+    if (paths.empty()) {
+        for (const char* p : {"/STL/fdm/Photogate_Top.stl", "/STL/fdm/Photogate_Bottom.stl",
+                              "/STL/fdm/shield_design/Shield_Top_V1.stl", "/STL/fdm/shield_design/Shield_Bottom_V1.stl"})
+            paths.push_back(std::string(PWB_REPO_ROOT) + p);
+    }
+
+    bool ok = true;
+    try {
+        for (const std::string& path : paths) {
+            if (pwb::ends_with(path, ".zip")) {
+                pwb::ZipArchive zip(path);
+                for (const pwb::ZipEntry& e : zip.entries()) {
+                    if (!pwb::ends_with(e.name, ".stl")) continue;
+                    std::string data = zip.read(e);
+                    pwb::stl::View v = pwb::stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), e.name);
+                    ok &= report(path + ":" + e.name, v.triangles, options);
+                }
+            } else {
+                pwb::stl::File f(path);
+                ok &= report(path, f.triangles(), options);
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_check: %s\n", ex.what());
+        return 2;
+    }
+    return ok ? 0 : 1;
+}
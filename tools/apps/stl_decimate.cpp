@@ -0,0 +1,101 @@
+// Reduces binary STL parts with quadric edge collapse for quick previews,
+// packs the result into the quantised PWBQ format and reports how far the
+// unpacked preview strays from the original (symmetric Hausdorff distance,
+// sampled at about 1/200 of the part's diagonal).
+//
+//   stl_decimate [--triangles N | --ratio F] [--error MM] [--bits B] [--threads N] [--out DIR] [part.stl ...]
+//
+// With no parts it reduces the Photogate and shield halves to 10 %.
+
+#include "pwb/lod.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/surface_distance.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    pwb::lod::Options options;
+    std::size_t triangles = 0;
+    double ratio = 0.1;
+    int bits = 16;
+    unsigned threads = 0;
+    std::string out_dir;
+    std::vector<std::string> paths;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_decimate [--triangles N | --ratio F] [--error MM] [--bits B] [--threads N] "
+                             "[--out DIR] [part.stl ...]\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10), ratio = 0;
+        else if (a == "--ratio" && i + 1 < argc) ratio = std::atof(argv[++i]), triangles = 0;
+        else if (a == "--error" && i + 1 < argc) options.max_error = std::atof(argv[++i]);
+        else if (a == "--bits" && i + 1 < argc) bits = std::atoi(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) threads = unsigned(std::atoi(argv[++i]));
+        else if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+        else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else return usage();
+    }
+    if (ratio < 0 || ratio > 1 || bits < 1 || bits > 16 || options.max_error < 0) return usage();
+    if (paths.empty())
+        for (const char* p : {"STL/fdm/Photogate_Top.stl", "STL/fdm/Photogate_Bottom.stl",
+                              "STL/fdm/shield_design/Shield_Top_V1.stl", "STL/fdm/shield_design/Shield_Bottom_V1.stl"})
+            paths.push_back(std::string(PWB_REPO_ROOT) + "/" + p);
+
+    try {
+        if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+        for (const std::string& path : paths) {
+            const pwb::stl::File file(path);
+            const pwb::mesh::Mesh mesh = pwb::mesh::weld(file.triangles());
+            pwb::lod::Options o = options;
+            o.target_triangles = triangles ? triangles : std::size_t(std::llround(ratio * double(mesh.triangles.size())));
+            pwb::lod::Stats s;
+            const pwb::mesh::Mesh reduced = pwb::lod::decimate(mesh, o, &s);
+            const std::string packed = pwb::lod::pack(reduced, bits);
+            const pwb::mesh::Mesh preview = pwb::lod::unpack(packed);
+
+            pwb::stl::Vec3 lo = mesh.vertices.empty() ? pwb::stl::Vec3{} : mesh.vertices[0], hi = lo;
+            for (const pwb::stl::Vec3& v : mesh.vertices) {
+                lo = {std::min(lo.x, v.x), std::min(lo.y, v.y), std::min(lo.z, v.z)};
+                hi = {std::max(hi.x, v.x), std::max(hi.y, v.y), std::max(hi.z, v.z)};
+            }
+            const double diagonal = std::hypot(double(hi.x) - lo.x, double(hi.y) - lo.y, double(hi.z) - lo.z);
+            const pwb::dist::Hausdorff h = pwb::dist::hausdorff(mesh, preview, float(diagonal / 200), threads);
+
+            const std::string name = path.substr(path.find_last_of("/\\") + 1);
+            const std::size_t stl_bytes = 84 + 50 * mesh.triangles.size();
+            std::printf("%s\n", name.c_str());
+            std::printf("  triangles  %zu -> %zu (%.1f %%), vertices %zu -> %zu\n", mesh.triangles.size(),
+                        reduced.triangles.size(), 100.0 * double(reduced.triangles.size()) / double(mesh.triangles.size()),
+                        mesh.vertices.size(), reduced.vertices.size());
+            std::printf("  collapses  %zu in %.1f ms, %zu stale heap entries, %zu rejected, bound %.4f mm\n",
+                        s.collapses, s.seconds * 1e3, s.stale, s.rejected, s.error);
+            std::printf("  size       %zu bytes STL -> %zu bytes PWBQ (%d-bit, 1:%.0f)\n", stl_bytes, packed.size(), bits,
+                        double(stl_bytes) / double(packed.size()));
+            std::printf("  hausdorff  %.4f mm max (%.4f / %.4f), mean %.4f, rms %.4f; %zu samples in %.1f ms\n",
+                        h.max(), h.forward, h.backward, h.mean, h.rms, h.samples, h.seconds * 1e3);
+            if (!out_dir.empty()) {
+                const std::string out_path = out_dir + "/" + name.substr(0, name.find_last_of('.')) + ".pwbq";
+                std::ofstream out(out_path, std::ios::binary);
+                if (!out.write(packed.data(), std::streamsize(packed.size())))
+                    throw std::runtime_error("cannot write " + out_path);
+                std::printf("  wrote      %s\n", out_path.c_str());
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_decimate: %s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
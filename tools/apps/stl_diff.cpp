@@ -0,0 +1,189 @@
+// Geometric diff between two revisions of a part: aligns the newer mesh onto
+// the older one by trimmed point-to-plane ICP, measures the signed distance
+// of every vertex and of a dense surface sampling to the other revision,
+// groups what moved into regions and writes the newer mesh as a
+// colour-mapped PLY (red where material was added, blue where removed).
+//
+//   stl_diff [--tolerance MM] [--range MM] [--no-align] [--threads N] [--out DIR] [old new]
+//
+// Each mesh is a file.stl or archive.zip:member (read in memory). With no
+// meshes it walks the Photogate housing revisions, V1 -> V2 -> V3 from
+// STL/fdm/deprecated.zip and on to the current STL/fdm parts.
+
+#include "pwb/mesh.hpp"
+#include "pwb/mesh_diff.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/surface_distance.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// "file.stl" or "archive.zip:member".
+pwb::mesh::Mesh load(const std::string& spec) {
+    const std::size_t colon = spec.find(".zip:");
+    if (colon == std::string::npos) return pwb::mesh::weld(pwb::stl::File(spec).triangles());
+    const pwb::ZipArchive zip(spec.substr(0, colon + 4));
+    const std::string member = spec.substr(colon + 5);
+    for (const pwb::ZipEntry& e : zip.entries())
+        if (e.name == member) {
+            const std::string data = zip.read(e);
+            return pwb::mesh::weld(pwb::stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), spec).triangles);
+        }
+    throw std::runtime_error(spec + ": no such member");
+}
+
+std::string stem(const std::string& spec) {
+    std::string s = spec.substr(spec.find_last_of("/\\:") + 1);
+    return s.substr(0, s.find_last_of('.'));
+}
+
+struct Revision {
+    std::string label; // "V1"
+    std::string spec;
+};
+
+struct Settings {
+    float tolerance = 0.05f;
+    float range = 0; // 0 = from the data
+    bool align = true;
+    unsigned threads = 0;
+    std::string out_dir = ".";
+};
+
+void compare(const std::string& part, const Revision& a, const Revision& b, const Settings& s) {
+    using namespace pwb;
+    const auto t0 = std::chrono::steady_clock::now();
+    const mesh::Mesh old_mesh = load(a.spec), new_mesh = load(b.spec);
+    const diff::Target old_target(old_mesh, s.threads);
+    diff::IcpOptions icp;
+    icp.threads = s.threads;
+    diff::Alignment fit;
+    if (s.align) fit = diff::align(new_mesh, old_target, icp);
+    const mesh::Mesh moved = diff::transformed(new_mesh, fit.transform);
+    const diff::Target new_target(moved, s.threads);
+
+    // Both surfaces sampled, each against the other; signs follow the newer
+    // part, so an old surface left outside the new one counts as removed.
+    stl::Vec3 lo = moved.vertices[0], hi = lo;
+    for (const stl::Vec3& v : moved.vertices) {
+        lo = {std::min(lo.x, v.x), std::min(lo.y, v.y), std::min(lo.z, v.z)};
+        hi = {std::max(hi.x, v.x), std::max(hi.y, v.y), std::max(hi.z, v.z)};
+    }
+    const float spacing = std::hypot(hi.x - lo.x, hi.y - lo.y, hi.z - lo.z) / 400;
+    const double cell = double(spacing) * spacing; // mm^2 per sample
+    std::vector<stl::Vec3> points = dist::sample_area(moved, spacing);
+    std::vector<float> d = diff::signed_distances(points, old_target, s.threads);
+    const std::vector<stl::Vec3> old_points = dist::sample_area(old_mesh, spacing);
+    const std::vector<float> old_d = diff::signed_distances(old_points, new_target, s.threads);
+    points.insert(points.end(), old_points.begin(), old_points.end());
+    for (float v : old_d) d.push_back(-v);
+    const std::vector<float> vertex_d = diff::signed_distances(moved.vertices, old_target, s.threads);
+
+    std::size_t same = 0;
+    float added = 0, removed = 0;
+    std::vector<float> beyond;
+    for (float v : d) {
+        if (std::abs(v) <= s.tolerance) ++same;
+        else beyond.push_back(std::abs(v));
+        added = std::max(added, v), removed = std::max(removed, -v);
+    }
+    float range = s.range;
+    if (range <= 0) {
+        range = 4 * s.tolerance;
+        if (!beyond.empty()) {
+            auto at = beyond.begin() + std::ptrdiff_t(0.98 * double(beyond.size() - 1));
+            std::nth_element(beyond.begin(), at, beyond.end());
+            range = std::max(range, *at);
+        }
+    }
+    const std::vector<diff::Region> regions = diff::regions(points, d, s.tolerance, std::max(1.0f, 2 * spacing));
+
+    const std::string path = s.out_dir + "/" + part + "_" + a.label + "-" + b.label + ".ply";
+    const std::string ply = diff::ply(moved, vertex_d, range, s.tolerance);
+    std::ofstream out(path, std::ios::binary);
+    if (!out.write(ply.data(), std::streamsize(ply.size()))) throw std::runtime_error("cannot write " + path);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    const diff::Transform& t = fit.transform;
+    std::printf("%s %s -> %s\n", part.c_str(), a.label.c_str(), b.label.c_str());
+    std::printf("  triangles  %zu -> %zu\n", old_mesh.triangles.size(), new_mesh.triangles.size());
+    if (s.align)
+        std::printf("  alignment  rotation %.3f deg, translation (%.3f, %.3f, %.3f) mm, median |d| %.3f -> %.3f mm, "
+                    "%d iterations, %zu pairs\n",
+                    t.angle(), t.translation[0], t.translation[1], t.translation[2], fit.median_before, fit.median,
+                    fit.iterations, fit.pairs);
+    std::printf("  surface    %.0f + %.0f mm2, %.1f %% within %.2f mm, added up to %.2f mm, removed up to %.2f mm\n",
+                double(d.size() - old_d.size()) * cell, double(old_d.size()) * cell, 100.0 * double(same) / double(d.size()),
+                s.tolerance, added, removed);
+    std::printf("  regions    %zu changed", regions.size());
+    std::printf(regions.empty() ? "\n" : ", largest:\n");
+    for (std::size_t i = 0; i < std::min<std::size_t>(regions.size(), 8); ++i) {
+        const diff::Region& r = regions[i];
+        std::printf("    %8.1f mm2 (%4.1f %%)  %s %5.2f mm  at (%.1f, %.1f, %.1f), %.1f x %.1f x %.1f mm\n",
+                    double(r.samples) * cell, 100.0 * double(r.samples) / double(d.size()),
+                    r.added > 0 ? "added  " : "removed", std::max(r.added, r.removed), 0.5 * (r.min.x + r.max.x),
+                    0.5 * (r.min.y + r.max.y), 0.5 * (r.min.z + r.max.z), r.max.x - r.min.x, r.max.y - r.min.y,
+                    r.max.z - r.min.z);
+    }
+    std::printf("  wrote      %s (full colour at %.2f mm), %.0f ms\n", path.c_str(), range, ms);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings s;
+    std::vector<std::string> specs;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_diff [--tolerance MM] [--range MM] [--no-align] [--threads N] [--out DIR] "
+                             "[old.stl|archive.zip:member new.stl|archive.zip:member]\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--tolerance" && i + 1 < argc) s.tolerance = float(std::atof(argv[++i]));
+        else if (a == "--range" && i + 1 < argc) s.range = float(std::atof(argv[++i]));
+        else if (a == "--no-align") s.align = false;
+        else if (a == "--threads" && i + 1 < argc) s.threads = unsigned(std::atoi(argv[++i]));
+        else if (a == "--out" && i + 1 < argc) s.out_dir = argv[++i];
+        else if (!a.empty() && a[0] != '-') specs.push_back(a);
+        else return usage();
+    }
+    if ((specs.size() != 0 && specs.size() != 2) || s.tolerance <= 0 || s.range < 0) return usage();
+
+    try {
+        std::filesystem::create_directories(s.out_dir);
+        const auto t0 = std::chrono::steady_clock::now();
+        if (specs.size() == 2) {
+            compare(stem(specs[1]), {"old", specs[0]}, {"new", specs[1]}, s);
+        } else {
+            // The inlays (PhotogateV2_Linhas, PhotogateV2_Seta) exist in V2 only.
+            const std::string root = std::string(PWB_REPO_ROOT) + "/STL/fdm/";
+            const std::string zip = root + "deprecated.zip:deprecated/";
+            for (const char* half : {"Top", "Bottom"}) {
+                const std::vector<Revision> chain = {{"V1", zip + "Photogate_" + half + ".stl"},
+                                                     {"V2", zip + "PhotogateV2_" + half + ".stl"},
+                                                     {"V3", zip + "V3/PhotogateV3_" + half + ".stl"},
+                                                     {"atual", root + "Photogate_" + half + ".stl"}};
+                for (std::size_t i = 0; i + 1 < chain.size(); ++i)
+                    compare(std::string("Photogate_") + half, chain[i], chain[i + 1], s);
+            }
+        }
+        std::printf("total      %.0f ms\n", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_diff: %s\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,229 @@
+// Draws binary STL parts as first-angle orthographic sheets: front, top and
+// left views with hidden lines dashed, hatched cross-sections and overall
+// dimensions, written as SVG and PDF. Visibility is decided by rays cast to
+// the viewer through a BVH of the part; parts are drawn in parallel.
+//
+//   stl_drawing [--section x|y|z=MM ...] [--plane PX,PY,PZ,NX,NY,NZ ...] [--angle DEG] [--no-hidden]
+//               [--svg | --pdf] [--threads N] [--out DIR] [file.stl | archive.zip | directory] ...
+//
+// Without --section or --plane each part is cut at half its height (A-A) and
+// half its depth (B-B). With no inputs it draws every STL in the repository.
+
+#include "pwb/drawing.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string stem(const std::string& path) {
+    std::string s = path.substr(path.find_last_of("/\\") + 1);
+    return s.substr(0, s.find_last_of('.'));
+}
+
+struct Part {
+    std::string name; // file stem, "<archive>_<member>" for zip members
+    pwb::mesh::Mesh mesh;
+};
+
+void collect(const std::string& path, std::vector<Part>& parts) {
+    namespace fs = std::filesystem;
+    if (fs::is_directory(path)) {
+        std::vector<std::string> found;
+        for (auto it = fs::recursive_directory_iterator(path); it != fs::recursive_directory_iterator(); ++it) {
+            const std::string name = it->path().filename().string();
+            if (it->is_directory() && (name.front() == '.' || name.front() == '_')) {
+                it.disable_recursion_pending(); // .git, build trees
+                continue;
+            }
+            const std::string p = it->path().string();
+            if (it->is_regular_file() && (pwb::ends_with(p, ".stl") || pwb::ends_with(p, ".zip"))) found.push_back(p);
+        }
+        std::sort(found.begin(), found.end());
+        for (const std::string& p : found) collect(p, parts);
+    } else if (pwb::ends_with(path, ".zip")) {
+        const pwb::ZipArchive zip(path);
+        for (const pwb::ZipEntry& e : zip.entries()) {
+            if (e.is_directory() || !pwb::ends_with(e.name, ".stl")) continue;
+            const std::string data = zip.read(e);
+            const pwb::stl::View v = pwb::stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), e.name);
+            parts.push_back({stem(path) + "_" + stem(e.name), pwb::mesh::weld(v.triangles)});
+        }
+    } else {
+        const pwb::stl::File f(path);
+        parts.push_back({stem(path), pwb::mesh::weld(f.triangles())});
+    }
+}
+
+// A cutting plane {p : p . normal = offset} as given on the command line.
+struct Plane {
+    pwb::stl::Vec3 normal;
+    double offset = 0;
+    std::string text; // "z = 12,5"
+};
+
+std::string decimal(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%g", v);
+    std::string s = buf;
+    std::replace(s.begin(), s.end(), '.', ',');
+    return s;
+}
+
+// "z=12.5" looks at the part from above, "y=..." from the front and "x=..."
+// from the left, matching the views.
+bool axis_plane(char axis, double at, Plane& p) {
+    if (axis == 'x') p = {{-1, 0, 0}, -at, ""};
+    else if (axis == 'y') p = {{0, -1, 0}, -at, ""};
+    else if (axis == 'z') p = {{0, 0, 1}, at, ""};
+    else return false;
+    p.text = std::string(1, axis) + " = " + decimal(at);
+    return true;
+}
+
+struct Sheet {
+    pwb::drawing::Page page;
+    std::size_t triangles = 0, edges = 0, rays = 0;
+    double ms = 0;
+};
+
+Sheet draw(const Part& part, const std::vector<Plane>& planes, const pwb::drawing::Options& options) {
+    using namespace pwb;
+    const auto t0 = std::chrono::steady_clock::now();
+    const mesh::HalfEdges he = mesh::half_edges(part.mesh, options.threads);
+    ray::Scene scene;
+    scene.add(part.mesh);
+    scene.build();
+
+    Sheet sheet;
+    const drawing::View front{"VISTA FRONTAL", drawing::project(part.mesh, he, scene, drawing::front(), options)};
+    const drawing::View top{"VISTA SUPERIOR", drawing::project(part.mesh, he, scene, drawing::top(), options)};
+    const drawing::View left{"VISTA LATERAL ESQUERDA", drawing::project(part.mesh, he, scene, drawing::left(), options)};
+
+    std::vector<Plane> cuts = planes;
+    if (cuts.empty() && !part.mesh.vertices.empty()) {
+        stl::Vec3 lo = part.mesh.vertices[0], hi = lo;
+        for (const stl::Vec3& v : part.mesh.vertices) {
+            lo = {std::min(lo.x, v.x), std::min(lo.y, v.y), std::min(lo.z, v.z)};
+            hi = {std::max(hi.x, v.x), std::max(hi.y, v.y), std::max(hi.z, v.z)};
+        }
+        cuts.resize(2);
+        axis_plane('z', std::round(5.0 * (lo.z + hi.z)) / 10, cuts[0]);
+        axis_plane('y', std::round(5.0 * (lo.y + hi.y)) / 10, cuts[1]);
+    }
+    std::vector<drawing::Cut> sections;
+    for (std::size_t i = 0; i < cuts.size(); ++i) {
+        const std::string letter(1, char('A' + i % 26));
+        std::vector<gerber::PolygonSet> r =
+            drawing::sections(part.mesh, drawing::facing(cuts[i].normal), {cuts[i].offset}, options.threads);
+        sections.push_back({letter + "-" + letter, cuts[i].text, std::move(r[0])});
+    }
+    sheet.page = drawing::layout(part.name, front, top, left, sections);
+
+    sheet.triangles = part.mesh.triangles.size();
+    for (const drawing::View* v : {&front, &top, &left})
+        sheet.edges += v->projection.edges, sheet.rays += v->projection.rays;
+    sheet.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return sheet;
+}
+
+void write(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.write(data.data(), std::streamsize(data.size()))) throw std::runtime_error("cannot write " + path);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    pwb::drawing::Options options;
+    std::vector<Plane> planes;
+    bool svg = true, pdf = true;
+    std::string out_dir = ".";
+    std::vector<std::string> paths;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_drawing [--section x|y|z=MM ...] [--plane PX,PY,PZ,NX,NY,NZ ...] [--angle DEG] "
+                             "[--no-hidden]\n"
+                             "                   [--svg | --pdf] [--threads N] [--out DIR] "
+                             "[file.stl | archive.zip | directory] ...\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--section" && i + 1 < argc) {
+            const std::string s = argv[++i];
+            Plane p;
+            if (s.size() < 3 || s[1] != '=' || !axis_plane(char(std::tolower(s[0])), std::atof(s.c_str() + 2), p))
+                return usage();
+            planes.push_back(p);
+        } else if (a == "--plane" && i + 1 < argc) {
+            double v[6];
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf,%lf,%lf,%lf", v, v + 1, v + 2, v + 3, v + 4, v + 5) != 6) return usage();
+            const double n = std::hypot(v[3], v[4], v[5]);
+            if (n == 0) return usage();
+            const pwb::stl::Vec3 normal{float(v[3] / n), float(v[4] / n), float(v[5] / n)};
+            planes.push_back({normal, (v[0] * v[3] + v[1] * v[4] + v[2] * v[5]) / n,
+                              "por (" + decimal(v[0]) + "; " + decimal(v[1]) + "; " + decimal(v[2]) + ")"});
+        } else if (a == "--angle" && i + 1 < argc) options.feature_angle = std::atof(argv[++i]);
+        else if (a == "--no-hidden") options.hidden = false;
+        else if (a == "--svg") svg = true, pdf = false;
+        else if (a == "--pdf") pdf = true, svg = false;
+        else if (a == "--threads" && i + 1 < argc) options.threads = unsigned(std::atoi(argv[++i]));
+        else if (a == "--out" && i + 1 < argc) out_dir = argv[++i];
+        else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else return usage();
+    }
+    if (options.feature_angle <= 0 || options.feature_angle >= 180) return usage();
+    if (paths.empty()) paths.push_back(PWB_REPO_ROOT);
+
+    try {
+        std::vector<Part> parts;
+        for (const std::string& p : paths) collect(p, parts);
+        std::filesystem::create_directories(out_dir);
+
+        // One part per thread when there are several, otherwise all threads on the one part.
+        const auto t0 = std::chrono::steady_clock::now();
+        std::vector<Sheet> sheets(parts.size());
+        pwb::drawing::Options inner = options;
+        if (parts.size() > 1) inner.threads = 1;
+        pwb::parallel_for(
+            parts.size(),
+            [&](std::size_t i) {
+                sheets[i] = draw(parts[i], planes, inner);
+                if (svg) write(out_dir + "/" + parts[i].name + ".svg", pwb::drawing::svg(sheets[i].page));
+                if (pdf) write(out_dir + "/" + parts[i].name + ".pdf", pwb::drawing::pdf(sheets[i].page));
+            },
+            parts.size() > 1 ? options.threads : 1);
+        const double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        std::size_t rays = 0;
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            const Sheet& s = sheets[i];
+            std::printf("%-40s %7zu tri %6zu edges %9zu rays %4.0fx%3.0f mm sheet, %7.1f ms\n", parts[i].name.c_str(),
+                        s.triangles, s.edges, s.rays, s.page.width, s.page.height, s.ms);
+            rays += s.rays;
+        }
+        std::printf("total      %zu parts, %zu rays, %.1f ms wall, written to %s\n", parts.size(), rays, wall,
+                    out_dir.c_str());
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_drawing: %s\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,132 @@
+// Shield enclosure derived from an EAGLE board: reads the outline, mounting
+// holes and connector footprints from the .brd and builds a tray (standoffs
+// with screw pilots under the holes, windows for the edge connectors) and a
+// lid (locating lip, an opening over each channel connector with its number
+// engraved) from signed distance fields, meshed by parallel marching cubes.
+// Both parts are placed as assembled around the board and checked for open,
+// non-manifold and flipped edges; with --out DIR they are written there as
+// binary STLs (about 40 MB each at the default cell).
+//
+//   stl_enclosure [--board FILE] [--wall MM] [--clearance MM] [--standoff MM] [--headroom MM]
+//                 [--port ELEMENT[:WIDTHxHEIGHT]]... [--channel ELEMENT]... [--opening MM] [--cell MM]
+//                 [--threads N] [--out DIR]
+//
+// With no options it builds Shield_Top/Bottom for PCB/eagle_files/schm.brd;
+// the first --port or --channel replaces the default list.
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/enclosure.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/mesh_check.hpp"
+#include "pwb/sdf.hpp"
+#include "pwb/stl.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    pwb::enclosure::Params p;
+    pwb::sdf::Options o;
+    std::string board_path = PWB_REPO_ROOT "/PCB/eagle_files/schm.brd";
+    std::string out_dir; // nothing is written without --out
+    bool own_ports = false, own_channels = false;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_enclosure [--board FILE] [--wall MM] [--clearance MM] [--standoff MM] "
+                             "[--headroom MM]\n"
+                             "                     [--port ELEMENT[:WIDTHxHEIGHT]]... [--channel ELEMENT]... "
+                             "[--opening MM] [--cell MM]\n"
+                             "                     [--threads N] [--out DIR]\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto number = [&](float& v) { v = float(std::atof(argv[++i])); };
+        if (i + 1 < argc && a == "--board") board_path = argv[++i];
+        else if (i + 1 < argc && a == "--wall") number(p.wall), p.fillet = std::min(p.fillet, p.wall);
+        else if (i + 1 < argc && a == "--clearance") number(p.clearance);
+        else if (i + 1 < argc && a == "--standoff") number(p.standoff);
+        else if (i + 1 < argc && a == "--headroom") number(p.headroom);
+        else if (i + 1 < argc && a == "--port") {
+            if (!own_ports) p.ports.clear(), own_ports = true;
+            const std::string spec = argv[++i];
+            const std::size_t colon = spec.find(':');
+            pwb::enclosure::Port port;
+            port.element = spec.substr(0, colon);
+            if (colon != std::string::npos) {
+                const std::string size = spec.substr(colon + 1);
+                const std::size_t x = size.find('x');
+                port.width = float(std::atof(size.substr(0, x).c_str()));
+                if (x != std::string::npos) port.height = float(std::atof(size.substr(x + 1).c_str()));
+            }
+            p.ports.push_back(port);
+        } else if (i + 1 < argc && a == "--channel") {
+            if (!own_channels) p.channels.clear(), own_channels = true;
+            p.channels.push_back(argv[++i]);
+        } else if (i + 1 < argc && a == "--opening") number(p.opening);
+        else if (i + 1 < argc && a == "--cell") number(o.cell);
+        else if (i + 1 < argc && a == "--threads") o.threads = unsigned(std::atoi(argv[++i]));
+        else if (i + 1 < argc && a == "--out") out_dir = argv[++i];
+        else return usage();
+    }
+    if (!(o.cell > 0)) return usage();
+
+    try {
+        const pwb::eagle::Board board = pwb::eagle::load_board(board_path);
+        pwb::enclosure::validate(board, p);
+        if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+        std::printf("board      %s, %zu mounting holes, %zu ports, %zu channels\n", board_path.c_str(),
+                    board.holes.size(), p.ports.size(), p.channels.size());
+        std::printf("shell      wall %.2f mm, %.2f mm around the board, %.1f mm standoffs, %.1f mm headroom\n", p.wall,
+                    p.clearance, p.standoff, p.headroom);
+        struct Part {
+            const char* name;
+            pwb::enclosure::Part part;
+        };
+        const Part parts[] = {{"Shield_Top", pwb::enclosure::Part::Top}, {"Shield_Bottom", pwb::enclosure::Part::Bottom}};
+
+        const auto t0 = std::chrono::steady_clock::now();
+        for (const Part& part : parts) {
+            pwb::sdf::Stats s;
+            const pwb::mesh::Mesh m = pwb::enclosure::build(board, p, part.part, o, &s);
+            const std::string bytes = pwb::mesh::stl_bytes(m, std::string("pwb stl_enclosure ") + part.name);
+            const pwb::stl::View view = pwb::stl::parse(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+            pwb::mesh::CheckOptions co;
+            co.self_intersections = false;
+            co.threads = o.threads;
+            const pwb::mesh::CheckReport r = pwb::mesh::check(view.triangles, co);
+
+            const std::string path = out_dir.empty() ? std::string() : out_dir + "/" + part.name + ".stl";
+            if (!path.empty()) {
+                std::ofstream out(path, std::ios::binary);
+                if (!out.write(bytes.data(), std::streamsize(bytes.size()))) throw std::runtime_error("cannot write " + path);
+            }
+            std::printf("%s\n", part.name);
+            std::printf("  lattice    %zu points at %.3f mm, %zu of %zu bricks empty, %zu field evaluations (%.1f %%)\n",
+                        s.lattice, o.cell, s.empty, s.bricks, s.evaluations, 100.0 * double(s.evaluations) / double(s.lattice));
+            std::printf("  mesh       %zu triangles, %zu vertices, %.1f cm3, %s, %zu shell%s, genus %d\n",
+                        m.triangles.size(), m.vertices.size(), r.volume / 1000,
+                        r.watertight() && r.misoriented_edges == 0 ? "watertight" : "NOT watertight", r.shells,
+                        r.shells == 1 ? "" : "s", r.genus);
+            if (!r.watertight() || r.misoriented_edges)
+                std::printf("             %zu open, %zu non-manifold, %zu misoriented edges\n", r.open_edges,
+                            r.nonmanifold_edges, r.misoriented_edges);
+            std::printf("  time       %.1f ms fields and triangles, %.1f ms weld\n", s.seconds * 1e3, s.weld_seconds * 1e3);
+            if (!path.empty()) std::printf("  wrote      %s (%zu bytes)\n", path.c_str(), bytes.size());
+            else std::printf("  stl        %zu bytes, not written (no --out)\n", bytes.size());
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("total      %.0f ms\n", ms);
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_enclosure: %s\n", ex.what());
+        return 1;
+    }
+}
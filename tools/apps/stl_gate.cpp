@@ -0,0 +1,139 @@
+// Parametric Photogate housing: builds the U-shaped gate from signed distance
+// fields (shell, sensor bosses, bores and flange grooves, the brass nut's
+// barrel and screw bosses, cable exit), meshes each half by parallel marching
+// cubes into binary STLs placed as assembled, optionally reduced by quadric
+// edge collapse within --simplify mm. Each half is checked for open,
+// non-manifold and flipped edges, and the IR beam is traced through the pair.
+//
+//   stl_gate [--gap MM] [--arm MM] [--arm-width MM] [--height MM] [--wall MM] [--led MM] [--sensor MM]
+//            [--sensor-from-tip MM] [--nut MM] [--cell MM] [--simplify MM] [--whole] [--threads N] [--out DIR]
+//
+// With no options it rebuilds the current STL/fdm/Photogate_Top/Bottom at
+// 0.25 mm and only reports on them; the unsimplified halves are 30 MB each,
+// so STLs are written only into the directory given with --out.
+
+#include "pwb/beam.hpp"
+#include "pwb/gate.hpp"
+#include "pwb/lod.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/mesh_check.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/sdf.hpp"
+#include "pwb/stl.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    pwb::gate::Params p;
+    pwb::sdf::Options o;
+    double simplify = 0;
+    bool whole = false;
+    std::string out_dir; // nothing is written without --out
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_gate [--gap MM] [--arm MM] [--arm-width MM] [--height MM] [--wall MM] [--led MM] "
+                             "[--sensor MM]\n"
+                             "                [--sensor-from-tip MM] [--nut MM] [--cell MM] [--whole] [--threads N] "
+                             "[--out DIR]\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto number = [&](float& v) { v = float(std::atof(argv[++i])); };
+        if (i + 1 < argc && a == "--gap") number(p.gap);
+        else if (i + 1 < argc && a == "--arm") number(p.arm_length);
+        else if (i + 1 < argc && a == "--arm-width") number(p.arm_width);
+        else if (i + 1 < argc && a == "--height") {
+            const float old = p.height;
+            number(p.height);
+            p.split *= p.height / old; // the beam stays at the same fraction of the height
+        } else if (i + 1 < argc && a == "--wall") number(p.wall), p.fillet = std::min(p.fillet, p.wall);
+        else if (i + 1 < argc && a == "--led") number(p.led_bore);
+        else if (i + 1 < argc && a == "--sensor") number(p.sensor_bore);
+        else if (i + 1 < argc && a == "--sensor-from-tip") number(p.sensor_from_tip);
+        else if (i + 1 < argc && a == "--nut") number(p.nut_barrel);
+        else if (i + 1 < argc && a == "--cell") number(o.cell);
+        else if (i + 1 < argc && a == "--simplify") simplify = std::atof(argv[++i]);
+        else if (a == "--whole") whole = true;
+        else if (i + 1 < argc && a == "--threads") o.threads = unsigned(std::atoi(argv[++i]));
+        else if (i + 1 < argc && a == "--out") out_dir = argv[++i];
+        else return usage();
+    }
+    if (!(o.cell > 0) || simplify < 0) return usage();
+
+    try {
+        pwb::gate::validate(p);
+        if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+        std::printf("gate       %.1f mm gap, arms %.1f x %.1f mm, %.1f mm high, wall %.2f mm, bores %.2f / %.2f mm, "
+                    "nut %.2f mm\n",
+                    p.gap, p.arm_length, p.arm_width, p.height, p.wall, p.led_bore, p.sensor_bore, p.nut_barrel);
+        struct Part {
+            const char* name;
+            pwb::gate::Half half;
+        };
+        std::vector<Part> parts;
+        if (whole) parts.push_back({"Photogate", pwb::gate::Half::Whole});
+        else parts = {{"Photogate_Top", pwb::gate::Half::Top}, {"Photogate_Bottom", pwb::gate::Half::Bottom}};
+
+        pwb::ray::Scene scene;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (const Part& part : parts) {
+            pwb::sdf::Stats s;
+            pwb::mesh::Mesh m = pwb::gate::build(p, part.half, o, &s);
+            const std::size_t marched = m.triangles.size();
+            pwb::lod::Stats ls;
+            if (simplify > 0) {
+                pwb::lod::Options lo;
+                lo.max_error = simplify;
+                m = pwb::lod::decimate(m, lo, &ls);
+            }
+            const std::string bytes = pwb::mesh::stl_bytes(m, std::string("pwb stl_gate ") + part.name);
+            const pwb::stl::View view = pwb::stl::parse(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+            pwb::mesh::CheckOptions co;
+            co.self_intersections = false;
+            co.threads = o.threads;
+            const pwb::mesh::CheckReport r = pwb::mesh::check(view.triangles, co);
+            scene.add(view.triangles);
+
+            const std::string path = out_dir.empty() ? std::string() : out_dir + "/" + part.name + ".stl";
+            if (!path.empty()) {
+                std::ofstream out(path, std::ios::binary);
+                if (!out.write(bytes.data(), std::streamsize(bytes.size()))) throw std::runtime_error("cannot write " + path);
+            }
+            std::printf("%s\n", part.name);
+            std::printf("  lattice    %zu points at %.3f mm, %zu of %zu bricks empty, %zu field evaluations (%.1f %%)\n",
+                        s.lattice, o.cell, s.empty, s.bricks, s.evaluations, 100.0 * double(s.evaluations) / double(s.lattice));
+            std::printf("  mesh       %zu triangles, %zu vertices, %.1f cm3, %s, %zu shell%s, genus %d\n",
+                        m.triangles.size(), m.vertices.size(), r.volume / 1000,
+                        r.watertight() && r.misoriented_edges == 0 ? "watertight" : "NOT watertight", r.shells,
+                        r.shells == 1 ? "" : "s", r.genus);
+            if (!r.watertight() || r.misoriented_edges)
+                std::printf("             %zu open, %zu non-manifold, %zu misoriented edges\n", r.open_edges,
+                            r.nonmanifold_edges, r.misoriented_edges);
+            if (simplify > 0)
+                std::printf("  simplified %zu -> %zu triangles within %.3f mm in %.0f ms\n", marched, m.triangles.size(),
+                            ls.error, ls.seconds * 1e3);
+            std::printf("  time       %.1f ms fields and triangles, %.1f ms weld\n", s.seconds * 1e3, s.weld_seconds * 1e3);
+            if (!path.empty()) std::printf("  wrote      %s (%zu bytes)\n", path.c_str(), bytes.size());
+            else std::printf("  stl        %zu bytes, not written (no --out)\n", bytes.size());
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        scene.build();
+        const pwb::beam::Trace t = pwb::beam::trace(scene, pwb::gate::beam(p));
+        std::printf("beam       %.1f %% of %zu lines of sight clear\n", 100.0 * t.fraction(), t.rays);
+        std::printf("total      %.0f ms\n", ms);
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_gate: %s\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,116 @@
+// Header, colours, triangle count and extents of binary STL files, read in
+// place from a memory mapping (or from memory for zip members), and what
+// welding the triangle soup into an indexed mesh gives.
+//
+//   stl_info [file.stl | archive.zip] ...
+//
+// With no arguments it lists the Photogate parts under STL/fdm.
+
+#include "pwb/mesh.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string hex(const pwb::stl::Color& c) {
+    char buf[16];
+    std::snprintf(buf, sizeof buf, "#%02x%02x%02x/%02x", c.r, c.g, c.b, c.a);
+    return buf;
+}
+
+void report(const std::string& name, const pwb::stl::View& v, std::size_t bytes, double open_ms) {
+    auto t0 = std::chrono::steady_clock::now();
+    const pwb::stl::TriangleView& tris = v.triangles;
+    pwb::stl::Bounds b = pwb::stl::bounds(tris);
+    std::map<std::string, std::size_t> colours;
+    std::size_t own = 0;
+    for (std::size_t i = 0; i < tris.size(); ++i) {
+        pwb::stl::Color c;
+        if (pwb::stl::facet_color(tris.attribute(i), v.header, c)) ++own, ++colours[hex(c)];
+    }
+    double scan_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("%s\n", name.c_str());
+    std::printf("  header     \"%s\"\n", v.header.text.c_str());
+    std::printf("  triangles  %zu (%zu bytes%s)\n", tris.size(), bytes,
+                v.trailing_bytes ? (", " + std::to_string(v.trailing_bytes) + " trailing").c_str() : "");
+    if (v.header.has_color) std::printf("  COLOR      %s\n", hex(v.header.color).c_str());
+    if (v.header.has_material)
+        std::printf("  MATERIAL   diffuse %s specular %s ambient %s\n", hex(v.header.diffuse).c_str(),
+                    hex(v.header.specular).c_str(), hex(v.header.ambient).c_str());
+    if (v.header.has_color) {
+        std::printf("  facets     %zu with their own colour, %zu default", own, tris.size() - own);
+        for (const auto& [c, n] : colours) std::printf("; %s x%zu", c.c_str(), n);
+        std::printf("\n");
+    }
+    if (!tris.empty())
+        std::printf("  extents    %.3f x %.3f x %.3f  (%.3f, %.3f, %.3f) .. (%.3f, %.3f, %.3f)\n", b.max.x - b.min.x,
+                    b.max.y - b.min.y, b.max.z - b.min.z, b.min.x, b.min.y, b.min.z, b.max.x, b.max.y, b.max.z);
+    pwb::mesh::WeldStats ws;
+    pwb::mesh::Mesh mesh = pwb::mesh::weld(tris, {}, &ws);
+    auto t1 = std::chrono::steady_clock::now();
+    pwb::mesh::HalfEdges he = pwb::mesh::half_edges(mesh);
+    double he_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+    std::printf("  welded     %zu vertices (each used %.1f times), %zu edges; %zu open, %zu non-manifold, %zu misoriented",
+                ws.vertices, ws.vertices ? double(ws.corners - 3 * ws.degenerate) / double(ws.vertices) : 0.0, he.edges,
+                he.boundary, he.nonmanifold, he.misoriented);
+    if (ws.degenerate) std::printf("; %zu degenerate triangles dropped", ws.degenerate);
+    if (ws.near_merges) std::printf("; %zu near-duplicate vertices", ws.near_merges);
+    std::printf("\n");
+    std::printf("  memory     soup %.1f KB -> indexed %.1f KB (+ %.1f KB half-edges)\n", tris.size() * 36 / 1024.0,
+                mesh.bytes() / 1024.0, he.bytes() / 1024.0);
+    std::printf("  open %.3f ms, scan %.3f ms, weld %.3f ms, half-edges %.3f ms\n", open_ms, scan_ms, ws.seconds * 1e3, he_ms);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a.empty() || a[0] == '-') {
+            std::fprintf(stderr, "usage: stl_info [file.stl | archive.zip] ...\n");
+            return 2;
+        }
+        paths.push_back(a);
+    }
+    if (paths.empty()) {
+        paths.push_back(PWB_REPO_ROOT "/STL/fdm/Photogate_Top.stl");
+        paths.push_back(PWB_REPO_ROOT "/STL/fdm/Photogate_Bottom.stl");
+    }
+
+    int failures = 0;
+    for (const std::string& path : paths) {
+        try {
+            if (pwb::ends_with(path, ".zip")) {
+                pwb::ZipArchive zip(path);
+                for (const pwb::ZipEntry& e : zip.entries()) {
+                    if (!pwb::ends_with(e.name, ".stl")) continue;
+                    std::string data = zip.read(e);
+                    auto t0 = std::chrono::steady_clock::now();
+                    pwb::stl::View v = pwb::stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), e.name);
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    report(path + ":" + e.name, v, data.size(), ms);
+                }
+            } else {
+                auto t0 = std::chrono::steady_clock::now();
+                pwb::stl::File file(path);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                report(path, {file.header(), file.triangles(), file.trailing_bytes()}, file.size_bytes(), ms);
+            }
+        } catch (const std::exception& ex) {
+            std::fprintf(stderr, "stl_info: %s\n", ex.what());
+            ++failures;
+        }
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+// Mass properties and print estimate of binary STL parts: volume, surface
+// area, centroid and inertia from divergence-theorem sums, then filament
+// length, mass, extrusion time and cost for PETG or ABS. Directories are
+// searched recursively and .stl members of zip archives are read in memory;
+// parts are processed in parallel and listed in path order.
+//
+//   stl_mass [--material PETG|ABS] [--infill F] [--shell MM] [--diameter MM] [--price P]
+//            [--threads N] [--scalar] [file.stl | archive.zip | directory] ...
+//
+// With no arguments it processes every STL in the repository.
+
+#include "pwb/mass.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A file, or one member of an archive.
+struct Part {
+    std::string path, member;
+    std::string name() const { return member.empty() ? path : path + ":" + member; }
+};
+
+void collect(const std::string& path, std::vector<Part>& parts) {
+    namespace fs = std::filesystem;
+    if (fs::is_directory(path)) {
+        std::vector<std::string> found;
+        for (auto it = fs::recursive_directory_iterator(path); it != fs::recursive_directory_iterator(); ++it) {
+            const std::string name = it->path().filename().string();
+            if (it->is_directory() && (name.front() == '.' || name.front() == '_')) {
+                it.disable_recursion_pending(); // .git, build trees
+                continue;
+            }
+            const std::string p = it->path().string();
+            if (it->is_regular_file() && (pwb::ends_with(p, ".stl") || pwb::ends_with(p, ".zip"))) found.push_back(p);
+        }
+        std::sort(found.begin(), found.end());
+        for (const std::string& p : found) collect(p, parts);
+    } else if (pwb::ends_with(path, ".zip")) {
+        const pwb::ZipArchive zip(path);
+        for (const pwb::ZipEntry& e : zip.entries())
+            if (!e.is_directory() && pwb::ends_with(e.name, ".stl")) parts.push_back({path, e.name});
+    } else {
+        parts.push_back({path, {}});
+    }
+}
+
+struct Result {
+    pwb::mass::Properties props;
+    std::string error;
+};
+
+std::string duration(double seconds) {
+    char buf[32];
+    const long m = std::lround(seconds / 60);
+    std::snprintf(buf, sizeof buf, "%ldh%02ld", m / 60, m % 60);
+    return buf;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const pwb::mass::Material* material = pwb::mass::find_material("PETG");
+    pwb::mass::Material custom;
+    double price = -1;
+    pwb::mass::PrintSettings settings;
+    pwb::mass::Options options;
+    unsigned threads = 0;
+    std::vector<std::string> paths;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_mass [--material PETG|ABS] [--infill F] [--shell MM] [--diameter MM] [--price P] "
+                             "[--threads N] [--scalar] [file.stl | archive.zip | directory] ...\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--material" && i + 1 < argc) {
+            material = pwb::mass::find_material(argv[++i]);
+            if (!material) return usage();
+        } else if (a == "--infill" && i + 1 < argc) settings.infill = std::atof(argv[++i]);
+        else if (a == "--shell" && i + 1 < argc) settings.shell = std::atof(argv[++i]);
+        else if (a == "--diameter" && i + 1 < argc) settings.filament_diameter = std::atof(argv[++i]);
+        else if (a == "--price" && i + 1 < argc) price = std::atof(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) threads = unsigned(std::atoi(argv[++i]));
+        else if (a == "--scalar") options.simd = false;
+        else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else return usage();
+    }
+    if (settings.infill < 0 || settings.infill > 1 || settings.shell < 0 || settings.filament_diameter <= 0) return usage();
+    if (price >= 0) custom = *material, custom.price_per_kg = price, material = &custom;
+    if (paths.empty()) paths.push_back(PWB_REPO_ROOT);
+
+    std::vector<Part> parts;
+    try {
+        for (const std::string& p : paths) collect(p, parts);
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_mass: %s\n", ex.what());
+        return 1;
+    }
+
+    // One part per task; a single part's sums stay on its thread.
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<Result> results(parts.size());
+    options.threads = 1;
+    pwb::parallel_for(
+        parts.size(),
+        [&](std::size_t i) {
+            const Part& part = parts[i];
+            try {
+                if (part.member.empty()) {
+                    const pwb::stl::File f(part.path);
+                    results[i].props = pwb::mass::compute(f.triangles(), options);
+                } else {
+                    const std::string data = pwb::ZipArchive(part.path).read(part.member);
+                    const pwb::stl::View v =
+                        pwb::stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), part.member);
+                    results[i].props = pwb::mass::compute(v.triangles, options);
+                }
+            } catch (const std::exception& ex) {
+                results[i].error = ex.what();
+            }
+        },
+        threads);
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("%s, density %.2f g/cm³, %.1f mm³/s, %.2f per kg; %.2f mm filament, %.1f mm shell, %.0f %% infill\n",
+                material->name.c_str(), material->density, material->flow, material->price_per_kg,
+                settings.filament_diameter, settings.shell, 100 * settings.infill);
+    const std::string root = std::string(PWB_REPO_ROOT) + "/";
+    int failures = 0;
+    std::size_t triangles = 0;
+    pwb::mass::Estimate total;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        std::string name = parts[i].name();
+        if (name.compare(0, root.size(), root) == 0) name.erase(0, root.size());
+        if (!results[i].error.empty()) {
+            std::fprintf(stderr, "stl_mass: %s\n", results[i].error.c_str());
+            ++failures;
+            continue;
+        }
+        const pwb::mass::Properties& p = results[i].props;
+        const pwb::mass::Estimate e = pwb::mass::estimate(p, *material, settings);
+        const double g = material->density * 1e-3; // g/mm³
+        triangles += p.triangles;
+        total.extruded += e.extruded, total.length += e.length, total.mass += e.mass, total.seconds += e.seconds,
+            total.cost += e.cost;
+        std::printf("%s\n", name.c_str());
+        std::printf("  solid      %zu triangles, %.3f cm³, %.2f cm² surface, %.2f g solid", p.triangles, p.volume / 1e3,
+                    p.area / 1e2, p.volume * g);
+        if (p.inverted) std::printf(", facets wound inwards");
+        if (!p.closed()) std::printf(", NOT closed (open area %.3f mm²)", p.gap);
+        std::printf("\n  centroid   (%.3f, %.3f, %.3f) mm\n", p.centroid.x, p.centroid.y, p.centroid.z);
+        std::printf("  inertia    Ixx %.1f Iyy %.1f Izz %.1f Ixy %.1f Iyz %.1f Ixz %.1f g·mm² (principal %.1f %.1f %.1f)\n",
+                    p.inertia[0][0] * g, p.inertia[1][1] * g, p.inertia[2][2] * g, p.inertia[0][1] * g,
+                    p.inertia[1][2] * g, p.inertia[0][2] * g, p.principal[0] * g, p.principal[1] * g, p.principal[2] * g);
+        std::printf("  print      %.2f m filament, %.2f g, %s, cost %.2f\n", e.length, e.mass, duration(e.seconds).c_str(),
+                    e.cost);
+    }
+    std::printf("total      %zu parts, %zu triangles: %.2f m filament, %.1f g, %s, cost %.2f; computed in %.1f ms\n",
+                parts.size() - failures, triangles, total.length, total.mass, duration(total.seconds).c_str(), total.cost,
+                wall * 1e3);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+// Packs binary STL parts into one compressed mesh library (PWBZ) and checks
+// that every part decodes back to its quantised self; or, given a library,
+// lists its directory and decodes each part. Directories are searched
+// recursively and .stl members of zip archives are read in memory.
+//
+//   stl_pack [--bits B] [--threads N] [-o library.pwbz] [file.stl | archive.zip | directory] ...
+//   stl_pack --list library.pwbz
+//
+// With no inputs it packs every STL in the repository.
+
+#include "pwb/mapped_file.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/mesh_codec.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Parts named by path relative to the repository, "archive.zip:member" for
+// zip members.
+void collect(const std::string& path, std::vector<pwb::codec::Part>& parts, std::vector<std::size_t>& stl_bytes) {
+    namespace fs = std::filesystem;
+    const std::string root = std::string(PWB_REPO_ROOT) + "/";
+    auto relative = [&](const std::string& p) { return p.compare(0, root.size(), root) == 0 ? p.substr(root.size()) : p; };
+    if (fs::is_directory(path)) {
+        std::vector<std::string> found;
+        for (auto it = fs::recursive_directory_iterator(path); it != fs::recursive_directory_iterator(); ++it) {
+            const std::string name = it->path().filename().string();
+            if (it->is_directory() && (name.front() == '.' || name.front() == '_')) {
+                it.disable_recursion_pending(); // .git, build trees
+                continue;
+            }
+            const std::string p = it->path().string();
+            if (it->is_regular_file() && (pwb::ends_with(p, ".stl") || pwb::ends_with(p, ".zip"))) found.push_back(p);
+        }
+        std::sort(found.begin(), found.end());
+        for (const std::string& p : found) collect(p, parts, stl_bytes);
+    } else if (pwb::ends_with(path, ".zip")) {
+        const pwb::ZipArchive zip(path);
+        for (const pwb::ZipEntry& e : zip.entries()) {
+            if (e.is_directory() || !pwb::ends_with(e.name, ".stl")) continue;
+            const std::string data = zip.read(e);
+            const pwb::stl::View v = pwb::stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), e.name);
+            parts.push_back({relative(path) + ":" + e.name, pwb::mesh::weld(v.triangles)});
+            stl_bytes.push_back(data.size());
+        }
+    } else {
+        const pwb::stl::File f(path);
+        parts.push_back({relative(path), pwb::mesh::weld(f.triangles())});
+        stl_bytes.push_back(84 + 50 * f.triangles().size());
+    }
+}
+
+// The decoded part is the input snapped to the library's grid: the same
+// triangles, as rotation-normalised triples of grid points, in any order.
+bool same_surface(const pwb::mesh::Mesh& in, const pwb::mesh::Mesh& out, const pwb::codec::Entry& e) {
+    using Key = std::array<long, 9>;
+    auto keys = [&](const pwb::mesh::Mesh& m) {
+        std::vector<Key> k;
+        for (const pwb::mesh::Triangle& t : m.triangles) {
+            Key key;
+            for (int c = 0; c < 3; ++c) {
+                const pwb::stl::Vec3& p = m.vertices[t[c]];
+                key[3 * c] = std::lround((double(p.x) - e.origin[0]) / e.step[0]);
+                key[3 * c + 1] = std::lround((double(p.y) - e.origin[1]) / e.step[1]);
+                key[3 * c + 2] = std::lround((double(p.z) - e.origin[2]) / e.step[2]);
+            }
+            Key best = key;
+            for (int r = 1; r < 3; ++r) {
+                std::rotate(key.begin(), key.begin() + 3, key.end());
+                best = std::min(best, key);
+            }
+            k.push_back(best);
+        }
+        std::sort(k.begin(), k.end());
+        return k;
+    };
+    return in.triangles.size() == out.triangles.size() && keys(in) == keys(out);
+}
+
+int list(const std::string& path) {
+    const pwb::MappedFile file(path);
+    const pwb::codec::Reader reader(file.view());
+    std::printf("%s: %zu parts, %zu bytes\n", path.c_str(), reader.entries().size(), file.size());
+    for (const pwb::codec::Entry& e : reader.entries()) {
+        const auto t0 = std::chrono::steady_clock::now();
+        const pwb::mesh::Mesh m = reader.decode(e);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::printf("  %-58s %7u tri %7u vert %8llu bytes (%.2f B/tri), %2d-bit, decoded in %.2f ms\n", e.name.c_str(),
+                    e.triangles, e.vertices, static_cast<unsigned long long>(e.bytes), double(e.bytes) / e.triangles,
+                    e.bits, ms);
+        if (m.triangles.size() != e.triangles) throw std::runtime_error(e.name + ": triangle count mismatch");
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    pwb::codec::Options options;
+    std::string out_path, list_path;
+    std::vector<std::string> paths;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_pack [--bits B] [--threads N] [-o library.pwbz] "
+                             "[file.stl | archive.zip | directory] ...\n"
+                             "       stl_pack --list library.pwbz\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--bits" && i + 1 < argc) options.bits = std::atoi(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) options.threads = unsigned(std::atoi(argv[++i]));
+        else if (a == "-o" && i + 1 < argc) out_path = argv[++i];
+        else if (a == "--list" && i + 1 < argc) list_path = argv[++i];
+        else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else return usage();
+    }
+    if (options.bits < 1 || options.bits > 16) return usage();
+    if (paths.empty()) paths.push_back(PWB_REPO_ROOT);
+
+    try {
+        if (!list_path.empty()) return list(list_path);
+
+        std::vector<pwb::codec::Part> parts;
+        std::vector<std::size_t> stl_bytes;
+        for (const std::string& p : paths) collect(p, parts, stl_bytes);
+        const auto t0 = std::chrono::steady_clock::now();
+        const std::string library = pwb::codec::encode(parts, options);
+        const double encode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        const pwb::codec::Reader reader(library);
+        std::size_t total_stl = 0, triangles = 0;
+        int failures = 0;
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            const pwb::codec::Entry& e = reader.entries()[i];
+            const pwb::mesh::Mesh& in = parts[i].mesh;
+            const pwb::mesh::Mesh out = reader.decode(e);
+            const bool ok = same_surface(in, out, e);
+            total_stl += stl_bytes[i], triangles += e.triangles;
+            std::printf("%-60s %7u tri %9zu -> %7llu bytes (1:%.1f, %.2f B/tri)%s\n", e.name.c_str(), e.triangles,
+                        stl_bytes[i], static_cast<unsigned long long>(e.bytes), double(stl_bytes[i]) / double(e.bytes),
+                        double(e.bytes) / e.triangles, ok ? "" : "  ROUND TRIP FAILED");
+            if (!ok) ++failures;
+        }
+        std::printf("total      %zu parts, %zu triangles: %zu bytes of STL -> %zu bytes (1:%.1f), %d-bit positions, "
+                    "encoded in %.1f ms\n",
+                    parts.size(), triangles, total_stl, library.size(), double(total_stl) / double(library.size()),
+                    options.bits, encode_ms);
+        if (!out_path.empty()) {
+            std::ofstream out(out_path, std::ios::binary);
+            if (!out.write(library.data(), std::streamsize(library.size()))) throw std::runtime_error("cannot write " + out_path);
+            std::printf("wrote      %s\n", out_path.c_str());
+        }
+        return failures ? 1 : 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_pack: %s\n", ex.what());
+        return 1;
+    }
+}
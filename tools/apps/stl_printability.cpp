@@ -0,0 +1,107 @@
+// Printability of binary STL parts before slicing: faces overhanging beyond
+// an angle, wall thickness from rays cast inwards through a BVH, the support
+// volume under the overhangs from a height field, and the orientations that
+// need the least support from a parallel sweep over the sphere. Support is
+// priced as filament and extrusion time at the material's flow rate.
+//
+//   stl_printability [--angle DEG] [--wall MM] [--cell MM] [--orientations N] [--density F]
+//                    [--material PETG|ABS] [--threads N] [part.stl ...]
+//
+// With no parts it checks the shield and Photogate halves as modelled.
+
+#include "pwb/mass.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/printability.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Support printed at `density` of its volume, as filament of `material`.
+std::string priced(double volume, double density, const pwb::mass::Material& material) {
+    const double plastic = volume * density; // mm^3
+    const double grams = plastic / 1000 * material.density;
+    const double metres = plastic / (pwb::kPi * 0.875 * 0.875) / 1000;
+    char buf[160];
+    std::snprintf(buf, sizeof buf, "support %.2f cm3 -> %.1f g / %.2f m %s, %.0f min", volume / 1000, grams, metres,
+                  material.name.c_str(), plastic / material.flow / 60);
+    return buf;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    pwb::printability::Options options;
+    std::size_t count = 500;
+    double density = 0.15;
+    std::string material_name = "PETG";
+    std::vector<std::string> paths;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_printability [--angle DEG] [--wall MM] [--cell MM] [--orientations N] "
+                             "[--density F]\n"
+                             "                        [--material PETG|ABS] [--threads N] [part.stl ...]\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--angle" && i + 1 < argc) options.overhang_angle = std::atof(argv[++i]);
+        else if (a == "--wall" && i + 1 < argc) options.min_wall = std::atof(argv[++i]);
+        else if (a == "--cell" && i + 1 < argc) options.cell = std::atof(argv[++i]);
+        else if (a == "--orientations" && i + 1 < argc) count = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--density" && i + 1 < argc) density = std::atof(argv[++i]);
+        else if (a == "--material" && i + 1 < argc) material_name = argv[++i];
+        else if (a == "--threads" && i + 1 < argc) options.threads = unsigned(std::atoi(argv[++i]));
+        else if (!a.empty() && a[0] != '-') paths.push_back(a);
+        else return usage();
+    }
+    const pwb::mass::Material* material = pwb::mass::find_material(material_name);
+    if (!material || options.overhang_angle <= 0 || options.overhang_angle >= 90 || options.cell <= 0 ||
+        options.min_wall <= 0 || density <= 0 || density > 1)
+        return usage();
+    if (paths.empty())
+        for (const char* p : {"STL/fdm/shield_design/Shield_Top_V1.stl", "STL/fdm/shield_design/Shield_Bottom_V1.stl",
+                              "STL/fdm/Photogate_Top.stl", "STL/fdm/Photogate_Bottom.stl"})
+            paths.push_back(std::string(PWB_REPO_ROOT) + "/" + p);
+
+    try {
+        for (const std::string& path : paths) {
+            const auto t0 = std::chrono::steady_clock::now();
+            const pwb::stl::File file(path);
+            const pwb::mesh::Mesh mesh = pwb::mesh::weld(file.triangles());
+            const pwb::mesh::Mesh placed = pwb::printability::place(mesh, {0, 0, -1});
+            const pwb::printability::Support modelled = pwb::printability::support(placed, options);
+            const pwb::printability::Walls walls = pwb::printability::walls(mesh, options);
+            const std::vector<pwb::printability::Orientation> best = pwb::printability::orientations(mesh, count, 8, options);
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+            std::printf("%s, %zu triangles\n", path.substr(path.find_last_of("/\\") + 1).c_str(), mesh.triangles.size());
+            std::printf("  as modelled  overhang %.0f mm2 past %g deg, %s, height %.1f mm, on the bed %.0f mm2\n",
+                        modelled.overhang_area, options.overhang_angle, priced(modelled.volume, density, *material).c_str(),
+                        modelled.height, modelled.contact);
+            std::printf("  walls        thinnest %.2f mm at (%.1f, %.1f, %.1f); %.1f mm2 under %.2f mm, %.1f mm2 under "
+                        "%.2f mm (%zu rays)\n",
+                        walls.thinnest, walls.thinnest_at.x, walls.thinnest_at.y, walls.thinnest_at.z, walls.below_min,
+                        options.min_wall, walls.below_nozzle, options.nozzle, walls.samples);
+            for (std::size_t i = 0; i < std::min<std::size_t>(best.size(), 3); ++i) {
+                const pwb::printability::Orientation& o = best[i];
+                std::printf("  %s down (%5.2f, %5.2f, %5.2f)  overhang %.0f mm2, %s, height %.1f mm\n",
+                            i ? "           " : "best        ", o.down.x, o.down.y, o.down.z, o.support.overhang_area,
+                            priced(o.support.volume, density, *material).c_str(), o.support.height);
+            }
+            std::printf("  %zu orientations in %.0f ms\n", count + 6, ms);
+        }
+        return 0;
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_printability: %s\n", ex.what());
+        return 1;
+    }
+}
@@ -0,0 +1,84 @@
+// Slices a binary STL part into Marlin G-code for the lab's Ender-3: layers
+// are cut in parallel, walls come from polygon offsets, top and bottom skins
+// from comparing neighbouring layers, and the rest is rectilinear infill.
+// Prints a per-stage timing and the estimated print time and filament.
+//
+//   stl_slice [--layer MM] [--first-layer MM] [--width MM] [--walls N] [--solid N] [--infill F]
+//             [--nozzle C] [--bed C] [--threads N] [-o out.gcode] part.stl
+//
+// With no part it slices STL/fdm/shield_design/Shield_Bottom_V1.stl, one of
+// the parts in the Cura-sliced sliced_V1.gcode next to it.
+
+#include "pwb/mesh.hpp"
+#include "pwb/slicer.hpp"
+#include "pwb/stl.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char** argv) {
+    pwb::slicer::Options options;
+    pwb::slicer::Machine machine;
+    std::string path, out_path;
+    auto usage = [] {
+        std::fprintf(stderr, "usage: stl_slice [--layer MM] [--first-layer MM] [--width MM] [--walls N] [--solid N] "
+                             "[--infill F] [--nozzle C] [--bed C] [--threads N] [-o out.gcode] part.stl\n");
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--layer" && i + 1 < argc) options.layer_height = std::atof(argv[++i]);
+        else if (a == "--first-layer" && i + 1 < argc) options.first_layer = std::atof(argv[++i]);
+        else if (a == "--width" && i + 1 < argc) options.line_width = std::atof(argv[++i]);
+        else if (a == "--walls" && i + 1 < argc) options.walls = std::atoi(argv[++i]);
+        else if (a == "--solid" && i + 1 < argc) options.solid_layers = std::atoi(argv[++i]);
+        else if (a == "--infill" && i + 1 < argc) options.infill = std::atof(argv[++i]);
+        else if (a == "--nozzle" && i + 1 < argc) machine.nozzle_temp = std::atoi(argv[++i]);
+        else if (a == "--bed" && i + 1 < argc) machine.bed_temp = std::atoi(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) options.threads = unsigned(std::atoi(argv[++i]));
+        else if (a == "-o" && i + 1 < argc) out_path = argv[++i];
+        else if (!a.empty() && a[0] != '-' && path.empty()) path = a;
+        else return usage();
+    }
+    if (options.layer_height <= 0 || options.first_layer <= 0 || options.line_width <= 0 || options.walls < 0 ||
+        options.solid_layers < 0 || options.infill < 0 || options.infill > 1)
+        return usage();
+    if (path.empty()) path = std::string(PWB_REPO_ROOT) + "/STL/fdm/shield_design/Shield_Bottom_V1.stl";
+
+    try {
+        const pwb::stl::File file(path);
+        pwb::mesh::WeldStats ws;
+        const pwb::mesh::Mesh mesh = pwb::mesh::weld(file.triangles(), {}, &ws);
+        const pwb::slicer::Result r = pwb::slicer::slice(mesh, options);
+        std::size_t paths = 0;
+        for (const pwb::slicer::Layer& l : r.layers) paths += l.paths.size();
+        std::printf("part       %s, %zu triangles, welded in %.2f ms\n", path.c_str(), r.triangles, ws.seconds * 1e3);
+        std::printf("layers     %zu (%.2f mm first, then %.2f mm), %zu paths", r.layers.size(), options.first_layer,
+                    options.layer_height, paths);
+        if (r.open_chains) std::printf(", %zu open chains dropped (mesh not closed)", r.open_chains);
+        std::printf("\n");
+        const double total = r.slice_seconds + r.wall_seconds + r.fill_seconds;
+        std::printf("time       slice %.1f ms, walls %.1f ms, skin/infill %.1f ms; %.3f ms per layer\n",
+                    r.slice_seconds * 1e3, r.wall_seconds * 1e3, r.fill_seconds * 1e3,
+                    r.layers.empty() ? 0.0 : total * 1e3 / double(r.layers.size()));
+        const pwb::slicer::Totals t = pwb::slicer::estimate(r, options, machine);
+        const long s = long(t.seconds);
+        std::printf("print      %ldh%02ldm%02lds, %.2f m filament (%s)\n", s / 3600, s / 60 % 60, s % 60, t.filament / 1000,
+                    machine.name.c_str());
+        if (!out_path.empty()) {
+            const std::string title = path.substr(path.find_last_of("/\\") + 1);
+            const std::string gcode = pwb::slicer::write_gcode(r, options, machine, title);
+            std::ofstream out(out_path, std::ios::binary);
+            if (!out.write(gcode.data(), std::streamsize(gcode.size()))) throw std::runtime_error("cannot write " + out_path);
+            std::printf("wrote      %s (%zu bytes)\n", out_path.c_str(), gcode.size());
+        }
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "stl_slice: %s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
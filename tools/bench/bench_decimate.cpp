@@ -0,0 +1,71 @@
+// Quadric decimation speed on a synthetic sphere of N triangles (default
+// 1M) reduced to 10 % and 1 %, the Hausdorff check of the result on one
+// thread versus all cores, and the repository parts at 10 %.
+//
+//   bench_decimate [--triangles N]
+
+#include "bench_util.hpp"
+#include "mesh_util.hpp"
+
+#include "pwb/lod.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/surface_distance.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t triangles = 1'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_decimate [--triangles N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads\n", default_threads());
+
+    const std::string soup = bench::sphere_soup(triangles);
+    const mesh::Mesh sphere =
+        mesh::weld(stl::parse(reinterpret_cast<const unsigned char*>(soup.data()), soup.size(), "sphere").triangles);
+    std::printf("sphere, %zu triangles:\n", sphere.triangles.size());
+    mesh::Mesh reduced;
+    for (double ratio : {0.1, 0.01}) {
+        lod::Options o;
+        o.target_triangles = std::size_t(ratio * double(sphere.triangles.size()));
+        lod::Stats s;
+        const double t = bench::best_time([&] { reduced = lod::decimate(sphere, o, &s); }, 0.2, 1);
+        char label[64];
+        std::snprintf(label, sizeof label, "decimate to %g %%", ratio * 100);
+        bench::row(label, t * 1e3, "ms");
+        std::snprintf(label, sizeof label, "  input rate");
+        bench::row(label, double(sphere.triangles.size()) / t / 1e6, "Mtri/s");
+        std::snprintf(label, sizeof label, "  stale entries per collapse");
+        bench::row(label, double(s.stale) / double(s.collapses), "");
+    }
+    for (unsigned threads : {1u, 0u}) {
+        const double t = bench::best_time([&] { bench::keep(dist::hausdorff(sphere, reduced, 0.08f, threads)); }, 0.2, 1);
+        bench::row(threads == 1 ? "hausdorff to 1 %, 1 thread" : "hausdorff to 1 %, all threads", t * 1e3, "ms");
+    }
+    const std::string packed = lod::pack(reduced);
+    bench::row("pack", bench::best_time([&] { bench::keep(lod::pack(reduced)); }) * 1e6, "us");
+    bench::row("unpack", bench::best_time([&] { bench::keep(lod::unpack(packed)); }) * 1e6, "us");
+
+    std::printf("repository parts to 10 %%:\n");
+    for (const char* part : {"STL/fdm/Photogate_Top.stl", "STL/fdm/shield_design/Shield_Bottom_V1.stl"}) {
+        const stl::File f(bench::repo_path(part));
+        const mesh::Mesh m = mesh::weld(f.triangles());
+        lod::Options o;
+        o.target_triangles = m.triangles.size() / 10;
+        const double t = bench::best_time([&] { bench::keep(lod::decimate(m, o)); }, 0.2, 1);
+        char label[64];
+        std::snprintf(label, sizeof label, "%s (%zu tri)", part + std::string(part).find_last_of('/') + 1, m.triangles.size());
+        bench::row(label, t * 1e3, "ms");
+    }
+    return 0;
+}
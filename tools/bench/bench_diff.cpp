@@ -0,0 +1,54 @@
+// Revision diff costs on the Photogate V3 top against the current one, read
+// from STL/fdm/deprecated.zip: building the signed-distance target, ICP
+// alignment (all five starts), and signed-distance queries over an
+// area-uniform sampling, on one thread and on all.
+//
+//   bench_diff
+
+#include "bench_util.hpp"
+
+#include "pwb/mesh.hpp"
+#include "pwb/mesh_diff.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/surface_distance.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char**) {
+    using namespace pwb;
+    if (argc > 1) {
+        std::fprintf(stderr, "usage: bench_diff\n");
+        return 2;
+    }
+    std::printf("%u threads\n", default_threads());
+    const ZipArchive zip(bench::repo_path("STL/fdm/deprecated.zip"));
+    mesh::Mesh older;
+    for (const ZipEntry& e : zip.entries())
+        if (e.name == "deprecated/V3/PhotogateV3_Top.stl") {
+            const std::string data = zip.read(e);
+            older = mesh::weld(stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), e.name).triangles);
+        }
+    const stl::File file(bench::repo_path("STL/fdm/Photogate_Top.stl"));
+    const mesh::Mesh newer = mesh::weld(file.triangles());
+    std::printf("PhotogateV3_Top (%zu triangles) -> Photogate_Top (%zu triangles):\n", older.triangles.size(),
+                newer.triangles.size());
+
+    bench::row("target (BVH + pseudo-normals)", bench::best_time([&] { bench::keep(diff::Target(older)); }) * 1e3, "ms");
+    const diff::Target target(older);
+    const std::vector<stl::Vec3> points = dist::sample_area(newer, 0.25f);
+    for (unsigned threads : {1u, 0u}) {
+        diff::IcpOptions o;
+        o.threads = threads;
+        diff::Alignment fit;
+        const double t_icp = bench::best_time([&] { fit = diff::align(newer, target, o); }, 0.5, 1);
+        bench::row(threads == 1 ? "ICP, 1 thread" : "ICP, all threads", t_icp * 1e3, "ms");
+        const double t_d = bench::best_time([&] { bench::keep(diff::signed_distances(points, target, threads)); });
+        bench::row(threads == 1 ? "signed distance, 1 thread" : "signed distance, all threads",
+                   double(points.size()) / t_d / 1e6, "Mq/s");
+    }
+    return 0;
+}
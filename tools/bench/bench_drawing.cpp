@@ -0,0 +1,82 @@
+// Drawing generation for the Photogate and shield halves: BVH build, the
+// three hidden-line views (edges, rays cast, Mrays/s) on one thread and on
+// all, the two default cross-sections, and writing the sheet as SVG and PDF.
+//
+//   bench_drawing
+
+#include "bench_util.hpp"
+
+#include "pwb/drawing.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/stl.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char**) {
+    using namespace pwb;
+    if (argc > 1) {
+        std::fprintf(stderr, "usage: bench_drawing\n");
+        return 2;
+    }
+    std::printf("%u threads\n", default_threads());
+    for (const char* p : {"STL/fdm/Photogate_Top.stl", "STL/fdm/Photogate_Bottom.stl",
+                          "STL/fdm/shield_design/Shield_Top_V1.stl", "STL/fdm/shield_design/Shield_Bottom_V1.stl"}) {
+        const stl::File file(bench::repo_path(p));
+        const mesh::Mesh m = mesh::weld(file.triangles());
+        const mesh::HalfEdges he = mesh::half_edges(m);
+        std::printf("%s, %zu triangles:\n", p, m.triangles.size());
+
+        ray::Scene scene;
+        const double t_build = bench::best_time([&] {
+            ray::Scene s;
+            s.add(m);
+            s.build();
+            bench::keep(s);
+        });
+        bench::row("BVH build", t_build * 1e3, "ms");
+        scene.add(m);
+        scene.build();
+
+        drawing::Projection views[3];
+        for (unsigned threads : {1u, 0u}) {
+            drawing::Options o;
+            o.threads = threads;
+            const double t = bench::best_time([&] {
+                views[0] = drawing::project(m, he, scene, drawing::front(), o);
+                views[1] = drawing::project(m, he, scene, drawing::top(), o);
+                views[2] = drawing::project(m, he, scene, drawing::left(), o);
+            });
+            const std::size_t rays = views[0].rays + views[1].rays + views[2].rays;
+            bench::row(threads == 1 ? "3 views, 1 thread" : "3 views, all threads", t * 1e3, "ms");
+            bench::row(threads == 1 ? "  rays, 1 thread" : "  rays, all threads", double(rays) / t / 1e6, "Mrays/s");
+        }
+        bench::row("  edges drawn", double(views[0].edges + views[1].edges + views[2].edges), "");
+
+        stl::Vec3 lo = m.vertices[0], hi = lo;
+        for (const stl::Vec3& v : m.vertices) {
+            lo = {std::min(lo.x, v.x), std::min(lo.y, v.y), std::min(lo.z, v.z)};
+            hi = {std::max(hi.x, v.x), std::max(hi.y, v.y), std::max(hi.z, v.z)};
+        }
+        std::vector<drawing::Cut> cuts(2);
+        const double t_cut = bench::best_time([&] {
+            cuts[0] = {"A-A", "z", drawing::sections(m, drawing::facing({0, 0, 1}), {0.5 * (lo.z + hi.z)})[0]};
+            cuts[1] = {"B-B", "y", drawing::sections(m, drawing::facing({0, -1, 0}), {-0.5 * (lo.y + hi.y)})[0]};
+        });
+        bench::row("2 cross-sections", t_cut * 1e3, "ms");
+
+        const drawing::Page page = drawing::layout(p, {"VISTA FRONTAL", views[0]}, {"VISTA SUPERIOR", views[1]},
+                                                   {"VISTA LATERAL ESQUERDA", views[2]}, cuts);
+        std::size_t svg_bytes = 0, pdf_bytes = 0;
+        const double t_svg = bench::best_time([&] { svg_bytes = drawing::svg(page).size(); });
+        const double t_pdf = bench::best_time([&] { pdf_bytes = drawing::pdf(page).size(); });
+        bench::row("SVG", t_svg * 1e3, "ms");
+        bench::row("  size", double(svg_bytes) / 1024, "KiB");
+        bench::row("PDF, deflated", t_pdf * 1e3, "ms");
+        bench::row("  size", double(pdf_bytes) / 1024, "KiB");
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Excellon parsing and drill route planning on synthetic boards.
+//
+//   bench_drill_path [holes]   (default 100000)
+//
+// Holes are a mix of component rows (DIP/header-like pitch) and scattered
+// vias, spread over tools in EAGLE's proportions.
+
+#include "bench_util.hpp"
+
+#include "pwb/drill_path.hpp"
+#include "pwb/excellon.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace {
+
+std::string synthetic_drill(std::size_t holes) {
+    pwb::excellon::DrillFile f;
+    const double diameters[] = {0.4, 0.84, 1.2, 3.5};
+    for (int t = 0; t < 4; ++t) f.tools.push_back({t + 1, diameters[t], {}, {}});
+    // Board side grows with the hole count so density stays board-like.
+    const double side = 20.0 * std::sqrt(double(holes) / 100.0);
+    std::mt19937 rng(54);
+    std::uniform_real_distribution<double> pos(0.0, side);
+    std::uniform_int_distribution<int> row_len(4, 20);
+    std::size_t made = 0;
+    while (made < holes) {
+        if (rng() % 3 == 0) {
+            f.tools[0].hits.push_back({pos(rng), pos(rng)}); // via
+            ++made;
+            continue;
+        }
+        pwb::excellon::Tool& t = f.tools[rng() % 8 == 0 ? 2 : 1];
+        double x = pos(rng), y = pos(rng);
+        bool vertical = rng() % 2;
+        for (int k = row_len(rng); k > 0 && made < holes; --k, ++made) {
+            t.hits.push_back({x, y});
+            (vertical ? y : x) += 2.54;
+        }
+    }
+    for (int k = 0; k < 4; ++k) f.tools[3].hits.push_back({k % 2 ? side - 3 : 3, k / 2 ? side - 3 : 3});
+    return pwb::excellon::write(f);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t holes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+
+    const std::string text = synthetic_drill(holes);
+    std::printf("synthetic drill file: %zu holes, %.1f KB\n", holes, text.size() / 1024.0);
+
+    double t = bench::best_time([&] { bench::keep(excellon::parse(text).hit_count()); });
+    bench::row("parse", text.size() / (1024.0 * 1024.0) / t, "MB/s");
+
+    const excellon::DrillFile file = excellon::parse(text);
+    drill::PlanOptions nn_only;
+    nn_only.two_opt = nn_only.or_opt = false;
+    drill::PlanOptions full;
+    for (const excellon::Tool& tool : file.tools) {
+        drill::PlanStats s;
+        t = bench::best_time([&] { bench::keep(drill::plan(tool.hits, nn_only, &s).size()); }, 0.2, 1);
+        std::printf(" T%d: %zu holes\n", tool.number, tool.hits.size());
+        bench::row("nearest neighbour", t * 1e3, "ms");
+        t = bench::best_time([&] { bench::keep(drill::plan(tool.hits, full, &s).size()); }, 0.0, 1);
+        bench::row("nearest neighbour + 2-opt + Or-opt", t * 1e3, "ms");
+        bench::row("travel in file order", s.original / 1e3, "m");
+        bench::row("travel after nearest neighbour", s.nearest / 1e3, "m");
+        bench::row("travel after 2-opt + Or-opt", s.optimised / 1e3, "m");
+        bench::row("reduction vs nearest neighbour", 100.0 * (s.nearest - s.optimised) / s.nearest, "%");
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Shield enclosure generation from PCB/eagle_files/schm.brd: the cost of each
+// part's distance field at random points, then meshing both parts at lattice
+// spacings from 1 mm to 0.25 mm on one thread and on all, with the share of
+// the lattice evaluated. The lid is thin and engraved, so most of its bricks
+// hold surface; the tray is mostly air.
+//
+//   bench_enclosure [board.brd]
+
+#include "bench_util.hpp"
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/enclosure.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/sdf.hpp"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    if (argc > 2) {
+        std::fprintf(stderr, "usage: bench_enclosure [board.brd]\n");
+        return 2;
+    }
+    const std::string path = argc > 1 ? argv[1] : bench::repo_path("PCB/eagle_files/schm.brd");
+    std::printf("%u threads\n", default_threads());
+    const eagle::Board board = eagle::load_board(path);
+    const enclosure::Params params;
+
+    struct Part {
+        const char* name;
+        enclosure::Part part;
+    };
+    char label[64];
+    for (const Part& part : {Part{"lid", enclosure::Part::Top}, Part{"tray", enclosure::Part::Bottom}}) {
+        const sdf::Field field = enclosure::field(board, params, part.part);
+        stl::Vec3 lo, hi;
+        enclosure::bounds(board, params, part.part, lo, hi);
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> ux(lo.x, hi.x), uy(lo.y, hi.y), uz(lo.z, hi.z);
+        std::vector<stl::Vec3> points(1 << 16);
+        for (stl::Vec3& p : points) p = {ux(rng), uy(rng), uz(rng)};
+        const double t_field = bench::best_time([&] {
+            float sum = 0;
+            for (const stl::Vec3& p : points) sum += field(p);
+            bench::keep(sum);
+        });
+        std::snprintf(label, sizeof label, "%s field, random points", part.name);
+        bench::row(label, t_field / double(points.size()) * 1e9, "ns");
+
+        for (float cell : {1.0f, 0.5f, 0.25f}) {
+            for (unsigned threads : {1u, 0u}) {
+                sdf::Options o;
+                o.cell = cell;
+                o.threads = threads;
+                sdf::Stats s;
+                mesh::Mesh m;
+                const double t = bench::best_time([&] { m = sdf::polygonise(field, lo, hi, o, &s); }, 0.5, 1);
+                std::snprintf(label, sizeof label, "%s %.3f mm, %s", part.name, cell, threads == 1 ? "1 thread" : "all threads");
+                bench::row(label, t * 1e3, "ms");
+                if (threads == 1) {
+                    std::printf("    %zu triangles, %.1f %% of %zu lattice points evaluated\n", m.triangles.size(),
+                                100.0 * double(s.evaluations) / double(s.lattice), s.lattice);
+                }
+            }
+        }
+    }
+    return 0;
+}
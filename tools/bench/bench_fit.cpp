@@ -0,0 +1,56 @@
+// Assembly clearance check, one thread versus all cores: the Photogate halves
+// as placed, and a synthetic sphere of N triangles (default 200k) nested
+// 0.5 mm inside another: every triangle has a neighbour within reach, so the
+// dual traversal cannot prune much, and every inner vertex is buried.
+//
+//   bench_fit [--triangles N]
+
+#include "bench_util.hpp"
+#include "mesh_util.hpp"
+
+#include "pwb/fit.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t triangles = 200'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_fit [--triangles N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads\n", default_threads());
+
+    auto run = [](const char* name, const mesh::Mesh& fixed, const mesh::Mesh& moving) {
+        fit::Options o;
+        o.threads = 1;
+        const fit::Report r = fit::check(fixed, moving, o);
+        std::printf("%s: %zu + %zu triangles, min %.3f mm, %zu triangle pairs\n", name, fixed.triangles.size(),
+                    moving.triangles.size(), r.min_distance, r.pairs_tested);
+        for (unsigned threads : {1u, 0u}) {
+            o.threads = threads;
+            const double t = bench::best_time([&] { bench::keep(fit::check(fixed, moving, o)); });
+            bench::row(threads == 1 ? "1 thread" : "all threads", t * 1e3, "ms");
+        }
+    };
+
+    {
+        stl::File top(bench::repo_path("STL/fdm/Photogate_Top.stl")), bottom(bench::repo_path("STL/fdm/Photogate_Bottom.stl"));
+        run("Photogate halves", mesh::weld(bottom.triangles()), mesh::weld(top.triangles()));
+    }
+    const std::string inner = bench::sphere_soup(triangles, 40.0f, 65), outer = bench::sphere_soup(triangles, 40.5f, 66);
+    auto load = [](const std::string& data) {
+        return mesh::weld(stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), "sphere").triangles);
+    };
+    run("nested spheres", load(outer), load(inner));
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Parametric Photogate generation against resolution: meshing the default
+// top half from its distance field at lattice spacings from 1 mm to 0.125 mm,
+// on one thread and on all, with the share of the lattice actually evaluated
+// after empty bricks are skipped. The field alone is timed at random points.
+//
+//   bench_gate
+
+#include "bench_util.hpp"
+
+#include "pwb/gate.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/sdf.hpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main(int argc, char**) {
+    using namespace pwb;
+    if (argc > 1) {
+        std::fprintf(stderr, "usage: bench_gate\n");
+        return 2;
+    }
+    std::printf("%u threads\n", default_threads());
+    const gate::Params params;
+    const sdf::Field field = gate::field(params, gate::Half::Top);
+    stl::Vec3 lo, hi;
+    gate::bounds(params, gate::Half::Top, lo, hi);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> ux(lo.x, hi.x), uy(lo.y, hi.y), uz(lo.z, hi.z);
+    std::vector<stl::Vec3> points(1 << 16);
+    for (stl::Vec3& p : points) p = {ux(rng), uy(rng), uz(rng)};
+    const double t_field = bench::best_time([&] {
+        float sum = 0;
+        for (const stl::Vec3& p : points) sum += field(p);
+        bench::keep(sum);
+    });
+    bench::row("field, random points", t_field / double(points.size()) * 1e9, "ns");
+
+    char label[64];
+    for (float cell : {1.0f, 0.5f, 0.25f, 0.125f}) {
+        for (unsigned threads : {1u, 0u}) {
+            sdf::Options o;
+            o.cell = cell;
+            o.threads = threads;
+            sdf::Stats s;
+            mesh::Mesh m;
+            const double t = bench::best_time([&] { m = sdf::polygonise(field, lo, hi, o, &s); }, 0.5, 1);
+            std::snprintf(label, sizeof label, "%.3f mm, %s", cell, threads == 1 ? "1 thread" : "all threads");
+            bench::row(label, t * 1e3, "ms");
+            if (threads == 1) {
+                std::printf("    %zu triangles, %.1f %% of %zu lattice points evaluated, %.0f ms weld\n",
+                            m.triangles.size(), 100.0 * double(s.evaluations) / double(s.lattice), s.lattice,
+                            s.weld_seconds * 1e3);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Gerber parser throughput, in MB/s of uncompressed RS-274X text.
+//
+//   bench_gerber [archive.zip]
+
+#include "bench_util.hpp"
+
+#include "pwb/gerber.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool is_gerber(const pwb::ZipEntry& e) {
+    return e.name.size() > 4 && e.name.compare(e.name.size() - 4, 4, ".gbr") == 0;
+}
+
+// EAGLE-style layer of roughly `bytes` bytes: silkscreen-like strokes, pads
+// flashed with the OC8 macro and a few regions.
+std::string synthetic_layer(std::size_t bytes) {
+    std::string s = "G04 synthetic*\nG75*\n%MOMM*%\n%FSLAX34Y34*%\n%LPD*%\n%INSynthetic*%\n%IPPOS*%\n"
+                    "%AMOC8*\n5,1,8,0,0,1.08239X$1,22.5*%\nG01*\n%ADD10C,0.101600*%\n%ADD11OC8,1.600000*%\n"
+                    "%ADD12R,1.300000X1.500000*%\n";
+    std::mt19937 rng(51);
+    std::uniform_int_distribution<int> coord(0, 672900);
+    char buf[96];
+    while (s.size() < bytes) {
+        s += "D10*\n";
+        for (int k = 0; k < 64; ++k) {
+            std::snprintf(buf, sizeof buf, "X%dY%dD0%d*\n", coord(rng), coord(rng), k % 8 == 0 ? 2 : 1);
+            s += buf;
+        }
+        s += "D11*\n";
+        for (int k = 0; k < 8; ++k) {
+            std::snprintf(buf, sizeof buf, "X%dY%dD03*\n", coord(rng), coord(rng));
+            s += buf;
+        }
+        int x = coord(rng), y = coord(rng);
+        std::snprintf(buf, sizeof buf, "G36*\nX%dY%dD02*\nX%dY%dD01*\nX%dY%dD01*\nX%dY%dD01*\nG37*\n", x, y,
+                      x + 5000, y, x + 5000, y + 5000, x, y + 5000);
+        s += buf;
+    }
+    s += "M02*\n";
+    return s;
+}
+
+double megabytes(std::size_t bytes) { return double(bytes) / (1024.0 * 1024.0); }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::string path = argc > 1 ? argv[1] : bench::repo_path("PCB/deprecated/gerber/gerber_espwroom32.zip");
+
+    ZipArchive zip(path);
+    std::vector<std::string> layers;
+    std::size_t total = 0;
+    for (const ZipEntry& e : zip.entries()) {
+        if (!is_gerber(e)) continue;
+        layers.push_back(zip.read(e));
+        total += layers.back().size();
+    }
+    std::printf("%s: %zu layers, %.1f KB of Gerber text\n", path.c_str(), layers.size(), total / 1024.0);
+
+    double t = bench::best_time([&] {
+        ZipArchive z(path);
+        std::size_t prims = 0;
+        for (const ZipEntry& e : z.entries())
+            if (is_gerber(e)) prims += gerber::parse(z.read(e)).primitive_count();
+        bench::keep(prims);
+    });
+    bench::row("open zip + inflate + parse (all layers)", megabytes(total) / t, "MB/s");
+
+    t = bench::best_time([&] {
+        ZipArchive z(path);
+        std::size_t prims = 0;
+        for (const ZipEntry& e : z.entries())
+            if (is_gerber(e)) prims += gerber::parse(z, e).primitive_count();
+        bench::keep(prims);
+    });
+    bench::row("open zip + streamed parse (all layers)", megabytes(total) / t, "MB/s");
+
+    t = bench::best_time([&] {
+        std::size_t bytes = 0;
+        for (const ZipEntry& e : zip.entries())
+            if (is_gerber(e)) bytes += zip.read(e).size();
+        bench::keep(bytes);
+    });
+    bench::row("inflate only", megabytes(total) / t, "MB/s");
+
+    t = bench::best_time([&] {
+        std::size_t prims = 0;
+        for (const std::string& l : layers) prims += gerber::parse(l).primitive_count();
+        bench::keep(prims);
+    });
+    bench::row("parse only (all layers)", megabytes(total) / t, "MB/s");
+
+    const std::string silk = zip.read("silkscreen_top.gbr");
+    t = bench::best_time([&] { bench::keep(gerber::parse(silk).strokes.size()); });
+    bench::row("parse silkscreen_top.gbr", megabytes(silk.size()) / t, "MB/s");
+
+    const std::string big = synthetic_layer(64u << 20);
+    t = bench::best_time([&] { bench::keep(gerber::parse(big).primitive_count()); }, 1.0);
+    bench::row("parse synthetic 64 MB layer", megabytes(big.size()) / t, "MB/s");
+    return 0;
+}
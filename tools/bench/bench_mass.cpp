@@ -0,0 +1,63 @@
+// Mass properties throughput on a synthetic sphere of N triangles (default
+// 10M), scalar versus AVX2, one thread versus all cores, and how far a plain
+// float running sum of the volume drifts from the compensated double sums.
+//
+//   bench_mass [--triangles N]
+
+#include "bench_util.hpp"
+#include "mesh_util.hpp"
+
+#include "pwb/mass.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/simd.hpp"
+#include "pwb/stl.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t triangles = 10'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_mass [--triangles N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads, AVX2 %s\n", default_threads(), cpu_has_avx2() ? "yes" : "no");
+
+    const std::string soup = bench::sphere_soup(triangles);
+    const stl::View v = stl::parse(reinterpret_cast<const unsigned char*>(soup.data()), soup.size(), "sphere");
+    const mass::Properties ref = mass::compute(v.triangles, {1, false});
+    std::printf("sphere: %zu triangles, volume %.6f cm³, area %.6f cm²\n", ref.triangles, ref.volume / 1e3, ref.area / 1e2);
+
+    struct Mode {
+        const char* label;
+        mass::Options options;
+    };
+    const Mode modes[] = {{"scalar, 1 thread", {1, false}}, {"AVX2, 1 thread", {1, true}}, {"AVX2, all threads", {0, true}}};
+    for (const Mode& m : modes) {
+        mass::Properties p;
+        const double t = bench::best_time([&] { p = mass::compute(v.triangles, m.options); });
+        bench::row(m.label, double(v.triangles.size()) / t * 1e-6, "Mtri/s");
+        std::printf("  %-40s %12.2e relative to scalar\n", "", std::abs(p.volume - ref.volume) / ref.volume);
+    }
+
+    // The naive way: signed tetrahedra summed straight into a float.
+    float naive = 0;
+    const double t = bench::best_time([&] {
+        float sum = 0;
+        for (std::size_t i = 0; i < v.triangles.size(); ++i) {
+            const stl::Vec3 a = v.triangles.vertex(i, 0), b = v.triangles.vertex(i, 1), c = v.triangles.vertex(i, 2);
+            sum += (a.x * (b.y * c.z - b.z * c.y) - a.y * (b.x * c.z - b.z * c.x) + a.z * (b.x * c.y - b.y * c.x)) / 6;
+        }
+        naive = sum;
+    });
+    bench::row("float running sum, volume only", double(v.triangles.size()) / t * 1e-6, "Mtri/s");
+    std::printf("  %-40s %12.2e relative to scalar\n", "", std::abs(naive - ref.volume) / ref.volume);
+    return 0;
+}
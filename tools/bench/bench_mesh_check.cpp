@@ -0,0 +1,54 @@
+// Printability validator on a closed synthetic sphere of N triangles
+// (default 10M), split into its stages, plus the repository parts.
+//
+//   bench_mesh_check [--triangles N]
+
+#include "bench_util.hpp"
+#include "mesh_util.hpp"
+
+#include "pwb/bvh.hpp"
+#include "pwb/mesh_check.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t triangles = 10'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_mesh_check [--triangles N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads\n", default_threads());
+
+    for (const char* part : {"STL/fdm/Photogate_Top.stl", "STL/fdm/Photogate_Bottom.stl",
+                             "STL/fdm/shield_design/Shield_Top_V1.stl", "STL/fdm/shield_design/Shield_Bottom_V1.stl"}) {
+        stl::File f(bench::repo_path(part));
+        double t = bench::best_time([&] { bench::keep(mesh::check(f.triangles())); }, 0.2);
+        char label[96];
+        std::snprintf(label, sizeof label, "%s (%zu tri)", part + 8, f.triangles().size());
+        bench::row(label, t * 1e3, "ms");
+    }
+
+    std::string soup = bench::sphere_soup(triangles);
+    stl::View v = stl::parse(reinterpret_cast<const unsigned char*>(soup.data()), soup.size(), "sphere");
+    auto t0 = std::chrono::steady_clock::now();
+    mesh::CheckReport r = mesh::check(v.triangles);
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("synthetic sphere: %zu triangles, %zu vertices; %s, %zu intersecting pairs\n", r.triangles, r.vertices,
+                r.printable() ? "printable" : "NOT printable", r.intersecting_pairs);
+    bench::row("weld", r.weld_seconds, "s");
+    bench::row("topology (half-edges, shells, normals)", r.topology_seconds, "s");
+    bench::row("BVH build + self-intersection queries", r.intersect_seconds, "s");
+    bench::row("total", total, "s");
+    bench::row("throughput", r.triangles / total / 1e6, "Mtri/s");
+    return 0;
+}
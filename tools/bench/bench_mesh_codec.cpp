@@ -0,0 +1,133 @@
+// Compressed mesh library against the STL files it replaces: size of raw
+// STL, deflated STL (zlib level 9, as in a zip) and PWBZ for the repository
+// parts, then the time to get an indexed mesh back from each (parse and
+// weld, inflate first for zip, or decode), one part at a time and all parts
+// on all cores. Finishes with encode and decode rates on a synthetic sphere
+// of N triangles (default 1M).
+//
+//   bench_mesh_codec [--triangles N]
+
+#include "bench_util.hpp"
+#include "mesh_util.hpp"
+
+#include "pwb/mapped_file.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/mesh_codec.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string deflate(const std::string& data) {
+    uLongf size = compressBound(uLong(data.size()));
+    std::string out(size, '\0');
+    if (compress2(reinterpret_cast<Bytef*>(&out[0]), &size, reinterpret_cast<const Bytef*>(data.data()),
+                  uLong(data.size()), 9) != Z_OK)
+        throw std::runtime_error("deflate failed");
+    out.resize(size);
+    return out;
+}
+
+std::string inflate(const std::string& data, std::size_t size) {
+    std::string out(size, '\0');
+    uLongf n = uLongf(size);
+    if (uncompress(reinterpret_cast<Bytef*>(&out[0]), &n, reinterpret_cast<const Bytef*>(data.data()), uLong(data.size())) !=
+        Z_OK)
+        throw std::runtime_error("inflate failed");
+    return out;
+}
+
+pwb::mesh::Mesh weld_bytes(const std::string& stl) {
+    return pwb::mesh::weld(
+        pwb::stl::parse(reinterpret_cast<const unsigned char*>(stl.data()), stl.size(), "part").triangles, {1e-4f, 1});
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t triangles = 1'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_mesh_codec [--triangles N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads\n", default_threads());
+
+    // The current parts and the superseded ones kept in deprecated.zip.
+    std::vector<std::string> stl;
+    std::vector<codec::Part> parts;
+    for (const char* p : {"STL/fdm/Photogate_Top.stl", "STL/fdm/Photogate_Bottom.stl",
+                          "STL/fdm/shield_design/Shield_Top_V1.stl", "STL/fdm/shield_design/Shield_Bottom_V1.stl"}) {
+        const MappedFile f(bench::repo_path(p));
+        stl.emplace_back(f.view());
+        parts.push_back({p, weld_bytes(stl.back())});
+    }
+    const ZipArchive zip(bench::repo_path("STL/fdm/deprecated.zip"));
+    for (const ZipEntry& e : zip.entries())
+        if (e.name.size() > 4 && e.name.compare(e.name.size() - 4, 4, ".stl") == 0)
+            stl.push_back(zip.read(e)), parts.push_back({e.name, weld_bytes(stl.back())});
+
+    std::vector<std::string> zipped;
+    std::size_t raw = 0, deflated = 0, tris = 0;
+    for (std::size_t i = 0; i < stl.size(); ++i) {
+        zipped.push_back(deflate(stl[i]));
+        raw += stl[i].size(), deflated += zipped.back().size(), tris += parts[i].mesh.triangles.size();
+    }
+    const std::string library = codec::encode(parts);
+    const codec::Reader reader(library);
+
+    std::printf("%zu parts, %zu triangles, bytes per triangle:\n", parts.size(), tris);
+    bench::row("STL", double(raw) / double(tris), "B");
+    bench::row("STL, deflate -9", double(deflated) / double(tris), "B");
+    bench::row("PWBZ, 16-bit", double(library.size()) / double(tris), "B");
+    bench::row("  ratio to STL", double(raw) / double(library.size()), "x");
+    bench::row("  ratio to deflated STL", double(deflated) / double(library.size()), "x");
+
+    std::printf("to an indexed mesh, Mtri/s:\n");
+    const std::size_t n = parts.size();
+    for (unsigned threads : {1u, 0u}) {
+        const char* suffix = threads == 1 ? "1 thread" : "all threads";
+        char label[64];
+        const double t_stl = bench::best_time([&] {
+            parallel_for(n, [&](std::size_t i) { bench::keep(weld_bytes(stl[i])); }, threads);
+        });
+        std::snprintf(label, sizeof label, "STL parse + weld, %s", suffix);
+        bench::row(label, double(tris) / t_stl / 1e6, "Mtri/s");
+        const double t_zip = bench::best_time([&] {
+            parallel_for(n, [&](std::size_t i) { bench::keep(weld_bytes(inflate(zipped[i], stl[i].size()))); }, threads);
+        });
+        std::snprintf(label, sizeof label, "inflate + parse + weld, %s", suffix);
+        bench::row(label, double(tris) / t_zip / 1e6, "Mtri/s");
+        const double t_codec = bench::best_time([&] {
+            parallel_for(n, [&](std::size_t i) { bench::keep(reader.decode(reader.entries()[i])); }, threads);
+        });
+        std::snprintf(label, sizeof label, "PWBZ decode, %s", suffix);
+        bench::row(label, double(tris) / t_codec / 1e6, "Mtri/s");
+    }
+
+    const std::string soup = bench::sphere_soup(triangles);
+    const mesh::Mesh sphere = weld_bytes(soup);
+    const std::vector<codec::Part> one{{"sphere", sphere}};
+    std::string packed;
+    const double t_enc = bench::best_time([&] { packed = codec::encode(one); }, 0.2, 1);
+    const codec::Reader sphere_reader(packed);
+    const double t_dec = bench::best_time([&] { bench::keep(sphere_reader.decode(sphere_reader.entries()[0])); }, 0.2, 1);
+    std::printf("sphere, %zu triangles:\n", sphere.triangles.size());
+    bench::row("bytes per triangle", double(packed.size()) / double(sphere.triangles.size()), "B");
+    bench::row("encode", double(sphere.triangles.size()) / t_enc / 1e6, "Mtri/s");
+    bench::row("decode", double(sphere.triangles.size()) / t_dec / 1e6, "Mtri/s");
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Polygon boolean engine on the CAM package layers: per-layer merge, the
+// mask/paste/copper operations DFM checks need, offsets, and a tiled panel.
+//
+//   bench_polygon [archive.zip]
+
+#include "bench_util.hpp"
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr pwb::gerber::Coord kTolerance = 1000; // 1 µm
+
+struct Loaded {
+    std::vector<pwb::gerber::PolygonSet> levels;
+    std::vector<bool> clear;
+    std::size_t edges = 0;
+};
+
+Loaded load(pwb::ZipArchive& zip, const char* name) {
+    pwb::gerber::Layer layer = pwb::gerber::parse(zip.read(name));
+    Loaded l;
+    l.levels = pwb::gerber::layer_outlines(layer, kTolerance);
+    for (const pwb::gerber::Level& level : layer.levels) l.clear.push_back(level.polarity == pwb::gerber::Polarity::Clear);
+    for (const pwb::gerber::PolygonSet& s : l.levels) l.edges += s.points.size();
+    return l;
+}
+
+double mm2(double nm2) { return nm2 * 1e-12; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::string path = argc > 1 ? argv[1] : bench::repo_path("PCB/deprecated/gerber/gerber_espwroom32.zip");
+    ZipArchive zip(path);
+
+    const char* names[] = {"copper_top.gbr", "copper_bottom.gbr", "soldermask_top.gbr", "solderpaste_top.gbr",
+                           "silkscreen_top.gbr"};
+    std::vector<gerber::PolygonSet> merged;
+    for (const char* name : names) {
+        Loaded l = load(zip, name);
+        gerber::PolygonSet out;
+        double t = bench::best_time([&] { out = poly::flatten(l.levels, l.clear); });
+        std::printf(" %s: %zu input edges -> %zu contours, %zu vertices, %.3f mm2\n", name, l.edges, out.size(),
+                    out.points.size(), mm2(poly::area(out)));
+        bench::row("flatten levels", t * 1e3, "ms");
+        bench::row("throughput", double(l.edges) / t * 1e-6, "M edges/s");
+        merged.push_back(std::move(out));
+    }
+    const gerber::PolygonSet &copper = merged[0], &mask = merged[2], &paste = merged[3], &silk = merged[4];
+
+    std::printf(" derived layers\n");
+    gerber::PolygonSet out;
+    double t = bench::best_time([&] { out = poly::boolean(paste, mask, poly::Op::Intersection); });
+    bench::row("paste AND mask", t * 1e3, "ms");
+    bench::row("  paste inside mask openings", 100.0 * poly::area(out) / poly::area(paste), "%");
+    t = bench::best_time([&] { out = poly::boolean(mask, copper, poly::Op::Difference); });
+    bench::row("mask - copper (exposed laminate)", t * 1e3, "ms");
+    bench::row("  area", mm2(poly::area(out)), "mm2");
+    t = bench::best_time([&] { out = poly::boolean(silk, mask, poly::Op::Difference); });
+    bench::row("silkscreen - mask (clipped legend)", t * 1e3, "ms");
+    t = bench::best_time([&] { out = poly::offset(copper, 100'000, kTolerance); });
+    bench::row("copper offset +0.1 mm", t * 1e3, "ms");
+    bench::row("  area", mm2(poly::area(out)), "mm2");
+    t = bench::best_time([&] { out = poly::offset(copper, -50'000, kTolerance); });
+    bench::row("copper offset -0.05 mm", t * 1e3, "ms");
+    bench::row("  area", mm2(poly::area(out)), "mm2");
+
+    // 4 x 4 panel of the top layers merged into one set.
+    gerber::PolygonSet panel;
+    for (int i = 0; i < 16; ++i) {
+        for (const gerber::PolygonSet* s : {&copper, &mask, &paste, &silk}) {
+            for (std::size_t k = 0; k < s->size(); ++k) {
+                for (std::size_t j = 0; j < s->count(k); ++j) {
+                    gerber::Point p = s->begin(k)[j];
+                    panel.points.push_back({p.x + (i % 4) * 70'000'000, p.y + (i / 4) * 52'000'000});
+                }
+                panel.close();
+            }
+        }
+    }
+    t = bench::best_time([&] { out = poly::merge(panel); });
+    std::printf(" 4x4 panel of all top layers: %zu edges -> %zu vertices\n", panel.points.size(), out.points.size());
+    bench::row("merge", t * 1e3, "ms");
+    bench::row("throughput", double(panel.points.size()) / t * 1e-6, "M edges/s");
+    return 0;
+}
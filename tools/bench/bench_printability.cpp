@@ -0,0 +1,50 @@
+// Printability analysis on the Photogate and shield halves: support volume
+// from the height field at two grid sizes, inward wall-thickness rays and the
+// orientation sweep (500 directions plus the axes), on one thread and on all.
+//
+//   bench_printability
+
+#include "bench_util.hpp"
+
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/printability.hpp"
+#include "pwb/stl.hpp"
+
+#include <cstdio>
+#include <string>
+
+int main(int argc, char**) {
+    using namespace pwb;
+    if (argc > 1) {
+        std::fprintf(stderr, "usage: bench_printability\n");
+        return 2;
+    }
+    std::printf("%u threads\n", default_threads());
+    for (const char* p : {"STL/fdm/Photogate_Top.stl", "STL/fdm/shield_design/Shield_Top_V1.stl"}) {
+        const stl::File file(bench::repo_path(p));
+        const mesh::Mesh m = mesh::weld(file.triangles());
+        const mesh::Mesh placed = printability::place(m, {0, 0, -1});
+        std::printf("%s, %zu triangles:\n", p, m.triangles.size());
+        for (unsigned threads : {1u, 0u}) {
+            const char* suffix = threads == 1 ? "1 thread" : "all threads";
+            char label[64];
+            printability::Options o;
+            o.threads = threads;
+            for (double cell : {0.5, 0.2}) {
+                o.cell = cell;
+                std::snprintf(label, sizeof label, "support, %.1f mm cells, %s", cell, suffix);
+                bench::row(label, bench::best_time([&] { bench::keep(printability::support(placed, o)); }) * 1e3, "ms");
+            }
+            o.cell = 0.5;
+            printability::Walls w;
+            const double t_walls = bench::best_time([&] { w = printability::walls(m, o); });
+            std::snprintf(label, sizeof label, "wall rays, %s", suffix);
+            bench::row(label, double(w.samples) / t_walls / 1e6, "Mrays/s");
+            const double t_sweep = bench::best_time([&] { bench::keep(printability::orientations(m, 500, 8, o)); }, 0.5, 1);
+            std::snprintf(label, sizeof label, "506 orientations, %s", suffix);
+            bench::row(label, t_sweep * 1e3, "ms");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Rasteriser throughput in megapixels/s over the board window declared in
+// gerber_job.gbrjob (67.29 x 49.2 mm), at several pixel sizes.
+//
+//   bench_raster [archive.zip]
+
+#include "bench_util.hpp"
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/raster.hpp"
+#include "pwb/simd.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pwb::gerber::Coord;
+
+// The obvious approach the scanline filler replaces: for every primitive,
+// test 4x4 samples of every pixel in its bounding box against the polygon.
+pwb::raster::Bitmap naive(const pwb::gerber::Layer& layer, const pwb::gerber::Box& window, Coord pixel) {
+    pwb::raster::Bitmap bmp;
+    bmp.pixel = pixel;
+    bmp.origin_x = window.min_x, bmp.origin_y = window.min_y;
+    bmp.width = int(window.width() / pixel), bmp.height = int(window.height() / pixel);
+    bmp.pixels.assign(std::size_t(bmp.width) * bmp.height, 0);
+    std::vector<pwb::gerber::PolygonSet> levels = pwb::gerber::layer_outlines(layer, pixel / 8);
+    std::vector<std::uint8_t> cover(bmp.pixels.size());
+    for (const auto& set : levels) {
+        for (std::size_t c = 0; c < set.size(); ++c) {
+            const auto* p = set.begin(c);
+            std::size_t n = set.count(c);
+            pwb::gerber::Box b;
+            for (std::size_t i = 0; i < n; ++i) b.add(p[i].x, p[i].y);
+            int c0 = std::max(0, int((b.min_x - bmp.origin_x) / pixel));
+            int c1 = std::min(bmp.width - 1, int((b.max_x - bmp.origin_x) / pixel));
+            int r0 = std::max(0, int((b.min_y - bmp.origin_y) / pixel));
+            int r1 = std::min(bmp.height - 1, int((b.max_y - bmp.origin_y) / pixel));
+            for (int r = r0; r <= r1; ++r) {
+                for (int col = c0; col <= c1; ++col) {
+                    int hits = 0;
+                    for (int s = 0; s < 16; ++s) {
+                        double x = bmp.origin_x + (col + (s % 4 + 0.5) / 4) * pixel;
+                        double y = bmp.origin_y + (r + (s / 4 + 0.5) / 4) * pixel;
+                        bool in = false;
+                        for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+                            if ((p[i].y > y) != (p[j].y > y) &&
+                                x < double(p[j].x - p[i].x) * (y - p[i].y) / double(p[j].y - p[i].y) + p[i].x)
+                                in = !in;
+                        }
+                        hits += in;
+                    }
+                    std::uint8_t& px = bmp.pixels[std::size_t(r) * bmp.width + col];
+                    px = std::uint8_t(std::min(255, px + hits * 16));
+                }
+            }
+        }
+    }
+    return bmp;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::string path = argc > 1 ? argv[1] : bench::repo_path("PCB/deprecated/gerber/gerber_espwroom32.zip");
+    ZipArchive zip(path);
+
+    gerber::Box board; // gerber_job.gbrjob: Overall.Size
+    board.add(0, 0);
+    board.add(Coord(67.29 * gerber::kNmPerMm), Coord(49.2 * gerber::kNmPerMm));
+
+    std::printf("AVX2 kernels: %s, threads: %u\n", cpu_has_avx2() ? "yes" : "no", default_threads());
+    for (const char* member : {"silkscreen_top.gbr", "copper_top.gbr"}) {
+        gerber::Layer layer = gerber::parse(zip.read(member));
+        std::printf("%s\n", member);
+        for (int um : {25, 20, 15, 10}) {
+            raster::Options opt;
+            opt.pixel = um * 1000;
+            opt.window = board;
+            double mp = 0;
+            char label[64];
+
+            opt.simd = false, opt.threads = 1;
+            double t = bench::best_time([&] { mp = raster::rasterise(layer, opt).megapixels(); });
+            std::snprintf(label, sizeof label, "%2d um  scalar, 1 thread", um);
+            bench::row(label, mp / t, "MP/s");
+
+            opt.simd = true;
+            t = bench::best_time([&] { mp = raster::rasterise(layer, opt).megapixels(); });
+            std::snprintf(label, sizeof label, "%2d um  AVX2,   1 thread", um);
+            bench::row(label, mp / t, "MP/s");
+
+            opt.threads = 0;
+            t = bench::best_time([&] { mp = raster::rasterise(layer, opt).megapixels(); });
+            std::snprintf(label, sizeof label, "%2d um  AVX2,   all threads (%.1f MP)", um, mp);
+            bench::row(label, mp / t, "MP/s");
+
+            if (um == 25) {
+                t = bench::best_time([&] { mp = naive(layer, board, opt.pixel).megapixels(); }, 0.5, 1);
+                bench::row("25 um  naive per-primitive 4x4 samples", mp / t, "MP/s");
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Ray casting through the assembled Photogate housing, in Mrays/s: the IR
+// beam bundle (coherent) and random segments across the housing box
+// (incoherent), scalar versus AVX2 packets, one thread versus all cores.
+//
+//   bench_raycast [--rays N]
+
+#include "bench_util.hpp"
+
+#include "pwb/beam.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/simd.hpp"
+#include "pwb/stl.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t rays_wanted = 1'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--rays" && i + 1 < argc) rays_wanted = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_raycast [--rays N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads, AVX2 %s\n", default_threads(), cpu_has_avx2() ? "yes" : "no");
+
+    stl::File top(bench::repo_path("STL/fdm/Photogate_Top.stl")), bottom(bench::repo_path("STL/fdm/Photogate_Bottom.stl"));
+    ray::Scene scene;
+    scene.add(bottom.triangles());
+    scene.add(top.triangles());
+    const double build = bench::best_time([&] {
+        ray::Scene s;
+        s.add(bottom.triangles());
+        s.add(top.triangles());
+        s.build();
+        bench::keep(s);
+    });
+    scene.build();
+    std::printf("scene: %zu triangles, %zu nodes\n", scene.triangles(), scene.tree().nodes.size());
+    bench::row("BVH build", build * 1e3, "ms");
+
+    beam::Beam b = beam::photogate();
+    b.samples = std::max(8, int(std::sqrt(double(rays_wanted))));
+    std::vector<ray::Ray> coherent = beam::bundle(b);
+
+    // Segments between random points of the housing box: most cross a wall.
+    const bvh::Aabb box = scene.tree().nodes[0].box;
+    std::mt19937 rng(64);
+    std::uniform_real_distribution<float> ux(box.min.x, box.max.x), uy(box.min.y, box.max.y), uz(box.min.z, box.max.z);
+    std::vector<ray::Ray> incoherent(coherent.size());
+    for (ray::Ray& r : incoherent) {
+        const stl::Vec3 p{ux(rng), uy(rng), uz(rng)}, q{ux(rng), uy(rng), uz(rng)};
+        r = {p, {q.x - p.x, q.y - p.y, q.z - p.z}, 1.0f};
+    }
+
+    std::vector<std::uint8_t> blocked(coherent.size());
+    struct Mode {
+        const char* label;
+        bool simd;
+        unsigned threads;
+    };
+    const Mode modes[] = {{"scalar, 1 thread", false, 1}, {"AVX2 packets, 1 thread", true, 1},
+                          {"AVX2 packets, all threads", true, 0}};
+    for (const auto& [name, rays] : {std::pair{"beam bundle", &coherent}, std::pair{"random segments", &incoherent}}) {
+        ray::Options o;
+        o.threads = 1;
+        const std::size_t hits = scene.occluded(rays->data(), rays->size(), blocked.data(), o);
+        std::printf("%s: %zu rays, %.1f%% blocked\n", name, rays->size(), 100.0 * double(hits) / double(rays->size()));
+        for (const Mode& m : modes) {
+            o.simd = m.simd;
+            o.threads = m.threads;
+            const double t = bench::best_time([&] { bench::keep(scene.occluded(rays->data(), rays->size(), blocked.data(), o)); });
+            bench::row(m.label, double(rays->size()) / t * 1e-6, "Mrays/s");
+        }
+    }
+    return 0;
+}
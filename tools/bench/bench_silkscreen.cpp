@@ -0,0 +1,80 @@
+// Silkscreen compositor: logo tracing speed and Gerber size against one flash
+// per pixel, and stroke-font text with a cold and a warm glyph cache.
+//
+//   bench_silkscreen [logo.jpg|pgm ...]
+
+#include "bench_util.hpp"
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+#include "pwb/image.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/silkscreen.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+double area(const pwb::gerber::Layer& layer) {
+    std::vector<bool> clear(layer.levels.size(), false);
+    return pwb::poly::area(pwb::poly::flatten(pwb::gerber::layer_outlines(layer, 1000), clear)) * 1e-12;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::vector<std::string> logos;
+    for (int i = 1; i < argc; ++i) logos.push_back(argv[i]);
+    if (logos.empty()) {
+        for (const char* name : {"ufscar_logo_128x32.jpg", "ufscar_logo_128x64.jpg", "cca_logo_128x32.jpg", "cca_logo_128x64.jpg"})
+            logos.push_back(bench::repo_path((std::string("images/") + name).c_str()));
+    }
+    gerber::Format format; // EAGLE's %FSLAX34Y34%, millimetres
+    const gerber::Units units = gerber::Units::Millimetres;
+    const gerber::Coord width = 14'000'000; // 14 mm, as silk_compose places them
+
+    for (const std::string& path : logos) {
+        image::Gray img = image::load(path);
+        silk::TraceOptions opt;
+        silk::Artwork art;
+        double t = bench::best_time([&] { art = silk::vectorise(img, width, opt); });
+        std::string regions = silk::region_block(art.outline, format, units);
+        std::string flashes = silk::pixel_flashes(img, width / img.width, 0, 0, format, units, 10, opt);
+        // Both encodings must describe the same ink.
+        gerber::Layer a = gerber::parse("%FSLAX34Y34*%%MOMM*%" + regions + "M02*");
+        gerber::Layer b = gerber::parse("%FSLAX34Y34*%%MOMM*%" + flashes + "M02*");
+        std::printf(" %s (%dx%d, %zu ink pixels)\n", path.substr(path.rfind('/') + 1).c_str(), img.width, img.height,
+                    silk::ink_pixels(img, opt));
+        bench::row("trace + simplify + clean", t * 1e3, "ms");
+        bench::row("crack vertices", double(art.traced_vertices), "");
+        bench::row("region vertices", double(art.outline.points.size()), "");
+        bench::row("regions", double(a.regions.size()), "");
+        bench::row("region Gerber", double(regions.size()) / 1024, "KiB");
+        bench::row("per-pixel flashes", double(flashes.size()) / 1024, "KiB");
+        bench::row("size ratio", double(flashes.size()) / double(regions.size()), "x");
+        bench::row("flashes", double(b.flashes.size()), "");
+        bench::row("ink area, regions", area(a), "mm2");
+        bench::row("ink area, flashes", area(b), "mm2");
+    }
+
+    const std::string paragraph = "Photogate ESP32 - UFSCar-CCA - VCC SENSOR GND - Felipe Ricobello - Rev 2 (2026)";
+    silk::TextStyle style;
+    style.height = 1'200'000;
+    silk::GlyphCache cache;
+    gerber::PolygonSet out;
+    double cold = bench::best_time([&] {
+        cache.clear();
+        out = silk::text_outline(cache, paragraph, 0, 0, style);
+    });
+    double warm = bench::best_time([&] { out = silk::text_outline(cache, paragraph, 0, 0, style); });
+    std::printf(" text, %zu characters at 1.2 mm\n", paragraph.size());
+    bench::row("cold cache", cold * 1e3, "ms");
+    bench::row("warm cache", warm * 1e6, "us");
+    bench::row("speed-up", cold / warm, "x");
+    bench::row("region Gerber", double(silk::region_block(out, format, units).size()) / 1024, "KiB");
+    bench::row("ink area", poly::area(out) * 1e-12, "mm2");
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Slicer time per layer against mesh size: plane intersection and chaining
+// on synthetic spheres of 10k to N triangles (default 4M), one thread versus
+// all cores, then the whole pipeline (walls, skins, infill) on the
+// repository parts.
+//
+//   bench_slice [--triangles N]
+
+#include "bench_util.hpp"
+#include "mesh_util.hpp"
+
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/slicer.hpp"
+#include "pwb/stl.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t max_triangles = 4'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) max_triangles = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_slice [--triangles N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads\n", default_threads());
+
+    // A 80 mm sphere at 0.2 mm: 400 layers.
+    std::vector<double> z;
+    for (double h = -39.9; h < 40; h += 0.2) z.push_back(h);
+    std::printf("sections of a sphere, %zu layers, ms per layer:\n", z.size());
+    for (std::size_t n = 10'000; n <= max_triangles; n *= 10) {
+        if (n * 10 > max_triangles && n != max_triangles) n = max_triangles; // always finish on N
+        const std::string soup = bench::sphere_soup(n);
+        const mesh::Mesh m =
+            mesh::weld(stl::parse(reinterpret_cast<const unsigned char*>(soup.data()), soup.size(), "sphere").triangles);
+        for (unsigned threads : {1u, 0u}) {
+            const double t = bench::best_time([&] { bench::keep(slicer::sections(m, z, 1000, threads)); }, 0.2, 1);
+            char label[64];
+            std::snprintf(label, sizeof label, "%zu triangles, %s", m.triangles.size(), threads == 1 ? "1 thread" : "all threads");
+            bench::row(label, t * 1e3 / double(z.size()), "ms");
+        }
+    }
+
+    std::printf("full slice (0.2 mm, 2 walls, 20%% infill), ms per layer:\n");
+    for (const char* part : {"STL/fdm/Photogate_Top.stl", "STL/fdm/shield_design/Shield_Bottom_V1.stl"}) {
+        const stl::File f(bench::repo_path(part));
+        const mesh::Mesh m = mesh::weld(f.triangles());
+        slicer::Result r;
+        const double t = bench::best_time([&] { r = slicer::slice(m); }, 0.2, 1);
+        char label[64];
+        std::snprintf(label, sizeof label, "%s (%zu layers)", part + std::string(part).find_last_of('/') + 1, r.layers.size());
+        bench::row(label, t * 1e3 / double(r.layers.size()), "ms");
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Binary STL read throughput, in GB/s of file bytes: the reader maps the
+// file and walks the 50-byte records in place, so this is the cost of
+// touching every vertex once (extents), cold and warm.
+//
+//   bench_stl [--triangles N] [--dir DIR]
+//
+// The synthetic file (100M triangles, 5 GB by default) is written to DIR
+// (default: the system temp directory) and removed afterwards.
+
+#include "bench_util.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Materialise-style header and records with per-facet colours, written in
+// 1M-triangle blocks so the generator never holds the whole file.
+void write_synthetic(const std::string& path, std::uint64_t triangles) {
+    std::ofstream out(path, std::ios::binary);
+    char header[80];
+    std::memset(header, ' ', sizeof header);
+    const char text[] = "STLB ATF 13.20.0.188 COLOR=";
+    std::memcpy(header, text, sizeof text - 1);
+    const unsigned char color[4] = {0xa0, 0xa0, 0xa0, 0xff};
+    std::memcpy(header + sizeof text - 1, color, 4);
+    out.write(header, 80);
+    const std::uint32_t n = std::uint32_t(triangles);
+    const unsigned char count[4] = {std::uint8_t(n), std::uint8_t(n >> 8), std::uint8_t(n >> 16), std::uint8_t(n >> 24)};
+    out.write(reinterpret_cast<const char*>(count), 4);
+
+    std::mt19937 rng(61);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    std::vector<unsigned char> block;
+    for (std::uint64_t done = 0; done < triangles;) {
+        const std::uint64_t m = std::min<std::uint64_t>(triangles - done, 1 << 20);
+        block.resize(m * 50);
+        for (std::uint64_t i = 0; i < m; ++i) {
+            float f[12] = {0, 0, 1};
+            for (int k = 3; k < 12; ++k) f[k] = pos(rng);
+            std::memcpy(&block[i * 50], f, sizeof f);
+            const std::uint16_t attr = std::uint16_t(rng() & 0x7fff);
+            block[i * 50 + 48] = std::uint8_t(attr), block[i * 50 + 49] = std::uint8_t(attr >> 8);
+        }
+        out.write(reinterpret_cast<const char*>(block.data()), std::streamsize(block.size()));
+        done += m;
+    }
+    if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::uint64_t triangles = 100'000'000;
+    std::string dir = std::filesystem::temp_directory_path().string();
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--dir" && i + 1 < argc) dir = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: bench_stl [--triangles N] [--dir DIR]\n");
+            return 2;
+        }
+    }
+    if (triangles > 0xffffffffu) {
+        std::fprintf(stderr, "bench_stl: binary STL holds at most 2^32-1 triangles\n");
+        return 2;
+    }
+
+    // The repository parts first, for scale.
+    for (const char* part : {"STL/fdm/Photogate_Top.stl", "STL/fdm/Photogate_Bottom.stl"}) {
+        stl::File f(bench::repo_path(part));
+        double t = bench::best_time([&] {
+            stl::File g(f.path());
+            bench::keep(stl::bounds(g.triangles(), 1));
+        });
+        std::printf("%s: %zu triangles, %.1f KB\n", part, f.triangles().size(), f.size_bytes() / 1024.0);
+        bench::row("map + validate + extents", f.size_bytes() / t / 1e9, "GB/s");
+    }
+
+    const std::string path = dir + "/bench_stl_synthetic.stl";
+    auto t0 = std::chrono::steady_clock::now();
+    write_synthetic(path, triangles);
+    const double gb = double(84 + triangles * 50) / 1e9;
+    std::printf("synthetic: %llu triangles, %.2f GB written in %.1f s\n", static_cast<unsigned long long>(triangles), gb,
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    try {
+        t0 = std::chrono::steady_clock::now();
+        stl::File f(path);
+        bench::keep(stl::bounds(f.triangles()));
+        bench::row("first pass (page cache as left by writing)",
+                   gb / std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(), "GB/s");
+        double t = bench::best_time([&] { bench::keep(stl::bounds(f.triangles(), 1)); });
+        bench::row("extents, 1 thread", gb / t, "GB/s");
+        t = bench::best_time([&] { bench::keep(stl::bounds(f.triangles())); });
+        char label[64];
+        std::snprintf(label, sizeof label, "extents, %u threads", default_threads());
+        bench::row(label, gb / t, "GB/s");
+        t = bench::best_time([&] {
+            std::uint64_t own = 0;
+            stl::Color c;
+            const stl::TriangleView& v = f.triangles();
+            for (std::size_t i = 0; i < v.size(); ++i) own += stl::facet_color(v.attribute(i), f.header(), c);
+            bench::keep(own);
+        });
+        bench::row("facet colours, 1 thread", gb / t, "GB/s");
+    } catch (...) {
+        std::filesystem::remove(path);
+        throw;
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Beam tolerance Monte Carlo on STL/fdm/Photogate_Top/Bottom: samples per
+// second on one thread and on all, with and without per-vertex roughness and
+// at two bundle sizes, and what refitting the BVH saves over rebuilding it
+// for the whole assembled housing.
+//
+//   bench_tolerance [--samples N]
+
+#include "bench_util.hpp"
+
+#include "pwb/beam.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/tolerance.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t samples = 20'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--samples" && i + 1 < argc) samples = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_tolerance [--samples N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads\n", default_threads());
+    const stl::File top_file(bench::repo_path("STL/fdm/Photogate_Top.stl"));
+    const stl::File bottom_file(bench::repo_path("STL/fdm/Photogate_Bottom.stl"));
+    const mesh::Mesh top = mesh::weld(top_file.triangles()), bottom = mesh::weld(bottom_file.triangles());
+    const beam::Beam beam = beam::photogate();
+
+    ray::Scene scene;
+    scene.add(bottom);
+    scene.add(top);
+    const double t_build = bench::best_time([&] {
+        ray::Scene s = scene;
+        s.build();
+        bench::keep(s.tree().nodes.size());
+    });
+    scene.build();
+    std::vector<stl::Vec3> corners;
+    for (const mesh::Mesh* m : {&bottom, &top})
+        for (const mesh::Triangle& t : m->triangles)
+            for (std::uint32_t v : t) corners.push_back(m->vertices[v]);
+    const double t_refit = bench::best_time([&] { scene.refit(corners); });
+    std::printf("housing, %zu triangles\n", scene.triangles());
+    bench::row("BVH rebuild", t_build * 1e3, "ms");
+    bench::row("BVH refit", t_refit * 1e3, "ms");
+
+    char label[64];
+    struct Case {
+        const char* name;
+        float roughness;
+        int disc;
+    };
+    for (const Case& c : {Case{"12 x 12 rays, roughness", 0.05f, 12}, Case{"12 x 12 rays, no roughness", 0, 12},
+                          Case{"24 x 24 rays, roughness", 0.05f, 24}}) {
+        tolerance::Tolerances t;
+        t.roughness.width = c.roughness;
+        for (unsigned threads : {1u, 0u}) {
+            tolerance::Options o;
+            o.samples = samples;
+            o.disc = c.disc;
+            o.threads = threads;
+            tolerance::Report r;
+            const double s = bench::best_time([&] { r = tolerance::run(top, bottom, beam, t, o); }, 0.5, 1);
+            std::snprintf(label, sizeof label, "%s, %s", c.name, threads == 1 ? "1 thread" : "all threads");
+            bench::row(label, double(samples) / s, "samples/s");
+            if (threads == 1) std::printf("    yield %.2f %%, %zu triangles near the beam\n", 100 * r.yield(), r.triangles);
+        }
+    }
+    return 0;
+}
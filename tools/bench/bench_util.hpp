@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#ifndef PWB_REPO_ROOT
+#define PWB_REPO_ROOT "."
+#endif
+
+namespace pwb::bench {
+
+inline std::string repo_path(const char* relative) { return std::string(PWB_REPO_ROOT) + "/" + relative; }
+
+// Runs `fn` repeatedly for at least `min_seconds` and returns the best time of
+// a single call, in seconds. Best-of is what we want for throughput figures:
+// it filters out scheduler noise on shared lab machines.
+template <typename Fn>
+double best_time(Fn&& fn, double min_seconds = 0.5, int min_runs = 3) {
+    using clock = std::chrono::steady_clock;
+    double best = 1e300, total = 0.0;
+    for (int run = 0; run < min_runs || total < min_seconds; ++run) {
+        auto t0 = clock::now();
+        fn();
+        double dt = std::chrono::duration<double>(clock::now() - t0).count();
+        total += dt;
+        if (dt < best) best = dt;
+    }
+    return best;
+}
+
+// Keeps the optimiser from discarding a computed value.
+template <typename T>
+inline void keep(const T& value) {
+#if defined(_MSC_VER)
+    static const void* volatile sink;
+    sink = &value;
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+inline void row(const char* label, double value, const char* unit) {
+    std::printf("  %-40s %12.2f %s\n", label, value, unit);
+}
+
+} // namespace pwb::bench
@@ -0,0 +1,92 @@
+// Vertex welding and half-edge construction, in triangles per second, with
+// the memory of the soup and of the indexed mesh.
+//
+//   bench_weld [--triangles N]
+//
+// Runs over every STL in STL/fdm (loose files and the zips) and a synthetic
+// shuffled sphere soup of N triangles (default 4M).
+
+#include "bench_util.hpp"
+#include "mesh_util.hpp"
+
+#include "pwb/mesh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/stl.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void measure(const std::string& name, const pwb::stl::TriangleView& soup) {
+    using namespace pwb;
+    mesh::WeldStats st;
+    mesh::Mesh m;
+    double t = bench::best_time([&] { m = mesh::weld(soup, {}, &st); });
+    mesh::HalfEdges he;
+    double th = bench::best_time([&] { he = mesh::half_edges(m); });
+    std::printf("%s: %zu triangles, %zu corners -> %zu vertices (%.1fx); %zu open, %zu non-manifold edges\n",
+                name.c_str(), soup.size(), st.corners, st.vertices, double(st.corners) / double(std::max<std::size_t>(1, st.vertices)),
+                he.boundary, he.nonmanifold);
+    bench::row("weld", soup.size() / t / 1e6, "Mtri/s");
+    bench::row("half-edges", m.triangles.size() / th / 1e6, "Mtri/s");
+    bench::row("memory: STL records", soup.size() * 50 / 1048576.0, "MB");
+    bench::row("memory: float soup (9 floats/triangle)", soup.size() * 36 / 1048576.0, "MB");
+    bench::row("memory: indexed mesh", m.bytes() / 1048576.0, "MB");
+    bench::row("memory: + half-edges", (m.bytes() + he.bytes()) / 1048576.0, "MB");
+}
+
+bool is_stl(const std::string& name) {
+    return name.size() > 4 && (name.compare(name.size() - 4, 4, ".stl") == 0 || name.compare(name.size() - 4, 4, ".STL") == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace pwb;
+    std::size_t triangles = 4'000'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--triangles" && i + 1 < argc) triangles = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: bench_weld [--triangles N]\n");
+            return 2;
+        }
+    }
+    std::printf("%u threads\n", default_threads());
+
+    std::size_t total = 0;
+    double total_time = 0;
+    for (const auto& e : std::filesystem::recursive_directory_iterator(bench::repo_path("STL/fdm"))) {
+        const std::string path = e.path().string();
+        if (is_stl(path)) {
+            stl::File f(path);
+            total += f.triangles().size();
+            total_time += bench::best_time([&] { bench::keep(mesh::weld(f.triangles())); }, 0.1);
+        } else if (e.path().extension() == ".zip") {
+            ZipArchive zip(path);
+            for (const ZipEntry& z : zip.entries()) {
+                if (!is_stl(z.name)) continue;
+                std::string data = zip.read(z);
+                stl::View v = stl::parse(reinterpret_cast<const unsigned char*>(data.data()), data.size(), z.name);
+                total += v.triangles.size();
+                total_time += bench::best_time([&] { bench::keep(mesh::weld(v.triangles)); }, 0.1);
+            }
+        }
+    }
+    std::printf("STL/fdm parts: %zu triangles in total\n", total);
+    bench::row("weld, all parts", total / total_time / 1e6, "Mtri/s");
+
+    stl::File top(bench::repo_path("STL/fdm/Photogate_Top.stl"));
+    measure("Photogate_Top.stl", top.triangles());
+
+    std::string soup = bench::sphere_soup(triangles);
+    stl::View v = stl::parse(reinterpret_cast<const unsigned char*>(soup.data()), soup.size(), "sphere");
+    measure("synthetic sphere, shuffled", v.triangles);
+    return 0;
+}
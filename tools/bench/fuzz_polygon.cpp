@@ -0,0 +1,325 @@
+// Robustness run for the polygon boolean engine: random and deliberately
+// degenerate inputs (shared and collinear edges, spikes, repeated points,
+// near-coincident edges, huge coordinates). Every result is checked for
+// validity (closed contours, no crossings, counter-clockwise outers and
+// clockwise holes), the operations are checked against each other through
+// their areas, and each result is compared point by point with the non-zero
+// winding of the inputs at random sample points.
+//
+//   fuzz_polygon [iterations] [seed]
+//
+// Exits with status 1 on the first failing case and prints its seed.
+
+#include "pwb/polygon_ops.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace {
+
+using pwb::gerber::Coord;
+using pwb::gerber::Point;
+using pwb::gerber::PolygonSet;
+namespace poly = pwb::poly;
+
+#if defined(__SIZEOF_INT128__)
+using Wide = __int128;
+#else
+using Wide = long double;
+#endif
+
+int orient(const Point& o, const Point& a, const Point& b) {
+    Wide c = Wide(a.x - o.x) * Wide(b.y - o.y) - Wide(a.y - o.y) * Wide(b.x - o.x);
+    return c > 0 ? 1 : c < 0 ? -1 : 0;
+}
+
+class Generator {
+public:
+    explicit Generator(std::uint64_t seed) : rng_(seed) {}
+
+    PolygonSet make(int family) {
+        PolygonSet s;
+        int contours = 1 + int(rng_() % 4);
+        for (int c = 0; c < contours; ++c) {
+            switch (family) {
+            case 0: grid_polygon(s, 1000, 6); break;           // shared vertices and collinear overlaps
+            case 1: random_polygon(s, 1'000'000); break;       // general position
+            case 2: squares(s); break;                         // edge-sharing squares and reversed copies
+            case 3: spiky(s); break;                           // zero-area spikes, repeated points
+            case 4: near_coincident(s); break;                 // edges 1 nm apart
+            default: random_polygon(s, 900'000'000); break;    // large coordinates
+            }
+        }
+        return s;
+    }
+
+private:
+    Coord pick(Coord range) { return Coord(rng_() % std::uint64_t(range + 1)); }
+
+    void grid_polygon(PolygonSet& s, Coord step, int cells) {
+        int n = 3 + int(rng_() % 6);
+        for (int k = 0; k < n; ++k) s.points.push_back({pick(cells) * step, pick(cells) * step});
+        s.close();
+    }
+
+    void random_polygon(PolygonSet& s, Coord range) {
+        int n = 3 + int(rng_() % 10);
+        for (int k = 0; k < n; ++k) s.points.push_back({pick(2 * range) - range, pick(2 * range) - range});
+        s.close();
+    }
+
+    void squares(PolygonSet& s) {
+        Coord x = pick(4) * 1000, y = pick(4) * 1000, w = (1 + pick(3)) * 1000, h = (1 + pick(3)) * 1000;
+        std::vector<Point> r = {{x, y}, {x + w, y}, {x + w, y + h}, {x, y + h}};
+        if (rng_() % 3 == 0) std::swap(r[1], r[3]); // clockwise: cancels or punches a hole
+        s.points.insert(s.points.end(), r.begin(), r.end());
+        s.close();
+        if (rng_() % 4 == 0) { // exact duplicate
+            s.points.insert(s.points.end(), r.begin(), r.end());
+            s.close();
+        }
+    }
+
+    void spiky(PolygonSet& s) {
+        Coord cx = pick(10'000), cy = pick(10'000);
+        int n = 4 + int(rng_() % 8);
+        for (int k = 0; k < n; ++k) {
+            Point p{cx + pick(4) * 2500, cy + pick(4) * 2500};
+            s.points.push_back(p);
+            if (rng_() % 3 == 0) s.points.push_back(p); // repeated point
+            if (rng_() % 4 == 0) { // out-and-back spike
+                s.points.push_back({p.x + 3000, p.y});
+                s.points.push_back(p);
+            }
+        }
+        s.close();
+    }
+
+    void near_coincident(PolygonSet& s) {
+        Coord x = pick(3) * 10'000 + Coord(rng_() % 3), y = pick(3) * 10'000 + Coord(rng_() % 3);
+        Coord w = 10'000 + Coord(rng_() % 3) - 1, h = 10'000 + Coord(rng_() % 3) - 1;
+        s.points.insert(s.points.end(), {{x, y}, {x + w, y + Coord(rng_() % 2)}, {x + w, y + h}, {x, y + h}});
+        s.close();
+    }
+
+    std::mt19937_64 rng_;
+};
+
+double perimeter(const PolygonSet& s) {
+    double p = 0;
+    for (std::size_t k = 0; k < s.size(); ++k) {
+        const Point* q = s.begin(k);
+        std::size_t n = s.count(k);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Point& a = q[i];
+            const Point& b = q[i + 1 == n ? 0 : i + 1];
+            p += std::hypot(double(b.x - a.x), double(b.y - a.y));
+        }
+    }
+    return p;
+}
+
+// Closed contours of at least three distinct points, no two edges crossing.
+std::string invalid(const PolygonSet& s) {
+    struct Seg {
+        Point a, b;
+    };
+    std::vector<Seg> segs;
+    for (std::size_t k = 0; k < s.size(); ++k) {
+        const Point* q = s.begin(k);
+        std::size_t n = s.count(k);
+        if (n < 3) return "contour with fewer than 3 points";
+        for (std::size_t i = 0; i < n; ++i) {
+            const Point& a = q[i];
+            const Point& b = q[i + 1 == n ? 0 : i + 1];
+            if (a == b) return "zero-length edge";
+            segs.push_back({a, b});
+        }
+    }
+    for (std::size_t i = 0; i < segs.size(); ++i) {
+        for (std::size_t j = i + 1; j < segs.size(); ++j) {
+            const Seg &e = segs[i], &f = segs[j];
+            int o1 = orient(e.a, e.b, f.a), o2 = orient(e.a, e.b, f.b);
+            int o3 = orient(f.a, f.b, e.a), o4 = orient(f.a, f.b, e.b);
+            if (o1 * o2 < 0 && o3 * o4 < 0) return "edges cross";
+        }
+    }
+    return {};
+}
+
+// Winding number of contour k about p. The contour is scaled by two so that
+// p can sit on the half-nanometre grid, off every input vertex. Sets on_edge
+// when p lies on the contour.
+int winding(const PolygonSet& s, std::size_t k, const Point& p, bool& on_edge) {
+    const Point* q = s.begin(k);
+    std::size_t n = s.count(k);
+    int w = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const Point a{2 * q[i].x, 2 * q[i].y}, b{2 * q[i + 1 == n ? 0 : i + 1].x, 2 * q[i + 1 == n ? 0 : i + 1].y};
+        int o = orient(a, b, p);
+        if (o == 0 && std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= p.y &&
+            p.y <= std::max(a.y, b.y))
+            on_edge = true;
+        if (a.y <= p.y) {
+            if (b.y > p.y && o > 0) ++w;
+        } else if (b.y <= p.y && o < 0) {
+            --w;
+        }
+    }
+    return w;
+}
+
+int winding(const PolygonSet& s, const Point& p) {
+    bool on_edge = false;
+    int w = 0;
+    for (std::size_t k = 0; k < s.size(); ++k) w += winding(s, k, p, on_edge);
+    return w;
+}
+
+// Outer contours must run counter-clockwise and holes clockwise: a contour
+// nested inside an odd number of others is a hole. Nesting is probed at the
+// midpoint of an edge that does not touch any other contour.
+std::string misoriented(const PolygonSet& s) {
+    for (std::size_t k = 0; k < s.size(); ++k) {
+        const Point* q = s.begin(k);
+        std::size_t n = s.count(k);
+        bool probed = false;
+        for (std::size_t i = 0; i < n && !probed; ++i) {
+            const Point& a = q[i];
+            const Point& b = q[i + 1 == n ? 0 : i + 1];
+            const Point mid{a.x + b.x, a.y + b.y};
+            bool on_edge = false;
+            int depth = 0;
+            for (std::size_t j = 0; j < s.size(); ++j)
+                if (j != k) depth += std::abs(winding(s, j, mid, on_edge));
+            if (on_edge) continue;
+            probed = true;
+            bool ccw = pwb::gerber::signed_area2(q, n) > 0;
+            if (ccw != (depth % 2 == 0)) return depth % 2 ? "hole is not clockwise" : "outer is not counter-clockwise";
+        }
+    }
+    return {};
+}
+
+// Distance in nm from p (half-nanometre grid, scaled by two) to the nearest edge.
+double clearance(const PolygonSet& s, const Point& p) {
+    const double px = 0.5 * double(p.x), py = 0.5 * double(p.y);
+    double best = INFINITY;
+    for (std::size_t k = 0; k < s.size(); ++k) {
+        const Point* q = s.begin(k);
+        std::size_t n = s.count(k);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Point& a = q[i];
+            const Point& b = q[i + 1 == n ? 0 : i + 1];
+            double dx = double(b.x - a.x), dy = double(b.y - a.y), ex = px - double(a.x), ey = py - double(a.y);
+            double len2 = dx * dx + dy * dy;
+            double t = len2 > 0 ? std::clamp((ex * dx + ey * dy) / len2, 0.0, 1.0) : 0.0;
+            best = std::min(best, std::hypot(ex - t * dx, ey - t * dy));
+        }
+    }
+    return best;
+}
+
+bool filled(int a, int b, poly::Op op) {
+    switch (op) {
+    case poly::Op::Union: return a || b;
+    case poly::Op::Intersection: return a && b;
+    case poly::Op::Difference: return a && !b;
+    case poly::Op::Xor: return (a != 0) != (b != 0);
+    }
+    return false;
+}
+
+// Independent oracle: at sample points clear of every boundary, a result must
+// wind exactly once where the op of the inputs' non-zero fills is set and not
+// at all elsewhere. Half the points are spread over the inputs' box, half
+// land within 20 nm of an input vertex where the degenerate cases live.
+std::string sample(const PolygonSet& a, const PolygonSet& b, const PolygonSet* results[4], std::mt19937_64& rng) {
+    const poly::Op ops[] = {poly::Op::Union, poly::Op::Intersection, poly::Op::Difference, poly::Op::Xor};
+    const char* names[] = {"union", "intersection", "difference", "xor"};
+    Coord min_x = INT64_MAX, min_y = INT64_MAX, max_x = INT64_MIN, max_y = INT64_MIN;
+    for (const PolygonSet* s : {&a, &b})
+        for (const Point& p : s->points)
+            min_x = std::min(min_x, p.x), max_x = std::max(max_x, p.x), min_y = std::min(min_y, p.y),
+            max_y = std::max(max_y, p.y);
+    if (min_x > max_x) return {};
+    auto in = [&](Coord lo, Coord hi) { return lo + Coord(rng() % std::uint64_t(hi - lo + 1)); };
+    for (int k = 0; k < 16; ++k) {
+        Point p;
+        if (k % 2 == 0) {
+            p = {in(min_x, max_x), in(min_y, max_y)};
+        } else {
+            const PolygonSet& s = rng() % 2 ? a : b;
+            const Point& v = s.points[rng() % s.points.size()];
+            p = {v.x + in(-20, 20), v.y + in(-20, 20)};
+        }
+        p = {2 * p.x + 1, 2 * p.y + 1};
+        // Rounded crossings move boundaries by under a nanometre.
+        bool clear = clearance(a, p) > 2 && clearance(b, p) > 2;
+        for (int r = 0; r < 4 && clear; ++r) clear = clearance(*results[r], p) > 2;
+        if (!clear) continue;
+        const int wa = winding(a, p), wb = winding(b, p);
+        for (int r = 0; r < 4; ++r) {
+            if (winding(*results[r], p) != int(filled(wa, wb, ops[r])))
+                return std::string(names[r]) + " disagrees with the input windings at (" +
+                       std::to_string(double(p.x) / 2) + ", " + std::to_string(double(p.y) / 2) + ")";
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 20000;
+    const std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    const char* names[] = {"grid", "random", "squares", "spiky", "near-coincident", "large"};
+    long checked = 0;
+
+    for (long it = 0; it < iterations; ++it) {
+        const std::uint64_t case_seed = seed * 1'000'003 + std::uint64_t(it);
+        Generator gen(case_seed);
+        int family = int(case_seed % 6);
+        PolygonSet a = gen.make(family), b = gen.make(family);
+
+        PolygonSet ma = poly::merge(a), mb = poly::merge(b);
+        PolygonSet u = poly::boolean(a, b, poly::Op::Union);
+        PolygonSet in = poly::boolean(a, b, poly::Op::Intersection);
+        PolygonSet d = poly::boolean(a, b, poly::Op::Difference);
+        PolygonSet x = poly::boolean(a, b, poly::Op::Xor);
+        PolygonSet uu = poly::merge(u);
+
+        std::string why;
+        for (const PolygonSet* r : {&ma, &mb, &u, &in, &d, &x, &uu}) {
+            why = invalid(*r);
+            if (why.empty()) why = misoriented(*r);
+            if (!why.empty()) break;
+        }
+        if (why.empty()) {
+            // Every rounded crossing moves the boundary by under a nanometre.
+            double tol = 2.0 * (perimeter(a) + perimeter(b)) + 1.0;
+            double A = poly::area(ma), B = poly::area(mb), U = poly::area(u), I = poly::area(in);
+            if (std::fabs(U + I - A - B) > tol) why = "area(A|B) + area(A&B) != area(A) + area(B)";
+            else if (std::fabs(poly::area(d) - (A - I)) > tol) why = "area(A-B) != area(A) - area(A&B)";
+            else if (std::fabs(poly::area(x) - (U - I)) > tol) why = "area(A^B) != area(A|B) - area(A&B)";
+            else if (std::fabs(poly::area(uu) - U) > tol) why = "merge is not idempotent";
+            else if (A < -tol || B < -tol || I < -tol) why = "negative area";
+        }
+        if (why.empty()) {
+            const PolygonSet* results[] = {&u, &in, &d, &x};
+            std::mt19937_64 rng(case_seed);
+            why = sample(a, b, results, rng);
+        }
+        if (!why.empty()) {
+            std::printf("FAIL %s case, seed %llu: %s\n", names[family], (unsigned long long)case_seed, why.c_str());
+            return 1;
+        }
+        ++checked;
+    }
+    std::printf("%ld cases passed (seed %llu)\n", checked, (unsigned long long)seed);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "pwb/stl.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace pwb::bench {
+
+// Binary STL bytes of a closed UV sphere of `radius` cut into about
+// `triangles` facets, in random order so mesh passes see no locality.
+// Facets wind counter-clockwise seen from outside; the stored normal is the
+// (unnormalised) centroid direction.
+inline std::string sphere_soup(std::size_t triangles, float radius = 40.0f, unsigned seed = 62) {
+    const int rings = std::max(2, int(std::sqrt(double(triangles) / 2.0)));
+    const int segments = std::max(3, int(triangles / (2 * std::size_t(rings))));
+    auto point = [&](int r, int s) {
+        const double th = pwb::kPi * r / rings, ph = 2 * pwb::kPi * (s % segments) / segments;
+        return stl::Vec3{float(radius * std::sin(th) * std::cos(ph)), float(radius * std::sin(th) * std::sin(ph)),
+                         float(radius * std::cos(th))};
+    };
+    std::vector<std::array<stl::Vec3, 4>> tris; // normal, then corners
+    for (int r = 0; r < rings; ++r)
+        for (int s = 0; s < segments; ++s) {
+            const stl::Vec3 a = point(r, s), b = point(r + 1, s), c = point(r + 1, s + 1), d = point(r, s + 1);
+            if (r + 1 < rings) tris.push_back({stl::Vec3{}, a, b, c});
+            if (r > 0) tris.push_back({stl::Vec3{}, a, c, d});
+        }
+    std::shuffle(tris.begin(), tris.end(), std::mt19937(seed));
+    std::string data(84 + 50 * tris.size(), '\0');
+    const std::uint32_t n = std::uint32_t(tris.size());
+    std::memcpy(&data[80], &n, 4);
+    for (std::size_t i = 0; i < tris.size(); ++i) {
+        stl::Vec3& nrm = tris[i][0];
+        const stl::Vec3 &a = tris[i][1], &b = tris[i][2], &c = tris[i][3];
+        nrm = {(a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3, (a.z + b.z + c.z) / 3};
+        std::memcpy(&data[84 + 50 * i], tris[i].data(), 48);
+    }
+    return data;
+}
+
+} // namespace pwb::bench
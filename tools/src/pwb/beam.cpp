@@ -0,0 +1,62 @@
+#include "pwb/beam.hpp"
+
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace pwb::beam {
+
+namespace {
+
+Vec3 add(const Vec3& a, const Vec3& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+Vec3 sub(const Vec3& a, const Vec3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+Vec3 scale(const Vec3& a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+Vec3 cross(const Vec3& a, const Vec3& b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+Vec3 unit(const Vec3& a) { return scale(a, 1.0f / std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z)); }
+
+// Vogel spiral: n points of equal area share on a disc normal to `axis`.
+std::vector<Vec3> disc(const Aperture& a, const Vec3& axis, int n) {
+    const Vec3 helper = std::fabs(axis.x) < 0.9f ? Vec3{1, 0, 0} : Vec3{0, 1, 0};
+    const Vec3 u = unit(cross(axis, helper)), v = cross(axis, u);
+    const double golden = kPi * (3.0 - std::sqrt(5.0));
+    std::vector<Vec3> points(std::size_t(std::max(n, 1)));
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const double r = a.radius * std::sqrt((double(i) + 0.5) / double(points.size())), th = golden * double(i);
+        points[i] = add(a.centre, add(scale(u, float(r * std::cos(th))), scale(v, float(r * std::sin(th)))));
+    }
+    return points;
+}
+
+} // namespace
+
+Beam photogate() {
+    Beam b;
+    b.emitter = {{-34.8f, -33.0f, 9.0f}, 2.5f};
+    b.receiver = {{34.8f, -33.0f, 9.0f}, 2.5f};
+    return b;
+}
+
+std::vector<ray::Ray> bundle(const Beam& beam) {
+    const Vec3 axis = unit(sub(beam.receiver.centre, beam.emitter.centre));
+    const std::vector<Vec3> from = disc(beam.emitter, axis, beam.samples), to = disc(beam.receiver, axis, beam.samples);
+    std::vector<ray::Ray> rays;
+    rays.reserve(from.size() * to.size());
+    for (const Vec3& a : from)
+        for (const Vec3& b : to) rays.push_back({a, sub(b, a), 1.0f});
+    return rays;
+}
+
+Trace trace(const ray::Scene& scene, const Beam& beam, const ray::Options& options) {
+    const auto t0 = std::chrono::steady_clock::now();
+    const std::vector<ray::Ray> rays = bundle(beam);
+    std::vector<std::uint8_t> blocked(rays.size());
+    Trace t;
+    t.rays = rays.size();
+    t.clear = rays.size() - scene.occluded(rays.data(), rays.size(), blocked.data(), options);
+    t.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return t;
+}
+
+} // namespace pwb::beam
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "pwb/raycast.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace pwb::beam {
+
+using stl::Vec3;
+
+// A lens seen as a disc facing the other one across the gap.
+struct Aperture {
+    Vec3 centre;
+    float radius = 0;
+};
+
+struct Beam {
+    Aperture emitter;
+    Aperture receiver;
+    int samples = 96; // points per disc; the bundle has samples² rays
+};
+
+// Photogate_Top/Bottom as assembled (the STLs are already placed): the 5 mm
+// IR LED and phototransistor sit in the Ø5.5 bores on the split plane at
+// y = -33, z = 9, flange in the groove, lens starting at x = ∓34.8.
+Beam photogate();
+
+// Every emitter sample joined to every receiver sample, both discs sampled
+// on a Vogel spiral. Emitter-major, so a packet of 8 consecutive rays leaves
+// one point towards neighbouring receiver points.
+std::vector<ray::Ray> bundle(const Beam& beam);
+
+struct Trace {
+    std::size_t rays = 0;
+    std::size_t clear = 0; // lines of sight the housing does not block
+    double seconds = 0;
+
+    double fraction() const { return rays ? double(clear) / double(rays) : 0.0; }
+};
+
+Trace trace(const ray::Scene& scene, const Beam& beam, const ray::Options& options = {});
+
+struct Limits {
+    double minus = 0, plus = 0; // offsets where the fraction first falls below the threshold
+};
+
+// Walks the offset out in `step`s each way until fraction_at(offset) drops
+// below `threshold`, then bisects the last step to `step / 64`. A side that
+// never drops reports ±reach.
+template <typename Fn>
+Limits limits(Fn&& fraction_at, double threshold, double step, double reach) {
+    auto side = [&](double sign) {
+        double good = 0;
+        for (double x = step; x <= reach + 1e-9; x += step) {
+            if (fraction_at(sign * x) >= threshold) {
+                good = x;
+                continue;
+            }
+            double bad = x;
+            while (bad - good > step / 64) {
+                const double mid = (good + bad) / 2;
+                (fraction_at(sign * mid) >= threshold ? good : bad) = mid;
+            }
+            return good;
+        }
+        return reach;
+    };
+    return {-side(-1.0), side(1.0)};
+}
+
+} // namespace pwb::beam
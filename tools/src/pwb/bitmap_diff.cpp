@@ -0,0 +1,139 @@
+#include "pwb/bitmap_diff.hpp"
+
+#include "pwb/parallel.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace pwb::raster {
+
+namespace {
+
+struct Run {
+    int row;
+    int c0, c1; // [c0, c1)
+};
+
+struct TileResult {
+    std::uint64_t sum_a = 0, sum_b = 0, sum_xor = 0;
+    std::vector<Run> runs;
+    std::vector<std::size_t> row_start; // index of the first run of each row, plus an end marker
+};
+
+std::size_t find(std::vector<std::size_t>& parent, std::size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void unite(std::vector<std::size_t>& parent, std::size_t a, std::size_t b) {
+    a = find(parent, a), b = find(parent, b);
+    if (a != b) parent[std::max(a, b)] = std::min(a, b);
+}
+
+// Unions each run of one row with the 8-connected runs of the row above.
+// Both lists are sorted by column; *_base turn list positions into global ids.
+void link_rows(const Run* row, std::size_t n_row, std::size_t row_base, const Run* above, std::size_t n_above,
+               std::size_t above_base, std::vector<std::size_t>& parent) {
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < n_row; ++i) {
+        while (j < n_above && above[j].c1 < row[i].c0) ++j;
+        for (std::size_t k = j; k < n_above && above[k].c0 <= row[i].c1; ++k)
+            unite(parent, row_base + i, above_base + k);
+    }
+}
+
+} // namespace
+
+DiffResult diff(const Bitmap& a, const Bitmap& b, const DiffOptions& opt) {
+    if (a.width != b.width || a.height != b.height || a.origin_x != b.origin_x || a.origin_y != b.origin_y ||
+        a.pixel != b.pixel)
+        throw std::invalid_argument("diff: bitmaps are not on the same grid");
+
+    const int rows = std::max(1, opt.tile_rows);
+    const int tiles = (a.height + rows - 1) / rows;
+    std::vector<TileResult> results(std::size_t(std::max(tiles, 0)));
+
+    parallel_for(std::size_t(tiles), [&](std::size_t t) {
+        TileResult& res = results[t];
+        const int r0 = int(t) * rows, r1 = std::min(a.height, r0 + rows);
+        for (int r = r0; r < r1; ++r) {
+            const std::uint8_t* pa = a.row(r);
+            const std::uint8_t* pb = b.row(r);
+            res.row_start.push_back(res.runs.size());
+            std::uint64_t sa = 0, sb = 0, sx = 0;
+            int run_start = -1;
+            for (int c = 0; c < a.width; ++c) {
+                int d = int(pa[c]) - int(pb[c]);
+                sa += pa[c], sb += pb[c];
+                d = d < 0 ? -d : d;
+                sx += unsigned(d);
+                bool on = d >= opt.threshold;
+                if (on && run_start < 0) run_start = c;
+                else if (!on && run_start >= 0) {
+                    res.runs.push_back({r, run_start, c});
+                    run_start = -1;
+                }
+            }
+            if (run_start >= 0) res.runs.push_back({r, run_start, a.width});
+            res.sum_a += sa, res.sum_b += sb, res.sum_xor += sx;
+        }
+        res.row_start.push_back(res.runs.size());
+    }, opt.threads);
+
+    // Global run numbering; each tile owns a contiguous slice of `parent`.
+    std::vector<std::size_t> base(results.size() + 1, 0);
+    for (std::size_t t = 0; t < results.size(); ++t) base[t + 1] = base[t] + results[t].runs.size();
+    std::vector<std::size_t> parent(base.back());
+    std::iota(parent.begin(), parent.end(), std::size_t(0));
+
+    parallel_for(results.size(), [&](std::size_t t) {
+        const TileResult& res = results[t];
+        const Run* runs = res.runs.data();
+        for (std::size_t r = 1; r + 1 < res.row_start.size(); ++r) {
+            std::size_t cur = res.row_start[r], prev = res.row_start[r - 1];
+            link_rows(runs + cur, res.row_start[r + 1] - cur, base[t] + cur, runs + prev, cur - prev, base[t] + prev,
+                      parent);
+        }
+    }, opt.threads);
+    // Stitch the first row of each tile to the last row of the tile before it.
+    for (std::size_t t = 1; t < results.size(); ++t) {
+        const TileResult& lo = results[t];
+        const TileResult& hi = results[t - 1];
+        if (lo.row_start.size() < 2 || hi.row_start.size() < 2) continue;
+        std::size_t hi0 = hi.row_start[hi.row_start.size() - 2], hi1 = hi.row_start.back();
+        link_rows(lo.runs.data(), lo.row_start[1], base[t], hi.runs.data() + hi0, hi1 - hi0, base[t - 1] + hi0, parent);
+    }
+
+    DiffResult out;
+    const double px_mm2 = double(a.pixel) * double(a.pixel) * 1e-12;
+    std::uint64_t sa = 0, sb = 0, sx = 0;
+    for (const TileResult& r : results) sa += r.sum_a, sb += r.sum_b, sx += r.sum_xor;
+    out.area_a_mm2 = double(sa) / 255.0 * px_mm2;
+    out.area_b_mm2 = double(sb) / 255.0 * px_mm2;
+    out.xor_mm2 = double(sx) / 255.0 * px_mm2;
+
+    std::vector<gerber::Box> boxes(parent.size());
+    std::vector<std::uint64_t> pixels(parent.size(), 0);
+    for (std::size_t t = 0; t < results.size(); ++t) {
+        for (std::size_t i = 0; i < results[t].runs.size(); ++i) {
+            const Run& run = results[t].runs[i];
+            std::size_t root = find(parent, base[t] + i);
+            boxes[root].add(a.origin_x + run.c0 * a.pixel, a.origin_y + run.row * a.pixel);
+            boxes[root].add(a.origin_x + run.c1 * a.pixel, a.origin_y + (run.row + 1) * a.pixel);
+            pixels[root] += std::uint64_t(run.c1 - run.c0);
+        }
+    }
+    for (std::size_t i = 0; i < parent.size(); ++i) {
+        if (parent[i] != i || pixels[i] < std::uint64_t(opt.min_pixels)) continue;
+        out.regions.push_back({boxes[i], double(pixels[i]) * px_mm2});
+    }
+    std::sort(out.regions.begin(), out.regions.end(),
+              [](const DiffRegion& x, const DiffRegion& y) { return x.area_mm2 > y.area_mm2; });
+    return out;
+}
+
+} // namespace pwb::raster
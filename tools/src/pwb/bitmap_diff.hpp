@@ -0,0 +1,34 @@
+#pragma once
+
+#include "pwb/raster.hpp"
+
+#include <vector>
+
+namespace pwb::raster {
+
+struct DiffRegion {
+    gerber::Box box;     // nanometres
+    double area_mm2 = 0; // area of differing pixels in this region
+};
+
+struct DiffOptions {
+    int threshold = 128; // |a - b| coverage difference that counts as differing
+    int min_pixels = 4;  // smaller islands are anti-aliasing noise
+    int tile_rows = 64;
+    unsigned threads = 0;
+};
+
+struct DiffResult {
+    double area_a_mm2 = 0;
+    double area_b_mm2 = 0;
+    double xor_mm2 = 0;  // integral of |a - b| coverage
+    std::vector<DiffRegion> regions; // largest first
+};
+
+// Compares two bitmaps rendered on the same grid (same origin, pixel, size).
+// Areas are accumulated per tile in parallel; differing pixels are grouped
+// into 8-connected regions with a run-based union-find whose tiles are also
+// labelled in parallel and stitched along tile borders.
+DiffResult diff(const Bitmap& a, const Bitmap& b, const DiffOptions& options = {});
+
+} // namespace pwb::raster
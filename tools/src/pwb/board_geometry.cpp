@@ -0,0 +1,310 @@
+#include "pwb/board_geometry.hpp"
+
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pwb::eagle {
+
+namespace {
+
+using gerber::Coord;
+using gerber::PolygonSet;
+
+Coord nm(double mm) { return std::llround(mm * double(gerber::kNmPerMm)); }
+
+int segments(double radius_mm, Coord tolerance) { return gerber::circle_segments(nm(radius_mm), tolerance); }
+
+class Builder {
+public:
+    Builder(PolygonSet& out, Coord tolerance) : out_(out), tol_(tolerance) {}
+
+    void disk(double cx, double cy, double r) {
+        if (r <= 0) return;
+        int n = segments(r, tol_);
+        for (int k = 0; k < n; ++k) {
+            double t = 2 * kPi * k / n;
+            point(cx + r * std::cos(t), cy + r * std::sin(t));
+        }
+        out_.close();
+    }
+
+    void ring(double cx, double cy, double radius, double width) {
+        if (width <= 0) return disk(cx, cy, radius);
+        disk(cx, cy, radius + width / 2);
+        double inner = radius - width / 2;
+        if (inner <= 0) return;
+        int n = segments(inner, tol_);
+        for (int k = n; k-- > 0;) {
+            double t = 2 * kPi * k / n;
+            point(cx + inner * std::cos(t), cy + inner * std::sin(t));
+        }
+        out_.close();
+    }
+
+    // Segment with round caps, as EAGLE draws wires.
+    void capsule(double x0, double y0, double x1, double y1, double width) {
+        double r = width / 2;
+        if (r <= 0) return;
+        double dx = x1 - x0, dy = y1 - y0, len = std::hypot(dx, dy);
+        if (len == 0) return disk(x0, y0, r);
+        double a = std::atan2(dy, dx);
+        int n = std::max(2, segments(r, tol_) / 2);
+        for (int k = 0; k <= n; ++k) {
+            double t = a - kPi / 2 + kPi * k / n;
+            point(x1 + r * std::cos(t), y1 + r * std::sin(t));
+        }
+        for (int k = 0; k <= n; ++k) {
+            double t = a + kPi / 2 + kPi * k / n;
+            point(x0 + r * std::cos(t), y0 + r * std::sin(t));
+        }
+        out_.close();
+    }
+
+    void wire(const Wire& w, const Placement* place) {
+        double x1 = w.x1, y1 = w.y1, x2 = w.x2, y2 = w.y2;
+        if (place) place->apply(w.x1, w.y1, x1, y1), place->apply(w.x2, w.y2, x2, y2);
+        double curve = place && place->rot.mirror ? -w.curve : w.curve;
+        if (curve == 0) return capsule(x1, y1, x2, y2, w.width);
+        // Arc through both ends sweeping `curve` degrees counter-clockwise.
+        double sweep = curve * kPi / 180.0;
+        double chord = std::hypot(x2 - x1, y2 - y1);
+        double r = chord / (2 * std::sin(std::fabs(sweep) / 2));
+        double mx = (x1 + x2) / 2, my = (y1 + y2) / 2;
+        double h = std::sqrt(std::max(0.0, r * r - chord * chord / 4)) * (std::fabs(sweep) > kPi ? -1 : 1);
+        double ux = -(y2 - y1) / chord, uy = (x2 - x1) / chord;
+        double sign = sweep > 0 ? 1 : -1;
+        double cx = mx + sign * h * ux, cy = my + sign * h * uy;
+        double a0 = std::atan2(y1 - cy, x1 - cx);
+        int n = std::max(1, int(std::ceil(std::fabs(sweep) / (2 * kPi) * segments(r, tol_))));
+        double px = x1, py = y1;
+        for (int k = 1; k <= n; ++k) {
+            double t = a0 + sweep * k / n;
+            double qx = k == n ? x2 : cx + r * std::cos(t), qy = k == n ? y2 : cy + r * std::sin(t);
+            capsule(px, py, qx, qy, w.width);
+            px = qx, py = qy;
+        }
+    }
+
+    // Rectangle centred on (cx, cy), rotated by `deg`, corners rounded by `radius`.
+    void rect(double cx, double cy, double w, double h, double deg, double radius = 0) {
+        double a = deg * kPi / 180.0, c = std::cos(a), s = std::sin(a);
+        auto emit = [&](double lx, double ly) { point(cx + lx * c - ly * s, cy + lx * s + ly * c); };
+        radius = std::min({radius, w / 2, h / 2});
+        if (radius <= 0) {
+            emit(-w / 2, -h / 2), emit(w / 2, -h / 2), emit(w / 2, h / 2), emit(-w / 2, h / 2);
+        } else {
+            int n = std::max(1, segments(radius, tol_) / 4);
+            const double corners[4][2] = {{w / 2 - radius, -h / 2 + radius}, {w / 2 - radius, h / 2 - radius},
+                                          {-w / 2 + radius, h / 2 - radius}, {-w / 2 + radius, -h / 2 + radius}};
+            for (int q = 0; q < 4; ++q) {
+                for (int k = 0; k <= n; ++k) {
+                    double t = -kPi / 2 + q * kPi / 2 + (kPi / 2) * k / n;
+                    emit(corners[q][0] + radius * std::cos(t), corners[q][1] + radius * std::sin(t));
+                }
+            }
+        }
+        out_.close();
+    }
+
+    // EAGLE octagon pads: flat-to-flat equals the pad diameter.
+    void octagon(double cx, double cy, double size_x, double size_y, double deg) {
+        double a = deg * kPi / 180.0, c = std::cos(a), s = std::sin(a);
+        double e = size_y * (1 - std::tan(kPi / 8)) / 2; // corner cut
+        double hx = size_x / 2, hy = size_y / 2;
+        const double pts[8][2] = {{hx, -hy + e}, {hx, hy - e}, {hx - e, hy}, {-hx + e, hy},
+                                  {-hx, hy - e}, {-hx, -hy + e}, {-hx + e, -hy}, {hx - e, -hy}};
+        for (const auto& p : pts) point(cx + p[0] * c - p[1] * s, cy + p[0] * s + p[1] * c);
+        out_.close();
+    }
+
+    void obround(double cx, double cy, double length, double width, double deg) {
+        double a = deg * kPi / 180.0, c = std::cos(a), s = std::sin(a);
+        double d = (length - width) / 2;
+        capsule(cx - d * c, cy - d * s, cx + d * c, cy + d * s, width);
+    }
+
+    void polygon(const Polygon& p, const Placement* place) {
+        std::size_t first = out_.points.size();
+        for (const Vertex& v : p.vertices) {
+            double x = v.x, y = v.y;
+            if (place) place->apply(v.x, v.y, x, y);
+            point(x, y);
+        }
+        if (out_.points.size() - first < 3) {
+            out_.points.resize(first);
+            return;
+        }
+        if (gerber::signed_area2(out_.points.data() + first, out_.points.size() - first) < 0)
+            std::reverse(out_.points.begin() + std::ptrdiff_t(first), out_.points.end());
+        out_.close();
+        // The outline is drawn with the polygon's wire width too.
+        for (std::size_t i = 0, n = p.vertices.size(); i < n; ++i) {
+            const Vertex& a = p.vertices[i];
+            const Vertex& b = p.vertices[(i + 1) % n];
+            wire({a.x, a.y, b.x, b.y, p.width, 0, p.layer}, place);
+        }
+    }
+
+private:
+    void point(double x, double y) { out_.points.push_back({nm(x), nm(y)}); }
+
+    PolygonSet& out_;
+    Coord tol_;
+};
+
+} // namespace
+
+PolygonSet copper(const Board& board, int layer, Coord tolerance) {
+    PolygonSet set;
+    Builder b(set, tolerance);
+
+    for (const Wire& w : board.wires)
+        if (w.layer == layer) b.wire(w, nullptr);
+    for (const Circle& c : board.circles)
+        if (c.layer == layer) b.ring(c.x, c.y, c.radius, c.width);
+    for (const Rect& r : board.rects)
+        if (r.layer == layer) b.rect((r.x1 + r.x2) / 2, (r.y1 + r.y2) / 2, std::fabs(r.x2 - r.x1), std::fabs(r.y2 - r.y1), r.rot.angle);
+    for (const Polygon& p : board.polygons)
+        if (p.layer == layer) b.polygon(p, nullptr);
+
+    for (const Signal& s : board.signals) {
+        for (const Wire& w : s.wires)
+            if (w.layer == layer) b.wire(w, nullptr);
+        for (const Via& v : s.vias) b.disk(v.x, v.y, board.rules.via_diameter(v.drill, v.diameter) / 2);
+        for (const Polygon& p : s.polygons)
+            if (p.layer == layer) b.polygon(p, nullptr);
+    }
+
+    const double elongation = board.rules.ratio("psElongationLong", 100) / 100.0;
+    for (const Element& e : board.elements) {
+        const Package* pkg = board.package_of(e);
+        if (!pkg) continue;
+        Placement place = placement(e);
+        for (const Pad& p : pkg->pads) {
+            double x, y;
+            place.apply(p.x, p.y, x, y);
+            double d = board.rules.pad_diameter(p.drill, p.diameter);
+            double a = place.angle(p.rot);
+            switch (p.shape) {
+            case PadShape::Round: b.disk(x, y, d / 2); break;
+            case PadShape::Square: b.rect(x, y, d, d, a); break;
+            case PadShape::Octagon: b.octagon(x, y, d, d, a); break;
+            case PadShape::Long: b.obround(x, y, d * (1 + elongation), d, a); break;
+            case PadShape::Offset: {
+                double r = a * kPi / 180.0, shift = d * elongation / 2;
+                b.obround(x + shift * std::cos(r), y + shift * std::sin(r), d * (1 + elongation), d, a);
+                break;
+            }
+            }
+        }
+        for (const Smd& s : pkg->smds) {
+            if (place.layer(s.layer) != layer) continue;
+            double x, y;
+            place.apply(s.x, s.y, x, y);
+            double radius = s.roundness / 100.0 * std::min(s.dx, s.dy) / 2;
+            b.rect(x, y, s.dx, s.dy, place.angle(s.rot), radius);
+        }
+        for (const Wire& w : pkg->wires)
+            if (place.layer(w.layer) == layer) b.wire(w, &place);
+        for (const Circle& c : pkg->circles) {
+            if (place.layer(c.layer) != layer) continue;
+            double x, y;
+            place.apply(c.x, c.y, x, y);
+            b.ring(x, y, c.radius, c.width);
+        }
+        for (const Rect& r : pkg->rects) {
+            if (place.layer(r.layer) != layer) continue;
+            double x, y;
+            place.apply((r.x1 + r.x2) / 2, (r.y1 + r.y2) / 2, x, y);
+            b.rect(x, y, std::fabs(r.x2 - r.x1), std::fabs(r.y2 - r.y1), place.angle(r.rot));
+        }
+        for (const Polygon& p : pkg->polygons)
+            if (place.layer(p.layer) == layer) b.polygon(p, &place);
+    }
+    return set;
+}
+
+std::vector<std::pair<double, double>> outline(const Board& board, double tolerance) {
+    // Dimension wires as flattened pieces, then chained end to end.
+    struct Piece {
+        std::vector<std::pair<double, double>> points;
+        bool used = false;
+    };
+    std::vector<Piece> pieces;
+    for (const eagle::Wire& w : board.wires) {
+        if (w.layer != eagle::kDimension) continue;
+        Piece p;
+        p.points.push_back({w.x1, w.y1});
+        if (w.curve != 0) {
+            // Arc through both ends sweeping `curve` degrees counter-clockwise.
+            const double sweep = w.curve * kPi / 180.0, chord = std::hypot(w.x2 - w.x1, w.y2 - w.y1);
+            const double rad = chord / (2 * std::sin(std::fabs(sweep) / 2));
+            const double h = std::sqrt(std::max(0.0, rad * rad - chord * chord / 4)) * (std::fabs(sweep) > kPi ? -1 : 1);
+            const double ux = -(w.y2 - w.y1) / chord, uy = (w.x2 - w.x1) / chord, sign = sweep > 0 ? 1 : -1;
+            const double cx = (w.x1 + w.x2) / 2 + sign * h * ux, cy = (w.y1 + w.y2) / 2 + sign * h * uy;
+            const double a0 = std::atan2(w.y1 - cy, w.x1 - cx);
+            const double step = 2 * std::acos(std::max(-1.0, 1 - tolerance / rad));
+            const int n = std::max(1, int(std::ceil(std::fabs(sweep) / step)));
+            for (int k = 1; k < n; ++k) p.points.push_back({cx + rad * std::cos(a0 + sweep * k / n), cy + rad * std::sin(a0 + sweep * k / n)});
+        }
+        p.points.push_back({w.x2, w.y2});
+        pieces.push_back(std::move(p));
+    }
+    if (pieces.empty()) throw std::runtime_error("board has no outline on the dimension layer");
+    auto near = [](std::pair<double, double> a, std::pair<double, double> b) {
+        return std::fabs(a.first - b.first) < 1e-3 && std::fabs(a.second - b.second) < 1e-3;
+    };
+    std::vector<std::pair<double, double>> outline = pieces[0].points;
+    pieces[0].used = true;
+    for (bool grew = true; grew && !near(outline.front(), outline.back());) {
+        grew = false;
+        for (Piece& p : pieces) {
+            if (p.used) continue;
+            if (near(p.points.back(), outline.back())) std::reverse(p.points.begin(), p.points.end());
+            if (!near(p.points.front(), outline.back())) continue;
+            outline.insert(outline.end(), p.points.begin() + 1, p.points.end());
+            p.used = grew = true;
+        }
+    }
+    if (!near(outline.front(), outline.back())) throw std::runtime_error("board outline is not closed");
+    outline.pop_back();
+    double area2 = 0;
+    for (std::size_t i = 0; i < outline.size(); ++i) {
+        const auto& a = outline[i];
+        const auto& b = outline[(i + 1) % outline.size()];
+        area2 += a.first * b.second - b.first * a.second;
+    }
+    if (area2 < 0) std::reverse(outline.begin(), outline.end());
+    return outline;
+}
+
+Extent footprint(const Board& board, const Element& element) {
+    Extent e{1e300, 1e300, -1e300, -1e300};
+    const Placement place = placement(element);
+    auto add = [&](double lx, double ly, double r) {
+        double x, y;
+        place.apply(lx, ly, x, y);
+        e.x0 = std::min(e.x0, x - r), e.y0 = std::min(e.y0, y - r);
+        e.x1 = std::max(e.x1, x + r), e.y1 = std::max(e.y1, y + r);
+    };
+    add(0, 0, 0);
+    if (const Package* pkg = board.package_of(element)) {
+        auto drawn = [](int layer) { return layer == kTPlace || layer == kTDocu; }; // as drawn in the library
+        for (const Pad& p : pkg->pads) add(p.x, p.y, board.rules.pad_diameter(p.drill, p.diameter) / 2);
+        for (const Smd& p : pkg->smds) add(p.x, p.y, 0.5 * std::hypot(p.dx, p.dy));
+        for (const Wire& w : pkg->wires)
+            if (drawn(w.layer)) add(w.x1, w.y1, w.width / 2), add(w.x2, w.y2, w.width / 2);
+        for (const Circle& c : pkg->circles)
+            if (drawn(c.layer)) add(c.x, c.y, c.radius + c.width / 2);
+        for (const Rect& r : pkg->rects)
+            if (drawn(r.layer)) add(r.x1, r.y1, 0), add(r.x2, r.y2, 0), add(r.x1, r.y2, 0), add(r.x2, r.y1, 0);
+    }
+    return e;
+}
+
+} // namespace pwb::eagle
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/gerber_outline.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace pwb::eagle {
+
+// Copper of one outer layer (kTop or kBottom) as counter-clockwise polygons in
+// nanometres: signal and plain wires, vias, through-hole pads sized by the
+// design rules, SMD pads and package copper. Signal polygons are taken as
+// drawn, without pour/isolation calculation.
+gerber::PolygonSet copper(const Board& board, int layer, gerber::Coord tolerance);
+
+// The dimension-layer wires chained end to end into one closed,
+// counter-clockwise ring in millimetres, arcs flattened to within `tolerance`.
+// Throws std::runtime_error when there is no outline or it does not close.
+std::vector<std::pair<double, double>> outline(const Board& board, double tolerance = 0.05);
+
+// Box around what an element puts on the board, in millimetres: its pads and
+// SMDs and the wires, circles and rectangles of its tPlace and tDocu drawing.
+struct Extent {
+    double x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+Extent footprint(const Board& board, const Element& element);
+
+} // namespace pwb::eagle
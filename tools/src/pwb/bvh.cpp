@@ -0,0 +1,158 @@
+#include "pwb/bvh.hpp"
+
+
+namespace pwb::bvh {
+
+namespace {
+
+constexpr int kMaxBins = 64;
+constexpr int kMaxDepth = 60; // traversal stacks hold 64 entries
+
+float axis(const Vec3& v, int a) { return a == 0 ? v.x : a == 1 ? v.y : v.z; }
+
+// Build record: partitioned in place, so every pass over a node reads
+// contiguous memory instead of gathering boxes through the item indices.
+struct Ref {
+    Aabb box;
+    float c[3];
+    std::uint32_t item;
+};
+
+struct Task {
+    std::uint32_t node, first, count;
+    int depth;
+};
+
+} // namespace
+
+double Tree::sah_cost() const {
+    if (nodes.empty()) return 0;
+    const double root = nodes[0].box.area();
+    if (root <= 0) return double(items.size());
+    double cost = 0;
+    for (const Node& n : nodes) cost += n.box.area() / root * (n.count ? double(n.count) : 1.0);
+    return cost;
+}
+
+Tree build(const std::vector<Aabb>& boxes, const BuildOptions& options) {
+    Tree tree;
+    const std::size_t n = boxes.size();
+    if (n == 0) return tree;
+    const int bins = std::clamp(options.bins, 2, kMaxBins);
+    const std::uint32_t max_leaf = std::uint32_t(std::max(1, options.max_leaf));
+
+    std::vector<Ref> refs(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const Aabb& b = boxes[i];
+        refs[i] = {b, {(b.min.x + b.max.x) / 2, (b.min.y + b.max.y) / 2, (b.min.z + b.max.z) / 2}, std::uint32_t(i)};
+    }
+    tree.nodes.reserve(2 * n / max_leaf + 1);
+    tree.nodes.emplace_back();
+
+    std::vector<Task> todo{{0, 0, std::uint32_t(n), 0}};
+    while (!todo.empty()) {
+        const Task t = todo.back();
+        todo.pop_back();
+        Ref* items = refs.data() + t.first;
+        Aabb box, centres;
+        for (std::uint32_t i = 0; i < t.count; ++i)
+            box.grow(items[i].box), centres.grow(Vec3{items[i].c[0], items[i].c[1], items[i].c[2]});
+        tree.nodes[t.node].box = box;
+        auto make_leaf = [&] {
+            tree.nodes[t.node].first = t.first;
+            tree.nodes[t.node].count = t.count;
+        };
+        if (t.count <= max_leaf || t.depth >= kMaxDepth) {
+            make_leaf();
+            continue;
+        }
+
+        // Binned SAH over the centroid extent of every axis, all three binned in one sweep.
+        float lo[3], scale[3];
+        bool splittable = false;
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = axis(centres.min, a);
+            const float extent = axis(centres.max, a) - lo[a];
+            scale[a] = extent > 0 ? float(bins) / extent : 0.0f;
+            splittable |= extent > 0;
+        }
+        float best_cost = 1e30f;
+        int best_axis = -1, best_split = 0;
+        if (splittable) {
+            float bmin[3][kMaxBins][3], bmax[3][kMaxBins][3];
+            std::uint32_t bin_count[3][kMaxBins] = {};
+            for (int a = 0; a < 3; ++a)
+                for (int b = 0; b < bins; ++b)
+                    for (int k = 0; k < 3; ++k) bmin[a][b][k] = 1e30f, bmax[a][b][k] = -1e30f;
+            for (std::uint32_t i = 0; i < t.count; ++i) {
+                const Aabb& ib = items[i].box;
+                const float* c = items[i].c;
+                const float mn[3] = {ib.min.x, ib.min.y, ib.min.z}, mx[3] = {ib.max.x, ib.max.y, ib.max.z};
+                for (int a = 0; a < 3; ++a) {
+                    const int b = std::min(bins - 1, int((c[a] - lo[a]) * scale[a]));
+                    ++bin_count[a][b];
+                    for (int k = 0; k < 3; ++k) {
+                        bmin[a][b][k] = std::min(bmin[a][b][k], mn[k]);
+                        bmax[a][b][k] = std::max(bmax[a][b][k], mx[k]);
+                    }
+                }
+            }
+            for (int a = 0; a < 3; ++a) {
+                if (scale[a] == 0) continue;
+                auto bin_aabb = [&](int b) {
+                    Aabb x;
+                    x.min = {bmin[a][b][0], bmin[a][b][1], bmin[a][b][2]};
+                    x.max = {bmax[a][b][0], bmax[a][b][1], bmax[a][b][2]};
+                    return x;
+                };
+                float right_area[kMaxBins];
+                std::uint32_t right_count[kMaxBins];
+                Aabb acc;
+                std::uint32_t cnt = 0;
+                for (int b = bins - 1; b > 0; --b) {
+                    if (bin_count[a][b]) acc.grow(bin_aabb(b));
+                    cnt += bin_count[a][b];
+                    right_area[b] = acc.area(), right_count[b] = cnt;
+                }
+                acc = Aabb();
+                cnt = 0;
+                for (int b = 0; b < bins - 1; ++b) {
+                    if (bin_count[a][b]) acc.grow(bin_aabb(b));
+                    cnt += bin_count[a][b];
+                    if (cnt == 0 || right_count[b + 1] == 0) continue;
+                    const float cost = acc.area() * float(cnt) + right_area[b + 1] * float(right_count[b + 1]);
+                    if (cost < best_cost) best_cost = cost, best_axis = a, best_split = b + 1;
+                }
+            }
+        }
+
+        std::uint32_t mid;
+        const float leaf_cost = box.area() * float(t.count);
+        if (best_axis < 0) {
+            // Every centroid in one point: split the list in half so leaves stay small.
+            mid = t.count / 2;
+        } else {
+            if (best_cost + box.area() >= leaf_cost && t.count <= 4 * max_leaf) {
+                make_leaf();
+                continue;
+            }
+            const float l = lo[best_axis], sc = scale[best_axis];
+            Ref* split = std::partition(items, items + t.count, [&](const Ref& r) {
+                return std::min(bins - 1, int((r.c[best_axis] - l) * sc)) < best_split;
+            });
+            mid = std::uint32_t(split - items);
+        }
+        const std::uint32_t left = std::uint32_t(tree.nodes.size());
+        tree.nodes.emplace_back();
+        tree.nodes.emplace_back();
+        tree.nodes[t.node].first = left;
+        tree.nodes[t.node].count = 0;
+        todo.push_back({left, t.first, mid, t.depth + 1});
+        todo.push_back({left + 1, t.first + mid, t.count - mid, t.depth + 1});
+    }
+    tree.items.resize(n);
+    for (std::size_t i = 0; i < n; ++i) tree.items[i] = refs[i].item;
+    return tree;
+}
+
+} // namespace pwb::bvh
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "pwb/stl.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pwb::bvh {
+
+using stl::Vec3;
+
+struct Aabb {
+    Vec3 min{1e30f, 1e30f, 1e30f};
+    Vec3 max{-1e30f, -1e30f, -1e30f};
+
+    void grow(const Vec3& p) {
+        min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+        max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+    }
+    void grow(const Aabb& b) {
+        min = {std::min(min.x, b.min.x), std::min(min.y, b.min.y), std::min(min.z, b.min.z)};
+        max = {std::max(max.x, b.max.x), std::max(max.y, b.max.y), std::max(max.z, b.max.z)};
+    }
+    bool empty() const { return min.x > max.x; }
+    float area() const {
+        if (empty()) return 0;
+        const float dx = max.x - min.x, dy = max.y - min.y, dz = max.z - min.z;
+        return 2 * (dx * dy + dy * dz + dz * dx);
+    }
+    bool overlaps(const Aabb& b) const {
+        return min.x <= b.max.x && b.min.x <= max.x && min.y <= b.max.y && b.min.y <= max.y && min.z <= b.max.z &&
+               b.min.z <= max.z;
+    }
+};
+
+// count == 0: interior node whose children are nodes[first] and nodes[first + 1].
+// count > 0: leaf holding items[first, first + count).
+struct Node {
+    Aabb box;
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
+
+struct BuildOptions {
+    int max_leaf = 4;
+    int bins = 16;  // SAH candidates per axis and node
+};
+
+// Bounding-volume hierarchy over arbitrary boxes (triangles, usually), built
+// top-down with the binned surface-area heuristic. Node 0 is the root.
+class Tree {
+public:
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> items; // leaf contents, indices into the input boxes
+
+    bool empty() const { return items.empty(); }
+    std::size_t bytes() const { return nodes.size() * sizeof(Node) + items.size() * sizeof(std::uint32_t); }
+    // SAH cost relative to a single leaf, for comparing builds.
+    double sah_cost() const;
+    // Recomputes every box bottom-up, keeping the tree's shape: far cheaper
+    // than a rebuild while the items only move a little. box_of(k) is the new
+    // box of items[k], so callers holding items in leaf order read them in turn.
+    template <typename BoxOf>
+    void refit(BoxOf&& box_of) {
+        // Children are always stored after their parent.
+        for (std::size_t i = nodes.size(); i-- > 0;) {
+            Node& n = nodes[i];
+            Aabb box; // built in registers, not through the node
+            if (n.count) {
+                for (std::uint32_t k = n.first; k < n.first + n.count; ++k) box.grow(box_of(k));
+            } else {
+                box = nodes[n.first].box;
+                box.grow(nodes[n.first + 1].box);
+            }
+            n.box = box;
+        }
+    }
+
+    // Calls fn(item) for every item whose box overlaps `query`.
+    template <typename Fn>
+    void overlapping(const Aabb& query, Fn&& fn) const {
+        if (nodes.empty()) return;
+        std::uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top) {
+            const Node& n = nodes[stack[--top]];
+            if (!n.box.overlaps(query)) continue;
+            if (n.count) {
+                for (std::uint32_t i = n.first; i < n.first + n.count; ++i) fn(items[i]);
+            } else {
+                stack[top++] = n.first;
+                stack[top++] = n.first + 1;
+            }
+        }
+    }
+};
+
+Tree build(const std::vector<Aabb>& boxes, const BuildOptions& options = {});
+
+} // namespace pwb::bvh
@@ -0,0 +1,275 @@
+#include "pwb/copper_area.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/raster.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace pwb::copper {
+
+namespace {
+
+using gerber::Box;
+using gerber::Coord;
+using gerber::Point;
+using gerber::PolygonSet;
+
+constexpr int kCacheVersion = 1;
+
+// Non-zero winding of (x, y) against the given contours.
+int winding(const PolygonSet& set, std::size_t first, std::size_t last, double x, double y) {
+    int w = 0;
+    for (std::size_t k = first; k < last; ++k) {
+        const Point* p = set.begin(k);
+        std::size_t n = set.count(k);
+        for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+            double ax = double(p[j].x), ay = double(p[j].y), bx = double(p[i].x), by = double(p[i].y);
+            double side = (bx - ax) * (y - ay) - (x - ax) * (by - ay);
+            if (ay <= y && by > y && side > 0) ++w;
+            else if (ay > y && by <= y && side < 0) --w;
+        }
+    }
+    return w;
+}
+
+PolygonSet merged_layer(const gerber::Layer& layer, Coord tolerance) {
+    std::vector<bool> clear;
+    for (const gerber::Level& l : layer.levels) clear.push_back(l.polarity == gerber::Polarity::Clear);
+    return poly::flatten(gerber::layer_outlines(layer, tolerance), clear);
+}
+
+Box snap(Box b, Coord cell) {
+    auto down = [&](Coord v) { return (v >= 0 ? v : v - cell + 1) / cell * cell; };
+    b.min_x = down(b.min_x), b.min_y = down(b.min_y);
+    b.max_x = down(b.max_x) + cell, b.max_y = down(b.max_y) + cell;
+    return b;
+}
+
+Heatmap heatmap(const PolygonSet& copper, const Box& window, const Options& opt, unsigned threads) {
+    Heatmap h;
+    h.cell = opt.cell;
+    h.origin_x = window.min_x, h.origin_y = window.min_y;
+    h.cols = int(window.width() / opt.cell), h.rows = int(window.height() / opt.cell);
+    h.density.assign(std::size_t(h.cols) * std::size_t(h.rows), 0.0f);
+
+    raster::Options ro;
+    ro.pixel = std::max<Coord>(1, opt.pixel);
+    ro.window = window;
+    ro.threads = threads;
+    raster::Bitmap bmp = raster::rasterise(std::vector<PolygonSet>{copper}, {}, ro);
+    std::vector<double> sum(h.density.size(), 0.0), count(h.density.size(), 0.0);
+    for (int r = 0; r < bmp.height; ++r) {
+        int cr = int((Coord(r) * bmp.pixel) / opt.cell);
+        if (cr >= h.rows) break;
+        const std::uint8_t* row = bmp.row(r);
+        for (int c = 0; c < bmp.width; ++c) {
+            int cc = int((Coord(c) * bmp.pixel) / opt.cell);
+            if (cc >= h.cols) break;
+            std::size_t i = std::size_t(cr) * std::size_t(h.cols) + std::size_t(cc);
+            sum[i] += row[c];
+            count[i] += 255.0;
+        }
+    }
+    for (std::size_t i = 0; i < sum.size(); ++i) h.density[i] = count[i] > 0 ? float(sum[i] / count[i]) : 0.0f;
+    return h;
+}
+
+std::string cache_path(const std::string& dir, std::uint64_t key) {
+    char name[40];
+    std::snprintf(name, sizeof name, "copper-%016llx.txt", static_cast<unsigned long long>(key));
+    return dir + "/" + name;
+}
+
+void save(const LayerResult& r, const std::string& path) {
+    std::ofstream out(path + ".tmp");
+    out.precision(17);
+    out << "pwb-copper " << kCacheVersion << "\n" << r.area << " " << r.exposed << "\n";
+    const Heatmap& h = r.heatmap;
+    out << h.cols << " " << h.rows << " " << h.cell << " " << h.origin_x << " " << h.origin_y << "\n";
+    for (float d : h.density) out << d << " ";
+    out << "\n" << r.islands.size() << "\n";
+    for (const Island& is : r.islands) {
+        out << is.area << " " << is.outline.size() << "\n";
+        for (std::size_t k = 0; k < is.outline.size(); ++k) {
+            out << is.outline.count(k);
+            for (std::size_t i = 0; i < is.outline.count(k); ++i) out << " " << is.outline.begin(k)[i].x << " " << is.outline.begin(k)[i].y;
+            out << "\n";
+        }
+    }
+    out.close();
+    // Rename so a concurrent reader never sees a half-written entry.
+    std::error_code ec;
+    if (out) std::filesystem::rename(path + ".tmp", path, ec);
+}
+
+bool load(LayerResult& r, const std::string& path) {
+    std::ifstream in(path);
+    std::string magic;
+    int version = 0;
+    if (!(in >> magic >> version) || magic != "pwb-copper" || version != kCacheVersion) return false;
+    Heatmap& h = r.heatmap;
+    in >> r.area >> r.exposed >> h.cols >> h.rows >> h.cell >> h.origin_x >> h.origin_y;
+    if (!in || h.cols < 0 || h.rows < 0) return false;
+    h.density.resize(std::size_t(h.cols) * std::size_t(h.rows));
+    for (float& d : h.density) in >> d;
+    std::size_t n = 0;
+    in >> n;
+    r.islands.resize(in ? n : 0);
+    for (Island& is : r.islands) {
+        std::size_t contours = 0;
+        in >> is.area >> contours;
+        for (std::size_t k = 0; k < contours && in; ++k) {
+            std::size_t pts = 0;
+            in >> pts;
+            for (std::size_t i = 0; i < pts && in; ++i) {
+                Point p;
+                in >> p.x >> p.y;
+                is.outline.points.push_back(p);
+                is.box.add(p.x, p.y);
+            }
+            is.outline.close();
+        }
+    }
+    return bool(in);
+}
+
+} // namespace
+
+bool Island::contains(double x, double y) const {
+    if (x < double(box.min_x) || x > double(box.max_x) || y < double(box.min_y) || y > double(box.max_y)) return false;
+    return winding(outline, 0, outline.size(), x, y) != 0;
+}
+
+void Heatmap::write_pgm(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("cannot write " + path);
+    std::fprintf(f, "P5\n%d %d\n255\n", cols, rows);
+    for (int r = rows - 1; r >= 0; --r)
+        for (int c = 0; c < cols; ++c) std::fputc(int(at(c, r) * 255.0f + 0.5f), f);
+    std::fclose(f);
+}
+
+std::uint64_t content_hash(std::string_view data, std::uint64_t h) {
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+std::vector<Island> islands(const PolygonSet& merged) {
+    std::vector<std::size_t> outers, holes;
+    std::vector<double> areas(merged.size());
+    for (std::size_t k = 0; k < merged.size(); ++k) {
+        areas[k] = gerber::signed_area2(merged.begin(k), merged.count(k)) / 2;
+        (areas[k] > 0 ? outers : holes).push_back(k);
+    }
+    std::vector<Island> out(outers.size());
+    std::vector<std::vector<std::size_t>> owned(outers.size());
+    for (std::size_t i = 0; i < outers.size(); ++i) {
+        const Point* p = merged.begin(outers[i]);
+        for (std::size_t j = 0; j < merged.count(outers[i]); ++j) out[i].box.add(p[j].x, p[j].y);
+    }
+    for (std::size_t h : holes) {
+        // Midpoint of a hole edge: output edges never overlap, so it is strictly
+        // inside or outside each outer contour.
+        const Point* p = merged.begin(h);
+        double x = (double(p[0].x) + double(p[1].x)) / 2, y = (double(p[0].y) + double(p[1].y)) / 2;
+        std::size_t best = outers.size();
+        for (std::size_t i = 0; i < outers.size(); ++i) {
+            const Box& b = out[i].box;
+            if (x < double(b.min_x) || x > double(b.max_x) || y < double(b.min_y) || y > double(b.max_y)) continue;
+            if (winding(merged, outers[i], outers[i] + 1, x, y) == 0) continue;
+            if (best == outers.size() || areas[outers[i]] < areas[outers[best]]) best = i;
+        }
+        if (best < outers.size()) owned[best].push_back(h);
+    }
+    for (std::size_t i = 0; i < outers.size(); ++i) {
+        Island& is = out[i];
+        double a = areas[outers[i]];
+        std::vector<std::size_t> contours{outers[i]};
+        contours.insert(contours.end(), owned[i].begin(), owned[i].end());
+        for (std::size_t k : contours) {
+            is.outline.points.insert(is.outline.points.end(), merged.begin(k), merged.begin(k) + merged.count(k));
+            is.outline.close();
+            if (k != outers[i]) a += areas[k];
+        }
+        is.area = a * 1e-12;
+    }
+    return out;
+}
+
+std::string default_cache_dir() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) return std::string(xdg) + "/pwb";
+    if (const char* home = std::getenv("HOME"); home && *home) return std::string(home) + "/.cache/pwb";
+    return {};
+}
+
+std::vector<LayerResult> analyse(const std::vector<LayerInput>& layers, const Options& options) {
+    if (options.cell <= 0) throw std::invalid_argument("copper: heatmap cell must be positive");
+    const std::size_t n = layers.size();
+    std::vector<gerber::Layer> parsed(n), masks(n);
+    parallel_for(
+        n,
+        [&](std::size_t i) {
+            parsed[i] = gerber::parse(layers[i].gerber);
+            if (!layers[i].mask.empty()) masks[i] = gerber::parse(layers[i].mask);
+        },
+        options.threads);
+
+    Box window = options.window;
+    if (window.empty()) {
+        for (const gerber::Layer& l : parsed) {
+            Box b = l.bounds();
+            if (!b.empty()) window.add(b.min_x, b.min_y), window.add(b.max_x, b.max_y);
+        }
+    }
+    if (!window.empty()) window = snap(window, options.cell);
+
+    std::ostringstream opts;
+    opts << options.tolerance << "/" << options.cell << "/" << options.pixel << "/" << window.min_x << "/"
+         << window.min_y << "/" << window.max_x << "/" << window.max_y;
+    const std::string opt_key = opts.str();
+    if (!options.cache_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(options.cache_dir, ec);
+    }
+
+    std::vector<LayerResult> results(n);
+    // Layers are the unit of parallelism; the raster inside each runs single-threaded.
+    const unsigned inner = n > 1 ? 1u : options.threads;
+    parallel_for(
+        n,
+        [&](std::size_t i) {
+            LayerResult& r = results[i];
+            r.name = layers[i].name;
+            r.key = content_hash(opt_key, content_hash(layers[i].mask, content_hash(layers[i].gerber)));
+            const std::string path = options.cache_dir.empty() ? std::string() : cache_path(options.cache_dir, r.key);
+            if (!path.empty() && load(r, path)) {
+                r.from_cache = true;
+                return;
+            }
+            r.islands.clear();
+            PolygonSet copper = merged_layer(parsed[i], options.tolerance);
+            r.area = poly::area(copper) * 1e-12;
+            r.exposed = -1;
+            if (!layers[i].mask.empty()) {
+                PolygonSet mask = merged_layer(masks[i], options.tolerance);
+                r.exposed = poly::area(poly::boolean(copper, mask, poly::Op::Intersection)) * 1e-12;
+            }
+            r.islands = islands(copper);
+            if (!window.empty()) r.heatmap = heatmap(copper, window, options, inner);
+            if (!path.empty()) save(r, path);
+        },
+        options.threads);
+    return results;
+}
+
+} // namespace pwb::copper
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pwb::copper {
+
+// One connected piece of copper: outer contour first, then its holes.
+struct Island {
+    gerber::PolygonSet outline;
+    gerber::Box box;
+    double area = 0; // mm²
+
+    bool contains(double x, double y) const; // nm
+};
+
+// Copper fraction per grid cell; row 0 is the bottom of the window.
+struct Heatmap {
+    int cols = 0, rows = 0;
+    gerber::Coord cell = 0;
+    gerber::Coord origin_x = 0, origin_y = 0;
+    std::vector<float> density;
+
+    float at(int c, int r) const { return density[std::size_t(r) * std::size_t(cols) + std::size_t(c)]; }
+    void write_pgm(const std::string& path) const; // one pixel per cell, white = full copper
+};
+
+struct LayerInput {
+    std::string name;
+    std::string gerber;
+    std::string mask; // matching soldermask image, empty if none
+};
+
+struct LayerResult {
+    std::string name;
+    std::uint64_t key = 0; // cache key: content hashes and options
+    double area = 0;       // filled copper, mm²
+    double exposed = 0;    // copper inside soldermask openings, mm² (-1 without a mask)
+    std::vector<Island> islands;
+    Heatmap heatmap;
+    bool from_cache = false;
+};
+
+struct Options {
+    gerber::Coord tolerance = 1000;     // arc flattening, 1 µm
+    gerber::Coord cell = 2'500'000;     // heatmap cell, 2.5 mm
+    gerber::Coord pixel = 50'000;       // coverage raster behind the heatmap, 50 µm
+    gerber::Box window;                 // heatmap window; empty = union of all layer bounds
+    std::string cache_dir;              // empty = no cache
+    unsigned threads = 0;               // layers run concurrently; 0 = all cores
+};
+
+// 64-bit FNV-1a.
+std::uint64_t content_hash(std::string_view data, std::uint64_t seed = 0xcbf29ce484222325ull);
+
+// Splits a merged polygon set into islands, holes attached to the smallest
+// outer contour around them.
+std::vector<Island> islands(const gerber::PolygonSet& merged);
+
+// Area, islands and heatmap of each layer. Results are cached per layer under
+// options.cache_dir, keyed by the hash of the Gerber text (and mask) plus the
+// options that affect the numbers.
+std::vector<LayerResult> analyse(const std::vector<LayerInput>& layers, const Options& options = {});
+
+// "$XDG_CACHE_HOME/pwb" or "~/.cache/pwb"; empty when neither is set.
+std::string default_cache_dir();
+
+} // namespace pwb::copper
@@ -0,0 +1,484 @@
+#include "pwb/drawing.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/slicer.hpp"
+#include "pwb/util.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace pwb::drawing {
+
+namespace {
+
+// An edge to draw, with the direction its rays start off in.
+struct Edge {
+    D3 a, b, nudge;
+    std::uint32_t first = 0, count = 0; // samples
+};
+
+struct Change {
+    std::uint32_t edge, sample; // between sample and sample + 1
+    double s = 0;               // refined position along the edge, 0..1
+};
+
+// "12,5": one decimal unless whole, comma as on Brazilian drawings.
+std::string dimension(double v) {
+    char buf[32];
+    if (std::abs(v - std::round(v)) < 0.05) std::snprintf(buf, sizeof buf, "%.0f", v);
+    else std::snprintf(buf, sizeof buf, "%.1f", v);
+    std::string s = buf;
+    std::replace(s.begin(), s.end(), '.', ',');
+    return s;
+}
+
+std::string num(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.3f", v);
+    std::string s = buf;
+    while (s.back() == '0') s.pop_back();
+    if (s.back() == '.') s.pop_back();
+    return s == "-0" ? "0" : s;
+}
+
+// Non-zero spans of `loops` along lines at `angle` degrees, `spacing` apart.
+std::vector<Segment> hatch(const std::vector<Page::Polygon>& loops, double spacing, double angle) {
+    const double c = std::cos(angle * kPi / 180), s = std::sin(angle * kPi / 180);
+    // Rotate by -angle so the hatch runs along x.
+    auto rot = [&](std::pair<double, double> p) { return std::pair{p.first * c + p.second * s, -p.first * s + p.second * c}; };
+    double lo = 1e300, hi = -1e300;
+    std::vector<Page::Polygon> r;
+    for (const Page::Polygon& loop : loops) {
+        r.emplace_back();
+        for (const auto& p : loop) {
+            r.back().push_back(rot(p));
+            lo = std::min(lo, r.back().back().second), hi = std::max(hi, r.back().back().second);
+        }
+    }
+    std::vector<Segment> out;
+    std::vector<std::pair<double, int>> crossings;
+    for (double y = std::ceil(lo / spacing) * spacing; y < hi; y += spacing) {
+        crossings.clear();
+        for (const Page::Polygon& loop : r)
+            for (std::size_t i = 0; i < loop.size(); ++i) {
+                const auto& p = loop[i];
+                const auto& q = loop[(i + 1) % loop.size()];
+                if ((p.second <= y) == (q.second <= y)) continue;
+                const double x = p.first + (y - p.second) * (q.first - p.first) / (q.second - p.second);
+                crossings.push_back({x, q.second > p.second ? 1 : -1});
+            }
+        std::sort(crossings.begin(), crossings.end());
+        int winding = 0;
+        for (std::size_t i = 0; i + 1 < crossings.size(); ++i) {
+            winding += crossings[i].second;
+            if (winding == 0) continue;
+            const double x0 = crossings[i].first, x1 = crossings[i + 1].first;
+            out.push_back({x0 * c - y * s, x0 * s + y * c, x1 * c - y * s, x1 * s + y * c});
+        }
+    }
+    return out;
+}
+
+// Helvetica advance widths for 32..126, in 1/1000 em.
+constexpr short kHelvetica[95] = {
+    278, 278, 355, 556, 556, 889, 667, 191, 333, 333, 389, 584, 278, 333, 278, 278, 556, 556, 556, 556, 556, 556, 556, 556,
+    556, 556, 278, 278, 584, 584, 584, 556, 1015, 667, 667, 722, 722, 667, 611, 778, 722, 278, 500, 667, 556, 833, 722, 778,
+    667, 778, 722, 667, 611, 722, 667, 944, 667, 667, 611, 278, 278, 278, 469, 556, 333, 556, 556, 500, 556, 556, 278, 556,
+    556, 222, 222, 500, 222, 833, 556, 556, 556, 556, 333, 500, 278, 556, 500, 722, 500, 500, 500, 334, 260, 334, 584};
+
+// UTF-8 to the single-byte WinAnsi encoding (Latin-1 for what we print).
+std::string latin1(const std::string& s) {
+    std::string out;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        if (c < 0x80) out += char(c);
+        else if ((c & 0xe0) == 0xc0 && i + 1 < s.size()) out += char(((c & 0x1f) << 6) | (s[++i] & 0x3f));
+        else out += '?';
+    }
+    return out;
+}
+
+double text_width(const std::string& latin, double size) {
+    double w = 0;
+    for (char ch : latin) {
+        const auto c = static_cast<unsigned char>(ch);
+        w += c >= 32 && c <= 126 ? kHelvetica[c - 32] : c == 0xba ? 365 : 556;
+    }
+    return w * size / 1000;
+}
+
+} // namespace
+
+Frame front() { return {{1, 0, 0}, {0, 0, 1}, {0, -1, 0}}; }
+Frame top() { return {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}; }
+Frame left() { return {{0, -1, 0}, {0, 0, 1}, {-1, 0, 0}}; }
+
+Frame facing(const Vec3& normal) {
+    const D3 t = unit(d3(normal));
+    if (dot(t, t) == 0) throw std::invalid_argument("drawing: zero plane normal");
+    D3 up = sub({0, 0, 1}, mul(t, t.z));
+    if (dot(up, up) < 1e-6) up = sub({0, 1, 0}, mul(t, t.y));
+    up = unit(up);
+    return {f3(cross(up, t)), f3(up), f3(t)};
+}
+
+std::vector<PolygonSet> sections(const mesh::Mesh& mesh, const Frame& frame, const std::vector<double>& offsets,
+                                 unsigned threads) {
+    const D3 r = d3(frame.right), u = d3(frame.up), t = d3(frame.toward);
+    mesh::Mesh turned;
+    turned.triangles = mesh.triangles;
+    turned.vertices.reserve(mesh.vertices.size());
+    for (const Vec3& v : mesh.vertices) {
+        const D3 p = d3(v);
+        turned.vertices.push_back(f3({dot(p, r), dot(p, u), dot(p, t)}));
+    }
+    return slicer::sections(turned, offsets, 1000, threads);
+}
+
+Projection project(const mesh::Mesh& mesh, const mesh::HalfEdges& he, const ray::Scene& scene, const Frame& frame,
+                   const Options& o) {
+    Projection pr;
+    if (mesh.triangles.empty()) return pr;
+    const D3 right = d3(frame.right), up = d3(frame.up), toward = d3(frame.toward);
+    pr.min_x = pr.min_y = 1e300, pr.max_x = pr.max_y = -1e300;
+    D3 lo{1e300, 1e300, 1e300}, hi{-1e300, -1e300, -1e300};
+    for (const Vec3& v : mesh.vertices) {
+        const D3 p = d3(v);
+        pr.min_x = std::min(pr.min_x, dot(p, right)), pr.max_x = std::max(pr.max_x, dot(p, right));
+        pr.min_y = std::min(pr.min_y, dot(p, up)), pr.max_y = std::max(pr.max_y, dot(p, up));
+        lo = {std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z)};
+        hi = {std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z)};
+    }
+    const double diagonal = std::sqrt(dot(sub(hi, lo), sub(hi, lo)));
+    const double step = o.sample > 0 ? o.sample : diagonal / 2000;
+    const double eps = diagonal * 1e-4;
+    const double sharp = std::cos(o.feature_angle * kPi / 180);
+
+    std::vector<D3> normals(mesh.triangles.size());
+    for (std::size_t t = 0; t < normals.size(); ++t) {
+        const mesh::Triangle& tri = mesh.triangles[t];
+        const D3 a = d3(mesh.vertices[tri[0]]);
+        normals[t] = unit(cross(sub(d3(mesh.vertices[tri[1]]), a), sub(d3(mesh.vertices[tri[2]]), a)));
+    }
+
+    std::vector<Edge> edges;
+    std::uint32_t samples = 0;
+    for (std::uint32_t h = 0; h < he.twin.size(); ++h) {
+        const std::uint32_t twin = he.twin[h];
+        if (twin != mesh::kNone && twin < h) continue;
+        const D3& n1 = normals[h / 3];
+        D3 nudge = n1;
+        if (twin != mesh::kNone) {
+            const D3& n2 = normals[twin / 3];
+            const double f1 = dot(n1, toward), f2 = dot(n2, toward);
+            const bool silhouette = (f1 > 1e-9) != (f2 > 1e-9);
+            if (dot(n1, n2) >= sharp && !silhouette) continue;
+            nudge = unit(add(n1, n2));
+        }
+        const mesh::Triangle& tri = mesh.triangles[h / 3];
+        Edge e{d3(mesh.vertices[tri[h % 3]]), d3(mesh.vertices[tri[(h + 1) % 3]]), nudge};
+        const D3 d = sub(e.b, e.a);
+        const double length = std::hypot(dot(d, right), dot(d, up));
+        if (length < diagonal * 1e-7) continue; // seen end on
+        e.first = samples;
+        e.count = std::uint32_t(std::clamp(std::ceil(length / step), 1.0, 1e5));
+        samples += e.count;
+        edges.push_back(e);
+    }
+    pr.edges = edges.size();
+
+    // Samples at the middle of each of an edge's `count` pieces, so no ray
+    // starts on a vertex.
+    auto origin = [&](const Edge& e, double s) { return add(add(e.a, mul(sub(e.b, e.a), s)), mul(add(e.nudge, toward), eps)); };
+    const float reach = float(2 * diagonal);
+    std::vector<ray::Ray> rays(samples);
+    for (const Edge& e : edges)
+        for (std::uint32_t i = 0; i < e.count; ++i)
+            rays[e.first + i] = {f3(origin(e, (i + 0.5) / e.count)), f3(toward), reach};
+    std::vector<std::uint8_t> blocked(samples);
+    scene.occluded(rays.data(), rays.size(), blocked.data(), {o.threads, true});
+    pr.rays = samples;
+
+    std::vector<Change> changes;
+    for (std::uint32_t k = 0; k < edges.size(); ++k)
+        for (std::uint32_t i = edges[k].first; i + 1 < edges[k].first + edges[k].count; ++i)
+            if (blocked[i] != blocked[i + 1]) changes.push_back({k, i - edges[k].first});
+    const std::size_t chunk = 256;
+    parallel_for(
+        (changes.size() + chunk - 1) / chunk,
+        [&](std::size_t c) {
+            for (std::size_t j = c * chunk; j < std::min(changes.size(), (c + 1) * chunk); ++j) {
+                Change& ch = changes[j];
+                const Edge& e = edges[ch.edge];
+                const bool first = blocked[e.first + ch.sample];
+                double a = (ch.sample + 0.5) / e.count, b = (ch.sample + 1.5) / e.count;
+                for (int it = 0; it < 10; ++it) {
+                    const double m = (a + b) / 2;
+                    const bool hit = scene.occluded(ray::Ray{f3(origin(e, m)), f3(toward), reach});
+                    (hit == first ? a : b) = m;
+                }
+                ch.s = (a + b) / 2;
+            }
+        },
+        o.threads);
+    pr.rays += changes.size() * 10;
+
+    std::size_t next = 0;
+    for (std::uint32_t k = 0; k < edges.size(); ++k) {
+        const Edge& e = edges[k];
+        auto emit = [&](double s0, double s1, bool hidden) {
+            if (hidden && !o.hidden) return;
+            const D3 p = add(e.a, mul(sub(e.b, e.a), s0)), q = add(e.a, mul(sub(e.b, e.a), s1));
+            (hidden ? pr.hidden : pr.visible).push_back({dot(p, right), dot(p, up), dot(q, right), dot(q, up)});
+        };
+        double start = 0;
+        for (; next < changes.size() && changes[next].edge == k; ++next) {
+            emit(start, changes[next].s, blocked[e.first + changes[next].sample]);
+            start = changes[next].s;
+        }
+        emit(start, 1, blocked[e.first + e.count - 1]);
+    }
+    return pr;
+}
+
+Page layout(const std::string& title, const View& front, const View& top, const View& left, const std::vector<Cut>& cuts) {
+    // Everything placed as a box of model extents; cuts in mm.
+    struct Item {
+        std::string label;
+        const Projection* projection = nullptr;
+        std::vector<Page::Polygon> loops; // model mm
+        double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+        int row = 0, col = 0;
+        double w() const { return max_x - min_x; }
+        double h() const { return max_y - min_y; }
+    };
+    std::vector<Item> items;
+    for (const auto& [view, row, col] : {std::tuple{&front, 0, 0}, std::tuple{&top, 1, 0}, std::tuple{&left, 0, 1}}) {
+        const Projection& p = view->projection;
+        items.push_back({view->label, &p, {}, p.min_x, p.min_y, p.max_x, p.max_y, row, col});
+    }
+    for (std::size_t i = 0; i < cuts.size(); ++i) {
+        Item it;
+        it.label = "CORTE " + cuts[i].label + " (" + cuts[i].plane + ")";
+        it.min_x = it.min_y = 1e300, it.max_x = it.max_y = -1e300;
+        const PolygonSet& r = cuts[i].region;
+        for (std::size_t k = 0; k < r.size(); ++k) {
+            it.loops.emplace_back();
+            for (std::size_t j = 0; j < r.count(k); ++j) {
+                const double x = double(r.begin(k)[j].x) / gerber::kNmPerMm, y = double(r.begin(k)[j].y) / gerber::kNmPerMm;
+                it.loops.back().push_back({x, y});
+                it.min_x = std::min(it.min_x, x), it.max_x = std::max(it.max_x, x);
+                it.min_y = std::min(it.min_y, y), it.max_y = std::max(it.max_y, y);
+            }
+        }
+        if (it.loops.empty()) it.min_x = it.min_y = it.max_x = it.max_y = 0;
+        // Filling the grid column by column after the left view: (1,1), (0,2), (1,2), (0,3) ...
+        it.row = int((i + 1) % 2), it.col = int(1 + (i + 1) / 2);
+        items.push_back(std::move(it));
+    }
+
+    const double margin = 10, label_space = 9, dim_space = 14, title_h = 26, title_w = 130;
+    int cols = 0;
+    for (const Item& it : items) cols = std::max(cols, it.col + 1);
+    Page page;
+    double scale = 0;
+    std::vector<double> col_w(std::size_t(cols), 0), row_h(2, 0);
+    auto fits = [&](double s, double w, double h) {
+        std::fill(col_w.begin(), col_w.end(), 0), std::fill(row_h.begin(), row_h.end(), 0);
+        for (const Item& it : items) {
+            col_w[std::size_t(it.col)] = std::max(col_w[std::size_t(it.col)], it.w() * s + dim_space + 6);
+            row_h[std::size_t(it.row)] = std::max(row_h[std::size_t(it.row)], it.h() * s + label_space + dim_space);
+        }
+        double tw = 2 * margin, th = 2 * margin + title_h;
+        for (double c : col_w) tw += c;
+        for (double r : row_h) th += r;
+        return tw <= w && th <= h;
+    };
+    for (auto [w, h] : {std::pair{297.0, 210.0}, std::pair{420.0, 297.0}}) {
+        for (double s : {5.0, 2.0, 1.0, 0.5, 0.2, 0.1, 0.05, 0.02})
+            if (fits(s, w, h)) {
+                scale = s;
+                break;
+            }
+        page.width = w, page.height = h;
+        if (scale > 0) break;
+    }
+    if (scale == 0) fits(scale = 0.02, page.width, page.height);
+
+    auto line = [&](double x0, double y0, double x1, double y1, double width, bool dashed = false) {
+        page.lines.push_back({x0, y0, x1, y1, width, dashed});
+    };
+    auto arrow = [&](double x, double y, double dx, double dy) { // tip at (x, y), pointing along (dx, dy)
+        const double l = 2.5, w = 0.6;
+        page.fills.push_back({{x, y}, {x - dx * l - dy * w, y - dy * l + dx * w}, {x - dx * l + dy * w, y - dy * l - dx * w}});
+    };
+
+    // Border and title block.
+    const double W = page.width, H = page.height;
+    line(5, 5, W - 5, 5, 0.5), line(W - 5, 5, W - 5, H - 5, 0.5), line(W - 5, H - 5, 5, H - 5, 0.5), line(5, H - 5, 5, 5, 0.5);
+    const double tx = W - 5 - title_w, ty = 5;
+    line(tx, ty, tx, ty + title_h, 0.5), line(tx, ty + title_h, W - 5, ty + title_h, 0.5);
+    line(tx, ty + 10, W - 5, ty + 10, 0.25);
+    line(tx + title_w / 3, ty, tx + title_w / 3, ty + 10, 0.25), line(tx + 2 * title_w / 3, ty, tx + 2 * title_w / 3, ty + 10, 0.25);
+    page.texts.push_back({tx + title_w / 2, ty + 15, 5, title, 0});
+    char scale_text[32];
+    if (scale >= 1) std::snprintf(scale_text, sizeof scale_text, "ESCALA %g:1", scale);
+    else std::snprintf(scale_text, sizeof scale_text, "ESCALA 1:%g", 1 / scale);
+    page.texts.push_back({tx + title_w / 6, ty + 3.5, 3, scale_text, 0});
+    page.texts.push_back({tx + title_w / 2, ty + 3.5, 3, "1º DIEDRO", 0});
+    page.texts.push_back({tx + 5 * title_w / 6, ty + 3.5, 3, "COTAS EM MM", 0});
+
+    for (const Item& it : items) {
+        double cx = margin, cy = H - margin;
+        for (int c = 0; c < it.col; ++c) cx += col_w[std::size_t(c)];
+        for (int r = 0; r <= it.row; ++r) cy -= row_h[std::size_t(r)];
+        // Centre in the cell; front and top share x, front and left share z.
+        const double w = it.w() * scale, h = it.h() * scale;
+        const double ox = cx + (col_w[std::size_t(it.col)] - dim_space - 6 - w) / 2 + 3;
+        const double oy = cy + dim_space + (row_h[std::size_t(it.row)] - label_space - dim_space - h) / 2;
+        auto X = [&](double x) { return ox + (x - it.min_x) * scale; };
+        auto Y = [&](double y) { return oy + (y - it.min_y) * scale; };
+
+        if (it.projection) {
+            for (const Segment& s : it.projection->hidden) line(X(s.x0), Y(s.y0), X(s.x1), Y(s.y1), 0.18, true);
+            for (const Segment& s : it.projection->visible) line(X(s.x0), Y(s.y0), X(s.x1), Y(s.y1), 0.35);
+        } else {
+            std::vector<Page::Polygon> paper;
+            for (const Page::Polygon& loop : it.loops) {
+                paper.emplace_back();
+                for (const auto& [x, y] : loop) paper.back().push_back({X(x), Y(y)});
+                for (std::size_t j = 0; j < loop.size(); ++j) {
+                    const auto& p = paper.back()[j];
+                    const auto& q = paper.back()[(j + 1) % paper.back().size()];
+                    if (j + 1 == loop.size()) line(p.first, p.second, paper.back()[0].first, paper.back()[0].second, 0.35);
+                    else line(p.first, p.second, q.first, q.second, 0.35);
+                }
+            }
+            for (const Segment& s : hatch(paper, 1.5, 45)) line(s.x0, s.y0, s.x1, s.y1, 0.13);
+        }
+        page.texts.push_back({ox + w / 2, oy + h + 4, 3.5, it.label, 0});
+        if (w <= 0 || h <= 0) continue;
+
+        // Overall width under the view, height to its right.
+        const double yd = oy - 8;
+        line(ox, oy - 1.5, ox, yd - 1.5, 0.18), line(ox + w, oy - 1.5, ox + w, yd - 1.5, 0.18);
+        line(ox, yd, ox + w, yd, 0.18);
+        arrow(ox, yd, -1, 0), arrow(ox + w, yd, 1, 0);
+        page.texts.push_back({ox + w / 2, yd + 1, 3, dimension(it.w()), 0});
+        const double xd = ox + w + 8;
+        line(ox + w + 1.5, oy, xd + 1.5, oy, 0.18), line(ox + w + 1.5, oy + h, xd + 1.5, oy + h, 0.18);
+        line(xd, oy, xd, oy + h, 0.18);
+        arrow(xd, oy, 0, -1), arrow(xd, oy + h, 0, 1);
+        page.texts.push_back({xd - 1, oy + h / 2, 3, dimension(it.h()), 0, true});
+    }
+    return page;
+}
+
+std::string svg(const Page& page) {
+    auto Y = [&](double y) { return num(page.height - y); };
+    auto escape = [](const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '&') out += "&amp;";
+            else if (c == '<') out += "&lt;";
+            else if (c == '>') out += "&gt;";
+            else out += c;
+        }
+        return out;
+    };
+    const std::string w = num(page.width), h = num(page.height);
+    std::string out = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + w + "mm\" height=\"" + h + "mm\" viewBox=\"0 0 " + w +
+           " " + h + "\">\n";
+    out += "<rect width=\"100%\" height=\"100%\" fill=\"#ffffff\"/>\n";
+    out += "<g stroke=\"#000000\" stroke-linecap=\"round\" fill=\"none\">\n";
+    for (const Page::Line& l : page.lines) {
+        out += "<line x1=\"" + num(l.x0) + "\" y1=\"" + Y(l.y0) + "\" x2=\"" + num(l.x1) + "\" y2=\"" + Y(l.y1) +
+               "\" stroke-width=\"" + num(l.width) + "\"";
+        if (l.dashed) out += " stroke-dasharray=\"1.5 0.8\"";
+        out += "/>\n";
+    }
+    out += "</g>\n<g fill=\"#000000\" fill-rule=\"evenodd\">\n";
+    for (const Page::Polygon& p : page.fills) {
+        out += "<path d=\"";
+        for (std::size_t i = 0; i < p.size(); ++i) out += (i ? " L" : "M") + num(p[i].first) + "," + Y(p[i].second);
+        out += " Z\"/>\n";
+    }
+    out += "</g>\n<g font-family=\"Helvetica, Arial, sans-serif\" fill=\"#000000\">\n";
+    for (const Page::Text& t : page.texts) {
+        const char* anchor = t.anchor < 0 ? "start" : t.anchor > 0 ? "end" : "middle";
+        out += "<text x=\"" + num(t.x) + "\" y=\"" + Y(t.y) + "\" font-size=\"" + num(t.size) + "\" text-anchor=\"" + anchor + "\"";
+        if (t.vertical) out += " transform=\"rotate(-90 " + num(t.x) + " " + Y(t.y) + ")\"";
+        out += ">" + escape(t.text) + "</text>\n";
+    }
+    out += "</g>\n</svg>\n";
+    return out;
+}
+
+std::string pdf(const Page& page) {
+    const double k = 72 / 25.4; // points per mm
+    auto P = [&](double v) { return num(v * k); };
+    std::string c = "1 J 1 j 0 G 0 g\n";
+    double width = -1;
+    int dashed = -1;
+    for (const Page::Line& l : page.lines) {
+        if (l.width != width) c += P(l.width) + " w\n", width = l.width;
+        if (int(l.dashed) != dashed) c += l.dashed ? "[" + P(1.5) + " " + P(0.8) + "] 0 d\n" : "[] 0 d\n", dashed = l.dashed;
+        c += P(l.x0) + " " + P(l.y0) + " m " + P(l.x1) + " " + P(l.y1) + " l S\n";
+    }
+    for (const Page::Polygon& p : page.fills) {
+        for (std::size_t i = 0; i < p.size(); ++i) c += P(p[i].first) + " " + P(p[i].second) + (i ? " l " : " m ");
+        c += "h f*\n";
+    }
+    for (const Page::Text& t : page.texts) {
+        const std::string s = latin1(t.text);
+        const double shift = t.anchor < 0 ? 0 : text_width(s, t.size) * (t.anchor > 0 ? 1 : 0.5);
+        std::string escaped;
+        for (char ch : s) {
+            if (ch == '(' || ch == ')' || ch == '\\') escaped += '\\';
+            escaped += ch;
+        }
+        c += "BT /F1 " + P(t.size) + " Tf ";
+        if (t.vertical) c += "0 1 -1 0 " + P(t.x) + " " + P(t.y - shift) + " Tm";
+        else c += "1 0 0 1 " + P(t.x - shift) + " " + P(t.y) + " Tm";
+        c += " (" + escaped + ") Tj ET\n";
+    }
+
+    uLongf size = compressBound(uLong(c.size()));
+    std::string z(size, '\0');
+    if (compress2(reinterpret_cast<Bytef*>(&z[0]), &size, reinterpret_cast<const Bytef*>(c.data()), uLong(c.size()), 6) != Z_OK)
+        throw std::runtime_error("drawing: deflate failed");
+    z.resize(size);
+
+    std::string out = "%PDF-1.4\n%\xe2\xe3\xcf\xd3\n";
+    std::vector<std::size_t> offsets;
+    auto object = [&](const std::string& body) {
+        offsets.push_back(out.size());
+        out += std::to_string(offsets.size()) + " 0 obj\n" + body + "\nendobj\n";
+    };
+    object("<< /Type /Catalog /Pages 2 0 R >>");
+    object("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+    object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " + P(page.width) + " " + P(page.height) +
+           "] /Resources << /Font << /F1 4 0 R >> >> /Contents 5 0 R >>");
+    object("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>");
+    object("<< /Length " + std::to_string(z.size()) + " /Filter /FlateDecode >>\nstream\n" + z + "\nendstream");
+    const std::size_t xref = out.size();
+    out += "xref\n0 " + std::to_string(offsets.size() + 1) + "\n0000000000 65535 f \n";
+    for (std::size_t off : offsets) {
+        char buf[24];
+        std::snprintf(buf, sizeof buf, "%010zu 00000 n \n", off);
+        out += buf;
+    }
+    out += "trailer\n<< /Size " + std::to_string(offsets.size() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+           std::to_string(xref) + "\n%%EOF\n";
+    return out;
+}
+
+} // namespace pwb::drawing
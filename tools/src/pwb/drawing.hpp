@@ -0,0 +1,105 @@
+#pragma once
+
+#include "pwb/gerber_outline.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/raycast.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pwb::drawing {
+
+using gerber::PolygonSet;
+using stl::Vec3;
+
+// A view or cutting plane: `right` and `up` span the paper, `toward` points
+// at the viewer. Right-handed, so right x up = toward.
+struct Frame {
+    Vec3 right, up, toward;
+};
+
+// First-angle projections of a part printed Z up.
+Frame front();
+Frame top();
+Frame left();
+
+// Orthonormal frame looking against `normal` (the viewer on its side), with
+// `up` as close to +Z as the plane allows, or +Y for horizontal planes.
+Frame facing(const Vec3& normal);
+
+// Cross-sections through `mesh` by the planes {p : p . frame.toward = d}
+// for each d in `offsets` (ascending), in paper coordinates (nm along right
+// and up), evaluated in parallel. Outer contours are counter-clockwise.
+std::vector<PolygonSet> sections(const mesh::Mesh& mesh, const Frame& frame, const std::vector<double>& offsets,
+                                 unsigned threads = 0);
+
+struct Segment {
+    double x0, y0, x1, y1; // paper millimetres
+};
+
+struct Options {
+    double feature_angle = 30; // degrees between face normals for an edge to be drawn
+    double sample = 0;         // visibility sampling along edges, mm; 0 = 1/2000 of the diagonal
+    bool hidden = true;        // keep hidden edges (drawn dashed)
+    unsigned threads = 0;      // 0 = all cores
+};
+
+struct Projection {
+    std::vector<Segment> visible, hidden;
+    double min_x = 0, min_y = 0, max_x = 0, max_y = 0; // silhouette extent
+    std::size_t edges = 0, rays = 0;
+};
+
+// Sharp, silhouette and open edges of the mesh seen along `frame`, split
+// into visible and hidden runs. Each edge is sampled and every sample casts
+// a ray to the viewer through `scene`, which must hold the same mesh; the
+// rays go in packets and the changes between visible and hidden are then
+// refined by bisection.
+Projection project(const mesh::Mesh& mesh, const mesh::HalfEdges& edges, const ray::Scene& scene, const Frame& frame,
+                   const Options& options = {});
+
+// Vector page in millimetres, origin at the bottom left.
+struct Page {
+    struct Line {
+        double x0, y0, x1, y1;
+        double width = 0.25;
+        bool dashed = false;
+    };
+    struct Text {
+        double x, y;
+        double size = 3.5;
+        std::string text; // UTF-8
+        int anchor = 0;   // -1 start, 0 middle, 1 end
+        bool vertical = false;
+    };
+    using Polygon = std::vector<std::pair<double, double>>;
+
+    double width = 297, height = 210;
+    std::vector<Line> lines;
+    std::vector<Polygon> fills; // solid black (arrowheads); polygons use the even-odd rule
+    std::vector<Text> texts;
+};
+
+struct View {
+    std::string label;
+    Projection projection;
+};
+
+struct Cut {
+    std::string label;     // "A-A"
+    std::string plane;     // human-readable, "z = 12,5"
+    PolygonSet region;     // nm, paper coordinates of its frame
+};
+
+// A sheet with the front view, the top view below it and the left view to
+// its right (first angle), then the cuts, each with overall dimensions and
+// the sections hatched at 45 degrees. The scale is the largest standard one
+// (5:1 down to 1:50) that fits A4 landscape, then A3.
+Page layout(const std::string& title, const View& front, const View& top, const View& left, const std::vector<Cut>& cuts);
+
+std::string svg(const Page& page);
+// Single-page PDF 1.4 with a deflated content stream and Helvetica text.
+std::string pdf(const Page& page);
+
+} // namespace pwb::drawing
@@ -0,0 +1,402 @@
+#include "pwb/drill_path.hpp"
+
+#include "pwb/parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+namespace pwb::drill {
+
+namespace {
+
+struct Pt {
+    double x, y;
+};
+
+double dist(const Pt& a, const Pt& b) { return std::hypot(a.x - b.x, a.y - b.y); }
+
+// Uniform bucket grid over the points, about two points per cell. Cells are
+// stored CSR-style; `alive` counts let the nearest-neighbour construction
+// delete points by swapping them to the end of their cell.
+class Grid {
+public:
+    explicit Grid(const std::vector<Pt>& pts) : pts_(pts) {
+        double min_x = pts[0].x, max_x = min_x, min_y = pts[0].y, max_y = min_y;
+        for (const Pt& p : pts) {
+            min_x = std::min(min_x, p.x), max_x = std::max(max_x, p.x);
+            min_y = std::min(min_y, p.y), max_y = std::max(max_y, p.y);
+        }
+        double w = std::max(max_x - min_x, 1e-6), h = std::max(max_y - min_y, 1e-6);
+        cell_ = std::max(std::sqrt(w * h * 2.0 / double(pts.size())), 1e-6);
+        nx_ = std::min(int(w / cell_) + 1, 1 << 12);
+        ny_ = std::min(int(h / cell_) + 1, 1 << 12);
+        cell_ = std::max({cell_, w / nx_, h / ny_});
+        x0_ = min_x, y0_ = min_y;
+
+        std::vector<std::uint32_t> count(std::size_t(nx_) * ny_ + 1, 0);
+        cell_of_.resize(pts.size());
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            cell_of_[i] = std::uint32_t(cell_index(pts[i]));
+            ++count[cell_of_[i] + 1];
+        }
+        for (std::size_t c = 1; c < count.size(); ++c) count[c] += count[c - 1];
+        start_ = count;
+        items_.resize(pts.size());
+        slot_.resize(pts.size());
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            std::uint32_t s = count[cell_of_[i]]++;
+            items_[s] = std::uint32_t(i);
+            slot_[i] = s;
+        }
+        alive_.resize(std::size_t(nx_) * ny_);
+        row_alive_.assign(std::size_t(ny_), 0);
+        for (std::size_t c = 0; c < alive_.size(); ++c) {
+            alive_[c] = start_[c + 1] - start_[c];
+            row_alive_[c / std::size_t(nx_)] += alive_[c];
+        }
+    }
+
+    void remove(std::uint32_t i) {
+        std::uint32_t c = cell_of_[i];
+        std::uint32_t last = start_[c] + --alive_[c];
+        std::uint32_t s = slot_[i];
+        std::swap(items_[s], items_[last]);
+        slot_[items_[s]] = s;
+        slot_[i] = last;
+        --row_alive_[c / std::uint32_t(nx_)];
+    }
+
+    // Closest live point to q, or UINT32_MAX when the grid is empty.
+    std::uint32_t nearest(const Pt& q) const {
+        int cx, cy;
+        cell_xy(q, cx, cy);
+        std::uint32_t best = std::numeric_limits<std::uint32_t>::max();
+        double best_d = std::numeric_limits<double>::infinity();
+        int max_r = std::max({cx, nx_ - 1 - cx, cy, ny_ - 1 - cy});
+        for (int r = 0; r <= max_r; ++r) {
+            for_ring(cx, cy, r, [&](std::uint32_t c) {
+                for (std::uint32_t s = start_[c], e = start_[c] + alive_[c]; s < e; ++s) {
+                    double d = dist(q, pts_[items_[s]]);
+                    if (d < best_d) best_d = d, best = items_[s];
+                }
+            });
+            // Every cell of ring r + 1 is at least r cells away from q.
+            if (best_d <= r * cell_) break;
+        }
+        return best;
+    }
+
+    // The k nearest other points of point i, closest first.
+    void k_nearest(std::uint32_t i, int k, std::vector<std::pair<double, std::uint32_t>>& out) const {
+        out.clear();
+        const Pt& q = pts_[i];
+        int cx, cy;
+        cell_xy(q, cx, cy);
+        int max_r = std::max({cx, nx_ - 1 - cx, cy, ny_ - 1 - cy});
+        for (int r = 0; r <= max_r; ++r) {
+            for_ring(cx, cy, r, [&](std::uint32_t c) {
+                for (std::uint32_t s = start_[c]; s < start_[c + 1]; ++s)
+                    if (items_[s] != i) out.push_back({dist(q, pts_[items_[s]]), items_[s]});
+            });
+            if (int(out.size()) >= k) {
+                std::nth_element(out.begin(), out.begin() + (k - 1), out.end());
+                if (out[std::size_t(k - 1)].first <= r * cell_) break;
+            }
+        }
+        std::size_t keep = std::min<std::size_t>(std::size_t(k), out.size());
+        std::partial_sort(out.begin(), out.begin() + keep, out.end());
+        out.resize(keep);
+    }
+
+private:
+    int cell_index(const Pt& p) const {
+        int cx, cy;
+        cell_xy(p, cx, cy);
+        return cy * nx_ + cx;
+    }
+
+    void cell_xy(const Pt& p, int& cx, int& cy) const {
+        cx = std::clamp(int((p.x - x0_) / cell_), 0, nx_ - 1);
+        cy = std::clamp(int((p.y - y0_) / cell_), 0, ny_ - 1);
+    }
+
+    // Visits the cells at Chebyshev distance exactly r from (cx, cy), skipping
+    // rows with no live points.
+    template <typename Fn>
+    void for_ring(int cx, int cy, int r, Fn&& fn) const {
+        int y_lo = std::max(cy - r, 0), y_hi = std::min(cy + r, ny_ - 1);
+        int x_lo = std::max(cx - r, 0), x_hi = std::min(cx + r, nx_ - 1);
+        for (int y = y_lo; y <= y_hi; ++y) {
+            if (row_alive_[std::size_t(y)] == 0) continue;
+            std::uint32_t row = std::uint32_t(y * nx_);
+            if (y == cy - r || y == cy + r) {
+                for (int x = x_lo; x <= x_hi; ++x) fn(row + std::uint32_t(x));
+            } else {
+                if (cx - r >= 0) fn(row + std::uint32_t(cx - r));
+                if (r > 0 && cx + r < nx_) fn(row + std::uint32_t(cx + r));
+            }
+        }
+    }
+
+    const std::vector<Pt>& pts_;
+    double x0_ = 0, y0_ = 0, cell_ = 1;
+    int nx_ = 1, ny_ = 1;
+    std::vector<std::uint32_t> start_, items_, slot_, cell_of_, alive_, row_alive_;
+};
+
+// Closed tour held as an array plus inverse positions. A 2-opt move reverses
+// whichever side of the cycle is shorter, so no move costs more than n/2 swaps.
+class Tour {
+public:
+    explicit Tour(std::vector<std::uint32_t> order) : tour_(std::move(order)), pos_(tour_.size()) {
+        for (std::size_t i = 0; i < tour_.size(); ++i) pos_[tour_[i]] = std::uint32_t(i);
+    }
+
+    std::size_t size() const { return tour_.size(); }
+    std::uint32_t next(std::uint32_t v) const {
+        std::uint32_t p = pos_[v] + 1;
+        return tour_[p == tour_.size() ? 0 : p];
+    }
+    std::uint32_t prev(std::uint32_t v) const {
+        std::uint32_t p = pos_[v];
+        return tour_[p == 0 ? tour_.size() - 1 : p - 1];
+    }
+    // Steps from a to b going forward.
+    std::size_t span(std::uint32_t a, std::uint32_t b) const {
+        return (pos_[b] + tour_.size() - pos_[a]) % tour_.size();
+    }
+
+    // Replaces tour edges {a, b} and {c, d} with {a, c} and {b, d}. The pairs
+    // must point the same way: b follows a exactly when d follows c.
+    void exchange(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d) {
+        if (next(a) == b) reverse(b, c);
+        else reverse(a, d);
+    }
+
+    const std::vector<std::uint32_t>& order() const { return tour_; }
+
+private:
+    // Reverses the forward path from..to (inclusive).
+    void reverse(std::uint32_t from, std::uint32_t to) {
+        const std::size_t n = tour_.size();
+        std::size_t len = span(from, to) + 1;
+        if (2 * len > n) {
+            std::uint32_t f = next(to), t = prev(from);
+            from = f, to = t;
+            len = n - len;
+        }
+        std::size_t i = pos_[from], j = pos_[to];
+        for (std::size_t k = 0; k < len / 2; ++k) {
+            std::swap(tour_[i], tour_[j]);
+            pos_[tour_[i]] = std::uint32_t(i);
+            pos_[tour_[j]] = std::uint32_t(j);
+            i = i + 1 == n ? 0 : i + 1;
+            j = j == 0 ? n - 1 : j - 1;
+        }
+    }
+
+    std::vector<std::uint32_t> tour_, pos_;
+};
+
+double tour_length(const std::vector<Pt>& pts, const std::vector<std::uint32_t>& order) {
+    double len = 0;
+    for (std::size_t i = 0; i < order.size(); ++i)
+        len += dist(pts[order[i]], pts[order[i + 1 == order.size() ? 0 : i + 1]]);
+    return len;
+}
+
+class LocalSearch {
+public:
+    LocalSearch(const std::vector<Pt>& pts, Tour& tour, const std::vector<std::uint32_t>& neighbours, int k,
+                const PlanOptions& options)
+        : pts_(pts), tour_(tour), nbr_(neighbours), k_(k), options_(options), queued_(pts.size(), 1) {
+        for (std::uint32_t v : tour.order()) queue_.push_back(v);
+    }
+
+    void run(PlanStats& stats) {
+        while (!queue_.empty()) {
+            std::uint32_t a = queue_.front();
+            queue_.pop_front();
+            queued_[a] = 0;
+            if (options_.two_opt && two_opt(a)) ++stats.two_opt_moves;
+            else if (options_.or_opt && or_opt(a)) ++stats.or_opt_moves;
+        }
+    }
+
+private:
+    static constexpr double kEps = 1e-9;
+
+    double d(std::uint32_t a, std::uint32_t b) const { return dist(pts_[a], pts_[b]); }
+
+    void push(std::uint32_t v) {
+        if (!queued_[v]) queued_[v] = 1, queue_.push_back(v);
+    }
+
+    const std::uint32_t* neighbours(std::uint32_t v) const { return nbr_.data() + std::size_t(v) * std::size_t(k_); }
+
+    bool two_opt(std::uint32_t a) {
+        for (int forward = 1; forward >= 0; --forward) {
+            std::uint32_t b = forward ? tour_.next(a) : tour_.prev(a);
+            double ab = d(a, b);
+            const std::uint32_t* nb = neighbours(a);
+            for (int i = 0; i < k_ && nb[i] != kNone; ++i) {
+                std::uint32_t c = nb[i];
+                double g1 = ab - d(a, c);
+                if (g1 <= kEps) break; // candidates are sorted by distance
+                std::uint32_t dd = forward ? tour_.next(c) : tour_.prev(c);
+                if (c == b || dd == a) continue;
+                if (g1 + d(c, dd) - d(b, dd) > kEps) {
+                    if (forward) tour_.exchange(a, b, c, dd);
+                    else tour_.exchange(b, a, dd, c);
+                    push(a), push(b), push(c), push(dd);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Moves a chain of 1-3 holes starting at s1 between two neighbouring
+    // holes, possibly reversed. Built from two or three 2-opt exchanges.
+    bool or_opt(std::uint32_t s1) {
+        const std::size_t n = tour_.size();
+        std::uint32_t s2 = s1;
+        for (std::size_t len = 1; len <= 3 && len + 3 <= n; ++len) {
+            if (len > 1) s2 = tour_.next(s2);
+            std::uint32_t p = tour_.prev(s1), nx = tour_.next(s2);
+            double removed = d(p, s1) + d(s2, nx) - d(p, nx);
+            if (removed <= kEps) continue;
+            for (std::uint32_t end : {s1, s2}) {
+                const std::uint32_t* nb = neighbours(end);
+                for (int i = 0; i < k_ && nb[i] != kNone; ++i) {
+                    std::uint32_t c = nb[i];
+                    if (d(end, c) >= removed) break;
+                    if (tour_.span(s1, c) < len) continue;
+                    for (int side = 0; side < 2; ++side) {
+                        // Insertion edge (u, v) with v following u.
+                        std::uint32_t u = side ? tour_.prev(c) : c;
+                        std::uint32_t v = side ? c : tour_.next(c);
+                        if (tour_.span(s1, u) < len || tour_.span(s1, v) < len || u == nx || v == p) continue;
+                        double uv = d(u, v);
+                        double fwd = removed + uv - d(u, s1) - d(s2, v);
+                        double rev = len > 1 ? removed + uv - d(u, s2) - d(s1, v) : -1;
+                        if (fwd <= kEps && rev <= kEps) continue;
+                        // p S nx .. u v  ->  p nx .. u S' v
+                        tour_.exchange(p, s1, u, v);
+                        tour_.exchange(p, u, nx, s2);
+                        if (fwd > rev && len > 1) tour_.exchange(u, s2, s1, v);
+                        push(p), push(nx), push(s1), push(s2), push(u), push(v);
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+public:
+    static constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+private:
+    const std::vector<Pt>& pts_;
+    Tour& tour_;
+    const std::vector<std::uint32_t>& nbr_;
+    int k_;
+    const PlanOptions& options_;
+    std::vector<char> queued_;
+    std::deque<std::uint32_t> queue_;
+};
+
+} // namespace
+
+double route_length(const std::vector<excellon::Hit>& hits, const std::vector<std::uint32_t>& order,
+                    double home_x, double home_y) {
+    if (order.empty()) return 0;
+    Pt home{home_x, home_y}, last = home;
+    double len = 0;
+    for (std::uint32_t i : order) {
+        Pt p{hits[i].x, hits[i].y};
+        len += dist(last, p);
+        last = p;
+    }
+    return len + dist(last, home);
+}
+
+std::vector<std::uint32_t> plan(const std::vector<excellon::Hit>& hits, const PlanOptions& options, PlanStats* stats) {
+    auto t0 = std::chrono::steady_clock::now();
+    PlanStats local;
+    PlanStats& st = stats ? *stats : local;
+    st = PlanStats{};
+    st.holes = hits.size();
+
+    std::vector<std::uint32_t> identity(hits.size());
+    for (std::size_t i = 0; i < hits.size(); ++i) identity[i] = std::uint32_t(i);
+    st.original = st.nearest = st.optimised = route_length(hits, identity, options.home_x, options.home_y);
+    if (hits.size() < 3) return identity;
+
+    // Node 0 is the tool-change position; holes are 1..n.
+    std::vector<Pt> pts;
+    pts.reserve(hits.size() + 1);
+    pts.push_back({options.home_x, options.home_y});
+    for (const excellon::Hit& h : hits) pts.push_back({h.x, h.y});
+    const std::size_t n = pts.size();
+
+    Grid grid(pts);
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    std::uint32_t cur = 0;
+    grid.remove(0);
+    order.push_back(0);
+    for (std::size_t k = 1; k < n; ++k) {
+        cur = grid.nearest(pts[cur]);
+        grid.remove(cur);
+        order.push_back(cur);
+    }
+    st.nearest = tour_length(pts, order);
+
+    if (options.two_opt || options.or_opt) {
+        Grid full(pts);
+        const int k = std::max(1, std::min<int>(options.neighbours, int(n) - 1));
+        std::vector<std::uint32_t> nbr(n * std::size_t(k), LocalSearch::kNone);
+        std::vector<std::pair<double, std::uint32_t>> scratch;
+        for (std::uint32_t i = 0; i < n; ++i) {
+            full.k_nearest(i, k, scratch);
+            for (std::size_t j = 0; j < scratch.size(); ++j) nbr[std::size_t(i) * std::size_t(k) + j] = scratch[j].second;
+        }
+        Tour tour(std::move(order));
+        LocalSearch(pts, tour, nbr, k, options).run(st);
+        order = tour.order();
+    }
+
+    // Rotate so the route leaves from home, then drop the home node.
+    std::rotate(order.begin(), std::find(order.begin(), order.end(), 0u), order.end());
+    std::vector<std::uint32_t> route(n - 1);
+    for (std::size_t i = 1; i < n; ++i) route[i - 1] = order[i] - 1;
+    st.optimised = route_length(hits, route, options.home_x, options.home_y);
+    if (st.optimised >= st.original) { // never hand back a longer route than the file's own
+        route = std::move(identity);
+        st.optimised = st.original;
+    }
+    st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return route;
+}
+
+std::vector<PlanStats> optimise(excellon::DrillFile& file, const PlanOptions& options) {
+    std::vector<PlanStats> stats(file.tools.size());
+    parallel_for(
+        file.tools.size(),
+        [&](std::size_t t) {
+            excellon::Tool& tool = file.tools[t];
+            std::vector<std::uint32_t> route = plan(tool.hits, options, &stats[t]);
+            std::vector<excellon::Hit> reordered(route.size());
+            for (std::size_t i = 0; i < route.size(); ++i) reordered[i] = tool.hits[route[i]];
+            tool.hits = std::move(reordered);
+        },
+        options.threads);
+    return stats;
+}
+
+} // namespace pwb::drill
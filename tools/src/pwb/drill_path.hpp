@@ -0,0 +1,42 @@
+#pragma once
+
+#include "pwb/excellon.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pwb::drill {
+
+struct PlanOptions {
+    double home_x = 0, home_y = 0; // tool-change position; every tool starts and ends here
+    int neighbours = 8;            // candidate list size for the local search
+    bool two_opt = true;
+    bool or_opt = true;
+    unsigned threads = 0;          // tools are planned concurrently; 0 = all cores
+};
+
+struct PlanStats {
+    std::size_t holes = 0;
+    double original = 0;  // mm of travel in file order
+    double nearest = 0;   // after nearest-neighbour construction
+    double optimised = 0; // after 2-opt / Or-opt
+    std::size_t two_opt_moves = 0;
+    std::size_t or_opt_moves = 0;
+    double seconds = 0;
+};
+
+// Travel from home through `hits` in the given order and back.
+double route_length(const std::vector<excellon::Hit>& hits, const std::vector<std::uint32_t>& order,
+                    double home_x, double home_y);
+
+// Visiting order for one tool: grid nearest-neighbour tour improved with
+// 2-opt and Or-opt moves over k-nearest candidate lists. Falls back to the
+// file order when that is already shorter.
+std::vector<std::uint32_t> plan(const std::vector<excellon::Hit>& hits, const PlanOptions& options = {},
+                                PlanStats* stats = nullptr);
+
+// Reorders the hits of every tool in place. Slots keep their file order.
+std::vector<PlanStats> optimise(excellon::DrillFile& file, const PlanOptions& options = {});
+
+} // namespace pwb::drill
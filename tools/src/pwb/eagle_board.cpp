@@ -0,0 +1,262 @@
+#include "pwb/eagle_board.hpp"
+
+#include "pwb/mapped_file.hpp"
+#include "pwb/util.hpp"
+#include "pwb/xml.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace pwb::eagle {
+
+namespace {
+
+int layer_of(const xml::Node& n) { return int(n.number("layer")); }
+
+Wire read_wire(const xml::Node& n) {
+    Wire w;
+    w.x1 = n.number("x1"), w.y1 = n.number("y1");
+    w.x2 = n.number("x2"), w.y2 = n.number("y2");
+    w.width = n.number("width");
+    w.curve = n.number("curve");
+    w.layer = layer_of(n);
+    return w;
+}
+
+Circle read_circle(const xml::Node& n) {
+    return {n.number("x"), n.number("y"), n.number("radius"), n.number("width"), layer_of(n)};
+}
+
+Rect read_rect(const xml::Node& n) {
+    Rect r;
+    r.x1 = n.number("x1"), r.y1 = n.number("y1");
+    r.x2 = n.number("x2"), r.y2 = n.number("y2");
+    r.layer = layer_of(n);
+    r.rot = Rotation::parse(n.attr("rot"));
+    return r;
+}
+
+Polygon read_polygon(const xml::Node& n) {
+    Polygon p;
+    p.width = n.number("width");
+    p.layer = layer_of(n);
+    for (const xml::Node& v : n.children)
+        if (v.name == "vertex") p.vertices.push_back({v.number("x"), v.number("y"), v.number("curve")});
+    return p;
+}
+
+Hole read_hole(const xml::Node& n) { return {n.number("x"), n.number("y"), n.number("drill")}; }
+
+Text read_text(const xml::Node& n) {
+    Text t;
+    t.value = n.text;
+    t.x = n.number("x"), t.y = n.number("y");
+    t.size = n.number("size");
+    t.ratio = int(n.number("ratio", 8));
+    t.layer = layer_of(n);
+    t.rot = Rotation::parse(n.attr("rot"));
+    return t;
+}
+
+PadShape pad_shape(const std::string& s) {
+    if (s == "square") return PadShape::Square;
+    if (s == "octagon") return PadShape::Octagon;
+    if (s == "long") return PadShape::Long;
+    if (s == "offset") return PadShape::Offset;
+    return PadShape::Round;
+}
+
+Package read_package(const xml::Node& n, const std::string& library) {
+    Package p;
+    p.library = library;
+    p.name = n.attr("name");
+    for (const xml::Node& c : n.children) {
+        if (c.name == "wire") p.wires.push_back(read_wire(c));
+        else if (c.name == "smd") {
+            Smd s;
+            s.name = c.attr("name");
+            s.x = c.number("x"), s.y = c.number("y");
+            s.dx = c.number("dx"), s.dy = c.number("dy");
+            s.layer = layer_of(c);
+            s.roundness = int(c.number("roundness"));
+            s.rot = Rotation::parse(c.attr("rot"));
+            p.smds.push_back(std::move(s));
+        } else if (c.name == "pad") {
+            Pad d;
+            d.name = c.attr("name");
+            d.x = c.number("x"), d.y = c.number("y");
+            d.drill = c.number("drill");
+            d.diameter = c.number("diameter");
+            d.shape = pad_shape(c.attr("shape", "round"));
+            d.rot = Rotation::parse(c.attr("rot"));
+            p.pads.push_back(std::move(d));
+        } else if (c.name == "circle") p.circles.push_back(read_circle(c));
+        else if (c.name == "rectangle") p.rects.push_back(read_rect(c));
+        else if (c.name == "polygon") p.polygons.push_back(read_polygon(c));
+        else if (c.name == "hole") p.holes.push_back(read_hole(c));
+        else if (c.name == "text") p.texts.push_back(read_text(c));
+    }
+    return p;
+}
+
+// "10mil" / "0.2mm" / "1.5" (mm) -> millimetres.
+double to_mm(const std::string& v) {
+    char* end = nullptr;
+    double x = std::strtod(v.c_str(), &end);
+    std::string unit = end ? std::string(end) : std::string();
+    if (unit == "mil") return x * 0.0254;
+    if (unit == "in" || unit == "inch") return x * 25.4;
+    if (unit == "mic") return x * 0.001;
+    return x;
+}
+
+} // namespace
+
+int mirrored_layer(int layer) {
+    switch (layer) {
+    case kTop: return kBottom;
+    case kBottom: return kTop;
+    case 21: case 23: case 25: case 27: case 29: case 31: case 33: case 35: case 37: case 39: case 41: case 51:
+        return layer + 1;
+    case 22: case 24: case 26: case 28: case 30: case 32: case 34: case 36: case 38: case 40: case 42: case 52:
+        return layer - 1;
+    default: return layer;
+    }
+}
+
+Rotation Rotation::parse(std::string_view text) {
+    Rotation r;
+    std::size_t i = 0;
+    for (; i < text.size() && (text[i] == 'M' || text[i] == 'S' || text[i] == 'R'); ++i) {
+        if (text[i] == 'M') r.mirror = true;
+        if (text[i] == 'S') r.spin = true;
+    }
+    if (i < text.size()) r.angle = std::strtod(std::string(text.substr(i)).c_str(), nullptr);
+    return r;
+}
+
+double DesignRules::ratio(const std::string& name, double fallback) const {
+    auto it = params.find(name);
+    return it == params.end() ? fallback : std::strtod(it->second.c_str(), nullptr);
+}
+
+double DesignRules::length_mm(const std::string& name, double fallback_mm) const {
+    auto it = params.find(name);
+    return it == params.end() ? fallback_mm : to_mm(it->second);
+}
+
+double DesignRules::pad_diameter(double drill, double requested) const {
+    double ring = std::clamp(drill * ratio("rvPadTop", 0.25), length_mm("rlMinPadTop", 0.254), length_mm("rlMaxPadTop", 0.508));
+    return std::max(requested, drill + 2 * ring);
+}
+
+double DesignRules::via_diameter(double drill, double requested) const {
+    double ring = std::clamp(drill * ratio("rvViaOuter", 0.25), length_mm("rlMinViaOuter", 0.2032), length_mm("rlMaxViaOuter", 0.508));
+    return std::max(requested, drill + 2 * ring);
+}
+
+double DesignRules::stop_frame(double size) const {
+    return std::clamp(size * ratio("mvStopFrame", 1.0), length_mm("mlMinStopFrame", 0.1016), length_mm("mlMaxStopFrame", 0.1016));
+}
+
+double DesignRules::cream_frame(double size) const {
+    return std::clamp(size * ratio("mvCreamFrame", 0.0), length_mm("mlMinCreamFrame", 0.0), length_mm("mlMaxCreamFrame", 0.0));
+}
+
+std::string Board::package_key(std::string_view library, std::string_view package) {
+    return std::string(library) + "/" + std::string(package);
+}
+
+const Package* Board::package_of(const Element& e) const {
+    auto it = packages.find(package_key(e.library, e.package));
+    return it == packages.end() ? nullptr : &it->second;
+}
+
+const Element* Board::element(std::string_view name) const {
+    for (const Element& e : elements)
+        if (e.name == name) return &e;
+    return nullptr;
+}
+
+Board parse_board(std::string_view text) {
+    xml::Node doc = xml::parse(text);
+    const xml::Node* board_node = doc.find("board");
+    if (!board_node) throw std::runtime_error("not an EAGLE board: no <board> element");
+
+    Board b;
+    if (const xml::Node* plain = board_node->child("plain")) {
+        for (const xml::Node& c : plain->children) {
+            if (c.name == "wire") b.wires.push_back(read_wire(c));
+            else if (c.name == "circle") b.circles.push_back(read_circle(c));
+            else if (c.name == "rectangle") b.rects.push_back(read_rect(c));
+            else if (c.name == "polygon") b.polygons.push_back(read_polygon(c));
+            else if (c.name == "hole") b.holes.push_back(read_hole(c));
+            else if (c.name == "text") b.texts.push_back(read_text(c));
+        }
+    }
+    if (const xml::Node* libs = board_node->child("libraries")) {
+        for (const xml::Node& lib : libs->children) {
+            if (lib.name != "library") continue;
+            std::string lib_name = lib.attr("name");
+            if (const xml::Node* pkgs = lib.child("packages")) {
+                for (const xml::Node& p : pkgs->children) {
+                    if (p.name != "package") continue;
+                    Package pkg = read_package(p, lib_name);
+                    b.packages[Board::package_key(lib_name, pkg.name)] = std::move(pkg);
+                }
+            }
+        }
+    }
+    if (const xml::Node* rules = board_node->child("designrules")) {
+        for (const xml::Node& p : rules->children)
+            if (p.name == "param") b.rules.params[p.attr("name")] = p.attr("value");
+    }
+    if (const xml::Node* elements = board_node->child("elements")) {
+        for (const xml::Node& e : elements->children) {
+            if (e.name != "element") continue;
+            Element el;
+            el.name = e.attr("name");
+            el.library = e.attr("library");
+            el.package = e.attr("package");
+            el.value = e.attr("value");
+            el.x = e.number("x"), el.y = e.number("y");
+            el.rot = Rotation::parse(e.attr("rot"));
+            b.elements.push_back(std::move(el));
+        }
+    }
+    if (const xml::Node* signals = board_node->child("signals")) {
+        for (const xml::Node& s : signals->children) {
+            if (s.name != "signal") continue;
+            Signal sig;
+            sig.name = s.attr("name");
+            for (const xml::Node& c : s.children) {
+                if (c.name == "wire") sig.wires.push_back(read_wire(c));
+                else if (c.name == "via") {
+                    sig.vias.push_back({c.number("x"), c.number("y"), c.number("drill"), c.number("diameter"), c.attr("extent")});
+                } else if (c.name == "polygon") sig.polygons.push_back(read_polygon(c));
+                else if (c.name == "contactref") sig.contacts.push_back({c.attr("element"), c.attr("pad")});
+            }
+            b.signals.push_back(std::move(sig));
+        }
+    }
+    return b;
+}
+
+Board load_board(const std::string& path) {
+    MappedFile file(path);
+    return parse_board(file.view());
+}
+
+void Placement::apply(double lx, double ly, double& bx, double& by) const {
+    if (rot.mirror) lx = -lx;
+    double a = rot.angle * kPi / 180.0;
+    double c = std::cos(a), s = std::sin(a);
+    bx = x + lx * c - ly * s;
+    by = y + lx * s + ly * c;
+}
+
+double Placement::angle(const Rotation& local) const { return rot.angle + (rot.mirror ? -local.angle : local.angle); }
+
+} // namespace pwb::eagle
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pwb::eagle {
+
+// EAGLE layer numbers used by the tools.
+enum Layer : int {
+    kTop = 1,
+    kBottom = 16,
+    kPads = 17,
+    kVias = 18,
+    kDimension = 20,
+    kTPlace = 21,
+    kBPlace = 22,
+    kTNames = 25,
+    kBNames = 26,
+    kTStop = 29,
+    kBStop = 30,
+    kTCream = 31,
+    kBCream = 32,
+    kTDocu = 51,
+};
+
+// Layer an object ends up on when its element is mirrored to the bottom side.
+int mirrored_layer(int layer);
+
+// "R90", "MR180", "SR0"... as written in EAGLE's rot attribute.
+struct Rotation {
+    double angle = 0.0;
+    bool mirror = false;
+    bool spin = false;
+
+    static Rotation parse(std::string_view text);
+};
+
+// All lengths are millimetres, as stored in the .brd file.
+struct Wire {
+    double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    double width = 0;
+    double curve = 0; // arc sweep in degrees, 0 for straight wires
+    int layer = 0;
+};
+
+struct Smd {
+    std::string name;
+    double x = 0, y = 0, dx = 0, dy = 0;
+    int layer = kTop;
+    int roundness = 0; // percent
+    Rotation rot;
+};
+
+enum class PadShape { Round, Square, Octagon, Long, Offset };
+
+struct Pad {
+    std::string name;
+    double x = 0, y = 0;
+    double drill = 0;
+    double diameter = 0; // 0 = derived from the design rules
+    PadShape shape = PadShape::Round;
+    Rotation rot;
+};
+
+struct Via {
+    double x = 0, y = 0;
+    double drill = 0;
+    double diameter = 0;
+    std::string extent;
+};
+
+struct Circle {
+    double x = 0, y = 0, radius = 0, width = 0;
+    int layer = 0;
+};
+
+struct Rect {
+    double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    int layer = 0;
+    Rotation rot;
+};
+
+struct Vertex {
+    double x = 0, y = 0, curve = 0;
+};
+
+struct Polygon {
+    std::vector<Vertex> vertices;
+    double width = 0;
+    int layer = 0;
+};
+
+struct Hole {
+    double x = 0, y = 0, drill = 0;
+};
+
+struct Text {
+    std::string value;
+    double x = 0, y = 0, size = 0;
+    int ratio = 8; // stroke width as percent of size
+    int layer = 0;
+    Rotation rot;
+};
+
+struct Package {
+    std::string library;
+    std::string name;
+    std::vector<Wire> wires;
+    std::vector<Smd> smds;
+    std::vector<Pad> pads;
+    std::vector<Circle> circles;
+    std::vector<Rect> rects;
+    std::vector<Polygon> polygons;
+    std::vector<Hole> holes;
+    std::vector<Text> texts;
+};
+
+struct Element {
+    std::string name;
+    std::string library;
+    std::string package;
+    std::string value;
+    double x = 0, y = 0;
+    Rotation rot;
+};
+
+struct ContactRef {
+    std::string element;
+    std::string pad;
+};
+
+struct Signal {
+    std::string name;
+    std::vector<Wire> wires;
+    std::vector<Via> vias;
+    std::vector<Polygon> polygons;
+    std::vector<ContactRef> contacts;
+};
+
+// <designrules> parameters with EAGLE's unit suffixes resolved.
+struct DesignRules {
+    std::map<std::string, std::string> params;
+
+    double ratio(const std::string& name, double fallback) const;
+    double length_mm(const std::string& name, double fallback_mm) const;
+
+    // Copper diameter EAGLE generates for a through-hole pad or via.
+    double pad_diameter(double drill, double requested) const;
+    double via_diameter(double drill, double requested) const;
+    double stop_frame(double size) const;
+    double cream_frame(double size) const;
+};
+
+struct Board {
+    std::vector<Wire> wires; // <plain>
+    std::vector<Circle> circles;
+    std::vector<Rect> rects;
+    std::vector<Polygon> polygons;
+    std::vector<Hole> holes;
+    std::vector<Text> texts;
+    std::map<std::string, Package> packages; // keyed by package_key()
+    std::vector<Element> elements;
+    std::vector<Signal> signals;
+    DesignRules rules;
+
+    static std::string package_key(std::string_view library, std::string_view package);
+    const Package* package_of(const Element& e) const;
+    const Element* element(std::string_view name) const;
+};
+
+// Parses an EAGLE 6+ XML board.
+Board parse_board(std::string_view xml);
+Board load_board(const std::string& path);
+
+// Maps a package-local point to board coordinates for an element.
+struct Placement {
+    double x = 0, y = 0;
+    Rotation rot;
+
+    void apply(double lx, double ly, double& bx, double& by) const;
+    int layer(int local_layer) const { return rot.mirror ? mirrored_layer(local_layer) : local_layer; }
+    // Combined rotation of an object rotated `local` inside the package.
+    double angle(const Rotation& local) const;
+};
+
+inline Placement placement(const Element& e) { return {e.x, e.y, e.rot}; }
+
+} // namespace pwb::eagle
@@ -0,0 +1,220 @@
+#include "pwb/enclosure.hpp"
+
+#include "pwb/board_geometry.hpp"
+#include "pwb/silkscreen.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pwb::enclosure {
+
+namespace {
+
+using sdf::cylinder;
+using sdf::Vec2;
+
+// No farther than the distance to anything inside the box, as in gate.cpp.
+float outside(const Vec3& q, const Vec3& lo, const Vec3& hi) { return std::max(sdf::box(q, lo, hi), 0.0f); }
+
+void require(bool ok, const std::string& what) {
+    if (!ok) throw std::runtime_error("enclosure: " + what);
+}
+
+const eagle::Element& element(const eagle::Board& board, const std::string& name) {
+    const eagle::Element* e = board.element(name);
+    require(e != nullptr, "no element " + name + " on the board");
+    return *e;
+}
+
+// "CANAL4" -> "4"; names without a number are engraved whole.
+std::string label_text(const std::string& name) {
+    std::size_t i = name.size();
+    while (i > 0 && std::isdigit(static_cast<unsigned char>(name[i - 1]))) --i;
+    return i < name.size() ? name.substr(i) : name;
+}
+
+struct Window {
+    Vec3 lo, hi;
+};
+
+struct Opening {
+    float x = 0, y = 0;
+    std::string name;
+};
+
+struct Label {
+    std::vector<std::vector<Vec2>> rings;
+    Vec3 lo, hi;
+};
+
+// Everything the field needs, worked out once from the board.
+struct Model {
+    Params p;
+    Part part = Part::Bottom;
+    std::vector<Vec2> outline;
+    Vec2 box_lo, box_hi;      // of the outline
+    float z_board = 0;        // underside of the board
+    float z_top = 0;          // rim of the tray, underside of the lid
+    std::vector<Vec2> standoffs;
+    std::vector<Window> windows;
+    std::vector<Opening> openings;
+    std::vector<Label> labels;
+
+    Model(const eagle::Board& board, const Params& params, Part pt) : p(params), part(pt) {
+        box_lo = {1e30f, 1e30f}, box_hi = {-1e30f, -1e30f};
+        for (const auto& [x, y] : eagle::outline(board)) {
+            outline.push_back({float(x), float(y)});
+            box_lo = {std::min(box_lo.x, float(x)), std::min(box_lo.y, float(y))};
+            box_hi = {std::max(box_hi.x, float(x)), std::max(box_hi.y, float(y))};
+        }
+        z_board = p.floor + p.standoff;
+        z_top = z_board + p.board + p.headroom;
+        for (const eagle::Hole& h : board.holes) standoffs.push_back({float(h.x), float(h.y)});
+
+        for (const Port& port : p.ports) {
+            const eagle::Extent e = eagle::footprint(board, element(board, port.element));
+            // Nearest side of the board: 0 = -x, 1 = +x, 2 = -y, 3 = +y.
+            const double gaps[4] = {e.x0 - box_lo.x, box_hi.x - e.x1, e.y0 - box_lo.y, box_hi.y - e.y1};
+            const int side = int(std::min_element(gaps, gaps + 4) - gaps);
+            const bool along_y = side < 2;
+            const float centre = float(along_y ? e.y0 + e.y1 : e.x0 + e.x1) * 0.5f;
+            const float half = port.width > 0 ? 0.5f * port.width
+                                              : float(along_y ? e.y1 - e.y0 : e.x1 - e.x0) * 0.5f + p.port_margin;
+            // Across the wall from just inside the board edge to beyond the outside.
+            const float edge = side == 0 ? box_lo.x : side == 1 ? box_hi.x : side == 2 ? box_lo.y : box_hi.y;
+            const float s = side % 2 ? 1.0f : -1.0f;
+            const float a = edge - s * 1.0f, b = edge + s * (p.clearance + p.wall + 1);
+            Window w;
+            const float z0 = z_board + p.board, z1 = z0 + port.height;
+            if (along_y) w.lo = {std::min(a, b), centre - half, z0}, w.hi = {std::max(a, b), centre + half, z1};
+            else w.lo = {centre - half, std::min(a, b), z0}, w.hi = {centre + half, std::max(a, b), z1};
+            windows.push_back(w);
+        }
+
+        silk::GlyphCache glyphs(20'000); // 20 µm, well under the lattice
+        for (const std::string& name : p.channels) {
+            const eagle::Extent e = eagle::footprint(board, element(board, name));
+            Opening o{float(e.x0 + e.x1) * 0.5f, float(e.y0 + e.y1) * 0.5f, name};
+            openings.push_back(o);
+
+            silk::TextStyle style;
+            style.height = gerber::Coord(p.label_height * float(gerber::kNmPerMm));
+            style.ratio = 15;
+            const float x = o.x + 0.5f * p.opening + 1, y = o.y - 0.5f * p.label_height;
+            const gerber::PolygonSet set =
+                silk::text_outline(glyphs, label_text(name), gerber::Coord(x * float(gerber::kNmPerMm)),
+                                   gerber::Coord(y * float(gerber::kNmPerMm)), style);
+            Label l;
+            l.lo = {1e30f, 1e30f, z_top + p.lid - p.label_depth}, l.hi = {-1e30f, -1e30f, z_top + p.lid + 1};
+            for (std::size_t k = 0; k < set.size(); ++k) {
+                std::vector<Vec2>& ring = l.rings.emplace_back();
+                for (std::size_t i = 0; i < set.count(k); ++i) {
+                    const Vec2 v{float(set.begin(k)[i].x) / float(gerber::kNmPerMm),
+                                 float(set.begin(k)[i].y) / float(gerber::kNmPerMm)};
+                    ring.push_back(v);
+                    l.lo.x = std::min(l.lo.x, v.x), l.lo.y = std::min(l.lo.y, v.y);
+                    l.hi.x = std::max(l.hi.x, v.x), l.hi.y = std::max(l.hi.y, v.y);
+                }
+            }
+            labels.push_back(std::move(l));
+        }
+    }
+
+    float operator()(const Vec3& q) const { return part == Part::Bottom ? tray(q) : lid(q); }
+
+    float tray(const Vec3& q) const {
+        const float d2 = sdf::polygon(q.x, q.y, outline), k = p.fillet, r = 0.5f * p.standoff_diameter;
+        float f = sdf::extrude(d2 - p.clearance - p.wall, q.z, 0, z_top);
+        f = sdf::subtract(f, sdf::extrude(d2 - p.clearance, q.z, p.floor, z_top + 1));
+        // Standoffs rise from inside the floor so the blend never swells it.
+        for (const Vec2& s : standoffs) {
+            const float near = outside(q, {s.x - r, s.y - r, 0}, {s.x + r, s.y + r, z_board});
+            if (near < f + k) f = sdf::blend(f, cylinder(q, 2, {s.x, s.y, 0}, r, k, z_board), k);
+        }
+        for (const Vec2& s : standoffs) {
+            const float near = outside(q, {s.x - r, s.y - r, 0}, {s.x + r, s.y + r, z_board + 1});
+            if (near < -f) f = sdf::subtract(f, cylinder(q, 2, {s.x, s.y, 0}, 0.5f * p.screw, z_board - p.screw_depth, z_board + 1));
+        }
+        for (const Window& w : windows) {
+            if (outside(q, w.lo, w.hi) >= -f) continue;
+            const float rr = p.port_radius;
+            f = sdf::subtract(f, sdf::box(q, {w.lo.x + rr, w.lo.y + rr, w.lo.z + rr}, {w.hi.x - rr, w.hi.y - rr, w.hi.z - rr}) - rr);
+        }
+        return f;
+    }
+
+    float lid(const Vec3& q) const {
+        const float d2 = sdf::polygon(q.x, q.y, outline), k = p.fillet, r = 0.5f * p.opening;
+        float f = sdf::extrude(d2 - p.clearance - p.wall, q.z, z_top, z_top + p.lid);
+        // The lip's outside stands lip_clearance off the tray's inside, and it
+        // reaches into the plate so the fillet only forms underneath.
+        const float a = d2 - (p.clearance - p.lip_clearance);
+        f = sdf::blend(f, sdf::extrude(std::max(a, -a - p.lip_width), q.z, z_top - p.lip, z_top + 0.5f * p.lid), k);
+        for (const Opening& o : openings) {
+            const float near = outside(q, {o.x - r, o.y - r, z_top - 1}, {o.x + r, o.y + r, z_top + p.lid + 1});
+            if (near < -f) f = sdf::subtract(f, cylinder(q, 2, {o.x, o.y, 0}, r, z_top - 1, z_top + p.lid + 1));
+        }
+        for (const Label& l : labels) {
+            if (outside(q, l.lo, l.hi) >= -f) continue;
+            f = sdf::subtract(f, sdf::extrude(sdf::polygon(q.x, q.y, l.rings), q.z, l.lo.z, l.hi.z));
+        }
+        return f;
+    }
+};
+
+} // namespace
+
+void validate(const eagle::Board& board, const Params& p) {
+    for (float v : {p.clearance, p.wall, p.floor, p.standoff, p.board, p.headroom, p.lid, p.lip, p.lip_width,
+                    p.standoff_diameter, p.screw, p.screw_depth, p.port_radius, p.opening, p.label_height, p.label_depth})
+        require(v > 0, "sizes must be positive");
+    require(p.lip_clearance >= 0 && p.port_margin >= 0 && p.fillet >= 0, "lip clearance, port margin and fillet must not be negative");
+    require(p.fillet <= p.wall, "fillet larger than the wall");
+    require(p.lip_clearance < p.clearance + p.wall, "lip wider than the inside of the tray");
+    require(p.screw < p.standoff_diameter, "screw wider than its standoff");
+    require(p.screw_depth < p.standoff + p.floor, "screw pilot through the floor");
+    require(p.label_depth < p.lid, "engraving through the lid");
+
+    const Model m(board, p, Part::Bottom);
+    for (std::size_t i = 0; i < p.ports.size(); ++i) {
+        const Window& w = m.windows[i];
+        require(w.hi.z <= m.z_top - p.lip, "window for " + p.ports[i].element + " reaches the lid's lip");
+        require(std::min(w.hi.x - w.lo.x, w.hi.y - w.lo.y) > 2 * p.port_radius &&
+                    w.hi.z - w.lo.z > 2 * p.port_radius,
+                "window for " + p.ports[i].element + " smaller than its corners");
+    }
+    const float inner = p.clearance - p.lip_clearance - p.lip_width; // inside face of the lip, from the board edge
+    for (const Opening& o : m.openings)
+        require(sdf::polygon(o.x, o.y, m.outline) + 0.5f * p.opening <= inner,
+                "opening over " + o.name + " cuts into the lip");
+}
+
+sdf::Field field(const eagle::Board& board, const Params& params, Part part) {
+    validate(board, params);
+    return Model(board, params, part);
+}
+
+void bounds(const eagle::Board& board, const Params& p, Part part, Vec3& lo, Vec3& hi) {
+    float x0 = 1e30f, y0 = 1e30f, x1 = -1e30f, y1 = -1e30f;
+    for (const auto& [x, y] : eagle::outline(board)) {
+        x0 = std::min(x0, float(x)), y0 = std::min(y0, float(y));
+        x1 = std::max(x1, float(x)), y1 = std::max(y1, float(y));
+    }
+    const float out = p.clearance + p.wall;
+    const float z_top = p.floor + p.standoff + p.board + p.headroom;
+    lo = {x0 - out, y0 - out, part == Part::Top ? z_top - p.lip : 0};
+    hi = {x1 + out, y1 + out, part == Part::Top ? z_top + p.lid : z_top};
+}
+
+mesh::Mesh build(const eagle::Board& board, const Params& params, Part part, const sdf::Options& options,
+                 sdf::Stats* stats) {
+    Vec3 lo, hi;
+    bounds(board, params, part, lo, hi);
+    return sdf::polygonise(field(board, params, part), lo, hi, options, stats);
+}
+
+} // namespace pwb::enclosure
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/sdf.hpp"
+
+#include <string>
+#include <vector>
+
+namespace pwb::enclosure {
+
+using stl::Vec3;
+
+// A window through the side wall that an element's footprint faces (the
+// nearest side of the board's bounding box), for connectors and cables.
+struct Port {
+    std::string element;
+    float width = 0;   // along the wall; 0 = the footprint's extent plus the margin
+    float height = 12; // above the board's top face
+};
+
+// Two-part shield around an EAGLE board, in mm, in the board's frame with the
+// bottom of the tray on z = 0: a tray with standoffs under the mounting holes
+// and windows for the edge connectors, and a lid held by a lip inside the
+// walls, with an opening over each channel connector engraved with its
+// number. The defaults fit PCB/eagle_files/schm.brd: J1 and the ESP32's USB
+// end through the walls, CANAL1-CANAL6 through the lid.
+struct Params {
+    float clearance = 0.5f; // board edge to the inside of the wall
+    float wall = 2;
+    float floor = 2;
+    float standoff = 5;     // floor to the underside of the board
+    float board = 1.6f;
+    float headroom = 20;    // board's top face to the lid
+    float lid = 2;
+    float lip = 2;          // depth of the lip under the lid
+    float lip_width = 1.2f;
+    float lip_clearance = 0.2f;
+    float fillet = 0.8f;    // standoffs and lip where they meet the shell (at most the wall)
+
+    float standoff_diameter = 6.5f;
+    float screw = 2.5f;      // pilot for M3 self-tapping screws
+    float screw_depth = 5;
+
+    std::vector<Port> ports = {{"J1"}, {"U1", 12, 12}};
+    float port_margin = 1;   // around a footprint's extent
+    float port_radius = 1;   // window corners
+
+    std::vector<std::string> channels = {"CANAL1", "CANAL2", "CANAL3", "CANAL4", "CANAL5", "CANAL6"};
+    float opening = 10;      // diameter of the hole over each channel
+    float label_height = 5;  // the channel number, right of its hole
+    float label_depth = 0.6f;
+};
+
+enum class Part { Bottom, Top };
+
+// Throws std::runtime_error when an element is missing from the board or the
+// parts do not fit each other (openings cutting the lip, windows reaching the
+// lid, pilots through the floor, ...).
+void validate(const eagle::Board& board, const Params& params);
+
+// Signed distance to one part, placed as assembled.
+sdf::Field field(const eagle::Board& board, const Params& params, Part part);
+
+// Box around the field, before polygonise() pads it.
+void bounds(const eagle::Board& board, const Params& params, Part part, Vec3& lo, Vec3& hi);
+
+mesh::Mesh build(const eagle::Board& board, const Params& params, Part part, const sdf::Options& options = {},
+                 sdf::Stats* stats = nullptr);
+
+} // namespace pwb::enclosure
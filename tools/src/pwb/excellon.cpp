@@ -0,0 +1,220 @@
+#include "pwb/excellon.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace pwb::excellon {
+
+namespace {
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+class Parser {
+public:
+    explicit Parser(std::string_view text) : s_(text) {}
+
+    DrillFile run() {
+        std::size_t pos = 0;
+        while (pos < s_.size()) {
+            std::size_t eol = s_.find('\n', pos);
+            if (eol == std::string_view::npos) eol = s_.size();
+            std::string_view line = s_.substr(pos, eol - pos);
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+            pos = eol + 1;
+            ++line_;
+            if (!line.empty()) statement(line);
+            if (done_) break;
+        }
+        return std::move(file_);
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const { throw ParseError(line_, what); }
+
+    void statement(std::string_view l) {
+        if (l[0] == ';') {
+            if (in_header_) file_.comments.emplace_back(l.substr(1));
+            return;
+        }
+        if (l == "M48") return void(in_header_ = true);
+        if (l == "%" || l == "M95") return void(in_header_ = false);
+        if (l == "M30" || l == "M00") return void(done_ = true);
+        if (l.substr(0, 6) == "METRIC" || l.substr(0, 4) == "INCH") return units(l);
+        if (l == "M71") return void(file_.format.metric = true);
+        if (l == "M72") return void(file_.format.metric = false);
+        if (l == "G90" || l == "G05" || l == "G00" || l == "G01" || l == "M15" || l == "M16" || l == "M17") return;
+        if (l.substr(0, 4) == "FMAT" || l.substr(0, 3) == "ICI" || l.substr(0, 4) == "VER,") return;
+        if (l == "G91") fail("incremental coordinates are not supported");
+        if (l[0] == 'T') return tool(l);
+        if (l[0] == 'X' || l[0] == 'Y') return hit(l);
+        if (in_header_) return; // unknown header directives carry no geometry
+        fail("unsupported statement '" + std::string(l) + "'");
+    }
+
+    void units(std::string_view l) {
+        Format& f = file_.format;
+        f.metric = l[0] == 'M';
+        f.has_units = true;
+        // Defaults per unit: metric 3.3, inch 2.4.
+        f.integer_digits = f.metric ? 3 : 2;
+        f.decimal_digits = f.metric ? 3 : 4;
+        std::size_t comma = l.find(',');
+        while (comma != std::string_view::npos) {
+            std::size_t next = l.find(',', comma + 1);
+            std::string_view field = l.substr(comma + 1, next == std::string_view::npos ? l.npos : next - comma - 1);
+            if (field == "TZ") f.keep_trailing = true, f.has_zeros = true;
+            else if (field == "LZ") f.keep_trailing = false, f.has_zeros = true;
+            else if (!field.empty() && (is_digit(field[0]) || field[0] == '.')) {
+                std::size_t dot = field.find('.');
+                if (dot != std::string_view::npos) {
+                    f.integer_digits = int(dot);
+                    f.decimal_digits = int(field.size() - dot - 1);
+                }
+            }
+            comma = next;
+        }
+    }
+
+    void tool(std::string_view l) {
+        std::size_t i = 1;
+        int number = 0;
+        while (i < l.size() && is_digit(l[i])) number = number * 10 + (l[i++] - '0');
+        std::size_t c = l.find('C', i);
+        if (c != std::string_view::npos) {
+            Tool* existing = file_.tool(number);
+            if (!existing) {
+                file_.tools.emplace_back();
+                existing = &file_.tools.back();
+                existing->number = number;
+            }
+            existing->diameter = std::strtod(std::string(l.substr(c + 1)).c_str(), nullptr) * unit_mm();
+            return;
+        }
+        if (number == 0) return void(current_ = -1); // T0 unloads the tool
+        for (std::size_t k = 0; k < file_.tools.size(); ++k) {
+            if (file_.tools[k].number == number) return void(current_ = int(k));
+        }
+        fail("tool T" + std::to_string(number) + " used before definition");
+    }
+
+    double unit_mm() const { return file_.format.metric ? 1.0 : 25.4; }
+
+    double coordinate(std::string_view& l) {
+        std::size_t i = 0;
+        while (i < l.size() && (is_digit(l[i]) || l[i] == '-' || l[i] == '+' || l[i] == '.')) ++i;
+        std::string_view num = l.substr(0, i);
+        l.remove_prefix(i);
+        if (num.empty()) fail("missing coordinate");
+        if (num.find('.') != std::string_view::npos) return std::strtod(std::string(num).c_str(), nullptr) * unit_mm();
+
+        bool neg = num[0] == '-';
+        if (num[0] == '-' || num[0] == '+') num.remove_prefix(1);
+        long long v = 0;
+        for (char c : num) {
+            if (!is_digit(c)) fail("bad coordinate");
+            v = v * 10 + (c - '0');
+        }
+        const Format& f = file_.format;
+        // TZ keeps trailing zeros, so the digits are right-aligned on the decimals;
+        // LZ keeps leading zeros, so they are left-aligned on the integer part.
+        int shift = f.keep_trailing ? 0 : f.integer_digits + f.decimal_digits - int(num.size());
+        double scaled = double(v) * std::pow(10.0, shift - f.decimal_digits);
+        return (neg ? -scaled : scaled) * unit_mm();
+    }
+
+    void hit(std::string_view l) {
+        if (current_ < 0) fail("hit with no tool selected");
+        Hit h = last_;
+        bool slot = false;
+        Hit end;
+        while (!l.empty()) {
+            char c = l[0];
+            l.remove_prefix(1);
+            if (c == 'X') (slot ? end.x : h.x) = coordinate(l);
+            else if (c == 'Y') (slot ? end.y : h.y) = coordinate(l);
+            else if (c == 'G' && l.substr(0, 2) == "85") {
+                l.remove_prefix(2);
+                slot = true;
+                end = h;
+            } else fail(std::string("unexpected '") + c + "' in hit");
+        }
+        Tool& t = file_.tools[std::size_t(current_)];
+        if (slot) {
+            t.slots.push_back({h, end});
+            last_ = end;
+        } else {
+            t.hits.push_back(h);
+            last_ = h;
+        }
+    }
+
+    std::string_view s_;
+    DrillFile file_;
+    Hit last_;
+    int line_ = 0;
+    int current_ = -1;
+    bool in_header_ = false;
+    bool done_ = false;
+};
+
+} // namespace
+
+Tool* DrillFile::tool(int number) {
+    for (Tool& t : tools)
+        if (t.number == number) return &t;
+    return nullptr;
+}
+
+const Tool* DrillFile::tool(int number) const {
+    for (const Tool& t : tools)
+        if (t.number == number) return &t;
+    return nullptr;
+}
+
+std::size_t DrillFile::hit_count() const {
+    std::size_t n = 0;
+    for (const Tool& t : tools) n += t.hits.size() + t.slots.size();
+    return n;
+}
+
+DrillFile parse(std::string_view text) { return Parser(text).run(); }
+
+std::string write(const DrillFile& file) {
+    const Format& f = file.format;
+    const double scale = std::pow(10.0, f.decimal_digits) / (f.metric ? 1.0 : 25.4);
+    std::string out = "M48\n";
+    for (const std::string& c : file.comments) out += ";" + c + "\n";
+    out += "FMAT,2\nICI,OFF\n";
+    out += f.metric ? "METRIC" : "INCH";
+    out += f.keep_trailing ? ",TZ," : ",LZ,";
+    out += std::string(std::size_t(f.integer_digits), '0') + "." + std::string(std::size_t(f.decimal_digits), '0') + "\n";
+    char buf[96];
+    for (const Tool& t : file.tools) {
+        std::snprintf(buf, sizeof buf, "T%dC%.3f\n", t.number, t.diameter / (f.metric ? 1.0 : 25.4));
+        out += buf;
+    }
+    out += "%\nG90\n";
+    out += f.metric ? "M71\n" : "M72\n";
+    auto coord = [&](double mm) {
+        long long v = std::llround(mm * scale);
+        if (f.keep_trailing) return std::to_string(v);
+        // LZ: pad to the full width, then drop trailing zeros.
+        std::string digits = std::to_string(v < 0 ? -v : v);
+        int total = f.integer_digits + f.decimal_digits;
+        if (int(digits.size()) < total) digits.insert(0, std::size_t(total) - digits.size(), '0');
+        while (digits.size() > 1 && digits.back() == '0') digits.pop_back();
+        return (v < 0 ? "-" : "") + digits;
+    };
+    for (const Tool& t : file.tools) {
+        if (t.hits.empty() && t.slots.empty()) continue;
+        out += "T" + std::to_string(t.number) + "\n";
+        for (const Hit& h : t.hits) out += "X" + coord(h.x) + "Y" + coord(h.y) + "\n";
+        for (const Slot& s : t.slots)
+            out += "X" + coord(s.from.x) + "Y" + coord(s.from.y) + "G85X" + coord(s.to.x) + "Y" + coord(s.to.y) + "\n";
+    }
+    out += "M30";
+    return out;
+}
+
+} // namespace pwb::excellon
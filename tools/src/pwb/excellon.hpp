@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pwb::excellon {
+
+struct Hit {
+    double x = 0, y = 0; // millimetres
+};
+
+struct Slot {
+    Hit from, to;
+};
+
+struct Tool {
+    int number = 0;
+    double diameter = 0; // millimetres
+    std::vector<Hit> hits;
+    std::vector<Slot> slots;
+};
+
+// Header settings, kept so that validators can compare them with the Gerbers.
+struct Format {
+    bool metric = true;
+    bool has_units = false;
+    bool keep_trailing = true;  // "TZ": trailing zeros present, leading suppressed
+    bool has_zeros = false;     // TZ or LZ written on the units line
+    int integer_digits = 3;
+    int decimal_digits = 3;
+};
+
+struct DrillFile {
+    Format format;
+    std::vector<std::string> comments; // ";..." header lines
+    std::vector<Tool> tools;           // in definition order
+
+    Tool* tool(int number);
+    const Tool* tool(int number) const;
+    std::size_t hit_count() const;
+};
+
+class ParseError : public std::runtime_error {
+public:
+    ParseError(int line, const std::string& what)
+        : std::runtime_error("line " + std::to_string(line) + ": " + what), line_(line) {}
+    int line() const { return line_; }
+
+private:
+    int line_;
+};
+
+DrillFile parse(std::string_view text);
+
+// Writes the file back in the dialect EAGLE produces (M48 header, FMAT,2,
+// units/zeros/format line), preserving tool and hit order.
+std::string write(const DrillFile& file);
+
+} // namespace pwb::excellon
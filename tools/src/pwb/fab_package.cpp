@@ -0,0 +1,334 @@
+#include "pwb/fab_package.hpp"
+
+#include "pwb/json.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+
+namespace pwb::fab {
+
+namespace {
+
+using gerber::Box;
+using gerber::Coord;
+
+std::string lower(std::string_view s) {
+    std::string out(s);
+    for (char& c : out)
+        if (c >= 'A' && c <= 'Z') c = char(c - 'A' + 'a');
+    return out;
+}
+
+bool contains(std::string_view s, std::string_view what) { return s.find(what) != std::string_view::npos; }
+
+double mm(Coord v) { return double(v) / gerber::kNmPerMm; }
+
+std::string printf_string(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+std::string printf_string(const char* fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    std::vsnprintf(buf, sizeof buf, fmt, ap);
+    va_end(ap);
+    return buf;
+}
+
+std::string fs_text(const gerber::Format& f) {
+    return printf_string("FS%c%c%d%d/%d%d", f.omit_trailing ? 'T' : 'L', f.incremental ? 'I' : 'A', f.x_integer, f.x_decimal,
+                  f.y_integer, f.y_decimal);
+}
+
+bool same_format(const gerber::Format& a, const gerber::Format& b) {
+    return a.x_integer == b.x_integer && a.x_decimal == b.x_decimal && a.y_integer == b.y_integer &&
+           a.y_decimal == b.y_decimal && a.omit_trailing == b.omit_trailing && a.incremental == b.incremental;
+}
+
+// Box through the centres of everything drawn: for a profile this is the
+// board edge itself, without the width of the outline pen.
+Box centreline(const gerber::Layer& layer) {
+    Box b;
+    for (const gerber::Stroke& s : layer.strokes) b.add(s.x0, s.y0), b.add(s.x1, s.y1);
+    for (const gerber::Flash& f : layer.flashes) b.add(f.x, f.y);
+    for (const gerber::Point& p : layer.region_points) b.add(p.x, p.y);
+    return b;
+}
+
+bool inside(const Box& inner, const Box& outer, Coord slack) {
+    return inner.empty() || (inner.min_x >= outer.min_x - slack && inner.min_y >= outer.min_y - slack &&
+                             inner.max_x <= outer.max_x + slack && inner.max_y <= outer.max_y + slack);
+}
+
+struct Member {
+    std::string path;
+    std::string name; // basename
+    std::string function;
+    gerber::Layer layer;
+    Box bounds;
+};
+
+} // namespace
+
+JobFile parse_job(std::string_view text) {
+    json::Value doc = json::parse(text);
+    if (!doc.is_object()) throw std::runtime_error("gbrjob: top level is not an object");
+    JobFile job;
+    job.application = doc.string_at("Header.GenerationSoftware.Application");
+    job.version = doc.string_at("Header.GenerationSoftware.Version");
+    job.project = doc.string_at("Overall.Name.ProjectId");
+    job.layer_count = int(doc.number_at("Overall.LayerNumber"));
+    job.thickness = doc.number_at("Overall.BoardThickness");
+    job.size_x = doc.number_at("Overall.Size.X");
+    job.size_y = doc.number_at("Overall.Size.Y");
+    if (const json::Value* files = doc.get("FilesAttributes"); files && files->is_array()) {
+        for (const json::Value& f : files->items) job.files.push_back({f.string_at("Path"), f.string_at("FileFunction")});
+    }
+    return job;
+}
+
+std::string guess_function(std::string_view member, std::string_view image_name, int layer_count) {
+    std::string n = lower(image_name) + " " + lower(member);
+    bool top = contains(n, "top"), bottom = contains(n, "bottom") || contains(n, "bot");
+    std::string side = top ? "Top" : bottom ? "Bot" : "";
+    if (contains(n, "profile") || contains(n, "outline") || contains(n, "dimension")) return "Profile,NP";
+    if (contains(n, "copper")) {
+        if (top) return "Copper,L1,Top";
+        if (bottom) return "Copper,L" + std::to_string(std::max(layer_count, 2)) + ",Bot";
+        return "Copper";
+    }
+    if (contains(n, "soldermask") || contains(n, "solder mask")) return "Soldermask," + side;
+    if (contains(n, "solderpaste") || contains(n, "paste")) return "Paste," + side;
+    if (contains(n, "silkscreen") || contains(n, "legend")) return "Legend," + side;
+    return "Other";
+}
+
+const char* status_name(Status s) {
+    switch (s) {
+    case Status::Pass: return "PASS";
+    case Status::Warn: return "WARN";
+    case Status::Fail: return "FAIL";
+    }
+    return "?";
+}
+
+Status Report::overall() const {
+    Status worst = Status::Pass;
+    for (const Check& c : checks) worst = std::max(worst, c.status);
+    return worst;
+}
+
+std::size_t Report::count(Status s) const {
+    return std::size_t(std::count_if(checks.begin(), checks.end(), [s](const Check& c) { return c.status == s; }));
+}
+
+Report validate(const ZipArchive& package, const Options& options) {
+    auto t0 = std::chrono::steady_clock::now();
+    Report report;
+    auto add = [&](std::string name, Status s, std::string detail) {
+        report.checks.push_back({std::move(name), s, std::move(detail)});
+    };
+
+    const ZipEntry* job_entry = nullptr;
+    std::vector<const ZipEntry*> gerbers, drills;
+    for (const ZipEntry& e : package.entries()) {
+        std::string name = lower(e.basename());
+        if (ends_with(name, ".gbrjob")) job_entry = &e;
+        else if (ends_with(name, ".gbr") || ends_with(name, ".ger") || ends_with(name, ".gtl") || ends_with(name, ".gbl"))
+            gerbers.push_back(&e);
+        else if (ends_with(name, ".xln") || ends_with(name, ".drl") || ends_with(name, ".xnc")) drills.push_back(&e);
+    }
+
+    JobFile job;
+    bool have_job = false;
+    if (!job_entry) {
+        add("job file", Status::Fail, "no .gbrjob in the package");
+    } else {
+        try {
+            job = parse_job(package.read(*job_entry));
+            have_job = true;
+            Status s = job.layer_count > 0 && job.size_x > 0 && job.size_y > 0 ? Status::Pass : Status::Fail;
+            if (s == Status::Pass && (job.thickness < 0.2 || job.thickness > 3.2)) s = Status::Warn;
+            add("job file", s,
+                    printf_string("%s %s, %d layers, %.2f mm thick, %.2f x %.2f mm", job.application.c_str(), job.version.c_str(),
+                           job.layer_count, job.thickness, job.size_x, job.size_y));
+        } catch (const std::exception& ex) {
+            add("job file", Status::Fail, ex.what());
+        }
+    }
+
+    // Parse every layer concurrently; headers and extents both come from the full parse.
+    std::vector<Member> members(gerbers.size());
+    std::vector<std::string> errors(gerbers.size());
+    parallel_for(
+        gerbers.size(),
+        [&](std::size_t i) {
+            Member& m = members[i];
+            m.path = gerbers[i]->name;
+            m.name = std::string(gerbers[i]->basename());
+            try {
+                m.layer = gerber::parse(package, *gerbers[i]);
+                m.bounds = m.layer.bounds();
+            } catch (const std::exception& ex) {
+                errors[i] = ex.what();
+            }
+        },
+        options.threads);
+
+    std::map<std::string, std::string> listed; // job path -> function
+    for (const JobFile::File& f : job.files) listed[lower(f.path)] = f.function;
+    for (Member& m : members) {
+        auto it = listed.find(lower(m.path));
+        if (it == listed.end()) it = listed.find(lower(m.name));
+        m.function = it != listed.end() ? it->second : guess_function(m.name, m.layer.name, job.layer_count);
+    }
+
+    // Headers.
+    const Member* reference = nullptr;
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        const Member& m = members[i];
+        if (!errors[i].empty()) {
+            add("header " + m.name, Status::Fail, errors[i]);
+            continue;
+        }
+        std::vector<std::string> missing;
+        if (!m.layer.has_units) missing.push_back("%MO%");
+        if (!m.layer.has_format) missing.push_back("%FS%");
+        Status s = missing.empty() ? Status::Pass : Status::Fail;
+        std::string detail = printf_string("%s %s %%IN%s%% -> %s", m.layer.units == gerber::Units::Millimetres ? "MOMM" : "MOIN",
+                                    fs_text(m.layer.format).c_str(), m.layer.name.c_str(), m.function.c_str());
+        for (const std::string& what : missing) detail += ", missing " + what;
+        if (s == Status::Pass && m.layer.name.empty()) s = Status::Warn, detail += ", empty image name";
+        if (s == Status::Pass && m.layer.format.omit_trailing) s = Status::Warn, detail += ", trailing-zero omission is deprecated";
+        add("header " + m.name, s, detail);
+        if (!reference && m.layer.has_units && m.layer.has_format) reference = &m;
+    }
+
+    // Units and format agree across layers.
+    if (reference) {
+        std::string odd_units, odd_format;
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            if (!errors[i].empty()) continue;
+            if (members[i].layer.units != reference->layer.units) odd_units += " " + members[i].name;
+            if (!same_format(members[i].layer.format, reference->layer.format)) odd_format += " " + members[i].name;
+        }
+        add("units", odd_units.empty() ? Status::Pass : Status::Fail,
+                odd_units.empty() ? std::string(reference->layer.units == gerber::Units::Millimetres ? "all layers in mm"
+                                                                                                     : "all layers in inches")
+                                  : "differs from " + reference->name + ":" + odd_units);
+        add("format", odd_format.empty() ? Status::Pass : Status::Warn,
+                odd_format.empty() ? "all layers " + fs_text(reference->layer.format)
+                                   : "differs from " + reference->name + ":" + odd_format);
+    }
+
+    // Layer presence.
+    const Member* profile = nullptr;
+    int copper = 0;
+    bool mask_top = false, mask_bottom = false;
+    for (const Member& m : members) {
+        if (m.function.rfind("Profile", 0) == 0) profile = &m;
+        if (m.function.rfind("Copper", 0) == 0) ++copper;
+        if (m.function == "Soldermask,Top") mask_top = true;
+        if (m.function == "Soldermask,Bot") mask_bottom = true;
+    }
+    {
+        std::vector<std::string> problems;
+        Status s = Status::Pass;
+        if (have_job && copper != job.layer_count)
+            problems.push_back(printf_string("%d copper layers, job declares %d", copper, job.layer_count)), s = Status::Fail;
+        if (!profile) problems.push_back("no profile layer"), s = Status::Fail;
+        if (copper > 0 && !mask_top) problems.push_back("no top soldermask"), s = std::max(s, Status::Warn);
+        if (copper > 1 && !mask_bottom) problems.push_back("no bottom soldermask"), s = std::max(s, Status::Warn);
+        for (const JobFile::File& f : job.files) {
+            if (!package.find(f.path)) problems.push_back("job lists missing " + f.path), s = Status::Fail;
+        }
+        if (!job.files.empty()) {
+            for (const Member& m : members)
+                if (!listed.count(lower(m.path)) && !listed.count(lower(m.name)))
+                    problems.push_back(m.name + " not in job"), s = std::max(s, Status::Warn);
+        }
+        std::string detail = printf_string("%d copper, %zu Gerber files, %zu drill files", copper, members.size(), drills.size());
+        for (const std::string& p : problems) detail += "; " + p;
+        if (job.files.empty() && have_job) detail += "; job has no FilesAttributes, functions guessed from names";
+        add("layers", s, detail);
+    }
+
+    // Size and extents against the profile.
+    Box edge;
+    if (profile) {
+        edge = centreline(profile->layer);
+        if (have_job) {
+            double dx = mm(edge.width()) - job.size_x, dy = mm(edge.height()) - job.size_y;
+            double slack = mm(options.tolerance);
+            bool ok = std::abs(dx) <= slack && std::abs(dy) <= slack;
+            add("board size", ok ? Status::Pass : Status::Fail,
+                    printf_string("profile %.3f x %.3f mm, job %.2f x %.2f mm", mm(edge.width()), mm(edge.height()), job.size_x,
+                           job.size_y));
+        }
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            const Member& m = members[i];
+            if (&m == profile || !errors[i].empty()) continue;
+            if (m.bounds.empty()) {
+                add("extent " + m.name, Status::Pass, "empty layer");
+                continue;
+            }
+            // Copper must stay on the board; legend and mask past the edge are only trimmed by the fab.
+            bool ok = inside(m.bounds, profile->bounds, options.tolerance);
+            Status s = ok ? Status::Pass : m.function.rfind("Copper", 0) == 0 ? Status::Fail : Status::Warn;
+            add("extent " + m.name, s,
+                    printf_string("[%.3f, %.3f]-[%.3f, %.3f] mm%s", mm(m.bounds.min_x), mm(m.bounds.min_y), mm(m.bounds.max_x),
+                           mm(m.bounds.max_y), ok ? "" : ", outside the profile"));
+        }
+    }
+
+    // Drill files: units and zero mode must be declared and agree with the Gerbers.
+    for (const ZipEntry* e : drills) {
+        std::string name(e->basename());
+        excellon::DrillFile d;
+        try {
+            d = excellon::parse(package.read(*e));
+        } catch (const std::exception& ex) {
+            add("drill " + name, Status::Fail, ex.what());
+            continue;
+        }
+        const excellon::Format& f = d.format;
+        std::string detail = printf_string("%s,%s %d.%d, %zu tools, %zu hits", f.metric ? "METRIC" : "INCH",
+                                    f.keep_trailing ? "TZ" : "LZ", f.integer_digits, f.decimal_digits, d.tools.size(),
+                                    d.hit_count());
+        Status s = Status::Pass;
+        if (!f.has_units) s = Status::Fail, detail += "; no METRIC/INCH line, zero mode is a guess";
+        else if (!f.has_zeros) s = Status::Fail, detail += "; no TZ/LZ on the units line, zero mode is a guess";
+        if (reference && f.metric != (reference->layer.units == gerber::Units::Millimetres))
+            s = Status::Fail, detail += "; units differ from the Gerbers";
+        // %FSLA% drops leading zeros and so keeps trailing ones, which is Excellon's TZ.
+        if (reference && f.keep_trailing == reference->layer.format.omit_trailing)
+            s = Status::Fail, detail += printf_string("; %s but the Gerbers are %%FS%cA%%", f.keep_trailing ? "TZ" : "LZ",
+                                                      reference->layer.format.omit_trailing ? 'T' : 'L');
+        if (profile && !edge.empty()) {
+            std::size_t outside = 0;
+            for (const excellon::Tool& t : d.tools)
+                for (const excellon::Hit& h : t.hits) {
+                    double r = t.diameter / 2;
+                    Box hole;
+                    hole.add(Coord((h.x - r) * gerber::kNmPerMm), Coord((h.y - r) * gerber::kNmPerMm));
+                    hole.add(Coord((h.x + r) * gerber::kNmPerMm), Coord((h.y + r) * gerber::kNmPerMm));
+                    if (!inside(hole, edge, options.tolerance)) ++outside;
+                }
+            // A wrong zero mode or digit count scales every coordinate, which shows up here first.
+            if (outside) s = Status::Fail, detail += printf_string("; %zu holes outside the board", outside);
+        }
+        add("drill " + name, s, detail);
+    }
+    if (drills.empty()) add("drill", Status::Warn, "no drill file in the package");
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return report;
+}
+
+} // namespace pwb::fab
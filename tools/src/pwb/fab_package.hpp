@@ -0,0 +1,67 @@
+#pragma once
+
+#include "pwb/excellon.hpp"
+#include "pwb/gerber.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pwb {
+class ZipArchive;
+}
+
+namespace pwb::fab {
+
+// The parts of a .gbrjob (Gerber job file, JSON) that a fab checks against
+// the layers. Sizes are millimetres, as the format requires.
+struct JobFile {
+    std::string application;
+    std::string version;
+    std::string project;
+    int layer_count = 0;
+    double thickness = 0;
+    double size_x = 0, size_y = 0;
+
+    struct File {
+        std::string path;
+        std::string function; // "Copper,L1,Top", "Profile,NP", ...
+    };
+    std::vector<File> files; // FilesAttributes, empty when the CAM tool omits it
+};
+
+JobFile parse_job(std::string_view text);
+
+// File function a Gerber member plays, from the job file when it lists the
+// member, otherwise guessed from the %IN% name and then the file name.
+std::string guess_function(std::string_view member, std::string_view image_name, int layer_count);
+
+enum class Status { Pass, Warn, Fail };
+
+struct Check {
+    std::string name;
+    Status status = Status::Pass;
+    std::string detail;
+};
+
+struct Report {
+    std::vector<Check> checks;
+    double seconds = 0;
+
+    Status overall() const;
+    std::size_t count(Status s) const;
+};
+
+struct Options {
+    gerber::Coord tolerance = 50'000; // size and extent slack, 50 µm
+    unsigned threads = 0;
+};
+
+// Cross-checks a CAM zip: job metadata against the profile, every layer's
+// %MO/%FS/%IN header, layer presence and extents, and the drill file's units
+// and zero mode against the Gerbers.
+Report validate(const ZipArchive& package, const Options& options = {});
+
+const char* status_name(Status s);
+
+} // namespace pwb::fab
@@ -0,0 +1,405 @@
+#include "pwb/fit.hpp"
+
+#include "pwb/board_geometry.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace pwb::fit {
+
+namespace {
+
+// Same strict test as the self-intersection check: touching faces do not count.
+bool segment_crosses(const D3& p, const D3& q, const D3& a, const D3& b, const D3& c) {
+    const double sp = orient(a, b, c, p), sq = orient(a, b, c, q);
+    if (!((sp > 0 && sq < 0) || (sp < 0 && sq > 0))) return false;
+    const double u = orient(p, q, a, b), v = orient(p, q, b, c), w = orient(p, q, c, a);
+    return (u > 0 && v > 0 && w > 0) || (u < 0 && v < 0 && w < 0);
+}
+
+bool triangles_cross(const D3* t, const D3* s) {
+    for (int k = 0; k < 3; ++k) {
+        if (segment_crosses(t[k], t[(k + 1) % 3], s[0], s[1], s[2])) return true;
+        if (segment_crosses(s[k], s[(k + 1) % 3], t[0], t[1], t[2])) return true;
+    }
+    return false;
+}
+
+// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5).
+D3 closest_on_triangle(const D3& p, const D3& a, const D3& b, const D3& c) {
+    const D3 ab = sub(b, a), ac = sub(c, a), ap = sub(p, a);
+    const double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+    const D3 bp = sub(p, b);
+    const double d3_ = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3_ >= 0 && d4 <= d3_) return b;
+    const double vc = d1 * d4 - d3_ * d2;
+    if (vc <= 0 && d1 >= 0 && d3_ <= 0) return add(a, mul(ab, d1 / (d1 - d3_)));
+    const D3 cp = sub(p, c);
+    const double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return add(a, mul(ac, d2 / (d2 - d6)));
+    const double va = d3_ * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3_ >= 0 && d5 - d6 >= 0)
+        return add(b, mul(sub(c, b), (d4 - d3_) / ((d4 - d3_) + (d5 - d6))));
+    const double denom = 1 / (va + vb + vc);
+    return add(a, add(mul(ab, vb * denom), mul(ac, vc * denom)));
+}
+
+// Closest points of segments p1q1 and p2q2 (Ericson 5.1.9); returns the squared distance.
+double closest_segments(const D3& p1, const D3& q1, const D3& p2, const D3& q2, D3& c1, D3& c2) {
+    const D3 d1 = sub(q1, p1), d2 = sub(q2, p2), r = sub(p1, p2);
+    const double a = norm2(d1), e = norm2(d2), f = dot(d2, r);
+    double s = 0, t = 0;
+    if (a <= 1e-30 && e <= 1e-30) {
+        // both points
+    } else if (a <= 1e-30) {
+        t = std::clamp(f / e, 0.0, 1.0);
+    } else {
+        const double c = dot(d1, r);
+        if (e <= 1e-30) {
+            s = std::clamp(-c / a, 0.0, 1.0);
+        } else {
+            const double b = dot(d1, d2), denom = a * e - b * b;
+            s = denom > 0 ? std::clamp((b * f - c * e) / denom, 0.0, 1.0) : 0.0;
+            t = (b * s + f) / e;
+            if (t < 0) t = 0, s = std::clamp(-c / a, 0.0, 1.0);
+            else if (t > 1) t = 1, s = std::clamp((b - c) / a, 0.0, 1.0);
+        }
+    }
+    c1 = add(p1, mul(d1, s));
+    c2 = add(p2, mul(d2, t));
+    return norm2(sub(c1, c2));
+}
+
+// Distance between two triangles that do not cross: the minimum over the
+// vertex-face and edge-edge candidates.
+double triangle_distance2(const D3* t, const D3* s, D3& pt, D3& ps) {
+    double best = 1e300;
+    auto take = [&](double d2, const D3& a, const D3& b) {
+        if (d2 < best) best = d2, pt = a, ps = b;
+    };
+    for (int k = 0; k < 3; ++k) {
+        const D3 q = closest_on_triangle(t[k], s[0], s[1], s[2]);
+        take(norm2(sub(t[k], q)), t[k], q);
+        const D3 r = closest_on_triangle(s[k], t[0], t[1], t[2]);
+        take(norm2(sub(s[k], r)), r, s[k]);
+    }
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) {
+            D3 a, b;
+            const double d2 = closest_segments(t[i], t[(i + 1) % 3], s[j], s[(j + 1) % 3], a, b);
+            take(d2, a, b);
+        }
+    return best;
+}
+
+float box_distance(const bvh::Aabb& a, const bvh::Aabb& b) {
+    const float dx = std::max({0.0f, a.min.x - b.max.x, b.min.x - a.max.x});
+    const float dy = std::max({0.0f, a.min.y - b.max.y, b.min.y - a.max.y});
+    const float dz = std::max({0.0f, a.min.z - b.max.z, b.min.z - a.max.z});
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+struct Part {
+    const mesh::Mesh& mesh;
+    std::vector<D3> corner; // 3 per triangle
+    std::vector<bvh::Aabb> boxes;
+    bvh::Tree tree;
+
+    explicit Part(const mesh::Mesh& m) : mesh(m), corner(3 * m.triangles.size()), boxes(m.triangles.size()) {
+        for (std::size_t t = 0; t < m.triangles.size(); ++t)
+            for (int k = 0; k < 3; ++k) {
+                const Vec3& v = m.vertices[m.triangles[t][std::size_t(k)]];
+                corner[3 * t + std::size_t(k)] = d3(v);
+                boxes[t].grow(v);
+            }
+        tree = bvh::build(boxes);
+    }
+    const D3* tri(std::size_t t) const { return &corner[3 * t]; }
+};
+
+// Per-task state of the dual traversal; `best` and `bound` are shared but
+// every task only touches the triangles and nodes of its own moving subtree.
+struct Walker {
+    const Part& fixed;
+    const Part& moving;
+    std::vector<float>& best;  // per moving triangle
+    std::vector<float>& bound; // per moving node: worst clearance still open inside it
+    std::size_t crossing = 0, tested = 0;
+    double closest = 1e300;
+    D3 closest_m{}, closest_f{};
+
+    void leaves(const bvh::Node& m, const bvh::Node& f) {
+        for (std::uint32_t i = m.first; i < m.first + m.count; ++i) {
+            const std::uint32_t tm = moving.tree.items[i];
+            for (std::uint32_t j = f.first; j < f.first + f.count; ++j) {
+                const std::uint32_t tf = fixed.tree.items[j];
+                const bool touching = moving.boxes[tm].overlaps(fixed.boxes[tf]);
+                if (!touching && box_distance(moving.boxes[tm], fixed.boxes[tf]) > best[tm]) continue;
+                if (touching && triangles_cross(moving.tri(tm), fixed.tri(tf))) {
+                    ++crossing;
+                    best[tm] = 0;
+                    if (closest > 0) closest = 0, closest_m = closest_f = moving.tri(tm)[0];
+                    continue;
+                }
+                D3 pm, pf;
+                const double d2 = triangle_distance2(moving.tri(tm), fixed.tri(tf), pm, pf);
+                ++tested;
+                const float d = float(std::sqrt(d2));
+                if (d < best[tm]) best[tm] = d;
+                if (d < closest) closest = d, closest_m = pm, closest_f = pf;
+            }
+        }
+    }
+
+    float leaf_bound(const bvh::Node& m) const {
+        float b = 0;
+        for (std::uint32_t i = m.first; i < m.first + m.count; ++i) b = std::max(b, best[moving.tree.items[i]]);
+        return b;
+    }
+
+    void visit(std::uint32_t m, std::uint32_t f) {
+        const bvh::Node& nm = moving.tree.nodes[m];
+        const bvh::Node& nf = fixed.tree.nodes[f];
+        if (box_distance(nm.box, nf.box) > bound[m]) return;
+        if (nm.count && nf.count) {
+            leaves(nm, nf);
+            bound[m] = leaf_bound(nm);
+            return;
+        }
+        if (nf.count || (!nm.count && nm.box.area() >= nf.box.area())) {
+            visit(nm.first, f);
+            visit(nm.first + 1, f);
+            bound[m] = std::max(bound[nm.first], bound[nm.first + 1]);
+            return;
+        }
+        // Nearer fixed child first so it tightens the bound for the other.
+        std::uint32_t a = nf.first, b = nf.first + 1;
+        if (box_distance(nm.box, fixed.tree.nodes[b].box) < box_distance(nm.box, fixed.tree.nodes[a].box)) std::swap(a, b);
+        visit(m, a);
+        visit(m, b);
+    }
+};
+
+// Nearest distance from p to the part's surface.
+double point_distance(const Part& part, const D3& p) {
+    double best = 1e300;
+    const bvh::Aabb pb{f3(p), f3(p)};
+    std::uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const bvh::Node& n = part.tree.nodes[stack[--top]];
+        const double d = box_distance(n.box, pb);
+        if (d * d > best) continue;
+        if (n.count) {
+            for (std::uint32_t i = n.first; i < n.first + n.count; ++i) {
+                const D3* t = part.tri(part.tree.items[i]);
+                best = std::min(best, norm2(sub(p, closest_on_triangle(p, t[0], t[1], t[2]))));
+            }
+            continue;
+        }
+        // Nearer child on top so the first leaves reached tighten `best`.
+        std::uint32_t a = n.first, b = n.first + 1;
+        const double da = box_distance(part.tree.nodes[a].box, pb), db = box_distance(part.tree.nodes[b].box, pb);
+        if (da < db) std::swap(a, b);
+        stack[top++] = a;
+        stack[top++] = b;
+    }
+    return std::sqrt(best);
+}
+
+// Odd number of crossings along a slightly skewed ray: inside.
+bool inside(const ray::Scene& scene, const Vec3& p) {
+    ray::Ray r{p, {0.0013f, 0.0021f, 1.0f}, 1e30f};
+    int crossings = 0;
+    for (int guard = 0; guard < 256; ++guard) {
+        const ray::Hit h = scene.intersect(r);
+        if (h.triangle == mesh::kNone) break;
+        ++crossings;
+        r.origin = {r.origin.x + r.dir.x * (h.t + 1e-4f), r.origin.y + r.dir.y * (h.t + 1e-4f),
+                    r.origin.z + r.dir.z * (h.t + 1e-4f)};
+    }
+    return crossings % 2 == 1;
+}
+
+} // namespace
+
+Report check(const mesh::Mesh& fixed_mesh, const mesh::Mesh& moving_mesh, const Options& options) {
+    const auto t0 = std::chrono::steady_clock::now();
+    Report r;
+    r.histogram.assign(std::size_t(std::max(1, options.bins)), 0.0);
+    if (fixed_mesh.triangles.empty() || moving_mesh.triangles.empty()) return r;
+    const Part fixed(fixed_mesh), moving(moving_mesh);
+    const std::size_t nm = moving_mesh.triangles.size();
+
+    // Moving subtrees, one per task, disjoint so their writes never meet.
+    const unsigned threads = options.threads ? options.threads : default_threads();
+    std::vector<std::uint32_t> roots{0};
+    while (roots.size() < 8 * std::size_t(threads)) {
+        std::vector<std::uint32_t> next;
+        bool split = false;
+        for (std::uint32_t n : roots) {
+            const bvh::Node& node = moving.tree.nodes[n];
+            if (node.count) next.push_back(n);
+            else next.push_back(node.first), next.push_back(node.first + 1), split = true;
+        }
+        roots.swap(next);
+        if (!split) break;
+    }
+
+    std::vector<float> best(nm, options.max_distance);
+    std::vector<float> bound(moving.tree.nodes.size(), options.max_distance);
+    std::vector<Walker> walkers(roots.size(), Walker{fixed, moving, best, bound});
+    parallel_for(roots.size(), [&](std::size_t i) { walkers[i].visit(roots[i], 0); }, options.threads);
+    double closest = 1e300;
+    for (const Walker& w : walkers) {
+        r.intersecting_pairs += w.crossing;
+        r.pairs_tested += w.tested;
+        if (w.closest < closest) closest = w.closest, r.closest_moving = f3(w.closest_m), r.closest_fixed = f3(w.closest_f);
+    }
+    if (closest <= options.max_distance) r.min_distance = float(closest);
+
+    // Histogram and contact patches over the moving surface.
+    const double bin = double(options.max_distance) / double(r.histogram.size());
+    std::vector<double> area(nm);
+    UnionFind patches(moving_mesh.vertices.size());
+    for (std::size_t t = 0; t < nm; ++t) {
+        const D3* c = moving.tri(t);
+        area[t] = std::sqrt(norm2(cross(sub(c[1], c[0]), sub(c[2], c[0])))) / 2;
+        r.area += area[t];
+        if (best[t] < options.max_distance)
+            r.histogram[std::min(r.histogram.size() - 1, std::size_t(best[t] / bin))] += area[t];
+        if (best[t] <= options.contact) {
+            const mesh::Triangle& tri = moving_mesh.triangles[t];
+            patches.join(tri[0], tri[1]), patches.join(tri[1], tri[2]);
+        }
+    }
+    std::vector<std::uint32_t> patch_of(moving_mesh.vertices.size(), mesh::kNone);
+    for (std::size_t t = 0; t < nm; ++t) {
+        if (best[t] > options.contact) continue;
+        const std::uint32_t root = patches.find(moving_mesh.triangles[t][0]);
+        if (patch_of[root] == mesh::kNone) patch_of[root] = std::uint32_t(r.contacts.size()), r.contacts.push_back({0, 0, {}, kFar});
+        Contact& c = r.contacts[patch_of[root]];
+        ++c.triangles;
+        c.area += area[t];
+        c.box.grow(moving.boxes[t]);
+        c.min_distance = std::min(c.min_distance, best[t]);
+    }
+    std::sort(r.contacts.begin(), r.contacts.end(), [](const Contact& a, const Contact& b) { return a.area > b.area; });
+
+    // Vertices buried in the other part, by parity, with their depth.
+    ray::Scene fixed_scene, moving_scene;
+    fixed_scene.add(fixed_mesh), fixed_scene.build();
+    moving_scene.add(moving_mesh), moving_scene.build();
+    struct Probe {
+        const mesh::Mesh& from;
+        const ray::Scene& into;
+        const Part& part;
+    };
+    for (const Probe& p : {Probe{moving_mesh, fixed_scene, fixed}, Probe{fixed_mesh, moving_scene, moving}}) {
+        const bvh::Aabb box = p.part.tree.nodes[0].box;
+        const std::size_t block = 1024, blocks = (p.from.vertices.size() + block - 1) / block;
+        std::vector<std::size_t> count(blocks, 0);
+        std::vector<float> depth(blocks, 0);
+        parallel_for(
+            blocks,
+            [&](std::size_t b) {
+                for (std::size_t v = b * block; v < std::min(p.from.vertices.size(), (b + 1) * block); ++v) {
+                    const Vec3& q = p.from.vertices[v];
+                    if (!box.overlaps({q, q}) || !inside(p.into, q)) continue;
+                    const float d = float(point_distance(p.part, d3(q)));
+                    if (d <= 1e-4f) continue; // on the surface: a contact, not a penetration
+                    ++count[b];
+                    depth[b] = std::max(depth[b], d);
+                }
+            },
+            options.threads);
+        for (std::size_t b = 0; b < blocks; ++b) r.vertices_inside += count[b], r.max_depth = std::max(r.max_depth, depth[b]);
+    }
+    if (r.interpenetrates()) r.min_distance = 0;
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+float seat_distance(const mesh::Mesh& fixed, const mesh::Mesh& moving, const Vec3& dir) {
+    ray::Scene fixed_scene, moving_scene;
+    fixed_scene.add(fixed), fixed_scene.build();
+    moving_scene.add(moving), moving_scene.build();
+    float best = kFar;
+    auto cast = [&](const mesh::Mesh& from, const ray::Scene& into, const Vec3& d) {
+        std::vector<Vec3> points = from.vertices;
+        for (const mesh::Triangle& t : from.triangles) {
+            const Vec3 &a = from.vertices[t[0]], &b = from.vertices[t[1]], &c = from.vertices[t[2]];
+            points.push_back({(a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3, (a.z + b.z + c.z) / 3});
+        }
+        for (const Vec3& p : points) best = std::min(best, into.intersect({p, d, best}).t);
+    };
+    cast(moving, fixed_scene, dir);
+    cast(fixed, moving_scene, {-dir.x, -dir.y, -dir.z});
+    return best;
+}
+
+mesh::Mesh translated(const mesh::Mesh& m, const Vec3& offset) {
+    mesh::Mesh out = m;
+    for (Vec3& v : out.vertices) v = {v.x + offset.x, v.y + offset.y, v.z + offset.z};
+    return out;
+}
+
+mesh::Mesh board_solid(const eagle::Board& board, double thickness, double z, double tolerance) {
+    const std::vector<std::pair<double, double>> outline = eagle::outline(board, tolerance);
+
+    // Ear clipping of the counter-clockwise outline.
+    const std::size_t n = outline.size();
+    auto cross2 = [&](std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+        return (outline[b].first - outline[a].first) * (outline[c].second - outline[a].second) -
+               (outline[b].second - outline[a].second) * (outline[c].first - outline[a].first);
+    };
+    std::vector<std::uint32_t> ring(n);
+    std::iota(ring.begin(), ring.end(), 0u);
+    std::vector<mesh::Triangle> cap;
+    while (ring.size() > 3) {
+        bool clipped = false;
+        for (std::size_t i = 0; i < ring.size() && !clipped; ++i) {
+            const std::uint32_t a = ring[(i + ring.size() - 1) % ring.size()], b = ring[i], c = ring[(i + 1) % ring.size()];
+            if (cross2(a, b, c) <= 0) continue;
+            bool ear = true;
+            for (std::uint32_t p : ring)
+                if (p != a && p != b && p != c && cross2(a, b, p) >= 0 && cross2(b, c, p) >= 0 && cross2(c, a, p) >= 0) {
+                    ear = false;
+                    break;
+                }
+            if (!ear) continue;
+            cap.push_back({a, b, c});
+            ring.erase(ring.begin() + std::ptrdiff_t(i));
+            clipped = true;
+        }
+        if (!clipped) throw std::runtime_error("board outline self-intersects");
+    }
+    cap.push_back({ring[0], ring[1], ring[2]});
+
+    mesh::Mesh m;
+    for (double level : {z, z + thickness})
+        for (const auto& p : outline) m.vertices.push_back({float(p.first), float(p.second), float(level)});
+    const std::uint32_t top = std::uint32_t(n);
+    for (const mesh::Triangle& t : cap) {
+        m.triangles.push_back({t[0], t[2], t[1]});                   // bottom faces down
+        m.triangles.push_back({t[0] + top, t[1] + top, t[2] + top}); // top faces up
+    }
+    for (std::uint32_t i = 0; i < n; ++i) {
+        const std::uint32_t j = std::uint32_t((i + 1) % n);
+        m.triangles.push_back({i, j, j + top});
+        m.triangles.push_back({i, j + top, i + top});
+    }
+    return m;
+}
+
+} // namespace pwb::fit
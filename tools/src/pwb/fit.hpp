@@ -0,0 +1,65 @@
+#pragma once
+
+#include "pwb/bvh.hpp"
+#include "pwb/eagle_board.hpp"
+#include "pwb/mesh.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace pwb::fit {
+
+using stl::Vec3;
+
+constexpr float kFar = 1e30f;
+
+struct Options {
+    float max_distance = 1.0f; // clearances are measured up to here (model units, mm)
+    float contact = 0.05f;     // closer than this counts as touching
+    int bins = 10;             // histogram bins over [0, max_distance)
+    unsigned threads = 0;      // 0 = all cores
+};
+
+// A connected patch of the moving part's surface touching the fixed part.
+struct Contact {
+    std::size_t triangles = 0;
+    double area = 0;
+    bvh::Aabb box;
+    float min_distance = 0;
+};
+
+struct Report {
+    float min_distance = kFar;  // between the surfaces; kFar beyond max_distance
+    Vec3 closest_moving, closest_fixed;
+    std::size_t intersecting_pairs = 0; // triangle pairs cutting through each other
+    std::size_t vertices_inside = 0;    // of either part buried in the other
+    float max_depth = 0;                // deepest such vertex below the other surface
+    double area = 0;                    // moving part surface
+    std::vector<double> histogram;      // moving surface area per clearance bin
+    std::vector<Contact> contacts;      // largest first
+    std::size_t pairs_tested = 0;       // triangle-triangle distance evaluations
+    double seconds = 0;
+
+    bool interpenetrates() const { return intersecting_pairs > 0 || vertices_inside > 0; }
+};
+
+// Clearance of `moving` against `fixed`: both get a triangle BVH and the two
+// trees are walked together, each moving subtree on its own thread, pruning
+// node pairs farther apart than the worst clearance still open in the moving
+// node. Triangle pairs get the exact distance; crossing pairs count as
+// interpenetration, as do vertices found inside the other part by ray parity.
+Report check(const mesh::Mesh& fixed, const mesh::Mesh& moving, const Options& options = {});
+
+// How far `moving` can travel along the unit vector `dir` before it touches
+// `fixed`, found by casting rays from the vertices and triangle centres of
+// each part towards the other. kFar if it never does.
+float seat_distance(const mesh::Mesh& fixed, const mesh::Mesh& moving, const Vec3& dir);
+
+mesh::Mesh translated(const mesh::Mesh& m, const Vec3& offset);
+
+// The board outline (dimension layer, arcs flattened to `tolerance`) as a
+// closed prism from z to z + thickness. Drill holes are left solid, which
+// can only make the report pessimistic.
+mesh::Mesh board_solid(const eagle::Board& board, double thickness = 1.6, double z = 0, double tolerance = 0.05);
+
+} // namespace pwb::fit
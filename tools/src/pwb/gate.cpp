@@ -0,0 +1,168 @@
+#include "pwb/gate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pwb::gate {
+
+namespace {
+
+using sdf::cylinder;
+
+constexpr float kSqrtHalf = 0.70710678f;
+
+// No farther than the distance to anything inside the box: features far
+// from a point are skipped when they cannot change the result.
+float outside(const Vec3& q, const Vec3& lo, const Vec3& hi) {
+    const float dx = std::max({lo.x - q.x, q.x - hi.x, 0.0f}), dy = std::max({lo.y - q.y, q.y - hi.y, 0.0f}),
+                dz = std::max({lo.z - q.z, q.z - hi.z, 0.0f});
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Everything the field needs, worked out once.
+struct Model {
+    Params p;
+    Half half = Half::Whole;
+    std::vector<sdf::Vec2> outline;
+    float x_gap = 0;    // inner face of the +x arm
+    float y_tip = 0, y_back = 0;
+    float y_sensor = 0;
+    float x_flange = 0; // start of the flange groove, from the gap face inwards
+    float x_boss = 0;   // far end of the sensor bosses
+    float y_nut = 0;
+    float r_boss = 0;   // sensor bosses
+    Vec3 sensor_lo[2], sensor_hi[2], nut_lo, nut_hi; // around each group of features
+
+    explicit Model(const Params& params, Half h) : p(params), half(h) {
+        const float w = 0.5f * p.gap + p.arm_width;
+        const float length = p.arm_length + p.bridge;
+        x_gap = 0.5f * p.gap;
+        y_tip = -0.5f * length, y_back = 0.5f * length;
+        const float y_bridge = y_tip + p.arm_length;
+        outline = {{-w, y_tip}, {-x_gap, y_tip}, {-x_gap, y_bridge}, {x_gap, y_bridge}, {x_gap, y_tip}, {w, y_tip},
+                   {w, y_back - p.chamfer}, {w - p.chamfer, y_back}, {-w + p.chamfer, y_back}, {-w, y_back - p.chamfer}};
+        y_sensor = y_tip + p.sensor_from_tip;
+        x_flange = x_gap + p.lens_recess + p.lens_length;
+        x_boss = x_flange + p.flange_width + 0.5f * p.wall; // half a wall behind the flange
+        y_nut = y_back - 0.5f * p.bridge;
+        r_boss = 0.5f * p.flange + p.wall;
+        for (int side = 0; side < 2; ++side) {
+            const float a = x_gap - 1, b = x_boss + p.wall;
+            sensor_lo[side] = {side ? a : -b, y_sensor - r_boss, p.split - r_boss};
+            sensor_hi[side] = {side ? b : -a, y_sensor + r_boss, p.split + r_boss};
+        }
+        const float r_nut = 0.5f * std::max(p.nut_barrel + 2 * p.wall, p.nut_pcd + p.nut_boss);
+        nut_lo = {-r_nut, y_nut - r_nut, -1}, nut_hi = {r_nut, y_nut + r_nut, p.height + 1};
+    }
+
+    float operator()(const Vec3& q) const {
+        const float h = p.height, k = p.fillet;
+        const float d2 = sdf::polygon(q.x, q.y, outline);
+        float f = sdf::extrude(d2, q.z, 0, h);
+        const float near[2] = {outside(q, sensor_lo[0], sensor_hi[0]), outside(q, sensor_lo[1], sensor_hi[1])};
+        const float near_nut = outside(q, nut_lo, nut_hi);
+        if (p.wall > 0) {
+            f = sdf::subtract(f, sdf::extrude(d2 + p.wall, q.z, p.wall, h - p.wall));
+            // Bosses start `fillet` inside the outer faces so the blend never
+            // swells them.
+            for (int side = 0; side < 2; ++side) {
+                const float s = side ? 1.0f : -1.0f;
+                if (near[side] < f + k)
+                    f = sdf::blend(f, cylinder(q, 0, {0, y_sensor, p.split}, r_boss, s * (x_gap + k), s * x_boss), k);
+            }
+            if (near_nut < f + k) {
+                f = sdf::blend(f, cylinder(q, 2, {0, y_nut, 0}, 0.5f * p.nut_barrel + p.wall, k, h - k), k);
+                for (int i = 0; i < 4; ++i) f = sdf::blend(f, cylinder(q, 2, screw(i), 0.5f * p.nut_boss, k, h - k), k);
+            }
+        }
+        // The LED on -x, the phototransistor on +x: bore from the gap face,
+        // groove for the flange, and the leads out of the back of the boss.
+        for (int side = 0; side < 2; ++side) {
+            if (near[side] >= -f) continue;
+            const float s = side ? 1.0f : -1.0f;
+            const float bore = 0.5f * (side ? p.sensor_bore : p.led_bore);
+            const Vec3 axis{0, y_sensor, p.split};
+            f = sdf::subtract(f, cylinder(q, 0, axis, bore, s * (x_gap - 1), s * (x_boss + 0.5f * p.wall)));
+            f = sdf::subtract(f, cylinder(q, 0, axis, 0.5f * p.flange, s * x_flange, s * (x_flange + p.flange_width)));
+        }
+        if (near_nut < -f) {
+            f = sdf::subtract(f, cylinder(q, 2, {0, y_nut, 0}, 0.5f * p.nut_barrel, -1, h + 1));
+            for (int i = 0; i < 4; ++i)
+                f = sdf::subtract(f, cylinder(q, 2, screw(i), 0.5f * p.nut_screw, h - p.nut_screw_depth, h + 1));
+        }
+        f = sdf::subtract(f, cylinder(q, 1, {p.cable_x, 0, p.split}, 0.5f * p.cable, y_back - 1.5f * p.wall - 1, y_back + 1));
+
+        if (half == Half::Bottom) f = sdf::intersect(f, q.z - p.split);
+        if (half == Half::Top) f = sdf::intersect(f, p.split - q.z);
+        return f;
+    }
+
+    // Flange screws at 45 degrees to the axes, clear of the barrel's bore.
+    Vec3 screw(int i) const {
+        const float r = 0.5f * p.nut_pcd * kSqrtHalf;
+        return {(i & 1 ? r : -r), y_nut + (i & 2 ? r : -r), 0};
+    }
+};
+
+void require(bool ok, const char* what) {
+    if (!ok) throw std::runtime_error(std::string("photogate: ") + what);
+}
+
+} // namespace
+
+void validate(const Params& p) {
+    for (float v : {p.gap, p.arm_length, p.arm_width, p.bridge, p.height, p.split, p.led_bore, p.sensor_bore, p.lens,
+                    p.sensor_from_tip, p.lens_length, p.flange, p.flange_width, p.nut_barrel, p.nut_flange, p.nut_pcd,
+                    p.nut_screw, p.nut_screw_depth, p.nut_boss, p.cable})
+        require(v > 0, "sizes must be positive");
+    require(p.wall >= 0 && p.chamfer >= 0 && p.lens_recess >= 0 && p.fillet >= 0, "wall, chamfer, recess and fillet must not be negative");
+    require(p.fillet <= p.wall, "fillet larger than the wall");
+    require(p.chamfer < p.bridge && p.chamfer < p.arm_width, "chamfer wider than the bridge or the arms");
+    require(p.split > p.wall && p.split < p.height - p.wall, "split plane outside the inside of the shell");
+    require(p.lens <= p.led_bore && p.lens <= p.sensor_bore, "lens wider than its bore");
+    require(p.flange > p.led_bore && p.flange > p.sensor_bore, "flange groove no wider than the bores");
+
+    const Model m(p, Half::Whole);
+    const float w = 0.5f * p.gap + p.arm_width;
+    require(m.x_boss + 1.5f * p.wall <= w, "LED and flange longer than the arm is wide");
+    require(m.y_sensor - m.r_boss >= m.y_tip + p.wall && m.y_sensor + m.r_boss <= m.y_tip + p.arm_length,
+            "sensor boss does not fit along the arm");
+    require(p.split - m.r_boss >= p.wall && p.split + m.r_boss <= p.height - p.wall, "sensor boss taller than the arm");
+    require(p.nut_flange <= p.bridge && 0.5f * p.nut_flange <= w - p.chamfer, "nut flange hangs over the bridge");
+    require(p.nut_pcd > p.nut_barrel + p.nut_screw && p.nut_pcd + p.nut_screw < p.nut_flange,
+            "flange screw circle does not fit between barrel and flange rim");
+    require(p.nut_screw < p.nut_boss, "flange screw wider than its boss");
+    require(0.5f * p.cable <= std::min(p.split, p.height - p.split) - p.wall &&
+                std::abs(p.cable_x) + 0.5f * p.cable <= w - p.chamfer,
+            "cable exit does not fit in the back wall");
+}
+
+sdf::Field field(const Params& params, Half half) {
+    validate(params);
+    return Model(params, half);
+}
+
+void bounds(const Params& p, Half half, Vec3& lo, Vec3& hi) {
+    const float w = 0.5f * p.gap + p.arm_width, l = 0.5f * (p.arm_length + p.bridge);
+    lo = {-w, -l, half == Half::Top ? p.split : 0};
+    hi = {w, l, half == Half::Bottom ? p.split : p.height};
+}
+
+mesh::Mesh build(const Params& params, Half half, const sdf::Options& options, sdf::Stats* stats) {
+    Vec3 lo, hi;
+    bounds(params, half, lo, hi);
+    return sdf::polygonise(field(params, half), lo, hi, options, stats);
+}
+
+beam::Beam beam(const Params& p) {
+    const float x = 0.5f * p.gap + p.lens_recess, y = -0.5f * (p.arm_length + p.bridge) + p.sensor_from_tip;
+    beam::Beam b;
+    b.emitter = {{-x, y, p.split}, 0.5f * p.lens};
+    b.receiver = {{x, y, p.split}, 0.5f * p.lens};
+    return b;
+}
+
+} // namespace pwb::gate
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "pwb/beam.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/sdf.hpp"
+
+namespace pwb::gate {
+
+using stl::Vec3;
+
+// The U-shaped Photogate housing, in mm, in the frame of STL/fdm: arms along
+// -Y with the gap centred on x = 0, bottom on z = 0. The defaults rebuild the
+// current Photogate_Top/Bottom: 97 x 90 x 18.8, a 63 mm gap, a 5 mm IR LED
+// and phototransistor in 5.5 mm bores on the split plane 12 mm from the arm
+// tips, and the T8 brass lead-screw nut of deprecated/brass_nut.f3d (10.2 mm
+// barrel, 22 mm flange, four screws on a 16 mm circle) in the bridge.
+struct Params {
+    float gap = 63;          // between the arms' inner faces
+    float arm_length = 62;   // from the arm tips to the bridge
+    float arm_width = 17;
+    float bridge = 28;       // depth of the bridge behind the gap
+    float chamfer = 15;      // 45-degree cut on the bridge's outer corners
+    float height = 18.8f;
+    float split = 9;         // z of the beam axis and of the cut between the halves
+    float wall = 1.6f;       // shell; 0 = solid
+    float fillet = 0.8f;     // where the bosses meet the shell (at most the wall)
+
+    float led_bore = 5.5f;
+    float sensor_bore = 5.5f; // phototransistor
+    float lens = 5;           // diameter of both lenses
+    float sensor_from_tip = 12;
+    float lens_recess = 3.3f; // lens tip behind the gap face
+    float lens_length = 8.6f; // lens tip to flange
+    float flange = 6.2f;      // groove holding the flange
+    float flange_width = 1.2f;
+
+    float nut_barrel = 10.5f; // hole for the nut's barrel, and the screw through it
+    float nut_flange = 22;
+    float nut_pcd = 16;       // circle through the flange screws
+    float nut_screw = 2.5f;   // pilot for M3 self-tapping screws
+    float nut_screw_depth = 8;
+    float nut_boss = 6;
+
+    float cable = 4;          // exit through the back wall on the split plane
+    float cable_x = 18;
+};
+
+// Throws std::runtime_error when the parts do not fit each other (bosses
+// wider than the arms, a nut flange hanging over the bridge, ...).
+void validate(const Params& params);
+
+enum class Half { Whole, Bottom, Top };
+
+// Signed distance to the housing, or to one half of it cut on the split plane.
+// Both halves are hollow trays open towards the split, joined by the bores.
+sdf::Field field(const Params& params, Half half = Half::Whole);
+
+// Box around the field, before polygonise() pads it.
+void bounds(const Params& params, Half half, Vec3& lo, Vec3& hi);
+
+// The half placed as assembled, like the files in STL/fdm.
+mesh::Mesh build(const Params& params, Half half, const sdf::Options& options = {}, sdf::Stats* stats = nullptr);
+
+// The two lenses facing each other across the gap, for beam::trace().
+beam::Beam beam(const Params& params);
+
+} // namespace pwb::gate
@@ -0,0 +1,683 @@
+#include "pwb/gerber.hpp"
+
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+namespace pwb::gerber {
+
+namespace {
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+Point rotate(double x, double y, double degrees) {
+    if (degrees == 0.0) return {std::llround(x), std::llround(y)};
+    double r = degrees * kPi / 180.0;
+    double c = std::cos(r), s = std::sin(r);
+    return {std::llround(x * c - y * s), std::llround(x * s + y * c)};
+}
+
+// Arithmetic used inside aperture macros: $n variables, + - x /, parentheses.
+class MacroExpression {
+public:
+    MacroExpression(std::string_view text, const std::vector<double>& vars, int line)
+        : s_(text), vars_(vars), line_(line) {}
+
+    double evaluate() {
+        double v = sum();
+        skip_spaces();
+        if (pos_ != s_.size()) fail();
+        return v;
+    }
+
+private:
+    void skip_spaces() {
+        while (pos_ < s_.size() && (s_[pos_] == ' ' || s_[pos_] == '\n' || s_[pos_] == '\r')) ++pos_;
+    }
+    char peek() {
+        skip_spaces();
+        return pos_ < s_.size() ? s_[pos_] : '\0';
+    }
+    [[noreturn]] void fail() { throw ParseError(line_, "bad macro expression '" + std::string(s_) + "'"); }
+
+    double sum() {
+        double v = product();
+        for (char c = peek(); c == '+' || c == '-'; c = peek()) {
+            ++pos_;
+            double rhs = product();
+            v = c == '+' ? v + rhs : v - rhs;
+        }
+        return v;
+    }
+    double product() {
+        double v = unary();
+        for (char c = peek(); c == 'x' || c == 'X' || c == '/'; c = peek()) {
+            ++pos_;
+            double rhs = unary();
+            v = c == '/' ? v / rhs : v * rhs;
+        }
+        return v;
+    }
+    double unary() {
+        char c = peek();
+        if (c == '-') return ++pos_, -unary();
+        if (c == '+') return ++pos_, unary();
+        if (c == '(') {
+            ++pos_;
+            double v = sum();
+            if (peek() != ')') fail();
+            ++pos_;
+            return v;
+        }
+        if (c == '$') {
+            ++pos_;
+            std::size_t start = pos_;
+            while (pos_ < s_.size() && is_digit(s_[pos_])) ++pos_;
+            if (start == pos_) fail();
+            std::size_t idx = std::strtoul(std::string(s_.substr(start, pos_ - start)).c_str(), nullptr, 10);
+            return idx >= 1 && idx <= vars_.size() ? vars_[idx - 1] : 0.0;
+        }
+        std::size_t start = pos_;
+        while (pos_ < s_.size() && (is_digit(s_[pos_]) || s_[pos_] == '.')) ++pos_;
+        if (start == pos_) fail();
+        return std::strtod(std::string(s_.substr(start, pos_ - start)).c_str(), nullptr);
+    }
+
+    std::string_view s_;
+    const std::vector<double>& vars_;
+    int line_;
+    std::size_t pos_ = 0;
+};
+
+std::vector<std::string_view> split(std::string_view s, char sep) {
+    std::vector<std::string_view> out;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i <= s.size(); ++i) {
+        if (i == s.size() || s[i] == sep) {
+            out.push_back(s.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    return out;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\r' || s.front() == '\n' || s.front() == '\t'))
+        s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\r' || s.back() == '\n' || s.back() == '\t'))
+        s.remove_suffix(1);
+    return s;
+}
+
+class Parser {
+public:
+    Parser(std::string_view text, const ParseOptions& options) : p_(text.data()), end_(p_ + text.size()), opt_(options) {
+        d_index_.assign(64, -1);
+        layer_.levels.push_back({});
+        // Rough pre-sizing: one primitive per ~20 bytes of EAGLE output.
+        layer_.strokes.reserve(text.size() / 24);
+    }
+    Parser(std::size_t size, const ParseOptions& options) : Parser(std::string_view(nullptr, 0), options) {
+        layer_.strokes.reserve(size / 24);
+    }
+
+    Layer run() {
+        statements(true);
+        return finish();
+    }
+
+    // Inflates the member a chunk at a time and parses what has arrived; a
+    // statement cut by the chunk boundary is carried over to the next one.
+    Layer run(ZipEntryStream& in, std::size_t chunk) {
+        std::string buf(chunk, '\0');
+        std::size_t carry = 0;
+        for (;;) {
+            if (buf.size() - carry < chunk / 2) buf.resize(carry + chunk); // a statement longer than a chunk
+            std::size_t n = in.read(buf.data() + carry, buf.size() - carry);
+            p_ = buf.data();
+            end_ = p_ + carry + n;
+            statements(n == 0);
+            if (n == 0 || finished_) break;
+            carry = std::size_t(end_ - p_);
+            std::memmove(buf.data(), p_, carry);
+        }
+        return finish();
+    }
+
+private:
+    // Parses the statements in [p_, end_). Unless `last`, one left unterminated
+    // at the end is not an error: p_ stays on its first byte.
+    void statements(bool last) {
+        while (p_ < end_) {
+            char c = *p_;
+            if (c == '\n') {
+                ++line_;
+                ++p_;
+            } else if (c == '\r' || c == ' ' || c == '\t') {
+                ++p_;
+            } else if (c == '%') {
+                const char* close = static_cast<const char*>(std::memchr(p_ + 1, '%', std::size_t(end_ - p_ - 1)));
+                if (!close) {
+                    if (last) fail("unterminated % block");
+                    return;
+                }
+                extended(close);
+            } else {
+                const char* star = static_cast<const char*>(std::memchr(p_, '*', std::size_t(end_ - p_)));
+                if (!star) {
+                    if (last) fail("unterminated data block");
+                    return;
+                }
+                const char* start = p_;
+                line_ += int(std::count(start, star, '\n'));
+                p_ = star;
+                block(start, p_);
+                ++p_;
+                if (finished_) break;
+            }
+        }
+    }
+
+    Layer finish() {
+        if (in_region_) close_contour();
+        Level& last = layer_.levels.back();
+        last.flash_end = static_cast<std::uint32_t>(layer_.flashes.size());
+        last.stroke_end = static_cast<std::uint32_t>(layer_.strokes.size());
+        last.region_end = static_cast<std::uint32_t>(layer_.regions.size());
+        return std::move(layer_);
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const { throw ParseError(line_, what); }
+
+    double unit_nm() const { return layer_.units == Units::Inches ? double(kNmPerInch) : double(kNmPerMm); }
+
+    void update_scales() {
+        x_scale_ = unit_nm() / std::pow(10.0, layer_.format.x_decimal);
+        y_scale_ = unit_nm() / std::pow(10.0, layer_.format.y_decimal);
+    }
+
+    // Reads one coordinate value in the %FS% format, starting at `s`.
+    Coord coordinate(const char*& s, const char* e, bool is_x) {
+        bool neg = false;
+        if (s < e && (*s == '-' || *s == '+')) neg = *s++ == '-';
+        std::int64_t v = 0;
+        int digits = 0;
+        while (s < e && is_digit(*s)) {
+            v = v * 10 + (*s++ - '0');
+            ++digits;
+        }
+        if (digits == 0) fail("missing coordinate digits");
+        const Format& f = layer_.format;
+        if (f.omit_trailing) {
+            int total = is_x ? f.x_integer + f.x_decimal : f.y_integer + f.y_decimal;
+            for (int i = digits; i < total; ++i) v *= 10;
+        }
+        double scaled = double(neg ? -v : v) * (is_x ? x_scale_ : y_scale_);
+        return static_cast<Coord>(std::llround(scaled));
+    }
+
+    static int integer(const char*& s, const char* e) {
+        int v = 0;
+        while (s < e && is_digit(*s)) v = v * 10 + (*s++ - '0');
+        return v;
+    }
+
+    void block(const char* s, const char* e) {
+        bool has_x = false, has_y = false, has_i = false, has_j = false;
+        Coord x = x_, y = y_, i = 0, j = 0;
+        int op = -1;
+        while (s < e) {
+            char c = *s++;
+            switch (c) {
+            case 'G': {
+                int g = integer(s, e);
+                switch (g) {
+                case 1: interp_ = 1; break;
+                case 2: interp_ = 2; break;
+                case 3: interp_ = 3; break;
+                case 4: return; // comment runs to end of block
+                case 36: begin_region(); break;
+                case 37: end_region(); break;
+                case 74: multi_quadrant_ = false; break;
+                case 75: multi_quadrant_ = true; break;
+                case 54: case 55: break;
+                case 70: set_units(Units::Inches); break;
+                case 71: set_units(Units::Millimetres); break;
+                case 90: layer_.format.incremental = false; break;
+                case 91: layer_.format.incremental = true; break;
+                default: fail("unsupported G" + std::to_string(g));
+                }
+                break;
+            }
+            case 'D': {
+                int d = integer(s, e);
+                if (d >= 10) select_aperture(d);
+                else if (d >= 1 && d <= 3) op = d;
+                else fail("bad D code");
+                break;
+            }
+            case 'M': {
+                int m = integer(s, e);
+                if (m == 2) finished_ = true;
+                break;
+            }
+            case 'X': x = coordinate(s, e, true); has_x = true; break;
+            case 'Y': y = coordinate(s, e, false); has_y = true; break;
+            case 'I': i = coordinate(s, e, true); has_i = true; break;
+            case 'J': j = coordinate(s, e, false); has_j = true; break;
+            case ' ': case '\r': case '\n': case '\t': break;
+            default: fail(std::string("unexpected '") + c + "'");
+            }
+        }
+        if (op < 0) {
+            if (!(has_x || has_y || has_i || has_j)) return;
+            op = last_op_; // deprecated modal operation
+        }
+        if (layer_.format.incremental) {
+            if (has_x) x += x_;
+            if (has_y) y += y_;
+        }
+        last_op_ = op;
+        operate(op, x, y, i, j);
+    }
+
+    void set_units(Units u) {
+        layer_.units = u;
+        layer_.has_units = true;
+        update_scales();
+    }
+
+    void select_aperture(int d) {
+        if (d >= static_cast<int>(d_index_.size()) || d_index_[d] < 0)
+            fail("aperture D" + std::to_string(d) + " used before definition");
+        aperture_ = d_index_[d];
+    }
+
+    void operate(int op, Coord x, Coord y, Coord i, Coord j) {
+        switch (op) {
+        case 1:
+            if (in_region_) {
+                if (contour_.empty()) contour_.push_back({x_, y_});
+                if (interp_ == 1) contour_.push_back({x, y});
+                else arc(x, y, i, j, [this](Coord, Coord, Coord bx, Coord by) { contour_.push_back({bx, by}); });
+            } else {
+                if (aperture_ < 0) fail("D01 with no aperture selected");
+                auto a = static_cast<std::uint32_t>(aperture_);
+                if (interp_ == 1) layer_.strokes.push_back({x_, y_, x, y, a});
+                else arc(x, y, i, j, [this, a](Coord ax, Coord ay, Coord bx, Coord by) {
+                         layer_.strokes.push_back({ax, ay, bx, by, a});
+                     });
+            }
+            break;
+        case 2:
+            if (in_region_) close_contour();
+            break;
+        case 3:
+            if (in_region_) fail("D03 inside a region statement");
+            if (aperture_ < 0) fail("D03 with no aperture selected");
+            layer_.flashes.push_back({x, y, static_cast<std::uint32_t>(aperture_)});
+            break;
+        }
+        x_ = x;
+        y_ = y;
+    }
+
+    template <typename Emit>
+    void arc(Coord x, Coord y, Coord i, Coord j, Emit emit) {
+        const bool ccw = interp_ == 3;
+        double cx, cy;
+        if (multi_quadrant_) {
+            cx = double(x_ + i);
+            cy = double(y_ + j);
+        } else {
+            // Single-quadrant mode: offsets are unsigned, pick the centre that
+            // gives the most consistent radius for a sweep of at most 90 degrees.
+            double best = 1e300;
+            cx = double(x_), cy = double(y_);
+            for (int sx = -1; sx <= 1; sx += 2) {
+                for (int sy = -1; sy <= 1; sy += 2) {
+                    double tx = double(x_) + sx * double(std::llabs(i));
+                    double ty = double(y_) + sy * double(std::llabs(j));
+                    double r0 = std::hypot(double(x_) - tx, double(y_) - ty);
+                    double r1 = std::hypot(double(x) - tx, double(y) - ty);
+                    double a0 = std::atan2(double(y_) - ty, double(x_) - tx);
+                    double a1 = std::atan2(double(y) - ty, double(x) - tx);
+                    double sweep = ccw ? a1 - a0 : a0 - a1;
+                    while (sweep < 0) sweep += 2 * kPi;
+                    if (sweep > kPi / 2 + 1e-6) continue;
+                    double err = std::fabs(r0 - r1);
+                    if (err < best) best = err, cx = tx, cy = ty;
+                }
+            }
+        }
+        double r = std::hypot(double(x_) - cx, double(y_) - cy);
+        double a0 = std::atan2(double(y_) - cy, double(x_) - cx);
+        double a1 = std::atan2(double(y) - cy, double(x) - cx);
+        double sweep = ccw ? a1 - a0 : a0 - a1;
+        while (sweep < 0) sweep += 2 * kPi;
+        if (multi_quadrant_ && sweep < 1e-9 && x == x_ && y == y_) sweep = 2 * kPi; // full circle
+        int n = std::max(1, int(std::ceil(sweep / (2 * kPi) * circle_segments(Coord(r), opt_.arc_tolerance))));
+        Coord px = x_, py = y_;
+        for (int k = 1; k <= n; ++k) {
+            Coord qx, qy;
+            if (k == n) {
+                qx = x, qy = y;
+            } else {
+                double a = a0 + (ccw ? 1 : -1) * sweep * k / n;
+                qx = std::llround(cx + r * std::cos(a));
+                qy = std::llround(cy + r * std::sin(a));
+            }
+            emit(px, py, qx, qy);
+            px = qx, py = qy;
+        }
+    }
+
+    void begin_region() {
+        in_region_ = true;
+        contour_.clear();
+    }
+
+    void end_region() {
+        close_contour();
+        in_region_ = false;
+    }
+
+    void close_contour() {
+        if (contour_.size() >= 3) {
+            layer_.regions.push_back({static_cast<std::uint32_t>(layer_.region_points.size()),
+                                      static_cast<std::uint32_t>(contour_.size())});
+            layer_.region_points.insert(layer_.region_points.end(), contour_.begin(), contour_.end());
+        }
+        contour_.clear();
+    }
+
+    void set_polarity(Polarity p) {
+        std::vector<Level>& levels = layer_.levels;
+        if (levels.back().polarity == p) return;
+        Level start = levels.size() > 1 ? levels[levels.size() - 2] : Level{};
+        Level& cur = levels.back();
+        cur.flash_end = static_cast<std::uint32_t>(layer_.flashes.size());
+        cur.stroke_end = static_cast<std::uint32_t>(layer_.strokes.size());
+        cur.region_end = static_cast<std::uint32_t>(layer_.regions.size());
+        bool empty = cur.flash_end == start.flash_end && cur.stroke_end == start.stroke_end &&
+                     cur.region_end == start.region_end;
+        if (empty) cur.polarity = p;
+        else levels.push_back({p});
+    }
+
+    // %...% parameter blocks; `close` is the terminating '%'.
+    void extended(const char* close) {
+        std::string_view body(p_ + 1, std::size_t(close - p_ - 1));
+        const int end_line = line_ + int(std::count(body.begin(), body.end(), '\n'));
+        p_ = close + 1;
+        body = trim(body);
+        if (body.substr(0, 2) == "AM") {
+            parameter(body); // a macro's primitives are themselves '*'-separated
+        } else {
+            // One block may hold several commands, e.g. %FSLAX34Y34*MOMM*%.
+            while (!body.empty()) {
+                std::size_t star = body.find('*');
+                std::string_view command = trim(body.substr(0, star));
+                if (!command.empty()) parameter(command);
+                body = star == std::string_view::npos ? std::string_view() : body.substr(star + 1);
+            }
+        }
+        line_ = end_line;
+    }
+
+    void parameter(std::string_view body) {
+        if (body.size() < 2) fail("empty parameter block");
+        std::string_view code = body.substr(0, 2);
+        std::string_view rest = body.substr(2);
+        if (!rest.empty() && rest.back() == '*') rest.remove_suffix(1);
+
+        if (code == "FS") format(rest);
+        else if (code == "MO") {
+            if (rest == "MM") set_units(Units::Millimetres);
+            else if (rest == "IN") set_units(Units::Inches);
+            else fail("bad %MO%");
+        } else if (code == "LP") {
+            if (rest == "D") set_polarity(Polarity::Dark);
+            else if (rest == "C") set_polarity(Polarity::Clear);
+            else fail("bad %LP%");
+        } else if (code == "IN") layer_.name = std::string(rest);
+        else if (code == "IP") layer_.image_negative = rest == "NEG";
+        else if (code == "AM") macros_[std::string(trim(rest.substr(0, rest.find('*'))))] = std::string(body.substr(2));
+        else if (code == "AD") define_aperture(rest);
+        else if (code == "SR" || code == "AB") {
+            if (code == "SR" && trim(rest).empty()) return; // closes a (trivial) step and repeat
+            fail("%" + std::string(code) + "% blocks are not supported");
+        }
+        // Attributes (TF/TA/TO/TD) and deprecated image parameters carry no geometry.
+    }
+
+    void format(std::string_view s) {
+        Format f;
+        std::size_t k = 0;
+        for (; k < s.size() && s[k] != 'X'; ++k) {
+            if (s[k] == 'T') f.omit_trailing = true;
+            else if (s[k] == 'I') f.incremental = true;
+        }
+        if (k + 6 > s.size() || s[k] != 'X' || s[k + 3] != 'Y') fail("bad %FS% '" + std::string(s) + "'");
+        f.x_integer = s[k + 1] - '0';
+        f.x_decimal = s[k + 2] - '0';
+        f.y_integer = s[k + 4] - '0';
+        f.y_decimal = s[k + 5] - '0';
+        layer_.format = f;
+        layer_.has_format = true;
+        update_scales();
+    }
+
+    Coord to_nm(double v) const { return std::llround(v * unit_nm()); }
+
+    void define_aperture(std::string_view s) {
+        if (s.empty() || s[0] != 'D') fail("bad %AD%");
+        const char* c = s.data() + 1;
+        const char* e = s.data() + s.size();
+        int d = integer(c, e);
+        if (d < 10) fail("aperture codes start at D10");
+        std::string_view spec(c, e - c);
+        std::size_t comma = spec.find(',');
+        std::string_view name = spec.substr(0, comma);
+
+        Aperture a;
+        a.d_code = d;
+        if (comma != std::string_view::npos) {
+            for (std::string_view v : split(spec.substr(comma + 1), 'X'))
+                a.params.push_back(std::strtod(std::string(trim(v)).c_str(), nullptr));
+        }
+        auto param = [&](std::size_t idx) { return idx < a.params.size() ? a.params[idx] : 0.0; };
+
+        if (name == "C") {
+            a.shape = ApertureShape::Circle;
+            a.width = a.height = to_nm(param(0));
+            a.hole = to_nm(param(1));
+        } else if (name == "R" || name == "O") {
+            a.shape = name == "R" ? ApertureShape::Rectangle : ApertureShape::Obround;
+            a.width = to_nm(param(0));
+            a.height = to_nm(param(1));
+            a.hole = to_nm(param(2));
+        } else if (name == "P") {
+            a.shape = ApertureShape::Polygon;
+            a.width = a.height = to_nm(param(0));
+            int n = std::max(3, int(param(1)));
+            ApertureContour contour;
+            for (int k = 0; k < n; ++k)
+                contour.points.push_back(rotate(a.width / 2.0, 0.0, param(2) + 360.0 * k / n));
+            a.contours.push_back(std::move(contour));
+            a.hole = to_nm(param(3));
+        } else {
+            auto it = macros_.find(std::string(name));
+            if (it == macros_.end()) fail("unknown aperture template '" + std::string(name) + "'");
+            a.shape = ApertureShape::Macro;
+            a.macro = it->first;
+            expand_macro(it->second, a);
+            Box b = a.extent();
+            a.width = b.width();
+            a.height = b.height();
+        }
+
+        if (d >= static_cast<int>(d_index_.size())) d_index_.resize(d + 1, -1);
+        d_index_[d] = static_cast<int>(layer_.apertures.size());
+        layer_.apertures.push_back(std::move(a));
+    }
+
+    void expand_macro(const std::string& body, Aperture& a) {
+        std::vector<double> vars = a.params;
+        std::vector<std::string_view> statements = split(body, '*');
+        for (std::size_t k = 1; k < statements.size(); ++k) {
+            std::string_view st = trim(statements[k]);
+            if (st.empty() || st[0] == '0') continue; // comment primitive
+            if (st[0] == '$') {
+                std::size_t eq = st.find('=');
+                if (eq == std::string_view::npos) fail("bad macro variable definition");
+                std::size_t idx = std::strtoul(std::string(st.substr(1, eq - 1)).c_str(), nullptr, 10);
+                if (idx == 0) fail("bad macro variable definition");
+                if (vars.size() < idx) vars.resize(idx, 0.0);
+                vars[idx - 1] = MacroExpression(st.substr(eq + 1), vars, line_).evaluate();
+                continue;
+            }
+            std::vector<double> m;
+            for (std::string_view f : split(st, ',')) m.push_back(MacroExpression(trim(f), vars, line_).evaluate());
+            macro_primitive(m, a);
+        }
+    }
+
+    void macro_primitive(const std::vector<double>& m, Aperture& a) {
+        auto at = [&](std::size_t idx) {
+            if (idx >= m.size()) fail("macro primitive has too few modifiers");
+            return m[idx];
+        };
+        const double u = unit_nm();
+        ApertureContour c;
+        c.polarity = at(1) == 0.0 ? Polarity::Clear : Polarity::Dark;
+        switch (int(at(0))) {
+        case 1: { // circle: exposure, diameter, x, y[, rotation]
+            double r = at(2) * u / 2, cx = at(3) * u, cy = at(4) * u;
+            double rot = m.size() > 5 ? m[5] : 0.0;
+            int n = circle_segments(Coord(r), opt_.arc_tolerance);
+            for (int k = 0; k < n; ++k) {
+                double t = 2 * kPi * k / n;
+                c.points.push_back(rotate(cx + r * std::cos(t), cy + r * std::sin(t), rot));
+            }
+            break;
+        }
+        case 4: { // outline: exposure, n, x0, y0, ..., xn, yn, rotation
+            int n = int(at(2));
+            double rot = at(3 + 2 * (n + 1));
+            for (int k = 0; k < n; ++k) c.points.push_back(rotate(at(3 + 2 * k) * u, at(4 + 2 * k) * u, rot));
+            break;
+        }
+        case 5: { // polygon: exposure, vertices, x, y, diameter, rotation
+            int n = int(at(2));
+            double cx = at(3) * u, cy = at(4) * u, r = at(5) * u / 2, rot = at(6);
+            if (n < 3) fail("macro polygon needs at least 3 vertices");
+            for (int k = 0; k < n; ++k) {
+                double t = 2 * kPi * k / n;
+                c.points.push_back(rotate(cx + r * std::cos(t), cy + r * std::sin(t), rot));
+            }
+            break;
+        }
+        case 20: { // vector line: exposure, width, xs, ys, xe, ye, rotation
+            double w = at(2) * u / 2, xs = at(3) * u, ys = at(4) * u, xe = at(5) * u, ye = at(6) * u, rot = at(7);
+            double len = std::hypot(xe - xs, ye - ys);
+            double nx = len > 0 ? -(ye - ys) / len * w : 0, ny = len > 0 ? (xe - xs) / len * w : w;
+            c.points = {rotate(xs + nx, ys + ny, rot), rotate(xs - nx, ys - ny, rot), rotate(xe - nx, ye - ny, rot),
+                        rotate(xe + nx, ye + ny, rot)};
+            break;
+        }
+        case 21: { // centre line: exposure, width, height, x, y, rotation
+            double hw = at(2) * u / 2, hh = at(3) * u / 2, cx = at(4) * u, cy = at(5) * u, rot = at(6);
+            c.points = {rotate(cx - hw, cy - hh, rot), rotate(cx + hw, cy - hh, rot), rotate(cx + hw, cy + hh, rot),
+                        rotate(cx - hw, cy + hh, rot)};
+            break;
+        }
+        default:
+            fail("unsupported macro primitive " + std::to_string(int(at(0))));
+        }
+        a.contours.push_back(std::move(c));
+    }
+
+    const char* p_;
+    const char* end_;
+    const ParseOptions& opt_;
+    int line_ = 1;
+    Layer layer_;
+    std::map<std::string, std::string> macros_;
+    std::vector<int> d_index_;
+    std::vector<Point> contour_;
+    double x_scale_ = 100.0, y_scale_ = 100.0;
+    Coord x_ = 0, y_ = 0;
+    int aperture_ = -1;
+    int interp_ = 1;
+    int last_op_ = 2;
+    bool multi_quadrant_ = false;
+    bool in_region_ = false;
+    bool finished_ = false;
+};
+
+} // namespace
+
+int circle_segments(Coord radius, Coord tolerance) {
+    if (radius <= tolerance || tolerance <= 0) return 8;
+    double half_angle = std::acos(1.0 - double(tolerance) / double(radius));
+    return std::clamp(int(std::ceil(kPi / half_angle)), 8, 4096);
+}
+
+Box Aperture::extent() const {
+    Box b;
+    switch (shape) {
+    case ApertureShape::Circle:
+        b.add(-width / 2, -width / 2);
+        b.add(width / 2, width / 2);
+        break;
+    case ApertureShape::Rectangle:
+    case ApertureShape::Obround:
+        b.add(-width / 2, -height / 2);
+        b.add(width / 2, height / 2);
+        break;
+    case ApertureShape::Polygon:
+    case ApertureShape::Macro:
+        for (const ApertureContour& c : contours) {
+            if (c.polarity != Polarity::Dark) continue;
+            for (const Point& p : c.points) b.add(p.x, p.y);
+        }
+        break;
+    }
+    return b;
+}
+
+Box Layer::bounds() const {
+    std::vector<Box> ext(apertures.size());
+    for (std::size_t k = 0; k < apertures.size(); ++k) ext[k] = apertures[k].extent();
+    Box b;
+    for (const Flash& f : flashes) {
+        const Box& e = ext[f.aperture];
+        if (e.empty()) continue;
+        b.add(f.x + e.min_x, f.y + e.min_y);
+        b.add(f.x + e.max_x, f.y + e.max_y);
+    }
+    for (const Stroke& s : strokes) {
+        const Box& e = ext[s.aperture];
+        if (e.empty()) continue;
+        b.add(std::min(s.x0, s.x1) + e.min_x, std::min(s.y0, s.y1) + e.min_y);
+        b.add(std::max(s.x0, s.x1) + e.max_x, std::max(s.y0, s.y1) + e.max_y);
+    }
+    for (const Point& p : region_points) b.add(p.x, p.y);
+    return b;
+}
+
+Layer parse(std::string_view text, const ParseOptions& options) { return Parser(text, options).run(); }
+
+Layer parse(const ZipArchive& archive, const ZipEntry& entry, const ParseOptions& options) {
+    ZipEntryStream in(archive, entry);
+    return Parser(static_cast<std::size_t>(entry.size), options).run(in, options.chunk);
+}
+
+} // namespace pwb::gerber
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pwb {
+class ZipArchive;
+struct ZipEntry;
+}
+
+namespace pwb::gerber {
+
+// All geometry is kept in integer nanometres so that later stages (booleans,
+// offsets, XOR checks) can work exactly on what the file said.
+using Coord = std::int64_t;
+constexpr Coord kNmPerMm = 1'000'000;
+constexpr Coord kNmPerInch = 25'400'000;
+
+struct Point {
+    Coord x = 0;
+    Coord y = 0;
+};
+
+inline bool operator==(const Point& a, const Point& b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(const Point& a, const Point& b) { return !(a == b); }
+
+struct Box {
+    Coord min_x = INT64_MAX, min_y = INT64_MAX;
+    Coord max_x = INT64_MIN, max_y = INT64_MIN;
+
+    bool empty() const { return min_x > max_x; }
+    Coord width() const { return empty() ? 0 : max_x - min_x; }
+    Coord height() const { return empty() ? 0 : max_y - min_y; }
+    void add(Coord x, Coord y) {
+        if (x < min_x) min_x = x;
+        if (x > max_x) max_x = x;
+        if (y < min_y) min_y = y;
+        if (y > max_y) max_y = y;
+    }
+    void add(const Box& b) {
+        if (b.empty()) return;
+        add(b.min_x, b.min_y);
+        add(b.max_x, b.max_y);
+    }
+};
+
+enum class Units : std::uint8_t { Millimetres, Inches };
+enum class Polarity : std::uint8_t { Dark, Clear };
+
+// %FS...% coordinate format. Defaults match EAGLE's %FSLAX34Y34%.
+struct Format {
+    int x_integer = 3, x_decimal = 4;
+    int y_integer = 3, y_decimal = 4;
+    bool omit_trailing = false;
+    bool incremental = false;
+};
+
+enum class ApertureShape : std::uint8_t { Circle, Rectangle, Obround, Polygon, Macro };
+
+// A contour produced by evaluating a polygon aperture or an aperture macro,
+// relative to the flash point.
+struct ApertureContour {
+    Polarity polarity = Polarity::Dark;
+    std::vector<Point> points;
+};
+
+struct Aperture {
+    int d_code = 0;
+    ApertureShape shape = ApertureShape::Circle;
+    std::string macro;              // macro name when shape == Macro
+    std::vector<double> params;     // AD modifiers as written, in file units
+    Coord width = 0;                // circle/polygon diameter, rectangle/obround x size
+    Coord height = 0;               // rectangle/obround y size; equals width for circles
+    Coord hole = 0;                 // optional round hole diameter
+    std::vector<ApertureContour> contours; // filled for Polygon and Macro shapes
+
+    // Bounding box of the flashed image relative to the flash point.
+    Box extent() const;
+};
+
+struct Flash {
+    Coord x, y;
+    std::uint32_t aperture;
+};
+
+// Linear draw with the aperture in force. Arcs are linearised at parse time.
+struct Stroke {
+    Coord x0, y0, x1, y1;
+    std::uint32_t aperture;
+};
+
+// One G36/G37 contour; its vertices are region_points[first, first + count).
+struct Region {
+    std::uint32_t first;
+    std::uint32_t count;
+};
+
+// Consecutive objects sharing one %LP% polarity. Order inside a level does
+// not affect the image, so primitives are stored grouped by kind and a level
+// only records where each array ends.
+struct Level {
+    Polarity polarity = Polarity::Dark;
+    std::uint32_t flash_end = 0;
+    std::uint32_t stroke_end = 0;
+    std::uint32_t region_end = 0;
+};
+
+struct Layer {
+    std::string name;               // %IN%
+    Units units = Units::Millimetres;
+    Format format;
+    bool has_units = false;
+    bool has_format = false;
+    bool image_negative = false;    // %IPNEG%
+
+    std::vector<Aperture> apertures; // primitives refer to apertures by index
+    std::vector<Flash> flashes;
+    std::vector<Stroke> strokes;
+    std::vector<Region> regions;
+    std::vector<Point> region_points;
+    std::vector<Level> levels;
+
+    std::size_t primitive_count() const { return flashes.size() + strokes.size() + regions.size(); }
+    Box bounds() const;
+};
+
+struct ParseOptions {
+    Coord arc_tolerance = 1000;     // maximum chord deviation when linearising arcs
+    std::size_t chunk = 64 * 1024;  // bytes inflated at a time when parsing straight from a zip member
+};
+
+class ParseError : public std::runtime_error {
+public:
+    ParseError(int line, const std::string& what)
+        : std::runtime_error("line " + std::to_string(line) + ": " + what), line_(line) {}
+    int line() const { return line_; }
+
+private:
+    int line_;
+};
+
+// Parses an RS-274X image held entirely in memory.
+Layer parse(std::string_view text, const ParseOptions& options = {});
+
+// Parses a zip member as it is inflated, `options.chunk` bytes at a time, so
+// the whole text is never held in memory.
+Layer parse(const ZipArchive& archive, const ZipEntry& entry, const ParseOptions& options = {});
+
+// Number of segments needed to keep a circle of the given radius within
+// `tolerance` of the true outline.
+int circle_segments(Coord radius, Coord tolerance);
+
+} // namespace pwb::gerber
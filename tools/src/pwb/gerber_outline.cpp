@@ -0,0 +1,191 @@
+#include "pwb/gerber_outline.hpp"
+
+#include "pwb/polygon_ops.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pwb::gerber {
+
+namespace {
+
+void append_circle(Coord cx, Coord cy, Coord radius, Coord tolerance, std::vector<Point>& out) {
+    int n = circle_segments(radius, tolerance);
+    for (int k = 0; k < n; ++k) {
+        double t = 2 * kPi * k / n;
+        out.push_back({cx + std::llround(radius * std::cos(t)), cy + std::llround(radius * std::sin(t))});
+    }
+}
+
+void append_obround(Coord w, Coord h, Coord tolerance, std::vector<Point>& out) {
+    if (w == h) return append_circle(0, 0, w / 2, tolerance, out);
+    bool horizontal = w > h;
+    Coord r = (horizontal ? h : w) / 2;
+    Coord d = (horizontal ? w : h) / 2 - r;
+    int n = circle_segments(r, tolerance) / 2;
+    for (int side = 0; side < 2; ++side) {
+        for (int k = 0; k <= n; ++k) {
+            double t = (horizontal ? -kPi / 2 : 0.0) + kPi * side + kPi * k / n;
+            Coord x = std::llround(r * std::cos(t)), y = std::llround(r * std::sin(t));
+            if (horizontal) out.push_back({x + (side == 0 ? d : -d), y});
+            else out.push_back({x, y + (side == 0 ? d : -d)});
+        }
+    }
+}
+
+void make_ccw(std::vector<Point>& pts, std::size_t first, bool ccw = true) {
+    if ((signed_area2(pts.data() + first, pts.size() - first) > 0) != ccw)
+        std::reverse(pts.begin() + static_cast<std::ptrdiff_t>(first), pts.end());
+}
+
+std::int64_t cross(const Point& o, const Point& a, const Point& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// Andrew's monotone chain; appends the CCW hull of `pts` to `out`.
+void append_hull(std::vector<Point>& pts, std::vector<Point>& out) {
+    std::sort(pts.begin(), pts.end(), [](const Point& a, const Point& b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+    std::size_t n = pts.size(), base = out.size(), k = base;
+    if (n < 3) {
+        out.insert(out.end(), pts.begin(), pts.end());
+        return;
+    }
+    out.resize(base + 2 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        while (k >= base + 2 && cross(out[k - 2], out[k - 1], pts[i]) <= 0) --k;
+        out[k++] = pts[i];
+    }
+    for (std::size_t i = n - 1, t = k + 1; i-- > 0;) {
+        while (k >= t && cross(out[k - 2], out[k - 1], pts[i]) <= 0) --k;
+        out[k++] = pts[i];
+    }
+    out.resize(k - 1);
+}
+
+// Moves the contour with the largest positive area to the front: strokes
+// sweep only that one.
+void outer_first(PolygonSet& set) {
+    if (set.size() < 2) return;
+    std::size_t best = 0;
+    double best_area = signed_area2(set.begin(0), set.count(0));
+    for (std::size_t k = 1; k < set.size(); ++k) {
+        const double area = signed_area2(set.begin(k), set.count(k));
+        if (area > best_area) best = k, best_area = area;
+    }
+    if (best == 0) return;
+    PolygonSet out;
+    out.points.assign(set.begin(best), set.begin(best) + set.count(best));
+    out.close();
+    for (std::size_t k = 0; k < set.size(); ++k) {
+        if (k == best) continue;
+        out.points.insert(out.points.end(), set.begin(k), set.begin(k) + set.count(k));
+        out.close();
+    }
+    set = std::move(out);
+}
+
+} // namespace
+
+double signed_area2(const Point* p, std::size_t n) {
+    double a = 0.0;
+    for (std::size_t i = 0, j = n - 1; i < n; j = i++)
+        a += double(p[j].x) * double(p[i].y) - double(p[i].x) * double(p[j].y);
+    return a;
+}
+
+PolygonSet aperture_outline(const Aperture& a, Coord tolerance) {
+    PolygonSet set;
+    switch (a.shape) {
+    case ApertureShape::Circle:
+        append_circle(0, 0, a.width / 2, tolerance, set.points);
+        set.close();
+        break;
+    case ApertureShape::Rectangle:
+        set.points = {{-a.width / 2, -a.height / 2}, {a.width / 2, -a.height / 2},
+                      {a.width / 2, a.height / 2}, {-a.width / 2, a.height / 2}};
+        set.close();
+        break;
+    case ApertureShape::Obround:
+        append_obround(a.width, a.height, tolerance, set.points);
+        set.close();
+        break;
+    case ApertureShape::Polygon:
+    case ApertureShape::Macro:
+        // Primitives in order: dark ones are added to what came before, clear
+        // ones cut out of it, so the result is a real set whatever overlaps.
+        for (const ApertureContour& c : a.contours) {
+            PolygonSet piece;
+            piece.points = c.points;
+            make_ccw(piece.points, 0);
+            piece.close();
+            const bool dark = c.polarity == Polarity::Dark;
+            if (a.contours.size() == 1 && dark) set = std::move(piece);
+            else if (dark || set.size()) set = poly::boolean(set, piece, dark ? poly::Op::Union : poly::Op::Difference);
+        }
+        break;
+    }
+    if (a.hole > 0 && set.size()) {
+        PolygonSet hole;
+        append_circle(0, 0, a.hole / 2, tolerance, hole.points);
+        hole.close();
+        set = poly::boolean(set, hole, poly::Op::Difference);
+    }
+    outer_first(set);
+    return set;
+}
+
+std::vector<PolygonSet> layer_outlines(const Layer& layer, Coord tolerance) {
+    std::vector<PolygonSet> shapes;
+    shapes.reserve(layer.apertures.size());
+    for (const Aperture& a : layer.apertures) shapes.push_back(aperture_outline(a, tolerance));
+
+    std::vector<PolygonSet> out(layer.levels.size());
+    std::vector<Point> scratch;
+    std::uint32_t flash_begin = 0, stroke_begin = 0, region_begin = 0;
+    for (std::size_t l = 0; l < layer.levels.size(); ++l) {
+        const Level& level = layer.levels[l];
+        PolygonSet& set = out[l];
+
+        for (std::uint32_t i = flash_begin; i < level.flash_end; ++i) {
+            const Flash& f = layer.flashes[i];
+            const PolygonSet& s = shapes[f.aperture];
+            for (std::size_t k = 0; k < s.size(); ++k) {
+                for (std::size_t v = 0; v < s.count(k); ++v) set.points.push_back({f.x + s.begin(k)[v].x, f.y + s.begin(k)[v].y});
+                set.close();
+            }
+        }
+
+        for (std::uint32_t i = stroke_begin; i < level.stroke_end; ++i) {
+            const Stroke& st = layer.strokes[i];
+            const PolygonSet& s = shapes[st.aperture];
+            if (s.size() == 0) continue;
+            // Only the first (outer) contour of the aperture is swept; holes in
+            // drawing apertures have no meaning for a stroke.
+            scratch.clear();
+            for (std::size_t v = 0; v < s.count(0); ++v) {
+                const Point& p = s.begin(0)[v];
+                scratch.push_back({st.x0 + p.x, st.y0 + p.y});
+                if (st.x0 != st.x1 || st.y0 != st.y1) scratch.push_back({st.x1 + p.x, st.y1 + p.y});
+            }
+            append_hull(scratch, set.points);
+            set.close();
+        }
+
+        for (std::uint32_t i = region_begin; i < level.region_end; ++i) {
+            const Region& r = layer.regions[i];
+            std::size_t first = set.points.size();
+            set.points.insert(set.points.end(), layer.region_points.begin() + r.first,
+                              layer.region_points.begin() + r.first + r.count);
+            make_ccw(set.points, first);
+            set.close();
+        }
+
+        flash_begin = level.flash_end;
+        stroke_begin = level.stroke_end;
+        region_begin = level.region_end;
+    }
+    return out;
+}
+
+} // namespace pwb::gerber
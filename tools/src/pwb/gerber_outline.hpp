@@ -0,0 +1,36 @@
+#pragma once
+
+#include "pwb/gerber.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace pwb::gerber {
+
+// Closed contours in flat storage: contour k is points[offsets[k], offsets[k + 1]).
+struct PolygonSet {
+    std::vector<Point> points;
+    std::vector<std::uint32_t> offsets{0};
+
+    std::size_t size() const { return offsets.size() - 1; }
+    const Point* begin(std::size_t k) const { return points.data() + offsets[k]; }
+    std::size_t count(std::size_t k) const { return offsets[k + 1] - offsets[k]; }
+    void close() { offsets.push_back(static_cast<std::uint32_t>(points.size())); }
+};
+
+// Outline of an aperture centred on the origin; curves are flattened to within
+// `tolerance`. Macro primitives are resolved in order and the hole cut out, so
+// the result is a plain region: counter-clockwise outers, clockwise holes, the
+// largest outer first.
+PolygonSet aperture_outline(const Aperture& aperture, Coord tolerance);
+
+// Every primitive of a layer as closed polygons, one set per %LP% level.
+// Dark primitives are counter-clockwise so a non-zero fill gives their union.
+// Strokes become the convex hull of the aperture at both ends, which is exact
+// for the convex apertures EAGLE emits.
+std::vector<PolygonSet> layer_outlines(const Layer& layer, Coord tolerance);
+
+// Twice the signed area, as a double to stay clear of overflow on big boards.
+double signed_area2(const Point* points, std::size_t count);
+
+} // namespace pwb::gerber
@@ -0,0 +1,149 @@
+#include "pwb/image.hpp"
+
+#include "pwb/mapped_file.hpp"
+#include "pwb/util.hpp"
+
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef PWB_HAVE_JPEG
+#include <csetjmp>
+#include <jpeglib.h>
+#endif
+
+namespace pwb::image {
+
+namespace {
+
+std::uint8_t luma(int r, int g, int b) { return std::uint8_t((r * 299 + g * 587 + b * 114 + 500) / 1000); }
+
+// Netpbm: P2/P3 ASCII, P5/P6 binary, maxval up to 255.
+Gray load_pnm(const std::string& path) {
+    MappedFile file(path);
+    std::string_view s = file.view();
+    std::size_t pos = 2;
+    auto next = [&]() {
+        for (;;) {
+            while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+            if (pos < s.size() && s[pos] == '#') {
+                while (pos < s.size() && s[pos] != '\n') ++pos;
+                continue;
+            }
+            break;
+        }
+        long v = 0;
+        std::size_t start = pos;
+        while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) v = v * 10 + (s[pos++] - '0');
+        if (start == pos) throw std::runtime_error(path + ": bad PNM header");
+        return v;
+    };
+    if (s.size() < 2 || s[0] != 'P' || (s[1] != '2' && s[1] != '3' && s[1] != '5' && s[1] != '6'))
+        throw std::runtime_error(path + ": not a PGM/PPM file");
+    const bool colour = s[1] == '3' || s[1] == '6', binary = s[1] == '5' || s[1] == '6';
+    Gray g;
+    g.width = int(next());
+    g.height = int(next());
+    long maxval = next();
+    if (g.width <= 0 || g.height <= 0 || maxval <= 0 || maxval > 255) throw std::runtime_error(path + ": unsupported PNM");
+    ++pos; // single whitespace before binary data
+    const std::size_t n = std::size_t(g.width) * std::size_t(g.height);
+    const std::size_t channels = colour ? 3 : 1;
+    if (binary && s.size() < pos + n * channels) throw std::runtime_error(path + ": truncated");
+    g.pixels.resize(n);
+    auto sample = [&](std::size_t k) { return int((binary ? static_cast<unsigned char>(s[pos + k]) : next()) * 255 / maxval); };
+    for (std::size_t i = 0; i < n; ++i) {
+        if (colour) {
+            int r = sample(3 * i), gr = sample(3 * i + 1), b = sample(3 * i + 2);
+            g.pixels[i] = luma(r, gr, b);
+        } else {
+            g.pixels[i] = std::uint8_t(sample(i));
+        }
+    }
+    return g;
+}
+
+#ifdef PWB_HAVE_JPEG
+struct JpegError {
+    jpeg_error_mgr mgr;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+Gray load_jpeg(const std::string& path) {
+    MappedFile file(path);
+    jpeg_decompress_struct cinfo;
+    JpegError err;
+    cinfo.err = jpeg_std_error(&err.mgr);
+    err.mgr.error_exit = [](j_common_ptr c) {
+        JpegError* e = reinterpret_cast<JpegError*>(c->err);
+        e->mgr.format_message(c, e->message);
+        std::longjmp(e->jump, 1);
+    };
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        throw std::runtime_error(path + ": " + err.message);
+    }
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(file.data()), static_cast<unsigned long>(file.size()));
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = JCS_GRAYSCALE;
+    jpeg_start_decompress(&cinfo);
+    Gray g;
+    g.width = int(cinfo.output_width);
+    g.height = int(cinfo.output_height);
+    g.pixels.resize(std::size_t(g.width) * std::size_t(g.height));
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = g.pixels.data() + std::size_t(cinfo.output_scanline) * std::size_t(g.width);
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return g;
+}
+#endif
+
+} // namespace
+
+bool has_jpeg() {
+#ifdef PWB_HAVE_JPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+Gray load(const std::string& path) {
+    if (ends_with(path, ".jpg") || ends_with(path, ".jpeg")) {
+#ifdef PWB_HAVE_JPEG
+        return load_jpeg(path);
+#else
+        throw std::runtime_error(path + ": built without libjpeg; convert to PGM first");
+#endif
+    }
+    return load_pnm(path);
+}
+
+int otsu_threshold(const Gray& image) {
+    std::array<double, 256> hist{};
+    for (std::uint8_t p : image.pixels) hist[p] += 1;
+    const double total = double(image.pixels.size());
+    double sum = 0;
+    for (int i = 0; i < 256; ++i) sum += i * hist[i];
+    double below = 0, below_sum = 0, best = -1;
+    int threshold = 128;
+    for (int t = 0; t < 256; ++t) {
+        below += hist[t];
+        if (below == 0) continue;
+        double above = total - below;
+        if (above == 0) break;
+        below_sum += t * hist[t];
+        double m0 = below_sum / below, m1 = (sum - below_sum) / above;
+        double between = below * above * (m0 - m1) * (m0 - m1);
+        if (between > best) best = between, threshold = t;
+    }
+    return threshold;
+}
+
+} // namespace pwb::image
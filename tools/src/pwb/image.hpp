@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pwb::image {
+
+// 8-bit greyscale image, row 0 at the top as stored in image files.
+struct Gray {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> pixels;
+
+    std::uint8_t at(int x, int y) const { return pixels[std::size_t(y) * std::size_t(width) + std::size_t(x)]; }
+};
+
+// Loads PGM/PPM (P2/P5/P3/P6) always, and JPEG when the library was built
+// with libjpeg. Colour is reduced to luma (Rec. 601).
+Gray load(const std::string& path);
+
+// True when load() accepts JPEG files.
+bool has_jpeg();
+
+// Otsu's threshold: the grey level that best splits the histogram in two.
+int otsu_threshold(const Gray& image);
+
+} // namespace pwb::image
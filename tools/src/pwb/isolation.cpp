@@ -0,0 +1,236 @@
+#include "pwb/isolation.hpp"
+
+#include "pwb/copper_area.hpp"
+#include "pwb/drill_path.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/polygon_ops.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <stdexcept>
+
+namespace pwb::mill {
+
+namespace {
+
+using gerber::Box;
+
+double mm(Coord v) { return double(v) / gerber::kNmPerMm; }
+
+double distance_mm(const Point& a, double x, double y) { return std::hypot(mm(a.x) - x, mm(a.y) - y); }
+
+double loop_length_mm(const std::vector<Point>& pts) {
+    double len = 0;
+    for (std::size_t i = 1; i < pts.size(); ++i) len += std::hypot(mm(pts[i].x - pts[i - 1].x), mm(pts[i].y - pts[i - 1].y));
+    return len;
+}
+
+// Cura-style number: up to three decimals, trailing zeros dropped.
+std::string num(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.3f", v);
+    std::string s = buf;
+    while (s.back() == '0') s.pop_back();
+    if (s.back() == '.') s.pop_back();
+    if (s == "-0") s = "0";
+    return s;
+}
+
+} // namespace
+
+Plan isolate(const PolygonSet& copper, const Options& options) {
+    if (options.tool_width <= 0 || options.passes < 1) throw std::invalid_argument("mill: bad tool width or pass count");
+    auto t0 = std::chrono::steady_clock::now();
+    Plan plan;
+    std::vector<copper::Island> nets = copper::islands(copper);
+    plan.nets = nets.size();
+    const std::size_t passes = std::size_t(options.passes);
+    const Coord step = std::max<Coord>(1, Coord(double(options.tool_width) * (1.0 - options.overlap)));
+
+    // Grow every net for every pass; this is where the time goes, so nets run in parallel.
+    std::vector<std::vector<PolygonSet>> grown(passes, std::vector<PolygonSet>(nets.size()));
+    parallel_for(
+        nets.size(),
+        [&](std::size_t i) {
+            for (std::size_t k = 0; k < passes; ++k)
+                grown[k][i] = poly::offset(nets[i].outline, options.tool_width / 2 + Coord(k) * step, options.tolerance);
+        },
+        options.threads);
+    std::vector<PolygonSet> merged(passes);
+    parallel_for(
+        passes,
+        [&](std::size_t k) {
+            PolygonSet all;
+            for (const PolygonSet& g : grown[k]) {
+                all.points.insert(all.points.end(), g.points.begin(), g.points.end());
+                for (std::size_t c = 1; c < g.offsets.size(); ++c)
+                    all.offsets.push_back(all.offsets.back() + (g.offsets[c] - g.offsets[c - 1]));
+            }
+            merged[k] = poly::merge(all);
+        },
+        options.threads);
+
+    // Nets whose first-pass growth runs into a neighbour are not isolated by this tool.
+    std::vector<copper::Island> first = copper::islands(merged[0]);
+    std::vector<std::vector<std::uint32_t>> members(first.size());
+    for (std::size_t i = 0; i < nets.size(); ++i) {
+        const Point& p = nets[i].outline.points.front();
+        for (std::size_t j = 0; j < first.size(); ++j) {
+            const Box& b = first[j].box;
+            if (p.x < b.min_x || p.x > b.max_x || p.y < b.min_y || p.y > b.max_y) continue;
+            if (first[j].contains(double(p.x), double(p.y))) {
+                members[j].push_back(std::uint32_t(i));
+                break;
+            }
+        }
+    }
+    for (std::vector<std::uint32_t>& m : members) {
+        if (m.size() < 2) continue;
+        plan.shorted += m.size();
+        plan.shorts.push_back(std::move(m));
+    }
+    plan.islands = std::move(nets);
+
+    std::vector<Loop> loops;
+    for (std::size_t k = 0; k < passes; ++k) {
+        for (std::size_t c = 0; c < merged[k].size(); ++c) {
+            Loop l;
+            l.pass = int(k);
+            l.points.assign(merged[k].begin(c), merged[k].begin(c) + merged[k].count(c));
+            // Offsets keep the grown copper on the left of travel, which with a clockwise
+            // spindle is conventional milling on the copper wall; climb runs the other way.
+            if (options.climb) std::reverse(l.points.begin(), l.points.end());
+            loops.push_back(std::move(l));
+        }
+    }
+    if (loops.empty()) return plan;
+
+    // Order loops as a drill route over their plunge points, then move each plunge
+    // point to the vertex closest to its neighbours in the route and plan again.
+    Box bounds;
+    for (const Point& p : copper.points) bounds.add(p.x, p.y);
+    drill::PlanOptions po;
+    po.home_x = mm(bounds.min_x), po.home_y = mm(bounds.min_y);
+    po.threads = 1;
+    std::vector<excellon::Hit> entry(loops.size());
+    std::vector<std::size_t> start(loops.size(), 0);
+    for (std::size_t i = 0; i < loops.size(); ++i) entry[i] = {mm(loops[i].points[0].x), mm(loops[i].points[0].y)};
+    std::vector<std::uint32_t> naive(loops.size());
+    std::iota(naive.begin(), naive.end(), 0u);
+    plan.naive_rapid_mm = drill::route_length(entry, naive, po.home_x, po.home_y);
+
+    std::vector<std::uint32_t> order;
+    double best = 1e300;
+    std::vector<std::uint32_t> best_order;
+    std::vector<std::size_t> best_start;
+    for (int round = 0; round < 3; ++round) {
+        order = drill::plan(entry, po);
+        for (std::size_t pos = 0; pos < order.size(); ++pos) {
+            const excellon::Hit prev = pos ? entry[order[pos - 1]] : excellon::Hit{po.home_x, po.home_y};
+            const excellon::Hit next = pos + 1 < order.size() ? entry[order[pos + 1]] : excellon::Hit{po.home_x, po.home_y};
+            const Loop& l = loops[order[pos]];
+            double cost = 1e300;
+            for (std::size_t v = 0; v < l.points.size(); ++v) {
+                double c = distance_mm(l.points[v], prev.x, prev.y) + distance_mm(l.points[v], next.x, next.y);
+                if (c < cost) cost = c, start[order[pos]] = v;
+            }
+            entry[order[pos]] = {mm(l.points[start[order[pos]]].x), mm(l.points[start[order[pos]]].y)};
+        }
+        double len = drill::route_length(entry, order, po.home_x, po.home_y);
+        if (len < best - 1e-9) best = len, best_order = order, best_start = start;
+        else break;
+    }
+    plan.rapid_mm = best;
+
+    plan.loops.reserve(loops.size());
+    for (std::uint32_t i : best_order) {
+        Loop& l = loops[i];
+        std::rotate(l.points.begin(), l.points.begin() + std::ptrdiff_t(best_start[i]), l.points.end());
+        l.points.push_back(l.points.front());
+        plan.cut_mm += loop_length_mm(l.points);
+        plan.loops.push_back(std::move(l));
+    }
+    plan.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return plan;
+}
+
+double estimate_seconds(const Plan& plan, const Machine& m) {
+    double plunges = double(plan.loops.size()) * (m.safe_z + m.cut_depth);
+    return 60.0 * (plan.cut_mm / m.feed + (plan.rapid_mm + plunges) / m.rapid_feed + plunges / m.plunge_feed);
+}
+
+std::string write_gcode(const Plan& plan, const Machine& m, const Box& board, bool mirror, const std::string& title) {
+    auto X = [&](Coord x) { return mirror ? mm(board.max_x - x) : mm(x - board.min_x); };
+    auto Y = [&](Coord y) { return mm(y - board.min_y); };
+    double min_x = 1e300, min_y = 1e300, max_x = -1e300, max_y = -1e300;
+    for (const Loop& l : plan.loops)
+        for (const Point& p : l.points) {
+            min_x = std::min(min_x, X(p.x)), max_x = std::max(max_x, X(p.x));
+            min_y = std::min(min_y, Y(p.y)), max_y = std::max(max_y, Y(p.y));
+        }
+    if (plan.loops.empty()) min_x = min_y = max_x = max_y = 0;
+
+    std::string out;
+    auto line = [&](const std::string& s) {
+        out += s;
+        out += '\n';
+    };
+    line(";FLAVOR:Marlin");
+    line(";TIME:" + std::to_string(long(std::lround(estimate_seconds(plan, m)))));
+    line(";MINX:" + num(min_x));
+    line(";MINY:" + num(min_y));
+    line(";MINZ:" + num(-m.cut_depth));
+    line(";MAXX:" + num(max_x));
+    line(";MAXY:" + num(max_y));
+    line(";MAXZ:" + num(m.safe_z));
+    line(";TITLE:" + title);
+    line(";Generated with pwb mill_isolation");
+    line("G90 ;absolute positioning");
+    line("G21 ;millimetres");
+    line("G92 X0 Y0 Z0 ;origin: board lower-left corner, tool touching the copper");
+    line("G0 F" + num(m.rapid_feed) + " Z" + num(m.safe_z));
+    if (m.spindle > 0) {
+        line("M3 S" + std::to_string(m.spindle) + " ;spindle on");
+        line("G4 S3 ;spin up");
+    }
+    line(";LAYER_COUNT:1");
+    line(";LAYER:0");
+
+    double feed = m.rapid_feed;
+    auto f = [&](double want) {
+        if (want == feed) return std::string();
+        feed = want;
+        return " F" + num(want);
+    };
+    int pass = -1;
+    for (const Loop& l : plan.loops) {
+        if (l.pass != pass) {
+            pass = l.pass;
+            line(";TYPE:ISOLATION-PASS-" + std::to_string(pass + 1));
+        }
+        // Mirroring reverses the winding; walk the loop backwards to keep the milling direction.
+        const std::size_t n = l.points.size();
+        auto at = [&](std::size_t i) -> const Point& { return l.points[mirror ? n - 1 - i : i]; };
+        line("G0" + f(m.rapid_feed) + " X" + num(X(at(0).x)) + " Y" + num(Y(at(0).y)));
+        line("G1" + f(m.plunge_feed) + " Z" + num(-m.cut_depth));
+        std::string last;
+        for (std::size_t i = 1; i < n; ++i) {
+            std::string xy = " X" + num(X(at(i).x)) + " Y" + num(Y(at(i).y));
+            if (xy == last) continue;
+            line("G1" + f(m.feed) + xy);
+            last = xy;
+        }
+        line("G0" + f(m.rapid_feed) + " Z" + num(m.safe_z));
+    }
+    line("G0 Z" + num(std::max(m.safe_z, 10.0)) + " ;raise");
+    if (m.spindle > 0) line("M5 ;spindle off");
+    line("G0 X0 Y0");
+    line("M84 ;disable steppers");
+    line(";End of Gcode");
+    return out;
+}
+
+} // namespace pwb::mill
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "pwb/copper_area.hpp"
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pwb::mill {
+
+using gerber::Coord;
+using gerber::Point;
+using gerber::PolygonSet;
+
+struct Options {
+    Coord tool_width = 200'000;   // cutting width of the V-bit at the cut depth
+    int passes = 2;               // concentric passes around every net
+    double overlap = 0.4;         // fraction of the tool width shared by neighbouring passes
+    Coord tolerance = 2000;       // arc flattening for offsets
+    bool climb = true;            // climb milling on the copper wall: with a clockwise (M3) spindle the
+                                  // copper stays on the right of travel, the G41 side
+    unsigned threads = 0;         // nets are offset concurrently; 0 = all cores
+};
+
+// One closed cut; the last point repeats the first.
+struct Loop {
+    int pass = 0;
+    std::vector<Point> points;
+};
+
+struct Plan {
+    std::vector<Loop> loops;      // in cutting order, each starting at its plunge point
+    std::size_t nets = 0;         // copper islands on the layer
+    std::vector<copper::Island> islands;            // the nets, in the order `shorts` refers to
+    std::vector<std::vector<std::uint32_t>> shorts; // groups of nets the first pass cannot separate
+    std::size_t shorted = 0;      // nets in those groups
+    double cut_mm = 0;
+    double rapid_mm = 0;          // travel between loops, from and back to the origin
+    double naive_rapid_mm = 0;    // same, loops in generation order
+    double seconds = 0;
+};
+
+// Isolation passes around every island of `copper` (a merged layer). Pass k
+// follows the boundary of the union of the nets grown by tool/2 + k * step;
+// growing happens per net in parallel and overlapping growths merge, so a
+// pass never cuts into another net. Loops are then ordered (and their plunge
+// points chosen) to keep rapids short, with the drill-route planner.
+Plan isolate(const PolygonSet& copper, const Options& options = {});
+
+struct Machine {
+    double cut_depth = 0.05;   // mm below the copper surface
+    double safe_z = 1.0;       // mm, for rapids
+    double feed = 200;         // mm/min while cutting
+    double plunge_feed = 60;   // mm/min into the copper
+    double rapid_feed = 3000;  // mm/min for G0
+    int spindle = 10000;       // RPM for M3; 0 leaves the spindle alone
+};
+
+// Marlin-flavoured G-code in the layout Cura writes (";FLAVOR:Marlin" header,
+// G0/G1 with F on change, ";TYPE:" markers). Coordinates are moved so the
+// lower-left corner of `board` is (0, 0); `mirror` flips x within `board`, for
+// the bottom side after turning the board over.
+std::string write_gcode(const Plan& plan, const Machine& machine, const gerber::Box& board, bool mirror,
+                        const std::string& title);
+
+// Cutting time estimate for `plan` on `machine`, seconds.
+double estimate_seconds(const Plan& plan, const Machine& machine);
+
+} // namespace pwb::mill
@@ -0,0 +1,215 @@
+#include "pwb/json.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace pwb::json {
+
+namespace {
+
+void append_utf8(std::string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += char(cp);
+    } else if (cp < 0x800) {
+        out += char(0xC0 | (cp >> 6));
+        out += char(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += char(0xE0 | (cp >> 12));
+        out += char(0x80 | ((cp >> 6) & 0x3F));
+        out += char(0x80 | (cp & 0x3F));
+    } else {
+        out += char(0xF0 | (cp >> 18));
+        out += char(0x80 | ((cp >> 12) & 0x3F));
+        out += char(0x80 | ((cp >> 6) & 0x3F));
+        out += char(0x80 | (cp & 0x3F));
+    }
+}
+
+bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+class Parser {
+public:
+    explicit Parser(std::string_view s) : s_(s) {}
+
+    Value document() {
+        Value v = value(0);
+        skip_spaces();
+        if (pos_ != s_.size()) fail("trailing characters");
+        return v;
+    }
+
+private:
+    static constexpr int kMaxDepth = 256;
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error("json: " + std::string(what) + " at offset " + std::to_string(pos_));
+    }
+
+    void skip_spaces() {
+        while (pos_ < s_.size() && is_space(s_[pos_])) ++pos_;
+    }
+
+    bool literal(std::string_view t) {
+        if (s_.compare(pos_, t.size(), t) != 0) return false;
+        pos_ += t.size();
+        return true;
+    }
+
+    void expect(char c) {
+        skip_spaces();
+        if (pos_ >= s_.size() || s_[pos_] != c) fail("unexpected character");
+        ++pos_;
+    }
+
+    Value value(int depth) {
+        if (depth > kMaxDepth) fail("nesting too deep");
+        skip_spaces();
+        if (pos_ >= s_.size()) fail("unexpected end of input");
+        Value v;
+        char c = s_[pos_];
+        if (c == '{') {
+            v.type = Type::Object;
+            ++pos_;
+            skip_spaces();
+            if (pos_ < s_.size() && s_[pos_] == '}') {
+                ++pos_;
+                return v;
+            }
+            for (;;) {
+                skip_spaces();
+                if (pos_ >= s_.size() || s_[pos_] != '"') fail("expected a key");
+                std::string key = string();
+                expect(':');
+                v.members.emplace_back(std::move(key), value(depth + 1));
+                skip_spaces();
+                if (pos_ < s_.size() && s_[pos_] == ',') {
+                    ++pos_;
+                    continue;
+                }
+                expect('}');
+                return v;
+            }
+        }
+        if (c == '[') {
+            v.type = Type::Array;
+            ++pos_;
+            skip_spaces();
+            if (pos_ < s_.size() && s_[pos_] == ']') {
+                ++pos_;
+                return v;
+            }
+            for (;;) {
+                v.items.push_back(value(depth + 1));
+                skip_spaces();
+                if (pos_ < s_.size() && s_[pos_] == ',') {
+                    ++pos_;
+                    continue;
+                }
+                expect(']');
+                return v;
+            }
+        }
+        if (c == '"') {
+            v.type = Type::String;
+            v.string = string();
+            return v;
+        }
+        if (literal("true")) v.type = Type::Bool, v.boolean = true;
+        else if (literal("false")) v.type = Type::Bool;
+        else if (literal("null")) v.type = Type::Null;
+        else if (c == '-' || (c >= '0' && c <= '9')) {
+            std::size_t start = pos_;
+            while (pos_ < s_.size() && ((s_[pos_] && std::strchr("+-.eE", s_[pos_])) || (s_[pos_] >= '0' && s_[pos_] <= '9'))) ++pos_;
+            std::string digits(s_.substr(start, pos_ - start));
+            char* end = nullptr;
+            v.type = Type::Number;
+            v.number = std::strtod(digits.c_str(), &end);
+            if (end != digits.c_str() + digits.size()) fail("bad number");
+        } else fail("unexpected character");
+        return v;
+    }
+
+    unsigned long hex4() {
+        if (pos_ + 4 > s_.size()) fail("bad \\u escape");
+        unsigned long cp = 0;
+        for (int k = 0; k < 4; ++k) {
+            char h = s_[pos_++];
+            cp <<= 4;
+            if (h >= '0' && h <= '9') cp |= unsigned(h - '0');
+            else if (h >= 'a' && h <= 'f') cp |= unsigned(h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') cp |= unsigned(h - 'A' + 10);
+            else fail("bad \\u escape");
+        }
+        return cp;
+    }
+
+    std::string string() {
+        ++pos_; // opening quote
+        std::string out;
+        for (;;) {
+            std::size_t stop = s_.find_first_of("\"\\", pos_);
+            if (stop == std::string_view::npos) fail("unterminated string");
+            out.append(s_.substr(pos_, stop - pos_));
+            pos_ = stop + 1;
+            if (s_[stop] == '"') return out;
+            if (pos_ >= s_.size()) fail("unterminated string");
+            char e = s_[pos_++];
+            switch (e) {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned long cp = hex4();
+                if (cp >= 0xDC00 && cp < 0xE000) fail("unpaired low surrogate");
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    if (!literal("\\u")) fail("unpaired high surrogate");
+                    unsigned long lo = hex4();
+                    if (lo < 0xDC00 || lo >= 0xE000) fail("high surrogate not followed by a low one");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default: out += e; break; // \" \\ \/
+            }
+        }
+    }
+
+    std::string_view s_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace
+
+const Value* Value::get(std::string_view key) const {
+    for (const auto& kv : members)
+        if (kv.first == key) return &kv.second;
+    return nullptr;
+}
+
+const Value* Value::path(std::string_view dotted) const {
+    const Value* v = this;
+    while (v && !dotted.empty()) {
+        std::size_t dot = dotted.find('.');
+        v = v->get(dotted.substr(0, dot));
+        dotted = dot == std::string_view::npos ? std::string_view() : dotted.substr(dot + 1);
+    }
+    return v;
+}
+
+double Value::number_at(std::string_view dotted, double fallback) const {
+    const Value* v = path(dotted);
+    return v && v->type == Type::Number ? v->number : fallback;
+}
+
+std::string Value::string_at(std::string_view dotted, std::string_view fallback) const {
+    const Value* v = path(dotted);
+    return v && v->type == Type::String ? v->string : std::string(fallback);
+}
+
+Value parse(std::string_view text) { return Parser(text).document(); }
+
+} // namespace pwb::json
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pwb::json {
+
+enum class Type { Null, Bool, Number, String, Array, Object };
+
+// Just enough JSON for Gerber job files and the like: a DOM with objects kept
+// in file order. Numbers are doubles; \u escapes are decoded to UTF-8.
+struct Value {
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Value> items;                            // Array
+    std::vector<std::pair<std::string, Value>> members;  // Object
+
+    bool is_object() const { return type == Type::Object; }
+    bool is_array() const { return type == Type::Array; }
+
+    const Value* get(std::string_view key) const;
+    // Dotted lookup through nested objects: "Overall.Size.X".
+    const Value* path(std::string_view dotted) const;
+    double number_at(std::string_view dotted, double fallback = 0.0) const;
+    std::string string_at(std::string_view dotted, std::string_view fallback = {}) const;
+};
+
+Value parse(std::string_view text);
+
+} // namespace pwb::json
@@ -0,0 +1,391 @@
+#include "pwb/lod.hpp"
+
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+namespace pwb::lod {
+
+namespace {
+
+// Symmetric 4x4 error quadric, upper triangle row by row:
+// xx xy xz xw / yy yz yw / zz zw / ww.
+struct Quadric {
+    double q[10] = {};
+
+    static Quadric plane(const D3& n, double d, double weight) {
+        Quadric r;
+        const double p[4] = {n.x, n.y, n.z, d};
+        int k = 0;
+        for (int i = 0; i < 4; ++i)
+            for (int j = i; j < 4; ++j) r.q[k++] = weight * p[i] * p[j];
+        return r;
+    }
+    Quadric& operator+=(const Quadric& o) {
+        for (int k = 0; k < 10; ++k) q[k] += o.q[k];
+        return *this;
+    }
+    double error(const D3& v) const {
+        return q[0] * v.x * v.x + 2 * q[1] * v.x * v.y + 2 * q[2] * v.x * v.z + 2 * q[3] * v.x + q[4] * v.y * v.y +
+               2 * q[5] * v.y * v.z + 2 * q[6] * v.y + q[7] * v.z * v.z + 2 * q[8] * v.z + q[9];
+    }
+    // Minimiser of error(), if the 3x3 part is well conditioned.
+    bool optimum(D3& v) const {
+        const double a = q[0], b = q[1], c = q[2], d = q[4], e = q[5], f = q[7];
+        const double det = a * (d * f - e * e) - b * (b * f - e * c) + c * (b * e - d * c);
+        const double scale = a + d + f;
+        if (!(std::abs(det) > 1e-9 * scale * scale * scale)) return false;
+        const double r0 = -q[3], r1 = -q[6], r2 = -q[8];
+        v.x = (r0 * (d * f - e * e) - b * (r1 * f - e * r2) + c * (r1 * e - d * r2)) / det;
+        v.y = (a * (r1 * f - e * r2) - r0 * (b * f - e * c) + c * (b * r2 - r1 * c)) / det;
+        v.z = (a * (d * r2 - r1 * e) - b * (b * r2 - r1 * c) + r0 * (b * e - d * c)) / det;
+        return true;
+    }
+};
+
+struct Candidate {
+    double cost;
+    std::uint32_t a, b;
+    std::uint32_t stamp_a, stamp_b;
+    float target[3];
+
+    bool operator>(const Candidate& o) const { return cost > o.cost; }
+};
+
+class Collapser {
+public:
+    Collapser(const mesh::Mesh& m, const Options& o) : options_(o) {
+        const std::size_t nv = m.vertices.size();
+        pos_.resize(nv);
+        for (std::size_t v = 0; v < nv; ++v) pos_[v] = {m.vertices[v].x, m.vertices[v].y, m.vertices[v].z};
+        tris_ = m.triangles;
+        tri_alive_.assign(tris_.size(), 1);
+        alive_triangles_ = tris_.size();
+        vertex_alive_.assign(nv, 1);
+        stamp_.assign(nv, 0);
+        quadric_.resize(nv);
+        seen_.assign(nv, 0);
+
+        // Faces around each vertex, CSR to start with; a collapse appends the
+        // survivor's merged list to the pool rather than growing it in place.
+        first_.assign(nv + 1, 0);
+        for (const mesh::Triangle& t : tris_)
+            for (std::uint32_t v : t) ++first_[v + 1];
+        for (std::size_t v = 0; v < nv; ++v) first_[v + 1] += first_[v];
+        count_.assign(nv, 0);
+        pool_.resize(3 * tris_.size());
+        for (std::uint32_t t = 0; t < tris_.size(); ++t)
+            for (std::uint32_t v : tris_[t]) pool_[first_[v] + count_[v]++] = t;
+        first_.pop_back();
+
+        // Undirected edges with the half-edge that produced them; an edge met
+        // once is open and gets a boundary plane.
+        std::vector<std::uint64_t> edges(3 * tris_.size());
+        std::vector<std::uint32_t> half(edges.size());
+        for (std::uint32_t t = 0; t < tris_.size(); ++t) {
+            const mesh::Triangle& tri = tris_[t];
+            const D3 n = normal(tri);
+            const double len = std::sqrt(dot(n, n));
+            if (len > 0) {
+                const D3 u{n.x / len, n.y / len, n.z / len};
+                const Quadric q = Quadric::plane(u, -dot(u, pos_[tri[0]]), 1.0);
+                for (std::uint32_t v : tri) quadric_[v] += q;
+            }
+            for (int k = 0; k < 3; ++k) {
+                const std::uint32_t a = tri[k], b = tri[(k + 1) % 3];
+                edges[3 * t + k] = std::uint64_t(std::min(a, b)) << 32 | std::max(a, b);
+                half[3 * t + k] = 3 * t + k;
+            }
+        }
+        mesh::radix_sort(edges, half);
+        std::vector<Candidate> heap;
+        heap.reserve(edges.size() / 2 + 16);
+        for (std::size_t i = 0; i < edges.size();) {
+            std::size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i]) ++j;
+            if (j - i == 1) hold_boundary(half[i]);
+            i = j;
+        }
+        for (std::size_t i = 0; i < edges.size(); ++i)
+            if (i == 0 || edges[i] != edges[i - 1])
+                heap.push_back(candidate(std::uint32_t(edges[i] >> 32), std::uint32_t(edges[i])));
+        heap_ = decltype(heap_)(std::greater<Candidate>(), std::move(heap));
+    }
+
+    mesh::Mesh run(Stats& stats) {
+        while (alive_triangles_ > options_.target_triangles && !heap_.empty()) {
+            const Candidate c = heap_.top();
+            heap_.pop();
+            if (!vertex_alive_[c.a] || !vertex_alive_[c.b] || stamp_[c.a] != c.stamp_a || stamp_[c.b] != c.stamp_b) {
+                ++stats.stale;
+                continue;
+            }
+            const double error = std::sqrt(std::max(0.0, c.cost));
+            if (options_.max_error > 0 && error > options_.max_error) break; // everything left costs more
+            const D3 target{c.target[0], c.target[1], c.target[2]};
+            if (!allowed(c.a, c.b, target)) {
+                ++stats.rejected;
+                continue;
+            }
+            collapse(c.a, c.b, target);
+            ++stats.collapses;
+            stats.error = std::max(stats.error, error);
+        }
+        return result();
+    }
+
+private:
+    D3 normal(const mesh::Triangle& t) const { return cross(sub(pos_[t[1]], pos_[t[0]]), sub(pos_[t[2]], pos_[t[0]])); }
+
+    const std::uint32_t* faces(std::uint32_t v) const { return pool_.data() + first_[v]; }
+
+    // A plane through the open half-edge, perpendicular to its face.
+    void hold_boundary(std::uint32_t half) {
+        const mesh::Triangle& tri = tris_[half / 3];
+        const std::uint32_t a = tri[half % 3], b = tri[(half + 1) % 3];
+        D3 n = cross(sub(pos_[b], pos_[a]), normal(tri));
+        const double len = std::sqrt(dot(n, n));
+        if (len == 0) return;
+        n = {n.x / len, n.y / len, n.z / len};
+        const Quadric q = Quadric::plane(n, -dot(n, pos_[a]), options_.boundary_weight);
+        quadric_[a] += q;
+        quadric_[b] += q;
+    }
+
+    Candidate candidate(std::uint32_t a, std::uint32_t b) const {
+        Quadric q = quadric_[a];
+        q += quadric_[b];
+        D3 v;
+        double cost;
+        if (q.optimum(v)) {
+            cost = q.error(v);
+        } else {
+            // Flat or straight neighbourhood: best of the ends and the midpoint.
+            const D3 mid{(pos_[a].x + pos_[b].x) / 2, (pos_[a].y + pos_[b].y) / 2, (pos_[a].z + pos_[b].z) / 2};
+            v = pos_[a], cost = q.error(v);
+            for (const D3& p : {pos_[b], mid})
+                if (const double e = q.error(p); e < cost) v = p, cost = e;
+        }
+        return {cost, a, b, stamp_[a], stamp_[b], {float(v.x), float(v.y), float(v.z)}};
+    }
+
+    // Link condition (the only vertices adjacent to both ends are the tips
+    // of the faces on the edge) and no face turned by more than the limit.
+    bool allowed(std::uint32_t a, std::uint32_t b, const D3& v) {
+        std::size_t shared_faces = 0, common = 0;
+        ++mark_;
+        for (const std::uint32_t* t = faces(a); t != faces(a) + count_[a]; ++t)
+            if (tri_alive_[*t])
+                for (std::uint32_t w : tris_[*t]) seen_[w] = mark_;
+        ++mark_;
+        for (const std::uint32_t* t = faces(b); t != faces(b) + count_[b]; ++t) {
+            if (!tri_alive_[*t]) continue;
+            const mesh::Triangle& tri = tris_[*t];
+            if (tri[0] == a || tri[1] == a || tri[2] == a) ++shared_faces;
+            for (std::uint32_t w : tri)
+                if (w != a && w != b && seen_[w] == mark_ - 1) seen_[w] = mark_, ++common;
+        }
+        if (shared_faces == 0 || common != shared_faces) return false;
+
+        for (std::uint32_t end : {a, b})
+            for (const std::uint32_t* t = faces(end); t != faces(end) + count_[end]; ++t) {
+                if (!tri_alive_[*t]) continue;
+                const mesh::Triangle& tri = tris_[*t];
+                if ((tri[0] == a || tri[1] == a || tri[2] == a) && (tri[0] == b || tri[1] == b || tri[2] == b))
+                    continue; // disappears
+                D3 p[3];
+                for (int k = 0; k < 3; ++k) p[k] = tri[k] == end ? v : pos_[tri[k]];
+                const D3 before = normal(tri);
+                const D3 after = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+                const double lb = dot(before, before), la = dot(after, after);
+                if (la <= 1e-24 * (lb + 1e-300)) return false;
+                if (dot(before, after) <= options_.min_normal_dot * std::sqrt(lb * la)) return false;
+            }
+        return true;
+    }
+
+    void collapse(std::uint32_t a, std::uint32_t b, const D3& v) {
+        if (pool_.size() + count_[a] + count_[b] > pool_.capacity()) compact();
+        const auto start = std::uint32_t(pool_.size());
+        for (std::uint32_t i = 0; i < count_[a]; ++i) {
+            const std::uint32_t t = pool_[first_[a] + i];
+            if (!tri_alive_[t]) continue;
+            const mesh::Triangle& tri = tris_[t];
+            if (tri[0] == b || tri[1] == b || tri[2] == b) {
+                tri_alive_[t] = 0;
+                --alive_triangles_;
+                continue;
+            }
+            pool_.push_back(t);
+        }
+        for (std::uint32_t i = 0; i < count_[b]; ++i) {
+            const std::uint32_t t = pool_[first_[b] + i];
+            if (!tri_alive_[t]) continue;
+            for (std::uint32_t& w : tris_[t])
+                if (w == b) w = a;
+            pool_.push_back(t);
+        }
+        first_[a] = start;
+        count_[a] = std::uint32_t(pool_.size()) - start;
+        count_[b] = 0;
+        vertex_alive_[b] = 0;
+        pos_[a] = v;
+        quadric_[a] += quadric_[b];
+        ++stamp_[a];
+
+        ++mark_;
+        for (const std::uint32_t* t = faces(a); t != faces(a) + count_[a]; ++t)
+            for (std::uint32_t w : tris_[*t])
+                if (w != a && seen_[w] != mark_) seen_[w] = mark_, heap_.push(candidate(a, w));
+    }
+
+    // Drops the lists abandoned by earlier collapses once the pool is full.
+    void compact() {
+        std::vector<std::uint32_t> pool;
+        pool.reserve(std::max<std::size_t>(pool_.capacity(), 64));
+        for (std::size_t v = 0; v < first_.size(); ++v) {
+            const auto start = std::uint32_t(pool.size());
+            for (std::uint32_t i = 0; i < count_[v]; ++i)
+                if (tri_alive_[pool_[first_[v] + i]]) pool.push_back(pool_[first_[v] + i]);
+            first_[v] = start;
+            count_[v] = std::uint32_t(pool.size()) - start;
+        }
+        if (pool.size() * 2 > pool.capacity()) pool.reserve(pool.size() * 2);
+        pool_.swap(pool);
+    }
+
+    mesh::Mesh result() const {
+        mesh::Mesh out;
+        std::vector<std::uint32_t> remap(pos_.size(), mesh::kNone);
+        for (std::size_t t = 0; t < tris_.size(); ++t) {
+            if (!tri_alive_[t]) continue;
+            mesh::Triangle tri = tris_[t];
+            for (std::uint32_t& w : tri) {
+                if (remap[w] == mesh::kNone) {
+                    remap[w] = std::uint32_t(out.vertices.size());
+                    out.vertices.push_back({float(pos_[w].x), float(pos_[w].y), float(pos_[w].z)});
+                }
+                w = remap[w];
+            }
+            out.triangles.push_back(tri);
+        }
+        return out;
+    }
+
+    const Options& options_;
+    std::vector<D3> pos_;
+    std::vector<mesh::Triangle> tris_;
+    std::vector<std::uint8_t> tri_alive_, vertex_alive_;
+    std::size_t alive_triangles_ = 0;
+    std::vector<std::uint32_t> stamp_;
+    std::vector<Quadric> quadric_;
+    std::vector<std::uint32_t> pool_, first_, count_; // faces around each vertex; dead ones are skipped
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap_;
+    std::vector<std::uint32_t> seen_;
+    std::uint32_t mark_ = 0;
+};
+
+template <typename T>
+void put(std::string& out, T v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+template <typename T>
+T get(std::string_view data, std::size_t& at) {
+    if (data.size() - at < sizeof(T) || at > data.size()) throw std::runtime_error("preview mesh: truncated");
+    T v;
+    std::memcpy(&v, data.data() + at, sizeof(T));
+    at += sizeof(T);
+    return v;
+}
+
+} // namespace
+
+mesh::Mesh decimate(const mesh::Mesh& mesh, const Options& options, Stats* stats) {
+    const auto t0 = std::chrono::steady_clock::now();
+    Stats local;
+    Collapser c(mesh, options);
+    mesh::Mesh out = c.run(local);
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (stats) *stats = local;
+    return out;
+}
+
+std::string pack(const mesh::Mesh& mesh, int bits) {
+    if (bits < 1 || bits > 16) throw std::runtime_error("preview mesh: position bits must be 1-16");
+    float lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+    for (std::size_t v = 0; v < mesh.vertices.size(); ++v) {
+        const float p[3] = {mesh.vertices[v].x, mesh.vertices[v].y, mesh.vertices[v].z};
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = v ? std::min(lo[k], p[k]) : p[k];
+            hi[k] = v ? std::max(hi[k], p[k]) : p[k];
+        }
+    }
+    const double levels = double((1u << bits) - 1);
+    float step[3];
+    for (int k = 0; k < 3; ++k) step[k] = hi[k] > lo[k] ? float((double(hi[k]) - lo[k]) / levels) : 1.0f;
+    const int index_bytes = mesh.vertices.size() <= 0x10000 ? 2 : 4;
+
+    std::string out;
+    out.reserve(40 + mesh.vertices.size() * 6 + mesh.triangles.size() * 3 * std::size_t(index_bytes));
+    out += "PWBQ";
+    put<std::uint8_t>(out, 1);
+    put<std::uint8_t>(out, std::uint8_t(bits));
+    put<std::uint8_t>(out, std::uint8_t(index_bytes));
+    put<std::uint8_t>(out, 0);
+    put<std::uint32_t>(out, std::uint32_t(mesh.vertices.size()));
+    put<std::uint32_t>(out, std::uint32_t(mesh.triangles.size()));
+    for (float v : lo) put(out, v);
+    for (float v : step) put(out, v);
+    for (const mesh::Vec3& p : mesh.vertices) {
+        const float c[3] = {p.x, p.y, p.z};
+        for (int k = 0; k < 3; ++k)
+            put(out, std::uint16_t(std::clamp(std::lround((double(c[k]) - lo[k]) / step[k]), 0l, long(levels))));
+    }
+    for (const mesh::Triangle& t : mesh.triangles)
+        for (std::uint32_t v : t) {
+            if (index_bytes == 2) put(out, std::uint16_t(v));
+            else put(out, v);
+        }
+    return out;
+}
+
+mesh::Mesh unpack(std::string_view data) {
+    if (data.size() < 40 || data.substr(0, 4) != "PWBQ") throw std::runtime_error("preview mesh: bad magic");
+    std::size_t at = 4;
+    const auto version = get<std::uint8_t>(data, at), bits = get<std::uint8_t>(data, at);
+    const auto index_bytes = get<std::uint8_t>(data, at);
+    at += 1;
+    if (version != 1 || bits < 1 || bits > 16 || (index_bytes != 2 && index_bytes != 4))
+        throw std::runtime_error("preview mesh: unsupported header");
+    const auto nv = get<std::uint32_t>(data, at), nt = get<std::uint32_t>(data, at);
+    float lo[3], step[3];
+    for (float& v : lo) v = get<float>(data, at);
+    for (float& v : step) v = get<float>(data, at);
+    if ((data.size() - at) != std::uint64_t(nv) * 6 + std::uint64_t(nt) * 3 * index_bytes)
+        throw std::runtime_error("preview mesh: size does not match the counts");
+    mesh::Mesh m;
+    m.vertices.resize(nv);
+    for (mesh::Vec3& p : m.vertices) {
+        float* c[3] = {&p.x, &p.y, &p.z};
+        for (int k = 0; k < 3; ++k) *c[k] = lo[k] + float(get<std::uint16_t>(data, at)) * step[k];
+    }
+    m.triangles.resize(nt);
+    for (mesh::Triangle& t : m.triangles)
+        for (std::uint32_t& v : t) {
+            v = index_bytes == 2 ? get<std::uint16_t>(data, at) : get<std::uint32_t>(data, at);
+            if (v >= nv) throw std::runtime_error("preview mesh: index out of range");
+        }
+    return m;
+}
+
+} // namespace pwb::lod
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "pwb/mesh.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace pwb::lod {
+
+struct Options {
+    std::size_t target_triangles = 0; // stop at or below this many
+    double max_error = 0;             // mm; stop before a collapse strays farther than this (0 = no bound)
+    double boundary_weight = 1000;    // open edges are held by perpendicular planes this heavy
+    double min_normal_dot = 0.2;      // reject collapses turning a face by more than acos(this)
+};
+
+struct Stats {
+    std::size_t collapses = 0;
+    std::size_t stale = 0;     // heap entries dropped because an endpoint had changed
+    std::size_t rejected = 0;  // collapses that would fold a face or break the link condition
+    double error = 0;          // largest error bound accepted, mm
+    double seconds = 0;
+};
+
+// Garland-Heckbert edge collapse. Every vertex carries the quadric of the
+// planes of its original faces; collapsing an edge moves the survivor to
+// the point minimising the summed quadric, whose square root bounds the
+// distance to those planes. Candidates sit in one binary heap and are never
+// updated in place: a collapse bumps the survivor's stamp and pushes fresh
+// entries for its edges, and entries with an old stamp are skipped when
+// popped. The input should be welded and manifold.
+mesh::Mesh decimate(const mesh::Mesh& mesh, const Options& options, Stats* stats = nullptr);
+
+// Compact preview format, little-endian:
+//   "PWBQ", u8 version (1), u8 position bits (1-16), u8 index bytes (2 or 4), u8 0,
+//   u32 vertices, u32 triangles, f32 origin[3], f32 step[3],
+//   u16 x, y, z per vertex (position = origin + q * step), then the indices.
+// Positions land within step / 2 of the input on every axis.
+std::string pack(const mesh::Mesh& mesh, int bits = 16);
+
+// Throws std::runtime_error on anything that is not a well-formed preview.
+mesh::Mesh unpack(std::string_view data);
+
+} // namespace pwb::lod
@@ -0,0 +1,268 @@
+#include "pwb/mass.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/simd.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+
+namespace pwb::mass {
+
+namespace {
+
+// Per-facet terms: the ten volume integrals of Eberly's "Polyhedral Mass
+// Properties" (1, x, y, z, x², y², z², xy, yz, zx, before their constant
+// factors), then |n| and the vector area n, where n = (p1 - p0) x (p2 - p0).
+constexpr int kTerms = 14;
+constexpr std::size_t kChunk = 1 << 16;
+
+struct Sums {
+    double s[kTerms] = {}, c[kTerms] = {}; // running sums and their lost low-order bits
+};
+
+// Neumaier's variant of Kahan summation: also exact when x outweighs s.
+inline void add(double& s, double& c, double x) {
+    const double t = s + x;
+    c += std::abs(s) >= std::abs(x) ? (s - t) + x : (x - t) + s;
+    s = t;
+}
+
+struct Sub {
+    double f1, f2, f3, g0, g1, g2;
+};
+
+inline Sub subexpressions(double w0, double w1, double w2) {
+    Sub r;
+    const double t0 = w0 + w1, t1 = w0 * w0, t2 = t1 + w1 * t0;
+    r.f1 = t0 + w2;
+    r.f2 = t2 + w2 * r.f1;
+    r.f3 = w0 * t1 + w1 * t2 + w2 * r.f2;
+    r.g0 = r.f2 + w0 * (r.f1 + w0);
+    r.g1 = r.f2 + w1 * (r.f1 + w1);
+    r.g2 = r.f2 + w2 * (r.f1 + w2);
+    return r;
+}
+
+void facet_scalar(const stl::TriangleView& tris, std::size_t i, const D3& o, Sums& sums) {
+    double p[3][3];
+    for (int k = 0; k < 3; ++k) {
+        const stl::Vec3 v = tris.vertex(i, k);
+        p[k][0] = double(v.x) - o.x, p[k][1] = double(v.y) - o.y, p[k][2] = double(v.z) - o.z;
+    }
+    const double a[3] = {p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+    const double b[3] = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+    const double d0 = a[1] * b[2] - a[2] * b[1], d1 = a[2] * b[0] - a[0] * b[2], d2 = a[0] * b[1] - a[1] * b[0];
+    const Sub x = subexpressions(p[0][0], p[1][0], p[2][0]);
+    const Sub y = subexpressions(p[0][1], p[1][1], p[2][1]);
+    const Sub z = subexpressions(p[0][2], p[1][2], p[2][2]);
+    const double t[kTerms] = {d0 * x.f1,
+                              d0 * x.f2,
+                              d1 * y.f2,
+                              d2 * z.f2,
+                              d0 * x.f3,
+                              d1 * y.f3,
+                              d2 * z.f3,
+                              d0 * (p[0][1] * x.g0 + p[1][1] * x.g1 + p[2][1] * x.g2),
+                              d1 * (p[0][2] * y.g0 + p[1][2] * y.g1 + p[2][2] * y.g2),
+                              d2 * (p[0][0] * z.g0 + p[1][0] * z.g1 + p[2][0] * z.g2),
+                              std::sqrt(d0 * d0 + d1 * d1 + d2 * d2),
+                              d0,
+                              d1,
+                              d2};
+    for (int k = 0; k < kTerms; ++k) add(sums.s[k], sums.c[k], t[k]);
+}
+
+void chunk_scalar(const stl::TriangleView& tris, const D3& o, Sums& sums) {
+    for (std::size_t i = 0; i < tris.size(); ++i) facet_scalar(tris, i, o, sums);
+}
+
+#if PWB_HAVE_AVX2
+struct SubV {
+    __m256d f1, f2, f3, g0, g1, g2;
+};
+
+PWB_TARGET_AVX2 inline SubV subexpressions_avx2(__m256d w0, __m256d w1, __m256d w2) {
+    SubV r;
+    const __m256d t0 = _mm256_add_pd(w0, w1), t1 = _mm256_mul_pd(w0, w0), t2 = _mm256_fmadd_pd(w1, t0, t1);
+    r.f1 = _mm256_add_pd(t0, w2);
+    r.f2 = _mm256_fmadd_pd(w2, r.f1, t2);
+    r.f3 = _mm256_fmadd_pd(w2, r.f2, _mm256_fmadd_pd(w1, t2, _mm256_mul_pd(w0, t1)));
+    r.g0 = _mm256_fmadd_pd(w0, _mm256_add_pd(r.f1, w0), r.f2);
+    r.g1 = _mm256_fmadd_pd(w1, _mm256_add_pd(r.f1, w1), r.f2);
+    r.g2 = _mm256_fmadd_pd(w2, _mm256_add_pd(r.f1, w2), r.f2);
+    return r;
+}
+
+// Four facets per step in double lanes; every lane keeps its own compensated
+// sums, folded together at the end of the chunk.
+PWB_TARGET_AVX2 void chunk_avx2(const stl::TriangleView& tris, const D3& o, Sums& sums) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d s[kTerms], c[kTerms];
+    for (int k = 0; k < kTerms; ++k) s[k] = c[k] = _mm256_setzero_pd();
+    const std::size_t n = tris.size() & ~std::size_t(3);
+    alignas(32) double p[9][4];
+    for (std::size_t i = 0; i < n; i += 4) {
+        // Records are 50 bytes apart: transpose four of them into lanes.
+        for (int l = 0; l < 4; ++l)
+            for (int k = 0; k < 3; ++k) {
+                const stl::Vec3 v = tris.vertex(i + l, k);
+                p[3 * k][l] = v.x, p[3 * k + 1][l] = v.y, p[3 * k + 2][l] = v.z;
+            }
+        __m256d q[9];
+        const __m256d origin[3] = {_mm256_set1_pd(o.x), _mm256_set1_pd(o.y), _mm256_set1_pd(o.z)};
+        for (int j = 0; j < 9; ++j) q[j] = _mm256_sub_pd(_mm256_load_pd(p[j]), origin[j % 3]);
+        const __m256d ax = _mm256_sub_pd(q[3], q[0]), ay = _mm256_sub_pd(q[4], q[1]), az = _mm256_sub_pd(q[5], q[2]);
+        const __m256d bx = _mm256_sub_pd(q[6], q[0]), by = _mm256_sub_pd(q[7], q[1]), bz = _mm256_sub_pd(q[8], q[2]);
+        const __m256d d0 = _mm256_fmsub_pd(ay, bz, _mm256_mul_pd(az, by));
+        const __m256d d1 = _mm256_fmsub_pd(az, bx, _mm256_mul_pd(ax, bz));
+        const __m256d d2 = _mm256_fmsub_pd(ax, by, _mm256_mul_pd(ay, bx));
+        const SubV x = subexpressions_avx2(q[0], q[3], q[6]);
+        const SubV y = subexpressions_avx2(q[1], q[4], q[7]);
+        const SubV z = subexpressions_avx2(q[2], q[5], q[8]);
+        const __m256d gx = _mm256_fmadd_pd(q[7], x.g2, _mm256_fmadd_pd(q[4], x.g1, _mm256_mul_pd(q[1], x.g0)));
+        const __m256d gy = _mm256_fmadd_pd(q[8], y.g2, _mm256_fmadd_pd(q[5], y.g1, _mm256_mul_pd(q[2], y.g0)));
+        const __m256d gz = _mm256_fmadd_pd(q[6], z.g2, _mm256_fmadd_pd(q[3], z.g1, _mm256_mul_pd(q[0], z.g0)));
+        const __m256d norm =
+            _mm256_sqrt_pd(_mm256_fmadd_pd(d2, d2, _mm256_fmadd_pd(d1, d1, _mm256_mul_pd(d0, d0))));
+        const __m256d t[kTerms] = {_mm256_mul_pd(d0, x.f1), _mm256_mul_pd(d0, x.f2), _mm256_mul_pd(d1, y.f2),
+                                   _mm256_mul_pd(d2, z.f2), _mm256_mul_pd(d0, x.f3), _mm256_mul_pd(d1, y.f3),
+                                   _mm256_mul_pd(d2, z.f3), _mm256_mul_pd(d0, gx),   _mm256_mul_pd(d1, gy),
+                                   _mm256_mul_pd(d2, gz),   norm,                    d0,
+                                   d1,                      d2};
+        for (int k = 0; k < kTerms; ++k) {
+            const __m256d sum = _mm256_add_pd(s[k], t[k]);
+            const __m256d big = _mm256_cmp_pd(_mm256_andnot_pd(sign, s[k]), _mm256_andnot_pd(sign, t[k]), _CMP_GE_OQ);
+            const __m256d lost = _mm256_blendv_pd(_mm256_add_pd(_mm256_sub_pd(t[k], sum), s[k]),
+                                                  _mm256_add_pd(_mm256_sub_pd(s[k], sum), t[k]), big);
+            c[k] = _mm256_add_pd(c[k], lost);
+            s[k] = sum;
+        }
+    }
+    alignas(32) double ls[4], lc[4];
+    for (int k = 0; k < kTerms; ++k) {
+        _mm256_store_pd(ls, s[k]);
+        _mm256_store_pd(lc, c[k]);
+        for (int l = 0; l < 4; ++l) add(sums.s[k], sums.c[k], ls[l]), sums.c[k] += lc[l];
+    }
+    for (std::size_t i = n; i < tris.size(); ++i) facet_scalar(tris, i, o, sums);
+}
+#endif
+
+using ChunkFn = void (*)(const stl::TriangleView&, const D3&, Sums&);
+
+ChunkFn pick_chunk(bool simd) {
+#if PWB_HAVE_AVX2
+    if (simd && cpu_has_avx2()) return chunk_avx2;
+#endif
+    (void)simd;
+    return chunk_scalar;
+}
+
+// Eigenvalues of a symmetric 3x3 matrix by the trigonometric closed form.
+void eigenvalues(const double m[3][3], double out[3]) {
+    const double p1 = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+    const double q = (m[0][0] + m[1][1] + m[2][2]) / 3;
+    if (p1 <= 1e-30 * q * q) {
+        out[0] = m[0][0], out[1] = m[1][1], out[2] = m[2][2];
+        std::sort(out, out + 3);
+        return;
+    }
+    const double p2 = (m[0][0] - q) * (m[0][0] - q) + (m[1][1] - q) * (m[1][1] - q) + (m[2][2] - q) * (m[2][2] - q) + 2 * p1;
+    const double p = std::sqrt(p2 / 6);
+    double b[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) b[i][j] = (m[i][j] - (i == j ? q : 0)) / p;
+    const double det = b[0][0] * (b[1][1] * b[2][2] - b[1][2] * b[2][1]) - b[0][1] * (b[1][0] * b[2][2] - b[1][2] * b[2][0]) +
+                       b[0][2] * (b[1][0] * b[2][1] - b[1][1] * b[2][0]);
+    const double r = std::clamp(det / 2, -1.0, 1.0), phi = std::acos(r) / 3;
+    out[2] = q + 2 * p * std::cos(phi);
+    out[0] = q + 2 * p * std::cos(phi + 2 * kPi / 3);
+    out[1] = 3 * q - out[0] - out[2];
+}
+
+} // namespace
+
+Properties compute(const stl::TriangleView& tris, const Options& options) {
+    const auto t0 = std::chrono::steady_clock::now();
+    Properties r;
+    r.triangles = tris.size();
+    if (tris.empty()) return r;
+    const stl::Bounds b = stl::bounds(tris, options.threads);
+    const D3 o{(double(b.min.x) + b.max.x) / 2, (double(b.min.y) + b.max.y) / 2, (double(b.min.z) + b.max.z) / 2};
+
+    const ChunkFn chunk = pick_chunk(options.simd);
+    const std::size_t chunks = (tris.size() + kChunk - 1) / kChunk;
+    std::vector<Sums> partial(chunks);
+    parallel_for(
+        chunks,
+        [&](std::size_t i) {
+            const std::size_t first = i * kChunk;
+            chunk(tris.slice(first, std::min(kChunk, tris.size() - first)), o, partial[i]);
+        },
+        options.threads);
+    Sums total;
+    for (const Sums& p : partial)
+        for (int k = 0; k < kTerms; ++k) add(total.s[k], total.c[k], p.s[k]), total.c[k] += p.c[k];
+    double in[kTerms];
+    for (int k = 0; k < kTerms; ++k) in[k] = total.s[k] + total.c[k];
+
+    const double factor[10] = {1.0 / 6, 1.0 / 24, 1.0 / 24, 1.0 / 24, 1.0 / 60, 1.0 / 60, 1.0 / 60, 1.0 / 120, 1.0 / 120, 1.0 / 120};
+    for (int k = 0; k < 10; ++k) in[k] *= factor[k];
+    if (in[0] < 0) {
+        r.inverted = true;
+        for (int k = 0; k < 10; ++k) in[k] = -in[k];
+    }
+    r.area = in[10] / 2;
+    r.gap = std::sqrt(in[11] * in[11] + in[12] * in[12] + in[13] * in[13]) / 2;
+    const double m = r.volume = in[0];
+    if (m > 0) {
+        const double cx = in[1] / m, cy = in[2] / m, cz = in[3] / m;
+        r.centroid = {cx + o.x, cy + o.y, cz + o.z};
+        double(&i)[3][3] = r.inertia;
+        i[0][0] = in[5] + in[6] - m * (cy * cy + cz * cz);
+        i[1][1] = in[4] + in[6] - m * (cz * cz + cx * cx);
+        i[2][2] = in[4] + in[5] - m * (cx * cx + cy * cy);
+        i[0][1] = i[1][0] = -(in[7] - m * cx * cy);
+        i[1][2] = i[2][1] = -(in[8] - m * cy * cz);
+        i[0][2] = i[2][0] = -(in[9] - m * cz * cx);
+        eigenvalues(r.inertia, r.principal);
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+const std::vector<Material>& materials() {
+    static const std::vector<Material> list = {
+        {"PETG", 1.27, 8.0, 120.0},
+        {"ABS", 1.04, 10.0, 100.0},
+    };
+    return list;
+}
+
+const Material* find_material(const std::string& name) {
+    for (const Material& m : materials()) {
+        if (m.name.size() != name.size()) continue;
+        bool same = true;
+        for (std::size_t i = 0; i < name.size() && same; ++i)
+            same = std::toupper(static_cast<unsigned char>(name[i])) == m.name[i];
+        if (same) return &m;
+    }
+    return nullptr;
+}
+
+Estimate estimate(const Properties& p, const Material& material, const PrintSettings& settings) {
+    Estimate e;
+    const double shell = std::min(p.volume, p.area * settings.shell);
+    e.extruded = shell + settings.infill * (p.volume - shell);
+    const double radius = settings.filament_diameter / 2;
+    e.length = e.extruded / (kPi * radius * radius) / 1000;
+    e.mass = e.extruded * material.density * 1e-3;
+    e.seconds = material.flow > 0 ? e.extruded / material.flow : 0;
+    e.cost = e.mass / 1000 * material.price_per_kg;
+    return e;
+}
+
+} // namespace pwb::mass
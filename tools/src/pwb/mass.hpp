@@ -0,0 +1,74 @@
+#pragma once
+
+#include "pwb/stl.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pwb::mass {
+
+struct D3 {
+    double x = 0, y = 0, z = 0;
+};
+
+struct Options {
+    unsigned threads = 0; // 0 = all cores
+    bool simd = true;     // AVX2 kernel when the CPU has it
+};
+
+// Solid properties of a closed triangle surface in model units (mm), from
+// the divergence theorem: every integral over the solid becomes a sum over
+// its facets, so the triangle soup is used as is, nothing welded.
+struct Properties {
+    std::size_t triangles = 0;
+    double volume = 0;  // mm³
+    double area = 0;    // mm²
+    D3 centroid;
+    double inertia[3][3] = {}; // about the centroid, per unit density (mm⁵)
+    double principal[3] = {};  // eigenvalues of `inertia`, ascending
+    double gap = 0;     // |sum of facet vector areas|: 0 for a closed surface
+    bool inverted = false;     // facets wound inwards; the sums were negated
+    double seconds = 0;
+
+    // A closed surface's vector areas cancel; allow for float round-off.
+    bool closed() const { return gap <= 1e-6 * area; }
+};
+
+// Sums run in double with compensated (Neumaier) accumulation per lane over
+// fixed-size chunks, and the chunks are combined in order, so the result does
+// not depend on the thread count. Coordinates are taken relative to the box
+// centre to keep the cubic terms small.
+Properties compute(const stl::TriangleView& triangles, const Options& options = {});
+
+struct Material {
+    std::string name;
+    double density = 0;      // g/cm³
+    double flow = 0;         // mm³/s the hot end sustains with this filament
+    double price_per_kg = 0;
+};
+
+// PETG and ABS, the two the top-level README recommends for the housings.
+const std::vector<Material>& materials();
+const Material* find_material(const std::string& name); // case-insensitive
+
+struct PrintSettings {
+    double filament_diameter = 1.75; // mm
+    double shell = 1.2;              // walls, floors and roofs: 3 x 0.4 mm lines
+    double infill = 0.2;             // of the volume inside the shell
+};
+
+struct Estimate {
+    double extruded = 0;  // mm³ of plastic
+    double length = 0;    // m of filament
+    double mass = 0;      // g
+    double seconds = 0;   // extrusion time at the material's flow rate
+    double cost = 0;      // in the currency of Material::price_per_kg
+};
+
+// The shell is taken as surface area x shell thickness (capped at the solid
+// volume); the rest is printed at the infill fraction. Travel and
+// acceleration are ignored, so the time is a lower bound.
+Estimate estimate(const Properties& p, const Material& material, const PrintSettings& settings = {});
+
+} // namespace pwb::mass
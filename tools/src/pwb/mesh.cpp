@@ -0,0 +1,304 @@
+#include "pwb/mesh.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+namespace pwb::mesh {
+
+namespace {
+
+constexpr int kCellBits = 21;
+constexpr std::uint64_t kCellMax = (std::uint64_t(1) << kCellBits) - 1;
+
+std::uint64_t pack(std::uint64_t x, std::uint64_t y, std::uint64_t z) {
+    return x << (2 * kCellBits) | y << kCellBits | z;
+}
+
+// Contiguous index ranges, one per worker, for the passes that must see
+// their elements in order (radix scatter) or that keep per-chunk results.
+struct Chunks {
+    std::size_t count = 1, size = 0, total = 0;
+    Chunks(std::size_t n, unsigned threads, std::size_t min_size = 1 << 16) : total(n) {
+        if (threads == 0) threads = default_threads();
+        count = std::max<std::size_t>(1, std::min<std::size_t>(threads, n / min_size));
+        size = (n + count - 1) / count;
+    }
+    std::size_t begin(std::size_t c) const { return std::min(total, c * size); }
+    std::size_t end(std::size_t c) const { return std::min(total, (c + 1) * size); }
+};
+
+// Open-addressing map from occupied grid cell to its run of welded corners.
+class CellHash {
+public:
+    explicit CellHash(std::size_t n) {
+        std::size_t cap = 16;
+        while (cap < 2 * n) cap <<= 1;
+        keys_.assign(cap, kEmpty);
+        values_.resize(cap);
+        mask_ = cap - 1;
+    }
+    void insert(std::uint64_t key, std::uint32_t value) {
+        std::size_t i = slot(key);
+        while (keys_[i] != kEmpty) i = (i + 1) & mask_;
+        keys_[i] = key, values_[i] = value;
+    }
+    std::uint32_t find(std::uint64_t key) const {
+        for (std::size_t i = slot(key);; i = (i + 1) & mask_) {
+            if (keys_[i] == key) return values_[i];
+            if (keys_[i] == kEmpty) return kNone;
+        }
+    }
+
+private:
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+    std::size_t slot(std::uint64_t key) const { return std::size_t((key * 0x9e3779b97f4a7c15ull) >> 20) & mask_; }
+
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint32_t> values_;
+    std::size_t mask_ = 0;
+};
+
+float distance2(const Vec3& a, const Vec3& b) {
+    const float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace
+
+void radix_sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, unsigned threads) {
+    const std::size_t n = keys.size();
+    if (n < 2) return;
+    const Chunks chunks(n, threads);
+    std::vector<std::uint64_t> differ(chunks.count, 0);
+    parallel_for(
+        chunks.count,
+        [&](std::size_t c) {
+            std::uint64_t d = 0;
+            for (std::size_t i = chunks.begin(c); i < chunks.end(c); ++i) d |= keys[i] ^ keys[0];
+            differ[c] = d;
+        },
+        threads);
+    const std::uint64_t varying = std::accumulate(differ.begin(), differ.end(), std::uint64_t(0), std::bit_or<>());
+
+    std::vector<std::uint64_t> keys2(n);
+    std::vector<std::uint32_t> values2(n);
+    std::vector<std::array<std::size_t, 256>> count(chunks.count);
+    for (int shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & 0xff) == 0) continue;
+        parallel_for(
+            chunks.count,
+            [&](std::size_t c) {
+                count[c].fill(0);
+                for (std::size_t i = chunks.begin(c); i < chunks.end(c); ++i) ++count[c][(keys[i] >> shift) & 0xff];
+            },
+            threads);
+        // Bucket b of chunk c starts after every smaller bucket and after bucket b of earlier chunks.
+        std::size_t at = 0;
+        for (int b = 0; b < 256; ++b)
+            for (std::size_t c = 0; c < chunks.count; ++c) {
+                const std::size_t k = count[c][std::size_t(b)];
+                count[c][std::size_t(b)] = at;
+                at += k;
+            }
+        parallel_for(
+            chunks.count,
+            [&](std::size_t c) {
+                std::array<std::size_t, 256>& pos = count[c];
+                for (std::size_t i = chunks.begin(c); i < chunks.end(c); ++i) {
+                    const std::size_t to = pos[(keys[i] >> shift) & 0xff]++;
+                    keys2[to] = keys[i];
+                    values2[to] = values[i];
+                }
+            },
+            threads);
+        keys.swap(keys2);
+        values.swap(values2);
+    }
+}
+
+Mesh weld(const stl::TriangleView& soup, const WeldOptions& options, WeldStats* stats, std::vector<std::uint32_t>* source) {
+    auto t0 = std::chrono::steady_clock::now();
+    const std::size_t corners = soup.size() * 3;
+    if (corners >= kNone) throw std::runtime_error("weld: too many triangles for 32-bit indices");
+    if (!(options.tolerance > 0)) throw std::invalid_argument("weld: tolerance must be positive");
+    Mesh mesh;
+    WeldStats st;
+    st.corners = corners;
+    if (source) source->clear();
+    if (corners == 0) {
+        if (stats) *stats = st;
+        return mesh;
+    }
+
+    const stl::Bounds box = stl::bounds(soup, options.threads);
+    const float tol = options.tolerance;
+    const double span = std::max({box.max.x - box.min.x, box.max.y - box.min.y, box.max.z - box.min.z});
+    if (span / tol >= double(kCellMax))
+        throw std::runtime_error("weld: tolerance too fine for a " + std::to_string(span) + " wide mesh");
+    const float inv = 1.0f / tol;
+
+    std::vector<std::uint64_t> keys(corners);
+    std::vector<std::uint32_t> order(corners);
+    const Chunks tri_chunks(soup.size(), options.threads);
+    parallel_for(
+        tri_chunks.count,
+        [&](std::size_t c) {
+            for (std::size_t t = tri_chunks.begin(c); t < tri_chunks.end(c); ++t) {
+                for (int k = 0; k < 3; ++k) {
+                    const Vec3 v = soup.vertex(t, k);
+                    const std::size_t i = 3 * t + std::size_t(k);
+                    keys[i] = pack(std::uint64_t((v.x - box.min.x) * inv), std::uint64_t((v.y - box.min.y) * inv),
+                                   std::uint64_t((v.z - box.min.z) * inv));
+                    order[i] = std::uint32_t(i);
+                }
+            }
+        },
+        options.threads);
+    radix_sort(keys, order, options.threads);
+
+    // Runs of equal cells are one vertex, placed at the run's first (lowest) corner.
+    std::vector<std::uint32_t> run_of(corners);
+    std::vector<std::uint64_t> run_cell;
+    std::vector<Vec3> run_pos;
+    for (std::size_t i = 0; i < corners; ++i) {
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            run_cell.push_back(keys[i]);
+            run_pos.push_back(soup.vertex(order[i] / 3, int(order[i] % 3)));
+        }
+        run_of[order[i]] = std::uint32_t(run_cell.size() - 1);
+    }
+    std::vector<std::uint64_t>().swap(keys);
+    std::vector<std::uint32_t>().swap(order);
+
+    // Points closer than the tolerance can straddle a cell boundary; look at
+    // the 13 neighbours that sort after each cell so every pair is seen once.
+    const std::size_t runs = run_cell.size();
+    CellHash hash(runs);
+    for (std::size_t r = 0; r < runs; ++r) hash.insert(run_cell[r], std::uint32_t(r));
+    static const int kForward[13][3] = {{0, 0, 1},  {0, 1, -1}, {0, 1, 0},  {0, 1, 1},  {1, -1, -1},
+                                        {1, -1, 0}, {1, -1, 1}, {1, 0, -1}, {1, 0, 0},  {1, 0, 1},
+                                        {1, 1, -1}, {1, 1, 0},  {1, 1, 1}};
+    const float tol2 = tol * tol;
+    const Chunks run_chunks(runs, options.threads);
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> pairs(run_chunks.count);
+    parallel_for(
+        run_chunks.count,
+        [&](std::size_t c) {
+            for (std::size_t r = run_chunks.begin(c); r < run_chunks.end(c); ++r) {
+                const std::uint64_t cell = run_cell[r];
+                const std::int64_t x = std::int64_t(cell >> (2 * kCellBits)), y = std::int64_t((cell >> kCellBits) & kCellMax),
+                                   z = std::int64_t(cell & kCellMax);
+                for (const int* d : kForward) {
+                    const std::int64_t nx = x + d[0], ny = y + d[1], nz = z + d[2];
+                    if (ny < 0 || nz < 0 || ny > std::int64_t(kCellMax) || nz > std::int64_t(kCellMax)) continue;
+                    const std::uint32_t s = hash.find(pack(std::uint64_t(nx), std::uint64_t(ny), std::uint64_t(nz)));
+                    if (s != kNone && distance2(run_pos[r], run_pos[s]) <= tol2) pairs[c].push_back({std::uint32_t(r), s});
+                }
+            }
+        },
+        options.threads);
+    UnionFind sets(runs);
+    for (const auto& list : pairs)
+        for (const auto& [a, b] : list) st.near_merges += sets.join(a, b);
+
+    // Drop collapsed triangles, then number vertices by first use.
+    std::vector<std::uint32_t> id(runs, kNone);
+    mesh.triangles.reserve(soup.size());
+    if (source) source->reserve(soup.size());
+    mesh.vertices.reserve(runs - st.near_merges);
+    for (std::size_t t = 0; t < soup.size(); ++t) {
+        std::uint32_t r[3];
+        for (int k = 0; k < 3; ++k) r[k] = sets.find(run_of[3 * t + std::size_t(k)]);
+        if (r[0] == r[1] || r[1] == r[2] || r[0] == r[2]) {
+            ++st.degenerate;
+            continue;
+        }
+        Triangle tri;
+        for (int k = 0; k < 3; ++k) {
+            if (id[r[k]] == kNone) {
+                id[r[k]] = std::uint32_t(mesh.vertices.size());
+                mesh.vertices.push_back(run_pos[r[k]]);
+            }
+            tri[std::size_t(k)] = id[r[k]];
+        }
+        mesh.triangles.push_back(tri);
+        if (source) source->push_back(std::uint32_t(t));
+    }
+    st.vertices = mesh.vertices.size();
+    st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (stats) *stats = st;
+    return mesh;
+}
+
+HalfEdges half_edges(const Mesh& mesh, unsigned threads) {
+    HalfEdges he;
+    const std::size_t n = mesh.triangles.size() * 3;
+    if (n >= kNone) throw std::runtime_error("half_edges: too many triangles for 32-bit indices");
+    he.twin.assign(n, kNone);
+    he.outgoing.assign(mesh.vertices.size(), kNone);
+    if (n == 0) return he;
+
+    auto origin = [&](std::uint32_t h) { return mesh.triangles[h / 3][h % 3]; };
+    auto target = [&](std::uint32_t h) { return mesh.triangles[h / 3][(h % 3 + 1) % 3]; };
+    std::vector<std::uint64_t> keys(n);
+    std::vector<std::uint32_t> order(n);
+    const Chunks chunks(n, threads);
+    parallel_for(
+        chunks.count,
+        [&](std::size_t c) {
+            for (std::size_t h = chunks.begin(c); h < chunks.end(c); ++h) {
+                const std::uint32_t a = origin(std::uint32_t(h)), b = target(std::uint32_t(h));
+                keys[h] = std::uint64_t(std::min(a, b)) << 32 | std::max(a, b);
+                order[h] = std::uint32_t(h);
+            }
+        },
+        threads);
+    radix_sort(keys, order, threads);
+
+    for (std::size_t i = 0; i < n;) {
+        std::size_t j = i + 1;
+        while (j < n && keys[j] == keys[i]) ++j;
+        ++he.edges;
+        if (j - i == 1) ++he.boundary;
+        else if (j - i > 2) ++he.nonmanifold;
+        else if (origin(order[i]) == origin(order[i + 1])) ++he.misoriented;
+        else he.twin[order[i]] = order[i + 1], he.twin[order[i + 1]] = order[i];
+        i = j;
+    }
+    // Prefer a half-edge without a twin, so walks around a boundary vertex can start at the rim.
+    for (std::uint32_t h = 0; h < n; ++h) {
+        std::uint32_t& out = he.outgoing[origin(h)];
+        if (out == kNone || (he.twin[h] == kNone && he.twin[out] != kNone)) out = h;
+    }
+    return he;
+}
+
+std::string stl_bytes(const Mesh& mesh, const std::string& header) {
+    std::string out(84 + 50 * mesh.triangles.size(), '\0');
+    std::memcpy(&out[0], header.data(), std::min<std::size_t>(header.size(), 80));
+    const std::uint32_t count = std::uint32_t(mesh.triangles.size());
+    for (int b = 0; b < 4; ++b) out[80 + b] = char(count >> 8 * b & 0xff); // little-endian
+    char* record = &out[84];
+    for (const Triangle& t : mesh.triangles) {
+        const Vec3 &a = mesh.vertices[t[0]], &b = mesh.vertices[t[1]], &c = mesh.vertices[t[2]];
+        const double ux = double(b.x) - a.x, uy = double(b.y) - a.y, uz = double(b.z) - a.z;
+        const double vx = double(c.x) - a.x, vy = double(c.y) - a.y, vz = double(c.z) - a.z;
+        double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        const double len = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (len > 0) nx /= len, ny /= len, nz /= len;
+        const Vec3 corners[4] = {{float(nx), float(ny), float(nz)}, a, b, c};
+        std::memcpy(record, corners, sizeof corners);
+        record += 50;
+    }
+    return out;
+}
+
+} // namespace pwb::mesh
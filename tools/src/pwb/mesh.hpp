@@ -0,0 +1,75 @@
+#pragma once
+
+#include "pwb/stl.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pwb::mesh {
+
+using stl::Vec3;
+using Triangle = std::array<std::uint32_t, 3>;
+
+constexpr std::uint32_t kNone = 0xffffffffu;
+
+// Indexed triangle mesh; vertices are numbered in order of first use, so
+// neighbouring triangles touch neighbouring memory.
+struct Mesh {
+    std::vector<Vec3> vertices;
+    std::vector<Triangle> triangles;
+
+    std::size_t bytes() const { return vertices.size() * sizeof(Vec3) + triangles.size() * sizeof(Triangle); }
+};
+
+struct WeldOptions {
+    float tolerance = 1e-4f;  // model units (mm for our parts)
+    unsigned threads = 0;     // 0 = all cores
+};
+
+struct WeldStats {
+    std::size_t corners = 0;     // 3 per input triangle
+    std::size_t vertices = 0;    // after welding
+    std::size_t degenerate = 0;  // triangles dropped because two corners welded together
+    std::size_t near_merges = 0; // vertices joined across grid cells, not exact duplicates
+    double seconds = 0;
+};
+
+// Welds the corners of a triangle soup. Corners are snapped to a grid of
+// `tolerance` cells and sorted by cell with a parallel LSD radix sort, which
+// joins everything in one cell; vertices in adjacent cells closer than the
+// tolerance are then joined through a hash of the occupied cells. `source`,
+// if given, receives the soup index of every kept triangle.
+Mesh weld(const stl::TriangleView& soup, const WeldOptions& options = {}, WeldStats* stats = nullptr,
+          std::vector<std::uint32_t>* source = nullptr);
+
+// Sorts `keys` and carries `values` along, stable, on up to `threads` threads.
+// Byte positions where every key agrees are skipped.
+void radix_sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, unsigned threads = 0);
+
+// Half-edge connectivity over Mesh::triangles: half-edge 3t+k runs from
+// corner k of triangle t to corner k+1, so next/prev/face are arithmetic and
+// only twins and one outgoing half-edge per vertex are stored.
+struct HalfEdges {
+    std::vector<std::uint32_t> twin;     // kNone on open, non-manifold and misoriented edges
+    std::vector<std::uint32_t> outgoing; // one half-edge leaving each vertex, kNone if unused
+    std::size_t edges = 0;               // undirected
+    std::size_t boundary = 0;            // edges with one face
+    std::size_t nonmanifold = 0;         // edges with more than two faces
+    std::size_t misoriented = 0;         // two-face edges walked the same way by both faces
+
+    static std::uint32_t next(std::uint32_t h) { return h % 3 == 2 ? h - 2 : h + 1; }
+    static std::uint32_t prev(std::uint32_t h) { return h % 3 == 0 ? h + 2 : h - 1; }
+    static std::uint32_t face(std::uint32_t h) { return h / 3; }
+    std::size_t bytes() const { return (twin.size() + outgoing.size()) * sizeof(std::uint32_t); }
+};
+
+HalfEdges half_edges(const Mesh& mesh, unsigned threads = 0);
+
+// Binary STL of the mesh: `header` (cut to 80 bytes), facet normals from the
+// winding, attribute words zero.
+std::string stl_bytes(const Mesh& mesh, const std::string& header);
+
+} // namespace pwb::mesh
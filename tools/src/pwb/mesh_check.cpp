@@ -0,0 +1,156 @@
+#include "pwb/mesh_check.hpp"
+
+#include "pwb/bvh.hpp"
+#include "pwb/parallel.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace pwb::mesh {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+// Segment pq passes strictly through the interior of triangle abc.
+bool segment_crosses(const D3& p, const D3& q, const D3& a, const D3& b, const D3& c) {
+    const double sp = orient(a, b, c, p), sq = orient(a, b, c, q);
+    if (!((sp > 0 && sq < 0) || (sp < 0 && sq > 0))) return false;
+    const double u = orient(p, q, a, b), v = orient(p, q, b, c), w = orient(p, q, c, a);
+    return (u > 0 && v > 0 && w > 0) || (u < 0 && v < 0 && w < 0);
+}
+
+// Every corner of `s` strictly on one side of the plane of `t`.
+bool one_side(const D3 t[3], const D3 s[3]) {
+    const D3 n = cross(sub(t[1], t[0]), sub(t[2], t[0]));
+    const double a = dot(n, sub(s[0], t[0])), b = dot(n, sub(s[1], t[0])), c = dot(n, sub(s[2], t[0]));
+    return (a > 0 && b > 0 && c > 0) || (a < 0 && b < 0 && c < 0);
+}
+
+// Two non-coplanar triangles intersect iff an edge of one crosses the other.
+bool triangles_cross(const D3 t[3], const D3 s[3]) {
+    if (one_side(t, s) || one_side(s, t)) return false;
+    for (int k = 0; k < 3; ++k) {
+        if (segment_crosses(t[k], t[(k + 1) % 3], s[0], s[1], s[2])) return true;
+        if (segment_crosses(s[k], s[(k + 1) % 3], t[0], t[1], t[2])) return true;
+    }
+    return false;
+}
+
+bool inside(const bvh::Aabb& inner, const bvh::Aabb& outer) {
+    return inner.min.x >= outer.min.x && inner.min.y >= outer.min.y && inner.min.z >= outer.min.z &&
+           inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+}
+
+} // namespace
+
+CheckReport check(const stl::TriangleView& soup, const CheckOptions& options) {
+    CheckReport r;
+    r.triangles = soup.size();
+    auto t0 = clock::now();
+    WeldStats ws;
+    std::vector<std::uint32_t> source;
+    WeldOptions wo;
+    wo.tolerance = options.weld_tolerance;
+    wo.threads = options.threads;
+    const Mesh m = weld(soup, wo, &ws, &source);
+    r.vertices = ws.vertices;
+    r.degenerate = ws.degenerate;
+    r.weld_seconds = std::chrono::duration<double>(clock::now() - t0).count();
+
+    // Topology: edge pairing, shells and their volumes.
+    t0 = clock::now();
+    const HalfEdges he = half_edges(m, options.threads);
+    r.edges = he.edges;
+    r.open_edges = he.boundary;
+    r.nonmanifold_edges = he.nonmanifold;
+    r.misoriented_edges = he.misoriented;
+
+    std::vector<D3> corner(3 * m.triangles.size());
+    for (std::size_t t = 0; t < m.triangles.size(); ++t)
+        for (int k = 0; k < 3; ++k) corner[3 * t + std::size_t(k)] = d3(m.vertices[m.triangles[t][std::size_t(k)]]);
+    for (std::size_t t = 0; t < m.triangles.size(); ++t) {
+        const D3* c = &corner[3 * t];
+        const D3 n = cross(sub(c[1], c[0]), sub(c[2], c[0]));
+        if (dot(n, n) == 0) ++r.degenerate;
+    }
+    for (std::size_t t = 0; t < soup.size(); ++t) {
+        const D3 a = d3(soup.vertex(t, 0)), b = d3(soup.vertex(t, 1)), c = d3(soup.vertex(t, 2));
+        if (dot(d3(soup.normal(t)), cross(sub(b, a), sub(c, a))) < 0) ++r.stored_normals_flipped;
+    }
+
+    UnionFind shells(m.vertices.size());
+    for (const Triangle& t : m.triangles) shells.join(t[0], t[1]), shells.join(t[1], t[2]);
+    std::vector<std::uint32_t> shell_of(m.vertices.size(), kNone);
+    std::vector<double> volume;
+    std::vector<bvh::Aabb> shell_box;
+    for (std::uint32_t v = 0; v < m.vertices.size(); ++v) {
+        const std::uint32_t root = shells.find(v);
+        if (shell_of[root] == kNone) shell_of[root] = std::uint32_t(volume.size()), volume.push_back(0), shell_box.emplace_back();
+        shell_of[v] = shell_of[root];
+        shell_box[shell_of[v]].grow(m.vertices[v]);
+    }
+    for (std::size_t t = 0; t < m.triangles.size(); ++t) {
+        const D3* c = &corner[3 * t];
+        volume[shell_of[m.triangles[t][0]]] += dot(c[0], cross(c[1], c[2])) / 6;
+    }
+    r.shells = volume.size();
+    for (std::size_t s = 0; s < volume.size(); ++s) {
+        r.volume += volume[s];
+        if (volume[s] >= 0) continue;
+        // A negative shell inside a bigger positive one is a cavity, which is fine.
+        bool cavity = false;
+        for (std::size_t o = 0; o < volume.size() && !cavity; ++o)
+            cavity = o != s && volume[o] > -volume[s] && inside(shell_box[s], shell_box[o]);
+        if (!cavity) ++r.inverted_shells;
+    }
+    if (r.shells == 1 && r.watertight())
+        r.genus = int((2 - (long(r.vertices) - long(r.edges) + long(m.triangles.size()))) / 2);
+    r.topology_seconds = std::chrono::duration<double>(clock::now() - t0).count();
+
+    if (!options.self_intersections || m.triangles.empty()) return r;
+
+    // Self-intersections: every triangle queries the BVH for later triangles
+    // whose boxes overlap its own; neighbours sharing a vertex are skipped.
+    // Queries run in leaf order so consecutive ones walk the same subtrees.
+    t0 = clock::now();
+    std::vector<bvh::Aabb> boxes(m.triangles.size());
+    for (std::size_t t = 0; t < m.triangles.size(); ++t)
+        for (int k = 0; k < 3; ++k) boxes[t].grow(m.vertices[m.triangles[t][std::size_t(k)]]);
+    const bvh::Tree tree = bvh::build(boxes);
+    const std::size_t block = 4096;
+    const std::size_t blocks = (m.triangles.size() + block - 1) / block;
+    std::vector<std::size_t> found(blocks, 0);
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> examples(blocks);
+    parallel_for(
+        blocks,
+        [&](std::size_t b) {
+            const std::size_t last = std::min(m.triangles.size(), (b + 1) * block);
+            for (std::size_t i = b * block; i < last; ++i) {
+                const std::uint32_t t = tree.items[i];
+                const Triangle& a = m.triangles[t];
+                tree.overlapping(boxes[t], [&](std::uint32_t u) {
+                    if (u <= t) return;
+                    const Triangle& c = m.triangles[u];
+                    for (std::uint32_t va : a)
+                        for (std::uint32_t vc : c)
+                            if (va == vc) return; // sharing a corner or an edge is not a crossing
+                    if (!triangles_cross(&corner[3 * t], &corner[3 * std::size_t(u)])) return;
+                    ++found[b];
+                    if (examples[b].size() < options.max_examples) examples[b].push_back({source[t], source[u]});
+                });
+            }
+        },
+        options.threads);
+    for (std::size_t b = 0; b < blocks; ++b) {
+        r.intersecting_pairs += found[b];
+        for (const auto& e : examples[b])
+            if (r.examples.size() < options.max_examples) r.examples.push_back(e);
+    }
+    r.intersect_seconds = std::chrono::duration<double>(clock::now() - t0).count();
+    return r;
+}
+
+} // namespace pwb::mesh
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "pwb/mesh.hpp"
+#include "pwb/stl.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace pwb::mesh {
+
+struct CheckOptions {
+    float weld_tolerance = 1e-4f;
+    bool self_intersections = true;
+    std::size_t max_examples = 8; // intersecting pairs kept for the report
+    unsigned threads = 0;
+};
+
+struct CheckReport {
+    std::size_t triangles = 0;   // in the file
+    std::size_t vertices = 0;    // after welding
+    std::size_t degenerate = 0;  // collapsed by welding or with zero area
+    std::size_t edges = 0;
+    std::size_t open_edges = 0;
+    std::size_t nonmanifold_edges = 0;
+    std::size_t misoriented_edges = 0; // neighbours wound the same way: one of them is flipped
+    std::size_t shells = 0;
+    std::size_t inverted_shells = 0;   // negative volume and not a cavity inside another shell
+    std::size_t stored_normals_flipped = 0; // STL normal disagrees with the winding
+    std::size_t intersecting_pairs = 0;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> examples; // file triangle indices
+    double volume = 0;           // signed, model units³
+    int genus = 0;               // of a single closed shell, from V - E + F
+    double weld_seconds = 0, topology_seconds = 0, intersect_seconds = 0;
+
+    bool watertight() const { return open_edges == 0 && nonmanifold_edges == 0; }
+    bool printable() const {
+        return watertight() && misoriented_edges == 0 && inverted_shells == 0 && intersecting_pairs == 0;
+    }
+};
+
+// Welds the soup, then reports the defects that make slicers guess: open and
+// non-manifold edges from the half-edge pairing, flipped faces (misoriented
+// edges and inside-out shells), and pairs of non-adjacent triangles that cut
+// through each other, found with a triangle BVH queried in parallel.
+// Coplanar overlaps and triangles that only touch are not counted.
+CheckReport check(const stl::TriangleView& soup, const CheckOptions& options = {});
+
+} // namespace pwb::mesh
@@ -0,0 +1,473 @@
+#include "pwb/mesh_codec.hpp"
+
+#include "pwb/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace pwb::codec {
+
+namespace {
+
+[[noreturn]] void corrupt(const std::string& what) { throw std::runtime_error("mesh library: " + what); }
+
+// LZMA-style binary range coder: 11-bit probabilities adapting by 1/32.
+using Prob = std::uint16_t;
+constexpr Prob kHalf = 1024;
+constexpr std::uint32_t kTop = 1u << 24;
+
+class RangeEncoder {
+public:
+    explicit RangeEncoder(std::string& out) : out_(out) {}
+
+    void bit(Prob& p, unsigned b) {
+        const std::uint32_t bound = (range_ >> 11) * p;
+        if (!b) {
+            range_ = bound;
+            p += (2048 - p) >> 5;
+        } else {
+            low_ += bound;
+            range_ -= bound;
+            p -= p >> 5;
+        }
+        while (range_ < kTop) range_ <<= 8, shift_low();
+    }
+    void direct(std::uint32_t v, int n) {
+        while (n--) {
+            range_ >>= 1;
+            if ((v >> n) & 1) low_ += range_;
+            while (range_ < kTop) range_ <<= 8, shift_low();
+        }
+    }
+    void finish() {
+        for (int i = 0; i < 5; ++i) shift_low();
+    }
+
+private:
+    void shift_low() {
+        if (std::uint32_t(low_) < 0xff000000u || (low_ >> 32) != 0) {
+            const auto carry = std::uint8_t(low_ >> 32);
+            std::uint8_t byte = cache_;
+            do {
+                out_.push_back(char(std::uint8_t(byte + carry)));
+                byte = 0xff;
+            } while (--pending_);
+            cache_ = std::uint8_t(low_ >> 24);
+        }
+        ++pending_;
+        low_ = (low_ & 0x00ffffffu) << 8;
+    }
+
+    std::string& out_;
+    std::uint64_t low_ = 0;
+    std::uint32_t range_ = 0xffffffffu;
+    std::uint8_t cache_ = 0;
+    std::uint64_t pending_ = 1;
+};
+
+class RangeDecoder {
+public:
+    explicit RangeDecoder(std::string_view in) : p_(reinterpret_cast<const unsigned char*>(in.data())), end_(p_ + in.size()) {
+        for (int i = 0; i < 5; ++i) code_ = code_ << 8 | next();
+    }
+
+    unsigned bit(Prob& p) {
+        const std::uint32_t bound = (range_ >> 11) * p;
+        unsigned b;
+        if (code_ < bound) {
+            range_ = bound;
+            p += (2048 - p) >> 5;
+            b = 0;
+        } else {
+            code_ -= bound;
+            range_ -= bound;
+            p -= p >> 5;
+            b = 1;
+        }
+        while (range_ < kTop) range_ <<= 8, code_ = code_ << 8 | next();
+        return b;
+    }
+    std::uint32_t direct(int n) {
+        std::uint32_t v = 0;
+        while (n--) {
+            range_ >>= 1;
+            const std::uint32_t b = code_ >= range_;
+            code_ -= range_ & (0u - b);
+            v = v << 1 | b;
+            while (range_ < kTop) range_ <<= 8, code_ = code_ << 8 | next();
+        }
+        return v;
+    }
+    // The encoder flushes five bytes; reading further means the stream is short.
+    bool overrun() const { return overrun_; }
+
+private:
+    std::uint32_t next() {
+        if (p_ < end_) return *p_++;
+        overrun_ = true;
+        return 0;
+    }
+
+    const unsigned char* p_;
+    const unsigned char* end_;
+    std::uint32_t code_ = 0;
+    std::uint32_t range_ = 0xffffffffu;
+    bool overrun_ = false;
+};
+
+template <int Bits>
+struct Tree {
+    Prob p[1 << Bits];
+    Tree() { std::fill(std::begin(p), std::end(p), kHalf); }
+
+    void put(RangeEncoder& rc, std::uint32_t symbol) {
+        std::uint32_t m = 1;
+        for (int i = Bits - 1; i >= 0; --i) {
+            const unsigned b = (symbol >> i) & 1;
+            rc.bit(p[m], b);
+            m = m << 1 | b;
+        }
+    }
+    std::uint32_t get(RangeDecoder& rc) {
+        std::uint32_t m = 1;
+        for (int i = 0; i < Bits; ++i) m = m << 1 | rc.bit(p[m]);
+        return m - (1u << Bits);
+    }
+};
+
+// Unsigned integers by magnitude class (bit length), the bit under the
+// leading one modelled per class and the rest sent raw.
+struct IntModel {
+    Tree<6> cls;
+    Prob second[33];
+    IntModel() { std::fill(std::begin(second), std::end(second), kHalf); }
+
+    void put(RangeEncoder& rc, std::uint32_t v) {
+        int c = 0;
+        while (c < 32 && (v >> c)) ++c;
+        cls.put(rc, std::uint32_t(c));
+        if (c < 2) return;
+        rc.bit(second[c], (v >> (c - 2)) & 1);
+        rc.direct(v, c - 2);
+    }
+    std::uint32_t get(RangeDecoder& rc) {
+        const auto c = int(cls.get(rc));
+        if (c > 32) corrupt("bad integer class");
+        if (c < 2) return std::uint32_t(c);
+        std::uint32_t v = (2u | rc.bit(second[c])) << (c - 2);
+        return v | rc.direct(c - 2);
+    }
+};
+
+std::uint32_t zigzag(std::int32_t v) { return (std::uint32_t(v) << 1) ^ std::uint32_t(v >> 31); }
+std::int32_t unzigzag(std::uint32_t v) { return std::int32_t(v >> 1) ^ -std::int32_t(v & 1); }
+
+// FIFOs shared by both sides; slot 0 is the most recent entry.
+constexpr int kEdges = 32, kVertices = 16;
+constexpr std::uint32_t kNoEdge = kEdges;
+constexpr std::uint32_t kNew = 0, kExplicit = kVertices + 1;
+
+struct Edge {
+    std::uint32_t a = mesh::kNone, b = mesh::kNone, opposite = mesh::kNone; // a -> b as the next face walks it
+};
+
+struct State {
+    Edge edges[kEdges];
+    std::uint32_t vertices[kVertices];
+    unsigned edge_head = 0, vertex_head = 0;
+    std::vector<std::array<std::int32_t, 3>> q; // quantised positions by decoded index
+    std::array<std::int32_t, 3> last{};
+
+    Tree<6> edge_model;
+    Tree<5> third_model, free_model[3];
+    IntModel explicit_model, parallelogram[3], delta[3];
+
+    State() { std::fill(std::begin(vertices), std::end(vertices), mesh::kNone); }
+
+    const Edge& edge(unsigned slot) const { return edges[(edge_head - 1 - slot) % kEdges]; }
+    std::uint32_t vertex(unsigned slot) const { return vertices[(vertex_head - 1 - slot) % kVertices]; }
+    void push_edge(std::uint32_t a, std::uint32_t b, std::uint32_t opposite) { edges[edge_head++ % kEdges] = {a, b, opposite}; }
+    void push_vertex(std::uint32_t v) { vertices[vertex_head++ % kVertices] = v; }
+
+    // Edges a neighbour will walk backwards, the likeliest next one last.
+    void push_face(std::uint32_t c0, std::uint32_t c1, std::uint32_t c2, bool from_edge) {
+        if (!from_edge) push_edge(c1, c0, c2);
+        push_edge(c0, c2, c1);
+        push_edge(c2, c1, c0);
+    }
+
+    std::array<std::int32_t, 3> predict(const Edge* across) const {
+        if (!across) return last;
+        const auto &a = q[across->a], &b = q[across->b], &c = q[across->opposite];
+        return {a[0] + b[0] - c[0], a[1] + b[1] - c[1], a[2] + b[2] - c[2]};
+    }
+};
+
+struct Encoded {
+    std::string bytes;
+    std::uint32_t vertices = 0, triangles = 0;
+    float origin[3] = {}, step[3] = {};
+};
+
+Encoded encode_part(const mesh::Mesh& m, int bits) {
+    Encoded out;
+    const std::size_t nv = m.vertices.size(), nt = m.triangles.size();
+    out.triangles = std::uint32_t(nt);
+
+    float lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+    for (std::size_t v = 0; v < nv; ++v) {
+        const float p[3] = {m.vertices[v].x, m.vertices[v].y, m.vertices[v].z};
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = v ? std::min(lo[k], p[k]) : p[k];
+            hi[k] = v ? std::max(hi[k], p[k]) : p[k];
+        }
+    }
+    const double levels = double((1u << bits) - 1);
+    for (int k = 0; k < 3; ++k) {
+        out.origin[k] = lo[k];
+        out.step[k] = hi[k] > lo[k] ? float((double(hi[k]) - lo[k]) / levels) : 1.0f;
+    }
+    std::vector<std::array<std::int32_t, 3>> quantised(nv);
+    for (std::size_t v = 0; v < nv; ++v) {
+        const float p[3] = {m.vertices[v].x, m.vertices[v].y, m.vertices[v].z};
+        for (int k = 0; k < 3; ++k)
+            quantised[v][k] = std::int32_t(std::clamp(std::lround((double(p[k]) - lo[k]) / out.step[k]), 0l, long(levels)));
+    }
+
+    const mesh::HalfEdges he = mesh::half_edges(m, 1);
+    std::vector<std::uint32_t> id(nv, mesh::kNone);
+    std::vector<std::uint8_t> rotation(nt, 0xff); // 0xff until emitted
+    std::vector<std::uint32_t> stack;
+    State s;
+    RangeEncoder rc(out.bytes);
+
+    auto code_vertex = [&](std::uint32_t v, Tree<5>& model, const Edge* across) {
+        if (id[v] == mesh::kNone) {
+            model.put(rc, kNew);
+            const auto p = s.predict(across);
+            for (int k = 0; k < 3; ++k) {
+                IntModel& im = across ? s.parallelogram[k] : s.delta[k];
+                im.put(rc, zigzag(quantised[v][k] - p[k]));
+            }
+            id[v] = std::uint32_t(s.q.size());
+            s.q.push_back(quantised[v]);
+            s.last = quantised[v];
+            s.push_vertex(id[v]);
+            return;
+        }
+        for (unsigned j = 0; j < kVertices; ++j)
+            if (s.vertex(j) == id[v]) return model.put(rc, 1 + j);
+        model.put(rc, kExplicit);
+        s.explicit_model.put(rc, std::uint32_t(s.q.size()) - 1 - id[v]);
+        s.push_vertex(id[v]);
+    };
+
+    auto emit = [&](std::uint32_t t) {
+        const mesh::Triangle& tri = m.triangles[t];
+        unsigned best = kNoEdge, r = 0;
+        for (unsigned k = 0; k < 3; ++k) {
+            const std::uint32_t a = id[tri[k]], b = id[tri[(k + 1) % 3]];
+            if (a == mesh::kNone || b == mesh::kNone) continue;
+            for (unsigned j = 0; j < std::min(best, unsigned(kEdges)); ++j)
+                if (s.edge(j).a == a && s.edge(j).b == b) best = j, r = k;
+        }
+        rotation[t] = std::uint8_t(r);
+        const std::uint32_t v0 = tri[r], v1 = tri[(r + 1) % 3], v2 = tri[(r + 2) % 3];
+        s.edge_model.put(rc, best);
+        if (best != kNoEdge) {
+            const Edge across = s.edge(best);
+            code_vertex(v2, s.third_model, &across);
+        } else {
+            code_vertex(v0, s.free_model[0], nullptr);
+            code_vertex(v1, s.free_model[1], nullptr);
+            code_vertex(v2, s.free_model[2], nullptr);
+        }
+        s.push_face(id[v0], id[v1], id[v2], best != kNoEdge);
+    };
+
+    // Unvisited neighbour of an emitted face, across the edges in the order
+    // their FIFO slots favour.
+    auto neighbour = [&](std::uint32_t t) {
+        for (unsigned k : {1u, 2u, 0u}) {
+            const std::uint32_t twin = he.twin[3 * t + (rotation[t] + k) % 3];
+            if (twin != mesh::kNone && rotation[twin / 3] == 0xff) return twin / 3;
+        }
+        return mesh::kNone;
+    };
+
+    std::uint32_t seed = 0, current = mesh::kNone;
+    for (std::size_t done = 0; done < nt; ++done) {
+        std::uint32_t next = current == mesh::kNone ? mesh::kNone : neighbour(current);
+        while (next == mesh::kNone && !stack.empty()) {
+            next = neighbour(stack.back());
+            if (next == mesh::kNone) stack.pop_back();
+        }
+        if (next == mesh::kNone) {
+            while (rotation[seed] != 0xff) ++seed;
+            next = seed;
+        }
+        emit(next);
+        stack.push_back(next);
+        current = next;
+    }
+    rc.finish();
+    out.vertices = std::uint32_t(s.q.size());
+    return out;
+}
+
+mesh::Mesh decode_part(std::string_view payload, const Entry& e) {
+    mesh::Mesh m;
+    m.vertices.reserve(e.vertices);
+    m.triangles.resize(e.triangles);
+    State s;
+    s.q.reserve(e.vertices);
+    RangeDecoder rc(payload);
+
+    auto vertex = [&](Tree<5>& model, const Edge* across) -> std::uint32_t {
+        const std::uint32_t symbol = model.get(rc);
+        if (symbol == kNew) {
+            if (s.q.size() == e.vertices) corrupt(e.name + ": more vertices than the directory says");
+            auto p = s.predict(across);
+            for (int k = 0; k < 3; ++k) {
+                IntModel& im = across ? s.parallelogram[k] : s.delta[k];
+                p[k] += unzigzag(im.get(rc));
+            }
+            const auto v = std::uint32_t(s.q.size());
+            s.q.push_back(p);
+            s.last = p;
+            m.vertices.push_back({e.origin[0] + float(p[0]) * e.step[0], e.origin[1] + float(p[1]) * e.step[1],
+                                  e.origin[2] + float(p[2]) * e.step[2]});
+            s.push_vertex(v);
+            return v;
+        }
+        if (symbol <= kVertices) {
+            const std::uint32_t v = s.vertex(symbol - 1);
+            if (v == mesh::kNone) corrupt(e.name + ": empty vertex slot");
+            return v;
+        }
+        if (symbol != kExplicit) corrupt(e.name + ": bad vertex code");
+        const std::uint32_t back = s.explicit_model.get(rc);
+        if (back >= s.q.size()) corrupt(e.name + ": vertex reference out of range");
+        const auto v = std::uint32_t(s.q.size()) - 1 - back;
+        s.push_vertex(v);
+        return v;
+    };
+
+    for (mesh::Triangle& tri : m.triangles) {
+        const std::uint32_t slot = s.edge_model.get(rc);
+        if (slot < kEdges) {
+            const Edge across = s.edge(slot);
+            if (across.a == mesh::kNone) corrupt(e.name + ": empty edge slot");
+            tri = {across.a, across.b, vertex(s.third_model, &across)};
+        } else if (slot == kNoEdge) {
+            tri[0] = vertex(s.free_model[0], nullptr);
+            tri[1] = vertex(s.free_model[1], nullptr);
+            tri[2] = vertex(s.free_model[2], nullptr);
+        } else {
+            corrupt(e.name + ": bad edge code");
+        }
+        s.push_face(tri[0], tri[1], tri[2], slot < kEdges);
+        if (rc.overrun()) corrupt(e.name + ": truncated payload");
+    }
+    if (m.vertices.size() != e.vertices) corrupt(e.name + ": fewer vertices than the directory says");
+    return m;
+}
+
+template <typename T>
+void put(std::string& out, T v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+template <typename T>
+T get(std::string_view data, std::size_t& at) {
+    if (at > data.size() || data.size() - at < sizeof(T)) corrupt("truncated directory");
+    T v;
+    std::memcpy(&v, data.data() + at, sizeof(T));
+    at += sizeof(T);
+    return v;
+}
+
+} // namespace
+
+std::string encode(const std::vector<Part>& parts, const Options& options) {
+    if (options.bits < 1 || options.bits > 16) throw std::runtime_error("mesh library: position bits must be 1-16");
+    std::vector<Encoded> encoded(parts.size());
+    parallel_for(parts.size(), [&](std::size_t i) { encoded[i] = encode_part(parts[i].mesh, options.bits); }, options.threads);
+
+    std::uint64_t offset = 16;
+    for (const Part& p : parts) offset += 2 + p.name.size() + 52;
+    std::string directory;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        if (parts[i].name.size() > 0xffff) throw std::runtime_error("mesh library: part name too long");
+        const Encoded& e = encoded[i];
+        put(directory, std::uint16_t(parts[i].name.size()));
+        directory += parts[i].name;
+        put(directory, e.vertices);
+        put(directory, e.triangles);
+        put(directory, std::uint32_t(options.bits));
+        for (float v : e.origin) put(directory, v);
+        for (float v : e.step) put(directory, v);
+        put(directory, offset);
+        put(directory, std::uint64_t(e.bytes.size()));
+        offset += e.bytes.size();
+    }
+    std::string out;
+    out.reserve(offset);
+    out += "PWBZ";
+    put(out, std::uint32_t(1));
+    put(out, std::uint32_t(parts.size()));
+    put(out, std::uint32_t(directory.size()));
+    out += directory;
+    for (const Encoded& e : encoded) out += e.bytes;
+    return out;
+}
+
+Reader::Reader(std::string_view data) : data_(data) {
+    if (data.size() < 16 || data.substr(0, 4) != "PWBZ") corrupt("bad magic");
+    std::size_t at = 4;
+    if (get<std::uint8_t>(data, at) != 1) corrupt("unsupported version");
+    at = 8;
+    const auto parts = get<std::uint32_t>(data, at);
+    const auto directory = get<std::uint32_t>(data, at);
+    if (directory > data.size() - 16) corrupt("truncated directory");
+    const std::string_view dir = data.substr(16, directory);
+    at = 0;
+    for (std::uint32_t i = 0; i < parts; ++i) {
+        Entry e;
+        const auto length = get<std::uint16_t>(dir, at);
+        if (dir.size() - at < length) corrupt("truncated directory");
+        e.name = std::string(dir.substr(at, length));
+        at += length;
+        e.vertices = get<std::uint32_t>(dir, at);
+        e.triangles = get<std::uint32_t>(dir, at);
+        e.bits = int(get<std::uint8_t>(dir, at));
+        at += 3;
+        for (float& v : e.origin) v = get<float>(dir, at);
+        for (float& v : e.step) v = get<float>(dir, at);
+        e.offset = get<std::uint64_t>(dir, at);
+        e.bytes = get<std::uint64_t>(dir, at);
+        if (e.bits < 1 || e.bits > 16) corrupt(e.name + ": bad position bits");
+        // No coder gets below 1/64 bit per triangle; anything denser is damage.
+        if (e.triangles > 64 * e.bytes + 64 || e.vertices > 3 * std::uint64_t(e.triangles))
+            corrupt(e.name + ": counts do not fit the payload");
+        if (e.offset > data.size() || e.bytes > data.size() - e.offset) corrupt(e.name + ": payload out of range");
+        entries_.push_back(std::move(e));
+    }
+}
+
+const Entry* Reader::find(std::string_view name) const {
+    for (const Entry& e : entries_)
+        if (e.name == name) return &e;
+    return nullptr;
+}
+
+mesh::Mesh Reader::decode(const Entry& entry) const {
+    return decode_part(data_.substr(entry.offset, entry.bytes), entry);
+}
+
+} // namespace pwb::codec
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "pwb/mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pwb::codec {
+
+// Compressed library of indexed meshes ("PWBZ"), little-endian:
+//
+//   "PWBZ", u8 version (1), u8 0 x3, u32 parts, u32 directory bytes,
+//   directory: per part u16 name length, name, u32 vertices, u32 triangles,
+//              u8 position bits, u8 0 x3, f32 origin[3], f32 step[3],
+//              u64 payload offset from the start of the file, u64 payload bytes,
+//   payloads.
+//
+// The directory comes first and is small, so one part can be read (or
+// fetched with a range request) without touching the others. Each payload
+// is a single adaptive binary range-coded stream. Triangles are walked depth
+// first, so most share an edge with one of the last few; a triangle is then
+// coded as a slot in a FIFO of recent edges plus its third vertex, which is
+// new, a slot in a FIFO of recent vertices, or an explicit back-reference.
+// Positions are quantised over the part's bounding box; a new vertex across
+// a known edge is predicted by the parallelogram rule and any other by the
+// previous vertex, and the residuals are coded by magnitude class.
+//
+// Decoding yields the same surface with triangles in walk order, corners
+// rotated (winding kept) and vertices numbered in order of first use.
+
+struct Part {
+    std::string name;
+    mesh::Mesh mesh;
+};
+
+struct Options {
+    int bits = 16;        // per coordinate, 1-16; 16 bits is 1.2 µm across an 80 mm part
+    unsigned threads = 0; // parts are encoded concurrently; 0 = all cores
+};
+
+std::string encode(const std::vector<Part>& parts, const Options& options = {});
+
+struct Entry {
+    std::string name;
+    std::uint32_t vertices = 0, triangles = 0;
+    int bits = 0;
+    float origin[3] = {}, step[3] = {}; // position = origin + q * step
+    std::uint64_t offset = 0, bytes = 0;
+};
+
+// Reads the directory of an encoded library held in memory; `data` must
+// outlive the reader. Throws std::runtime_error on malformed input, here or
+// in decode().
+class Reader {
+public:
+    explicit Reader(std::string_view data);
+
+    const std::vector<Entry>& entries() const { return entries_; }
+    const Entry* find(std::string_view name) const;
+
+    mesh::Mesh decode(const Entry& entry) const;
+
+private:
+    std::string_view data_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace pwb::codec
@@ -0,0 +1,382 @@
+#include "pwb/mesh_diff.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace pwb::diff {
+
+namespace {
+
+struct Box {
+    D3 lo{1e300, 1e300, 1e300}, hi{-1e300, -1e300, -1e300};
+    void grow(const Vec3& v) {
+        lo = {std::min(lo.x, double(v.x)), std::min(lo.y, double(v.y)), std::min(lo.z, double(v.z))};
+        hi = {std::max(hi.x, double(v.x)), std::max(hi.y, double(v.y)), std::max(hi.z, double(v.z))};
+    }
+    D3 centre() const { return mul(add(lo, hi), 0.5); }
+    double diagonal() const { return lo.x > hi.x ? 0 : std::sqrt(dot(sub(hi, lo), sub(hi, lo))); }
+};
+
+Box bounds(const mesh::Mesh& m) {
+    Box b;
+    for (const Vec3& v : m.vertices) b.grow(v);
+    return b;
+}
+
+// Rotation by the vector w (axis times angle in radians).
+Transform rotation(const D3& w) {
+    Transform r;
+    const double theta = std::sqrt(dot(w, w));
+    if (theta < 1e-15) return r;
+    const D3 k = mul(w, 1 / theta);
+    const double s = std::sin(theta), c = 1 - std::cos(theta);
+    const double K[3][3] = {{0, -k.z, k.y}, {k.z, 0, -k.x}, {-k.y, k.x, 0}};
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) {
+            double k2 = 0;
+            for (int m = 0; m < 3; ++m) k2 += K[i][m] * K[m][j];
+            r.rotation[i][j] = (i == j) + s * K[i][j] + c * k2;
+        }
+    return r;
+}
+
+// Solves the symmetric system a x = b in place by Gaussian elimination with
+// partial pivoting; a tiny ridge keeps flat or rotationally symmetric
+// samples (which leave a direction unconstrained) from blowing up.
+std::array<double, 6> solve(double a[6][6], double b[6]) {
+    double trace = 0;
+    for (int i = 0; i < 6; ++i) trace += a[i][i];
+    for (int i = 0; i < 6; ++i) a[i][i] += 1e-9 * trace + 1e-30;
+    for (int col = 0; col < 6; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < 6; ++r)
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+        std::swap(a[col], a[pivot]);
+        std::swap(b[col], b[pivot]);
+        for (int r = col + 1; r < 6; ++r) {
+            const double f = a[r][col] / a[col][col];
+            for (int c = col; c < 6; ++c) a[r][c] -= f * a[col][c];
+            b[r] -= f * b[col];
+        }
+    }
+    std::array<double, 6> x{};
+    for (int r = 5; r >= 0; --r) {
+        double s = b[r];
+        for (int c = r + 1; c < 6; ++c) s -= a[r][c] * x[std::size_t(c)];
+        x[std::size_t(r)] = s / a[r][r];
+    }
+    return x;
+}
+
+double median_abs(std::vector<double> v) {
+    if (v.empty()) return 0;
+    auto mid = v.begin() + std::ptrdiff_t(v.size() / 2);
+    std::nth_element(v.begin(), mid, v.end());
+    return *mid;
+}
+
+template <typename T>
+void put(std::string& out, T v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+} // namespace
+
+Vec3 Transform::apply(const Vec3& p) const {
+    const double v[3] = {p.x, p.y, p.z};
+    double r[3];
+    for (int i = 0; i < 3; ++i) r[i] = rotation[i][0] * v[0] + rotation[i][1] * v[1] + rotation[i][2] * v[2] + translation[i];
+    return {float(r[0]), float(r[1]), float(r[2])};
+}
+
+Transform Transform::then(const Transform& next) const {
+    Transform out;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            out.rotation[i][j] = 0;
+            for (int k = 0; k < 3; ++k) out.rotation[i][j] += next.rotation[i][k] * rotation[k][j];
+        }
+        out.translation[i] = next.translation[i];
+        for (int k = 0; k < 3; ++k) out.translation[i] += next.rotation[i][k] * translation[k];
+    }
+    return out;
+}
+
+double Transform::angle() const {
+    const double c = (rotation[0][0] + rotation[1][1] + rotation[2][2] - 1) / 2;
+    return std::acos(std::clamp(c, -1.0, 1.0)) * 180 / kPi;
+}
+
+mesh::Mesh transformed(const mesh::Mesh& mesh, const Transform& t) {
+    mesh::Mesh out;
+    out.triangles = mesh.triangles;
+    out.vertices.reserve(mesh.vertices.size());
+    for (const Vec3& v : mesh.vertices) out.vertices.push_back(t.apply(v));
+    return out;
+}
+
+Target::Target(const mesh::Mesh& mesh, unsigned threads) : mesh_(mesh), surface_(mesh) {
+    const std::size_t n = mesh.triangles.size();
+    face_normals_.resize(n);
+    std::vector<D3> vertex(mesh.vertices.size());
+    for (std::size_t t = 0; t < n; ++t) {
+        const mesh::Triangle& tri = mesh.triangles[t];
+        const D3 p[3] = {d3(mesh.vertices[tri[0]]), d3(mesh.vertices[tri[1]]), d3(mesh.vertices[tri[2]])};
+        const D3 normal = unit(cross(sub(p[1], p[0]), sub(p[2], p[0])));
+        face_normals_[t] = f3(normal);
+        for (int k = 0; k < 3; ++k) {
+            const D3 u = unit(sub(p[(k + 1) % 3], p[k])), v = unit(sub(p[(k + 2) % 3], p[k]));
+            vertex[tri[std::size_t(k)]] = add(vertex[tri[std::size_t(k)]], mul(normal, std::acos(std::clamp(dot(u, v), -1.0, 1.0))));
+        }
+    }
+    vertex_normals_.reserve(vertex.size());
+    for (const D3& v : vertex) vertex_normals_.push_back(f3(unit(v)));
+    const mesh::HalfEdges he = mesh::half_edges(mesh, threads);
+    edge_normals_.resize(3 * n);
+    for (std::size_t h = 0; h < 3 * n; ++h) {
+        D3 e = d3(face_normals_[h / 3]);
+        if (he.twin[h] != mesh::kNone) e = add(e, d3(face_normals_[he.twin[h] / 3]));
+        edge_normals_[h] = f3(unit(e));
+    }
+}
+
+Hit Target::nearest(const Vec3& q, float reach) const {
+    Hit hit;
+    const dist::Closest c = surface_.closest(q, reach);
+    if (c.triangle == mesh::kNone) return hit;
+    hit.point = c.point, hit.triangle = c.triangle, hit.normal = face_normals_[c.triangle];
+
+    // Barycentric weights of the nearest point tell face, edge or vertex.
+    const mesh::Triangle& tri = mesh_.triangles[c.triangle];
+    const D3 a = d3(mesh_.vertices[tri[0]]), b = d3(mesh_.vertices[tri[1]]), cc = d3(mesh_.vertices[tri[2]]);
+    const D3 v0 = sub(b, a), v1 = sub(cc, a), v2 = sub(d3(c.point), a);
+    const double d00 = dot(v0, v0), d01 = dot(v0, v1), d11 = dot(v1, v1), d20 = dot(v2, v0), d21 = dot(v2, v1);
+    const double den = d00 * d11 - d01 * d01;
+    D3 pseudo = d3(hit.normal);
+    if (den > 0) {
+        const double v = (d11 * d20 - d01 * d21) / den, w = (d00 * d21 - d01 * d20) / den;
+        const double weight[3] = {1 - v - w, v, w}, eps = 1e-5;
+        int zeros = 0, zero = 0, one = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (weight[k] < eps) ++zeros, zero = k;
+            if (weight[k] > 1 - eps) one = k;
+        }
+        if (zeros >= 2) pseudo = d3(vertex_normals_[tri[std::size_t(one)]]);
+        else if (zeros == 1) pseudo = d3(edge_normals_[3 * std::size_t(c.triangle) + std::size_t((zero + 1) % 3)]);
+    }
+    const double side = dot(sub(d3(q), d3(c.point)), pseudo);
+    hit.distance = side < 0 ? -c.distance : c.distance;
+    return hit;
+}
+
+std::vector<float> signed_distances(const std::vector<Vec3>& points, const Target& target, unsigned threads) {
+    std::vector<float> out(points.size());
+    const std::size_t block = 4096;
+    parallel_for(
+        (points.size() + block - 1) / block,
+        [&](std::size_t k) {
+            for (std::size_t i = k * block; i < std::min(points.size(), (k + 1) * block); ++i)
+                out[i] = target.nearest(points[i]).distance;
+        },
+        threads);
+    return out;
+}
+
+Alignment align(const mesh::Mesh& moving, const Target& fixed, const IcpOptions& o) {
+    Alignment best;
+    if (moving.triangles.empty() || fixed.mesh().triangles.empty()) return best;
+    const Box box = bounds(moving);
+    const double diagonal = box.diagonal();
+    double area = 0;
+    for (const mesh::Triangle& t : moving.triangles) {
+        const D3 a = d3(moving.vertices[t[0]]);
+        const D3 n = cross(sub(d3(moving.vertices[t[1]]), a), sub(d3(moving.vertices[t[2]]), a));
+        area += 0.5 * std::sqrt(dot(n, n));
+    }
+    const std::vector<Vec3> points = dist::sample_area(moving, float(std::sqrt(area / double(std::max<std::size_t>(1, o.samples)))));
+    if (points.size() < 6) return best;
+    const float reach = o.reach > 0 ? o.reach : float(0.05 * diagonal);
+    const std::size_t block = 1024, blocks = (points.size() + block - 1) / block;
+    std::vector<Hit> hits(points.size());
+    std::vector<Vec3> moved(points.size());
+
+    auto pair_up = [&](const Transform& t, float within) {
+        parallel_for(
+            blocks,
+            [&](std::size_t k) {
+                for (std::size_t i = k * block; i < std::min(points.size(), (k + 1) * block); ++i) {
+                    moved[i] = t.apply(points[i]);
+                    hits[i] = fixed.nearest(moved[i], within);
+                }
+            },
+            o.threads);
+    };
+    auto median = [&](const Transform& t) {
+        pair_up(t, 1e30f);
+        std::vector<double> d(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i) d[i] = std::abs(hits[i].distance);
+        return median_abs(std::move(d));
+    };
+
+    // Up to `steps` more iterations of `a`, fewer once it settles.
+    std::vector<std::pair<double, std::uint32_t>> pairs;
+    auto run = [&](Alignment& a, int steps) {
+        Transform& t = a.transform;
+        for (int step = 0; step < steps; ++step) {
+            pair_up(t, reach);
+            ++a.iterations;
+            pairs.clear();
+            for (std::uint32_t i = 0; i < points.size(); ++i)
+                if (hits[i].triangle != mesh::kNone) pairs.push_back({std::abs(hits[i].distance), i});
+            if (pairs.size() < 6) return;
+            const std::size_t kept = std::max<std::size_t>(6, std::size_t(o.keep * double(pairs.size())));
+            std::nth_element(pairs.begin(), pairs.begin() + std::ptrdiff_t(kept - 1), pairs.end());
+            pairs.resize(kept);
+
+            D3 c;
+            for (const auto& [d, i] : pairs) c = add(c, d3(moved[i]));
+            c = mul(c, 1.0 / double(pairs.size()));
+            double A[6][6] = {}, b[6] = {}, sum2 = 0;
+            for (const auto& [d, i] : pairs) {
+                const D3 p = d3(moved[i]), n = d3(hits[i].normal);
+                const D3 arm = cross(sub(p, c), n);
+                const double row[6] = {arm.x, arm.y, arm.z, n.x, n.y, n.z};
+                const double r = dot(sub(p, d3(hits[i].point)), n);
+                for (int u = 0; u < 6; ++u) {
+                    for (int v = 0; v < 6; ++v) A[u][v] += row[u] * row[v];
+                    b[u] -= row[u] * r;
+                }
+                sum2 += d * d;
+            }
+            const double rms = std::sqrt(sum2 / double(pairs.size()));
+            const bool settled = a.pairs && std::abs(rms - a.rms) < 1e-6 * diagonal;
+            a.rms = rms, a.pairs = pairs.size();
+            const std::array<double, 6> x = solve(A, b);
+            Transform move = rotation({x[0], x[1], x[2]});
+            const D3 rc = d3(move.apply(f3(c)));
+            move.translation[0] = c.x - rc.x + x[3];
+            move.translation[1] = c.y - rc.y + x[4];
+            move.translation[2] = c.z - rc.z + x[5];
+            t = t.then(move);
+            if (settled || (std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]) < 1e-6 &&
+                            std::sqrt(x[3] * x[3] + x[4] * x[4] + x[5] * x[5]) < 1e-6 * diagonal))
+                return;
+        }
+    };
+
+    // Revisions are drawn in their own frames and often turned on the bed, so
+    // besides where the part already is, start from the bounding-box centres
+    // matched under each quarter turn about Z. Each start gets a few
+    // iterations; the best by median distance is carried on to convergence.
+    std::vector<Alignment> starts(1);
+    if (o.centre_start) {
+        const D3 from = box.centre(), to = bounds(fixed.mesh()).centre();
+        for (int quarter = 0; quarter < 4; ++quarter) {
+            Transform start = rotation({0, 0, quarter * kPi / 2});
+            const D3 turned = d3(start.apply(f3(from)));
+            start.translation[0] = to.x - turned.x, start.translation[1] = to.y - turned.y, start.translation[2] = to.z - turned.z;
+            starts.push_back({start});
+        }
+    }
+    const double before = median(Transform{});
+    const int trial = std::min(o.iterations, 10);
+    for (Alignment& a : starts) {
+        run(a, trial);
+        a.median = median(a.transform);
+    }
+    best = *std::min_element(starts.begin(), starts.end(), [](const Alignment& a, const Alignment& b) { return a.median < b.median; });
+    run(best, o.iterations - trial);
+    best.median = median(best.transform);
+    best.median_before = before;
+    return best;
+}
+
+std::vector<Region> regions(const std::vector<Vec3>& points, const std::vector<float>& distance, float tolerance,
+                            float cell) {
+    // Changed samples by grid cell and side (gained or lost); cells joined to
+    // their 26 neighbours on the same side with union-find.
+    auto coord = [&](float v) { return std::uint64_t(std::int64_t(std::floor(double(v) / cell)) + (1 << 20)) & 0x1fffff; };
+    auto key = [](bool lost, std::uint64_t x, std::uint64_t y, std::uint64_t z) { return std::uint64_t(lost) << 63 | x << 42 | y << 21 | z; };
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> changed;
+    for (std::uint32_t i = 0; i < points.size(); ++i)
+        if (std::abs(distance[i]) > tolerance)
+            changed.push_back({key(distance[i] < 0, coord(points[i].x), coord(points[i].y), coord(points[i].z)), i});
+    std::sort(changed.begin(), changed.end());
+    std::vector<std::uint64_t> cells;
+    for (const auto& c : changed)
+        if (cells.empty() || cells.back() != c.first) cells.push_back(c.first);
+
+    UnionFind regions(cells.size());
+    const std::uint64_t mask = 0x1fffff;
+    for (std::uint32_t i = 0; i < cells.size(); ++i) {
+        const bool lost = cells[i] >> 63;
+        const std::uint64_t x = cells[i] >> 42 & mask, y = cells[i] >> 21 & mask, z = cells[i] & mask;
+        for (int dx = -1; dx <= 1; ++dx)
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dz = -1; dz <= 1; ++dz) {
+                    const std::uint64_t k = key(lost, x + std::uint64_t(dx), y + std::uint64_t(dy), z + std::uint64_t(dz));
+                    const auto it = std::lower_bound(cells.begin(), cells.end(), k);
+                    if (it == cells.end() || *it != k) continue;
+                    regions.join(i, std::uint32_t(it - cells.begin()));
+                }
+    }
+
+    std::vector<Region> out;
+    std::vector<std::uint32_t> index(cells.size(), mesh::kNone);
+    std::size_t c = 0;
+    for (const auto& [k, i] : changed) {
+        while (cells[c] != k) ++c;
+        const std::uint32_t root = regions.find(std::uint32_t(c));
+        if (index[root] == mesh::kNone) {
+            index[root] = std::uint32_t(out.size());
+            out.push_back({points[i], points[i], 0, 0, 0});
+        }
+        Region& r = out[index[root]];
+        const Vec3& p = points[i];
+        r.min = {std::min(r.min.x, p.x), std::min(r.min.y, p.y), std::min(r.min.z, p.z)};
+        r.max = {std::max(r.max.x, p.x), std::max(r.max.y, p.y), std::max(r.max.z, p.z)};
+        ++r.samples;
+        r.added = std::max(r.added, distance[i]);
+        r.removed = std::max(r.removed, -distance[i]);
+    }
+    std::sort(out.begin(), out.end(), [](const Region& a, const Region& b) { return a.samples > b.samples; });
+    return out;
+}
+
+std::string ply(const mesh::Mesh& mesh, const std::vector<float>& distance, float range, float tolerance) {
+    std::string out = "ply\nformat binary_little_endian 1.0\ncomment signed distance to the other revision, mm\n"
+                      "element vertex " + std::to_string(mesh.vertices.size()) +
+                      "\nproperty float x\nproperty float y\nproperty float z\n"
+                      "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty float quality\n"
+                      "element face " + std::to_string(mesh.triangles.size()) +
+                      "\nproperty list uchar int vertex_indices\nend_header\n";
+    out.reserve(out.size() + mesh.vertices.size() * 19 + mesh.triangles.size() * 13);
+    const double grey = 190;
+    for (std::size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const Vec3& v = mesh.vertices[i];
+        put(out, v.x), put(out, v.y), put(out, v.z);
+        const float d = distance[i];
+        // Anything past the tolerance is clearly tinted, fully so at `range`.
+        double s = 0;
+        if (std::abs(d) > tolerance)
+            s = 0.25 + 0.75 * std::min(1.0, (std::abs(double(d)) - tolerance) / std::max(1e-9, double(range - tolerance)));
+        // Grey to red (220, 30, 30) or to blue (30, 60, 220).
+        const double to[3] = {d > 0 ? 220.0 : 30.0, d > 0 ? 30.0 : 60.0, d > 0 ? 30.0 : 220.0};
+        for (double t : to) put(out, std::uint8_t(std::lround(grey + (t - grey) * s)));
+        put(out, d);
+    }
+    for (const mesh::Triangle& t : mesh.triangles) {
+        put(out, std::uint8_t(3));
+        for (std::uint32_t v : t) put(out, std::int32_t(v));
+    }
+    return out;
+}
+
+} // namespace pwb::diff
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "pwb/mesh.hpp"
+#include "pwb/surface_distance.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pwb::diff {
+
+using stl::Vec3;
+
+// Rigid motion p -> rotation p + translation.
+struct Transform {
+    double rotation[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    double translation[3] = {0, 0, 0};
+
+    Vec3 apply(const Vec3& p) const;
+    Transform then(const Transform& next) const; // next after this
+    double angle() const;                        // rotation angle, degrees
+};
+
+mesh::Mesh transformed(const mesh::Mesh& mesh, const Transform& t);
+
+struct Hit {
+    float distance = 1e30f; // signed: positive outside the surface
+    Vec3 point;             // nearest point on the surface
+    Vec3 normal;            // unit normal of the triangle holding it
+    std::uint32_t triangle = mesh::kNone;
+};
+
+// A mesh to measure against. The sign of a distance comes from the
+// angle-weighted pseudo-normal of the nearest feature (face, edge or vertex),
+// which is exact for closed, consistently oriented meshes (Baerentzen and
+// Aanaes, 2005) and a fair guess on open ones.
+class Target {
+public:
+    explicit Target(const mesh::Mesh& mesh, unsigned threads = 0);
+
+    Hit nearest(const Vec3& p, float reach = 1e30f) const;
+    const mesh::Mesh& mesh() const { return mesh_; }
+
+private:
+    mesh::Mesh mesh_;
+    dist::Surface surface_;
+    std::vector<Vec3> face_normals_;
+    std::vector<Vec3> vertex_normals_; // angle weighted
+    std::vector<Vec3> edge_normals_;   // per half-edge, both faces together
+};
+
+// Signed distance from each point to `target`, on `threads` threads.
+std::vector<float> signed_distances(const std::vector<Vec3>& points, const Target& target, unsigned threads = 0);
+
+struct IcpOptions {
+    int iterations = 100;
+    std::size_t samples = 5000;  // points taken evenly over the moving surface
+    double keep = 0.8;           // fraction of the nearest pairs used in each step
+    float reach = 0;             // pairs farther apart are ignored; 0 = 5 % of the diagonal
+    bool centre_start = true;    // also try matched bounding-box centres under quarter turns about Z
+    unsigned threads = 0;
+};
+
+struct Alignment {
+    Transform transform;
+    double median_before = 0, median = 0; // median |distance| of the samples, mm
+    double rms = 0;                       // over the pairs kept in the last step
+    std::size_t pairs = 0;
+    int iterations = 0;
+};
+
+// Rigid alignment of `moving` onto `fixed` by trimmed point-to-plane ICP:
+// each step pairs the samples with their nearest points on the fixed mesh
+// (in parallel), drops the farthest pairs, so that the parts which really
+// changed between revisions do not drag the fit, and solves the linearised
+// 6x6 least-squares problem for a small rotation and translation.
+Alignment align(const mesh::Mesh& moving, const Target& fixed, const IcpOptions& options = {});
+
+// A connected patch of surface that moved more than the tolerance, all on
+// one side: either material gained or material lost.
+struct Region {
+    Vec3 min, max;          // bounding box
+    std::size_t samples = 0;
+    float added = 0;        // largest outward distance, mm (material gained)
+    float removed = 0;      // largest inward distance, mm, as a positive number
+};
+
+// Samples with |distance| > tolerance, gained and lost apart, grouped by
+// 26-connectivity on a grid of `cell`, largest first.
+std::vector<Region> regions(const std::vector<Vec3>& points, const std::vector<float>& distance, float tolerance,
+                            float cell);
+
+// Binary PLY with per-vertex colour and the distance as "quality" (MeshLab
+// and CloudCompare read both): grey within the tolerance, then towards red for
+// material gained and blue for material lost, saturating at `range`.
+std::string ply(const mesh::Mesh& mesh, const std::vector<float>& distance, float range, float tolerance);
+
+} // namespace pwb::diff
@@ -0,0 +1,502 @@
+#include "pwb/polygon_ops.hpp"
+
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace pwb::poly {
+
+namespace {
+
+// Exact orientation tests need 2 x 64-bit products. MSVC has no 128-bit
+// integer; long double keeps it building there at reduced robustness.
+#if defined(__SIZEOF_INT128__)
+using Wide = __int128;
+#else
+using Wide = long double;
+#endif
+
+// Sweep order: bottom to top, then left to right. Treating equal-y points this
+// way is a symbolic shear, so horizontal edges need no special case.
+bool below(const Point& a, const Point& b) { return a.y < b.y || (a.y == b.y && a.x < b.x); }
+
+Wide cross(const Point& o, const Point& a, const Point& b) {
+    return Wide(a.x - o.x) * Wide(b.y - o.y) - Wide(a.y - o.y) * Wide(b.x - o.x);
+}
+
+Wide dot(const Point& o, const Point& a, const Point& b) {
+    return Wide(a.x - o.x) * Wide(b.x - o.x) + Wide(a.y - o.y) * Wide(b.y - o.y);
+}
+
+int sign(Wide v) { return v > 0 ? 1 : v < 0 ? -1 : 0; }
+
+// Sign of cross(o, a, b): doubles when the result is clearly away from zero,
+// exact arithmetic otherwise.
+int orient(const Point& o, const Point& a, const Point& b) {
+    double l = double(a.x - o.x) * double(b.y - o.y), r = double(a.y - o.y) * double(b.x - o.x);
+    double d = l - r, bound = (std::fabs(l) + std::fabs(r)) * 1e-15;
+    if (d > bound) return 1;
+    if (d < -bound) return -1;
+    return sign(cross(o, a, b));
+}
+
+Coord round_div(Wide num, Wide den) {
+#if defined(__SIZEOF_INT128__)
+    if (den < 0) num = -num, den = -den;
+    Wide q = (2 * num + den) / (2 * den);
+    if ((2 * num + den) % (2 * den) < 0) --q; // floor for negative numerators
+    return Coord(q);
+#else
+    return Coord(std::floor(num / den + 0.5L));
+#endif
+}
+
+// Input edge in its original direction; `op` is 0 for the subject, 1 for the clip.
+struct Edge {
+    Point a, b;
+    std::uint8_t op;
+    bool fresh; // created or split in the last noding pass
+};
+
+struct Split {
+    std::uint32_t edge;
+    Point at;
+};
+
+// Strictly inside segment ab, given that p is collinear with it.
+bool inside_collinear(const Point& a, const Point& b, const Point& p) {
+    return p != a && p != b && dot(p, a, b) < 0;
+}
+
+// Finds where edges cross or touch each other's interiors and records the
+// split points. Returns false when the edges are already fully noded.
+class Noder {
+public:
+    bool run(const std::vector<Edge>& edges, std::vector<Split>& splits) {
+        splits.clear();
+        if (edges.size() < 2) return false;
+        build_grid(edges);
+        bool found = false;
+        for (std::size_t s = 0, e = 0; s < cells_.size(); s = e) {
+            const std::uint64_t cell = cells_[s].cell;
+            bool any_fresh = false;
+            for (e = s; e < cells_.size() && cells_[e].cell == cell; ++e) any_fresh |= cells_[e].fresh;
+            if (!any_fresh) continue;
+            for (std::size_t i = s; i < e; ++i) {
+                const Entry& p = cells_[i];
+                for (std::size_t j = i + 1; j < e; ++j) {
+                    const Entry& q = cells_[j];
+                    if (q.min_x > p.max_x) break; // runs are sorted by min_x
+                    if (!(p.fresh || q.fresh) || p.max_y < q.min_y || q.max_y < p.min_y) continue;
+                    // A pair sharing several cells is tested in each; the repeated
+                    // splits coincide and apply_splits drops them.
+                    found |= intersect(edges, p.edge, q.edge, splits);
+                }
+            }
+        }
+        return found;
+    }
+
+private:
+    // Grid entry with the edge's box inlined, so the sweep over a cell's
+    // entries (sorted by min_x) stays in one contiguous run of memory.
+    struct Entry {
+        std::uint64_t cell;
+        Coord min_x, min_y, max_x, max_y;
+        std::uint32_t edge;
+        bool fresh;
+    };
+
+    // Visits every cell the closed segment touches, column by column: the rows
+    // between the segment's lowest and highest y inside each column, with the
+    // crossing heights rounded outwards. Long diagonal edges so stay O(length)
+    // instead of filling their whole bounding box.
+    template <typename Fn>
+    void for_cells(const Edge& e, Fn&& fn) const {
+        const Point& a = e.a.x <= e.b.x ? e.a : e.b;
+        const Point& b = e.a.x <= e.b.x ? e.b : e.a;
+        const Coord lo_y = std::min(a.y, b.y), hi_y = std::max(a.y, b.y);
+        const Wide dx = Wide(b.x) - Wide(a.x), dy = Wide(b.y) - Wide(a.y);
+        auto y_at = [&](Coord x, bool up) {
+            if (dx == 0) return up ? hi_y : lo_y;
+            Wide num = Wide(x - a.x) * dy, q = num / dx;
+            if (num % dx != 0) q += up ? (num > 0) : -(num < 0);
+            return std::clamp(a.y + Coord(q), lo_y, hi_y);
+        };
+        const Coord c0 = (a.x - x0_) / cell_, c1 = (b.x - x0_) / cell_;
+        for (Coord c = c0; c <= c1; ++c) {
+            const Coord l = std::max(a.x, x0_ + c * cell_), h = std::min(b.x, x0_ + (c + 1) * cell_);
+            const Coord y0 = std::min(y_at(l, false), y_at(h, false)), y1 = std::max(y_at(l, true), y_at(h, true));
+            for (Coord r = (y0 - y0_) / cell_, r1 = (y1 - y0_) / cell_; r <= r1; ++r)
+                fn(std::uint64_t(r) * std::uint64_t(nx_) + std::uint64_t(c));
+        }
+    }
+
+    // Sparse uniform grid sized from the mean edge extent, as cell-sorted
+    // entries for every cell an edge crosses. When few edges are fresh
+    // only the cells they touch are populated.
+    void build_grid(const std::vector<Edge>& edges) {
+        Coord min_x = INT64_MAX, min_y = INT64_MAX, max_x = INT64_MIN, max_y = INT64_MIN;
+        double extent = 0;
+        std::size_t fresh = 0;
+        for (const Edge& e : edges) {
+            min_x = std::min({min_x, e.a.x, e.b.x}), max_x = std::max({max_x, e.a.x, e.b.x});
+            min_y = std::min({min_y, e.a.y, e.b.y}), max_y = std::max({max_y, e.a.y, e.b.y});
+            extent += double(std::max(std::llabs(e.b.x - e.a.x), std::llabs(e.b.y - e.a.y)));
+            fresh += e.fresh;
+        }
+        Coord span = std::max<Coord>(std::max(max_x - min_x, max_y - min_y), 1);
+        cell_ = std::max<Coord>({Coord(4 * extent / double(edges.size())), span >> 16, 1});
+        x0_ = min_x, y0_ = min_y;
+        nx_ = (max_x - min_x) / cell_ + 1;
+
+        std::vector<std::uint64_t> wanted;
+        if (fresh * 4 < edges.size()) {
+            for (const Edge& e : edges)
+                if (e.fresh) for_cells(e, [&](std::uint64_t c) { wanted.push_back(c); });
+            std::sort(wanted.begin(), wanted.end());
+            wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+        }
+        cells_.clear();
+        for (std::uint32_t i = 0; i < edges.size(); ++i) {
+            const Edge& e = edges[i];
+            Entry entry{0, std::min(e.a.x, e.b.x), std::min(e.a.y, e.b.y), std::max(e.a.x, e.b.x), std::max(e.a.y, e.b.y),
+                        i, e.fresh};
+            for_cells(e, [&](std::uint64_t c) {
+                if (!wanted.empty() && !std::binary_search(wanted.begin(), wanted.end(), c)) return;
+                entry.cell = c;
+                cells_.push_back(entry);
+            });
+        }
+        std::sort(cells_.begin(), cells_.end(),
+                  [](const Entry& p, const Entry& q) { return p.cell != q.cell ? p.cell < q.cell : p.min_x < q.min_x; });
+    }
+
+    static bool intersect(const std::vector<Edge>& edges, std::uint32_t e, std::uint32_t f, std::vector<Split>& out) {
+        const Point &a = edges[e].a, &b = edges[e].b, &c = edges[f].a, &d = edges[f].b;
+        int o1 = orient(a, b, c), o2 = orient(a, b, d);
+        int o3 = orient(c, d, a), o4 = orient(c, d, b);
+        bool found = false;
+        auto add = [&](std::uint32_t edge, const Point& p) {
+            const Edge& g = edges[edge];
+            if (p == g.a || p == g.b) return;
+            out.push_back({edge, p});
+            found = true;
+        };
+        if (o1 * o2 < 0 && o3 * o4 < 0) {
+            // Proper crossing: a + (b - a) * t with t = cross(c - a, d - c) / cross(b - a, d - c).
+            Wide num = Wide(c.x - a.x) * Wide(d.y - c.y) - Wide(c.y - a.y) * Wide(d.x - c.x);
+            Wide den = Wide(b.x - a.x) * Wide(d.y - c.y) - Wide(b.y - a.y) * Wide(d.x - c.x);
+            Point p{a.x + round_div(Wide(b.x - a.x) * num, den), a.y + round_div(Wide(b.y - a.y) * num, den)};
+            add(e, p);
+            add(f, p);
+            return found;
+        }
+        // Touching or collinear overlap: split at the endpoints lying inside the other edge.
+        if (o1 == 0 && inside_collinear(a, b, c)) add(e, c);
+        if (o2 == 0 && inside_collinear(a, b, d)) add(e, d);
+        if (o3 == 0 && inside_collinear(c, d, a)) add(f, a);
+        if (o4 == 0 && inside_collinear(c, d, b)) add(f, b);
+        return found;
+    }
+
+    Coord x0_ = 0, y0_ = 0, cell_ = 1, nx_ = 1;
+    std::vector<Entry> cells_;
+};
+
+// Splits edges at the recorded points, in order along each edge.
+void apply_splits(std::vector<Edge>& edges, std::vector<Split>& splits) {
+    std::sort(splits.begin(), splits.end(), [&](const Split& s, const Split& t) {
+        if (s.edge != t.edge) return s.edge < t.edge;
+        const Edge& e = edges[s.edge];
+        const Wide ds = dot(e.a, s.at, e.b), dt = dot(e.a, t.at, e.b);
+        if (ds != dt) return ds < dt;
+        return below(s.at, t.at); // keeps repeated points adjacent
+    });
+    std::vector<Edge> out;
+    out.reserve(edges.size() + splits.size());
+    std::size_t k = 0;
+    for (std::uint32_t i = 0; i < edges.size(); ++i) {
+        Point from = edges[i].a;
+        bool split = k < splits.size() && splits[k].edge == i;
+        for (; k < splits.size() && splits[k].edge == i; ++k) {
+            if (splits[k].at == from) continue;
+            out.push_back({from, splits[k].at, edges[i].op, true});
+            from = splits[k].at;
+        }
+        if (from != edges[i].b) out.push_back({from, edges[i].b, edges[i].op, split});
+    }
+    edges.swap(out);
+}
+
+// Noded edge with both operands' crossings folded in. lo is below hi in sweep
+// order; up[k] is the net count of operand k edges running lo -> hi.
+struct Bound {
+    std::uint32_t lo, hi; // vertex ids
+    int up[2];
+    int wind[2]; // winding numbers of the face on the sweep-left side
+};
+
+bool filled(const int w[2], Op op) {
+    bool a = w[0] != 0, b = w[1] != 0;
+    switch (op) {
+    case Op::Union: return a || b;
+    case Op::Intersection: return a && b;
+    case Op::Difference: return a && !b;
+    case Op::Xor: return a != b;
+    }
+    return false;
+}
+
+class Overlay {
+public:
+    PolygonSet run(const PolygonSet& subject, const PolygonSet& clip, Op op) {
+        collect(subject, 0);
+        collect(clip, 1);
+        node();
+        build_bounds();
+        sweep();
+        return link(op);
+    }
+
+private:
+    void collect(const PolygonSet& set, std::uint8_t op) {
+        for (std::size_t k = 0; k < set.size(); ++k) {
+            const Point* p = set.begin(k);
+            std::size_t n = set.count(k);
+            for (std::size_t i = 0; i < n; ++i) {
+                const Point& a = p[i];
+                const Point& b = p[i + 1 == n ? 0 : i + 1];
+                if (a != b) edges_.push_back({a, b, op, true});
+            }
+        }
+    }
+
+    // Rounded crossing points can create new crossings nearby; repeat until
+    // the arrangement is clean (one extra pass in practice). Later passes only
+    // test pairs involving an edge that was just split.
+    void node() {
+        Noder noder;
+        std::vector<Split> splits;
+        for (int pass = 0; pass < 16 && noder.run(edges_, splits); ++pass) apply_splits(edges_, splits);
+    }
+
+    void build_bounds() {
+        // One sort of all endpoints gives both the vertex list and each edge's ids.
+        std::vector<std::pair<Point, std::uint32_t>> ends(edges_.size() * 2);
+        for (std::uint32_t i = 0; i < edges_.size(); ++i) ends[2 * i] = {edges_[i].a, 2 * i}, ends[2 * i + 1] = {edges_[i].b, 2 * i + 1};
+        std::sort(ends.begin(), ends.end(), [](const auto& s, const auto& t) { return below(s.first, t.first); });
+        std::vector<std::uint32_t> id(ends.size());
+        vertices_.reserve(ends.size() / 2);
+        for (const auto& e : ends) {
+            if (vertices_.empty() || vertices_.back() != e.first) vertices_.push_back(e.first);
+            id[e.second] = std::uint32_t(vertices_.size() - 1);
+        }
+
+        struct Key {
+            std::uint32_t lo, hi;
+            int dir;
+            std::uint8_t op;
+        };
+        std::vector<Key> keys;
+        keys.reserve(edges_.size());
+        for (std::uint32_t i = 0; i < edges_.size(); ++i) {
+            std::uint32_t a = id[2 * i], b = id[2 * i + 1];
+            keys.push_back(a < b ? Key{a, b, 1, edges_[i].op} : Key{b, a, -1, edges_[i].op});
+        }
+        std::vector<Edge>().swap(edges_);
+        std::sort(keys.begin(), keys.end(), [](const Key& s, const Key& t) { return s.lo != t.lo ? s.lo < t.lo : s.hi < t.hi; });
+        for (std::size_t i = 0; i < keys.size();) {
+            Bound b{keys[i].lo, keys[i].hi, {0, 0}, {0, 0}};
+            for (; i < keys.size() && keys[i].lo == b.lo && keys[i].hi == b.hi; ++i) b.up[keys[i].op] += keys[i].dir;
+            if (b.up[0] != 0 || b.up[1] != 0) bounds_.push_back(b); // cancelled edges bound nothing
+        }
+    }
+
+    const Point& lo(std::uint32_t b) const { return vertices_[bounds_[b].lo]; }
+    const Point& hi(std::uint32_t b) const { return vertices_[bounds_[b].hi]; }
+
+    // Vatti-style scanbeam sweep over the noded edges. With no crossings left the
+    // active edge list only changes at vertices, so each edge's left-side
+    // winding is read off its left neighbour when it is inserted.
+    void sweep() {
+        std::vector<std::uint32_t> starts(vertices_.size() + 1, 0);
+        for (const Bound& b : bounds_) ++starts[b.lo + 1];
+        for (std::size_t v = 1; v < starts.size(); ++v) starts[v] += starts[v - 1];
+        // bounds_ is sorted by lo, so edges starting at v are bounds_[starts[v], starts[v + 1]).
+
+        std::vector<std::uint32_t> active, fresh;
+        for (std::uint32_t v = 0; v < vertices_.size(); ++v) {
+            const Point& p = vertices_[v];
+            // First active edge that p is not strictly to the right of.
+            auto it = std::partition_point(active.begin(), active.end(),
+                                           [&](std::uint32_t b) { return cross(lo(b), hi(b), p) < 0; });
+            auto end = it;
+            while (end != active.end() && bounds_[*end].hi == v) ++end;
+            it = active.erase(it, end);
+
+            fresh.clear();
+            for (std::uint32_t b = starts[v]; b < starts[v + 1]; ++b) fresh.push_back(b);
+            if (fresh.empty()) continue;
+            // Left to right around p: q1 is left of q2 when it lies left of the ray p -> q2.
+            std::sort(fresh.begin(), fresh.end(), [&](std::uint32_t s, std::uint32_t t) { return cross(p, hi(t), hi(s)) > 0; });
+            int w[2] = {0, 0};
+            if (it != active.begin()) {
+                const Bound& left = bounds_[*(it - 1)];
+                w[0] = left.wind[0] - left.up[0];
+                w[1] = left.wind[1] - left.up[1];
+            }
+            for (std::uint32_t b : fresh) {
+                bounds_[b].wind[0] = w[0], bounds_[b].wind[1] = w[1];
+                w[0] -= bounds_[b].up[0];
+                w[1] -= bounds_[b].up[1];
+            }
+            active.insert(it, fresh.begin(), fresh.end());
+        }
+    }
+
+    // Keeps the edges that separate filled from empty, oriented with the fill on
+    // their left, and walks them into contours.
+    PolygonSet link(Op op) {
+        struct Arc {
+            std::uint32_t from, to;
+        };
+        std::vector<Arc> arcs;
+        for (const Bound& b : bounds_) {
+            int right[2] = {b.wind[0] - b.up[0], b.wind[1] - b.up[1]};
+            bool l = filled(b.wind, op), r = filled(right, op);
+            if (l != r) arcs.push_back(l ? Arc{b.lo, b.hi} : Arc{b.hi, b.lo});
+        }
+        std::sort(arcs.begin(), arcs.end(), [](const Arc& s, const Arc& t) { return s.from < t.from; });
+        std::vector<std::uint32_t> first(vertices_.size() + 1, 0);
+        for (const Arc& a : arcs) ++first[a.from + 1];
+        for (std::size_t v = 1; v < first.size(); ++v) first[v] += first[v - 1];
+
+        std::vector<char> used(arcs.size(), 0);
+        PolygonSet out;
+        std::vector<Point> ring;
+        for (std::uint32_t start = 0; start < arcs.size(); ++start) {
+            if (used[start]) continue;
+            ring.clear();
+            std::uint32_t cur = start;
+            bool closed = false;
+            while (true) {
+                used[cur] = 1;
+                ring.push_back(vertices_[arcs[cur].from]);
+                std::uint32_t v = arcs[cur].to;
+                if (v == arcs[start].from) {
+                    closed = true;
+                    break;
+                }
+                // At a vertex shared by several contours take the sharpest left
+                // turn, so touching contours stay separate and simple.
+                const Point& at = vertices_[v];
+                const Point back = vertices_[arcs[cur].from];
+                std::uint32_t best = UINT32_MAX;
+                for (std::uint32_t k = first[v]; k < first[v + 1]; ++k) {
+                    if (used[k]) continue;
+                    if (best == UINT32_MAX || turns_later(at, back, vertices_[arcs[best].to], vertices_[arcs[k].to])) best = k;
+                }
+                if (best == UINT32_MAX) break; // inconsistent input that noding could not repair
+                cur = best;
+            }
+            if (closed) emit(ring, out);
+        }
+        return out;
+    }
+
+    // Counter-clockwise angle from direction at->back: is `q` further round than `p`?
+    static bool turns_later(const Point& at, const Point& back, const Point& p, const Point& q) {
+        auto half = [&](const Point& r) {
+            Wide c = cross(at, back, r);
+            return c > 0 || (c == 0 && dot(at, back, r) > 0) ? 0 : 1;
+        };
+        int hp = half(p), hq = half(q);
+        if (hp != hq) return hq > hp;
+        return cross(at, p, q) > 0;
+    }
+
+    static void emit(std::vector<Point>& ring, PolygonSet& out) {
+        // Drop vertices in the middle of straight runs.
+        std::vector<Point> kept;
+        kept.reserve(ring.size());
+        for (const Point& p : ring) {
+            while (kept.size() >= 2 && cross(kept[kept.size() - 2], kept.back(), p) == 0) kept.pop_back();
+            kept.push_back(p);
+        }
+        while (kept.size() >= 3 && cross(kept[kept.size() - 2], kept.back(), kept[0]) == 0) kept.pop_back();
+        while (kept.size() >= 3 && cross(kept.back(), kept[0], kept[1]) == 0) kept.erase(kept.begin());
+        if (kept.size() < 3) return;
+        out.points.insert(out.points.end(), kept.begin(), kept.end());
+        out.close();
+    }
+
+    std::vector<Edge> edges_; // input and noding arena, released once bounds are built
+    std::vector<Point> vertices_;
+    std::vector<Bound> bounds_;
+};
+
+void append_ccw(std::vector<Point>& pts, PolygonSet& out) {
+    if (gerber::signed_area2(pts.data(), pts.size()) < 0) std::reverse(pts.begin(), pts.end());
+    out.points.insert(out.points.end(), pts.begin(), pts.end());
+    out.close();
+}
+
+} // namespace
+
+PolygonSet boolean(const PolygonSet& subject, const PolygonSet& clip, Op op) {
+    return Overlay().run(subject, clip, op);
+}
+
+PolygonSet merge(const PolygonSet& set) { return boolean(set, PolygonSet{}, Op::Union); }
+
+PolygonSet flatten(const std::vector<PolygonSet>& levels, const std::vector<bool>& clear) {
+    PolygonSet acc;
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        bool subtract = i < clear.size() && clear[i];
+        if (subtract && acc.size() == 0) continue;
+        acc = boolean(acc, levels[i], subtract ? Op::Difference : Op::Union);
+    }
+    return acc;
+}
+
+PolygonSet offset(const PolygonSet& set, Coord delta, Coord tolerance) {
+    if (delta == 0) return merge(set);
+    // The band swept by a disc of radius |delta| along every edge: a rectangle
+    // per edge plus a disc per vertex.
+    const Coord r = delta < 0 ? -delta : delta;
+    const int segments = gerber::circle_segments(r, tolerance);
+    PolygonSet band;
+    std::vector<Point> piece;
+    for (std::size_t k = 0; k < set.size(); ++k) {
+        const Point* p = set.begin(k);
+        std::size_t n = set.count(k);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Point& a = p[i];
+            const Point& b = p[i + 1 == n ? 0 : i + 1];
+            piece.clear();
+            for (int s = 0; s < segments; ++s) {
+                double t = 2 * kPi * s / segments;
+                piece.push_back({a.x + std::llround(r * std::cos(t)), a.y + std::llround(r * std::sin(t))});
+            }
+            append_ccw(piece, band);
+            if (a == b) continue;
+            double len = std::hypot(double(b.x - a.x), double(b.y - a.y));
+            Coord nx = std::llround(-double(b.y - a.y) * r / len), ny = std::llround(double(b.x - a.x) * r / len);
+            piece = {{a.x + nx, a.y + ny}, {a.x - nx, a.y - ny}, {b.x - nx, b.y - ny}, {b.x + nx, b.y + ny}};
+            append_ccw(piece, band);
+        }
+    }
+    return boolean(set, band, delta > 0 ? Op::Union : Op::Difference);
+}
+
+double area(const PolygonSet& set) {
+    double a2 = 0;
+    for (std::size_t k = 0; k < set.size(); ++k) a2 += gerber::signed_area2(set.begin(k), set.count(k));
+    return a2 / 2;
+}
+
+} // namespace pwb::poly
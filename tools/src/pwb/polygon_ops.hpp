@@ -0,0 +1,34 @@
+#pragma once
+
+#include "pwb/gerber_outline.hpp"
+
+#include <vector>
+
+namespace pwb::poly {
+
+using gerber::Coord;
+using gerber::Point;
+using gerber::PolygonSet;
+
+enum class Op { Union, Intersection, Difference, Xor };
+
+// Boolean of two polygon sets under the non-zero rule (the Gerber fill rule).
+// Inputs may self-intersect, overlap, share edges or touch; the result has
+// counter-clockwise outer contours, clockwise holes, no crossings and no
+// collinear vertices. Intersection points are rounded to the nanometre grid.
+PolygonSet boolean(const PolygonSet& subject, const PolygonSet& clip, Op op);
+
+// Union of the contours of one set (resolves overlaps and self-intersections).
+PolygonSet merge(const PolygonSet& set);
+
+// Gerber %LP% levels in order: dark levels are added, clear ones subtracted.
+PolygonSet flatten(const std::vector<PolygonSet>& levels, const std::vector<bool>& clear);
+
+// Grows (delta > 0) or shrinks (delta < 0) the filled area by |delta| with
+// round corners flattened to within `tolerance`.
+PolygonSet offset(const PolygonSet& set, Coord delta, Coord tolerance);
+
+// Filled area in nm², holes subtracted.
+double area(const PolygonSet& set);
+
+} // namespace pwb::poly
@@ -0,0 +1,238 @@
+#include "pwb/printability.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/raycast.hpp"
+#include "pwb/surface_distance.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace pwb::printability {
+
+namespace {
+
+// One face met by one column of the height field.
+struct Column {
+    std::uint32_t i;  // cell along x
+    float z;
+    std::uint8_t overhang; // 1: needs support, 0: an upward face support can stand on
+};
+
+bool by_column(const Column& a, const Column& b) { return a.i != b.i ? a.i < b.i : a.z < b.z; }
+
+bool better(const Orientation& a, const Orientation& b) {
+    const double va = std::round(a.support.volume), vb = std::round(b.support.volume); // to 1 mm^3
+    return va != vb ? va < vb : a.support.height < b.support.height;
+}
+
+} // namespace
+
+mesh::Mesh place(const mesh::Mesh& mesh, const Vec3& down) {
+    // Rotation taking d onto -Z (Rodrigues, with v = d x -Z and c = d . -Z).
+    const double n = std::sqrt(double(down.x) * down.x + double(down.y) * down.y + double(down.z) * down.z);
+    const D3 d{down.x / n, down.y / n, down.z / n};
+    double r[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    const double c = -d.z;
+    if (c < -1 + 1e-12) { // d is +Z: half a turn about X
+        r[1][1] = r[2][2] = -1;
+    } else {
+        const D3 v{-d.y, d.x, 0};
+        const double k[3][3] = {{0, -v.z, v.y}, {v.z, 0, -v.x}, {-v.y, v.x, 0}};
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) {
+                double k2 = 0;
+                for (int m = 0; m < 3; ++m) k2 += k[i][m] * k[m][j];
+                r[i][j] += k[i][j] + k2 / (1 + c);
+            }
+    }
+    mesh::Mesh out;
+    out.triangles = mesh.triangles;
+    out.vertices.reserve(mesh.vertices.size());
+    double low = 1e300;
+    for (const Vec3& v : mesh.vertices) {
+        const D3 p{r[0][0] * v.x + r[0][1] * v.y + r[0][2] * v.z, r[1][0] * v.x + r[1][1] * v.y + r[1][2] * v.z,
+                   r[2][0] * v.x + r[2][1] * v.y + r[2][2] * v.z};
+        out.vertices.push_back({float(p.x), float(p.y), float(p.z)});
+        low = std::min(low, p.z);
+    }
+    for (Vec3& v : out.vertices) v.z = float(v.z - low);
+    return out;
+}
+
+Support support(const mesh::Mesh& m, const Options& o) {
+    Support s;
+    if (m.triangles.empty()) return s;
+    D3 lo{1e300, 1e300, 1e300}, hi{-1e300, -1e300, -1e300};
+    for (const Vec3& v : m.vertices) {
+        lo = {std::min(lo.x, double(v.x)), std::min(lo.y, double(v.y)), std::min(lo.z, double(v.z))};
+        hi = {std::max(hi.x, double(v.x)), std::max(hi.y, double(v.y)), std::max(hi.z, double(v.z))};
+    }
+    s.height = hi.z - lo.z;
+    const double cell = o.cell;
+    const std::size_t nx = std::size_t(std::ceil((hi.x - lo.x) / cell)) + 1, ny = std::size_t(std::ceil((hi.y - lo.y) / cell)) + 1;
+    const double steep = std::sin(o.overhang_angle * kPi / 180);
+
+    // Faces that matter, binned by the bands of rows they cross.
+    const std::size_t rows_per_band = 8, bands = (ny + rows_per_band - 1) / rows_per_band;
+    std::vector<std::vector<std::uint32_t>> bins(bands);
+    std::vector<std::uint8_t> kind(m.triangles.size());
+    for (std::size_t t = 0; t < m.triangles.size(); ++t) {
+        const mesh::Triangle& tri = m.triangles[t];
+        const D3 a = d3(m.vertices[tri[0]]), b = d3(m.vertices[tri[1]]), c = d3(m.vertices[tri[2]]);
+        const D3 n = cross(sub(b, a), sub(c, a));
+        const double len = std::sqrt(dot(n, n)), area = 0.5 * len;
+        if (len == 0) continue;
+        if (std::max({a.z, b.z, c.z}) <= lo.z + o.bed_tolerance) {
+            s.contact += area;
+            continue;
+        }
+        const double nz = n.z / len;
+        if (nz < -steep) kind[t] = 1, s.overhang_area += area;
+        else if (nz > 1e-6) kind[t] = 0;
+        else continue;
+        const double y0 = std::min({a.y, b.y, c.y}) - lo.y, y1 = std::max({a.y, b.y, c.y}) - lo.y;
+        const std::size_t r0 = std::size_t(std::max(0.0, std::ceil(y0 / cell - 0.5)));
+        const std::size_t r1 = std::min(ny - 1, std::size_t(std::max(0.0, std::floor(y1 / cell - 0.5))));
+        if (r0 > r1) continue;
+        for (std::size_t band = r0 / rows_per_band; band <= r1 / rows_per_band; ++band) bins[band].push_back(std::uint32_t(t));
+    }
+
+    std::vector<double> volume(bands);
+    parallel_for(
+        bands,
+        [&](std::size_t band) {
+            std::vector<Column> entries;
+            for (std::size_t row = band * rows_per_band; row < std::min(ny, (band + 1) * rows_per_band); ++row) {
+                const double y = lo.y + (double(row) + 0.5) * cell;
+                entries.clear();
+                for (std::uint32_t t : bins[band]) {
+                    const mesh::Triangle& tri = m.triangles[t];
+                    const D3 p[3] = {d3(m.vertices[tri[0]]), d3(m.vertices[tri[1]]), d3(m.vertices[tri[2]])};
+                    // Half-open crossings, so a row through a shared vertex counts each face once.
+                    double x0 = 1e300, x1 = -1e300;
+                    for (int k = 0; k < 3; ++k) {
+                        const D3& u = p[k];
+                        const D3& v = p[(k + 1) % 3];
+                        if ((u.y <= y) == (v.y <= y)) continue;
+                        const double x = u.x + (y - u.y) * (v.x - u.x) / (v.y - u.y);
+                        x0 = std::min(x0, x), x1 = std::max(x1, x);
+                    }
+                    if (x0 > x1) continue;
+                    const std::size_t i0 = std::size_t(std::max(0.0, std::ceil((x0 - lo.x) / cell - 0.5)));
+                    const std::size_t i1 = std::size_t(std::max(0.0, std::ceil((x1 - lo.x) / cell - 0.5)));
+                    const D3 n = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+                    const double zmin = std::min({p[0].z, p[1].z, p[2].z}), zmax = std::max({p[0].z, p[1].z, p[2].z});
+                    for (std::size_t i = i0; i < std::min(i1, nx); ++i) {
+                        const double x = lo.x + (double(i) + 0.5) * cell;
+                        const double z = p[0].z - (n.x * (x - p[0].x) + n.y * (y - p[0].y)) / n.z;
+                        entries.push_back({std::uint32_t(i), float(std::clamp(z, zmin, zmax)), kind[t]});
+                    }
+                }
+                std::sort(entries.begin(), entries.end(), by_column);
+                // Up each column: support fills from the last floor (or the bed) to each overhang.
+                double floor = lo.z;
+                for (std::size_t e = 0; e < entries.size(); ++e) {
+                    if (e == 0 || entries[e].i != entries[e - 1].i) floor = lo.z;
+                    if (entries[e].overhang) volume[band] += std::max(0.0, double(entries[e].z) - floor);
+                    floor = entries[e].z;
+                }
+            }
+            volume[band] *= cell * cell;
+        },
+        o.threads);
+    for (double v : volume) s.volume += v;
+    return s;
+}
+
+Walls walls(const mesh::Mesh& m, const Options& o) {
+    Walls w;
+    if (m.triangles.empty()) return w;
+    ray::Scene scene;
+    scene.add(m);
+    scene.build();
+    const double spacing = o.wall_spacing > 0 ? o.wall_spacing : o.nozzle;
+    std::vector<std::uint32_t> owner;
+    const std::vector<Vec3> points = dist::sample_area(m, float(spacing), &owner);
+    std::vector<Vec3> normals(m.triangles.size());
+    for (std::size_t t = 0; t < m.triangles.size(); ++t) {
+        const mesh::Triangle& tri = m.triangles[t];
+        const D3 a = d3(m.vertices[tri[0]]);
+        const D3 n = cross(sub(d3(m.vertices[tri[1]]), a), sub(d3(m.vertices[tri[2]]), a));
+        const double len = std::sqrt(dot(n, n));
+        if (len > 0) normals[t] = {float(n.x / len), float(n.y / len), float(n.z / len)};
+    }
+
+    struct Block {
+        std::size_t samples = 0, below_nozzle = 0, below_min = 0;
+        double thinnest = 1e300;
+        Vec3 at;
+    };
+    const std::size_t block = 2048, blocks = (points.size() + block - 1) / block;
+    std::vector<Block> partial(blocks);
+    const float eps = 1e-3f; // mm, off the face the ray starts from
+    parallel_for(
+        blocks,
+        [&](std::size_t k) {
+            Block& b = partial[k];
+            for (std::size_t i = k * block; i < std::min(points.size(), (k + 1) * block); ++i) {
+                const Vec3& n = normals[owner[i]];
+                const Vec3& p = points[i];
+                const ray::Hit hit = scene.intersect({{p.x - eps * n.x, p.y - eps * n.y, p.z - eps * n.z}, {-n.x, -n.y, -n.z}});
+                if (hit.triangle == mesh::kNone) continue; // open surface
+                // Only a far side facing back within 60 degrees is a wall; near
+                // corners the ray leaves through a neighbouring face instead.
+                const Vec3& far = normals[hit.triangle];
+                if (far.x * n.x + far.y * n.y + far.z * n.z > -0.5f) continue;
+                const double t = double(hit.t) + eps;
+                ++b.samples;
+                if (t < o.nozzle) ++b.below_nozzle;
+                if (t < o.min_wall) ++b.below_min;
+                if (t < b.thinnest) b.thinnest = t, b.at = p;
+            }
+        },
+        o.threads);
+    double thinnest = 1e300;
+    for (const Block& b : partial) {
+        w.samples += b.samples;
+        w.below_nozzle += double(b.below_nozzle) * spacing * spacing;
+        w.below_min += double(b.below_min) * spacing * spacing;
+        if (b.thinnest < thinnest) thinnest = b.thinnest, w.thinnest_at = b.at;
+    }
+    w.thinnest = w.samples ? thinnest : 0;
+    return w;
+}
+
+std::vector<Orientation> orientations(const mesh::Mesh& mesh, std::size_t count, std::size_t refine, const Options& o) {
+    std::vector<Orientation> all;
+    for (const Vec3& axis : {Vec3{0, 0, -1}, Vec3{0, 0, 1}, Vec3{1, 0, 0}, Vec3{-1, 0, 0}, Vec3{0, 1, 0}, Vec3{0, -1, 0}})
+        all.push_back({axis, {}});
+    const double golden = kPi * (3 - std::sqrt(5.0));
+    for (std::size_t i = 0; i < count; ++i) {
+        const double z = 1 - (2 * double(i) + 1) / double(count), r = std::sqrt(1 - z * z), phi = golden * double(i);
+        all.push_back({{float(r * std::cos(phi)), float(r * std::sin(phi)), float(z)}, {}});
+    }
+    if (mesh.triangles.empty()) return all;
+
+    // A coarse grid for the sweep: about 80 cells across the part.
+    D3 lo{1e300, 1e300, 1e300}, hi{-1e300, -1e300, -1e300};
+    for (const Vec3& v : mesh.vertices) {
+        lo = {std::min(lo.x, double(v.x)), std::min(lo.y, double(v.y)), std::min(lo.z, double(v.z))};
+        hi = {std::max(hi.x, double(v.x)), std::max(hi.y, double(v.y)), std::max(hi.z, double(v.z))};
+    }
+    Options coarse = o;
+    coarse.threads = 1;
+    coarse.cell = std::max(o.cell, std::sqrt(dot(sub(hi, lo), sub(hi, lo))) / 80);
+    parallel_for(all.size(), [&](std::size_t i) { all[i].support = support(place(mesh, all[i].down), coarse); }, o.threads);
+    std::sort(all.begin(), all.end(), better);
+
+    all.resize(std::min(all.size(), std::max<std::size_t>(1, refine)));
+    Options fine = o;
+    fine.threads = 1;
+    parallel_for(all.size(), [&](std::size_t i) { all[i].support = support(place(mesh, all[i].down), fine); }, o.threads);
+    std::sort(all.begin(), all.end(), better);
+    return all;
+}
+
+} // namespace pwb::printability
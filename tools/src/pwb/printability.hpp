@@ -0,0 +1,66 @@
+#pragma once
+
+#include "pwb/mesh.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace pwb::printability {
+
+using stl::Vec3;
+
+struct Options {
+    double overhang_angle = 45; // degrees from vertical a downward face may lean before it needs support
+    double min_wall = 0.8;      // mm: two 0.4 mm lines
+    double nozzle = 0.4;        // mm: walls thinner than one line do not print at all
+    double cell = 0.5;          // height-field grid, mm
+    double wall_spacing = 0;    // mm between wall-thickness samples; 0 = nozzle
+    double bed_tolerance = 0.05; // faces this close to the bed rest on it
+    unsigned threads = 0;       // 0 = all cores
+};
+
+// `mesh` turned so that `down` (a unit vector in the part's own frame) points
+// to -Z, then lifted to rest on z = 0. Turns about Z are left out: support
+// does not depend on them.
+mesh::Mesh place(const mesh::Mesh& mesh, const Vec3& down);
+
+struct Support {
+    double overhang_area = 0; // mm^2 of faces steeper than the overhang angle, off the bed
+    double volume = 0;        // mm^3 of space between those faces and what lies below them
+    double height = 0;        // build height, mm
+    double contact = 0;       // mm^2 of faces on the bed
+};
+
+// Support for a placed part. Every face steeper than the overhang angle is
+// projected straight down a height field of `cell` columns to the nearest
+// upward face below it, or to the bed; the column heights are summed.
+// Columns are rasterised in parallel bands of rows.
+Support support(const mesh::Mesh& placed, const Options& options = {});
+
+struct Walls {
+    std::size_t samples = 0;   // rays that measured a wall
+    double thinnest = 0;       // mm, over samples that hit the far side
+    double below_nozzle = 0;   // mm^2 of surface over material thinner than one line
+    double below_min = 0;      // mm^2 thinner than min_wall (including below_nozzle)
+    Vec3 thinnest_at;          // where the thinnest sample sits
+};
+
+// Wall thickness measured by casting a ray from points spread over the
+// surface straight inwards through a BVH of the part and taking the distance
+// to the first face it meets, when that face looks back the other way (so
+// rays that leave through a side face near an edge do not count).
+Walls walls(const mesh::Mesh& mesh, const Options& options = {});
+
+struct Orientation {
+    Vec3 down;        // part-frame direction that goes onto the bed
+    Support support;
+};
+
+// Support for `count` directions spread evenly over the sphere (Fibonacci
+// lattice) plus the six axis directions, evaluated in parallel on a coarse
+// grid; the best `refine` are evaluated again at `options.cell` and returned,
+// least support volume first, then lowest build height.
+std::vector<Orientation> orientations(const mesh::Mesh& mesh, std::size_t count = 500, std::size_t refine = 8,
+                                      const Options& options = {});
+
+} // namespace pwb::printability
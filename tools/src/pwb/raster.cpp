@@ -0,0 +1,319 @@
+#include "pwb/raster.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace pwb::raster {
+
+namespace {
+
+using gerber::Box;
+using gerber::Coord;
+using gerber::PolygonSet;
+
+constexpr int kSubScanlines = 4;
+constexpr int kFullSpan = 64; // coverage of one fully covered pixel on one sub-scanline
+
+// Non-horizontal polygon edge in pixel space, stored from its top (lowest y).
+struct Edge {
+    float x_top;
+    float y_top;
+    float y_bot;
+    float dxdy;
+    int dir;
+};
+
+struct LevelEdges {
+    bool clear = false;
+    std::vector<Edge> edges;
+    std::vector<std::vector<std::uint32_t>> tiles; // edge indices overlapping each tile
+};
+
+// Active edge table. Edge data lives in structure-of-arrays slots so that
+// crossings can be evaluated eight at a time; `order` lists the slots sorted
+// by crossing, which changes little from one scanline to the next.
+struct ActiveEdges {
+    std::vector<float> x_top, y_top, y_bot, dxdy, x;
+    std::vector<int> dir;
+    std::vector<std::uint32_t> order;
+    std::vector<std::uint32_t> remap;
+
+    std::size_t size() const { return x.size(); }
+    void clear() {
+        x_top.clear(), y_top.clear(), y_bot.clear(), dxdy.clear(), x.clear(), dir.clear(), order.clear();
+    }
+
+    // Adds an edge at its sorted position for scanline y.
+    void insert(const Edge& e, float y) {
+        float xe = e.x_top + (y - e.y_top) * e.dxdy;
+        auto slot = static_cast<std::uint32_t>(size());
+        x_top.push_back(e.x_top), y_top.push_back(e.y_top), y_bot.push_back(e.y_bot);
+        dxdy.push_back(e.dxdy), x.push_back(xe), dir.push_back(e.dir);
+        auto at = std::upper_bound(order.begin(), order.end(), xe, [this](float v, std::uint32_t s) { return v < x[s]; });
+        order.insert(at, slot);
+    }
+
+    // Drops edges that end at or above scanline y.
+    void retire(float y) {
+        const std::size_t n = size();
+        remap.resize(n);
+        std::uint32_t kept = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (y_bot[i] > y) {
+                if (kept != i) {
+                    x_top[kept] = x_top[i], y_top[kept] = y_top[i], y_bot[kept] = y_bot[i];
+                    dxdy[kept] = dxdy[i], x[kept] = x[i], dir[kept] = dir[i];
+                }
+                remap[i] = kept++;
+            } else {
+                remap[i] = UINT32_MAX;
+            }
+        }
+        if (kept == n) return;
+        x_top.resize(kept), y_top.resize(kept), y_bot.resize(kept), dxdy.resize(kept), x.resize(kept), dir.resize(kept);
+        std::size_t o = 0;
+        for (std::uint32_t s : order)
+            if (remap[s] != UINT32_MAX) order[o++] = remap[s];
+        order.resize(o);
+    }
+
+    void sort_by_x() {
+        for (std::size_t i = 1; i < order.size(); ++i) {
+            std::uint32_t s = order[i];
+            float xs = x[s];
+            std::size_t j = i;
+            for (; j > 0 && x[order[j - 1]] > xs; --j) order[j] = order[j - 1];
+            order[j] = s;
+        }
+    }
+};
+
+void crossings_scalar(ActiveEdges& a, float y) {
+    for (std::size_t i = 0; i < a.size(); ++i) a.x[i] = a.x_top[i] + (y - a.y_top[i]) * a.dxdy[i];
+}
+
+void fill_scalar(std::uint16_t* acc, int from, int to) {
+    for (int i = from; i < to; ++i) acc[i] = static_cast<std::uint16_t>(acc[i] + kFullSpan);
+}
+
+void pack_scalar(const std::uint16_t* acc, std::uint8_t* out, int n) {
+    for (int i = 0; i < n; ++i) out[i] = static_cast<std::uint8_t>(acc[i] > 255 ? 255 : acc[i]);
+}
+
+#if PWB_HAVE_AVX2
+PWB_TARGET_AVX2 void crossings_avx2(ActiveEdges& a, float y) {
+    const std::size_t n = a.size();
+    const __m256 vy = _mm256_set1_ps(y);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dy = _mm256_sub_ps(vy, _mm256_loadu_ps(a.y_top.data() + i));
+        __m256 x = _mm256_fmadd_ps(dy, _mm256_loadu_ps(a.dxdy.data() + i), _mm256_loadu_ps(a.x_top.data() + i));
+        _mm256_storeu_ps(a.x.data() + i, x);
+    }
+    for (; i < n; ++i) a.x[i] = a.x_top[i] + (y - a.y_top[i]) * a.dxdy[i];
+}
+
+PWB_TARGET_AVX2 void fill_avx2(std::uint16_t* acc, int from, int to) {
+    const __m256i full = _mm256_set1_epi16(kFullSpan);
+    int i = from;
+    for (; i + 16 <= to; i += 16) {
+        __m256i* p = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(p, _mm256_add_epi16(_mm256_loadu_si256(p), full));
+    }
+    for (; i < to; ++i) acc[i] = static_cast<std::uint16_t>(acc[i] + kFullSpan);
+}
+
+PWB_TARGET_AVX2 void pack_avx2(const std::uint16_t* acc, std::uint8_t* out, int n) {
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i + 16));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    pack_scalar(acc + i, out + i, n - i);
+}
+#endif
+
+struct Kernels {
+    void (*crossings)(ActiveEdges&, float);
+    void (*fill)(std::uint16_t*, int, int);
+    void (*pack)(const std::uint16_t*, std::uint8_t*, int);
+};
+
+Kernels pick_kernels(bool simd) {
+#if PWB_HAVE_AVX2
+    if (simd && cpu_has_avx2()) return {crossings_avx2, fill_avx2, pack_avx2};
+#endif
+    (void)simd;
+    return {crossings_scalar, fill_scalar, pack_scalar};
+}
+
+void add_span(std::uint16_t* acc, int width, float xa, float xb, const Kernels& k) {
+    xa = std::max(xa, 0.0f);
+    xb = std::min(xb, float(width));
+    if (xb <= xa) return;
+    int ia = int(xa), ib = int(xb);
+    if (ia == ib) {
+        acc[ia] = static_cast<std::uint16_t>(acc[ia] + int((xb - xa) * kFullSpan + 0.5f));
+        return;
+    }
+    acc[ia] = static_cast<std::uint16_t>(acc[ia] + int((float(ia + 1) - xa) * kFullSpan + 0.5f));
+    k.fill(acc, ia + 1, ib);
+    if (ib < width) acc[ib] = static_cast<std::uint16_t>(acc[ib] + int((xb - float(ib)) * kFullSpan + 0.5f));
+}
+
+LevelEdges build_edges(const PolygonSet& set, const Bitmap& bmp, int tile_rows, int tiles) {
+    LevelEdges level;
+    const double inv = 1.0 / double(bmp.pixel);
+    for (std::size_t c = 0; c < set.size(); ++c) {
+        const gerber::Point* p = set.begin(c);
+        std::size_t n = set.count(c);
+        for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+            double x0 = double(p[j].x - bmp.origin_x) * inv, y0 = double(p[j].y - bmp.origin_y) * inv;
+            double x1 = double(p[i].x - bmp.origin_x) * inv, y1 = double(p[i].y - bmp.origin_y) * inv;
+            if (y0 == y1) continue;
+            int dir = y1 > y0 ? 1 : -1;
+            if (y0 > y1) std::swap(x0, x1), std::swap(y0, y1);
+            if (y1 <= 0.0 || y0 >= double(bmp.height)) continue;
+            double dxdy = (x1 - x0) / (y1 - y0);
+            level.edges.push_back({float(x0), float(y0), float(y1), float(dxdy), dir});
+        }
+    }
+    level.tiles.resize(tiles);
+    for (std::size_t i = 0; i < level.edges.size(); ++i) {
+        const Edge& e = level.edges[i];
+        int t0 = std::max(0, int(std::floor(e.y_top)) / tile_rows);
+        int t1 = std::min(tiles - 1, int(std::ceil(e.y_bot)) / tile_rows);
+        for (int t = t0; t <= t1; ++t) level.tiles[t].push_back(static_cast<std::uint32_t>(i));
+    }
+    return level;
+}
+
+// Scan-converts one level over rows [row0, row1) into `out` (row-major, bitmap width).
+void scan_level(const LevelEdges& level, int tile, int row0, int row1, int width, const Kernels& k,
+                ActiveEdges& active, std::vector<Edge>& list, std::vector<std::uint16_t>& acc, std::uint8_t* out) {
+    // Sorting per tile rather than once globally keeps the sort parallel and
+    // each list small.
+    list.clear();
+    for (std::uint32_t i : level.tiles[tile]) list.push_back(level.edges[i]);
+    std::sort(list.begin(), list.end(), [](const Edge& a, const Edge& b) { return a.y_top < b.y_top; });
+    std::size_t next = 0;
+    active.clear();
+    for (int r = row0; r < row1; ++r) {
+        std::fill(acc.begin(), acc.end(), std::uint16_t(0));
+        for (int s = 0; s < kSubScanlines; ++s) {
+            const float y = float(r) + (float(s) + 0.5f) / kSubScanlines;
+            active.retire(y);
+            if (active.size() > 0) {
+                k.crossings(active, y);
+                active.sort_by_x();
+            }
+            while (next < list.size() && list[next].y_top <= y) {
+                const Edge& e = list[next++];
+                if (e.y_bot > y) active.insert(e, y);
+            }
+            if (active.size() == 0) continue;
+
+            int winding = 0;
+            float start = 0.0f;
+            for (std::uint32_t slot : active.order) {
+                int before = winding;
+                winding += active.dir[slot];
+                if (before == 0 && winding != 0) start = active.x[slot];
+                else if (before != 0 && winding == 0) add_span(acc.data(), width, start, active.x[slot], k);
+            }
+        }
+        k.pack(acc.data(), out + std::size_t(r - row0) * std::size_t(width), width);
+    }
+}
+
+Bitmap run(const std::vector<PolygonSet>& levels, const std::vector<bool>& clear, Box window, const Options& opt) {
+    if (opt.pixel <= 0) throw std::invalid_argument("raster: pixel size must be positive");
+    Bitmap bmp;
+    bmp.pixel = opt.pixel;
+    if (window.empty()) {
+        for (const PolygonSet& s : levels)
+            for (const gerber::Point& p : s.points) window.add(p.x, p.y);
+        if (window.empty()) return bmp;
+        window.min_x -= 2 * opt.pixel, window.min_y -= 2 * opt.pixel;
+        window.max_x += 2 * opt.pixel, window.max_y += 2 * opt.pixel;
+    }
+    bmp.origin_x = window.min_x;
+    bmp.origin_y = window.min_y;
+    bmp.width = int((window.width() + opt.pixel - 1) / opt.pixel);
+    bmp.height = int((window.height() + opt.pixel - 1) / opt.pixel);
+    bmp.pixels.assign(std::size_t(bmp.width) * std::size_t(bmp.height), 0);
+    if (bmp.width == 0 || bmp.height == 0) return bmp;
+
+    const int tile_rows = std::max(1, opt.tile_rows);
+    const int tiles = (bmp.height + tile_rows - 1) / tile_rows;
+    std::vector<LevelEdges> edges;
+    edges.reserve(levels.size());
+    for (std::size_t l = 0; l < levels.size(); ++l) {
+        edges.push_back(build_edges(levels[l], bmp, tile_rows, tiles));
+        edges.back().clear = l < clear.size() && clear[l];
+    }
+    const Kernels k = pick_kernels(opt.simd);
+
+    parallel_for(std::size_t(tiles), [&](std::size_t t) {
+        const int row0 = int(t) * tile_rows;
+        const int row1 = std::min(bmp.height, row0 + tile_rows);
+        ActiveEdges active;
+        std::vector<Edge> list;
+        std::vector<std::uint16_t> acc(std::size_t(bmp.width) + 1);
+        std::vector<std::uint8_t> scratch;
+        std::uint8_t* out = bmp.row(row0);
+        bool first = true;
+        for (const LevelEdges& level : edges) {
+            if (level.tiles[t].empty()) continue;
+            if (first && !level.clear) {
+                scan_level(level, int(t), row0, row1, bmp.width, k, active, list, acc, out);
+                first = false;
+                continue;
+            }
+            std::size_t n = std::size_t(row1 - row0) * std::size_t(bmp.width);
+            scratch.resize(n);
+            scan_level(level, int(t), row0, row1, bmp.width, k, active, list, acc, scratch.data());
+            if (level.clear) {
+                for (std::size_t i = 0; i < n; ++i) out[i] = out[i] > scratch[i] ? std::uint8_t(out[i] - scratch[i]) : 0;
+            } else {
+                for (std::size_t i = 0; i < n; ++i) {
+                    unsigned v = unsigned(out[i]) + scratch[i];
+                    out[i] = std::uint8_t(v > 255 ? 255 : v);
+                }
+            }
+            first = false;
+        }
+    }, opt.threads);
+    return bmp;
+}
+
+} // namespace
+
+void Bitmap::write_pgm(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("cannot write " + path);
+    std::fprintf(f, "P5\n%d %d\n255\n", width, height);
+    for (int r = height - 1; r >= 0; --r) std::fwrite(row(r), 1, std::size_t(width), f);
+    std::fclose(f);
+}
+
+Bitmap rasterise(const gerber::Layer& layer, const Options& options) {
+    Coord tolerance = std::max<Coord>(options.pixel / 8, 100);
+    std::vector<PolygonSet> levels = gerber::layer_outlines(layer, tolerance);
+    std::vector<bool> clear;
+    for (const gerber::Level& l : layer.levels) clear.push_back(l.polarity == gerber::Polarity::Clear);
+    return run(levels, clear, options.window, options);
+}
+
+Bitmap rasterise(const std::vector<PolygonSet>& levels, const std::vector<bool>& clear, const Options& options) {
+    return run(levels, clear, options.window, options);
+}
+
+} // namespace pwb::raster
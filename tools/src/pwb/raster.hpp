@@ -0,0 +1,49 @@
+#pragma once
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pwb::raster {
+
+// 8-bit coverage image. Row 0 is the bottom of the window (Gerber y grows up);
+// pixel (c, r) covers [origin + c * pixel, origin + (c + 1) * pixel) in x and
+// likewise in y.
+struct Bitmap {
+    int width = 0;
+    int height = 0;
+    gerber::Coord origin_x = 0;
+    gerber::Coord origin_y = 0;
+    gerber::Coord pixel = 0;
+    std::vector<std::uint8_t> pixels;
+
+    std::uint8_t* row(int r) { return pixels.data() + std::size_t(r) * std::size_t(width); }
+    const std::uint8_t* row(int r) const { return pixels.data() + std::size_t(r) * std::size_t(width); }
+    double megapixels() const { return double(width) * double(height) * 1e-6; }
+
+    // Binary PGM, top row first, for eyeballing layers.
+    void write_pgm(const std::string& path) const;
+};
+
+struct Options {
+    gerber::Coord pixel = 10'000;   // 10 µm
+    gerber::Box window;             // empty = layer bounds
+    int tile_rows = 64;             // scanlines per parallel tile
+    unsigned threads = 0;           // 0 = all cores
+    bool simd = true;               // use AVX2 kernels when the CPU has them
+};
+
+// Scanline coverage fill: 4 sub-scanlines per row with exact horizontal span
+// ends, non-zero winding within a level, dark levels added and clear levels
+// subtracted in file order.
+Bitmap rasterise(const gerber::Layer& layer, const Options& options = {});
+
+// Same, for polygon levels that did not come from a Gerber file (e.g. EAGLE
+// board geometry). `clear` marks which levels subtract.
+Bitmap rasterise(const std::vector<gerber::PolygonSet>& levels, const std::vector<bool>& clear,
+                 const Options& options);
+
+} // namespace pwb::raster
@@ -0,0 +1,279 @@
+#include "pwb/raycast.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pwb::ray {
+
+namespace {
+
+using Tri = Scene::Tri;
+
+constexpr std::size_t kChunk = 4096; // rays per parallel task
+
+// Zero direction components become tiny ones so slab tests never see 0 * inf.
+float safe_inverse(float d) { return 1.0f / (std::fabs(d) > 1e-20f ? d : std::copysign(1e-20f, d)); }
+
+struct Prepared {
+    float o[3], d[3], inv[3], tmax;
+};
+
+Prepared prepare(const Ray& r) {
+    return {{r.origin.x, r.origin.y, r.origin.z},
+            {r.dir.x, r.dir.y, r.dir.z},
+            {safe_inverse(r.dir.x), safe_inverse(r.dir.y), safe_inverse(r.dir.z)},
+            r.tmax};
+}
+
+// Entry distance of the ray into `box`, or +inf when it misses within (0, tmax).
+float slab(const bvh::Aabb& box, const Prepared& p, float tmax) {
+    const float lo[3] = {box.min.x, box.min.y, box.min.z}, hi[3] = {box.max.x, box.max.y, box.max.z};
+    float tn = 0, tf = tmax;
+    for (int a = 0; a < 3; ++a) {
+        const float t0 = (lo[a] - p.o[a]) * p.inv[a], t1 = (hi[a] - p.o[a]) * p.inv[a];
+        tn = std::max(tn, std::min(t0, t1));
+        tf = std::min(tf, std::max(t0, t1));
+    }
+    return tn <= tf ? tn : 1e30f;
+}
+
+// Möller-Trumbore; returns t in (0, tmax) or +inf.
+float triangle(const Tri& tr, const Prepared& p, float tmax) {
+    const float* d = p.d;
+    const float pv[3] = {d[1] * tr.e2[2] - d[2] * tr.e2[1], d[2] * tr.e2[0] - d[0] * tr.e2[2],
+                         d[0] * tr.e2[1] - d[1] * tr.e2[0]};
+    const float det = tr.e1[0] * pv[0] + tr.e1[1] * pv[1] + tr.e1[2] * pv[2];
+    if (std::fabs(det) < 1e-12f) return 1e30f;
+    const float inv = 1.0f / det;
+    const float tv[3] = {p.o[0] - tr.v0[0], p.o[1] - tr.v0[1], p.o[2] - tr.v0[2]};
+    const float u = (tv[0] * pv[0] + tv[1] * pv[1] + tv[2] * pv[2]) * inv;
+    if (u < 0 || u > 1) return 1e30f;
+    const float qv[3] = {tv[1] * tr.e1[2] - tv[2] * tr.e1[1], tv[2] * tr.e1[0] - tv[0] * tr.e1[2],
+                         tv[0] * tr.e1[1] - tv[1] * tr.e1[0]};
+    const float v = (d[0] * qv[0] + d[1] * qv[1] + d[2] * qv[2]) * inv;
+    if (v < 0 || u + v > 1) return 1e30f;
+    const float t = (tr.e2[0] * qv[0] + tr.e2[1] * qv[1] + tr.e2[2] * qv[2]) * inv;
+    return t > 0 && t < tmax ? t : 1e30f;
+}
+
+// Nearest hit when `any` is false, else stops at the first one.
+Hit trace(const bvh::Tree& tree, const Tri* tris, const Ray& r, bool any) {
+    Hit hit;
+    if (tree.nodes.empty()) return hit;
+    const Prepared p = prepare(r);
+    float best = r.tmax;
+    std::uint32_t stack[64];
+    int top = 0;
+    if (slab(tree.nodes[0].box, p, best) < 1e30f) stack[top++] = 0;
+    while (top) {
+        const bvh::Node& n = tree.nodes[stack[--top]];
+        if (n.count) {
+            for (std::uint32_t i = n.first; i < n.first + n.count; ++i) {
+                const float t = triangle(tris[i], p, best);
+                if (t >= best) continue;
+                best = t;
+                hit = {t, tris[i].id};
+                if (any) return hit;
+            }
+            continue;
+        }
+        // Near child last so it is popped first; its hits shrink `best` for the far one.
+        const float ta = slab(tree.nodes[n.first].box, p, best), tb = slab(tree.nodes[n.first + 1].box, p, best);
+        const std::uint32_t a = n.first, b = n.first + 1;
+        if (ta <= tb) {
+            if (tb < 1e30f) stack[top++] = b;
+            if (ta < 1e30f) stack[top++] = a;
+        } else {
+            if (ta < 1e30f) stack[top++] = a;
+            stack[top++] = b;
+        }
+    }
+    return hit;
+}
+
+std::size_t packet_scalar(const bvh::Tree& tree, const Tri* tris, const Ray* rays, std::size_t n, std::uint8_t* blocked) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        blocked[i] = trace(tree, tris, rays[i], true).triangle != mesh::kNone;
+        count += blocked[i];
+    }
+    return count;
+}
+
+#if PWB_HAVE_AVX2
+struct Packet {
+    __m256 o[3], inv[3], tmax;
+};
+
+// Lanes of `p` whose segment crosses `b`.
+PWB_TARGET_AVX2 inline int box_mask(const bvh::Aabb& b, const Packet& p) {
+    const float lo[3] = {b.min.x, b.min.y, b.min.z}, hi[3] = {b.max.x, b.max.y, b.max.z};
+    __m256 tn = _mm256_setzero_ps(), tf = p.tmax;
+    for (int a = 0; a < 3; ++a) {
+        const __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(lo[a]), p.o[a]), p.inv[a]);
+        const __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(hi[a]), p.o[a]), p.inv[a]);
+        tn = _mm256_max_ps(tn, _mm256_min_ps(t0, t1));
+        tf = _mm256_min_ps(tf, _mm256_max_ps(t0, t1));
+    }
+    return _mm256_movemask_ps(_mm256_cmp_ps(tn, tf, _CMP_LE_OQ));
+}
+
+// Eight rays walk the tree together: a node is entered when any live ray
+// crosses its box, and rays drop out of the packet as soon as they are blocked.
+PWB_TARGET_AVX2 std::size_t packet_avx2(const bvh::Tree& tree, const Tri* tris, const Ray* rays, std::size_t n,
+                                        std::uint8_t* blocked) {
+    alignas(32) float o[3][8], d[3][8], inv[3][8], tmax[8];
+    for (std::size_t i = 0; i < 8; ++i) {
+        const Prepared p = prepare(rays[std::min(i, n - 1)]);
+        for (int a = 0; a < 3; ++a) o[a][i] = p.o[a], d[a][i] = p.d[a], inv[a][i] = p.inv[a];
+        tmax[i] = p.tmax;
+    }
+    Packet pk;
+    for (int a = 0; a < 3; ++a) pk.o[a] = _mm256_load_ps(o[a]), pk.inv[a] = _mm256_load_ps(inv[a]);
+    pk.tmax = _mm256_load_ps(tmax);
+    const __m256 ox = pk.o[0], oy = pk.o[1], oz = pk.o[2], tm = pk.tmax;
+    const __m256 dx = _mm256_load_ps(d[0]), dy = _mm256_load_ps(d[1]), dz = _mm256_load_ps(d[2]);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), eps = _mm256_set1_ps(1e-12f);
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    int live = n >= 8 ? 0xff : (1 << n) - 1;
+    int hit_lanes = 0;
+
+    std::uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top && live) {
+        const bvh::Node& node = tree.nodes[stack[--top]];
+        if (!(box_mask(node.box, pk) & live)) continue;
+        if (!node.count) {
+            stack[top++] = node.first + 1;
+            stack[top++] = node.first;
+            continue;
+        }
+        for (std::uint32_t k = node.first; k < node.first + node.count && live; ++k) {
+            const Tri& tr = tris[k];
+            const __m256 e1x = _mm256_set1_ps(tr.e1[0]), e1y = _mm256_set1_ps(tr.e1[1]), e1z = _mm256_set1_ps(tr.e1[2]);
+            const __m256 e2x = _mm256_set1_ps(tr.e2[0]), e2y = _mm256_set1_ps(tr.e2[1]), e2z = _mm256_set1_ps(tr.e2[2]);
+            const __m256 px = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+            const __m256 py = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+            const __m256 pz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+            const __m256 det = _mm256_fmadd_ps(e1x, px, _mm256_fmadd_ps(e1y, py, _mm256_mul_ps(e1z, pz)));
+            const __m256 inv_det = _mm256_div_ps(one, det);
+            const __m256 tx = _mm256_sub_ps(ox, _mm256_set1_ps(tr.v0[0]));
+            const __m256 ty = _mm256_sub_ps(oy, _mm256_set1_ps(tr.v0[1]));
+            const __m256 tz = _mm256_sub_ps(oz, _mm256_set1_ps(tr.v0[2]));
+            const __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(tx, px, _mm256_fmadd_ps(ty, py, _mm256_mul_ps(tz, pz))), inv_det);
+            const __m256 qx = _mm256_fmsub_ps(ty, e1z, _mm256_mul_ps(tz, e1y));
+            const __m256 qy = _mm256_fmsub_ps(tz, e1x, _mm256_mul_ps(tx, e1z));
+            const __m256 qz = _mm256_fmsub_ps(tx, e1y, _mm256_mul_ps(ty, e1x));
+            const __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(dx, qx, _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dz, qz))), inv_det);
+            const __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(e2x, qx, _mm256_fmadd_ps(e2y, qy, _mm256_mul_ps(e2z, qz))), inv_det);
+            __m256 ok = _mm256_cmp_ps(_mm256_and_ps(det, abs_mask), eps, _CMP_GE_OQ);
+            ok = _mm256_and_ps(ok, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+            ok = _mm256_and_ps(ok, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+            ok = _mm256_and_ps(ok, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+            ok = _mm256_and_ps(ok, _mm256_cmp_ps(t, zero, _CMP_GT_OQ));
+            ok = _mm256_and_ps(ok, _mm256_cmp_ps(t, tm, _CMP_LT_OQ));
+            const int hits = _mm256_movemask_ps(ok) & live;
+            hit_lanes |= hits;
+            live &= ~hits;
+        }
+    }
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        blocked[i] = (hit_lanes >> i) & 1;
+        count += blocked[i];
+    }
+    return count;
+}
+#endif
+
+using PacketFn = std::size_t (*)(const bvh::Tree&, const Tri*, const Ray*, std::size_t, std::uint8_t*);
+
+PacketFn pick_packet(bool simd) {
+#if PWB_HAVE_AVX2
+    if (simd && cpu_has_avx2()) return packet_avx2;
+#endif
+    (void)simd;
+    return packet_scalar;
+}
+
+} // namespace
+
+void Scene::add(const mesh::Mesh& part, const Vec3& offset) {
+    for (const mesh::Triangle& t : part.triangles)
+        for (std::uint32_t v : t) {
+            const Vec3& p = part.vertices[v];
+            corners_.push_back({p.x + offset.x, p.y + offset.y, p.z + offset.z});
+        }
+}
+
+void Scene::add(const stl::TriangleView& part, const Vec3& offset) {
+    for (std::size_t t = 0; t < part.size(); ++t)
+        for (int k = 0; k < 3; ++k) {
+            const Vec3 p = part.vertex(t, k);
+            corners_.push_back({p.x + offset.x, p.y + offset.y, p.z + offset.z});
+        }
+}
+
+void Scene::build(const bvh::BuildOptions& options) {
+    const std::size_t n = triangles();
+    std::vector<bvh::Aabb> boxes(n);
+    for (std::size_t t = 0; t < n; ++t)
+        for (int k = 0; k < 3; ++k) boxes[t].grow(corners_[3 * t + std::size_t(k)]);
+    tree_ = bvh::build(boxes, options);
+    tris_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint32_t id = tree_.items[i];
+        const Vec3 &a = corners_[3 * std::size_t(id)], &b = corners_[3 * std::size_t(id) + 1],
+                   &c = corners_[3 * std::size_t(id) + 2];
+        tris_[i] = {{a.x, a.y, a.z}, {b.x - a.x, b.y - a.y, b.z - a.z}, {c.x - a.x, c.y - a.y, c.z - a.z}, id};
+    }
+}
+
+void Scene::refit(const std::vector<Vec3>& corners) {
+    if (corners.size() != corners_.size()) throw std::invalid_argument("ray: refit with a different triangle count");
+    corners_ = corners;
+    for (std::size_t i = 0; i < tris_.size(); ++i) {
+        const std::uint32_t id = tree_.items[i];
+        const Vec3 &a = corners_[3 * std::size_t(id)], &b = corners_[3 * std::size_t(id) + 1],
+                   &c = corners_[3 * std::size_t(id) + 2];
+        tris_[i] = {{a.x, a.y, a.z}, {b.x - a.x, b.y - a.y, b.z - a.z}, {c.x - a.x, c.y - a.y, c.z - a.z}, id};
+    }
+    tree_.refit([&](std::uint32_t k) {
+        const Vec3* c = &corners_[3 * std::size_t(tris_[k].id)];
+        bvh::Aabb box;
+        box.grow(c[0]), box.grow(c[1]), box.grow(c[2]);
+        return box;
+    });
+}
+
+bool Scene::occluded(const Ray& r) const { return trace(tree_, tris_.data(), r, true).triangle != mesh::kNone; }
+
+Hit Scene::intersect(const Ray& r) const { return trace(tree_, tris_.data(), r, false); }
+
+std::size_t Scene::occluded(const Ray* rays, std::size_t count, std::uint8_t* blocked, const Options& options) const {
+    if (tree_.nodes.empty()) {
+        std::fill(blocked, blocked + count, std::uint8_t(0));
+        return 0;
+    }
+    const PacketFn packet = pick_packet(options.simd);
+    const std::size_t chunks = (count + kChunk - 1) / kChunk;
+    std::vector<std::size_t> found(chunks, 0);
+    parallel_for(
+        chunks,
+        [&](std::size_t c) {
+            const std::size_t last = std::min(count, (c + 1) * kChunk);
+            for (std::size_t i = c * kChunk; i < last; i += 8)
+                found[c] += packet(tree_, tris_.data(), rays + i, std::min<std::size_t>(8, last - i), blocked + i);
+        },
+        options.threads);
+    std::size_t total = 0;
+    for (std::size_t f : found) total += f;
+    return total;
+}
+
+} // namespace pwb::ray
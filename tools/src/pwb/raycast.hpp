@@ -0,0 +1,70 @@
+#pragma once
+
+#include "pwb/bvh.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/stl.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pwb::ray {
+
+using stl::Vec3;
+
+// Points at origin + t * dir for t in (0, tmax); dir need not be unit length,
+// so a segment from a to b is {a, b - a, 1}.
+struct Ray {
+    Vec3 origin;
+    Vec3 dir;
+    float tmax = 1e30f;
+};
+
+struct Hit {
+    float t = 1e30f;
+    std::uint32_t triangle = mesh::kNone; // index in the order triangles were added
+};
+
+struct Options {
+    unsigned threads = 0;  // 0 = all cores
+    bool simd = true;      // trace packets of 8 rays with AVX2 when the CPU has them
+};
+
+// Triangles from one or more parts, each with its own offset, under a SAH
+// BVH. Triangles are stored in leaf order as (v0, e1, e2) so a leaf is one
+// contiguous read for the Möller-Trumbore test.
+class Scene {
+public:
+    void add(const mesh::Mesh& part, const Vec3& offset = {});
+    void add(const stl::TriangleView& part, const Vec3& offset = {});
+    // Must be called after the last add() and before tracing.
+    void build(const bvh::BuildOptions& options = {});
+    // Moves the triangles to `corners` (3 per triangle, in the order they
+    // were added, offsets applied) and refits the built BVH to them.
+    void refit(const std::vector<Vec3>& corners);
+
+    std::size_t triangles() const { return corners_.size() / 3; }
+    const bvh::Tree& tree() const { return tree_; }
+    std::size_t bytes() const { return tree_.bytes() + tris_.size() * sizeof(Tri); }
+
+    // Any hit in (0, tmax).
+    bool occluded(const Ray& r) const;
+    // Nearest hit in (0, tmax); Hit::triangle is kNone on a miss.
+    Hit intersect(const Ray& r) const;
+    // blocked[i] = 1 when rays[i] is occluded. Consecutive rays travel as a
+    // packet of 8, so bundles should be ordered for coherence. Returns the
+    // number of blocked rays.
+    std::size_t occluded(const Ray* rays, std::size_t count, std::uint8_t* blocked, const Options& options = {}) const;
+
+    struct Tri {
+        float v0[3], e1[3], e2[3];
+        std::uint32_t id;
+    };
+
+private:
+    std::vector<Vec3> corners_; // 3 per triangle, offsets applied
+    bvh::Tree tree_;
+    std::vector<Tri> tris_;     // leaf order
+};
+
+} // namespace pwb::ray
@@ -0,0 +1,298 @@
+#include "pwb/sdf.hpp"
+
+#include "pwb/parallel.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace pwb::sdf {
+
+namespace {
+
+// Cube corners are numbered x | y << 1 | z << 2; a cube edge is its lower
+// corner and an axis. The faces list their corners anticlockwise seen from
+// outside the cube.
+constexpr int kFaces[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+
+struct Lattice {
+    Vec3 lo;
+    float cell = 0;
+    std::size_t nx = 0, ny = 0, nz = 0; // points per axis
+
+    std::uint64_t index(std::size_t i, std::size_t j, std::size_t k) const { return (std::uint64_t(k) * ny + j) * nx + i; }
+    Vec3 point(double i, double j, double k) const {
+        return {float(lo.x + i * cell), float(lo.y + j * cell), float(lo.z + k * cell)};
+    }
+};
+
+// Vertices and triangles of one row of bricks; vertices carry the key of the
+// lattice edge they sit on.
+struct Row {
+    std::vector<Vec3> vertices;
+    std::vector<std::uint64_t> keys;
+    std::vector<mesh::Triangle> triangles; // row-local vertex numbers
+    std::size_t evaluations = 0, empty = 0;
+};
+
+struct Brick {
+    std::size_t i0, j0, k0;    // first lattice point
+    std::size_t ni, nj, nk;    // points per axis (cells + 1)
+    std::vector<float> value;  // ni * nj * nk
+    std::vector<std::uint32_t> slot; // per local point and direction: row vertex, or kNone
+
+    std::size_t at(std::size_t i, std::size_t j, std::size_t k) const { return (k * nj + j) * ni + i; }
+};
+
+// Point on the cube edge from corner c along `axis` where the field crosses
+// zero. Interpolated from the lower end, so every brick that meets the edge
+// computes the same bits.
+std::uint32_t crossing(const Lattice& lat, Brick& br, Row& row, int c, int axis, std::size_t ci, std::size_t cj,
+                       std::size_t ck) {
+    const std::size_t ai = ci + (c & 1), aj = cj + (c >> 1 & 1), ak = ck + (c >> 2 & 1);
+    const std::size_t local = br.at(ai - br.i0, aj - br.j0, ak - br.k0);
+    std::uint32_t& slot = br.slot[local * 3 + std::size_t(axis)];
+    if (slot != mesh::kNone) return slot;
+    const float fa = br.value[local];
+    const float fb = br.value[br.at(ai - br.i0 + (axis == 0), aj - br.j0 + (axis == 1), ak - br.k0 + (axis == 2))];
+    // Kept off the ends, so the corners of a triangle never coincide when the
+    // surface passes through a lattice point.
+    const double t = std::clamp(double(fa) / (double(fa) - fb), 0.01, 0.99);
+    slot = std::uint32_t(row.vertices.size());
+    row.vertices.push_back(lat.point(double(ai) + t * (axis == 0), double(aj) + t * (axis == 1), double(ak) + t * (axis == 2)));
+    row.keys.push_back(lat.index(ai, aj, ak) * 3 + std::uint64_t(axis));
+    return slot;
+}
+
+// Cube edge (0-11: lower corner's two other bits, then axis) between two
+// corners one bit apart.
+int edge(int a, int b) {
+    const int lower = std::min(a, b), axis = (a ^ b) == 1 ? 0 : (a ^ b) == 2 ? 1 : 2;
+    const int rest = axis == 0 ? lower >> 1 : axis == 1 ? (lower & 1) | (lower >> 2) << 1 : lower & 3;
+    return axis * 4 + rest;
+}
+
+// Marching cubes without a case table. Each face of the cube is walked
+// anticlockwise from outside: the surface enters where the walk goes from an
+// outside corner to an inside one and leaves at the next exit, so every
+// surface edge on a face is directed and the pieces link up into closed loops
+// around the cube, one per sheet, wound the same way in every cube. A face
+// with two diagonal inside corners is resolved by the asymptotic decider (the
+// sign of the bilinear saddle), which depends only on that face's values, so
+// both cubes sharing it cut it alike and the mesh has no cracks.
+void triangulate(const Lattice& lat, Brick& br, Row& row, std::size_t i0, std::size_t j0, std::size_t k0, std::size_t ni,
+                 std::size_t nj, std::size_t nk) {
+    for (std::size_t k = k0; k < k0 + nk; ++k)
+        for (std::size_t j = j0; j < j0 + nj; ++j)
+            for (std::size_t i = i0; i < i0 + ni; ++i) {
+                float f[8];
+                int inside = 0;
+                for (int c = 0; c < 8; ++c) {
+                    f[c] = br.value[br.at(i - br.i0 + (c & 1), j - br.j0 + (c >> 1 & 1), k - br.k0 + (c >> 2 & 1))];
+                    inside |= (f[c] < 0) << c;
+                }
+                if (inside == 0 || inside == 0xff) continue;
+                int next[12];
+                std::fill(next, next + 12, -1);
+                for (const auto& face : kFaces) {
+                    int enter[2], leave[2], n_enter = 0, n_leave = 0;
+                    for (int e = 0; e < 4; ++e) {
+                        const int a = face[e], b = face[(e + 1) & 3];
+                        const bool in_a = inside >> a & 1, in_b = inside >> b & 1;
+                        if (!in_a && in_b) enter[n_enter++] = e;
+                        if (in_a && !in_b) leave[n_leave++] = e;
+                    }
+                    if (n_enter == 0) continue;
+                    auto link = [&](int from, int to) {
+                        next[edge(face[from], face[(from + 1) & 3])] = edge(face[to], face[(to + 1) & 3]);
+                    };
+                    if (n_enter == 1) {
+                        link(enter[0], leave[0]);
+                        continue;
+                    }
+                    // Enter at e leaves at e + 1 when each inside corner is cut
+                    // off on its own, at e + 3 when the saddle joins them.
+                    const float a = f[face[0]], b = f[face[1]], c = f[face[2]], d = f[face[3]];
+                    const bool joined = (a * c - b * d) / (a + c - b - d) < 0;
+                    for (int n = 0; n < 2; ++n) link(enter[n], (enter[n] + (joined ? 3 : 1)) & 3);
+                }
+                std::uint32_t loop[12];
+                for (int start = 0; start < 12; ++start) {
+                    if (next[start] < 0) continue;
+                    int n = 0;
+                    for (int e = start; next[e] >= 0;) {
+                        const int axis = e / 4, rest = e % 4;
+                        const int c = axis == 0 ? rest << 1 : axis == 1 ? (rest & 1) | (rest >> 1) << 2 : rest;
+                        loop[n++] = crossing(lat, br, row, c, axis, i, j, k);
+                        const int to = next[e];
+                        next[e] = -1;
+                        e = to;
+                    }
+                    for (int t = 1; t + 1 < n; ++t) row.triangles.push_back({loop[0], loop[t], loop[t + 1]});
+                }
+            }
+}
+
+// Cells [i0, i0 + size) and so on, clipped to the brick. A box whose centre
+// is farther from the surface than its half-diagonal holds none of it;
+// otherwise it is split in eight down to two cells a side, and only those
+// leaves are evaluated and triangulated.
+void visit(const Field& field, const Lattice& lat, Brick& br, Row& row, std::size_t i0, std::size_t j0, std::size_t k0,
+           std::size_t size) {
+    const std::size_t ni = std::min(size, br.i0 + br.ni - 1 - std::min(i0, br.i0 + br.ni - 1)),
+                      nj = std::min(size, br.j0 + br.nj - 1 - std::min(j0, br.j0 + br.nj - 1)),
+                      nk = std::min(size, br.k0 + br.nk - 1 - std::min(k0, br.k0 + br.nk - 1));
+    if (ni == 0 || nj == 0 || nk == 0) return;
+    const float centre = field(lat.point(double(i0) + 0.5 * double(ni), double(j0) + 0.5 * double(nj), double(k0) + 0.5 * double(nk)));
+    ++row.evaluations;
+    const float half_diagonal = 0.5f * lat.cell * std::sqrt(float(ni * ni + nj * nj + nk * nk));
+    if (std::abs(centre) > half_diagonal + 1e-3f * lat.cell) {
+        if (i0 == br.i0 && j0 == br.j0 && k0 == br.k0 && ni + 1 == br.ni && nj + 1 == br.nj && nk + 1 == br.nk) ++row.empty;
+        return;
+    }
+    if (size > 2) {
+        const std::size_t half = (size + 1) / 2;
+        for (int c = 0; c < 8; ++c)
+            visit(field, lat, br, row, i0 + (c & 1) * half, j0 + (c >> 1 & 1) * half, k0 + (c >> 2 & 1) * half, half);
+        return;
+    }
+    for (std::size_t k = k0; k <= k0 + nk; ++k)
+        for (std::size_t j = j0; j <= j0 + nj; ++j)
+            for (std::size_t i = i0; i <= i0 + ni; ++i) {
+                float& v = br.value[br.at(i - br.i0, j - br.j0, k - br.k0)];
+                if (!std::isnan(v)) continue; // shared with a leaf already done
+                const float f = field(lat.point(double(i), double(j), double(k)));
+                // Faces lying on a lattice plane evaluate to rounding noise
+                // around zero; all of it counts as outside, so they stay flat.
+                v = std::abs(f) < 1e-4f * lat.cell ? 1e-20f : f;
+                ++row.evaluations;
+            }
+    triangulate(lat, br, row, i0, j0, k0, ni, nj, nk);
+}
+
+// Nearest squared distance to the ring's edges, and the ray crossings to the
+// right of the point for the even-odd rule.
+void crossings(float x, float y, const std::vector<Vec2>& ring, float& d2, bool& inside) {
+    for (std::size_t a = 0, b = ring.size() - 1; a < ring.size(); b = a++) {
+        const Vec2 &p = ring[a], &q = ring[b];
+        const float ex = q.x - p.x, ey = q.y - p.y, wx = x - p.x, wy = y - p.y;
+        const float len2 = ex * ex + ey * ey;
+        const float t = len2 > 0 ? std::clamp((wx * ex + wy * ey) / len2, 0.0f, 1.0f) : 0.0f;
+        const float dx = wx - ex * t, dy = wy - ey * t;
+        d2 = std::min(d2, dx * dx + dy * dy);
+        if ((p.y > y) != (q.y > y) && x < p.x + (y - p.y) * ex / ey) inside = !inside;
+    }
+}
+
+} // namespace
+
+float polygon(float x, float y, const std::vector<Vec2>& ring) {
+    float d2 = 1e30f;
+    bool inside = false;
+    crossings(x, y, ring, d2, inside);
+    return inside ? -std::sqrt(d2) : std::sqrt(d2);
+}
+
+float polygon(float x, float y, const std::vector<std::vector<Vec2>>& rings) {
+    float d2 = 1e30f;
+    bool inside = false;
+    for (const std::vector<Vec2>& ring : rings) crossings(x, y, ring, d2, inside);
+    return inside ? -std::sqrt(d2) : std::sqrt(d2);
+}
+
+float cylinder(const Vec3& p, int axis, const Vec3& c, float radius, float from, float to) {
+    const float u[3] = {p.x - c.x, p.y - c.y, p.z - c.z};
+    const float along = axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+    const float a = u[(axis + 1) % 3], b = u[(axis + 2) % 3];
+    const float dr = std::sqrt(a * a + b * b) - radius;
+    const float lo = std::min(from, to), hi = std::max(from, to);
+    const float da = std::abs(along - 0.5f * (lo + hi)) - 0.5f * (hi - lo);
+    const float ox = std::max(dr, 0.0f), oy = std::max(da, 0.0f);
+    return std::min(std::max(dr, da), 0.0f) + std::sqrt(ox * ox + oy * oy);
+}
+
+mesh::Mesh polygonise(const Field& field, const Vec3& lo, const Vec3& hi, const Options& o, Stats* stats) {
+    if (!(o.cell > 0) || o.brick < 1) throw std::runtime_error("sdf: cell and brick must be positive");
+    const auto t0 = std::chrono::steady_clock::now();
+    Lattice lat;
+    lat.cell = o.cell;
+    lat.lo = {lo.x - 2 * o.cell, lo.y - 2 * o.cell, lo.z - 2 * o.cell};
+    auto points = [&](float a, float b) { return std::size_t(std::ceil((double(b) - a) / o.cell)) + 5; };
+    lat.nx = points(lo.x, hi.x), lat.ny = points(lo.y, hi.y), lat.nz = points(lo.z, hi.z);
+    if (double(lat.nx) * double(lat.ny) * double(lat.nz) * 3 > 1.8e19)
+        throw std::runtime_error("sdf: lattice too fine for the box");
+
+    const std::size_t b = std::size_t(o.brick);
+    auto bricks_along = [&](std::size_t n) { return (n - 1 + b - 1) / b; };
+    const std::size_t bx = bricks_along(lat.nx), by = bricks_along(lat.ny), bz = bricks_along(lat.nz);
+
+    std::vector<Row> rows(by * bz);
+    parallel_for(rows.size(), [&](std::size_t r) {
+        Row& row = rows[r];
+        Brick br;
+        br.j0 = (r % by) * b, br.k0 = (r / by) * b;
+        br.nj = std::min(b, lat.ny - 1 - br.j0) + 1, br.nk = std::min(b, lat.nz - 1 - br.k0) + 1;
+        for (std::size_t q = 0; q < bx; ++q) {
+            br.i0 = q * b;
+            br.ni = std::min(b, lat.nx - 1 - br.i0) + 1;
+            const std::size_t n = br.ni * br.nj * br.nk;
+            br.value.assign(n, std::numeric_limits<float>::quiet_NaN());
+            br.slot.assign(n * 3, mesh::kNone);
+            visit(field, lat, br, row, br.i0, br.j0, br.k0, b);
+        }
+    }, o.threads);
+    const auto t1 = std::chrono::steady_clock::now();
+
+    // Edges on the faces between bricks were met by both; join them by key.
+    std::size_t total = 0;
+    std::vector<std::size_t> base(rows.size());
+    for (std::size_t r = 0; r < rows.size(); ++r) base[r] = total, total += rows[r].vertices.size();
+    if (total >= mesh::kNone) throw std::runtime_error("sdf: too many vertices");
+    std::vector<std::uint64_t> keys(total);
+    std::vector<std::uint32_t> order(total);
+    parallel_for(rows.size(), [&](std::size_t r) {
+        for (std::size_t v = 0; v < rows[r].keys.size(); ++v) {
+            keys[base[r] + v] = rows[r].keys[v];
+            order[base[r] + v] = std::uint32_t(base[r] + v);
+        }
+    }, o.threads);
+    mesh::radix_sort(keys, order, o.threads);
+    std::vector<std::uint32_t> unique(total); // global row vertex -> first of its key
+    for (std::size_t s = 0; s < total; ++s)
+        unique[order[s]] = s > 0 && keys[s] == keys[s - 1] ? unique[order[s - 1]] : order[s];
+
+    // Numbered in order of first use, like mesh::weld.
+    mesh::Mesh out;
+    std::vector<std::uint32_t> number(total, mesh::kNone);
+    std::size_t triangles = 0;
+    for (const Row& row : rows) triangles += row.triangles.size();
+    out.triangles.reserve(triangles);
+    for (std::size_t r = 0; r < rows.size(); ++r)
+        for (const mesh::Triangle& t : rows[r].triangles) {
+            mesh::Triangle m;
+            for (int c = 0; c < 3; ++c) {
+                const std::uint32_t u = unique[base[r] + t[c]];
+                if (number[u] == mesh::kNone) {
+                    number[u] = std::uint32_t(out.vertices.size());
+                    std::size_t rr = std::size_t(std::upper_bound(base.begin(), base.end(), std::size_t(u)) - base.begin()) - 1;
+                    out.vertices.push_back(rows[rr].vertices[u - base[rr]]);
+                }
+                m[c] = number[u];
+            }
+            out.triangles.push_back(m);
+        }
+    const auto t2 = std::chrono::steady_clock::now();
+
+    if (stats) {
+        *stats = {};
+        stats->lattice = lat.nx * lat.ny * lat.nz;
+        stats->bricks = rows.size() * bx;
+        for (const Row& row : rows) stats->evaluations += row.evaluations, stats->empty += row.empty;
+        stats->seconds = std::chrono::duration<double>(t1 - t0).count();
+        stats->weld_seconds = std::chrono::duration<double>(t2 - t1).count();
+    }
+    return out;
+}
+
+} // namespace pwb::sdf
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "pwb/mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace pwb::sdf {
+
+using stl::Vec3;
+
+// Signed distance, negative inside, in mm. Fields built from the primitives
+// and operators below never change faster than distance (1-Lipschitz), which
+// polygonise() relies on to skip empty space.
+using Field = std::function<float(const Vec3&)>;
+
+struct Vec2 {
+    float x = 0, y = 0;
+};
+
+// Exact distance to a closed polygon in the XY plane (either winding; the
+// even-odd rule decides inside).
+float polygon(float x, float y, const std::vector<Vec2>& ring);
+// Several rings taken together, so rings inside others are holes.
+float polygon(float x, float y, const std::vector<std::vector<Vec2>>& rings);
+
+// A 2D distance swept along Z between z0 and z1.
+inline float extrude(float d2, float z, float z0, float z1) {
+    const float dz = std::abs(z - 0.5f * (z0 + z1)) - 0.5f * (z1 - z0);
+    const float ox = std::max(d2, 0.0f), oz = std::max(dz, 0.0f);
+    return std::min(std::max(d2, dz), 0.0f) + std::sqrt(ox * ox + oz * oz);
+}
+
+// Axis-aligned box between the corners lo and hi.
+inline float box(const Vec3& p, const Vec3& lo, const Vec3& hi) {
+    const float dx = std::abs(p.x - 0.5f * (lo.x + hi.x)) - 0.5f * (hi.x - lo.x);
+    const float dy = std::abs(p.y - 0.5f * (lo.y + hi.y)) - 0.5f * (hi.y - lo.y);
+    const float dz = std::abs(p.z - 0.5f * (lo.z + hi.z)) - 0.5f * (hi.z - lo.z);
+    const float ox = std::max(dx, 0.0f), oy = std::max(dy, 0.0f), oz = std::max(dz, 0.0f);
+    return std::min(std::max({dx, dy, dz}), 0.0f) + std::sqrt(ox * ox + oy * oy + oz * oz);
+}
+
+// Capped cylinder along axis 0 (x), 1 (y) or 2 (z): `c` is a point on the
+// axis, the cylinder runs from `from` to `to` along it.
+float cylinder(const Vec3& p, int axis, const Vec3& c, float radius, float from, float to);
+
+inline float unite(float a, float b) { return std::min(a, b); }
+inline float subtract(float a, float b) { return std::max(a, -b); } // a without b
+inline float intersect(float a, float b) { return std::max(a, b); }
+
+// Union with a fillet of about `k` where the surfaces meet (polynomial
+// smooth minimum); the plain union when they are more than `k` apart.
+inline float blend(float a, float b, float k) {
+    if (k <= 0) return std::min(a, b);
+    const float h = std::clamp(0.5f + 0.5f * (b - a) / k, 0.0f, 1.0f);
+    return b + (a - b) * h - k * h * (1 - h);
+}
+
+struct Options {
+    float cell = 0.25f;  // lattice spacing, mm
+    int brick = 8;       // cells per side of the unit of work
+    unsigned threads = 0; // 0 = all cores
+};
+
+struct Stats {
+    std::size_t lattice = 0;     // points in the whole lattice
+    std::size_t bricks = 0;
+    std::size_t empty = 0;       // bricks skipped after one evaluation at their centre
+    std::size_t evaluations = 0; // calls to the field
+    double seconds = 0;          // evaluation and triangulation, in parallel
+    double weld_seconds = 0;     // joining the bricks' vertices
+};
+
+// Zero set of `field` inside the box [lo, hi] as a closed, consistently wound
+// triangle mesh. The box is padded by two cells and the field must be positive
+// on its border. The lattice is cut into bricks, handled a row at a time in
+// parallel; a box whose centre is farther from the surface than its
+// half-diagonal cannot hold any of it and is skipped, and the rest is split
+// in eight down to two cells a side, so the field is mostly evaluated near the
+// surface. Cubes are triangulated by marching cubes with ambiguous faces
+// settled by the asymptotic decider. Vertices are keyed by the lattice edge
+// they sit on and joined across bricks with one radix sort.
+mesh::Mesh polygonise(const Field& field, const Vec3& lo, const Vec3& hi, const Options& options = {},
+                      Stats* stats = nullptr);
+
+} // namespace pwb::sdf
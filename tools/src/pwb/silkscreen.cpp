@@ -0,0 +1,635 @@
+#include "pwb/silkscreen.hpp"
+
+#include "pwb/polygon_ops.hpp"
+#include "pwb/raster.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace pwb::silk {
+
+namespace {
+
+struct IPoint {
+    int x, y;
+};
+
+bool is_ink(std::uint8_t v, int threshold, bool dark_ink) { return dark_ink ? v <= threshold : v > threshold; }
+
+// Logos are usually coloured artwork on plain paper, so anything clearly off
+// the paper tone is ink. Paper is the median of the border pixels; Otsu would
+// split the ink colours among themselves instead.
+int resolve_threshold(const image::Gray& image, const TraceOptions& options) {
+    if (options.threshold >= 0) return options.threshold;
+    std::vector<std::uint8_t> border;
+    for (int c = 0; c < image.width; ++c) border.push_back(image.at(c, 0)), border.push_back(image.at(c, image.height - 1));
+    for (int r = 0; r < image.height; ++r) border.push_back(image.at(0, r)), border.push_back(image.at(image.width - 1, r));
+    std::nth_element(border.begin(), border.begin() + border.size() / 2, border.end());
+    int paper = border[border.size() / 2];
+    return options.dark_ink ? std::max(0, paper - 40) : std::min(255, paper + 40) - 1;
+}
+
+// ---- Crack following --------------------------------------------------------
+
+// Closed contours along the pixel boundaries, ink on the left: outers come
+// out counter-clockwise, holes clockwise. Only corners are kept.
+std::vector<std::vector<IPoint>> crack_contours(const image::Gray& image, const TraceOptions& options) {
+    const int w = image.width, h = image.height, threshold = resolve_threshold(image, options);
+    // Ink mask with a one-pixel border, y up.
+    std::vector<std::uint8_t> ink(std::size_t(w + 2) * std::size_t(h + 2), 0);
+    auto cell = [&](int x, int y) -> std::uint8_t& { return ink[std::size_t(y + 1) * std::size_t(w + 2) + std::size_t(x + 1)]; };
+    for (int r = 0; r < h; ++r)
+        for (int c = 0; c < w; ++c) cell(c, h - 1 - r) = is_ink(image.at(c, r), threshold, options.dark_ink);
+
+    // Outgoing crack directions per lattice vertex: bit d for E, N, W, S.
+    const int vw = w + 1;
+    std::vector<std::uint8_t> out(std::size_t(vw) * std::size_t(h + 1), 0);
+    auto vertex = [&](int x, int y) -> std::uint8_t& { return out[std::size_t(y) * std::size_t(vw) + std::size_t(x)]; };
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (!cell(x, y)) continue;
+            if (!cell(x, y - 1)) vertex(x, y) |= 1;         // bottom edge, heading east
+            if (!cell(x + 1, y)) vertex(x + 1, y) |= 2;     // right edge, heading north
+            if (!cell(x, y + 1)) vertex(x + 1, y + 1) |= 4; // top edge, heading west
+            if (!cell(x - 1, y)) vertex(x, y + 1) |= 8;     // left edge, heading south
+        }
+    }
+
+    static const int dx[4] = {1, 0, -1, 0}, dy[4] = {0, 1, 0, -1};
+    std::vector<std::vector<IPoint>> contours;
+    for (int y0 = 0; y0 <= h; ++y0) {
+        for (int x0 = 0; x0 <= w; ++x0) {
+            while (vertex(x0, y0)) {
+                std::vector<IPoint> contour;
+                int d = 0;
+                while (!(vertex(x0, y0) >> d & 1)) ++d;
+                const int first = d;
+                int x = x0, y = y0;
+                for (;;) {
+                    vertex(x, y) &= std::uint8_t(~(1u << d));
+                    x += dx[d], y += dy[d];
+                    const bool home = x == x0 && y == y0;
+                    unsigned o = vertex(x, y) | (home ? 1u << first : 0u);
+                    // Left turn first, so diagonal pixels stay separate contours.
+                    int next = -1;
+                    for (int turn : {1, 0, 3})
+                        if (o >> ((d + turn) & 3) & 1) {
+                            next = (d + turn) & 3;
+                            break;
+                        }
+                    if (next < 0) throw std::logic_error("crack_contours: open contour");
+                    if (next != d) contour.push_back({x, y});
+                    if (home && next == first) break;
+                    d = next;
+                }
+                if (contour.size() >= 4) contours.push_back(std::move(contour));
+            }
+        }
+    }
+    return contours;
+}
+
+double area2(const std::vector<IPoint>& c) {
+    double a = 0;
+    for (std::size_t i = 0, j = c.size() - 1; i < c.size(); j = i++) a += double(c[j].x) * c[i].y - double(c[i].x) * c[j].y;
+    return a;
+}
+
+// Douglas-Peucker on a closed contour, split at vertex 0 and the vertex farthest from it.
+std::vector<IPoint> simplify(const std::vector<IPoint>& c, double tolerance) {
+    const std::size_t n = c.size();
+    if (tolerance <= 0 || n < 5) return c;
+    std::vector<char> keep(n, 0);
+    std::size_t far = 0;
+    double best = -1;
+    for (std::size_t i = 1; i < n; ++i) {
+        double d = std::hypot(double(c[i].x - c[0].x), double(c[i].y - c[0].y));
+        if (d > best) best = d, far = i;
+    }
+    keep[0] = keep[far] = 1;
+    const double tol2 = tolerance * tolerance;
+    std::vector<std::pair<std::size_t, std::size_t>> stack{{0, far}, {far, n}};
+    while (!stack.empty()) {
+        auto [a, b] = stack.back();
+        stack.pop_back();
+        if (b - a < 2) continue;
+        const IPoint& p = c[a];
+        const IPoint& q = c[b % n];
+        double ex = q.x - p.x, ey = q.y - p.y, len2 = ex * ex + ey * ey;
+        std::size_t worst = a;
+        double worst_d = -1;
+        for (std::size_t i = a + 1; i < b; ++i) {
+            double vx = c[i].x - p.x, vy = c[i].y - p.y;
+            double cross = ex * vy - ey * vx;
+            double d = len2 > 0 ? cross * cross / len2 : vx * vx + vy * vy;
+            if (d > worst_d) worst_d = d, worst = i;
+        }
+        if (worst_d > tol2) {
+            keep[worst] = 1;
+            stack.push_back({a, worst});
+            stack.push_back({worst, b});
+        }
+    }
+    std::vector<IPoint> s;
+    for (std::size_t i = 0; i < n; ++i)
+        if (keep[i]) s.push_back(c[i]);
+    return s;
+}
+
+bool point_in(const std::vector<IPoint>& c, double px, double py) {
+    bool in = false;
+    for (std::size_t i = 0, j = c.size() - 1; i < c.size(); j = i++) {
+        if ((c[i].y > py) != (c[j].y > py)) {
+            double x = c[j].x + (py - c[j].y) * double(c[i].x - c[j].x) / double(c[i].y - c[j].y);
+            if (px < x) in = !in;
+        }
+    }
+    return in;
+}
+
+// ---- Stroke font ----------------------------------------------------------------
+
+// Polylines separated by ';', points "x,y" on a 4 x 6 cell; a single point is a dot.
+const char* const kGlyphs[95] = {
+    "",                                                              // ' '
+    "1,6 1,2;1,0",                                                   // !
+    "1,6 1,5;3,6 3,5",                                               // "
+    "1,0 1,6;3,0 3,6;0,2 4,2;0,4 4,4",                               // #
+    "4,5 3,6 1,6 0,5 0,4 1,3 3,3 4,2 4,1 3,0 1,0 0,1;2,7 2,-1",      // $
+    "0,0 4,6;0,6 0,5;4,1 4,0",                                       // %
+    "4,0 1,4 1,5 2,6 3,5 3,4 0,2 0,1 1,0 2,0 4,2",                   // &
+    "1,6 1,5",                                                       // '
+    "2,7 1,5 1,1 2,-1",                                              // (
+    "0,7 1,5 1,1 0,-1",                                              // )
+    "2,1 2,5;0,2 4,4;0,4 4,2",                                       // *
+    "0,3 4,3;2,1 2,5",                                               // +
+    "1,0 0,-1",                                                      // ,
+    "1,3 3,3",                                                       // -
+    "1,0",                                                           // .
+    "0,0 4,6",                                                       // /
+    "1,0 3,0 4,1 4,5 3,6 1,6 0,5 0,1 1,0",                           // 0
+    "1,5 2,6 2,0;1,0 3,0",                                           // 1
+    "0,5 1,6 3,6 4,5 4,4 0,0 4,0",                                   // 2
+    "0,5 1,6 3,6 4,5 4,4 3,3 1,3;3,3 4,2 4,1 3,0 1,0 0,1",           // 3
+    "3,0 3,6 0,2 4,2",                                               // 4
+    "4,6 0,6 0,3 3,3 4,2 4,1 3,0 0,0",                               // 5
+    "4,5 3,6 1,6 0,5 0,1 1,0 3,0 4,1 4,2 3,3 0,3",                   // 6
+    "0,6 4,6 1,0",                                                   // 7
+    "1,3 0,4 0,5 1,6 3,6 4,5 4,4 3,3 1,3 0,2 0,1 1,0 3,0 4,1 4,2 3,3", // 8
+    "0,1 1,0 3,0 4,1 4,5 3,6 1,6 0,5 0,4 1,3 4,3",                   // 9
+    "1,1;1,4",                                                       // :
+    "1,0 0,-1;1,4",                                                  // ;
+    "4,5 0,3 4,1",                                                   // <
+    "0,2 4,2;0,4 4,4",                                               // =
+    "0,5 4,3 0,1",                                                   // >
+    "0,5 1,6 3,6 4,5 4,4 2,3 2,2;2,0",                               // ?
+    "3,2 1,2 1,4 3,4 3,1 4,1 4,5 3,6 1,6 0,5 0,1 1,0 4,0",           // @
+    "0,0 0,4 2,6 4,4 4,0;0,2 4,2",                                   // A
+    "0,0 0,6 3,6 4,5 4,4 3,3 0,3;3,3 4,2 4,1 3,0 0,0",               // B
+    "4,5 3,6 1,6 0,5 0,1 1,0 3,0 4,1",                               // C
+    "0,0 0,6 2,6 4,4 4,2 2,0 0,0",                                   // D
+    "4,6 0,6 0,0 4,0;0,3 3,3",                                       // E
+    "4,6 0,6 0,0;0,3 3,3",                                           // F
+    "4,5 3,6 1,6 0,5 0,1 1,0 3,0 4,1 4,3 2,3",                       // G
+    "0,0 0,6;4,0 4,6;0,3 4,3",                                       // H
+    "1,0 3,0;2,0 2,6;1,6 3,6",                                       // I
+    "3,6 3,1 2,0 1,0 0,1",                                           // J
+    "0,0 0,6;4,6 0,2;1,3 4,0",                                       // K
+    "0,6 0,0 4,0",                                                   // L
+    "0,0 0,6 2,3 4,6 4,0",                                           // M
+    "0,0 0,6 4,0 4,6",                                               // N
+    "1,0 3,0 4,1 4,5 3,6 1,6 0,5 0,1 1,0",                           // O
+    "0,0 0,6 3,6 4,5 4,4 3,3 0,3",                                   // P
+    "1,0 3,0 4,1 4,5 3,6 1,6 0,5 0,1 1,0;2,2 4,0",                   // Q
+    "0,0 0,6 3,6 4,5 4,4 3,3 0,3;2,3 4,0",                           // R
+    "4,5 3,6 1,6 0,5 0,4 1,3 3,3 4,2 4,1 3,0 1,0 0,1",               // S
+    "0,6 4,6;2,6 2,0",                                               // T
+    "0,6 0,1 1,0 3,0 4,1 4,6",                                       // U
+    "0,6 2,0 4,6",                                                   // V
+    "0,6 1,0 2,3 3,0 4,6",                                           // W
+    "0,0 4,6;0,6 4,0",                                               // X
+    "0,6 2,3 4,6;2,3 2,0",                                           // Y
+    "0,6 4,6 0,0 4,0",                                               // Z
+    "2,7 1,7 1,-1 2,-1",                                             // [
+    "0,6 4,0",                                                       // backslash
+    "0,7 1,7 1,-1 0,-1",                                             // ]
+    "1,5 2,6 3,5",                                                   // ^
+    "0,-1 4,-1",                                                     // _
+    "1,6 2,5",                                                       // `
+    "4,4 4,0;4,3 3,4 1,4 0,3 0,1 1,0 3,0 4,1",                       // a
+    "0,6 0,0;0,1 1,0 3,0 4,1 4,3 3,4 1,4 0,3",                       // b
+    "4,3 3,4 1,4 0,3 0,1 1,0 3,0 4,1",                               // c
+    "4,6 4,0;4,1 3,0 1,0 0,1 0,3 1,4 3,4 4,3",                       // d
+    "0,2 4,2 4,3 3,4 1,4 0,3 0,1 1,0 3,0",                           // e
+    "3,6 2,6 1,5 1,0;0,4 3,4",                                       // f
+    "4,4 4,-1 3,-2 1,-2;4,1 3,0 1,0 0,1 0,3 1,4 3,4 4,3",            // g
+    "0,6 0,0;0,3 1,4 3,4 4,3 4,0",                                   // h
+    "1,0 1,4;1,6",                                                   // i
+    "2,4 2,-1 1,-2 0,-2;2,6",                                        // j
+    "0,6 0,0;3,4 0,1;1,2 3,0",                                       // k
+    "1,6 1,1 2,0",                                                   // l
+    "0,0 0,4;0,3 1,4 2,3 2,0;2,3 3,4 4,3 4,0",                       // m
+    "0,0 0,4;0,3 1,4 3,4 4,3 4,0",                                   // n
+    "1,0 3,0 4,1 4,3 3,4 1,4 0,3 0,1 1,0",                           // o
+    "0,4 0,-2;0,3 1,4 3,4 4,3 4,1 3,0 1,0 0,1",                      // p
+    "4,4 4,-2;4,3 3,4 1,4 0,3 0,1 1,0 3,0 4,1",                      // q
+    "0,0 0,4;0,3 1,4 3,4",                                           // r
+    "4,4 1,4 0,3 1,2 3,2 4,1 3,0 0,0",                               // s
+    "1,6 1,1 2,0 3,0;0,4 3,4",                                       // t
+    "0,4 0,1 1,0 3,0 4,1;4,4 4,0",                                   // u
+    "0,4 2,0 4,4",                                                   // v
+    "0,4 1,0 2,2 3,0 4,4",                                           // w
+    "0,0 4,4;0,4 4,0",                                               // x
+    "0,4 2,0;4,4 1,-2",                                              // y
+    "0,4 4,4 0,0 4,0",                                               // z
+    "3,7 2,6 2,4 1,3 2,2 2,0 3,-1",                                  // {
+    "1,-1 1,7",                                                      // |
+    "1,7 2,6 2,4 3,3 2,2 2,0 1,-1",                                  // }
+    "0,3 1,4 3,2 4,3",                                               // ~
+};
+const char* const kMissingGlyph = "0,0 4,0 4,6 0,6 0,0";
+constexpr int kCellHeight = 6;
+
+const char* glyph_strokes(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return u >= 32 && u < 127 ? kGlyphs[u - 32] : kMissingGlyph;
+}
+
+std::vector<std::vector<IPoint>> parse_strokes(const char* s) {
+    std::vector<std::vector<IPoint>> lines(1);
+    while (*s) {
+        if (*s == ';') {
+            lines.emplace_back();
+            ++s;
+            continue;
+        }
+        if (*s == ' ') {
+            ++s;
+            continue;
+        }
+        char* end = nullptr;
+        int x = int(std::strtol(s, &end, 10));
+        int y = int(std::strtol(end + 1, &end, 10));
+        lines.back().push_back({x, y});
+        s = end;
+    }
+    if (lines.back().empty()) lines.pop_back();
+    return lines;
+}
+
+// Round-capped segment as one convex contour, counter-clockwise.
+void add_capsule(PolygonSet& out, double x0, double y0, double x1, double y1, double r, Coord tolerance) {
+    const int n = std::max(8, gerber::circle_segments(Coord(r), tolerance));
+    const int half = (n + 1) / 2;
+    double a = std::atan2(y1 - y0, x1 - x0);
+    if (x0 == x1 && y0 == y1) a = 0;
+    // Cap around (x1, y1) from a - 90° to a + 90°, then around (x0, y0) on the other side.
+    for (int k = 0; k <= half; ++k) {
+        double t = a - kPi / 2 + kPi * k / half;
+        out.points.push_back({std::llround(x1 + r * std::cos(t)), std::llround(y1 + r * std::sin(t))});
+    }
+    for (int k = 0; k <= half; ++k) {
+        double t = a + kPi / 2 + kPi * k / half;
+        out.points.push_back({std::llround(x0 + r * std::cos(t)), std::llround(y0 + r * std::sin(t))});
+    }
+    out.close();
+}
+
+// ---- Gerber writing -------------------------------------------------------------
+
+struct Writer {
+    const gerber::Format& format;
+    double scale_x, scale_y; // file units per nm
+    std::string out;
+    bool have = false;
+    long long last_x = 0, last_y = 0;
+
+    Writer(const gerber::Format& f, gerber::Units units) : format(f) {
+        double unit_nm = units == gerber::Units::Inches ? double(gerber::kNmPerInch) : double(gerber::kNmPerMm);
+        scale_x = std::pow(10.0, f.x_decimal) / unit_nm;
+        scale_y = std::pow(10.0, f.y_decimal) / unit_nm;
+    }
+
+    void number(char axis, long long v, int digits) {
+        char buf[40];
+        if (format.omit_trailing) std::snprintf(buf, sizeof buf, "%c%s%0*lld", axis, v < 0 ? "-" : "", digits, std::llabs(v));
+        else std::snprintf(buf, sizeof buf, "%c%lld", axis, v);
+        out += buf;
+    }
+
+    // One operation, leaving out a coordinate equal to the current point.
+    void op(Coord x, Coord y, const char* d) {
+        long long fx = std::llround(double(x) * scale_x), fy = std::llround(double(y) * scale_y);
+        if (!have || fx != last_x) number('X', fx, format.x_integer + format.x_decimal);
+        if (!have || fy != last_y) number('Y', fy, format.y_integer + format.y_decimal);
+        out += d;
+        out += "*\n";
+        have = true, last_x = fx, last_y = fy;
+    }
+};
+
+bool has_hole(const PolygonSet& set) {
+    for (std::size_t k = 0; k < set.size(); ++k)
+        if (gerber::signed_area2(set.begin(k), set.count(k)) < 0) return true;
+    return false;
+}
+
+PolygonSet rect(Coord x0, Coord y0, Coord x1, Coord y1) {
+    PolygonSet r;
+    r.points = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+    r.close();
+    return r;
+}
+
+// Cuts `set` at the middle of a hole until no piece has one; the cut line
+// crosses the hole, so in each half it opens onto the outline.
+void hole_free(const PolygonSet& set, std::vector<PolygonSet>& pieces, int depth = 0) {
+    if (!has_hole(set) || depth > 64) {
+        pieces.push_back(set);
+        return;
+    }
+    Box all, hole;
+    for (std::size_t k = 0; k < set.size(); ++k) {
+        const bool first_hole = hole.empty() && gerber::signed_area2(set.begin(k), set.count(k)) < 0;
+        for (std::size_t i = 0; i < set.count(k); ++i) {
+            all.add(set.begin(k)[i].x, set.begin(k)[i].y);
+            if (first_hole) hole.add(set.begin(k)[i].x, set.begin(k)[i].y);
+        }
+    }
+    Coord cut = hole.min_x + hole.width() / 2;
+    hole_free(poly::boolean(set, rect(all.min_x - 1, all.min_y - 1, cut, all.max_y + 1), poly::Op::Intersection), pieces,
+              depth + 1);
+    hole_free(poly::boolean(set, rect(cut, all.min_y - 1, all.max_x + 1, all.max_y + 1), poly::Op::Intersection), pieces,
+              depth + 1);
+}
+
+} // namespace
+
+// ---- Logos ------------------------------------------------------------------------
+
+std::size_t ink_pixels(const image::Gray& image, const TraceOptions& options) {
+    const int threshold = resolve_threshold(image, options);
+    std::size_t n = 0;
+    for (std::uint8_t v : image.pixels) n += is_ink(v, threshold, options.dark_ink);
+    return n;
+}
+
+Artwork vectorise(const image::Gray& image, Coord width, const TraceOptions& options) {
+    if (image.width <= 0 || image.height <= 0) throw std::runtime_error("vectorise: empty image");
+    std::vector<std::vector<IPoint>> contours = crack_contours(image, options);
+    Artwork art;
+    const double pixel = double(width) / image.width;
+    art.width = width;
+    art.height = std::llround(pixel * image.height);
+
+    // Nesting depth from the exact crack contours; contour edges never cross,
+    // so testing one pixel-centre-offset point of each is enough.
+    std::vector<double> areas(contours.size());
+    for (std::size_t i = 0; i < contours.size(); ++i) {
+        areas[i] = area2(contours[i]) / 2;
+        art.traced_vertices += contours[i].size();
+    }
+    std::vector<int> depth(contours.size(), 0);
+    int max_depth = 0;
+    for (std::size_t i = 0; i < contours.size(); ++i) {
+        // A point just inside the contour's first edge (ink side for outers, paper side for holes).
+        const IPoint& a = contours[i].back();
+        const IPoint& b = contours[i].front();
+        double ex = b.x - a.x, ey = b.y - a.y, len = std::hypot(ex, ey);
+        double px = (a.x + b.x) / 2.0 - 0.25 * ey / len, py = (a.y + b.y) / 2.0 + 0.25 * ex / len;
+        for (std::size_t j = 0; j < contours.size(); ++j)
+            if (j != i && std::abs(areas[j]) > std::abs(areas[i]) && point_in(contours[j], px, py)) ++depth[i];
+        max_depth = std::max(max_depth, depth[i]);
+    }
+
+    std::vector<PolygonSet> levels(std::size_t(max_depth) + 1);
+    std::vector<bool> clear(levels.size());
+    for (std::size_t d = 0; d < levels.size(); ++d) clear[d] = d % 2 == 1;
+    for (std::size_t i = 0; i < contours.size(); ++i) {
+        if (std::abs(areas[i]) < options.min_area) continue;
+        std::vector<IPoint> s = simplify(contours[i], options.simplify);
+        if (s.size() < 3) continue;
+        PolygonSet& level = levels[std::size_t(depth[i])];
+        // Every level is filled counter-clockwise; clear levels subtract.
+        if (areas[i] < 0) std::reverse(s.begin(), s.end());
+        for (const IPoint& p : s) level.points.push_back({std::llround(p.x * pixel), std::llround(p.y * pixel)});
+        level.close();
+    }
+    art.outline = poly::flatten(levels, clear);
+    return art;
+}
+
+// ---- Text -------------------------------------------------------------------------
+
+Coord GlyphCache::advance(char c, Coord height) {
+    if (c == ' ') return height * 4 / kCellHeight;
+    int max_x = 0;
+    for (const auto& line : parse_strokes(glyph_strokes(c)))
+        for (const IPoint& p : line) max_x = std::max(max_x, p.x);
+    return height * (max_x + 2) / kCellHeight;
+}
+
+const PolygonSet& GlyphCache::glyph(char c, Coord height, Coord stroke) {
+    auto key = std::make_tuple(c, height, stroke);
+    auto it = glyphs_.find(key);
+    if (it != glyphs_.end()) {
+        ++hits_;
+        return it->second;
+    }
+    ++misses_;
+    PolygonSet capsules;
+    const double unit = double(height) / kCellHeight, r = stroke / 2.0;
+    // Pen centres sit inside the cell so the inked glyph is `height` tall.
+    const double shrink = (double(height) - double(stroke)) / double(height);
+    for (const auto& line : parse_strokes(glyph_strokes(c))) {
+        auto at = [&](const IPoint& p) { return std::make_pair(r + p.x * unit * shrink, r + p.y * unit * shrink); };
+        if (line.size() == 1) {
+            auto [x, y] = at(line[0]);
+            add_capsule(capsules, x, y, x, y, r, tolerance_);
+        }
+        for (std::size_t i = 1; i < line.size(); ++i) {
+            auto [x0, y0] = at(line[i - 1]);
+            auto [x1, y1] = at(line[i]);
+            add_capsule(capsules, x0, y0, x1, y1, r, tolerance_);
+        }
+    }
+    return glyphs_.emplace(key, poly::merge(capsules)).first->second;
+}
+
+Coord text_width(std::string_view text, Coord height) {
+    Coord w = 0;
+    for (char c : text) w += GlyphCache::advance(c, height);
+    return w;
+}
+
+PolygonSet text_outline(GlyphCache& cache, std::string_view text, Coord x, Coord y, const TextStyle& style) {
+    const Coord stroke = std::max<Coord>(1, style.height * style.ratio / 100);
+    PolygonSet line;
+    Coord pen = 0;
+    for (char c : text) {
+        if (c != ' ') {
+            const PolygonSet& g = cache.glyph(c, style.height, stroke);
+            for (std::size_t k = 0; k < g.size(); ++k) {
+                for (std::size_t i = 0; i < g.count(k); ++i) line.points.push_back({g.begin(k)[i].x + pen, g.begin(k)[i].y});
+                line.close();
+            }
+        }
+        pen += GlyphCache::advance(c, style.height);
+    }
+    // With the usual ratios neighbouring glyphs never touch and the concatenation
+    // is already a valid set; heavy strokes can reach the next cell.
+    if (stroke * kCellHeight >= 2 * style.height) line = poly::merge(line);
+    return transform(line, x, y, style.angle, style.mirror);
+}
+
+// ---- Placement ----------------------------------------------------------------------
+
+PolygonSet transform(const PolygonSet& set, Coord dx, Coord dy, double angle, bool mirror) {
+    PolygonSet out;
+    out.points.reserve(set.points.size());
+    const double a = angle * kPi / 180.0, c = std::cos(a), s = std::sin(a);
+    const bool turn = angle != 0;
+    for (std::size_t k = 0; k < set.size(); ++k) {
+        const std::size_t n = set.count(k);
+        for (std::size_t i = 0; i < n; ++i) {
+            // Mirroring flips orientation, so walk the contour backwards to keep it.
+            const gerber::Point& p = set.begin(k)[mirror ? n - 1 - i : i];
+            double x = mirror ? -double(p.x) : double(p.x), y = double(p.y);
+            if (turn) {
+                double rx = x * c - y * s, ry = x * s + y * c;
+                x = rx, y = ry;
+            }
+            out.points.push_back({std::llround(x) + dx, std::llround(y) + dy});
+        }
+        out.close();
+    }
+    return out;
+}
+
+bool find_free_spot(const PolygonSet& occupied, const Box& board, Coord w, Coord h, Coord clearance, Coord& x, Coord& y) {
+    if (board.empty()) return false;
+    raster::Options ro;
+    ro.pixel = std::max<Coord>(50'000, std::max(board.width(), board.height()) / 1024);
+    ro.window = board;
+    raster::Bitmap bm = raster::rasterise({occupied}, {false}, ro);
+    const int bw = bm.width, bh = bm.height;
+    // Summed-area table of occupied pixels.
+    std::vector<std::int32_t> sat(std::size_t(bw + 1) * std::size_t(bh + 1), 0);
+    auto S = [&](int c, int r) -> std::int32_t& { return sat[std::size_t(r) * std::size_t(bw + 1) + std::size_t(c)]; };
+    for (int r = 0; r < bh; ++r)
+        for (int c = 0; c < bw; ++c) S(c + 1, r + 1) = (bm.row(r)[c] != 0) + S(c, r + 1) + S(c + 1, r) - S(c, r);
+    auto busy = [&](int c0, int r0, int c1, int r1) {
+        if (c0 < 0 || r0 < 0 || c1 > bw || r1 > bh) return true;
+        return S(c1, r1) - S(c0, r1) - S(c1, r0) + S(c0, r0) != 0;
+    };
+    const int pw = int((w + bm.pixel - 1) / bm.pixel), ph = int((h + bm.pixel - 1) / bm.pixel);
+    const int pc = int((clearance + bm.pixel - 1) / bm.pixel);
+    int best = -1, best_c = 0, best_r = 0;
+    for (int r = pc; r + ph + pc <= bh; ++r) {
+        for (int c = pc; c + pw + pc <= bw; ++c) {
+            if (busy(c - pc, r - pc, c + pw + pc, r + ph + pc)) continue;
+            // Room to spare: how far the clearance ring can grow before it hits something.
+            int lo = pc, hi = std::max(bw, bh);
+            while (lo < hi) {
+                int mid = (lo + hi + 1) / 2;
+                if (busy(c - mid, r - mid, c + pw + mid, r + ph + mid)) hi = mid - 1;
+                else lo = mid;
+            }
+            if (lo > best) best = lo, best_c = c, best_r = r;
+        }
+    }
+    if (best < 0) return false;
+    x = bm.origin_x + Coord(best_c) * bm.pixel;
+    y = bm.origin_y + Coord(best_r) * bm.pixel;
+    return true;
+}
+
+// ---- Gerber output ---------------------------------------------------------------------
+
+std::string region_block(const PolygonSet& set, const gerber::Format& format, gerber::Units units) {
+    // Split into islands: each outer with the holes inside it.
+    std::vector<std::size_t> outers, holes;
+    for (std::size_t k = 0; k < set.size(); ++k)
+        (gerber::signed_area2(set.begin(k), set.count(k)) > 0 ? outers : holes).push_back(k);
+    std::vector<PolygonSet> islands(outers.size());
+    std::vector<double> outer_area(outers.size());
+    for (std::size_t i = 0; i < outers.size(); ++i) {
+        std::size_t k = outers[i];
+        islands[i].points.assign(set.begin(k), set.begin(k) + set.count(k));
+        islands[i].close();
+        outer_area[i] = gerber::signed_area2(set.begin(k), set.count(k));
+    }
+    auto inside = [&](std::size_t k, const gerber::Point& p) {
+        const gerber::Point* c = set.begin(k);
+        const std::size_t n = set.count(k);
+        bool in = false;
+        for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+            if ((c[i].y > p.y) != (c[j].y > p.y)) {
+                double x = double(c[j].x) + double(p.y - c[j].y) * double(c[i].x - c[j].x) / double(c[i].y - c[j].y);
+                if (double(p.x) < x) in = !in;
+            }
+        }
+        return in;
+    };
+    for (std::size_t h : holes) {
+        // Hole vertices lie on or inside their outer; the midpoint of a hole edge nudged
+        // to the paper side is strictly inside the smallest enclosing outer.
+        const gerber::Point& a = set.begin(h)[0];
+        const gerber::Point& b = set.begin(h)[1];
+        gerber::Point probe{(a.x + b.x) / 2, (a.y + b.y) / 2};
+        std::size_t best = outers.size();
+        for (std::size_t i = 0; i < outers.size(); ++i)
+            if (inside(outers[i], probe) && (best == outers.size() || outer_area[i] < outer_area[best])) best = i;
+        if (best == outers.size()) continue;
+        islands[best].points.insert(islands[best].points.end(), set.begin(h), set.begin(h) + set.count(h));
+        islands[best].close();
+    }
+
+    Writer w(format, units);
+    w.out = "G01*\nG36*\n";
+    for (const PolygonSet& island : islands) {
+        std::vector<PolygonSet> pieces;
+        hole_free(island, pieces);
+        for (const PolygonSet& piece : pieces) {
+            for (std::size_t k = 0; k < piece.size(); ++k) {
+                const gerber::Point* p = piece.begin(k);
+                w.op(p[0].x, p[0].y, "D02");
+                for (std::size_t i = 1; i < piece.count(k); ++i) w.op(p[i].x, p[i].y, "D01");
+                w.op(p[0].x, p[0].y, "D01");
+            }
+        }
+    }
+    w.out += "G37*\n";
+    return w.out;
+}
+
+std::string pixel_flashes(const image::Gray& image, Coord pixel, Coord x, Coord y, const gerber::Format& format,
+                          gerber::Units units, int aperture, const TraceOptions& options) {
+    const int threshold = resolve_threshold(image, options);
+    const double unit = units == gerber::Units::Inches ? double(gerber::kNmPerInch) : double(gerber::kNmPerMm);
+    char head[96];
+    std::snprintf(head, sizeof head, "%%ADD%dR,%.6fX%.6f*%%\nD%d*\n", aperture, pixel / unit, pixel / unit, aperture);
+    Writer w(format, units);
+    w.out = head;
+    for (int r = 0; r < image.height; ++r)
+        for (int c = 0; c < image.width; ++c)
+            if (is_ink(image.at(c, r), threshold, options.dark_ink))
+                w.op(x + Coord(c) * pixel + pixel / 2, y + Coord(image.height - 1 - r) * pixel + pixel / 2, "D03");
+    return w.out;
+}
+
+std::string append_to_layer(std::string_view gerber_text, std::string_view block) {
+    std::size_t end = gerber_text.rfind("M02*");
+    std::string out(gerber_text.substr(0, end == std::string_view::npos ? gerber_text.size() : end));
+    if (!out.empty() && out.back() != '\n') out += '\n';
+    out += "%LPD*%\n";
+    out += block;
+    out += "M02*\n";
+    return out;
+}
+
+} // namespace pwb::silk
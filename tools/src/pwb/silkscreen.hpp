@@ -0,0 +1,105 @@
+#pragma once
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+#include "pwb/image.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace pwb::silk {
+
+using gerber::Box;
+using gerber::Coord;
+using gerber::PolygonSet;
+
+// ---- Bitmap logos ---------------------------------------------------------
+
+struct TraceOptions {
+    int threshold = -1;         // grey level splitting ink from paper; -1 = paper level - 40
+    bool dark_ink = true;       // ink is the dark side of the threshold
+    double simplify = 0.7;      // Douglas-Peucker tolerance, pixels (0 = keep the staircase)
+    double min_area = 2.0;      // drop specks smaller than this, pixels²
+};
+
+// Number of ink pixels under the options' threshold, for the per-pixel baseline.
+std::size_t ink_pixels(const image::Gray& image, const TraceOptions& options = {});
+
+// A traced logo scaled to board units, origin at its bottom-left corner.
+struct Artwork {
+    PolygonSet outline;
+    Coord width = 0;
+    Coord height = 0;
+    std::size_t traced_vertices = 0; // crack-following vertices before simplification
+};
+
+// Follows the pixel cracks around the ink, simplifies each contour, scales it
+// so the image is `width` wide and rebuilds the fill level by level (outers
+// dark, holes clear, islands in holes dark...) so that simplification cannot
+// turn a hole inside out.
+Artwork vectorise(const image::Gray& image, Coord width, const TraceOptions& options = {});
+
+// ---- Stroke-font text -----------------------------------------------------
+
+// Built-in single-stroke font on a 4 x 6 cell (descenders to -2), drawn with
+// round pens like EAGLE's vector font. Glyph outlines are computed once per
+// (character, height, stroke width) and reused.
+class GlyphCache {
+public:
+    // Pen ends are flattened to within `tolerance`; 5 µm is well under what legend printing resolves.
+    explicit GlyphCache(Coord tolerance = 5000) : tolerance_(tolerance) {}
+
+    // Outline of one glyph, origin at the left end of the baseline.
+    const PolygonSet& glyph(char c, Coord height, Coord stroke);
+    // Horizontal advance of a glyph at this height.
+    static Coord advance(char c, Coord height);
+
+    std::size_t hits() const { return hits_; }
+    std::size_t misses() const { return misses_; }
+    void clear() { glyphs_.clear(), hits_ = misses_ = 0; }
+
+private:
+    Coord tolerance_;
+    std::map<std::tuple<char, Coord, Coord>, PolygonSet> glyphs_;
+    std::size_t hits_ = 0, misses_ = 0;
+};
+
+struct TextStyle {
+    Coord height = 1'000'000;   // cap height
+    int ratio = 12;             // stroke width as percent of height, as in EAGLE
+    double angle = 0;           // degrees, counter-clockwise about the anchor
+    bool mirror = false;        // bottom-side text reads correctly from below
+};
+
+// Merged outline of `text` with its baseline starting at (x, y).
+PolygonSet text_outline(GlyphCache& cache, std::string_view text, Coord x, Coord y, const TextStyle& style);
+Coord text_width(std::string_view text, Coord height);
+
+// ---- Placement and Gerber output -----------------------------------------
+
+// Copy of `set` mirrored about x = 0 (when asked), rotated, then moved by (dx, dy).
+PolygonSet transform(const PolygonSet& set, Coord dx, Coord dy, double angle = 0, bool mirror = false);
+
+// Lower-left corner of a w x h rectangle inside `board` that keeps `clearance`
+// from everything in `occupied` (merged polygons), choosing the spot with the
+// most room around it. Returns false when nothing fits.
+bool find_free_spot(const PolygonSet& occupied, const Box& board, Coord w, Coord h, Coord clearance, Coord& x, Coord& y);
+
+// G36/G37 region statements for `set` in the layer's units and %FS% format.
+// Gerber regions cannot carry holes, so islands with holes are cut into
+// vertical slabs through each hole first; coordinates that repeat the previous
+// value are omitted (they are modal).
+std::string region_block(const PolygonSet& set, const gerber::Format& format, gerber::Units units);
+
+// The naive alternative: one square-aperture flash per ink pixel.
+std::string pixel_flashes(const image::Gray& image, Coord pixel, Coord x, Coord y, const gerber::Format& format,
+                          gerber::Units units, int aperture, const TraceOptions& options = {});
+
+// Inserts `block` (and a %LPD*% to be safe) before the final M02 of a Gerber file.
+std::string append_to_layer(std::string_view gerber_text, std::string_view block);
+
+} // namespace pwb::silk
@@ -0,0 +1,27 @@
+#pragma once
+
+// Runtime-dispatched AVX2 kernels. Functions tagged PWB_TARGET_AVX2 are built
+// for AVX2/FMA regardless of the global -m flags and must only be called when
+// cpu_has_avx2() is true, so the same binary still runs on older lab PCs.
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PWB_HAVE_AVX2 1
+#define PWB_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#include <immintrin.h>
+#else
+#define PWB_HAVE_AVX2 0
+#define PWB_TARGET_AVX2
+#endif
+
+namespace pwb {
+
+inline bool cpu_has_avx2() {
+#if PWB_HAVE_AVX2
+    static const bool has = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return has;
+#else
+    return false;
+#endif
+}
+
+} // namespace pwb
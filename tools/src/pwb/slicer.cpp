@@ -0,0 +1,509 @@
+#include "pwb/slicer.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+
+namespace pwb::slicer {
+
+namespace {
+
+double mm(Coord v) { return double(v) / gerber::kNmPerMm; }
+Coord nm(double v) { return std::llround(v * gerber::kNmPerMm); }
+
+// Cura-style number: up to three decimals, trailing zeros dropped.
+std::string num(double v, int decimals = 3) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.*f", decimals, v);
+    std::string s = buf;
+    while (s.back() == '0') s.pop_back();
+    if (s.back() == '.') s.pop_back();
+    if (s == "-0") s = "0";
+    return s;
+}
+
+// Drops vertices within `tolerance` of the chord between their kept
+// predecessor and their successor; fine meshes give many nearly collinear
+// cuts that would only slow the booleans down.
+void simplify(std::vector<Point>& loop, Coord tolerance) {
+    const std::size_t n = loop.size();
+    if (n < 4 || tolerance <= 0) return;
+    const double tol2 = double(tolerance) * double(tolerance);
+    std::vector<Point> out;
+    out.reserve(n);
+    out.push_back(loop[0]);
+    for (std::size_t i = 1; i < n; ++i) {
+        const Point& a = out.back();
+        const Point& b = loop[i];
+        const Point& c = loop[i + 1 == n ? 0 : i + 1];
+        const double dx = double(c.x - a.x), dy = double(c.y - a.y), len2 = dx * dx + dy * dy;
+        const double cross = double(b.x - a.x) * dy - double(b.y - a.y) * dx;
+        if (len2 > 0 && cross * cross <= tol2 * len2) continue;
+        out.push_back(b);
+    }
+    if (out.size() >= 3) loop.swap(out);
+}
+
+// One plane through the triangles that straddle it. A vertex counts as
+// above when strictly above, so every crossing edge has one end on each
+// side and neighbouring triangles agree on which edges they cut. Walking a
+// counter-clockwise (outward-facing) triangle, the segment runs from the
+// edge that goes down through the plane to the edge that comes back up,
+// which leaves the solid on its left.
+PolygonSet section(const mesh::Mesh& mesh, const std::vector<std::uint32_t>& tris, double z, Coord tolerance,
+                   std::size_t& open) {
+    struct Segment {
+        std::uint64_t from, to;
+        Point p; // where the plane cuts the `from` edge
+    };
+    const std::vector<mesh::Vec3>& v = mesh.vertices;
+    auto key = [](std::uint32_t a, std::uint32_t b) {
+        if (a > b) std::swap(a, b);
+        return std::uint64_t(a) << 32 | b;
+    };
+    auto cut = [&](std::uint32_t a, std::uint32_t b) {
+        if (a > b) std::swap(a, b); // same arithmetic from both sides of the edge
+        const double t = (z - v[a].z) / (double(v[b].z) - v[a].z);
+        return Point{nm(v[a].x + t * (double(v[b].x) - v[a].x)), nm(v[a].y + t * (double(v[b].y) - v[a].y))};
+    };
+    std::vector<Segment> segments;
+    segments.reserve(tris.size());
+    for (std::uint32_t t : tris) {
+        const mesh::Triangle& tri = mesh.triangles[t];
+        const bool up[3] = {v[tri[0]].z > z, v[tri[1]].z > z, v[tri[2]].z > z};
+        Segment s{};
+        int ends = 0;
+        for (int k = 0; k < 3; ++k) {
+            const std::uint32_t a = tri[k], b = tri[(k + 1) % 3];
+            if (up[k] && !up[(k + 1) % 3]) s.from = key(a, b), s.p = cut(a, b), ++ends;
+            else if (!up[k] && up[(k + 1) % 3]) s.to = key(a, b), ++ends;
+        }
+        if (ends == 2) segments.push_back(s);
+    }
+
+    std::unordered_map<std::uint64_t, std::uint32_t> starting;
+    starting.reserve(segments.size());
+    for (std::uint32_t i = 0; i < segments.size(); ++i) starting.emplace(segments[i].from, i);
+    std::vector<char> used(segments.size(), 0);
+    PolygonSet loops;
+    std::vector<Point> loop;
+    for (std::uint32_t i = 0; i < segments.size(); ++i) {
+        if (used[i]) continue;
+        loop.clear();
+        bool closed = false;
+        for (std::uint32_t j = i;;) {
+            used[j] = 1;
+            if (loop.empty() || loop.back() != segments[j].p) loop.push_back(segments[j].p);
+            auto it = starting.find(segments[j].to);
+            if (it == starting.end()) break;
+            j = it->second;
+            if (j == i) {
+                closed = true;
+                break;
+            }
+            if (used[j]) break;
+        }
+        if (!closed) {
+            ++open;
+            continue;
+        }
+        if (loop.size() > 1 && loop.back() == loop.front()) loop.pop_back();
+        simplify(loop, tolerance);
+        if (loop.size() < 3) continue;
+        loops.points.insert(loops.points.end(), loop.begin(), loop.end());
+        loops.close();
+    }
+    return poly::merge(loops);
+}
+
+// Parallel lines across `area` at `angle`, `spacing` apart on a grid fixed
+// to the origin, so sparse infill lines stack from one layer to the next.
+// Every other line runs backwards, which keeps the greedy ordering zig-zag.
+void hatch(const PolygonSet& area, double spacing, double angle, Kind kind, std::vector<Path>& out) {
+    if (area.size() == 0 || spacing <= 0) return;
+    const double c = std::cos(angle), s = std::sin(angle);
+    struct Hit {
+        std::int64_t line;
+        double x;
+    };
+    std::vector<Hit> hits;
+    for (std::size_t k = 0; k < area.size(); ++k) {
+        const Point* p = area.begin(k);
+        const std::size_t n = area.count(k);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Point& a = p[i];
+            const Point& b = p[i + 1 == n ? 0 : i + 1];
+            // Rotated by -angle, the lines are horizontal.
+            const double ax = a.x * c + a.y * s, ay = a.y * c - a.x * s;
+            const double bx = b.x * c + b.y * s, by = b.y * c - b.x * s;
+            if (ay == by) continue;
+            const double lo = std::min(ay, by), hi = std::max(ay, by);
+            for (auto line = std::int64_t(std::ceil(lo / spacing)); line * spacing < hi; ++line) {
+                const double t = (line * spacing - ay) / (by - ay);
+                hits.push_back({line, ax + t * (bx - ax)});
+            }
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) { return a.line != b.line ? a.line < b.line : a.x < b.x; });
+    auto back = [&](double x, double y) { return Point{std::llround(x * c - y * s), std::llround(x * s + y * c)}; };
+    for (std::size_t i = 0; i + 1 < hits.size(); i += 2) {
+        if (hits[i].line != hits[i + 1].line) { // a grazing vertex; resynchronise
+            --i;
+            continue;
+        }
+        const double y = hits[i].line * spacing;
+        Path path{kind, false, {back(hits[i].x, y), back(hits[i + 1].x, y)}};
+        if (hits[i].line & 1) std::swap(path.points[0], path.points[1]);
+        if (path.points[0] != path.points[1]) out.push_back(std::move(path));
+    }
+}
+
+double distance2(const Point& a, const Point& b) {
+    const double dx = double(a.x - b.x), dy = double(a.y - b.y);
+    return dx * dx + dy * dy;
+}
+
+// Nearest-next ordering: loops start at their vertex closest to the nozzle,
+// lines are flipped to start at their nearer end.
+void order(std::vector<Path>& paths, Point& at) {
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        std::size_t best = i, best_vertex = 0;
+        double best_d = 1e300;
+        for (std::size_t j = i; j < paths.size(); ++j) {
+            const std::vector<Point>& pts = paths[j].points;
+            const std::size_t candidates = paths[j].closed ? pts.size() : 2;
+            for (std::size_t k = 0; k < candidates; ++k) {
+                const std::size_t vertex = paths[j].closed ? k : (k ? pts.size() - 1 : 0);
+                const double d = distance2(at, pts[vertex]);
+                if (d < best_d) best_d = d, best = j, best_vertex = vertex;
+            }
+        }
+        std::swap(paths[i], paths[best]);
+        std::vector<Point>& pts = paths[i].points;
+        if (paths[i].closed) {
+            std::rotate(pts.begin(), pts.begin() + std::ptrdiff_t(best_vertex), pts.end());
+            at = pts.front();
+        } else {
+            if (best_vertex) std::reverse(pts.begin(), pts.end());
+            at = pts.back();
+        }
+    }
+}
+
+void add_loops(const PolygonSet& set, Kind kind, std::vector<Path>& out) {
+    for (std::size_t k = 0; k < set.size(); ++k) out.push_back({kind, true, {set.begin(k), set.begin(k) + set.count(k)}});
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Time for a straight move from rest to rest, trapezoidal velocity profile.
+double move_time(double length, double speed, double accel) {
+    if (length <= 0 || speed <= 0) return 0;
+    if (accel <= 0 || length >= speed * speed / accel) return length / speed + (accel > 0 ? speed / accel : 0);
+    return 2 * std::sqrt(length / accel);
+}
+
+const char* type_name(Kind kind) {
+    switch (kind) {
+    case Kind::OuterWall: return "WALL-OUTER";
+    case Kind::InnerWall: return "WALL-INNER";
+    case Kind::Skin: return "SKIN";
+    case Kind::Fill: return "FILL";
+    }
+    return "FILL";
+}
+
+double speed_of(Kind kind, std::size_t layer, const Machine& m) {
+    if (layer == 0) return m.first_layer_speed;
+    switch (kind) {
+    case Kind::OuterWall:
+    case Kind::InnerWall: return m.wall_speed;
+    case Kind::Skin: return m.skin_speed;
+    case Kind::Fill: return m.fill_speed;
+    }
+    return m.fill_speed;
+}
+
+// Filament per mm of bead: a line_width x height rectangle of plastic.
+double filament_per_mm(const Layer& layer, const Options& o, const Machine& m) {
+    const double r = m.filament_diameter / 2;
+    return o.line_width * layer.height / (kPi * r * r);
+}
+
+// Walks every path of every layer in print order, calling `travel` before
+// each path and `extrude` for each of its segments.
+template <typename Travel, typename Extrude>
+void walk(const Result& result, Travel&& travel, Extrude&& extrude) {
+    bool started = false;
+    Point at{};
+    for (std::size_t l = 0; l < result.layers.size(); ++l)
+        for (const Path& path : result.layers[l].paths) {
+            if (path.points.empty()) continue;
+            travel(l, started ? &at : nullptr, path.points.front());
+            started = true;
+            const std::size_t n = path.points.size() + (path.closed ? 1 : 0);
+            for (std::size_t i = 1; i < n; ++i) extrude(l, path, path.points[i - 1], path.points[i % path.points.size()]);
+            at = path.closed ? path.points.front() : path.points.back();
+        }
+}
+
+} // namespace
+
+std::vector<PolygonSet> sections(const mesh::Mesh& mesh, const std::vector<double>& z, Coord tolerance,
+                                 unsigned threads, std::size_t* open_chains) {
+    std::vector<PolygonSet> out(z.size());
+    if (open_chains) *open_chains = 0;
+    if (z.empty() || mesh.triangles.empty()) return out;
+    // A triangle crosses plane z when its lowest corner is at or below z and
+    // its highest strictly above.
+    std::vector<std::vector<std::uint32_t>> buckets(z.size());
+    for (std::uint32_t t = 0; t < mesh.triangles.size(); ++t) {
+        const mesh::Triangle& tri = mesh.triangles[t];
+        const double z0 = mesh.vertices[tri[0]].z, z1 = mesh.vertices[tri[1]].z, z2 = mesh.vertices[tri[2]].z;
+        const double lo = std::min({z0, z1, z2}), hi = std::max({z0, z1, z2});
+        auto first = std::lower_bound(z.begin(), z.end(), lo);
+        for (auto it = first; it != z.end() && *it < hi; ++it) buckets[std::size_t(it - z.begin())].push_back(t);
+    }
+    std::vector<std::size_t> open(z.size(), 0);
+    parallel_for(
+        z.size(), [&](std::size_t l) { out[l] = section(mesh, buckets[l], z[l], tolerance, open[l]); }, threads);
+    if (open_chains)
+        for (std::size_t n : open) *open_chains += n;
+    return out;
+}
+
+Result slice(const mesh::Mesh& mesh, const Options& o) {
+    Result r;
+    r.triangles = mesh.triangles.size();
+    if (mesh.triangles.empty()) return r;
+    double zmin = 1e300, zmax = -1e300;
+    for (const mesh::Vec3& v : mesh.vertices) zmin = std::min(zmin, double(v.z)), zmax = std::max(zmax, double(v.z));
+
+    // Layer tops from the bed; each layer is cut through its middle.
+    std::vector<double> planes;
+    for (double top = o.first_layer, height = o.first_layer; top - height / 2 < zmax - zmin;
+         height = o.layer_height, top += o.layer_height) {
+        r.layers.push_back({top, height, {}, {}});
+        planes.push_back(zmin + top - height / 2);
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<PolygonSet> regions = sections(mesh, planes, o.tolerance, o.threads, &r.open_chains);
+    r.slice_seconds = seconds_since(t0);
+
+    const std::size_t n = r.layers.size();
+    const Coord w = nm(o.line_width);
+    std::vector<PolygonSet> inner(n); // inside the innermost wall
+    t0 = std::chrono::steady_clock::now();
+    parallel_for(
+        n,
+        [&](std::size_t l) {
+            Layer& layer = r.layers[l];
+            layer.region = std::move(regions[l]);
+            for (int k = 0; k < o.walls; ++k) {
+                const PolygonSet wall = poly::offset(layer.region, -(w / 2 + Coord(k) * w), o.tolerance);
+                if (wall.size() == 0) break;
+                add_loops(wall, k == 0 ? Kind::OuterWall : Kind::InnerWall, layer.paths);
+            }
+            inner[l] = o.walls > 0 ? poly::offset(layer.region, -Coord(o.walls) * w, o.tolerance) : layer.region;
+        },
+        o.threads);
+    r.wall_seconds = seconds_since(t0);
+
+    // Skin wherever one of the `solid_layers` layers above or below does
+    // not cover the area; the rest gets sparse infill.
+    t0 = std::chrono::steady_clock::now();
+    parallel_for(
+        n,
+        [&](std::size_t l) {
+            Layer& layer = r.layers[l];
+            PolygonSet skin = inner[l], sparse;
+            const int s = o.solid_layers;
+            if (s == 0) {
+                sparse = std::move(skin);
+                skin = {};
+            } else if (l >= std::size_t(s) && l + std::size_t(s) < n) {
+                PolygonSet covered = r.layers[l - std::size_t(s)].region;
+                for (std::size_t j = l - std::size_t(s) + 1; j <= l + std::size_t(s) && covered.size(); ++j)
+                    if (j != l) covered = poly::boolean(covered, r.layers[j].region, poly::Op::Intersection);
+                sparse = poly::boolean(inner[l], covered, poly::Op::Intersection);
+                skin = poly::boolean(inner[l], covered, poly::Op::Difference);
+            }
+            const double angle = (l % 2 ? -o.infill_angle : o.infill_angle) * kPi / 180;
+            hatch(skin, double(w), angle, Kind::Skin, layer.paths);
+            if (o.infill > 0) hatch(sparse, double(w) / std::min(1.0, o.infill), angle, Kind::Fill, layer.paths);
+        },
+        o.threads);
+
+    // Print order: inner walls, outer wall, skin, infill, each nearest-next.
+    Point at{};
+    for (Layer& layer : r.layers) {
+        auto rank = [](const Path& p) {
+            switch (p.kind) {
+            case Kind::InnerWall: return 0;
+            case Kind::OuterWall: return 1;
+            case Kind::Skin: return 2;
+            case Kind::Fill: return 3;
+            }
+            return 3;
+        };
+        std::stable_sort(layer.paths.begin(), layer.paths.end(), [&](const Path& a, const Path& b) { return rank(a) < rank(b); });
+        std::size_t begin = 0;
+        while (begin < layer.paths.size()) {
+            std::size_t end = begin;
+            while (end < layer.paths.size() && rank(layer.paths[end]) == rank(layer.paths[begin])) ++end;
+            std::vector<Path> group(std::make_move_iterator(layer.paths.begin() + std::ptrdiff_t(begin)),
+                                    std::make_move_iterator(layer.paths.begin() + std::ptrdiff_t(end)));
+            order(group, at);
+            std::move(group.begin(), group.end(), layer.paths.begin() + std::ptrdiff_t(begin));
+            begin = end;
+        }
+    }
+    r.fill_seconds = seconds_since(t0);
+    return r;
+}
+
+Totals estimate(const Result& result, const Options& o, const Machine& m) {
+    Totals t;
+    walk(
+        result,
+        [&](std::size_t l, const Point* from, const Point& to) {
+            if (!from) return;
+            const double d = std::sqrt(distance2(*from, to)) / gerber::kNmPerMm;
+            t.seconds += move_time(d, l == 0 ? m.first_layer_travel : m.travel_speed, m.acceleration);
+            if (d > m.retract_after && m.retraction_speed > 0) t.seconds += 2 * m.retraction / m.retraction_speed;
+        },
+        [&](std::size_t l, const Path& path, const Point& a, const Point& b) {
+            const double d = std::sqrt(distance2(a, b)) / gerber::kNmPerMm;
+            t.seconds += move_time(d, speed_of(path.kind, l, m), m.acceleration);
+            t.filament += d * filament_per_mm(result.layers[l], o, m);
+        });
+    return t;
+}
+
+std::string write_gcode(const Result& result, const Options& o, const Machine& m, const std::string& title) {
+    // Centre the print on the bed.
+    gerber::Box box;
+    for (const Layer& layer : result.layers)
+        for (const Path& p : layer.paths)
+            for (const Point& q : p.points) box.add(q.x, q.y);
+    if (box.empty()) box.add(0, 0);
+    const double dx = m.bed_x / 2 - (mm(box.min_x) + mm(box.max_x)) / 2;
+    const double dy = m.bed_y / 2 - (mm(box.min_y) + mm(box.max_y)) / 2;
+    auto xy = [&](const Point& p) { return " X" + num(mm(p.x) + dx) + " Y" + num(mm(p.y) + dy); };
+    const Totals totals = estimate(result, o, m);
+
+    std::string out;
+    auto line = [&](const std::string& s) {
+        out += s;
+        out += '\n';
+    };
+    line(";FLAVOR:Marlin");
+    line(";TIME:" + std::to_string(long(std::lround(totals.seconds))));
+    line(";Filament used: " + num(totals.filament / 1000, 5) + "m");
+    line(";Layer height: " + num(o.layer_height));
+    line(";MINX:" + num(mm(box.min_x) + dx));
+    line(";MINY:" + num(mm(box.min_y) + dy));
+    line(";MINZ:" + num(result.layers.empty() ? 0 : result.layers.front().z));
+    line(";MAXX:" + num(mm(box.max_x) + dx));
+    line(";MAXY:" + num(mm(box.max_y) + dy));
+    line(";MAXZ:" + num(result.layers.empty() ? 0 : result.layers.back().z));
+    line(";TARGET_MACHINE.NAME:" + m.name);
+    line(";TITLE:" + title);
+    line(";Generated with pwb stl_slice");
+    line("M140 S" + std::to_string(m.bed_temp));
+    line("M105");
+    line("M190 S" + std::to_string(m.bed_temp));
+    line("M104 S" + std::to_string(m.nozzle_temp));
+    line("M105");
+    line("M109 S" + std::to_string(m.nozzle_temp));
+    line("M82 ;absolute extrusion mode");
+    line("G92 E0 ; Reset Extruder");
+    line("G28 ; Home all axes");
+    line("G29 ; Probe the bed, as the profile's start code does");
+    line("G1 Z2.0 F3000 ; Move Z Axis up little to prevent scratching of Heat Bed");
+    line("G1 X0.1 Y20 Z0.3 F5000.0 ; Move to start position");
+    line("G1 X0.1 Y200.0 Z0.3 F1500.0 E15 ; Draw the first line");
+    line("G1 X0.4 Y200.0 Z0.3 F5000.0 ; Move to side a little");
+    line("G1 X0.4 Y20 Z0.3 F1500.0 E30 ; Draw the second line");
+    line("G92 E0 ; Reset Extruder");
+    line("G1 Z2.0 F3000 ; Move Z Axis up little to prevent scratching of Heat Bed");
+    line("G1 X5 Y20 Z2.0 F5000.0 ; Move over to prevent blob squish");
+    line("G92 E0");
+    line("G1 F" + num(m.retraction_speed * 60) + " E" + num(-m.retraction, 5));
+    line(";LAYER_COUNT:" + std::to_string(result.layers.size()));
+
+    double e = 0, feed = 0;
+    bool retracted = true;
+    std::size_t current = std::size_t(-1);
+    Kind kind = Kind::Fill;
+    bool typed = false;
+    auto f = [&](double mm_per_s) {
+        const double want = mm_per_s * 60;
+        if (want == feed) return std::string();
+        feed = want;
+        return " F" + num(want);
+    };
+    // As Cura does: retract, then lift to the new layer, then travel. The
+    // first layer is reached going down from the purge lines, so its Z rides
+    // on the first travel rather than dropping onto the bed at the purge line.
+    auto layer_change = [&](std::size_t l) {
+        current = l;
+        typed = false;
+        line(";LAYER:" + std::to_string(l));
+        if (l == 0) line("M107");
+        if (l == 1 && m.fan > 0) line("M106 S" + std::to_string(m.fan));
+        if (l > 0) line("G0" + f(m.travel_speed) + " Z" + num(result.layers[l].z));
+    };
+    walk(
+        result,
+        [&](std::size_t l, const Point* from, const Point& to) {
+            const bool first = l != current;
+            const double d = from ? std::sqrt(distance2(*from, to)) / gerber::kNmPerMm : 1e9;
+            if (!retracted && (first || d > m.retract_after)) {
+                line("G1" + f(m.retraction_speed) + " E" + num(e - m.retraction, 5));
+                retracted = true;
+            }
+            if (first) layer_change(l);
+            line("G0" + f(l == 0 ? m.first_layer_travel : m.travel_speed) + xy(to) +
+                 (first && l == 0 ? " Z" + num(result.layers[l].z) : std::string()));
+        },
+        [&](std::size_t l, const Path& path, const Point& a, const Point& b) {
+            if (!typed || path.kind != kind) {
+                line(std::string(";TYPE:") + type_name(path.kind));
+                kind = path.kind;
+                typed = true;
+            }
+            if (retracted) {
+                line("G1" + f(m.retraction_speed) + " E" + num(e, 5));
+                retracted = false;
+            }
+            e += std::sqrt(distance2(a, b)) / gerber::kNmPerMm * filament_per_mm(result.layers[l], o, m);
+            line("G1" + f(speed_of(path.kind, l, m)) + xy(b) + " E" + num(e, 5));
+        });
+
+    line("M140 S0");
+    line("G91 ;Relative positioning");
+    line("G1 E-2 F2700 ;Retract a bit");
+    line("G1 E-2 Z0.2 F2400 ;Retract and raise Z");
+    line("G1 X5 Y5 F3000 ;Wipe out");
+    line("G1 Z10 ;Raise Z more");
+    line("G90 ;Absolute positioning");
+    line("G1 X0 Y" + num(m.bed_y) + " ;Present print");
+    line("M106 S0 ;Turn-off fan");
+    line("M104 S0 ;Turn-off hotend");
+    line("M140 S0 ;Turn-off bed");
+    line("M84 X Y E ;Disable all steppers but Z");
+    line(";End of Gcode");
+    return out;
+}
+
+} // namespace pwb::slicer
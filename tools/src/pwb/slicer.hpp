@@ -0,0 +1,95 @@
+#pragma once
+
+#include "pwb/gerber_outline.hpp"
+#include "pwb/mesh.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pwb::slicer {
+
+using gerber::Coord;
+using gerber::Point;
+using gerber::PolygonSet;
+
+// Cross-sections of a closed mesh at each height in `z` (model units, mm),
+// in nanometres like the rest of the polygon code: every triangle crossing a
+// plane gives a segment, segments are chained into loops through the mesh
+// edges they share, and the loops are merged under the non-zero rule, so
+// outer contours come out counter-clockwise and holes clockwise. Vertices
+// within `tolerance` of a straight run are dropped. Heights must ascend;
+// layers run in parallel. Chains that do not close (holes in the mesh) are
+// dropped and counted in `open_chains`.
+std::vector<PolygonSet> sections(const mesh::Mesh& mesh, const std::vector<double>& z, Coord tolerance = 1000,
+                                 unsigned threads = 0, std::size_t* open_chains = nullptr);
+
+struct Options {
+    double layer_height = 0.2;  // mm
+    double first_layer = 0.16;  // mm, thinner for adhesion
+    double line_width = 0.4;    // mm
+    int walls = 2;              // perimeters, 0.8 mm of wall
+    int solid_layers = 4;       // top and bottom skin layers
+    double infill = 0.2;        // sparse infill density, 0..1
+    double infill_angle = 45;   // degrees; alternates sign every layer
+    Coord tolerance = 5000;     // contour simplification and offsets, nm
+    unsigned threads = 0;       // layers are processed concurrently; 0 = all cores
+};
+
+enum class Kind { OuterWall, InnerWall, Skin, Fill };
+
+struct Path {
+    Kind kind = Kind::Fill;
+    bool closed = false; // loops return to their first point without repeating it
+    std::vector<Point> points;
+};
+
+struct Layer {
+    double z = 0;       // top of the layer above the mesh's lowest point, mm
+    double height = 0;
+    PolygonSet region;  // the cross-section at mid-layer
+    std::vector<Path> paths; // in print order
+};
+
+struct Result {
+    std::vector<Layer> layers;
+    std::size_t triangles = 0;
+    std::size_t open_chains = 0;
+    double slice_seconds = 0; // plane intersection, chaining and merging
+    double wall_seconds = 0;  // perimeter offsets
+    double fill_seconds = 0;  // skin detection, infill lines and path ordering
+};
+
+// Walls, skins and rectilinear infill for every layer, starting from the
+// mesh's lowest point. Paths are ordered greedily from the end of the
+// previous one: inner walls, the outer wall, then skin and infill lines.
+Result slice(const mesh::Mesh& mesh, const Options& options = {});
+
+// Printer and material settings. The defaults are those of the Cura 5.6
+// ABS profile for the Ender-3 in STL/fdm/shield_design/sliced_V1.gcode.
+struct Machine {
+    std::string name = "Creality Ender-3";
+    double bed_x = 235, bed_y = 235;   // mm; the part is centred on the bed
+    double filament_diameter = 1.75;
+    int nozzle_temp = 250, bed_temp = 110;
+    int fan = 0;                        // 0-255 from the second layer on
+    double wall_speed = 65, skin_speed = 65, fill_speed = 130; // mm/s
+    double first_layer_speed = 10, first_layer_travel = 50, travel_speed = 200;
+    double acceleration = 1000;         // mm/s², for the time estimate
+    double retraction = 2, retraction_speed = 40;
+    double retract_after = 1.5;         // mm of travel before retracting
+};
+
+struct Totals {
+    double seconds = 0;  // trapezoidal moves, each starting and ending at rest
+    double filament = 0; // mm
+};
+
+Totals estimate(const Result& result, const Options& options, const Machine& machine = {});
+
+// Marlin G-code in the layout Cura writes: ";FLAVOR:Marlin", ";TIME:" and
+// ";Filament used:" headers, ";LAYER:" and ";TYPE:" markers, absolute E.
+std::string write_gcode(const Result& result, const Options& options, const Machine& machine,
+                        const std::string& title);
+
+} // namespace pwb::slicer
@@ -0,0 +1,348 @@
+#include "pwb/stencil.hpp"
+
+#include "pwb/polygon_ops.hpp"
+#include "pwb/silkscreen.hpp"
+#include "pwb/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+namespace pwb::stencil {
+
+namespace {
+
+constexpr double kMm2 = double(gerber::kNmPerMm) * double(gerber::kNmPerMm);
+constexpr Coord kTolerance = 1000; // chord error of round apertures kept as drawn
+
+Coord nm(double mm) { return Coord(std::llround(mm * gerber::kNmPerMm)); }
+double mm(Coord v) { return double(v) / gerber::kNmPerMm; }
+
+// Openings of all pads, one entry per rectangle; (ux, uy) is the axis that
+// points at the part body, the point (if any) is cut on that end.
+struct Panes {
+    std::vector<Coord> cx, cy, hu, hv, depth;
+    std::vector<std::int64_t> ux, uy;
+    std::vector<std::size_t> pad;
+
+    std::size_t size() const { return cx.size(); }
+    void add(std::size_t p, Coord x, Coord y, Coord u, Coord v, Coord d, std::int64_t dx, std::int64_t dy) {
+        cx.push_back(x), cy.push_back(y), hu.push_back(u), hv.push_back(v), depth.push_back(d);
+        ux.push_back(dx), uy.push_back(dy), pad.push_back(p);
+    }
+};
+
+bool matches(const Rule& r, const Pad& p, double area) {
+    return (r.package.empty() || r.package == p.package) && area >= r.min_area;
+}
+
+// Web width that leaves `coverage` of an L x W pad open with nu x nv panes.
+double web_for(double L, double W, int nu, int nv, double coverage) {
+    double lo = 0, hi = std::min(nu > 1 ? L / (nu - 1) : 1e300, nv > 1 ? W / (nv - 1) : 1e300);
+    for (int i = 0; i < 60; ++i) {
+        double t = (lo + hi) / 2;
+        double open = (L - (nu - 1) * t) * (W - (nv - 1) * t) / (L * W);
+        (open > coverage ? lo : hi) = t;
+    }
+    return lo;
+}
+
+// Corners of openings [from, size): each is a pentagon in its (u, v) frame,
+// and a plain rectangle has a zero-depth point, so all pads go through the
+// same arithmetic.
+void corners_from(const Panes& p, std::size_t from, gerber::Point* out) {
+    const Coord *cx = p.cx.data(), *cy = p.cy.data(), *hu = p.hu.data(), *hv = p.hv.data(), *dp = p.depth.data();
+    const std::int64_t *ux = p.ux.data(), *uy = p.uy.data();
+    for (std::size_t k = from; k < p.size(); ++k) {
+        const Coord a[5] = {-hu[k], hu[k] - dp[k], hu[k], hu[k] - dp[k], -hu[k]};
+        const Coord b[5] = {-hv[k], -hv[k], 0, hv[k], hv[k]};
+        for (int j = 0; j < 5; ++j) {
+            out[5 * k + j].x = cx[k] + ux[k] * a[j] - uy[k] * b[j];
+            out[5 * k + j].y = cy[k] + uy[k] * a[j] + ux[k] * b[j];
+        }
+    }
+}
+
+void corners_scalar(const Panes& p, gerber::Point* out) { corners_from(p, 0, out); }
+
+#if PWB_HAVE_AVX2
+PWB_TARGET_AVX2 inline __m256i load4(const std::int64_t* v) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+}
+
+// v * s for s in {-1, 0, 1}; AVX2 has no 64-bit multiply.
+PWB_TARGET_AVX2 inline __m256i times_unit(__m256i v, __m256i s) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i neg = _mm256_cmpgt_epi64(zero, s);
+    const __m256i kept = _mm256_andnot_si256(_mm256_cmpeq_epi64(s, zero), v);
+    return _mm256_sub_epi64(_mm256_xor_si256(kept, neg), neg);
+}
+
+// Four openings per step in 64-bit lanes; x and y are interleaved into
+// Points and written with one 128-bit store per corner.
+PWB_TARGET_AVX2 void corners_avx2(const Panes& p, gerber::Point* out) {
+    static_assert(sizeof(gerber::Point) == 16, "Point must be two packed 64-bit coordinates");
+    const std::size_t n = p.size() & ~std::size_t(3);
+    const __m256i zero = _mm256_setzero_si256();
+    for (std::size_t k = 0; k < n; k += 4) {
+        const __m256i cx = load4(p.cx.data() + k), cy = load4(p.cy.data() + k);
+        const __m256i hu = load4(p.hu.data() + k), hv = load4(p.hv.data() + k), dp = load4(p.depth.data() + k);
+        const __m256i ux = load4(p.ux.data() + k), uy = load4(p.uy.data() + k);
+        const __m256i tip = _mm256_sub_epi64(hu, dp), nhu = _mm256_sub_epi64(zero, hu), nhv = _mm256_sub_epi64(zero, hv);
+        const __m256i a[5] = {nhu, tip, hu, tip, nhu};
+        const __m256i b[5] = {nhv, nhv, zero, hv, hv};
+        for (int j = 0; j < 5; ++j) {
+            const __m256i x = _mm256_sub_epi64(_mm256_add_epi64(cx, times_unit(a[j], ux)), times_unit(b[j], uy));
+            const __m256i y = _mm256_add_epi64(_mm256_add_epi64(cy, times_unit(a[j], uy)), times_unit(b[j], ux));
+            const __m256i even = _mm256_unpacklo_epi64(x, y), odd = _mm256_unpackhi_epi64(x, y); // k, k+2 | k+1, k+3
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 5 * k + j), _mm256_castsi256_si128(even));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 5 * (k + 1) + j), _mm256_castsi256_si128(odd));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 5 * (k + 2) + j), _mm256_extracti128_si256(even, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 5 * (k + 3) + j), _mm256_extracti128_si256(odd, 1));
+        }
+    }
+    corners_from(p, n, out);
+}
+#endif
+
+using CornersFn = void (*)(const Panes&, gerber::Point*);
+
+CornersFn pick_corners(bool simd) {
+#if PWB_HAVE_AVX2
+    if (simd && cpu_has_avx2()) return corners_avx2;
+#endif
+    (void)simd;
+    return corners_scalar;
+}
+
+std::string fmt_mm(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.4f", v);
+    return buf;
+}
+
+} // namespace
+
+std::vector<Rule> default_rules() {
+    std::vector<Rule> rules;
+    for (const char* chip : {"R0805", "C0805", "CHIP-LED0805"}) {
+        Rule r;
+        r.package = chip;
+        r.shape = Shape::HomePlate;
+        r.point = 0.2; // removes 10 % of the pad
+        rules.push_back(r);
+    }
+    Rule tab;
+    tab.package = "SOT223";
+    tab.shape = Shape::WindowPane;
+    tab.min_area = 4.0;
+    tab.coverage = 0.6;
+    tab.max_pane = 1.5;
+    rules.push_back(tab);
+    Rule ground = tab;
+    ground.package = "ESP-WROOM-32";
+    ground.min_area = 16.0;
+    ground.coverage = 0.5;
+    ground.max_pane = 1.6;
+    rules.push_back(ground);
+    return rules;
+}
+
+std::vector<Pad> paste_pads(const gerber::Layer& paste, const eagle::Board* board, int layer) {
+    std::vector<Pad> pads;
+    pads.reserve(paste.flashes.size());
+    for (const gerber::Flash& f : paste.flashes) {
+        const gerber::Aperture& ap = paste.apertures.at(f.aperture);
+        gerber::Box e = ap.extent();
+        if (e.empty()) continue;
+        Pad p;
+        p.x = f.x + (e.min_x + e.max_x) / 2;
+        p.y = f.y + (e.min_y + e.max_y) / 2;
+        p.width = e.width(), p.height = e.height();
+        p.body_x = p.x, p.body_y = p.y;
+        if (ap.shape != gerber::ApertureShape::Rectangle || ap.hole > 0) {
+            p.outline = gerber::aperture_outline(ap, kTolerance);
+            for (gerber::Point& q : p.outline.points) q.x += f.x, q.y += f.y;
+        }
+        pads.push_back(std::move(p));
+    }
+    if (!board) return pads;
+
+    // SMD centres on this side, in nanometres.
+    struct Smd {
+        Coord x, y;
+        const eagle::Element* element;
+        const std::string* name;
+    };
+    std::vector<Smd> smds;
+    for (const eagle::Element& e : board->elements) {
+        const eagle::Package* pkg = board->package_of(e);
+        if (!pkg) continue;
+        eagle::Placement pl = eagle::placement(e);
+        for (const eagle::Smd& s : pkg->smds) {
+            if (pl.layer(s.layer) != layer) continue;
+            double bx, by;
+            pl.apply(s.x, s.y, bx, by);
+            smds.push_back({nm(bx), nm(by), &e, &s.name});
+        }
+    }
+    const double reach = 100'000; // 0.1 mm; paste is concentric with its pad
+    for (Pad& p : pads) {
+        const Smd* best = nullptr;
+        double best_d = reach;
+        for (const Smd& s : smds) {
+            double d = std::hypot(double(s.x - p.x), double(s.y - p.y));
+            if (d < best_d) best_d = d, best = &s;
+        }
+        if (!best) continue;
+        p.element = best->element->name;
+        p.package = best->element->package;
+        p.pad = *best->name;
+        p.body_x = nm(best->element->x), p.body_y = nm(best->element->y);
+    }
+    return pads;
+}
+
+Result reduce(const std::vector<Pad>& pads, const std::vector<Rule>& rules, double thickness_mm, bool simd) {
+    Result result;
+    result.pads.resize(pads.size());
+    Panes panes;
+    std::vector<std::size_t> as_drawn; // non-rectangular pads no rule reduces
+    for (std::size_t i = 0; i < pads.size(); ++i) {
+        const Pad& p = pads[i];
+        PadResult& pr = result.pads[i];
+        pr.pad_area = p.outline.size() ? poly::area(p.outline) / kMm2 : double(p.width) * double(p.height) / kMm2;
+        for (std::size_t r = 0; r < rules.size() && pr.rule < 0; ++r)
+            if (matches(rules[r], p, pr.pad_area)) pr.rule = int(r);
+        if (p.outline.size() &&
+            (pr.rule < 0 || (rules[std::size_t(pr.rule)].shape == Shape::Inset && rules[std::size_t(pr.rule)].inset <= 0))) {
+            as_drawn.push_back(i);
+            continue;
+        }
+
+        // Pads are axis-aligned, so the body direction snaps to an axis.
+        const double dx = double(p.body_x - p.x), dy = double(p.body_y - p.y);
+        std::int64_t ux = 1, uy = 0;
+        if (std::abs(dy) > std::abs(dx)) ux = 0, uy = dy > 0 ? 1 : -1;
+        else if (dx < 0) ux = -1;
+        Coord hu = (ux ? p.width : p.height) / 2, hv = (ux ? p.height : p.width) / 2;
+        if (pr.rule < 0) {
+            panes.add(i, p.x, p.y, hu, hv, 0, ux, uy);
+            continue;
+        }
+        const Rule& rule = rules[std::size_t(pr.rule)];
+        const Coord inset = nm(rule.inset);
+        hu = std::max(hu / 4, hu - inset), hv = std::max(hv / 4, hv - inset);
+        if (rule.shape == Shape::Inset) {
+            panes.add(i, p.x, p.y, hu, hv, 0, ux, uy);
+        } else if (rule.shape == Shape::HomePlate) {
+            panes.add(i, p.x, p.y, hu, hv, Coord(rule.point * double(2 * hu)), ux, uy);
+        } else {
+            const double L = mm(2 * hu), W = mm(2 * hv);
+            const int nu = std::max(1, int(std::ceil(L / rule.max_pane))), nv = std::max(1, int(std::ceil(W / rule.max_pane)));
+            if (nu == 1 && nv == 1) {
+                // Too small to split: shrink to the same coverage instead.
+                const double s = std::sqrt(rule.coverage);
+                panes.add(i, p.x, p.y, Coord(double(hu) * s), Coord(double(hv) * s), 0, ux, uy);
+                continue;
+            }
+            const double t = web_for(L, W, nu, nv, rule.coverage);
+            const double pu = (L - (nu - 1) * t) / nu, pv = (W - (nv - 1) * t) / nv;
+            for (int a = 0; a < nu; ++a) {
+                for (int b = 0; b < nv; ++b) {
+                    const Coord ou = nm(-L / 2 + pu / 2 + a * (pu + t)), ov = nm(-W / 2 + pv / 2 + b * (pv + t));
+                    panes.add(i, p.x + ux * ou - uy * ov, p.y + uy * ou + ux * ov, nm(pu / 2), nm(pv / 2), 0, ux, uy);
+                }
+            }
+        }
+    }
+
+    const std::size_t n = panes.size();
+    result.apertures.points.resize(5 * n);
+    result.apertures.offsets.resize(n + 1);
+    pick_corners(simd)(panes, result.apertures.points.data());
+    for (std::size_t k = 0; k <= n; ++k) result.apertures.offsets[k] = std::uint32_t(5 * k);
+    result.pad_of = std::move(panes.pad);
+
+    for (PadResult& pr : result.pads) pr.area_ratio = 1e300;
+    for (std::size_t k = 0; k < n; ++k) {
+        const double L = mm(2 * panes.hu[k]), W = mm(2 * panes.hv[k]), d = mm(panes.depth[k]);
+        const double area = L * W - d * W / 2;
+        const double wall = 2 * (L - d) + W + 2 * std::hypot(d, W / 2);
+        PadResult& pr = result.pads[result.pad_of[k]];
+        ++pr.openings;
+        pr.paste_area += area;
+        pr.area_ratio = std::min(pr.area_ratio, area / (wall * thickness_mm));
+    }
+
+    // Round, obround and macro pads cut 1:1 keep their own outline; the walls
+    // of any hole count towards the area ratio.
+    for (std::size_t i : as_drawn) {
+        const PolygonSet& o = pads[i].outline;
+        PadResult& pr = result.pads[i];
+        double wall = 0;
+        for (std::size_t k = 0; k < o.size(); ++k) {
+            const gerber::Point* q = o.begin(k);
+            const std::size_t m = o.count(k);
+            result.apertures.points.insert(result.apertures.points.end(), q, q + m);
+            result.apertures.close();
+            result.pad_of.push_back(i);
+            if (gerber::signed_area2(q, m) > 0) ++pr.openings;
+            for (std::size_t j = 0; j < m; ++j) {
+                const gerber::Point& a = q[j];
+                const gerber::Point& b = q[j + 1 == m ? 0 : j + 1];
+                wall += std::hypot(mm(b.x - a.x), mm(b.y - a.y));
+            }
+        }
+        pr.paste_area = pr.pad_area;
+        if (wall > 0) pr.area_ratio = pr.pad_area / (wall * thickness_mm);
+    }
+    return result;
+}
+
+std::string paste_gerber(const PolygonSet& apertures, const std::string& name, const gerber::Format& format,
+                         gerber::Units units) {
+    char fs[64];
+    std::snprintf(fs, sizeof fs, "%%FS%c%cX%d%dY%d%d*%%\n", format.omit_trailing ? 'T' : 'L',
+                  format.incremental ? 'I' : 'A', format.x_integer, format.x_decimal, format.y_integer, format.y_decimal);
+    std::string out = "G04 Stencil apertures after per-package reduction*\nG75*\n";
+    out += units == gerber::Units::Inches ? "%MOIN*%\n" : "%MOMM*%\n";
+    out += fs;
+    out += "%LPD*%\n%IN" + name + "*%\n%IPPOS*%\n";
+    out += silk::region_block(apertures, format, units);
+    out += "M02*\n";
+    return out;
+}
+
+std::string svg(const PolygonSet& apertures, const gerber::Box& board, const gerber::Layer* profile, bool mirror) {
+    gerber::Box box = board;
+    if (box.empty())
+        for (const gerber::Point& p : apertures.points) box.add(p.x, p.y);
+    if (box.empty()) throw std::invalid_argument("stencil: nothing to draw");
+    auto X = [&](Coord x) { return fmt_mm(mirror ? mm(box.max_x - x) : mm(x - box.min_x)); };
+    auto Y = [&](Coord y) { return fmt_mm(mm(box.max_y - y)); };
+    const std::string w = fmt_mm(mm(box.width())), h = fmt_mm(mm(box.height()));
+
+    std::string out = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + w + "mm\" height=\"" + h + "mm\" viewBox=\"0 0 " + w +
+           " " + h + "\">\n";
+    if (profile) {
+        out += "<g id=\"profile\" fill=\"none\" stroke=\"#0000ff\" stroke-width=\"0.01\">\n";
+        for (const gerber::Stroke& s : profile->strokes)
+            out += "<line x1=\"" + X(s.x0) + "\" y1=\"" + Y(s.y0) + "\" x2=\"" + X(s.x1) + "\" y2=\"" + Y(s.y1) + "\"/>\n";
+        out += "</g>\n";
+    }
+    out += "<g id=\"apertures\" fill=\"none\" stroke=\"#ff0000\" stroke-width=\"0.01\">\n";
+    for (std::size_t k = 0; k < apertures.size(); ++k) {
+        const gerber::Point* p = apertures.begin(k);
+        out += "<path d=\"M" + X(p[0].x) + "," + Y(p[0].y);
+        for (std::size_t i = 1; i < apertures.count(k); ++i) out += " L" + X(p[i].x) + "," + Y(p[i].y);
+        out += " Z\"/>\n";
+    }
+    out += "</g>\n</svg>\n";
+    return out;
+}
+
+} // namespace pwb::stencil
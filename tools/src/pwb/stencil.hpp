@@ -0,0 +1,88 @@
+#pragma once
+
+#include "pwb/eagle_board.hpp"
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pwb::stencil {
+
+using gerber::Coord;
+using gerber::PolygonSet;
+
+enum class Shape {
+    Inset,      // the pad shrunk on every side
+    HomePlate,  // inset, with the edge facing the part body drawn to a point
+    WindowPane, // a grid of openings separated by webs, for large thermal pads
+};
+
+// Aperture rule for the pads of one package. The first rule whose package
+// matches (empty = any) and whose min_area the pad reaches is used.
+struct Rule {
+    std::string package;
+    Shape shape = Shape::Inset;
+    double min_area = 0;  // mm²
+    double inset = 0;     // mm removed from every side
+    double point = 0;     // home plate: depth of the point, fraction of the pad length
+    double coverage = 0;  // window pane: paste area over pad area
+    double max_pane = 0;  // window pane: largest opening side, mm
+};
+
+// Rules for hand-assembled boards with a 0.12 mm stencil: 0805 chips get a
+// 10 % home plate so the paste under the body cannot bridge or ball, SOT-223
+// and module ground tabs a window pane near 50-60 % coverage, everything else
+// is cut 1:1.
+std::vector<Rule> default_rules();
+
+// One paste flash, centred on its aperture's bounding box. A pad that no rule
+// reduces is cut as drawn; a rule reduces any other shape as its bounding
+// rectangle.
+struct Pad {
+    Coord x = 0, y = 0;
+    Coord width = 0, height = 0;
+    PolygonSet outline;   // board coordinates; empty for plain rectangles
+    std::string element;  // from the board file; empty if no SMD lands here
+    std::string package;
+    std::string pad;
+    Coord body_x = 0, body_y = 0; // element origin, which home plates point at
+};
+
+// Pads of a paste layer, matched to the SMDs of `board` on `layer` (kTop or
+// kBottom) when a board is given.
+std::vector<Pad> paste_pads(const gerber::Layer& paste, const eagle::Board* board, int layer);
+
+struct PadResult {
+    int rule = -1;          // index into the rules, -1 when none matched (kept 1:1)
+    std::size_t openings = 0;
+    double pad_area = 0;    // mm²
+    double paste_area = 0;  // mm²
+    double area_ratio = 0;  // smallest opening area / wall area (IPC-7525 asks for >= 0.66)
+};
+
+struct Result {
+    // Counter-clockwise pentagons, one per rectangular opening, followed by
+    // the outlines of the non-rectangular pads cut as drawn (holes clockwise).
+    PolygonSet apertures;
+    std::vector<std::size_t> pad_of; // pad index per contour
+    std::vector<PadResult> pads;
+};
+
+// Applies the rules to every pad. Rules only decide how each pad splits into
+// rectangular openings; all openings are then built in one branch-free pass
+// over structure-of-arrays coordinates, four at a time with AVX2 when `simd`
+// is set and the CPU has it.
+Result reduce(const std::vector<Pad>& pads, const std::vector<Rule>& rules, double thickness_mm, bool simd = true);
+
+// A complete RS-274X paste layer holding `apertures` as G36/G37 regions.
+std::string paste_gerber(const PolygonSet& apertures, const std::string& name, const gerber::Format& format,
+                         gerber::Units units);
+
+// Laser-cutter SVG in millimetres over `board`: openings as red hairline cuts
+// and, when given, the profile strokes in blue for alignment. `mirror` flips
+// x, for a bottom-side stencil cut from the top.
+std::string svg(const PolygonSet& apertures, const gerber::Box& board, const gerber::Layer* profile, bool mirror);
+
+} // namespace pwb::stencil
@@ -0,0 +1,105 @@
+#include "pwb/stl.hpp"
+
+#include "pwb/parallel.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace pwb::stl {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 80;
+constexpr std::size_t kFirstRecord = 84;
+
+Color read_color(const unsigned char* p) { return {p[0], p[1], p[2], p[3]}; }
+
+std::uint8_t expand5(unsigned v) { return std::uint8_t((v << 3) | (v >> 2)); }
+
+} // namespace
+
+Header parse_header(const unsigned char* header80) {
+    Header h;
+    std::string_view raw(reinterpret_cast<const char*>(header80), kHeaderSize);
+    // Binary payloads follow the keys, so search the raw bytes, not a C string.
+    std::size_t color = raw.find("COLOR=");
+    if (color != std::string_view::npos && color + 6 + 4 <= kHeaderSize) {
+        h.has_color = true;
+        h.color = read_color(header80 + color + 6);
+    }
+    std::size_t material = raw.find("MATERIAL=");
+    if (material != std::string_view::npos && material + 9 + 12 <= kHeaderSize) {
+        h.has_material = true;
+        h.diffuse = read_color(header80 + material + 9);
+        h.specular = read_color(header80 + material + 13);
+        h.ambient = read_color(header80 + material + 17);
+    }
+    std::size_t end = std::min({color, material, raw.size()});
+    std::size_t n = 0;
+    while (n < end && raw[n] >= 0x20 && raw[n] < 0x7f) ++n;
+    while (n > 0 && raw[n - 1] == ' ') --n;
+    h.text.assign(raw.data(), n);
+    return h;
+}
+
+bool facet_color(std::uint16_t attribute, const Header& header, Color& out) {
+    if (!header.has_color || (attribute & 0x8000)) return false;
+    out.r = expand5(attribute & 31u);
+    out.g = expand5((attribute >> 5) & 31u);
+    out.b = expand5((attribute >> 10) & 31u);
+    out.a = 255;
+    return true;
+}
+
+View parse(const unsigned char* data, std::size_t size, const std::string& what) {
+    if (size < kFirstRecord) throw std::runtime_error(what + ": " + std::to_string(size) + " bytes, too short for binary STL");
+    const std::uint64_t count =
+        std::uint64_t(data[80]) | std::uint64_t(data[81]) << 8 | std::uint64_t(data[82]) << 16 | std::uint64_t(data[83]) << 24;
+    const std::uint64_t needed = kFirstRecord + count * TriangleView::kStride;
+    if (needed > size) {
+        if (std::string_view(reinterpret_cast<const char*>(data), 5) == "solid")
+            throw std::runtime_error(what + ": ASCII STL is not supported");
+        throw std::runtime_error(what + ": header says " + std::to_string(count) + " triangles (" +
+                                 std::to_string(needed) + " bytes) but the file has " + std::to_string(size));
+    }
+    View v;
+    v.header = parse_header(data);
+    v.triangles = TriangleView(data + kFirstRecord, std::size_t(count));
+    v.trailing_bytes = size - std::size_t(needed);
+    return v;
+}
+
+Bounds bounds(const TriangleView& triangles, unsigned threads) {
+    const std::size_t chunk = 1 << 16;
+    const std::size_t chunks = (triangles.size() + chunk - 1) / chunk;
+    std::vector<Bounds> part(chunks);
+    parallel_for(
+        chunks,
+        [&](std::size_t c) {
+            const std::size_t first = c * chunk, last = std::min(triangles.size(), first + chunk);
+            float lo[3] = {1e30f, 1e30f, 1e30f}, hi[3] = {-1e30f, -1e30f, -1e30f};
+            for (std::size_t i = first; i < last; ++i) {
+                float v[9];
+                std::memcpy(v, triangles.record(i) + 12, sizeof v);
+                for (int k = 0; k < 9; ++k) {
+                    lo[k % 3] = std::min(lo[k % 3], v[k]);
+                    hi[k % 3] = std::max(hi[k % 3], v[k]);
+                }
+            }
+            part[c].min = {lo[0], lo[1], lo[2]};
+            part[c].max = {hi[0], hi[1], hi[2]};
+        },
+        threads);
+    Bounds b;
+    for (const Bounds& p : part) {
+        b.min = {std::min(b.min.x, p.min.x), std::min(b.min.y, p.min.y), std::min(b.min.z, p.min.z)};
+        b.max = {std::max(b.max.x, p.max.x), std::max(b.max.y, p.max.y), std::max(b.max.z, p.max.z)};
+    }
+    return b;
+}
+
+File::File(const std::string& path) : file_(path) { view_ = parse(file_.data(), file_.size(), path); }
+
+} // namespace pwb::stl
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "pwb/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace pwb::stl {
+
+struct Vec3 {
+    float x = 0, y = 0, z = 0;
+};
+
+struct Color {
+    std::uint8_t r = 0, g = 0, b = 0, a = 255;
+};
+
+// 80-byte header. Materialise Magics (and Autodesk's ATF exporter, which
+// writes "STLB ATF <version> COLOR=") store a default colour as four bytes
+// after "COLOR=" and diffuse/specular/ambient after "MATERIAL=".
+struct Header {
+    std::string text;             // printable prefix, trailing spaces dropped ("STLB ATF 13.20.0.188")
+    bool has_color = false;
+    Color color;
+    bool has_material = false;
+    Color diffuse, specular, ambient;
+};
+
+Header parse_header(const unsigned char* header80);
+
+// Per-facet colour from the 16-bit attribute word, Materialise layout: bit 15
+// clear means the facet has its own colour, red in bits 0-4, green 5-9, blue
+// 10-14. Returns false (and leaves `out` alone) when the facet uses the
+// default colour or the file has no COLOR= header.
+bool facet_color(std::uint16_t attribute, const Header& header, Color& out);
+
+// Triangles of a binary STL in place: a 50-byte stride over the mapped bytes,
+// nothing copied. Records are not 4-byte aligned, so fields are read with
+// memcpy (a single unaligned load on x86 and ARMv8). STL is little-endian.
+class TriangleView {
+public:
+    static constexpr std::size_t kStride = 50;
+
+    TriangleView() = default;
+    TriangleView(const unsigned char* first, std::size_t count) : base_(first), count_(count) {}
+
+    std::size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    const unsigned char* record(std::size_t i) const { return base_ + i * kStride; }
+
+    Vec3 normal(std::size_t i) const { return load(record(i)); }
+    Vec3 vertex(std::size_t i, int k) const { return load(record(i) + 12 + 12 * k); }
+    std::uint16_t attribute(std::size_t i) const {
+        const unsigned char* p = record(i) + 48;
+        return std::uint16_t(p[0] | p[1] << 8);
+    }
+
+    // Triangles [first, first + count), for splitting work across threads.
+    TriangleView slice(std::size_t first, std::size_t count) const { return {record(first), count}; }
+
+private:
+    static Vec3 load(const unsigned char* p) {
+        Vec3 v;
+        std::memcpy(&v, p, sizeof v);
+        return v;
+    }
+
+    const unsigned char* base_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+static_assert(sizeof(Vec3) == 12, "Vec3 must match the STL record layout");
+
+// A binary STL held in memory by someone else (a zip member, a test buffer).
+struct View {
+    Header header;
+    TriangleView triangles;
+    std::size_t trailing_bytes = 0; // past the last record; some exporters pad
+};
+
+// Checks the record count against `size` and returns the view. Throws
+// std::runtime_error for short files and for ASCII STL ("solid ..." whose
+// size does not fit the binary count).
+View parse(const unsigned char* data, std::size_t size, const std::string& what = "STL");
+
+struct Bounds {
+    Vec3 min{1e30f, 1e30f, 1e30f};
+    Vec3 max{-1e30f, -1e30f, -1e30f};
+};
+
+// Axis-aligned box of all vertices; split across `threads` (0 = all cores).
+Bounds bounds(const TriangleView& triangles, unsigned threads = 0);
+
+// Memory-mapped binary STL; views stay valid while the object lives.
+class File {
+public:
+    explicit File(const std::string& path);
+
+    const Header& header() const { return view_.header; }
+    const TriangleView& triangles() const { return view_.triangles; }
+    std::size_t trailing_bytes() const { return view_.trailing_bytes; }
+    std::size_t size_bytes() const { return file_.size(); }
+    const std::string& path() const { return file_.path(); }
+
+private:
+    MappedFile file_;
+    View view_;
+};
+
+} // namespace pwb::stl
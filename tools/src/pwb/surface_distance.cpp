@@ -0,0 +1,170 @@
+#include "pwb/surface_distance.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace pwb::dist {
+
+namespace {
+
+// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5).
+D3 closest_on_triangle(const D3& p, const D3& a, const D3& b, const D3& c) {
+    const D3 ab = sub(b, a), ac = sub(c, a), ap = sub(p, a);
+    const double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+    const D3 bp = sub(p, b);
+    const double d3_ = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3_ >= 0 && d4 <= d3_) return b;
+    const double vc = d1 * d4 - d3_ * d2;
+    if (vc <= 0 && d1 >= 0 && d3_ <= 0) return add(a, mul(ab, d1 / (d1 - d3_)));
+    const D3 cp = sub(p, c);
+    const double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return add(a, mul(ac, d2 / (d2 - d6)));
+    const double va = d3_ * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3_ >= 0 && d5 - d6 >= 0)
+        return add(b, mul(sub(c, b), (d4 - d3_) / ((d4 - d3_) + (d5 - d6))));
+    const double denom = 1 / (va + vb + vc);
+    return add(a, add(mul(ab, vb * denom), mul(ac, vc * denom)));
+}
+
+double box_distance2(const bvh::Aabb& b, const D3& p) {
+    const double dx = std::max({double(b.min.x) - p.x, 0.0, p.x - double(b.max.x)});
+    const double dy = std::max({double(b.min.y) - p.y, 0.0, p.y - double(b.max.y)});
+    const double dz = std::max({double(b.min.z) - p.z, 0.0, p.z - double(b.max.z)});
+    return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace
+
+Surface::Surface(const mesh::Mesh& mesh, const bvh::BuildOptions& options) {
+    std::vector<bvh::Aabb> boxes(mesh.triangles.size());
+    for (std::size_t t = 0; t < boxes.size(); ++t)
+        for (std::uint32_t v : mesh.triangles[t]) boxes[t].grow(mesh.vertices[v]);
+    tree_ = bvh::build(boxes, options);
+    ids_ = tree_.items;
+    corners_.reserve(3 * ids_.size());
+    for (std::uint32_t id : ids_)
+        for (std::uint32_t v : mesh.triangles[id]) corners_.push_back(mesh.vertices[v]);
+    // Leaves now address corners_ by slot; items[i] == i.
+    for (std::size_t i = 0; i < tree_.items.size(); ++i) tree_.items[i] = std::uint32_t(i);
+}
+
+Closest Surface::closest(const Vec3& q, float reach) const {
+    Closest best;
+    if (tree_.nodes.empty()) return best;
+    const D3 p = d3(q);
+    double best2 = double(reach) * reach;
+    D3 point{};
+    std::uint32_t slot = mesh::kNone;
+    std::uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const bvh::Node& n = tree_.nodes[stack[--top]];
+        if (box_distance2(n.box, p) >= best2) continue;
+        if (n.count) {
+            for (std::uint32_t i = n.first; i < n.first + n.count; ++i) {
+                const Vec3* c = &corners_[3 * std::size_t(i)];
+                const D3 x = closest_on_triangle(p, d3(c[0]), d3(c[1]), d3(c[2]));
+                const D3 d = sub(x, p);
+                const double d2 = dot(d, d);
+                if (d2 < best2) best2 = d2, point = x, slot = i;
+            }
+            continue;
+        }
+        // Nearer child on top of the stack.
+        std::uint32_t a = n.first, b = n.first + 1;
+        if (box_distance2(tree_.nodes[a].box, p) < box_distance2(tree_.nodes[b].box, p)) std::swap(a, b);
+        stack[top++] = a;
+        stack[top++] = b;
+    }
+    if (slot == mesh::kNone) return best;
+    best.distance = float(std::sqrt(best2));
+    best.point = {float(point.x), float(point.y), float(point.z)};
+    best.triangle = ids_[slot];
+    return best;
+}
+
+std::vector<Vec3> sample(const mesh::Mesh& mesh, float spacing) {
+    std::vector<Vec3> out(mesh.vertices);
+    if (spacing <= 0) return out;
+    for (const mesh::Triangle& t : mesh.triangles) {
+        const D3 a = d3(mesh.vertices[t[0]]), b = d3(mesh.vertices[t[1]]), c = d3(mesh.vertices[t[2]]);
+        const D3 ab = sub(b, a), ac = sub(c, a), bc = sub(c, b);
+        const double longest = std::sqrt(std::max({dot(ab, ab), dot(ac, ac), dot(bc, bc)}));
+        const int n = std::clamp(int(std::ceil(longest / spacing)), 1, 1024);
+        for (int i = 0; i <= n; ++i)
+            for (int j = 0; i + j <= n; ++j) {
+                if ((i == 0 && j == 0) || i == n || j == n) continue; // corners are vertices already
+                const D3 p = add(a, add(mul(ab, double(i) / n), mul(ac, double(j) / n)));
+                out.push_back({float(p.x), float(p.y), float(p.z)});
+            }
+    }
+    return out;
+}
+
+std::vector<Vec3> sample_area(const mesh::Mesh& mesh, float spacing, std::vector<std::uint32_t>* triangles) {
+    std::vector<Vec3> out;
+    if (triangles) triangles->clear();
+    if (spacing <= 0) return out;
+    const double cell = double(spacing) * spacing;
+    // R2 sequence (Roberts, 2018) for the points, a Weyl step for the rounding.
+    const double a1 = 0.7548776662466927, a2 = 0.5698402909980532, phi = 0.6180339887498949;
+    for (std::size_t t = 0; t < mesh.triangles.size(); ++t) {
+        const mesh::Triangle& tri = mesh.triangles[t];
+        const D3 a = d3(mesh.vertices[tri[0]]), ab = sub(d3(mesh.vertices[tri[1]]), a), ac = sub(d3(mesh.vertices[tri[2]]), a);
+        const D3 n{ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x};
+        const double expected = 0.5 * std::sqrt(dot(n, n)) / cell, jitter = std::fmod(double(t) * phi, 1.0);
+        const std::size_t k = std::size_t(expected + jitter);
+        for (std::size_t j = 0; j < k; ++j) {
+            const double u = std::fmod(jitter + double(j + 1) * a1, 1.0), v = std::fmod(0.5 + double(j + 1) * a2, 1.0);
+            const double r = std::sqrt(u);
+            const D3 p = add(a, add(mul(ab, r * (1 - v)), mul(ac, r * v)));
+            out.push_back({float(p.x), float(p.y), float(p.z)});
+            if (triangles) triangles->push_back(std::uint32_t(t));
+        }
+    }
+    return out;
+}
+
+Hausdorff hausdorff(const mesh::Mesh& a, const mesh::Mesh& b, float spacing, unsigned threads) {
+    const auto t0 = std::chrono::steady_clock::now();
+    Hausdorff h;
+    if (a.triangles.empty() || b.triangles.empty()) return h;
+    const Surface sa(a), sb(b);
+    struct Block {
+        double max = 0, sum = 0, sum2 = 0;
+    };
+    double sum = 0, sum2 = 0;
+    for (int dir = 0; dir < 2; ++dir) {
+        const std::vector<Vec3> points = sample(dir ? b : a, spacing);
+        const Surface& target = dir ? sa : sb;
+        const std::size_t block = 4096, blocks = (points.size() + block - 1) / block;
+        std::vector<Block> partial(blocks);
+        parallel_for(
+            blocks,
+            [&](std::size_t k) {
+                Block& r = partial[k];
+                for (std::size_t i = k * block; i < std::min(points.size(), (k + 1) * block); ++i) {
+                    const double d = target.closest(points[i]).distance;
+                    r.max = std::max(r.max, d), r.sum += d, r.sum2 += d * d;
+                }
+            },
+            threads);
+        double& worst = dir ? h.backward : h.forward;
+        for (const Block& r : partial) worst = std::max(worst, r.max), sum += r.sum, sum2 += r.sum2;
+        h.samples += points.size();
+    }
+    h.mean = sum / double(h.samples);
+    h.rms = std::sqrt(sum2 / double(h.samples));
+    h.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return h;
+}
+
+} // namespace pwb::dist
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "pwb/bvh.hpp"
+#include "pwb/mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pwb::dist {
+
+using stl::Vec3;
+
+struct Closest {
+    float distance = 1e30f;
+    Vec3 point;                               // on the surface
+    std::uint32_t triangle = mesh::kNone;     // index in the mesh; kNone if nothing within reach
+};
+
+// Nearest-point queries against a triangle mesh. Corners are copied in BVH
+// leaf order, so a leaf is one contiguous read; the walk visits the nearer
+// child first and prunes boxes farther than the best distance so far.
+class Surface {
+public:
+    explicit Surface(const mesh::Mesh& mesh, const bvh::BuildOptions& options = {});
+
+    std::size_t triangles() const { return ids_.size(); }
+    const bvh::Tree& tree() const { return tree_; }
+
+    // Nearest point within `reach` of p.
+    Closest closest(const Vec3& p, float reach = 1e30f) const;
+
+private:
+    bvh::Tree tree_;
+    std::vector<Vec3> corners_;       // 3 per triangle, leaf order
+    std::vector<std::uint32_t> ids_;  // mesh triangle of each leaf slot
+};
+
+// Points spread over the surface at about `spacing` apart: every vertex, then
+// per triangle a barycentric grid fine enough for its longest edge.
+std::vector<Vec3> sample(const mesh::Mesh& mesh, float spacing);
+
+// Points scattered evenly by area: each stands for spacing^2 of surface, so
+// counts measure area. Per triangle the expected count is rounded up or down
+// by a hash of its index and the points follow a low-discrepancy sequence, so
+// the result is deterministic. `triangles`, if given, receives the triangle
+// each point lies on.
+std::vector<Vec3> sample_area(const mesh::Mesh& mesh, float spacing, std::vector<std::uint32_t>* triangles = nullptr);
+
+struct Hausdorff {
+    double forward = 0;   // max over samples of `a` of the distance to `b`
+    double backward = 0;  // and the other way round
+    double mean = 0;      // both directions together
+    double rms = 0;
+    std::size_t samples = 0;
+    double seconds = 0;
+
+    double max() const { return forward > backward ? forward : backward; }
+};
+
+// Symmetric Hausdorff distance between two surfaces, sampled at `spacing`
+// (model units) and evaluated on `threads` threads (0 = all cores).
+Hausdorff hausdorff(const mesh::Mesh& a, const mesh::Mesh& b, float spacing, unsigned threads = 0);
+
+} // namespace pwb::dist
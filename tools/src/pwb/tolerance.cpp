@@ -0,0 +1,211 @@
+#include "pwb/tolerance.hpp"
+
+#include "pwb/parallel.hpp"
+#include "pwb/raycast.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace pwb::tolerance {
+
+namespace {
+
+constexpr float kSqrt2 = 1.41421356f;
+
+Vec3 add(const Vec3& a, const Vec3& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+Vec3 sub(const Vec3& a, const Vec3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+Vec3 scale(const Vec3& a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec3 cross(const Vec3& a, const Vec3& b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+float length(const Vec3& a) { return std::sqrt(dot(a, a)); }
+Vec3 unit(const Vec3& a) {
+    const float l = length(a);
+    return l > 0 ? scale(a, 1.0f / l) : Vec3{0, 0, 0};
+}
+
+std::uint64_t mix(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// A vertex near the beam and what moves it.
+struct Point {
+    Vec3 p, n;      // position and unit normal
+    int part, side; // 0 = top / emitter side, 1 = bottom / receiver side
+};
+
+struct Batch {
+    std::size_t passed = 0, clear = 0;
+    std::vector<std::size_t> histogram = std::vector<std::size_t>(11, 0);
+    std::size_t worst = 0;
+    double worst_fraction = 2;
+};
+
+} // namespace
+
+Stream::Stream(std::uint64_t seed, std::uint64_t index) : state_(mix(seed * 0x9e3779b97f4a7c15ull + mix(index))) {}
+
+std::uint64_t Stream::next() {
+    state_ += 0x9e3779b97f4a7c15ull;
+    return mix(state_);
+}
+
+double Stream::uniform() { return double(next() >> 11) * 0x1.0p-53; }
+
+double Stream::normal() {
+    if (has_spare_) {
+        has_spare_ = false;
+        return spare_;
+    }
+    // Marsaglia's polar method: no sine or cosine, one logarithm per pair.
+    double x, y, r2;
+    do {
+        x = 2 * uniform() - 1, y = 2 * uniform() - 1;
+        r2 = x * x + y * y;
+    } while (r2 >= 1 || r2 == 0);
+    const double f = std::sqrt(-2 * std::log(r2) / r2);
+    spare_ = y * f, has_spare_ = true;
+    return x * f;
+}
+
+float Distribution::draw(Stream& s) const {
+    if (width <= 0) return 0;
+    if (kind == Kind::Uniform) return float((2 * s.uniform() - 1) * width);
+    return float(std::clamp(s.normal() * width / 3, -double(width), double(width)));
+}
+
+double Report::margin() const {
+    if (!samples) return 0;
+    const double p = yield();
+    return 1.96 * std::sqrt(p * (1 - p) / double(samples));
+}
+
+Report run(const mesh::Mesh& top, const mesh::Mesh& bottom, const beam::Beam& beam, const Tolerances& t,
+           const Options& o) {
+    if (o.disc < 1 || o.batch < 1) throw std::runtime_error("tolerance: disc and batch must be positive");
+    const auto t0 = std::chrono::steady_clock::now();
+    const Vec3 from = beam.emitter.centre, span = sub(beam.receiver.centre, from);
+    const float gap = length(span);
+    if (!(gap > 0)) throw std::runtime_error("tolerance: emitter and receiver coincide");
+    const Vec3 axis = scale(span, 1.0f / gap);
+    const Vec3 helper = std::fabs(axis.x) < 0.9f ? Vec3{1, 0, 0} : Vec3{0, 1, 0};
+    const Vec3 u = unit(cross(axis, helper)), v = cross(axis, u);
+
+    // Every line of sight stays inside the cylinder around the nominal axis
+    // that holds both displaced lenses, and no point of a triangle moves
+    // farther than its corners can; anything farther out never matters.
+    const float lens = std::max(beam.emitter.radius, beam.receiver.radius) +
+                       kSqrt2 * (std::fabs(t.bore.width) + std::fabs(t.placement.width));
+    const float moves = std::fabs(t.surface.width) + std::fabs(t.roughness.width) +
+                        kSqrt2 * (std::fabs(t.bore.width) + std::fabs(t.mate.width));
+    const float reach = lens + moves + 0.25f, ends = std::fabs(t.seating.width) + moves + 0.25f;
+
+    std::vector<Point> points;
+    mesh::Mesh near;
+    const mesh::Mesh* parts[2] = {&top, &bottom};
+    for (int part = 0; part < 2; ++part) {
+        const mesh::Mesh& m = *parts[part];
+        std::vector<Vec3> normals(m.vertices.size(), Vec3{0, 0, 0});
+        for (const mesh::Triangle& tri : m.triangles) {
+            const Vec3 n = cross(sub(m.vertices[tri[1]], m.vertices[tri[0]]), sub(m.vertices[tri[2]], m.vertices[tri[0]]));
+            for (std::uint32_t k : tri) normals[k] = add(normals[k], n);
+        }
+        std::vector<std::uint32_t> index(m.vertices.size(), mesh::kNone);
+        for (const mesh::Triangle& tri : m.triangles) {
+            const Vec3 c = scale(add(add(m.vertices[tri[0]], m.vertices[tri[1]]), m.vertices[tri[2]]), 1.0f / 3);
+            float r = 0;
+            for (std::uint32_t k : tri) r = std::max(r, length(sub(m.vertices[k], c)));
+            const float along = std::clamp(dot(sub(c, from), axis), -ends, gap + ends);
+            if (length(sub(c, add(from, scale(axis, along)))) - r > reach) continue;
+            mesh::Triangle kept;
+            for (int k = 0; k < 3; ++k) {
+                std::uint32_t& i = index[tri[std::size_t(k)]];
+                if (i == mesh::kNone) {
+                    i = std::uint32_t(points.size());
+                    const Vec3& p = m.vertices[tri[std::size_t(k)]];
+                    points.push_back({p, unit(normals[tri[std::size_t(k)]]), part, dot(sub(p, from), axis) < 0.5f * gap ? 0 : 1});
+                    near.vertices.push_back(p);
+                }
+                kept[std::size_t(k)] = i;
+            }
+            near.triangles.push_back(kept);
+        }
+    }
+    ray::Scene base;
+    base.add(near);
+    base.build();
+
+    Report report;
+    report.samples = o.samples;
+    report.triangles = near.triangles.size();
+    report.total_triangles = top.triangles.size() + bottom.triangles.size();
+    report.vertices = points.size();
+
+    const std::size_t batches = (o.samples + o.batch - 1) / o.batch;
+    std::vector<Batch> results(batches);
+    ray::Options ro;
+    ro.threads = 1;
+    parallel_for(
+        batches,
+        [&](std::size_t b) {
+            Batch& out = results[b];
+            ray::Scene scene = base;
+            std::vector<Vec3> moved(points.size()), corners(3 * near.triangles.size());
+            std::vector<std::uint8_t> blocked;
+            const std::size_t last = std::min(o.samples, (b + 1) * o.batch);
+            for (std::size_t i = b * o.batch; i < last; ++i) {
+                Stream s(o.seed, o.first + i);
+                const float surface[2] = {t.surface.draw(s), t.surface.draw(s)};
+                const Vec3 mate{t.mate.draw(s), t.mate.draw(s), 0};
+                Vec3 bore[2], lens_at[2];
+                for (int side = 0; side < 2; ++side) {
+                    bore[side] = add(scale(u, t.bore.draw(s)), scale(v, t.bore.draw(s)));
+                    const Vec3 play = add(scale(u, t.placement.draw(s)), scale(v, t.placement.draw(s)));
+                    const float deeper = t.seating.draw(s);
+                    lens_at[side] = add(add(bore[side], play), scale(axis, side ? deeper : -deeper));
+                }
+                for (std::size_t k = 0; k < points.size(); ++k) {
+                    const Point& p = points[k];
+                    Vec3 q = add(add(p.p, scale(p.n, surface[p.part] + t.roughness.draw(s))), bore[p.side]);
+                    if (p.part == 0) q = add(q, mate);
+                    moved[k] = q;
+                }
+                for (std::size_t k = 0; k < near.triangles.size(); ++k)
+                    for (int c = 0; c < 3; ++c) corners[3 * k + std::size_t(c)] = moved[near.triangles[k][std::size_t(c)]];
+                scene.refit(corners);
+
+                beam::Beam sample = beam;
+                sample.samples = o.disc;
+                sample.emitter.centre = add(beam.emitter.centre, lens_at[0]);
+                sample.receiver.centre = add(beam.receiver.centre, lens_at[1]);
+                const std::vector<ray::Ray> rays = beam::bundle(sample);
+                blocked.resize(rays.size());
+                const std::size_t clear = rays.size() - scene.occluded(rays.data(), rays.size(), blocked.data(), ro);
+                const double fraction = double(clear) / double(rays.size());
+
+                out.clear += clear;
+                out.passed += fraction >= o.threshold;
+                ++out.histogram[clear == rays.size() ? 10 : std::min<std::size_t>(9, std::size_t(fraction * 10))];
+                if (fraction < out.worst_fraction) out.worst_fraction = fraction, out.worst = o.first + i;
+            }
+        },
+        o.threads);
+
+    std::size_t clear = 0;
+    report.histogram.assign(11, 0);
+    for (const Batch& b : results) {
+        report.passed += b.passed;
+        clear += b.clear;
+        for (std::size_t k = 0; k < 11; ++k) report.histogram[k] += b.histogram[k];
+        if (b.worst_fraction < report.worst_fraction) report.worst_fraction = b.worst_fraction, report.worst = b.worst;
+    }
+    const std::size_t rays = std::size_t(o.disc) * std::size_t(o.disc);
+    report.mean = o.samples ? double(clear) / (double(o.samples) * double(rays)) : 0.0;
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return report;
+}
+
+} // namespace pwb::tolerance
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "pwb/beam.hpp"
+#include "pwb/mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pwb::tolerance {
+
+using stl::Vec3;
+
+// SplitMix64 started from a hash of (seed, index): every sample draws from
+// its own stream, so a run gives the same answer on any number of threads and
+// any one sample can be replayed on its own.
+class Stream {
+public:
+    Stream(std::uint64_t seed, std::uint64_t index);
+
+    std::uint64_t next();
+    double uniform(); // [0, 1)
+    double normal();  // standard normal (polar method, the spare kept for the next call)
+
+private:
+    std::uint64_t state_;
+    double spare_ = 0;
+    bool has_spare_ = false;
+};
+
+struct Distribution {
+    enum class Kind { Uniform, Normal };
+    Kind kind = Kind::Normal;
+    float width = 0; // Uniform on [-width, width]; Normal with sigma = width / 3, clamped to ±width
+
+    float draw(Stream& s) const;
+};
+
+// How far a printed and assembled Photogate strays from the model, in mm.
+// Every draw is bounded by its width, which bounds how far any surface can
+// move and so which triangles can ever reach the beam.
+struct Tolerances {
+    using Kind = Distribution::Kind;
+    Distribution surface{Kind::Normal, 0.2f};     // each half's faces along their normals, + = more plastic
+    Distribution roughness{Kind::Normal, 0.05f};  // on top of that, drawn for every vertex
+    Distribution bore{Kind::Normal, 0.2f};        // each bore across the beam, with the wall around it
+    Distribution mate{Kind::Uniform, 0.1f};       // top half against the bottom, in X and Y
+    Distribution placement{Kind::Uniform, 0.25f}; // each lens across its bore (Ø5 in Ø5.5)
+    Distribution seating{Kind::Uniform, 0.3f};    // each lens along its bore, + = deeper
+};
+
+struct Options {
+    // About 20 s on one core; the 95 % interval is near ±0.2 % at a 92 % yield.
+    std::size_t samples = 100'000;
+    std::size_t first = 0;      // index of the first sample, to replay a stretch of a run
+    std::uint64_t seed = 1;
+    int disc = 12;              // points per lens; disc² lines of sight per sample
+    double threshold = 1.0;     // clear fraction a sample needs to pass
+    std::size_t batch = 512;    // samples per task
+    unsigned threads = 0;       // 0 = all cores
+};
+
+struct Report {
+    std::size_t samples = 0;
+    std::size_t passed = 0;
+    std::vector<std::size_t> histogram; // samples by clear fraction: [0, 0.1), ..., [0.9, 1), fully clear
+    double mean = 0;                    // clear fraction over all samples
+    std::size_t worst = 0;              // index of the sample with the least clear beam
+    double worst_fraction = 1;
+    std::size_t triangles = 0;          // kept near the beam, out of
+    std::size_t total_triangles = 0;
+    std::size_t vertices = 0;           // moved per sample
+    double seconds = 0;
+
+    double yield() const { return samples ? double(passed) / double(samples) : 0.0; }
+    // Half-width of the 95 % confidence interval on the yield (normal approximation).
+    double margin() const;
+};
+
+// Monte Carlo yield of the beam through the two halves (as assembled, split
+// plane normal to Z). Only triangles that any draw can bring within reach of
+// the lines of sight are kept; each task copies their scene, and each sample
+// moves every kept vertex (surface offset along the vertex normal, its bore's
+// offset, the mate offset on the top half), refits the BVH instead of
+// rebuilding it and casts the sample's bundle between the displaced lenses.
+Report run(const mesh::Mesh& top, const mesh::Mesh& bottom, const beam::Beam& beam, const Tolerances& tolerances,
+           const Options& options = {});
+
+} // namespace pwb::tolerance
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "pwb/stl.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+namespace pwb {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// File-name suffix test ignoring ASCII case; `suffix` is given in lower case
+// (".gbr", ".stl"), so names written by Windows tools match too.
+inline bool ends_with(std::string_view s, std::string_view suffix) {
+    if (s.size() < suffix.size()) return false;
+    const std::size_t at = s.size() - suffix.size();
+    for (std::size_t i = 0; i < suffix.size(); ++i)
+        if (std::tolower(static_cast<unsigned char>(s[at + i])) != suffix[i]) return false;
+    return true;
+}
+
+// Disjoint sets over 0..n-1 with path halving. Each set's root is its
+// smallest member, so the labels do not depend on the order of the joins.
+class UnionFind {
+public:
+    explicit UnionFind(std::size_t n) : parent_(n) { std::iota(parent_.begin(), parent_.end(), 0u); }
+
+    std::uint32_t find(std::uint32_t i) {
+        while (parent_[i] != i) i = parent_[i] = parent_[parent_[i]];
+        return i;
+    }
+    // False when a and b were already in the same set.
+    bool join(std::uint32_t a, std::uint32_t b) {
+        a = find(a), b = find(b);
+        if (a == b) return false;
+        parent_[std::max(a, b)] = std::min(a, b);
+        return true;
+    }
+
+private:
+    std::vector<std::uint32_t> parent_;
+};
+
+// Double-precision point for the geometric predicates and accumulations that
+// float Vec3 is too coarse for.
+struct D3 {
+    double x = 0, y = 0, z = 0;
+};
+
+inline D3 d3(const stl::Vec3& v) { return {v.x, v.y, v.z}; }
+inline stl::Vec3 f3(const D3& a) { return {float(a.x), float(a.y), float(a.z)}; }
+inline D3 add(const D3& a, const D3& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline D3 sub(const D3& a, const D3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline D3 mul(const D3& a, double s) { return {a.x * s, a.y * s, a.z * s}; }
+inline double dot(const D3& a, const D3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline D3 cross(const D3& a, const D3& b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+inline double norm2(const D3& a) { return dot(a, a); }
+inline D3 unit(const D3& a) {
+    const double l = std::sqrt(dot(a, a));
+    return l > 0 ? mul(a, 1 / l) : a;
+}
+// Six times the signed volume of tetrahedron (a, b, c, d).
+inline double orient(const D3& a, const D3& b, const D3& c, const D3& d) {
+    return dot(cross(sub(b, a), sub(c, a)), sub(d, a));
+}
+
+} // namespace pwb
@@ -0,0 +1,195 @@
+#include "pwb/xml.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace pwb::xml {
+
+namespace {
+
+void append_utf8(std::string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += char(cp);
+    } else if (cp < 0x800) {
+        out += char(0xC0 | (cp >> 6));
+        out += char(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += char(0xE0 | (cp >> 12));
+        out += char(0x80 | ((cp >> 6) & 0x3F));
+        out += char(0x80 | (cp & 0x3F));
+    } else {
+        out += char(0xF0 | (cp >> 18));
+        out += char(0x80 | ((cp >> 12) & 0x3F));
+        out += char(0x80 | ((cp >> 6) & 0x3F));
+        out += char(0x80 | (cp & 0x3F));
+    }
+}
+
+std::string decode(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (s[i] != '&') {
+            out += s[i];
+            continue;
+        }
+        std::size_t semi = s.find(';', i);
+        if (semi == std::string_view::npos) {
+            out += s[i];
+            continue;
+        }
+        std::string_view ent = s.substr(i + 1, semi - i - 1);
+        if (ent == "amp") out += '&';
+        else if (ent == "lt") out += '<';
+        else if (ent == "gt") out += '>';
+        else if (ent == "quot") out += '"';
+        else if (ent == "apos") out += '\'';
+        else if (!ent.empty() && ent[0] == '#') {
+            std::string digits(ent.substr(ent.size() > 1 && (ent[1] == 'x' || ent[1] == 'X') ? 2 : 1));
+            append_utf8(out, std::strtoul(digits.c_str(), nullptr, ent.size() > 1 && (ent[1] == 'x' || ent[1] == 'X') ? 16 : 10));
+        } else {
+            out.append(s.substr(i, semi - i + 1));
+        }
+        i = semi;
+    }
+    return out;
+}
+
+bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+class Parser {
+public:
+    explicit Parser(std::string_view s) : s_(s) {}
+
+    Node document() {
+        Node root;
+        root.name = "#document";
+        content(root);
+        return root;
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error("xml: " + std::string(what) + " at offset " + std::to_string(pos_));
+    }
+
+    bool starts(std::string_view t) const { return s_.compare(pos_, t.size(), t) == 0; }
+
+    void skip_past(std::string_view t) {
+        std::size_t at = s_.find(t, pos_);
+        if (at == std::string_view::npos) fail("unterminated markup");
+        pos_ = at + t.size();
+    }
+
+    std::string_view name() {
+        std::size_t start = pos_;
+        while (pos_ < s_.size() && !is_space(s_[pos_]) && s_[pos_] != '>' && s_[pos_] != '/' && s_[pos_] != '=') ++pos_;
+        if (start == pos_) fail("expected a name");
+        return s_.substr(start, pos_ - start);
+    }
+
+    void skip_spaces() {
+        while (pos_ < s_.size() && is_space(s_[pos_])) ++pos_;
+    }
+
+    // Parses children of `parent` until its end tag (or end of input for the document).
+    void content(Node& parent) {
+        while (pos_ < s_.size()) {
+            if (s_[pos_] != '<') {
+                std::size_t lt = s_.find('<', pos_);
+                if (lt == std::string_view::npos) lt = s_.size();
+                parent.text += decode(s_.substr(pos_, lt - pos_));
+                pos_ = lt;
+                continue;
+            }
+            if (starts("<!--")) skip_past("-->");
+            else if (starts("<![CDATA[")) {
+                std::size_t start = pos_ + 9;
+                skip_past("]]>");
+                parent.text.append(s_.substr(start, pos_ - 3 - start));
+            } else if (starts("<?")) skip_past("?>");
+            else if (starts("<!")) skip_past(">");
+            else if (starts("</")) {
+                pos_ += 2;
+                if (name() != parent.name) fail("mismatched end tag");
+                skip_spaces();
+                if (pos_ >= s_.size() || s_[pos_] != '>') fail("bad end tag");
+                ++pos_;
+                return;
+            } else {
+                ++pos_;
+                parent.children.emplace_back();
+                element(parent.children.back());
+            }
+        }
+        if (parent.name != "#document") fail("unexpected end of input");
+    }
+
+    void element(Node& node) {
+        node.name = std::string(name());
+        for (;;) {
+            skip_spaces();
+            if (pos_ >= s_.size()) fail("unterminated tag");
+            if (s_[pos_] == '/') {
+                if (pos_ + 1 >= s_.size() || s_[pos_ + 1] != '>') fail("bad empty-element tag");
+                pos_ += 2;
+                return;
+            }
+            if (s_[pos_] == '>') {
+                ++pos_;
+                content(node);
+                return;
+            }
+            std::string key(name());
+            skip_spaces();
+            if (pos_ >= s_.size() || s_[pos_] != '=') fail("expected '='");
+            ++pos_;
+            skip_spaces();
+            if (pos_ >= s_.size() || (s_[pos_] != '"' && s_[pos_] != '\'')) fail("expected a quoted value");
+            char quote = s_[pos_++];
+            std::size_t end = s_.find(quote, pos_);
+            if (end == std::string_view::npos) fail("unterminated attribute value");
+            node.attributes.emplace_back(std::move(key), decode(s_.substr(pos_, end - pos_)));
+            pos_ = end + 1;
+        }
+    }
+
+    std::string_view s_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace
+
+const std::string* Node::attribute(std::string_view key) const {
+    for (const auto& kv : attributes)
+        if (kv.first == key) return &kv.second;
+    return nullptr;
+}
+
+std::string Node::attr(std::string_view key, std::string_view fallback) const {
+    const std::string* v = attribute(key);
+    return v ? *v : std::string(fallback);
+}
+
+double Node::number(std::string_view key, double fallback) const {
+    const std::string* v = attribute(key);
+    return v ? std::strtod(v->c_str(), nullptr) : fallback;
+}
+
+const Node* Node::child(std::string_view child_name) const {
+    for (const Node& c : children)
+        if (c.name == child_name) return &c;
+    return nullptr;
+}
+
+const Node* Node::find(std::string_view descendant) const {
+    for (const Node& c : children) {
+        if (c.name == descendant) return &c;
+        if (const Node* n = c.find(descendant)) return n;
+    }
+    return nullptr;
+}
+
+Node parse(std::string_view text) { return Parser(text).document(); }
+
+} // namespace pwb::xml
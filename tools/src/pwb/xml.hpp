@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pwb::xml {
+
+// Just enough XML for EAGLE files: elements, attributes, character data and
+// the predefined/numeric entities. No namespaces, no DTD processing.
+struct Node {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::vector<Node> children;
+    std::string text;
+
+    const std::string* attribute(std::string_view key) const;
+    std::string attr(std::string_view key, std::string_view fallback = {}) const;
+    double number(std::string_view key, double fallback = 0.0) const;
+
+    const Node* child(std::string_view child_name) const;
+    // Depth-first search for the first descendant with this name.
+    const Node* find(std::string_view descendant) const;
+};
+
+Node parse(std::string_view text);
+
+} // namespace pwb::xml
@@ -0,0 +1,174 @@
+#include "pwb/zip_archive.hpp"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace pwb {
+
+namespace {
+
+constexpr std::uint32_t kLocalHeaderSig = 0x04034b50;
+constexpr std::uint32_t kCentralHeaderSig = 0x02014b50;
+constexpr std::uint32_t kEndOfCentralDirSig = 0x06054b50;
+
+std::uint16_t le16(const unsigned char* p) { return static_cast<std::uint16_t>(p[0] | p[1] << 8); }
+
+std::uint32_t le32(const unsigned char* p) {
+    return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8 |
+           static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+}
+
+[[noreturn]] void corrupt(const std::string& path, const char* what) {
+    throw std::runtime_error(path + ": " + what);
+}
+
+} // namespace
+
+std::string_view ZipEntry::basename() const {
+    std::string_view n = name;
+    auto slash = n.find_last_of('/');
+    return slash == std::string_view::npos ? n : n.substr(slash + 1);
+}
+
+ZipArchive::ZipArchive(const std::string& path) : file_(path) {
+    const unsigned char* base = file_.data();
+    const std::size_t size = file_.size();
+    if (size < 22) corrupt(path, "not a zip archive");
+
+    // The end-of-central-directory record sits within the last 64 KiB + 22 bytes.
+    std::size_t eocd = std::string::npos;
+    std::size_t lowest = size > 0xffff + 22 ? size - 0xffff - 22 : 0;
+    for (std::size_t i = size - 22 + 1; i-- > lowest;) {
+        if (le32(base + i) == kEndOfCentralDirSig) {
+            eocd = i;
+            break;
+        }
+    }
+    if (eocd == std::string::npos) corrupt(path, "missing end of central directory");
+
+    std::uint16_t count = le16(base + eocd + 10);
+    std::uint32_t dir_size = le32(base + eocd + 12);
+    std::uint32_t dir_offset = le32(base + eocd + 16);
+    if (dir_offset == 0xffffffffu || count == 0xffff) corrupt(path, "zip64 archives are not supported");
+    if (std::uint64_t(dir_offset) + dir_size > eocd) corrupt(path, "central directory out of range");
+
+    entries_.reserve(count);
+    const unsigned char* p = base + dir_offset;
+    const unsigned char* end = base + dir_offset + dir_size;
+    for (std::uint16_t i = 0; i < count; ++i) {
+        if (p + 46 > end || le32(p) != kCentralHeaderSig) corrupt(path, "bad central directory header");
+        ZipEntry e;
+        e.method = le16(p + 10);
+        e.crc32 = le32(p + 16);
+        e.compressed_size = le32(p + 20);
+        e.size = le32(p + 24);
+        std::uint16_t name_len = le16(p + 28);
+        std::uint16_t extra_len = le16(p + 30);
+        std::uint16_t comment_len = le16(p + 32);
+        e.local_header_offset = le32(p + 42);
+        if (p + 46 + name_len > end) corrupt(path, "truncated file name");
+        e.name.assign(reinterpret_cast<const char*>(p + 46), name_len);
+        // Windows' built-in zipper writes backslashes.
+        for (char& c : e.name)
+            if (c == '\\') c = '/';
+        entries_.push_back(std::move(e));
+        p += 46 + name_len + extra_len + comment_len;
+    }
+}
+
+const ZipEntry* ZipArchive::find(std::string_view name) const {
+    bool by_basename = name.find('/') == std::string_view::npos;
+    for (const ZipEntry& e : entries_) {
+        if (e.name == name || (by_basename && e.basename() == name)) return &e;
+    }
+    return nullptr;
+}
+
+const unsigned char* ZipArchive::entry_data(const ZipEntry& entry) const {
+    const unsigned char* base = file_.data();
+    if (entry.local_header_offset + 30 > file_.size()) corrupt(path(), "local header out of range");
+    const unsigned char* local = base + entry.local_header_offset;
+    if (le32(local) != kLocalHeaderSig) corrupt(path(), "bad local header");
+    std::uint64_t data_offset = entry.local_header_offset + 30 + le16(local + 26) + le16(local + 28);
+    if (data_offset + entry.compressed_size > file_.size()) corrupt(path(), "entry data out of range");
+    return base + data_offset;
+}
+
+std::string ZipArchive::read(const ZipEntry& entry) const {
+    std::string out(entry.size, '\0');
+    ZipEntryStream stream(*this, entry);
+    std::size_t got = 0;
+    while (got < out.size()) {
+        std::size_t n = stream.read(out.data() + got, out.size() - got);
+        if (n == 0) break;
+        got += n;
+    }
+    if (got != out.size() || !stream.done()) corrupt(path(), "short read");
+    return out;
+}
+
+std::string ZipArchive::read(std::string_view name) const {
+    const ZipEntry* e = find(name);
+    if (!e) throw std::runtime_error(path() + ": no member named " + std::string(name));
+    return read(*e);
+}
+
+ZipEntryStream::ZipEntryStream(const ZipArchive& archive, const ZipEntry& entry)
+    : entry_(entry), src_(archive.entry_data(entry)) {
+    if (entry.method == 8) {
+        z_ = new z_stream{};
+        if (inflateInit2(z_, -MAX_WBITS) != Z_OK) {
+            delete z_;
+            throw std::runtime_error("inflateInit2 failed");
+        }
+    } else if (entry.method != 0) {
+        throw std::runtime_error(archive.path() + ": unsupported compression method for " + entry.name);
+    } else if (entry.size != entry.compressed_size) {
+        // Stored data is copied verbatim; entry_data() only bounds compressed_size.
+        throw std::runtime_error(archive.path() + ": stored entry " + entry.name + " has mismatched sizes");
+    }
+}
+
+ZipEntryStream::~ZipEntryStream() {
+    if (z_) {
+        inflateEnd(z_);
+        delete z_;
+    }
+}
+
+std::size_t ZipEntryStream::read(char* out, std::size_t capacity) {
+    std::uint64_t remaining = entry_.size - produced_;
+    if (remaining == 0 || capacity == 0) return 0;
+    std::size_t want = remaining < capacity ? static_cast<std::size_t>(remaining) : capacity;
+    std::size_t got = 0;
+
+    if (!z_) {
+        std::memcpy(out, src_ + consumed_, want);
+        consumed_ += want;
+        got = want;
+    } else {
+        z_->next_out = reinterpret_cast<Bytef*>(out);
+        z_->avail_out = static_cast<uInt>(want);
+        while (z_->avail_out > 0) {
+            std::uint64_t in_left = entry_.compressed_size - consumed_;
+            z_->next_in = const_cast<Bytef*>(src_ + consumed_);
+            z_->avail_in = static_cast<uInt>(in_left > 0x40000000 ? 0x40000000 : in_left);
+            uInt before = z_->avail_in;
+            int rc = inflate(z_, Z_NO_FLUSH);
+            consumed_ += before - z_->avail_in;
+            if (rc == Z_STREAM_END) break;
+            if (rc != Z_OK) throw std::runtime_error("corrupt deflate stream in " + entry_.name);
+        }
+        got = want - z_->avail_out;
+    }
+
+    crc_ = static_cast<std::uint32_t>(::crc32(crc_, reinterpret_cast<const Bytef*>(out), static_cast<uInt>(got)));
+    produced_ += got;
+    if (produced_ == entry_.size && crc_ != entry_.crc32)
+        throw std::runtime_error("CRC mismatch in " + entry_.name);
+    return got;
+}
+
+} // namespace pwb
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "pwb/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+typedef struct z_stream_s z_stream;
+
+namespace pwb {
+
+// One member of a zip archive, as described by the central directory.
+struct ZipEntry {
+    std::string name;
+    std::uint16_t method = 0;          // 0 = stored, 8 = deflate
+    std::uint32_t crc32 = 0;
+    std::uint64_t compressed_size = 0;
+    std::uint64_t size = 0;
+    std::uint64_t local_header_offset = 0;
+
+    bool is_directory() const { return !name.empty() && name.back() == '/'; }
+    std::string_view basename() const;
+};
+
+class ZipArchive;
+
+// Pull-style decompressor for a single entry. Data is inflated straight from
+// the mapped archive into the caller's buffer; nothing touches the disk.
+class ZipEntryStream {
+public:
+    ZipEntryStream(const ZipArchive& archive, const ZipEntry& entry);
+    ~ZipEntryStream();
+    ZipEntryStream(const ZipEntryStream&) = delete;
+    ZipEntryStream& operator=(const ZipEntryStream&) = delete;
+
+    // Returns the number of bytes written; 0 once the entry is exhausted.
+    std::size_t read(char* out, std::size_t capacity);
+    bool done() const { return produced_ == entry_.size; }
+
+private:
+    const ZipEntry& entry_;
+    const unsigned char* src_ = nullptr;
+    std::uint64_t consumed_ = 0;
+    std::uint64_t produced_ = 0;
+    std::uint32_t crc_ = 0;
+    z_stream* z_ = nullptr;
+};
+
+// Read-only zip reader over a memory-mapped archive. Supports stored and
+// deflated members, which covers everything EAGLE, Cura and Windows produce.
+class ZipArchive {
+public:
+    explicit ZipArchive(const std::string& path);
+
+    const std::vector<ZipEntry>& entries() const { return entries_; }
+    const std::string& path() const { return file_.path(); }
+
+    // Lookup by full member path, or by basename when the name has no '/'.
+    const ZipEntry* find(std::string_view name) const;
+
+    // Inflates a whole entry into memory and checks its CRC.
+    std::string read(const ZipEntry& entry) const;
+    std::string read(std::string_view name) const;
+
+private:
+    friend class ZipEntryStream;
+    const unsigned char* entry_data(const ZipEntry& entry) const;
+
+    MappedFile file_;
+    std::vector<ZipEntry> entries_;
+};
+
+} // namespace pwb
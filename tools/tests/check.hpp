@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#ifndef PWB_REPO_ROOT
+#define PWB_REPO_ROOT "."
+#endif
+
+namespace pwb::test {
+
+inline int& failures() {
+    static int n = 0;
+    return n;
+}
+
+inline std::string repo_path(const char* relative) { return std::string(PWB_REPO_ROOT) + "/" + relative; }
+
+inline bool check(bool ok, const char* what, const char* file, int line) {
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+        ++failures();
+    }
+    return ok;
+}
+
+// Exit status for main: 1 if any check failed.
+inline int result(const char* name) {
+    if (failures()) std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+    else std::printf("%s: ok\n", name);
+    return failures() ? 1 : 0;
+}
+
+} // namespace pwb::test
+
+// Records a failure and carries on, so one run reports every broken check.
+#define PWB_CHECK(cond) ::pwb::test::check(bool(cond), #cond, __FILE__, __LINE__)
+
+// Passes when `expr` throws an exception derived from `type`.
+#define PWB_CHECK_THROWS(expr, type)                                                                                  \
+    do {                                                                                                              \
+        bool thrown_ = false;                                                                                         \
+        try {                                                                                                         \
+            (void)(expr);                                                                                             \
+        } catch (const type&) {                                                                                       \
+            thrown_ = true;                                                                                           \
+        }                                                                                                             \
+        ::pwb::test::check(thrown_, #expr " throws " #type, __FILE__, __LINE__);                                     \
+    } while (0)
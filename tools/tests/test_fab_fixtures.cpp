@@ -0,0 +1,124 @@
+// Parses the CAM package under PCB/deprecated/gerber: every Gerber layer with
+// its known primitive counts, the same layers inflated in tiny chunks straight
+// from the zip, and the Excellon drill file, written back and re-read.
+
+#include "check.hpp"
+
+#include "pwb/excellon.hpp"
+#include "pwb/gerber.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <iterator>
+#include <string>
+
+namespace {
+
+using namespace pwb;
+
+struct Expected {
+    const char* name;
+    std::size_t apertures, flashes, strokes;
+};
+
+// As listed by gerber_dump; every layer is EAGLE's MM FSLAX34Y34, no regions.
+const Expected kLayers[] = {
+    {"copper_bottom.gbr", 4, 35, 47},         {"copper_top.gbr", 14, 120, 188},
+    {"profile.gbr", 1, 0, 292},               {"silkscreen_bottom.gbr", 0, 0, 0},
+    {"silkscreen_top.gbr", 8, 3, 6965},       {"soldermask_bottom.gbr", 4, 38, 0},
+    {"soldermask_top.gbr", 14, 123, 0},       {"solderpaste_bottom.gbr", 0, 0, 0},
+    {"solderpaste_top.gbr", 10, 85, 0},
+};
+
+bool same(const gerber::Layer& a, const gerber::Layer& b) {
+    if (a.name != b.name || a.apertures.size() != b.apertures.size() || a.flashes.size() != b.flashes.size() ||
+        a.strokes.size() != b.strokes.size() || a.regions.size() != b.regions.size() ||
+        a.levels.size() != b.levels.size())
+        return false;
+    for (std::size_t i = 0; i < a.flashes.size(); ++i)
+        if (a.flashes[i].x != b.flashes[i].x || a.flashes[i].y != b.flashes[i].y ||
+            a.flashes[i].aperture != b.flashes[i].aperture)
+            return false;
+    for (std::size_t i = 0; i < a.strokes.size(); ++i)
+        if (a.strokes[i].x0 != b.strokes[i].x0 || a.strokes[i].y1 != b.strokes[i].y1 ||
+            a.strokes[i].aperture != b.strokes[i].aperture)
+            return false;
+    return true;
+}
+
+void gerbers(const ZipArchive& zip) {
+    std::size_t seen = 0;
+    for (const ZipEntry& e : zip.entries()) {
+        if (!ends_with(e.name, ".gbr")) continue;
+        const Expected* x = nullptr;
+        for (const Expected& l : kLayers)
+            if (e.basename() == l.name) x = &l;
+        if (!PWB_CHECK(x != nullptr)) continue;
+        ++seen;
+        const gerber::Layer layer = gerber::parse(zip.read(e));
+        PWB_CHECK(layer.units == gerber::Units::Millimetres);
+        PWB_CHECK(layer.has_format && !layer.format.omit_trailing);
+        PWB_CHECK(layer.format.x_integer == 3 && layer.format.x_decimal == 4);
+        PWB_CHECK(layer.apertures.size() == x->apertures);
+        PWB_CHECK(layer.flashes.size() == x->flashes);
+        PWB_CHECK(layer.strokes.size() == x->strokes);
+        PWB_CHECK(layer.regions.empty());
+        PWB_CHECK(layer.levels.size() == 1);
+
+        // Statements and %...% blocks split across every possible chunk edge.
+        gerber::ParseOptions tiny;
+        tiny.chunk = 7;
+        PWB_CHECK(same(layer, gerber::parse(zip, e, tiny)));
+        PWB_CHECK(same(layer, gerber::parse(zip, e)));
+    }
+    PWB_CHECK(seen == std::size(kLayers));
+
+    const gerber::Layer top = gerber::parse(zip.read("CAMOutputs/GerberFiles/copper_top.gbr"));
+    const gerber::Box b = top.bounds();
+    PWB_CHECK(top.name == "Top Copper");
+    PWB_CHECK(b.min_x == 1'790'000 && b.min_y == 1'620'000 && b.max_x == 65'520'000 && b.max_y == 47'537'000);
+}
+
+void drills(const ZipArchive& zip) {
+    const excellon::DrillFile f = excellon::parse(zip.read("CAMOutputs/DrillFiles/drill_1_16.xln"));
+    PWB_CHECK(f.format.metric && f.format.has_units && f.format.has_zeros && f.format.keep_trailing);
+    PWB_CHECK(f.tools.size() == 4);
+    PWB_CHECK(f.hit_count() == 38);
+    const excellon::Tool* t4 = f.tool(4);
+    if (PWB_CHECK(t4 != nullptr)) {
+        PWB_CHECK(std::fabs(t4->diameter - 0.4) < 1e-9);
+        PWB_CHECK(t4->hits.size() == 15);
+        PWB_CHECK(std::fabs(t4->hits[0].x - 45.72) < 1e-9 && std::fabs(t4->hits[0].y - 11.43) < 1e-9);
+    }
+
+    const excellon::DrillFile g = excellon::parse(excellon::write(f));
+    PWB_CHECK(g.tools.size() == f.tools.size());
+    for (std::size_t t = 0; t < f.tools.size() && t < g.tools.size(); ++t) {
+        PWB_CHECK(g.tools[t].number == f.tools[t].number);
+        PWB_CHECK(std::fabs(g.tools[t].diameter - f.tools[t].diameter) < 1e-9);
+        if (!PWB_CHECK(g.tools[t].hits.size() == f.tools[t].hits.size())) continue;
+        for (std::size_t h = 0; h < f.tools[t].hits.size(); ++h)
+            PWB_CHECK(std::fabs(g.tools[t].hits[h].x - f.tools[t].hits[h].x) < 1e-6 &&
+                      std::fabs(g.tools[t].hits[h].y - f.tools[t].hits[h].y) < 1e-6);
+    }
+
+    PWB_CHECK_THROWS(excellon::parse("M48\nMETRIC,TZ\nT1C0.8\n%\nG91\n"), excellon::ParseError);
+}
+
+} // namespace
+
+int main() {
+    try {
+        ZipArchive zip(test::repo_path("PCB/deprecated/gerber/gerber_espwroom32.zip"));
+        gerbers(zip);
+        drills(zip);
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "test_fab_fixtures: %s\n", ex.what());
+        return 1;
+    }
+    return test::result("test_fab_fixtures");
+}
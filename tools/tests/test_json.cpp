@@ -0,0 +1,61 @@
+// JSON strings: the short escapes, \u escapes to UTF-8 at every encoded
+// length, surrogate pairs, and the malformed escapes that must be rejected.
+
+#include "check.hpp"
+
+#include "pwb/json.hpp"
+
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using namespace pwb;
+
+std::string str(const char* text) {
+    const json::Value v = json::parse(text);
+    return v.type == json::Type::String ? v.string : "<not a string>";
+}
+
+void escapes() {
+    PWB_CHECK(str(R"("plain")") == "plain");
+    PWB_CHECK(str(R"("\"\\\/\b\f\n\r\t")") == "\"\\/\b\f\n\r\t");
+    PWB_CHECK(str(R"("a\u0041b")") == "aAb");
+    PWB_CHECK(str(R"("\u00e9")") == "\xC3\xA9");                // 2 bytes
+    PWB_CHECK(str(R"("\u20AC")") == "\xE2\x82\xAC");            // 3 bytes, upper-case hex
+    PWB_CHECK(str(R"("\ud83d\ude00")") == "\xF0\x9F\x98\x80");  // pair -> 4 bytes
+    PWB_CHECK(str(R"("\uDBFF\uDFFF")") == "\xF4\x8F\xBF\xBF");  // U+10FFFF
+    PWB_CHECK(str(R"("x\u0000y")") == std::string("x\0y", 3));
+    PWB_CHECK(str("\"\xC3\xA9\"") == "\xC3\xA9"); // raw UTF-8 passes through
+
+    const json::Value job = json::parse(R"({"Header": {"Part": "Single PCB"}, "Size": {"X": 67.3}})");
+    PWB_CHECK(job.string_at("Header.Part") == "Single PCB");
+    PWB_CHECK(job.number_at("Size.X") == 67.3);
+}
+
+void rejects() {
+    PWB_CHECK_THROWS(json::parse(R"("\uDE00")"), std::runtime_error);        // lone low surrogate
+    PWB_CHECK_THROWS(json::parse(R"("\uD83D")"), std::runtime_error);        // lone high surrogate
+    PWB_CHECK_THROWS(json::parse(R"("\uD83Dx")"), std::runtime_error);       // high surrogate, then text
+    PWB_CHECK_THROWS(json::parse(R"("\uD83D\u0041")"), std::runtime_error);  // high surrogate, then non-surrogate
+    PWB_CHECK_THROWS(json::parse(R"("\uD83D\uD83D")"), std::runtime_error);  // two high surrogates
+    PWB_CHECK_THROWS(json::parse(R"("\u12")"), std::runtime_error);          // short escape
+    PWB_CHECK_THROWS(json::parse(R"("\u12G4")"), std::runtime_error);        // bad hex digit
+    PWB_CHECK_THROWS(json::parse(R"("abc)"), std::runtime_error);            // unterminated
+    PWB_CHECK_THROWS(json::parse(R"("abc\)"), std::runtime_error);           // escape at the end
+}
+
+} // namespace
+
+int main() {
+    try {
+        escapes();
+        rejects();
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "test_json: %s\n", ex.what());
+        return 1;
+    }
+    return test::result("test_json");
+}
@@ -0,0 +1,119 @@
+// Round trips through both mesh containers: PWBQ previews (lod::pack and
+// unpack) and PWBZ libraries (codec::encode and Reader), on a repository part
+// and a synthetic sphere, plus rejection of truncated and corrupted input.
+
+#include "check.hpp"
+
+#include "pwb/lod.hpp"
+#include "pwb/mesh.hpp"
+#include "pwb/mesh_codec.hpp"
+#include "pwb/stl.hpp"
+
+#include "../bench/mesh_util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace pwb;
+
+mesh::Mesh weld_bytes(const std::string& stl) {
+    return mesh::weld(stl::parse(reinterpret_cast<const unsigned char*>(stl.data()), stl.size(), "part").triangles);
+}
+
+// Every vertex within half a quantisation step of the original on each axis.
+bool within(const std::vector<stl::Vec3>& got, const std::vector<stl::Vec3>& want, const float step[3]) {
+    if (got.size() != want.size()) return false;
+    for (std::size_t i = 0; i < got.size(); ++i)
+        if (std::fabs(got[i].x - want[i].x) > step[0] * 0.5f + 1e-5f ||
+            std::fabs(got[i].y - want[i].y) > step[1] * 0.5f + 1e-5f ||
+            std::fabs(got[i].z - want[i].z) > step[2] * 0.5f + 1e-5f)
+            return false;
+    return true;
+}
+
+// Triangles as corner grid positions (as the encoder quantises them), each
+// rotated to start at its smallest corner and then sorted, so meshes that
+// differ only in vertex numbering, triangle order and corner rotation
+// compare equal.
+std::vector<std::array<long, 9>> shape(const mesh::Mesh& m, const codec::Entry& e) {
+    const long levels = long((1u << e.bits) - 1);
+    auto grid = [&](const stl::Vec3& v) {
+        const float p[3] = {v.x, v.y, v.z};
+        std::array<long, 3> q;
+        for (int k = 0; k < 3; ++k)
+            q[k] = std::clamp(std::lround((double(p[k]) - e.origin[k]) / e.step[k]), 0l, levels);
+        return q;
+    };
+    std::vector<std::array<long, 9>> out;
+    for (const mesh::Triangle& t : m.triangles) {
+        const std::array<long, 3> c[3] = {grid(m.vertices[t[0]]), grid(m.vertices[t[1]]), grid(m.vertices[t[2]])};
+        const int k = int(std::min_element(c, c + 3) - c);
+        std::array<long, 9> f;
+        for (int i = 0; i < 3; ++i)
+            for (int a = 0; a < 3; ++a) f[3 * i + a] = c[(k + i) % 3][a];
+        out.push_back(f);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void preview(const mesh::Mesh& m) {
+    for (int bits : {16, 11}) {
+        const std::string packed = lod::pack(m, bits);
+        PWB_CHECK(packed.compare(0, 4, "PWBQ") == 0);
+        const mesh::Mesh back = lod::unpack(packed);
+        PWB_CHECK(back.triangles == m.triangles);
+        float step[3];
+        std::memcpy(step, packed.data() + 28, sizeof step);
+        PWB_CHECK(within(back.vertices, m.vertices, step));
+
+        PWB_CHECK_THROWS(lod::unpack(std::string_view(packed).substr(0, packed.size() - 1)), std::runtime_error);
+        std::string bad = packed;
+        bad[0] = 'X';
+        PWB_CHECK_THROWS(lod::unpack(bad), std::runtime_error);
+    }
+}
+
+void library(const std::vector<codec::Part>& parts) {
+    const std::string data = codec::encode(parts);
+    PWB_CHECK(data.compare(0, 4, "PWBZ") == 0);
+    const codec::Reader reader(data);
+    if (!PWB_CHECK(reader.entries().size() == parts.size())) return;
+    for (const codec::Part& p : parts) {
+        const codec::Entry* e = reader.find(p.name);
+        if (!PWB_CHECK(e != nullptr)) continue;
+        PWB_CHECK(e->vertices == p.mesh.vertices.size() && e->triangles == p.mesh.triangles.size());
+        const mesh::Mesh back = reader.decode(*e);
+        PWB_CHECK(e->bits == 16);
+        PWB_CHECK(shape(back, *e) == shape(p.mesh, *e));
+    }
+    PWB_CHECK(reader.find("no such part") == nullptr);
+    PWB_CHECK_THROWS(codec::Reader(std::string_view(data).substr(0, 20)), std::runtime_error);
+}
+
+} // namespace
+
+int main() {
+    try {
+        const stl::File top(test::repo_path("STL/fdm/Photogate_Top.stl"));
+        const mesh::Mesh part = mesh::weld(top.triangles());
+        const mesh::Mesh sphere = weld_bytes(bench::sphere_soup(20'000));
+        PWB_CHECK(!part.triangles.empty() && !sphere.triangles.empty());
+        preview(part);
+        preview(sphere);
+        library({{"Photogate_Top", part}, {"sphere", sphere}});
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "test_mesh_codec: %s\n", ex.what());
+        return 1;
+    }
+    return test::result("test_mesh_codec");
+}
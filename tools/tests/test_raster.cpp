@@ -0,0 +1,106 @@
+// Raster coverage against exact areas: an off-grid square and rotated
+// triangle, a flashed circle and a clear hole from a hand-written Gerber, the
+// AVX2 kernels against the scalar ones, and the top copper of the fixture
+// package against the polygon engine's area of the same layer.
+
+#include "check.hpp"
+
+#include "pwb/gerber.hpp"
+#include "pwb/gerber_outline.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/raster.hpp"
+#include "pwb/util.hpp"
+#include "pwb/zip_archive.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+namespace {
+
+using namespace pwb;
+using gerber::Coord;
+
+// Covered area in mm².
+double covered(const raster::Bitmap& b) {
+    std::uint64_t sum = 0;
+    for (std::uint8_t v : b.pixels) sum += v;
+    const double mm = double(b.pixel) / gerber::kNmPerMm;
+    return double(sum) / 255.0 * mm * mm;
+}
+
+// Coverage is quantised to 1/255 per pixel and exact only in x, so allow
+// about one pixel row of error along the outline.
+bool near(double got, double want, double perimeter_mm, double pixel_mm) {
+    return std::fabs(got - want) <= perimeter_mm * pixel_mm * 0.5 + want * 0.004;
+}
+
+void polygons() {
+    raster::Options o;
+    o.pixel = 10'000;
+    o.window = {-1'000'000, -1'000'000, 3'000'000, 3'000'000};
+
+    gerber::PolygonSet square;
+    square.points = {{12'345, 67'890}, {1'012'345, 67'890}, {1'012'345, 1'067'890}, {12'345, 1'067'890}};
+    square.close();
+    const raster::Bitmap sq = raster::rasterise({square}, {false}, o);
+    PWB_CHECK(near(covered(sq), 1.0, 4.0, 0.01));
+
+    // Clockwise and skewed: the non-zero rule fills either winding.
+    gerber::PolygonSet tri;
+    tri.points = {{0, 0}, {733'000, 1'912'000}, {1'850'000, 211'000}};
+    tri.close();
+    const double tri_area = std::fabs(gerber::signed_area2(tri.points.data(), 3)) / 2 / 1e12;
+    PWB_CHECK(near(covered(raster::rasterise({tri}, {false}, o)), tri_area, 6.0, 0.01));
+
+    // A clear level over the dark square leaves nothing.
+    PWB_CHECK(covered(raster::rasterise({square, square}, {false, true}, o)) < 1e-9);
+
+    o.simd = false;
+    const raster::Bitmap scalar = raster::rasterise({square}, {false}, o);
+    PWB_CHECK(scalar.pixels == sq.pixels);
+}
+
+void gerber_text() {
+    // 2 mm circle with a 1 mm clear circle flashed on top, and a 0.5 x 4 mm draw.
+    const char* text = "%FSLAX34Y34*%\n%MOMM*%\n%ADD10C,2.0*%\n%ADD11C,1.0*%\n%ADD12R,0.5X0.5*%\n"
+                       "D10*\nX50000Y50000D03*\n%LPC*%\nD11*\nX50000Y50000D03*\n%LPD*%\n"
+                       "D12*\nX100000Y20000D02*\nX100000Y60000D01*\nM02*\n";
+    const gerber::Layer layer = gerber::parse(text);
+    raster::Options o;
+    o.pixel = 5'000;
+    const double want = kPi * (1.0 - 0.25) + 0.5 * 4.5;
+    PWB_CHECK(near(covered(raster::rasterise(layer, o)), want, 2 * kPi * 1.5 + 10.0, 0.005));
+    o.simd = false;
+    PWB_CHECK(near(covered(raster::rasterise(layer, o)), want, 2 * kPi * 1.5 + 10.0, 0.005));
+}
+
+void fixture() {
+    ZipArchive zip(test::repo_path("PCB/deprecated/gerber/gerber_espwroom32.zip"));
+    const gerber::Layer top = gerber::parse(zip.read("CAMOutputs/GerberFiles/copper_top.gbr"));
+    raster::Options o;
+    o.pixel = 10'000;
+    const double raster_mm2 = covered(raster::rasterise(top, o));
+    const std::vector<gerber::PolygonSet> levels = gerber::layer_outlines(top, 1000);
+    std::vector<bool> clear;
+    for (const gerber::Level& l : top.levels) clear.push_back(l.polarity == gerber::Polarity::Clear);
+    const double exact_mm2 = poly::area(poly::flatten(levels, clear)) / 1e12;
+    PWB_CHECK(exact_mm2 > 100);
+    PWB_CHECK(std::fabs(raster_mm2 - exact_mm2) < 0.01 * exact_mm2);
+}
+
+} // namespace
+
+int main() {
+    try {
+        polygons();
+        gerber_text();
+        fixture();
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "test_raster: %s\n", ex.what());
+        return 1;
+    }
+    return test::result("test_raster");
+}
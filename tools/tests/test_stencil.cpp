@@ -0,0 +1,77 @@
+// Stencil reduction on synthetic pads: the AVX2 corner pass against the
+// scalar one over every rule and body direction, and round pads, which are
+// cut as drawn when no rule reduces them.
+
+#include "check.hpp"
+
+#include "pwb/gerber.hpp"
+#include "pwb/polygon_ops.hpp"
+#include "pwb/stencil.hpp"
+#include "pwb/util.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace pwb;
+using gerber::Coord;
+
+void simd_matches_scalar() {
+    const std::vector<stencil::Rule> rules = stencil::default_rules();
+    const char* packages[] = {"R0805", "SOT223", "ESP-WROOM-32", "SMC_B"};
+    std::mt19937_64 rng(60);
+    std::vector<stencil::Pad> pads;
+    for (int i = 0; i < 203; ++i) { // not a multiple of four: exercises the scalar tail
+        stencil::Pad p;
+        p.x = Coord(rng() % 60'000'000), p.y = Coord(rng() % 40'000'000);
+        p.width = 300'000 + Coord(rng() % 6'000'000), p.height = 300'000 + Coord(rng() % 6'000'000);
+        p.package = packages[rng() % 4];
+        p.body_x = p.x + Coord(rng() % 4'000'000) - 2'000'000, p.body_y = p.y + Coord(rng() % 4'000'000) - 2'000'000;
+        pads.push_back(p);
+    }
+    const stencil::Result fast = stencil::reduce(pads, rules, 0.12, true);
+    const stencil::Result slow = stencil::reduce(pads, rules, 0.12, false);
+    PWB_CHECK(fast.apertures.points == slow.apertures.points);
+    PWB_CHECK(fast.apertures.offsets == slow.apertures.offsets);
+    PWB_CHECK(fast.pad_of == slow.pad_of);
+    PWB_CHECK(fast.apertures.size() > pads.size()); // window panes split
+}
+
+void round_pads_as_drawn() {
+    const gerber::Layer paste = gerber::parse("%FSLAX34Y34*%\n%MOMM*%\n%ADD10C,1.0*%\n%ADD11R,1.0X2.0*%\n"
+                                              "D10*\nX100000Y100000D03*\nD11*\nX200000Y100000D03*\nM02*\n");
+    const std::vector<stencil::Pad> pads = stencil::paste_pads(paste, nullptr, 0);
+    if (!PWB_CHECK(pads.size() == 2)) return;
+    PWB_CHECK(!pads[0].outline.points.empty());
+    PWB_CHECK(pads[1].outline.points.empty());
+
+    const stencil::Result r = stencil::reduce(pads, stencil::default_rules(), 0.12);
+    // The rectangle is a pentagon from the SoA pass; the circle follows as its outline.
+    PWB_CHECK(r.apertures.size() == 2);
+    PWB_CHECK(r.pad_of.size() == 2 && r.pad_of[0] == 1 && r.pad_of[1] == 0);
+    PWB_CHECK(r.apertures.count(1) > 5);
+    const double disc = kPi * 0.25;
+    PWB_CHECK(std::fabs(r.pads[0].paste_area - disc) < 0.01 * disc);
+    PWB_CHECK(std::fabs(r.pads[0].pad_area - disc) < 0.01 * disc);
+    PWB_CHECK(std::fabs(r.pads[1].paste_area - 2.0) < 1e-9);
+    // A 1 mm disc on 0.12 mm foil: area / wall = d / (4 t).
+    PWB_CHECK(std::fabs(r.pads[0].area_ratio - 1.0 / (4 * 0.12)) < 0.01);
+    PWB_CHECK(gerber::signed_area2(r.apertures.begin(1), r.apertures.count(1)) > 0);
+}
+
+} // namespace
+
+int main() {
+    try {
+        simd_matches_scalar();
+        round_pads_as_drawn();
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "test_stencil: %s\n", ex.what());
+        return 1;
+    }
+    return test::result("test_stencil");
+}
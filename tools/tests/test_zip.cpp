@@ -0,0 +1,79 @@
+// Zip reader on hand-built archives: a stored member reads back intact, and a
+// stored member whose central directory claims more bytes than it holds is
+// rejected instead of being copied past its data.
+
+#include "check.hpp"
+
+#include "pwb/zip_archive.hpp"
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using namespace pwb;
+
+void put16(std::string& s, std::uint32_t v) { s += char(v & 0xff), s += char(v >> 8 & 0xff); }
+void put32(std::string& s, std::uint32_t v) { put16(s, v & 0xffff), put16(s, v >> 16); }
+
+// One stored member; `claimed_size` is what the central directory says the
+// uncompressed size is.
+std::string stored_zip(const std::string& name, const std::string& data, std::uint32_t claimed_size) {
+    const std::uint32_t crc = std::uint32_t(crc32(0, reinterpret_cast<const Bytef*>(data.data()), uInt(data.size())));
+    std::string z;
+    put32(z, 0x04034b50);
+    put16(z, 10), put16(z, 0), put16(z, 0), put16(z, 0), put16(z, 0);
+    put32(z, crc), put32(z, std::uint32_t(data.size())), put32(z, std::uint32_t(data.size()));
+    put16(z, std::uint32_t(name.size())), put16(z, 0);
+    z += name + data;
+    const std::uint32_t dir = std::uint32_t(z.size());
+    put32(z, 0x02014b50);
+    put16(z, 20), put16(z, 10), put16(z, 0), put16(z, 0), put16(z, 0), put16(z, 0);
+    put32(z, crc), put32(z, std::uint32_t(data.size())), put32(z, claimed_size);
+    put16(z, std::uint32_t(name.size())), put16(z, 0), put16(z, 0), put16(z, 0), put16(z, 0);
+    put32(z, 0), put32(z, 0);
+    z += name;
+    const std::uint32_t dir_size = std::uint32_t(z.size()) - dir;
+    put32(z, 0x06054b50);
+    put16(z, 0), put16(z, 0), put16(z, 1), put16(z, 1);
+    put32(z, dir_size), put32(z, dir), put16(z, 0);
+    return z;
+}
+
+// Scratch archives go to the system temp directory, so a run that dies before
+// removing them does not leave them in the source tree.
+std::string write_temp(const std::string& bytes, const char* name) {
+    const std::string path = (std::filesystem::temp_directory_path() / (std::string("pwb_test_zip_") + name + ".zip")).string();
+    std::ofstream(path, std::ios::binary) << bytes;
+    return path;
+}
+
+} // namespace
+
+int main() {
+    try {
+        const std::string data = "G04 stored member*\nM02*\n";
+        const std::string good = write_temp(stored_zip("a.gbr", data, std::uint32_t(data.size())), "good");
+        ZipArchive zip(good);
+        PWB_CHECK(zip.entries().size() == 1);
+        PWB_CHECK(zip.read("a.gbr") == data);
+
+        const std::string bad = write_temp(stored_zip("a.gbr", data, 1 << 20), "bad");
+        ZipArchive overlong(bad);
+        PWB_CHECK_THROWS(overlong.read("a.gbr"), std::runtime_error);
+        PWB_CHECK_THROWS(ZipEntryStream(overlong, overlong.entries()[0]), std::runtime_error);
+        std::remove(good.c_str());
+        std::remove(bad.c_str());
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "test_zip: %s\n", ex.what());
+        return 1;
+    }
+    return test::result("test_zip");
+}